@@ -884,11 +884,13 @@ const char* get_request_type(HTTPAPI_REQUEST_TYPE requestType)
 }
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, size_t headersCount)
+static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle)
 {
     HTTPAPI_RESULT result;
     char    buf[TEMP_BUFFER_SIZE];
     int     ret;
+    size_t  headersSize;
+    HTTP_HEADERS_RESULT headersResult;
 
     //Send request
     /*Codes_SRS_HTTPAPI_COMPACT_21_038: [ The HTTPAPI_ExecuteRequest shall execute the resquest for the path in relativePath parameter. ]*/
@@ -899,34 +901,42 @@ static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_RE
         /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
         result = HTTPAPI_STRING_PROCESSING_ERROR;
     }
-        /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
-    else if ((result = conn_send_all(http_instance, (const unsigned char*)buf, strlen(buf))) == HTTPAPI_OK)
+    /*a call without destination only gets the size of the serialized headers*/
+    else if (((headersResult = HTTPHeaders_Serialize(httpHeadersHandle, NULL, 0, &headersSize)) != HTTP_HEADERS_OK) &&
+        (headersResult != HTTP_HEADERS_INSUFFICIENT_BUFFER))
     {
-		size_t i;
-        //Send default headers
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        for (i = 0; ((i < headersCount) && (result == HTTPAPI_OK)); i++)
+        /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+        result = HTTPAPI_STRING_PROCESSING_ERROR;
+    }
+    else
+    {
+        size_t requestLineLength = (size_t)ret;
+        size_t headsLength = requestLineLength + headersSize + 2;
+        unsigned char* heads = (unsigned char*)malloc(headsLength);
+        if (heads == NULL)
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+            result = HTTPAPI_STRING_PROCESSING_ERROR;
+        }
+        else
         {
-            char* header;
-            if (HTTPHeaders_GetHeader(httpHeadersHandle, i, &header) != HTTP_HEADERS_OK)
+            if (HTTPHeaders_Serialize(httpHeadersHandle, (char*)heads + requestLineLength, headersSize, &headersSize) != HTTP_HEADERS_OK)
             {
                 /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
                 result = HTTPAPI_STRING_PROCESSING_ERROR;
             }
             else
             {
-                if ((result = conn_send_all(http_instance, (const unsigned char*)header, strlen(header))) == HTTPAPI_OK)
-                {
-                    result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
-                }
-                free(header);
-            }
-        }
+                /*Codes_SRS_HTTPAPI_COMPACT_11_001: [ The HTTPAPI_ExecuteRequest shall send the request line, the headers serialized by HTTPHeaders_Serialize and the empty line that closes them in a single xio_send. ]*/
+                (void)memcpy(heads, buf, requestLineLength);
+                heads[headsLength - 2] = '\r';
+                heads[headsLength - 1] = '\n';
 
-        //Close headers
-        if (result == HTTPAPI_OK)
-        {
-            result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
+                /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+                /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
+                result = conn_send_all(http_instance, heads, headsLength);
+            }
+            free(heads);
         }
     }
     return result;
@@ -1289,7 +1299,7 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest_Internal(HTTP_HANDLE handle, HTTPAPI_REQUE
         LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
     /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, headersCount)) != HTTPAPI_OK)
+    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle)) != HTTPAPI_OK)
     {
         LogError("Send heads to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
@@ -476,8 +476,8 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
 
                     for (i = 0; i < headersCount; i++)
                     {
-                        char *tempBuffer;
-                        if (HTTPHeaders_GetHeader(httpHeadersHandle, i, &tempBuffer) != HTTP_HEADERS_OK)
+                        HTTP_HEADER_SPAN header;
+                        if (HTTPHeaders_GetHeaderSpan(httpHeadersHandle, i, &header) != HTTP_HEADERS_OK)
                         {
                             /* error */
                             result = HTTPAPI_HTTP_HEADERS_FAILED;
@@ -486,17 +486,16 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
                         }
                         else
                         {
-                            struct curl_slist* newHeaders = curl_slist_append(headers, tempBuffer);
+                            /* curl_slist_append makes its own copy, so the line is passed straight from the headers collection */
+                            struct curl_slist* newHeaders = curl_slist_append(headers, header.line);
                             if (newHeaders == NULL)
                             {
                                 result = HTTPAPI_ALLOC_FAILED;
                                 LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-                                free(tempBuffer);
                                 break;
                             }
                             else
                             {
-                                free(tempBuffer);
                                 headers = newHeaders;
                             }
                         }
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+/*syscall is only declared by unistd.h when this is defined*/
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#include "azure_c_shared_utility/random_source.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#if !defined(__APPLE__)
+static int read_dev_urandom(unsigned char* buffer, size_t size)
+{
+    int result;
+    FILE* urandom = fopen("/dev/urandom", "rb");
+
+    if (urandom == NULL)
+    {
+        LogError("Failure opening /dev/urandom");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (fread(buffer, 1, size, urandom) != size)
+        {
+            LogError("Failure reading %lu bytes from /dev/urandom", (unsigned long)size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        (void)fclose(urandom);
+    }
+
+    return result;
+}
+#endif
+
+int random_source_fill(unsigned char* buffer, size_t size)
+{
+    int result;
+
+#if defined(__APPLE__)
+    arc4random_buf(buffer, size);
+    result = 0;
+#elif defined(SYS_getrandom)
+    size_t filled = 0;
+
+    result = 0;
+    while (filled < size)
+    {
+        long read_bytes = syscall(SYS_getrandom, buffer + filled, size - filled, 0);
+        if (read_bytes < 0)
+        {
+            if (errno != EINTR)
+            {
+                /*kernels older than 3.17 do not have getrandom*/
+                result = read_dev_urandom(buffer + filled, size - filled);
+                break;
+            }
+        }
+        else
+        {
+            filled += (size_t)read_bytes;
+        }
+    }
+#else
+    result = read_dev_urandom(buffer, size);
+#endif
+
+    return result;
+}
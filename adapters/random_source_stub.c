@@ -0,0 +1,18 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/random_source.h"
+
+/*for platforms without a known cryptographic generator, this is rand*/
+int random_source_fill(unsigned char* buffer, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        buffer[i] = (unsigned char)rand();
+    }
+
+    return 0;
+}
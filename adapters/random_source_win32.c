@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#if !defined(_CRT_RAND_S)
+/*rand_s is only declared by stdlib.h when this is defined*/
+#define _CRT_RAND_S
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "azure_c_shared_utility/random_source.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+int random_source_fill(unsigned char* buffer, size_t size)
+{
+    int result;
+    size_t i;
+
+    result = 0;
+    for (i = 0; i < size; i += sizeof(unsigned int))
+    {
+        unsigned int value;
+        size_t to_copy = (size - i < sizeof(value)) ? size - i : sizeof(value);
+
+        if (rand_s(&value) != 0)
+        {
+            LogError("rand_s failed");
+            result = __FAILURE__;
+            break;
+        }
+
+        (void)memcpy(buffer + i, &value, to_copy);
+    }
+
+    return result;
+}
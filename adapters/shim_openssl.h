@@ -37,6 +37,7 @@
 #include "openssl/rsa.h"
 #include "openssl/x509.h"
 #include "openssl/pem.h"
+#include "openssl/sha.h"
 #include "openssl/err.h"
 
 #if defined(USE_OPENSSL_DYNAMIC)
@@ -65,6 +66,7 @@
     REQUIRED_FUNCTION(BIO_write) \
     REQUIRED_FUNCTION_1_0_2(CRYPTO_cleanup_all_ex_data) \
     REQUIRED_FUNCTION(CRYPTO_free) \
+    REQUIRED_FUNCTION_1_0_2(CRYPTO_get_locking_callback) \
     REQUIRED_FUNCTION_1_0_2(CRYPTO_num_locks) \
     REQUIRED_FUNCTION_1_0_2(CRYPTO_set_dynlock_create_callback) \
     REQUIRED_FUNCTION_1_0_2(CRYPTO_set_dynlock_destroy_callback) \
@@ -107,11 +109,15 @@
     REQUIRED_FUNCTION(PEM_read_bio_X509_CRL) \
     REQUIRED_FUNCTION(PEM_write_bio_X509_CRL) \
     REQUIRED_FUNCTION(RSA_free) \
+    REQUIRED_FUNCTION(SHA256_Final) \
+    REQUIRED_FUNCTION(SHA256_Init) \
+    REQUIRED_FUNCTION(SHA256_Update) \
     REQUIRED_FUNCTION_1_0_2(SSL_COMP_free_compression_methods) \
     REQUIRED_FUNCTION(SSL_CTX_ctrl) \
     REQUIRED_FUNCTION(SSL_CTX_free) \
     REQUIRED_FUNCTION(SSL_CTX_get_cert_store) \
     REQUIRED_FUNCTION(SSL_CTX_new) \
+    REQUIRED_FUNCTION(SSL_CTX_sess_set_new_cb) \
     REQUIRED_FUNCTION(SSL_CTX_set_cert_verify_callback) \
     REQUIRED_FUNCTION(SSL_CTX_set_default_verify_paths) \
     REQUIRED_FUNCTION(SSL_CTX_set_verify) \
@@ -120,14 +126,19 @@
     REQUIRED_FUNCTION(SSL_CTX_use_certificate) \
     REQUIRED_FUNCTION(SSL_ctrl) \
     REQUIRED_FUNCTION(SSL_do_handshake) \
+    REQUIRED_FUNCTION(SSL_SESSION_free) \
     REQUIRED_FUNCTION(SSL_free) \
     REQUIRED_FUNCTION(SSL_get_error) \
+    REQUIRED_FUNCTION(SSL_get_ex_data) \
     REQUIRED_FUNCTION_1_0_2(SSL_library_init) \
     REQUIRED_FUNCTION_1_0_2(SSL_load_error_strings) \
     REQUIRED_FUNCTION(SSL_new) \
     REQUIRED_FUNCTION(SSL_read) \
     REQUIRED_FUNCTION(SSL_set_bio) \
     REQUIRED_FUNCTION(SSL_set_connect_state) \
+    REQUIRED_FUNCTION(SSL_set_ex_data) \
+    REQUIRED_FUNCTION(SSL_set_session) \
+    REQUIRED_FUNCTION_1_1_0(SSL_session_reused) \
     REQUIRED_FUNCTION(SSL_write) \
     REQUIRED_FUNCTION_1_1_0(TLS_method) \
     REQUIRED_FUNCTION_1_0_2(SSLeay) \
@@ -218,10 +229,14 @@ FOR_ALL_OPENSSL_FUNCTIONS
 #define PEM_read_bio_X509_CRL PEM_read_bio_X509_CRL_ptr
 #define PEM_write_bio_X509_CRL PEM_write_bio_X509_CRL_ptr
 #define RSA_free RSA_free_ptr
+#define SHA256_Final SHA256_Final_ptr
+#define SHA256_Init SHA256_Init_ptr
+#define SHA256_Update SHA256_Update_ptr
 #define SSL_CTX_ctrl SSL_CTX_ctrl_ptr
 #define SSL_CTX_free SSL_CTX_free_ptr
 #define SSL_CTX_get_cert_store SSL_CTX_get_cert_store_ptr
 #define SSL_CTX_new SSL_CTX_new_ptr
+#define SSL_CTX_sess_set_new_cb SSL_CTX_sess_set_new_cb_ptr
 #define SSL_CTX_set_cert_verify_callback SSL_CTX_set_cert_verify_callback_ptr
 #define SSL_CTX_set_default_verify_paths SSL_CTX_set_default_verify_paths_ptr
 #define SSL_CTX_set_verify SSL_CTX_set_verify_ptr
@@ -230,12 +245,16 @@ FOR_ALL_OPENSSL_FUNCTIONS
 #define SSL_CTX_use_certificate SSL_CTX_use_certificate_ptr
 #define SSL_ctrl SSL_ctrl_ptr
 #define SSL_do_handshake SSL_do_handshake_ptr
+#define SSL_SESSION_free SSL_SESSION_free_ptr
 #define SSL_free SSL_free_ptr
 #define SSL_get_error SSL_get_error_ptr
+#define SSL_get_ex_data SSL_get_ex_data_ptr
 #define SSL_new SSL_new_ptr
 #define SSL_read SSL_read_ptr
 #define SSL_set_bio SSL_set_bio_ptr
 #define SSL_set_connect_state SSL_set_connect_state_ptr
+#define SSL_set_ex_data SSL_set_ex_data_ptr
+#define SSL_set_session SSL_set_session_ptr
 #define SSL_write SSL_write_ptr
 #define X509_CRL_free X509_CRL_free_ptr
 #define X509_CRL_http_nbio X509_CRL_http_nbio_ptr
@@ -253,6 +272,7 @@ FOR_ALL_OPENSSL_FUNCTIONS
 #if USE_OPENSSL_1_0_2
 #define ASN1_STRING_data ASN1_STRING_data_ptr
 #define CRYPTO_cleanup_all_ex_data CRYPTO_cleanup_all_ex_data_ptr
+#define CRYPTO_get_locking_callback CRYPTO_get_locking_callback_ptr
 #define CRYPTO_num_locks CRYPTO_num_locks_ptr
 #define CRYPTO_set_dynlock_create_callback CRYPTO_set_dynlock_create_callback_ptr
 #define CRYPTO_set_dynlock_destroy_callback CRYPTO_set_dynlock_destroy_callback_ptr
@@ -295,6 +315,7 @@ FOR_ALL_OPENSSL_FUNCTIONS
 #define OPENSSL_sk_value OPENSSL_sk_value_ptr
 #define OpenSSL_version OpenSSL_version_ptr
 #define OpenSSL_version_num OpenSSL_version_num_ptr
+#define SSL_session_reused SSL_session_reused_ptr
 #define TLS_method TLS_method_ptr
 #define X509_CRL_get0_nextUpdate X509_CRL_get0_nextUpdate_ptr
 #define X509_CRL_get_issuer X509_CRL_get_issuer_ptr
@@ -18,12 +18,15 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include "azure_c_shared_utility/socketio.h"
+#include "azure_c_shared_utility/socketio_reactor.h"
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <poll.h>
 #ifdef TIZENRT
 #include <net/lwip/tcp.h>
@@ -56,6 +59,22 @@
 
 #define CONNECT_TIMEOUT_SECONDS 10
 
+/*number of pieces handed to a single sendmsg, both for new sends and when draining the pending queue; the iovec array lives on the stack*/
+#ifndef SOCKETIO_SEND_MAX_IOV
+#if defined(IOV_MAX) && (IOV_MAX < 64)
+#define SOCKETIO_SEND_MAX_IOV IOV_MAX
+#else
+#define SOCKETIO_SEND_MAX_IOV 64
+#endif
+#endif
+
+/*a peer closing the connection shall not raise SIGPIPE; where neither MSG_NOSIGNAL nor SO_NOSIGPIPE exist SIGPIPE is ignored once at open*/
+#ifdef MSG_NOSIGNAL
+#define SOCKETIO_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SOCKETIO_SEND_FLAGS 0
+#endif
+
 typedef enum IO_STATE_TAG
 {
     IO_STATE_CLOSED,
@@ -69,6 +88,8 @@ typedef struct PENDING_SOCKET_IO_TAG
 {
     unsigned char* bytes;
     size_t size;
+    /*bytes already sent*/
+    size_t offset;
     ON_SEND_COMPLETE on_send_complete;
     void* callback_context;
     SINGLYLINKEDLIST_HANDLE pending_io_list;
@@ -86,6 +107,21 @@ typedef struct SOCKET_IO_INSTANCE_TAG
     char* target_mac_address;
     IO_STATE io_state;
     SINGLYLINKEDLIST_HANDLE pending_io_list;
+    SOCKETIO_REACTOR_HANDLE reactor;
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE reactor_registration;
+    /*recv_bytes unless the configured chunk size and batch count need a larger buffer*/
+    unsigned char* recv_buffer;
+    size_t recv_chunk_size;
+    size_t recv_batch_count;
+    /*0 leaves the kernel default*/
+    int so_rcvbuf;
+    int so_sndbuf;
+    /*bytes and entries in pending_io_list not yet written to the socket*/
+    size_t outstanding_bytes;
+    size_t outstanding_items;
+    XIO_SEND_QUEUE_LIMITS send_queue_limits;
+    /*a send was refused with XIO_SEND_WOULD_BLOCK, on_low_water is due*/
+    bool send_blocked;
     unsigned char recv_bytes[RECEIVE_BYTES_VALUE];
 } SOCKET_IO_INSTANCE;
 
@@ -126,6 +162,58 @@ static void* socketio_CloneOption(const char* name, const void* value)
                 }
             }
         }
+        else if (strcmp(name, OPTION_SOCKETIO_REACTOR) == 0)
+        {
+            /*the reactor is not owned by the socketio, the handle itself is the option*/
+            result = (void*)value;
+        }
+        else if ((strcmp(name, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE) == 0) ||
+            (strcmp(name, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT) == 0))
+        {
+            if (value == NULL)
+            {
+                LogError("Failed cloning option %s (value is NULL)", name);
+            }
+            else if ((result = malloc(sizeof(size_t))) == NULL)
+            {
+                LogError("Failed cloning option %s (malloc failed)", name);
+            }
+            else
+            {
+                *(size_t*)result = *(const size_t*)value;
+            }
+        }
+        else if ((strcmp(name, OPTION_SOCKETIO_SO_RCVBUF) == 0) ||
+            (strcmp(name, OPTION_SOCKETIO_SO_SNDBUF) == 0))
+        {
+            if (value == NULL)
+            {
+                LogError("Failed cloning option %s (value is NULL)", name);
+            }
+            else if ((result = malloc(sizeof(int))) == NULL)
+            {
+                LogError("Failed cloning option %s (malloc failed)", name);
+            }
+            else
+            {
+                *(int*)result = *(const int*)value;
+            }
+        }
+        else if (strcmp(name, OPTION_XIO_SEND_QUEUE_LIMITS) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("Failed cloning option %s (value is NULL)", name);
+            }
+            else if ((result = malloc(sizeof(XIO_SEND_QUEUE_LIMITS))) == NULL)
+            {
+                LogError("Failed cloning option %s (malloc failed)", name);
+            }
+            else
+            {
+                *(XIO_SEND_QUEUE_LIMITS*)result = *(const XIO_SEND_QUEUE_LIMITS*)value;
+            }
+        }
         else
         {
             LogError("Cannot clone option %s (not suppported)", name);
@@ -143,7 +231,13 @@ static void socketio_DestroyOption(const char* name, const void* value)
 {
     if (name != NULL)
     {
-        if (strcmp(name, OPTION_NET_INT_MAC_ADDRESS) == 0 && value != NULL)
+        if (((strcmp(name, OPTION_NET_INT_MAC_ADDRESS) == 0) ||
+            (strcmp(name, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE) == 0) ||
+            (strcmp(name, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT) == 0) ||
+            (strcmp(name, OPTION_SOCKETIO_SO_RCVBUF) == 0) ||
+            (strcmp(name, OPTION_SOCKETIO_SO_SNDBUF) == 0) ||
+            (strcmp(name, OPTION_XIO_SEND_QUEUE_LIMITS) == 0)) &&
+            value != NULL)
         {
             free((void*)value);
         }
@@ -175,6 +269,48 @@ static OPTIONHANDLER_HANDLE socketio_retrieveoptions(CONCRETE_IO_HANDLE handle)
             OptionHandler_Destroy(result);
             result = NULL;
         }
+        else if (socket_io_instance->reactor != NULL &&
+            OptionHandler_AddOption(result, OPTION_SOCKETIO_REACTOR, socket_io_instance->reactor) != OPTIONHANDLER_OK)
+        {
+            LogError("failed retrieving options (failed adding socketio_reactor)");
+            OptionHandler_Destroy(result);
+            result = NULL;
+        }
+        else if (socket_io_instance->recv_chunk_size != RECEIVE_BYTES_VALUE &&
+            OptionHandler_AddOption(result, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &socket_io_instance->recv_chunk_size) != OPTIONHANDLER_OK)
+        {
+            LogError("failed retrieving options (failed adding socketio_receive_chunk_size)");
+            OptionHandler_Destroy(result);
+            result = NULL;
+        }
+        else if (socket_io_instance->recv_batch_count != 1 &&
+            OptionHandler_AddOption(result, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT, &socket_io_instance->recv_batch_count) != OPTIONHANDLER_OK)
+        {
+            LogError("failed retrieving options (failed adding socketio_receive_batch_count)");
+            OptionHandler_Destroy(result);
+            result = NULL;
+        }
+        else if (socket_io_instance->so_rcvbuf != 0 &&
+            OptionHandler_AddOption(result, OPTION_SOCKETIO_SO_RCVBUF, &socket_io_instance->so_rcvbuf) != OPTIONHANDLER_OK)
+        {
+            LogError("failed retrieving options (failed adding socketio_so_rcvbuf)");
+            OptionHandler_Destroy(result);
+            result = NULL;
+        }
+        else if (socket_io_instance->so_sndbuf != 0 &&
+            OptionHandler_AddOption(result, OPTION_SOCKETIO_SO_SNDBUF, &socket_io_instance->so_sndbuf) != OPTIONHANDLER_OK)
+        {
+            LogError("failed retrieving options (failed adding socketio_so_sndbuf)");
+            OptionHandler_Destroy(result);
+            result = NULL;
+        }
+        else if (socket_io_instance->send_queue_limits.high_water_mark != 0 &&
+            OptionHandler_AddOption(result, OPTION_XIO_SEND_QUEUE_LIMITS, &socket_io_instance->send_queue_limits) != OPTIONHANDLER_OK)
+        {
+            LogError("failed retrieving options (failed adding xio_send_queue_limits)");
+            OptionHandler_Destroy(result);
+            result = NULL;
+        }
     }
 
     return result;
@@ -189,7 +325,9 @@ static const IO_INTERFACE_DESCRIPTION socket_io_interface_description =
     socketio_close,
     socketio_send,
     socketio_dowork,
-    socketio_setoption
+    socketio_setoption,
+    socketio_send_vectored,
+    socketio_getoption
 };
 
 static void indicate_error(SOCKET_IO_INSTANCE* socket_io_instance)
@@ -200,7 +338,7 @@ static void indicate_error(SOCKET_IO_INSTANCE* socket_io_instance)
     }
 }
 
-static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned char* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const XIO_IOVEC* iov, size_t iov_count, size_t skip, ON_SEND_COMPLETE on_send_complete, void* callback_context)
 {
     int result;
     PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)malloc(sizeof(PENDING_SOCKET_IO));
@@ -210,6 +348,15 @@ static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned
     }
     else
     {
+        size_t size = 0;
+        size_t i;
+
+        for (i = 0; i < iov_count; i++)
+        {
+            size += iov[i].length;
+        }
+        size -= skip;
+
         pending_socket_io->bytes = (unsigned char*)malloc(size);
         if (pending_socket_io->bytes == NULL)
         {
@@ -219,11 +366,28 @@ static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned
         }
         else
         {
+            size_t offset = 0;
+
             pending_socket_io->size = size;
+            pending_socket_io->offset = 0;
             pending_socket_io->on_send_complete = on_send_complete;
             pending_socket_io->callback_context = callback_context;
             pending_socket_io->pending_io_list = socket_io_instance->pending_io_list;
-            (void)memcpy(pending_socket_io->bytes, buffer, size);
+
+            /* only the bytes after the first skip ones (already sent) are queued */
+            for (i = 0; i < iov_count; i++)
+            {
+                if (iov[i].length <= skip)
+                {
+                    skip -= iov[i].length;
+                }
+                else
+                {
+                    (void)memcpy(pending_socket_io->bytes + offset, (const unsigned char*)iov[i].base + skip, iov[i].length - skip);
+                    offset += iov[i].length - skip;
+                    skip = 0;
+                }
+            }
 
             if (singlylinkedlist_add(socket_io_instance->pending_io_list, pending_socket_io) == NULL)
             {
@@ -234,6 +398,8 @@ static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned
             }
             else
             {
+                socket_io_instance->outstanding_bytes += size;
+                socket_io_instance->outstanding_items++;
                 result = 0;
             }
         }
@@ -241,6 +407,344 @@ static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned
     return result;
 }
 
+static void remove_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, LIST_ITEM_HANDLE pending_io, PENDING_SOCKET_IO* pending_socket_io)
+{
+    socket_io_instance->outstanding_bytes -= pending_socket_io->size - pending_socket_io->offset;
+    socket_io_instance->outstanding_items--;
+
+    if (singlylinkedlist_remove(socket_io_instance->pending_io_list, pending_io) != 0)
+    {
+        socket_io_instance->io_state = IO_STATE_ERROR;
+        indicate_error(socket_io_instance);
+        LogError("Failure: unable to remove socket from list");
+    }
+}
+
+static void indicate_low_water_if_due(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    if ((socket_io_instance->send_blocked) &&
+        (socket_io_instance->outstanding_bytes <= socket_io_instance->send_queue_limits.low_water_mark))
+    {
+        socket_io_instance->send_blocked = false;
+        if (socket_io_instance->send_queue_limits.on_low_water != NULL)
+        {
+            socket_io_instance->send_queue_limits.on_low_water(socket_io_instance->send_queue_limits.on_low_water_context);
+        }
+    }
+}
+
+static void send_pending_ios(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
+    while (first_pending_io != NULL)
+    {
+        /* gather the head of the queue in one sendmsg */
+        struct iovec send_iov[SOCKETIO_SEND_MAX_IOV];
+        struct msghdr message;
+        size_t send_iov_count = 0;
+        size_t send_length = 0;
+        LIST_ITEM_HANDLE pending_io = first_pending_io;
+
+        while ((pending_io != NULL) && (send_iov_count < SOCKETIO_SEND_MAX_IOV))
+        {
+            PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)singlylinkedlist_item_get_value(pending_io);
+            if (pending_socket_io == NULL)
+            {
+                break;
+            }
+
+            send_iov[send_iov_count].iov_base = pending_socket_io->bytes + pending_socket_io->offset;
+            send_iov[send_iov_count].iov_len = pending_socket_io->size - pending_socket_io->offset;
+            send_length += send_iov[send_iov_count].iov_len;
+            send_iov_count++;
+
+            pending_io = singlylinkedlist_get_next_item(pending_io);
+        }
+
+        if (send_iov_count == 0)
+        {
+            socket_io_instance->io_state = IO_STATE_ERROR;
+            indicate_error(socket_io_instance);
+            LogError("Failure: retrieving socket from list");
+            break;
+        }
+
+        (void)memset(&message, 0, sizeof(message));
+        message.msg_iov = send_iov;
+        message.msg_iovlen = send_iov_count;
+
+        ssize_t send_result = sendmsg(socket_io_instance->socket, &message, SOCKETIO_SEND_FLAGS);
+        if (send_result == INVALID_SOCKET)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
+            {
+                /*do nothing until next dowork */
+            }
+            else
+            {
+                PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)singlylinkedlist_item_get_value(first_pending_io);
+                socket_io_instance->outstanding_bytes -= pending_socket_io->size - pending_socket_io->offset;
+                socket_io_instance->outstanding_items--;
+                free(pending_socket_io->bytes);
+                free(pending_socket_io);
+                (void)singlylinkedlist_remove(socket_io_instance->pending_io_list, first_pending_io);
+
+                LogError("Failure: sending Socket information. errno=%d (%s).", errno, strerror(errno));
+                socket_io_instance->io_state = IO_STATE_ERROR;
+                indicate_error(socket_io_instance);
+            }
+            break;
+        }
+        else
+        {
+            size_t sent = (size_t)send_result;
+
+            /* complete, in order, every entry that went out entirely; the first partially sent one only advances its offset */
+            while (sent > 0)
+            {
+                PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)singlylinkedlist_item_get_value(first_pending_io);
+                size_t remaining = pending_socket_io->size - pending_socket_io->offset;
+
+                if (sent < remaining)
+                {
+                    pending_socket_io->offset += sent;
+                    socket_io_instance->outstanding_bytes -= sent;
+                    sent = 0;
+                }
+                else
+                {
+                    sent -= remaining;
+
+                    remove_pending_io(socket_io_instance, first_pending_io, pending_socket_io);
+
+                    if (pending_socket_io->on_send_complete != NULL)
+                    {
+                        pending_socket_io->on_send_complete(pending_socket_io->callback_context, IO_SEND_OK);
+                    }
+
+                    free(pending_socket_io->bytes);
+                    free(pending_socket_io);
+
+                    first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
+                }
+            }
+
+            if ((size_t)send_result < send_length)
+            {
+                /* simply wait until next dowork */
+                break;
+            }
+        }
+
+        first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
+    }
+
+    indicate_low_water_if_due(socket_io_instance);
+}
+
+static void indicate_bytes_received(SOCKET_IO_INSTANCE* socket_io_instance, size_t size)
+{
+    if (socket_io_instance->on_bytes_received != NULL)
+    {
+        /* Explicitly ignoring here the result of the callback */
+        (void)socket_io_instance->on_bytes_received(socket_io_instance->on_bytes_received_context, socket_io_instance->recv_buffer, size);
+    }
+}
+
+/* returns non-zero when the connection failed or was closed by the other end */
+static int receive_bytes(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    int result = 0;
+    ssize_t received = 0;
+    /* with a batch count above 1 the chunks are gathered back to back in recv_buffer and handed upward in one callback,
+       each recv asks for all the space left so that a busy socket fills the batch in as few calls as possible */
+    size_t filled = 0;
+    do
+    {
+        size_t capacity = socket_io_instance->recv_chunk_size * socket_io_instance->recv_batch_count;
+
+        received = recv(socket_io_instance->socket, socket_io_instance->recv_buffer + filled, capacity - filled, 0);
+        if (received > 0)
+        {
+            filled += (size_t)received;
+            if ((socket_io_instance->recv_batch_count == 1) || (filled == capacity))
+            {
+                indicate_bytes_received(socket_io_instance, filled);
+                filled = 0;
+            }
+        }
+        else
+        {
+            /* hand over what was gathered before reporting a closed or failed connection */
+            if ((filled > 0) && (socket_io_instance->io_state == IO_STATE_OPEN))
+            {
+                int recv_errno = errno;
+                indicate_bytes_received(socket_io_instance, filled);
+                errno = recv_errno;
+            }
+            filled = 0;
+
+            if (received == 0)
+            {
+                // Do not log error here due to this is probably the socket being closed on the other end
+                indicate_error(socket_io_instance);
+                result = __FAILURE__;
+            }
+            else if (errno != EAGAIN)
+            {
+                LogError("Socketio_Failure: Receiving data from endpoint: errno=%d.", errno);
+                indicate_error(socket_io_instance);
+                result = __FAILURE__;
+            }
+        }
+
+    } while (received > 0 && socket_io_instance->io_state == IO_STATE_OPEN);
+
+    return result;
+}
+
+static int set_receive_buffer(SOCKET_IO_INSTANCE* socket_io_instance, size_t chunk_size, size_t batch_count)
+{
+    int result;
+
+    if ((chunk_size == 0) || (batch_count == 0) || (chunk_size > SIZE_MAX / batch_count))
+    {
+        LogError("Invalid receive buffer: chunk size %lu, batch count %lu.", (unsigned long)chunk_size, (unsigned long)batch_count);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t capacity = chunk_size * batch_count;
+        unsigned char* new_buffer;
+
+        if (capacity <= RECEIVE_BYTES_VALUE)
+        {
+            new_buffer = socket_io_instance->recv_bytes;
+        }
+        else if (capacity == socket_io_instance->recv_chunk_size * socket_io_instance->recv_batch_count)
+        {
+            new_buffer = socket_io_instance->recv_buffer;
+        }
+        else
+        {
+            new_buffer = (unsigned char*)malloc(capacity);
+        }
+
+        if (new_buffer == NULL)
+        {
+            LogError("Allocation Failure: Unable to allocate a %lu byte receive buffer.", (unsigned long)capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            if ((socket_io_instance->recv_buffer != socket_io_instance->recv_bytes) &&
+                (socket_io_instance->recv_buffer != new_buffer))
+            {
+                free(socket_io_instance->recv_buffer);
+            }
+
+            socket_io_instance->recv_buffer = new_buffer;
+            socket_io_instance->recv_chunk_size = chunk_size;
+            socket_io_instance->recv_batch_count = batch_count;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/* applies the configured SO_RCVBUF and SO_SNDBUF, returns errno when setsockopt fails */
+static int set_socket_buffer_sizes(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    int result;
+
+    if ((socket_io_instance->so_rcvbuf != 0) &&
+        (setsockopt(socket_io_instance->socket, SOL_SOCKET, SO_RCVBUF, &socket_io_instance->so_rcvbuf, sizeof(int)) != 0))
+    {
+        result = errno;
+        LogError("setsockopt SO_RCVBUF failed (%d)", result);
+    }
+    else if ((socket_io_instance->so_sndbuf != 0) &&
+        (setsockopt(socket_io_instance->socket, SOL_SOCKET, SO_SNDBUF, &socket_io_instance->so_sndbuf, sizeof(int)) != 0))
+    {
+        result = errno;
+        LogError("setsockopt SO_SNDBUF failed (%d)", result);
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+#ifndef __APPLE__
+static void detach_from_reactor(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    if (socket_io_instance->reactor_registration != NULL)
+    {
+        socketio_reactor_unregister(socket_io_instance->reactor_registration);
+        socket_io_instance->reactor_registration = NULL;
+    }
+}
+
+static void on_socket_event(void* context, unsigned int events)
+{
+    SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)context;
+    int receive_result = 0;
+
+    if ((events & (SOCKETIO_REACTOR_EVENT_WRITE | SOCKETIO_REACTOR_EVENT_ERROR)) != 0)
+    {
+        send_pending_ios(socket_io_instance);
+    }
+
+    if ((socket_io_instance->io_state == IO_STATE_OPEN) &&
+        ((events & (SOCKETIO_REACTOR_EVENT_READ | SOCKETIO_REACTOR_EVENT_ERROR)) != 0))
+    {
+        receive_result = receive_bytes(socket_io_instance);
+    }
+
+    /* the callbacks may have closed the socketio, which detaches it */
+    if (socket_io_instance->reactor_registration != NULL)
+    {
+        if ((receive_result != 0) || (socket_io_instance->io_state != IO_STATE_OPEN))
+        {
+            /* the error has been indicated, stop watching the socket so that a hung up socket does not keep waking the reactor up */
+            socket_io_instance->io_state = IO_STATE_ERROR;
+            detach_from_reactor(socket_io_instance);
+        }
+        else if (socketio_reactor_set_write_interest(socket_io_instance->reactor_registration, singlylinkedlist_get_head_item(socket_io_instance->pending_io_list) != NULL) != 0)
+        {
+            LogError("Failure: unable to update the reactor write interest.");
+        }
+    }
+}
+
+static int attach_to_reactor(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    int result;
+
+    if ((socket_io_instance->reactor_registration = socketio_reactor_register(socket_io_instance->reactor, socket_io_instance->socket, on_socket_event, socket_io_instance)) == NULL)
+    {
+        LogError("Failure: unable to register the socket with the reactor.");
+        result = __FAILURE__;
+    }
+    else if ((singlylinkedlist_get_head_item(socket_io_instance->pending_io_list) != NULL) &&
+        (socketio_reactor_set_write_interest(socket_io_instance->reactor_registration, true) != 0))
+    {
+        LogError("Failure: unable to set the reactor write interest.");
+        detach_from_reactor(socket_io_instance);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+#endif //__APPLE__
+
 static STATIC_VAR_UNUSED void signal_callback(int signum)
 {
     AZURE_UNREFERENCED_PARAMETER(signum);
@@ -520,6 +1024,17 @@ CONCRETE_IO_HANDLE socketio_create(void* io_create_parameters)
                     result->on_bytes_received_context = NULL;
                     result->on_io_error_context = NULL;
                     result->io_state = IO_STATE_CLOSED;
+                    result->reactor = NULL;
+                    result->reactor_registration = NULL;
+                    result->recv_buffer = result->recv_bytes;
+                    result->recv_chunk_size = RECEIVE_BYTES_VALUE;
+                    result->recv_batch_count = 1;
+                    result->so_rcvbuf = 0;
+                    result->so_sndbuf = 0;
+                    result->outstanding_bytes = 0;
+                    result->outstanding_items = 0;
+                    (void)memset(&result->send_queue_limits, 0, sizeof(result->send_queue_limits));
+                    result->send_blocked = false;
                 }
             }
         }
@@ -537,6 +1052,9 @@ void socketio_destroy(CONCRETE_IO_HANDLE socket_io)
     if (socket_io != NULL)
     {
         SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
+#ifndef __APPLE__
+        detach_from_reactor(socket_io_instance);
+#endif //__APPLE__
         /* we cannot do much if the close fails, so just ignore the result */
         if (socket_io_instance->socket != INVALID_SOCKET)
         {
@@ -561,10 +1079,36 @@ void socketio_destroy(CONCRETE_IO_HANDLE socket_io)
         singlylinkedlist_destroy(socket_io_instance->pending_io_list);
         free(socket_io_instance->hostname);
         free(socket_io_instance->target_mac_address);
+        if (socket_io_instance->recv_buffer != socket_io_instance->recv_bytes)
+        {
+            free(socket_io_instance->recv_buffer);
+        }
         free(socket_io);
     }
 }
 
+static void disable_sigpipe(int socket)
+{
+#if defined(MSG_NOSIGNAL)
+    /* every send passes MSG_NOSIGNAL */
+    (void)socket;
+#elif defined(SO_NOSIGPIPE)
+    int one = 1;
+    if (setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)) != 0)
+    {
+        LogError("setsockopt SO_NOSIGPIPE failed (%d)", errno);
+    }
+#else
+    static bool is_sigpipe_ignored = false;
+    (void)socket;
+    if (!is_sigpipe_ignored)
+    {
+        (void)signal(SIGPIPE, SIG_IGN);
+        is_sigpipe_ignored = true;
+    }
+#endif
+}
+
 int socketio_open(CONCRETE_IO_HANDLE socket_io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
 {
     int result;
@@ -589,6 +1133,9 @@ int socketio_open(CONCRETE_IO_HANDLE socket_io, ON_IO_OPEN_COMPLETE on_io_open_c
         else if (socket_io_instance->socket != INVALID_SOCKET)
         {
             // Opening an accepted socket
+            disable_sigpipe(socket_io_instance->socket);
+            /* an accepted socket still works with the default buffer sizes */
+            (void)set_socket_buffer_sizes(socket_io_instance);
             socket_io_instance->on_bytes_received_context = on_bytes_received_context;
             socket_io_instance->on_bytes_received = on_bytes_received;
             socket_io_instance->on_io_error = on_io_error;
@@ -620,9 +1167,20 @@ int socketio_open(CONCRETE_IO_HANDLE socket_io, ON_IO_OPEN_COMPLETE on_io_open_c
                 result = open_result_detailed.code = __FAILURE__;
             }
 #endif //__APPLE__
+            /* SO_RCVBUF has to be set before connecting for the TCP window scale to take it into account */
+            else if ((open_result_detailed.code = set_socket_buffer_sizes(socket_io_instance)) != 0)
+            {
+                LogError("Failure: failed setting the socket buffer sizes.");
+                close(socket_io_instance->socket);
+                socket_io_instance->socket = INVALID_SOCKET;
+                result = __FAILURE__;
+            }
             else
             {
                 struct addrinfo addrHint = { 0 };
+
+                disable_sigpipe(socket_io_instance->socket);
+
                 addrHint.ai_family = AF_INET;
                 addrHint.ai_socktype = SOCK_STREAM;
                 addrHint.ai_protocol = 0;
@@ -742,6 +1300,22 @@ int socketio_open(CONCRETE_IO_HANDLE socket_io, ON_IO_OPEN_COMPLETE on_io_open_c
                 }
             }
         }
+
+#ifndef __APPLE__
+        if ((result == 0) &&
+            (socket_io_instance->reactor != NULL) &&
+            (attach_to_reactor(socket_io_instance) != 0))
+        {
+            LogError("Failure: unable to attach the socket to the reactor.");
+            if (socket_io_instance->hostname != NULL)
+            {
+                close(socket_io_instance->socket);
+                socket_io_instance->socket = INVALID_SOCKET;
+            }
+            socket_io_instance->io_state = IO_STATE_CLOSED;
+            result = open_result_detailed.code = __FAILURE__;
+        }
+#endif //__APPLE__
     }
 
     if (on_io_open_complete != NULL)
@@ -767,6 +1341,9 @@ int socketio_close(CONCRETE_IO_HANDLE socket_io, ON_IO_CLOSE_COMPLETE on_io_clos
         if ((socket_io_instance->io_state != IO_STATE_CLOSED) && (socket_io_instance->io_state != IO_STATE_CLOSING))
         {
             // Only close if the socket isn't already in the closed or closing state
+#ifndef __APPLE__
+            detach_from_reactor(socket_io_instance);
+#endif //__APPLE__
             (void)shutdown(socket_io_instance->socket, SHUT_RDWR);
             close(socket_io_instance->socket);
             socket_io_instance->socket = INVALID_SOCKET;
@@ -798,70 +1375,135 @@ int socketio_send(CONCRETE_IO_HANDLE socket_io, const void* buffer, size_t size,
     }
     else
     {
-        SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
-        if (socket_io_instance->io_state != IO_STATE_OPEN)
+        XIO_IOVEC iov;
+        iov.base = buffer;
+        iov.length = size;
+
+        result = socketio_send_vectored(socket_io, &iov, 1, on_send_complete, callback_context);
+    }
+
+    return result;
+}
+
+int socketio_send_vectored(CONCRETE_IO_HANDLE socket_io, const XIO_IOVEC* iov, size_t iov_count, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    int result;
+    size_t total_length = 0;
+    size_t i;
+
+    if ((socket_io == NULL) ||
+        (iov == NULL) ||
+        (iov_count == 0))
+    {
+        LogError("Invalid argument: send given invalid parameter");
+        result = __FAILURE__;
+    }
+    else
+    {
+        for (i = 0; i < iov_count; i++)
+        {
+            if ((iov[i].base == NULL) && (iov[i].length != 0))
+            {
+                break;
+            }
+
+            total_length += iov[i].length;
+        }
+
+        if ((i < iov_count) ||
+            (total_length == 0))
         {
-            LogError("Failure: socket state is not opened.");
+            LogError("Invalid argument: send given invalid parameter");
             result = __FAILURE__;
         }
         else
         {
-            LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-            if (first_pending_io != NULL)
+            SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
+            if (socket_io_instance->io_state != IO_STATE_OPEN)
+            {
+                LogError("Failure: socket state is not opened.");
+                result = __FAILURE__;
+            }
+            else if ((socket_io_instance->send_queue_limits.high_water_mark != 0) &&
+                (socket_io_instance->outstanding_bytes >= socket_io_instance->send_queue_limits.high_water_mark))
             {
-                if (add_pending_io(socket_io_instance, buffer, size, on_send_complete, callback_context) != 0)
+                /* not an error, the caller retries once on_low_water is called */
+                socket_io_instance->send_blocked = true;
+                result = XIO_SEND_WOULD_BLOCK;
+            }
+            else
+            {
+                LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
+                if (first_pending_io != NULL)
                 {
-                    LogError("Failure: add_pending_io failed.");
-                    result = __FAILURE__;
+                    /* the reactor already watches the socket for writability since the list is not empty */
+                    if (add_pending_io(socket_io_instance, iov, iov_count, 0, on_send_complete, callback_context) != 0)
+                    {
+                        LogError("Failure: add_pending_io failed.");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        result = 0;
+                    }
                 }
                 else
                 {
-                    result = 0;
-                }
-            }
-            else
-            {
-                signal(SIGPIPE, SIG_IGN);
+                    /* the pieces go to the kernel as they are, pieces beyond SOCKETIO_SEND_MAX_IOV are queued */
+                    struct iovec send_iov[SOCKETIO_SEND_MAX_IOV];
+                    struct msghdr message;
+                    size_t send_iov_count = (iov_count < SOCKETIO_SEND_MAX_IOV) ? iov_count : SOCKETIO_SEND_MAX_IOV;
 
-                ssize_t send_result = send(socket_io_instance->socket, buffer, size, 0);
-                if (send_result != size)
-                {
-                    if (send_result == INVALID_SOCKET)
+                    for (i = 0; i < send_iov_count; i++)
                     {
-                        if (errno == EAGAIN) /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
-                        {
-                            /*do nothing*/
-                            result = 0;
-                        }
-                        else
-                        {
-                            LogError("Failure: sending socket failed. errno=%d (%s).", errno, strerror(errno));
-                            result = __FAILURE__;
-                        }
+                        send_iov[i].iov_base = (void*)iov[i].base;
+                        send_iov[i].iov_len = iov[i].length;
+                    }
+
+                    (void)memset(&message, 0, sizeof(message));
+                    message.msg_iov = send_iov;
+                    message.msg_iovlen = send_iov_count;
+
+                    ssize_t send_result = sendmsg(socket_io_instance->socket, &message, SOCKETIO_SEND_FLAGS);
+                    if ((send_result == INVALID_SOCKET) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+                    {
+                        LogError("Failure: sending socket failed. errno=%d (%s).", errno, strerror(errno));
+                        result = __FAILURE__;
                     }
                     else
                     {
+                        /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
+                        size_t sent = (send_result == INVALID_SOCKET) ? 0 : (size_t)send_result;
+
+                        if (sent == total_length)
+                        {
+                            if (on_send_complete != NULL)
+                            {
+                                on_send_complete(callback_context, IO_SEND_OK);
+                            }
+
+                            result = 0;
+                        }
                         /* queue data */
-                        if (add_pending_io(socket_io_instance, buffer + send_result, size - send_result, on_send_complete, callback_context) != 0)
+                        else if (add_pending_io(socket_io_instance, iov, iov_count, sent, on_send_complete, callback_context) != 0)
                         {
                             LogError("Failure: add_pending_io failed.");
                             result = __FAILURE__;
                         }
                         else
                         {
+#ifndef __APPLE__
+                            if ((socket_io_instance->reactor_registration != NULL) &&
+                                (socketio_reactor_set_write_interest(socket_io_instance->reactor_registration, true) != 0))
+                            {
+                                /* the queued bytes go out on the next event reported for the socket */
+                                LogError("Failure: unable to set the reactor write interest.");
+                            }
+#endif //__APPLE__
                             result = 0;
                         }
                     }
                 }
-                else
-                {
-                    if (on_send_complete != NULL)
-                    {
-                        on_send_complete(callback_context, IO_SEND_OK);
-                    }
-
-                    result = 0;
-                }
             }
         }
     }
@@ -874,95 +1516,16 @@ void socketio_dowork(CONCRETE_IO_HANDLE socket_io)
     if (socket_io != NULL)
     {
         SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
-        LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-        while (first_pending_io != NULL)
-        {
-            PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)singlylinkedlist_item_get_value(first_pending_io);
-            if (pending_socket_io == NULL)
-            {
-                socket_io_instance->io_state = IO_STATE_ERROR;
-                indicate_error(socket_io_instance);
-                LogError("Failure: retrieving socket from list");
-                break;
-            }
 
-            signal(SIGPIPE, SIG_IGN);
-
-            ssize_t send_result = send(socket_io_instance->socket, pending_socket_io->bytes, pending_socket_io->size, 0);
-            if (send_result != pending_socket_io->size)
-            {
-                if (send_result == INVALID_SOCKET)
-                {
-                    if (errno == EAGAIN) /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
-                    {
-                        /*do nothing until next dowork */
-                        break;
-                    }
-                    else
-                    {
-                        free(pending_socket_io->bytes);
-                        free(pending_socket_io);
-                        (void)singlylinkedlist_remove(socket_io_instance->pending_io_list, first_pending_io);
+        /* when attached to a reactor the socket is only touched when the reactor reports it ready */
+        if (socket_io_instance->reactor == NULL)
+        {
+            send_pending_ios(socket_io_instance);
 
-                        LogError("Failure: sending Socket information. errno=%d (%s).", errno, strerror(errno));
-                        socket_io_instance->io_state = IO_STATE_ERROR;
-                        indicate_error(socket_io_instance);
-                    }
-                }
-                else
-                {
-                    /* simply wait until next dowork */
-                    (void)memmove(pending_socket_io->bytes, pending_socket_io->bytes + send_result, pending_socket_io->size - send_result);
-                    pending_socket_io->size -= send_result;
-                    break;
-                }
-            }
-            else
+            if (socket_io_instance->io_state == IO_STATE_OPEN)
             {
-                if (pending_socket_io->on_send_complete != NULL)
-                {
-                    pending_socket_io->on_send_complete(pending_socket_io->callback_context, IO_SEND_OK);
-                }
-
-                free(pending_socket_io->bytes);
-                free(pending_socket_io);
-                if (singlylinkedlist_remove(socket_io_instance->pending_io_list, first_pending_io) != 0)
-                {
-                    socket_io_instance->io_state = IO_STATE_ERROR;
-                    indicate_error(socket_io_instance);
-                    LogError("Failure: unable to remove socket from list");
-                }
+                (void)receive_bytes(socket_io_instance);
             }
-
-            first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-        }
-
-        if (socket_io_instance->io_state == IO_STATE_OPEN)
-        {
-            ssize_t received = 0;
-            do
-            {
-                received = recv(socket_io_instance->socket, socket_io_instance->recv_bytes, RECEIVE_BYTES_VALUE, 0);
-                if (received > 0)
-                {
-                    if (socket_io_instance->on_bytes_received != NULL)
-                    {
-                        /* Explicitly ignoring here the result of the callback */
-                        (void)socket_io_instance->on_bytes_received(socket_io_instance->on_bytes_received_context, socket_io_instance->recv_bytes, received);
-                    }
-                }
-                else if (received == 0)
-                {
-                    // Do not log error here due to this is probably the socket being closed on the other end
-                    indicate_error(socket_io_instance);
-                }
-                else if (received < 0 && errno != EAGAIN)
-                {
-                    LogError("Socketio_Failure: Receiving data from endpoint: errno=%d.", errno);
-                    indicate_error(socket_io_instance);
-                }
-
-            } while (received > 0 && socket_io_instance->io_state == IO_STATE_OPEN);
         }
     }
 }
@@ -1022,6 +1585,69 @@ int socketio_setoption(CONCRETE_IO_HANDLE socket_io, const char* optionName, con
             result = setsockopt(socket_io_instance->socket, SOL_TCP, TCP_KEEPINTVL, value, sizeof(int));
             if (result == -1) result = errno;
         }
+        else if (strcmp(optionName, OPTION_SOCKETIO_REACTOR) == 0)
+        {
+#ifdef __APPLE__
+            LogError("option not supported.");
+            result = __FAILURE__;
+#else
+            detach_from_reactor(socket_io_instance);
+            socket_io_instance->reactor = (SOCKETIO_REACTOR_HANDLE)value;
+
+            if ((socket_io_instance->io_state == IO_STATE_OPEN) &&
+                (attach_to_reactor(socket_io_instance) != 0))
+            {
+                LogError("failed setting socketio_reactor option (unable to attach the socket)");
+                socket_io_instance->reactor = NULL;
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+#endif
+        }
+        else if (strcmp(optionName, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE) == 0)
+        {
+            result = set_receive_buffer(socket_io_instance, *(const size_t*)value, socket_io_instance->recv_batch_count);
+        }
+        else if (strcmp(optionName, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT) == 0)
+        {
+            result = set_receive_buffer(socket_io_instance, socket_io_instance->recv_chunk_size, *(const size_t*)value);
+        }
+        else if ((strcmp(optionName, OPTION_SOCKETIO_SO_RCVBUF) == 0) ||
+            (strcmp(optionName, OPTION_SOCKETIO_SO_SNDBUF) == 0))
+        {
+            int size = *(const int*)value;
+            if (size < 0)
+            {
+                LogError("option %s must not be negative", optionName);
+                result = __FAILURE__;
+            }
+            else
+            {
+                if (strcmp(optionName, OPTION_SOCKETIO_SO_RCVBUF) == 0)
+                {
+                    socket_io_instance->so_rcvbuf = size;
+                }
+                else
+                {
+                    socket_io_instance->so_sndbuf = size;
+                }
+
+                /* before open the sizes are applied once the socket exists */
+                result = (socket_io_instance->socket != INVALID_SOCKET) ? set_socket_buffer_sizes(socket_io_instance) : 0;
+            }
+        }
+        else if (strcmp(optionName, OPTION_XIO_SEND_QUEUE_LIMITS) == 0)
+        {
+            socket_io_instance->send_queue_limits = *(const XIO_SEND_QUEUE_LIMITS*)value;
+            if (socket_io_instance->send_queue_limits.high_water_mark == 0)
+            {
+                socket_io_instance->send_blocked = false;
+            }
+            result = 0;
+        }
         else if (strcmp(optionName, OPTION_NET_INT_MAC_ADDRESS) == 0)
         {
 #ifdef __APPLE__
@@ -1061,6 +1687,40 @@ int socketio_setoption(CONCRETE_IO_HANDLE socket_io, const char* optionName, con
     return result;
 }
 
+int socketio_getoption(CONCRETE_IO_HANDLE socket_io, const char* optionName, void* value)
+{
+    int result;
+
+    if (socket_io == NULL ||
+        optionName == NULL ||
+        value == NULL)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
+
+        if (strcmp(optionName, OPTION_XIO_OUTSTANDING_BYTES) == 0)
+        {
+            *(size_t*)value = socket_io_instance->outstanding_bytes;
+            result = 0;
+        }
+        else if (strcmp(optionName, OPTION_XIO_OUTSTANDING_ITEMS) == 0)
+        {
+            *(size_t*)value = socket_io_instance->outstanding_items;
+            result = 0;
+        }
+        else
+        {
+            LogError("option %s cannot be queried", optionName);
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
 const IO_INTERFACE_DESCRIPTION* socketio_get_interface_description(void)
 {
     return &socket_io_interface_description;
@@ -0,0 +1,395 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/socketio_reactor.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/*number of ready sockets picked up by one epoll_wait*/
+#ifndef SOCKETIO_REACTOR_MAX_EVENTS
+#define SOCKETIO_REACTOR_MAX_EVENTS 64
+#endif
+
+typedef struct SOCKETIO_REACTOR_REGISTRATION_TAG
+{
+    struct SOCKETIO_REACTOR_TAG* reactor;
+    int fd;
+    ON_SOCKETIO_REACTOR_EVENT on_event;
+    void* on_event_context;
+    uint32_t epoll_events;
+    bool is_removed;
+    struct SOCKETIO_REACTOR_REGISTRATION_TAG* next_retired;
+} SOCKETIO_REACTOR_REGISTRATION;
+
+typedef struct SOCKETIO_REACTOR_TAG
+{
+    int epoll_fd;
+    int wakeup_fd;
+    size_t registration_count;
+    bool is_dispatching;
+    bool is_stop_requested;
+    /*registrations removed while dispatching, an event for them can still be in the events array*/
+    SOCKETIO_REACTOR_REGISTRATION* retired_registrations;
+    struct epoll_event events[SOCKETIO_REACTOR_MAX_EVENTS];
+} SOCKETIO_REACTOR;
+
+static unsigned int get_reactor_events(uint32_t epoll_events)
+{
+    unsigned int result = 0;
+
+    if ((epoll_events & EPOLLIN) != 0)
+    {
+        result |= SOCKETIO_REACTOR_EVENT_READ;
+    }
+
+    if ((epoll_events & EPOLLOUT) != 0)
+    {
+        result |= SOCKETIO_REACTOR_EVENT_WRITE;
+    }
+
+    if ((epoll_events & (EPOLLERR | EPOLLHUP)) != 0)
+    {
+        result |= SOCKETIO_REACTOR_EVENT_ERROR;
+    }
+
+    return result;
+}
+
+static void free_retired_registrations(SOCKETIO_REACTOR* reactor)
+{
+    while (reactor->retired_registrations != NULL)
+    {
+        SOCKETIO_REACTOR_REGISTRATION* registration = reactor->retired_registrations;
+        reactor->retired_registrations = registration->next_retired;
+        free(registration);
+    }
+}
+
+SOCKETIO_REACTOR_HANDLE socketio_reactor_create(void)
+{
+    SOCKETIO_REACTOR* result;
+
+    if ((result = (SOCKETIO_REACTOR*)malloc(sizeof(SOCKETIO_REACTOR))) == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_002: [ If any error occurs, socketio_reactor_create shall fail and return NULL. ]*/
+        LogError("Failed allocating the socketio reactor");
+    }
+    /* Codes_SRS_SOCKETIO_REACTOR_11_001: [ socketio_reactor_create shall create an epoll instance and an eventfd used to wake it up, and add the eventfd to the epoll instance. ]*/
+    else if ((result->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        LogError("epoll_create1 failed, errno=%d", errno);
+        free(result);
+        result = NULL;
+    }
+    else if ((result->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    {
+        LogError("eventfd failed, errno=%d", errno);
+        (void)close(result->epoll_fd);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        struct epoll_event wakeup_event = { 0 };
+        wakeup_event.events = EPOLLIN;
+        wakeup_event.data.ptr = NULL;
+
+        if (epoll_ctl(result->epoll_fd, EPOLL_CTL_ADD, result->wakeup_fd, &wakeup_event) != 0)
+        {
+            LogError("epoll_ctl failed adding the wakeup eventfd, errno=%d", errno);
+            (void)close(result->wakeup_fd);
+            (void)close(result->epoll_fd);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            result->registration_count = 0;
+            result->is_dispatching = false;
+            result->is_stop_requested = false;
+            result->retired_registrations = NULL;
+        }
+    }
+
+    return result;
+}
+
+void socketio_reactor_destroy(SOCKETIO_REACTOR_HANDLE reactor)
+{
+    if (reactor == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_004: [ If reactor is NULL, socketio_reactor_destroy shall do nothing. ]*/
+        LogError("NULL reactor");
+    }
+    else
+    {
+        if (reactor->registration_count != 0)
+        {
+            LogError("socketio reactor destroyed with %lu sockets still registered", (unsigned long)reactor->registration_count);
+        }
+
+        /* Codes_SRS_SOCKETIO_REACTOR_11_003: [ socketio_reactor_destroy shall close the eventfd and the epoll instance and free the reactor. ]*/
+        free_retired_registrations(reactor);
+        (void)close(reactor->wakeup_fd);
+        (void)close(reactor->epoll_fd);
+        free(reactor);
+    }
+}
+
+int socketio_reactor_run_once(SOCKETIO_REACTOR_HANDLE reactor, int timeout_ms)
+{
+    int result;
+
+    if (reactor == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_005: [ If reactor is NULL, socketio_reactor_run_once shall fail and return a non-zero value. ]*/
+        LogError("NULL reactor");
+        result = __FAILURE__;
+    }
+    else if (reactor->is_dispatching)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_006: [ If socketio_reactor_run_once is called from an event callback, it shall fail and return a non-zero value. ]*/
+        LogError("socketio_reactor_run_once cannot be called from an event callback");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_007: [ socketio_reactor_run_once shall wait with epoll_wait for up to timeout_ms milliseconds for ready sockets. ]*/
+        int event_count = epoll_wait(reactor->epoll_fd, reactor->events, SOCKETIO_REACTOR_MAX_EVENTS, timeout_ms);
+        if (event_count < 0)
+        {
+            if (errno == EINTR)
+            {
+                /* Codes_SRS_SOCKETIO_REACTOR_11_009: [ If epoll_wait is interrupted by a signal, socketio_reactor_run_once shall return 0 without dispatching any event. ]*/
+                result = 0;
+            }
+            else
+            {
+                /* Codes_SRS_SOCKETIO_REACTOR_11_010: [ If epoll_wait fails, socketio_reactor_run_once shall fail and return a non-zero value. ]*/
+                LogError("epoll_wait failed, errno=%d", errno);
+                result = __FAILURE__;
+            }
+        }
+        else
+        {
+            int i;
+
+            reactor->is_dispatching = true;
+
+            for (i = 0; i < event_count; i++)
+            {
+                SOCKETIO_REACTOR_REGISTRATION* registration = (SOCKETIO_REACTOR_REGISTRATION*)reactor->events[i].data.ptr;
+                if (registration == NULL)
+                {
+                    /* Codes_SRS_SOCKETIO_REACTOR_11_011: [ When the eventfd is signaled, socketio_reactor_run_once shall reset it and record that a stop was requested. ]*/
+                    uint64_t wakeup_count;
+                    (void)read(reactor->wakeup_fd, &wakeup_count, sizeof(wakeup_count));
+                    reactor->is_stop_requested = true;
+                }
+                /* Codes_SRS_SOCKETIO_REACTOR_11_012: [ Events for sockets unregistered earlier in the same dispatch shall be skipped. ]*/
+                else if (!registration->is_removed)
+                {
+                    /* Codes_SRS_SOCKETIO_REACTOR_11_008: [ For each ready socket, socketio_reactor_run_once shall call on_event with the on_event_context given at registration and the SOCKETIO_REACTOR_EVENT_READ, SOCKETIO_REACTOR_EVENT_WRITE and SOCKETIO_REACTOR_EVENT_ERROR flags matching the reported epoll events. ]*/
+                    registration->on_event(registration->on_event_context, get_reactor_events(reactor->events[i].events));
+                }
+            }
+
+            reactor->is_dispatching = false;
+            free_retired_registrations(reactor);
+
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int socketio_reactor_run(SOCKETIO_REACTOR_HANDLE reactor)
+{
+    int result;
+
+    if (reactor == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_013: [ If reactor is NULL, socketio_reactor_run shall fail and return a non-zero value. ]*/
+        LogError("NULL reactor");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+
+        /* Codes_SRS_SOCKETIO_REACTOR_11_014: [ socketio_reactor_run shall call socketio_reactor_run_once without a timeout until a stop is requested and then return 0. ]*/
+        while (!reactor->is_stop_requested)
+        {
+            if (socketio_reactor_run_once(reactor, -1) != 0)
+            {
+                /* Codes_SRS_SOCKETIO_REACTOR_11_015: [ If socketio_reactor_run_once fails, socketio_reactor_run shall fail and return a non-zero value. ]*/
+                LogError("socketio_reactor_run_once failed");
+                result = __FAILURE__;
+                break;
+            }
+        }
+
+        reactor->is_stop_requested = false;
+    }
+
+    return result;
+}
+
+int socketio_reactor_stop(SOCKETIO_REACTOR_HANDLE reactor)
+{
+    int result;
+
+    if (reactor == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_016: [ If reactor is NULL, socketio_reactor_stop shall fail and return a non-zero value. ]*/
+        LogError("NULL reactor");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_017: [ socketio_reactor_stop shall signal the eventfd of the reactor. ]*/
+        uint64_t one = 1;
+        if ((write(reactor->wakeup_fd, &one, sizeof(one)) != (ssize_t)sizeof(one)) && (errno != EAGAIN))
+        {
+            /* Codes_SRS_SOCKETIO_REACTOR_11_018: [ If signaling the eventfd fails, socketio_reactor_stop shall fail and return a non-zero value. ]*/
+            LogError("Failed signaling the socketio reactor, errno=%d", errno);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+SOCKETIO_REACTOR_REGISTRATION_HANDLE socketio_reactor_register(SOCKETIO_REACTOR_HANDLE reactor, int fd, ON_SOCKETIO_REACTOR_EVENT on_event, void* on_event_context)
+{
+    SOCKETIO_REACTOR_REGISTRATION* result;
+
+    if ((reactor == NULL) ||
+        (fd < 0) ||
+        (on_event == NULL))
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_019: [ If reactor is NULL, fd is negative or on_event is NULL, socketio_reactor_register shall fail and return NULL. ]*/
+        LogError("Invalid arguments: reactor=%p, fd=%d, on_event=%p", reactor, fd, on_event);
+        result = NULL;
+    }
+    else if ((result = (SOCKETIO_REACTOR_REGISTRATION*)malloc(sizeof(SOCKETIO_REACTOR_REGISTRATION))) == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_021: [ If any error occurs, socketio_reactor_register shall fail and return NULL. ]*/
+        LogError("Failed allocating the socketio reactor registration");
+    }
+    else
+    {
+        struct epoll_event event = { 0 };
+        event.events = EPOLLIN;
+        event.data.ptr = result;
+
+        /* Codes_SRS_SOCKETIO_REACTOR_11_020: [ socketio_reactor_register shall add fd to the epoll instance of the reactor, watching it for readability only. ]*/
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            LogError("epoll_ctl failed adding socket %d, errno=%d", fd, errno);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            result->reactor = reactor;
+            result->fd = fd;
+            result->on_event = on_event;
+            result->on_event_context = on_event_context;
+            result->epoll_events = EPOLLIN;
+            result->is_removed = false;
+            result->next_retired = NULL;
+            reactor->registration_count++;
+        }
+    }
+
+    return result;
+}
+
+int socketio_reactor_set_write_interest(SOCKETIO_REACTOR_REGISTRATION_HANDLE registration, bool enabled)
+{
+    int result;
+
+    if (registration == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_022: [ If registration is NULL, socketio_reactor_set_write_interest shall fail and return a non-zero value. ]*/
+        LogError("NULL registration");
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint32_t epoll_events = enabled ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        if (epoll_events == registration->epoll_events)
+        {
+            /* Codes_SRS_SOCKETIO_REACTOR_11_024: [ If the interest does not change, socketio_reactor_set_write_interest shall return 0 without calling epoll_ctl. ]*/
+            result = 0;
+        }
+        else
+        {
+            struct epoll_event event = { 0 };
+            event.events = epoll_events;
+            event.data.ptr = registration;
+
+            /* Codes_SRS_SOCKETIO_REACTOR_11_023: [ socketio_reactor_set_write_interest shall modify the epoll registration of the socket to watch it for writability when enabled is true and to stop doing so when enabled is false. ]*/
+            if (epoll_ctl(registration->reactor->epoll_fd, EPOLL_CTL_MOD, registration->fd, &event) != 0)
+            {
+                /* Codes_SRS_SOCKETIO_REACTOR_11_025: [ If epoll_ctl fails, socketio_reactor_set_write_interest shall fail and return a non-zero value. ]*/
+                LogError("epoll_ctl failed modifying socket %d, errno=%d", registration->fd, errno);
+                result = __FAILURE__;
+            }
+            else
+            {
+                registration->epoll_events = epoll_events;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+void socketio_reactor_unregister(SOCKETIO_REACTOR_REGISTRATION_HANDLE registration)
+{
+    if (registration == NULL)
+    {
+        /* Codes_SRS_SOCKETIO_REACTOR_11_026: [ If registration is NULL, socketio_reactor_unregister shall do nothing. ]*/
+        LogError("NULL registration");
+    }
+    else
+    {
+        SOCKETIO_REACTOR* reactor = registration->reactor;
+
+        /* Codes_SRS_SOCKETIO_REACTOR_11_027: [ socketio_reactor_unregister shall remove the socket from the epoll instance and free the registration. ]*/
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, registration->fd, NULL) != 0)
+        {
+            LogError("epoll_ctl failed removing socket %d, errno=%d", registration->fd, errno);
+        }
+
+        reactor->registration_count--;
+
+        if (reactor->is_dispatching)
+        {
+            /* Codes_SRS_SOCKETIO_REACTOR_11_028: [ If socketio_reactor_unregister is called from an event callback, freeing the registration shall be deferred until the dispatch completes. ]*/
+            registration->is_removed = true;
+            registration->next_retired = reactor->retired_registrations;
+            reactor->retired_registrations = registration;
+        }
+        else
+        {
+            free(registration);
+        }
+    }
+}
@@ -11,14 +11,19 @@
 #else
 #include <dirent.h>
 #include <unistd.h>
+#include <pthread.h>
 #endif
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <limits.h>
 #include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/tlsio_openssl.h"
+#include "azure_c_shared_utility/tlsio_openssl_session_cache.h"
 #include "azure_c_shared_utility/socketio.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -52,6 +57,14 @@ static bool is_an_opening_state(TLSIO_STATE state)
 
 typedef int(*TLS_CERTIFICATE_VALIDATION_CALLBACK)(X509_STORE_CTX*, void*);
 
+/*an SSL_CTX used by every open instance with the same configuration, see acquire_ssl_context*/
+typedef struct TLSIO_SHARED_CONTEXT_TAG
+{
+    STRING_HANDLE key;
+    SSL_CTX* ssl_context;
+    size_t ref_count;
+} TLSIO_SHARED_CONTEXT;
+
 typedef struct TLS_IO_INSTANCE_TAG
 {
     XIO_HANDLE underlying_io;
@@ -65,6 +78,8 @@ typedef struct TLS_IO_INSTANCE_TAG
     void* on_io_error_context;
     SSL* ssl;
     SSL_CTX* ssl_context;
+    /*NULL when ssl_context could not be shared and belongs to this instance*/
+    TLSIO_SHARED_CONTEXT* shared_context;
     BIO* in_bio;
     BIO* out_bio;
     TLSIO_STATE tlsio_state;
@@ -77,15 +92,30 @@ typedef struct TLS_IO_INSTANCE_TAG
     TLS_CERTIFICATE_VALIDATION_CALLBACK tls_validation_callback;
     void* tls_validation_callback_data;
     const char* serverName;
+    /*enforced here against the outstanding bytes of the underlying IO, which never refuses the TLS records*/
+    XIO_SEND_QUEUE_LIMITS send_queue_limits;
+    bool send_blocked;
+    /*allocated on the first decode, unless the caller supplied storage through OPTION_TLS_RECEIVE_BUFFER*/
+    unsigned char* receive_buffer;
+    size_t receive_buffer_size;
+    TLSIO_RECEIVE_BUFFER user_receive_buffer;
+    /*the encrypted bytes are staged here on their way from out_bio to the underlying IO, kept for the lifetime of the instance*/
+    unsigned char* send_buffer;
+    size_t send_buffer_size;
+    bool send_buffer_in_use;
+    int port;
+    /*hostname:port and a digest of the client certificate and key, built at open when a session cache is set*/
+    char* session_key;
+    TLSIO_SESSION_CACHE_HANDLE session_cache;
+    bool owns_session_cache;
 } TLS_IO_INSTANCE;
 
-struct CRYPTO_dynlock_value
-{
-    LOCK_HANDLE lock;
-};
-
 static const char* const OPTION_UNDERLYING_IO_OPTIONS = "underlying_io_options";
 #define SSL_DO_HANDSHAKE_SUCCESS 1
+/*the largest plaintext a single TLS record can carry*/
+#define TLSIO_RECEIVE_BUFFER_SIZE 16384
+/*the staging buffer is kept between sends up to one full TLS record, larger sends get a buffer of their own*/
+#define TLSIO_MAX_RETAINED_SEND_BUFFER_SIZE SSL3_RT_MAX_PACKET_SIZE
 
 /*this function will clone an option given by name and value*/
 static void* tlsio_openssl_CloneOption(const char* name, const void* value)
@@ -201,7 +231,8 @@ static void* tlsio_openssl_CloneOption(const char* name, const void* value)
             }
         }
         else if (strcmp(name, OPTION_DISABLE_CRL_CHECK) == 0 ||
-            strcmp(name, OPTION_DISABLE_DEFAULT_VERIFY_PATHS) == 0)
+            strcmp(name, OPTION_DISABLE_DEFAULT_VERIFY_PATHS) == 0 ||
+            strcmp(name, OPTION_TLS_SESSION_RESUMPTION) == 0)
         {
             bool bool_value = *(bool*)value;
             bool* value_clone = (bool*)malloc(sizeof(bool));
@@ -219,11 +250,58 @@ static void* tlsio_openssl_CloneOption(const char* name, const void* value)
         }
         else if (
             (strcmp(name, "tls_validation_callback") == 0) ||
-            (strcmp(name, "tls_validation_callback_data") == 0)
+            (strcmp(name, "tls_validation_callback_data") == 0) ||
+            (strcmp(name, OPTION_TLS_SESSION_CACHE) == 0)
             )
         {
             result = (void*)value;
         }
+        else if (strcmp(name, OPTION_TLS_RECEIVE_BUFFER_SIZE) == 0)
+        {
+            size_t* value_clone = (size_t*)malloc(sizeof(size_t));
+
+            if (value_clone)
+            {
+                *value_clone = *(const size_t*)value;
+            }
+            else
+            {
+                LogError("Failed cloning %s option", name);
+            }
+
+            result = value_clone;
+        }
+        else if (strcmp(name, OPTION_TLS_RECEIVE_BUFFER) == 0)
+        {
+            /*only the descriptor is copied, the storage stays with the caller*/
+            TLSIO_RECEIVE_BUFFER* value_clone = (TLSIO_RECEIVE_BUFFER*)malloc(sizeof(TLSIO_RECEIVE_BUFFER));
+
+            if (value_clone)
+            {
+                *value_clone = *(const TLSIO_RECEIVE_BUFFER*)value;
+            }
+            else
+            {
+                LogError("Failed cloning %s option", name);
+            }
+
+            result = value_clone;
+        }
+        else if (strcmp(name, OPTION_XIO_SEND_QUEUE_LIMITS) == 0)
+        {
+            XIO_SEND_QUEUE_LIMITS* value_clone = (XIO_SEND_QUEUE_LIMITS*)malloc(sizeof(XIO_SEND_QUEUE_LIMITS));
+
+            if (value_clone)
+            {
+                *value_clone = *(const XIO_SEND_QUEUE_LIMITS*)value;
+            }
+            else
+            {
+                LogError("Failed cloning %s option", name);
+            }
+
+            result = value_clone;
+        }
         else
         {
             LogError("not handled option : %s", name);
@@ -251,14 +329,19 @@ static void tlsio_openssl_DestroyOption(const char* name, const void* value)
             (strcmp(name, SU_OPTION_X509_PRIVATE_KEY) == 0) ||
             (strcmp(name, OPTION_X509_ECC_CERT) == 0) ||
             (strcmp(name, OPTION_X509_ECC_KEY) == 0) ||
-            (strcmp(name, OPTION_TLS_VERSION) == 0)
+            (strcmp(name, OPTION_TLS_VERSION) == 0) ||
+            (strcmp(name, OPTION_XIO_SEND_QUEUE_LIMITS) == 0) ||
+            (strcmp(name, OPTION_TLS_RECEIVE_BUFFER_SIZE) == 0) ||
+            (strcmp(name, OPTION_TLS_RECEIVE_BUFFER) == 0) ||
+            (strcmp(name, OPTION_TLS_SESSION_RESUMPTION) == 0)
             )
         {
             free((void*)value);
         }
         else if (
             (strcmp(name, "tls_validation_callback") == 0) ||
-            (strcmp(name, "tls_validation_callback_data") == 0)
+            (strcmp(name, "tls_validation_callback_data") == 0) ||
+            (strcmp(name, OPTION_TLS_SESSION_CACHE) == 0)
             )
         {
             // nothing to free.
@@ -325,6 +408,36 @@ static OPTIONHANDLER_HANDLE tlsio_openssl_retrieveoptions(CONCRETE_IO_HANDLE han
                 OptionHandler_Destroy(result);
                 result = NULL;
             }
+            else if (tls_io_instance->send_queue_limits.high_water_mark != 0 && (OptionHandler_AddOption(result, OPTION_XIO_SEND_QUEUE_LIMITS, &tls_io_instance->send_queue_limits) != OPTIONHANDLER_OK))
+            {
+                LogError("unable to save %s option", OPTION_XIO_SEND_QUEUE_LIMITS);
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
+            else if (tls_io_instance->receive_buffer_size != TLSIO_RECEIVE_BUFFER_SIZE && (OptionHandler_AddOption(result, OPTION_TLS_RECEIVE_BUFFER_SIZE, &tls_io_instance->receive_buffer_size) != OPTIONHANDLER_OK))
+            {
+                LogError("unable to save %s option", OPTION_TLS_RECEIVE_BUFFER_SIZE);
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
+            else if (tls_io_instance->user_receive_buffer.buffer != NULL && (OptionHandler_AddOption(result, OPTION_TLS_RECEIVE_BUFFER, &tls_io_instance->user_receive_buffer) != OPTIONHANDLER_OK))
+            {
+                LogError("unable to save %s option", OPTION_TLS_RECEIVE_BUFFER);
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
+            else if (tls_io_instance->owns_session_cache && (OptionHandler_AddOption(result, OPTION_TLS_SESSION_RESUMPTION, &tls_io_instance->owns_session_cache) != OPTIONHANDLER_OK))
+            {
+                LogError("unable to save %s option", OPTION_TLS_SESSION_RESUMPTION);
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
+            else if (!tls_io_instance->owns_session_cache && tls_io_instance->session_cache != NULL && (OptionHandler_AddOption(result, OPTION_TLS_SESSION_CACHE, tls_io_instance->session_cache) != OPTIONHANDLER_OK))
+            {
+                LogError("unable to save %s option", OPTION_TLS_SESSION_CACHE);
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
             else if (tls_io_instance->tls_version != 0)
             {
                 if (OptionHandler_AddOption(result, OPTION_TLS_VERSION, &tls_io_instance->tls_version) != OPTIONHANDLER_OK)
@@ -397,7 +510,9 @@ static const IO_INTERFACE_DESCRIPTION tlsio_openssl_interface_description =
     tlsio_openssl_close,
     tlsio_openssl_send,
     tlsio_openssl_dowork,
-    tlsio_openssl_setoption
+    tlsio_openssl_setoption,
+    tlsio_openssl_send_vectored,
+    tlsio_openssl_getoption
 };
 
 static void log_ERR_get_error(const char* message)
@@ -424,23 +539,81 @@ static void log_ERR_get_error(const char* message)
 #if !USE_OPENSSL_1_1_0_OR_UP
 // Locking callbacks are not required anymore with OpenSSL 1.1.0 or up.
 
-static LOCK_HANDLE * openssl_locks = NULL;
+#ifdef WIN32
+/*read locks are taken exclusively*/
+typedef LOCK_HANDLE OPENSSL_LOCK;
+
+static int openssl_lock_init(OPENSSL_LOCK* lock)
+{
+    *lock = Lock_Init();
+    return (*lock == NULL) ? __FAILURE__ : 0;
+}
+
+static void openssl_lock_deinit(OPENSSL_LOCK* lock)
+{
+    (void)Lock_Deinit(*lock);
+}
+
+static int openssl_lock_acquire(OPENSSL_LOCK* lock, int lock_mode)
+{
+    (void)lock_mode;
+    return (Lock(*lock) == LOCK_OK) ? 0 : __FAILURE__;
+}
+
+static int openssl_lock_release(OPENSSL_LOCK* lock)
+{
+    return (Unlock(*lock) == LOCK_OK) ? 0 : __FAILURE__;
+}
+#else
+/*OpenSSL asks for CRYPTO_READ locks on its hot paths (error queues, ex_data, X509 store lookups), a rwlock lets those run concurrently*/
+typedef pthread_rwlock_t OPENSSL_LOCK;
+
+static int openssl_lock_init(OPENSSL_LOCK* lock)
+{
+    return (pthread_rwlock_init(lock, NULL) == 0) ? 0 : __FAILURE__;
+}
+
+static void openssl_lock_deinit(OPENSSL_LOCK* lock)
+{
+    (void)pthread_rwlock_destroy(lock);
+}
+
+static int openssl_lock_acquire(OPENSSL_LOCK* lock, int lock_mode)
+{
+    int result = (lock_mode & CRYPTO_READ) ? pthread_rwlock_rdlock(lock) : pthread_rwlock_wrlock(lock);
+    return (result == 0) ? 0 : __FAILURE__;
+}
+
+static int openssl_lock_release(OPENSSL_LOCK* lock)
+{
+    return (pthread_rwlock_unlock(lock) == 0) ? 0 : __FAILURE__;
+}
+#endif
+
+struct CRYPTO_dynlock_value
+{
+    OPENSSL_LOCK lock;
+};
+
+static OPENSSL_LOCK* openssl_locks = NULL;
+/*false when the application had installed its own locking callbacks before tlsio_openssl_init*/
+static bool openssl_locks_installed = false;
 
-static void openssl_lock_unlock_helper(LOCK_HANDLE lock, int lock_mode, const char* file, int line)
+static void openssl_lock_unlock_helper(OPENSSL_LOCK* lock, int lock_mode, const char* file, int line)
 {
     (void)(file);
     (void)(line);
 
     if (lock_mode & CRYPTO_LOCK)
     {
-        if (Lock(lock) != 0)
+        if (openssl_lock_acquire(lock, lock_mode) != 0)
         {
             LogError("Failed to lock openssl lock (%s:%d)", file, line);
         }
     }
     else
     {
-        if (Unlock(lock) != 0)
+        if (openssl_lock_release(lock) != 0)
         {
             LogError("Failed to unlock openssl lock (%s:%d)", file, line);
         }
@@ -462,8 +635,7 @@ static struct CRYPTO_dynlock_value* openssl_dynamic_locks_create_cb(const char*
     }
     else
     {
-        result->lock = Lock_Init();
-        if (result->lock == NULL)
+        if (openssl_lock_init(&result->lock) != 0)
         {
             LogError("Failed to create lock for dynamic lock (%s:%d).", file, line);
 
@@ -477,14 +649,14 @@ static struct CRYPTO_dynlock_value* openssl_dynamic_locks_create_cb(const char*
 
 static void openssl_dynamic_locks_lock_unlock_cb(int lock_mode, struct CRYPTO_dynlock_value* dynlock_value, const char* file, int line)
 {
-    openssl_lock_unlock_helper(dynlock_value->lock, lock_mode, file, line);
+    openssl_lock_unlock_helper(&dynlock_value->lock, lock_mode, file, line);
 }
 
 static void openssl_dynamic_locks_destroy_cb(struct CRYPTO_dynlock_value* dynlock_value, const char* file, int line)
 {
     (void)file;
     (void)line;
-    Lock_Deinit(dynlock_value->lock);
+    openssl_lock_deinit(&dynlock_value->lock);
     free(dynlock_value);
 }
 
@@ -510,7 +682,7 @@ static void openssl_static_locks_lock_unlock_cb(int lock_mode, int lock_index, c
     }
     else
     {
-        openssl_lock_unlock_helper(openssl_locks[lock_index], lock_mode, file, line);
+        openssl_lock_unlock_helper(&openssl_locks[lock_index], lock_mode, file, line);
     }
 }
 
@@ -523,10 +695,7 @@ static void openssl_static_locks_uninstall(void)
 
         for (i = 0; i < CRYPTO_num_locks(); i++)
         {
-            if (openssl_locks[i] != NULL)
-            {
-                Lock_Deinit(openssl_locks[i]);
-            }
+            openssl_lock_deinit(&openssl_locks[i]);
         }
 
         free(openssl_locks);
@@ -549,7 +718,7 @@ static int openssl_static_locks_install(void)
     }
     else
     {
-        openssl_locks = malloc(CRYPTO_num_locks() * sizeof(LOCK_HANDLE));
+        openssl_locks = malloc(CRYPTO_num_locks() * sizeof(OPENSSL_LOCK));
         if (openssl_locks == NULL)
         {
             LogError("Failed to allocate locks");
@@ -560,8 +729,7 @@ static int openssl_static_locks_install(void)
             int i;
             for (i = 0; i < CRYPTO_num_locks(); i++)
             {
-                openssl_locks[i] = Lock_Init();
-                if (openssl_locks[i] == NULL)
+                if (openssl_lock_init(&openssl_locks[i]) != 0)
                 {
                     LogError("Failed to allocate lock %d", i);
                     break;
@@ -573,8 +741,10 @@ static int openssl_static_locks_install(void)
                 int j;
                 for (j = 0; j < i; j++)
                 {
-                    Lock_Deinit(openssl_locks[j]);
+                    openssl_lock_deinit(&openssl_locks[j]);
                 }
+                free(openssl_locks);
+                openssl_locks = NULL;
                 result = __FAILURE__;
             }
             else
@@ -589,6 +759,63 @@ static int openssl_static_locks_install(void)
 }
 #endif
 
+/*called by OpenSSL for every session the server hands out (TLS 1.2 sessions and tickets, TLS 1.3 tickets after the handshake)*/
+static int on_new_tls_session(SSL* ssl, SSL_SESSION* session)
+{
+    int result;
+    TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)SSL_get_app_data(ssl);
+
+    if (tls_io_instance == NULL || tls_io_instance->session_cache == NULL || tls_io_instance->session_key == NULL)
+    {
+        /*not kept, OpenSSL releases it*/
+        result = 0;
+    }
+    else if (tlsio_openssl_session_cache_store(tls_io_instance->session_cache, tls_io_instance->session_key, session) != 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        result = 1;
+    }
+
+    return result;
+}
+
+static int set_session_cache(TLS_IO_INSTANCE* tls_io_instance, TLSIO_SESSION_CACHE_HANDLE session_cache, bool owned)
+{
+    if (tls_io_instance->owns_session_cache)
+    {
+        tlsio_openssl_session_cache_destroy(tls_io_instance->session_cache);
+    }
+
+    tls_io_instance->session_cache = session_cache;
+    tls_io_instance->owns_session_cache = owned;
+
+    return 0;
+}
+
+/*the key carries a digest of the client certificate and key, never the PEM itself*/
+static int build_session_key(TLS_IO_INSTANCE* tls_io_instance)
+{
+    int result;
+
+    free(tls_io_instance->session_key);
+
+    if ((tls_io_instance->session_key = tlsio_openssl_session_cache_build_key(tls_io_instance->serverName, tls_io_instance->port,
+        tls_io_instance->x509_certificate, tls_io_instance->x509_private_key)) == NULL)
+    {
+        LogError("Failed creating session cache key.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
 static void indicate_error(TLS_IO_INSTANCE* tls_io_instance)
 {
     if (tls_io_instance->on_io_error == NULL)
@@ -613,6 +840,58 @@ static void indicate_open_complete(TLS_IO_INSTANCE* tls_io_instance, IO_OPEN_RES
     }
 }
 
+static unsigned char* get_send_buffer(TLS_IO_INSTANCE* tls_io_instance, size_t size)
+{
+    unsigned char* result;
+
+    if (tls_io_instance->send_buffer_in_use)
+    {
+        /*re-entered from an on_send_complete called within xio_send, the staging buffer is still being sent*/
+        result = (unsigned char*)malloc(size);
+    }
+    else if (size > TLSIO_MAX_RETAINED_SEND_BUFFER_SIZE)
+    {
+        /*one large send would otherwise pin its size for the lifetime of the instance, release_send_buffer frees this one*/
+        result = (unsigned char*)malloc(size);
+    }
+    else
+    {
+        if (size > tls_io_instance->send_buffer_size)
+        {
+            unsigned char* new_buffer = (unsigned char*)realloc(tls_io_instance->send_buffer, size);
+            if (new_buffer != NULL)
+            {
+                tls_io_instance->send_buffer = new_buffer;
+                tls_io_instance->send_buffer_size = size;
+            }
+        }
+
+        if (size > tls_io_instance->send_buffer_size)
+        {
+            result = NULL;
+        }
+        else
+        {
+            tls_io_instance->send_buffer_in_use = true;
+            result = tls_io_instance->send_buffer;
+        }
+    }
+
+    return result;
+}
+
+static void release_send_buffer(TLS_IO_INSTANCE* tls_io_instance, unsigned char* buffer)
+{
+    if (buffer == tls_io_instance->send_buffer)
+    {
+        tls_io_instance->send_buffer_in_use = false;
+    }
+    else
+    {
+        free(buffer);
+    }
+}
+
 static int write_outgoing_bytes(TLS_IO_INSTANCE* tls_io_instance, ON_SEND_COMPLETE on_send_complete, void* callback_context)
 {
     int result;
@@ -625,7 +904,8 @@ static int write_outgoing_bytes(TLS_IO_INSTANCE* tls_io_instance, ON_SEND_COMPLE
     }
     else
     {
-        unsigned char* bytes_to_send = malloc(pending);
+        /*xio_send copies whatever it cannot send right away, so the buffer is free again once it returns*/
+        unsigned char* bytes_to_send = get_send_buffer(tls_io_instance, pending);
         if (bytes_to_send == NULL)
         {
             LogError("NULL bytes_to_send.");
@@ -640,9 +920,14 @@ static int write_outgoing_bytes(TLS_IO_INSTANCE* tls_io_instance, ON_SEND_COMPLE
             }
             else
             {
-                if (xio_send(tls_io_instance->underlying_io, bytes_to_send, pending, on_send_complete, callback_context) != 0)
+                XIO_IOVEC records;
+                records.base = bytes_to_send;
+                records.length = pending;
+
+                /*the underlying socketio hands the records to the kernel with sendmsg and only queues what it did not take*/
+                if (xio_send_vectored(tls_io_instance->underlying_io, &records, 1, on_send_complete, callback_context) != 0)
                 {
-                    LogError("Error in xio_send.");
+                    LogError("Error in xio_send_vectored.");
                     result = __FAILURE__;
                 }
                 else
@@ -651,7 +936,7 @@ static int write_outgoing_bytes(TLS_IO_INSTANCE* tls_io_instance, ON_SEND_COMPLE
                 }
             }
 
-            free(bytes_to_send);
+            release_send_buffer(tls_io_instance, bytes_to_send);
         }
     }
 
@@ -680,6 +965,12 @@ static void send_handshake_bytes(TLS_IO_INSTANCE* tls_io_instance)
             {
                 LogError("SSL handshake failed: %d", ssl_err);
             }
+
+            if (tls_io_instance->session_cache != NULL && tls_io_instance->session_key != NULL)
+            {
+                /*do not offer the same session again*/
+                tlsio_openssl_session_cache_remove(tls_io_instance->session_cache, tls_io_instance->session_key);
+            }
             tls_io_instance->tlsio_state = TLSIO_STATE_HANDSHAKE_FAILED;
         }
         else
@@ -693,12 +984,60 @@ static void send_handshake_bytes(TLS_IO_INSTANCE* tls_io_instance)
     }
     else
     {
+        if (tls_io_instance->session_cache != NULL)
+        {
+            tlsio_openssl_session_cache_count_handshake(tls_io_instance->session_cache, SSL_session_reused(tls_io_instance->ssl) == 1);
+        }
+
         tls_io_instance->tlsio_state = TLSIO_STATE_OPEN;
         IO_OPEN_RESULT_DETAILED ok_result = { IO_OPEN_OK, 0 };
         indicate_open_complete(tls_io_instance, ok_result);
     }
 }
 
+static LOCK_HANDLE shared_contexts_lock = NULL;
+static SINGLYLINKEDLIST_HANDLE shared_contexts = NULL;
+
+static void release_ssl_context(TLS_IO_INSTANCE* tls_io_instance)
+{
+    if (tls_io_instance->shared_context == NULL)
+    {
+        SSL_CTX_free(tls_io_instance->ssl_context);
+    }
+    else if (Lock(shared_contexts_lock) != LOCK_OK)
+    {
+        /*leaking is the lesser evil, the context may still be used by other instances*/
+        LogError("Failed locking the shared contexts.");
+    }
+    else
+    {
+        TLSIO_SHARED_CONTEXT* shared_context = tls_io_instance->shared_context;
+
+        if (--shared_context->ref_count == 0)
+        {
+            LIST_ITEM_HANDLE item = singlylinkedlist_get_head_item(shared_contexts);
+            while (item != NULL && singlylinkedlist_item_get_value(item) != shared_context)
+            {
+                item = singlylinkedlist_get_next_item(item);
+            }
+
+            if (item != NULL)
+            {
+                (void)singlylinkedlist_remove(shared_contexts, item);
+            }
+
+            SSL_CTX_free(shared_context->ssl_context);
+            STRING_delete(shared_context->key);
+            free(shared_context);
+        }
+
+        (void)Unlock(shared_contexts_lock);
+    }
+
+    tls_io_instance->ssl_context = NULL;
+    tls_io_instance->shared_context = NULL;
+}
+
 static void close_openssl_instance(TLS_IO_INSTANCE* tls_io_instance)
 {
     if (tls_io_instance->ssl != NULL)
@@ -708,8 +1047,7 @@ static void close_openssl_instance(TLS_IO_INSTANCE* tls_io_instance)
     }
     if (tls_io_instance->ssl_context != NULL)
     {
-        SSL_CTX_free(tls_io_instance->ssl_context);
-        tls_io_instance->ssl_context = NULL;
+        release_ssl_context(tls_io_instance);
     }
 }
 
@@ -799,15 +1137,56 @@ static void on_underlying_io_error(void* context)
     }
 }
 
+static int get_receive_buffer(TLS_IO_INSTANCE* tls_io_instance, unsigned char** buffer, size_t* size)
+{
+    int result;
+
+    if (tls_io_instance->user_receive_buffer.buffer != NULL)
+    {
+        *buffer = tls_io_instance->user_receive_buffer.buffer;
+        *size = tls_io_instance->user_receive_buffer.size;
+        result = 0;
+    }
+    else
+    {
+        if (tls_io_instance->receive_buffer == NULL)
+        {
+            tls_io_instance->receive_buffer = (unsigned char*)malloc(tls_io_instance->receive_buffer_size);
+        }
+
+        if (tls_io_instance->receive_buffer == NULL)
+        {
+            LogError("Failed allocating %lu bytes receive buffer.", (unsigned long)tls_io_instance->receive_buffer_size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            *buffer = tls_io_instance->receive_buffer;
+            *size = tls_io_instance->receive_buffer_size;
+            result = 0;
+        }
+    }
+
+    /*SSL_read takes an int*/
+    if (result == 0 && *size > INT_MAX)
+    {
+        *size = INT_MAX;
+    }
+
+    return result;
+}
+
 static int decode_ssl_received_bytes(TLS_IO_INSTANCE* tls_io_instance)
 {
     int result = 0;
-    unsigned char buffer[64];
-
     int rcv_bytes = 1;
 
     while (rcv_bytes > 0 && tls_io_instance->tlsio_state == TLSIO_STATE_OPEN)
     {
+        unsigned char* buffer;
+        size_t buffer_size;
+        size_t received = 0;
+
         if (tls_io_instance->ssl == NULL)
         {
             LogError("SSL channel closed in decode_ssl_received_bytes while tlsio state is %d.", tls_io_instance->tlsio_state);
@@ -815,8 +1194,24 @@ static int decode_ssl_received_bytes(TLS_IO_INSTANCE* tls_io_instance)
             return result;
         }
 
-        rcv_bytes = SSL_read(tls_io_instance->ssl, buffer, sizeof(buffer));
-        if (rcv_bytes > 0)
+        /*fetched on every pass, the consumer may swap the buffer from within on_bytes_received*/
+        if (get_receive_buffer(tls_io_instance, &buffer, &buffer_size) != 0)
+        {
+            result = __FAILURE__;
+            return result;
+        }
+
+        /*SSL_read returns at most one record, keep reading until the buffer is full or OpenSSL needs more input*/
+        do
+        {
+            rcv_bytes = SSL_read(tls_io_instance->ssl, buffer + received, (int)(buffer_size - received));
+            if (rcv_bytes > 0)
+            {
+                received += rcv_bytes;
+            }
+        } while (rcv_bytes > 0 && received < buffer_size);
+
+        if (received > 0)
         {
             if (tls_io_instance->on_bytes_received == NULL)
             {
@@ -824,7 +1219,7 @@ static int decode_ssl_received_bytes(TLS_IO_INSTANCE* tls_io_instance)
             }
             else
             {
-                tls_io_instance->on_bytes_received(tls_io_instance->on_bytes_received_context, buffer, rcv_bytes);
+                tls_io_instance->on_bytes_received(tls_io_instance->on_bytes_received_context, buffer, received);
             }
         }
     }
@@ -1924,7 +2319,7 @@ static int add_certificate_to_store(TLS_IO_INSTANCE* tls_io_instance, const char
     return result;
 }
 
-static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
+static int create_ssl_context(TLS_IO_INSTANCE* tlsInstance)
 {
     int result;
 
@@ -1958,11 +2353,15 @@ static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
     }
     else if (load_system_store(tlsInstance) != 0)
     {
+        SSL_CTX_free(tlsInstance->ssl_context);
+        tlsInstance->ssl_context = NULL;
         log_ERR_get_error("unable to load_system_store.");
         result = __FAILURE__;
     }
     else if (setup_crl_check(tlsInstance) != 0)
     {
+        SSL_CTX_free(tlsInstance->ssl_context);
+        tlsInstance->ssl_context = NULL;
         log_ERR_get_error("unable to set up CRL check.");
         result = __FAILURE__;
     }
@@ -1991,62 +2390,246 @@ static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
     {
         SSL_CTX_set_cert_verify_callback(tlsInstance->ssl_context, tlsInstance->tls_validation_callback, tlsInstance->tls_validation_callback_data);
 
-        tlsInstance->in_bio = BIO_new(BIO_s_mem());
-        if (tlsInstance->in_bio == NULL)
+        /*sessions are kept in the session cache of each instance, keyed by host and client identity, never in the SSL_CTX*/
+        (void)SSL_CTX_set_session_cache_mode(tlsInstance->ssl_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(tlsInstance->ssl_context, on_new_tls_session);
+
+        SSL_CTX_set_verify(tlsInstance->ssl_context, SSL_VERIFY_PEER, NULL);
+
+        if (!tlsInstance->disable_default_verify_paths)
         {
-            SSL_CTX_free(tlsInstance->ssl_context);
-            tlsInstance->ssl_context = NULL;
-            log_ERR_get_error("Failed BIO_new for in BIO.");
-            result = __FAILURE__;
+            // Specifies that the default locations for which CA certificates are loaded should be used.
+            if (SSL_CTX_set_default_verify_paths(tlsInstance->ssl_context) != 1)
+            {
+                // This is only a warning to the user. They can still specify the certificate via SetOption.
+                LogInfo("WARNING: Unable to specify the default location for CA certificates on this platform.");
+            }
         }
         else
         {
-            tlsInstance->out_bio = BIO_new(BIO_s_mem());
-            if (tlsInstance->out_bio == NULL)
-            {
-                (void)BIO_free(tlsInstance->in_bio);
-                SSL_CTX_free(tlsInstance->ssl_context);
-                tlsInstance->ssl_context = NULL;
-                log_ERR_get_error("Failed BIO_new for out BIO.");
-                result = __FAILURE__;
-            }
+            LogInfo("Not using default verify paths, as requested.\n");
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+/*same encoding as the session cache key: a NULL PEM and an empty one hash differently, so do PEMs moved from one option to another*/
+static int add_pem_to_digest(SHA256_CTX* sha256_context, const char* pem)
+{
+    int result;
+    unsigned char marker = (pem == NULL) ? 0 : 1;
+    size_t length = (pem == NULL) ? 0 : strlen(pem);
+    unsigned char encoded_length[8];
+    size_t i;
+
+    for (i = 0; i < sizeof(encoded_length); i++)
+    {
+        encoded_length[i] = (unsigned char)(((uint64_t)length >> (8 * i)) & 0xFF);
+    }
+
+    if ((SHA256_Update(sha256_context, &marker, 1) != 1) ||
+        (SHA256_Update(sha256_context, encoded_length, sizeof(encoded_length)) != 1) ||
+        ((length > 0) && (SHA256_Update(sha256_context, pem, length) != 1)))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+/*everything create_ssl_context puts in the SSL_CTX, the PEMs only as a SHA-256 digest so the key has a fixed size and holds no key material*/
+static STRING_HANDLE build_shared_context_key(TLS_IO_INSTANCE* tlsInstance)
+{
+    STRING_HANDLE result;
+    SHA256_CTX sha256_context;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+#ifdef WIN32
+#pragma warning(push)
+#pragma warning(disable:4152)
+#endif
+    void* validation_callback = tlsInstance->tls_validation_callback;
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+    if ((SHA256_Init(&sha256_context) != 1) ||
+        (add_pem_to_digest(&sha256_context, tlsInstance->certificate) != 0) ||
+        (add_pem_to_digest(&sha256_context, tlsInstance->x509_certificate) != 0) ||
+        (add_pem_to_digest(&sha256_context, tlsInstance->x509_private_key) != 0) ||
+        (SHA256_Final(digest, &sha256_context) != 1))
+    {
+        LogError("Failed hashing the shared context certificates.");
+        result = NULL;
+    }
+    else
+    {
+        static const char hex_digits[] = "0123456789abcdef";
+        /*the settings take less than 128 characters, followed by the digest in hex*/
+        char key[128 + (2 * SHA256_DIGEST_LENGTH) + 1];
+        int written = sprintf_s(key, 128, "%d;%d;%d;%p;%p;", (int)tlsInstance->tls_version, tlsInstance->disable_crl_check ? 1 : 0,
+            tlsInstance->disable_default_verify_paths ? 1 : 0, validation_callback, tlsInstance->tls_validation_callback_data);
+
+        if (written < 0)
+        {
+            LogError("Failed formatting the shared context key.");
+            result = NULL;
+        }
+        else
+        {
+            size_t i;
+
+            for (i = 0; i < SHA256_DIGEST_LENGTH; i++)
+            {
+                key[written + (2 * i)] = hex_digits[digest[i] >> 4];
+                key[written + (2 * i) + 1] = hex_digits[digest[i] & 0x0F];
+            }
+
+            key[written + (2 * SHA256_DIGEST_LENGTH)] = '\0';
+
+            if ((result = STRING_construct(key)) == NULL)
+            {
+                LogError("Failed creating the shared context key.");
+            }
+        }
+    }
+
+    return result;
+}
+
+static bool shared_context_matches(LIST_ITEM_HANDLE list_item, const void* match_context)
+{
+    const TLSIO_SHARED_CONTEXT* shared_context = (const TLSIO_SHARED_CONTEXT*)singlylinkedlist_item_get_value(list_item);
+    return STRING_compare(shared_context->key, (STRING_HANDLE)match_context) == 0;
+}
+
+/*the certificate parsing and store setup happen once per distinct configuration, the open instances share the SSL_CTX*/
+static int acquire_ssl_context(TLS_IO_INSTANCE* tlsInstance)
+{
+    int result;
+    STRING_HANDLE key;
+
+    tlsInstance->shared_context = NULL;
+
+    if (shared_contexts == NULL || (key = build_shared_context_key(tlsInstance)) == NULL)
+    {
+        result = create_ssl_context(tlsInstance);
+    }
+    else
+    {
+        if (Lock(shared_contexts_lock) != LOCK_OK)
+        {
+            LogError("Failed locking the shared contexts, using a private SSL_CTX.");
+            STRING_delete(key);
+            result = create_ssl_context(tlsInstance);
+        }
+        else
+        {
+            LIST_ITEM_HANDLE item = singlylinkedlist_find(shared_contexts, shared_context_matches, key);
+
+            if (item != NULL)
+            {
+                tlsInstance->shared_context = (TLSIO_SHARED_CONTEXT*)singlylinkedlist_item_get_value(item);
+                tlsInstance->shared_context->ref_count++;
+                tlsInstance->ssl_context = tlsInstance->shared_context->ssl_context;
+                STRING_delete(key);
+                result = 0;
+            }
+            else if (create_ssl_context(tlsInstance) != 0)
+            {
+                STRING_delete(key);
+                result = __FAILURE__;
+            }
             else
             {
-                if ((BIO_set_mem_eof_return(tlsInstance->in_bio, -1) <= 0) ||
-                    (BIO_set_mem_eof_return(tlsInstance->out_bio, -1) <= 0))
+                TLSIO_SHARED_CONTEXT* shared_context = (TLSIO_SHARED_CONTEXT*)malloc(sizeof(TLSIO_SHARED_CONTEXT));
+                if (shared_context == NULL)
                 {
-                    (void)BIO_free(tlsInstance->in_bio);
-                    (void)BIO_free(tlsInstance->out_bio);
-                    SSL_CTX_free(tlsInstance->ssl_context);
-                    tlsInstance->ssl_context = NULL;
-                    LogError("Failed BIO_set_mem_eof_return.");
-                    result = __FAILURE__;
+                    /*still usable, just not shared*/
+                    LogError("Failed allocating shared context.");
+                    STRING_delete(key);
                 }
                 else
                 {
-                    SSL_CTX_set_verify(tlsInstance->ssl_context, SSL_VERIFY_PEER, NULL);
+                    shared_context->key = key;
+                    shared_context->ssl_context = tlsInstance->ssl_context;
+                    shared_context->ref_count = 1;
 
-                    if (!tlsInstance->disable_default_verify_paths)
+                    if (singlylinkedlist_add(shared_contexts, shared_context) == NULL)
                     {
-                        // Specifies that the default locations for which CA certificates are loaded should be used.
-                        if (SSL_CTX_set_default_verify_paths(tlsInstance->ssl_context) != 1)
-                        {
-                            // This is only a warning to the user. They can still specify the certificate via SetOption.
-                            LogInfo("WARNING: Unable to specify the default location for CA certificates on this platform.");
-                        }
+                        LogError("Failed adding shared context.");
+                        STRING_delete(key);
+                        free(shared_context);
                     }
                     else
                     {
-                        LogInfo("Not using default verify paths, as requested.\n");
+                        tlsInstance->shared_context = shared_context;
                     }
+                }
 
+                result = 0;
+            }
+
+            (void)Unlock(shared_contexts_lock);
+        }
+    }
+
+    return result;
+}
+
+static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
+{
+    int result;
+
+    if (acquire_ssl_context(tlsInstance) != 0)
+    {
+        LogError("Failed getting an OpenSSL context.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        tlsInstance->in_bio = BIO_new(BIO_s_mem());
+        if (tlsInstance->in_bio == NULL)
+        {
+            release_ssl_context(tlsInstance);
+            log_ERR_get_error("Failed BIO_new for in BIO.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            tlsInstance->out_bio = BIO_new(BIO_s_mem());
+            if (tlsInstance->out_bio == NULL)
+            {
+                (void)BIO_free(tlsInstance->in_bio);
+                release_ssl_context(tlsInstance);
+                log_ERR_get_error("Failed BIO_new for out BIO.");
+                result = __FAILURE__;
+            }
+            else
+            {
+                if ((BIO_set_mem_eof_return(tlsInstance->in_bio, -1) <= 0) ||
+                    (BIO_set_mem_eof_return(tlsInstance->out_bio, -1) <= 0))
+                {
+                    (void)BIO_free(tlsInstance->in_bio);
+                    (void)BIO_free(tlsInstance->out_bio);
+                    release_ssl_context(tlsInstance);
+                    LogError("Failed BIO_set_mem_eof_return.");
+                    result = __FAILURE__;
+                }
+                else
+                {
                     tlsInstance->ssl = SSL_new(tlsInstance->ssl_context);
                     if (tlsInstance->ssl == NULL)
                     {
                         (void)BIO_free(tlsInstance->in_bio);
                         (void)BIO_free(tlsInstance->out_bio);
-                        SSL_CTX_free(tlsInstance->ssl_context);
-                        tlsInstance->ssl_context = NULL;
+                        release_ssl_context(tlsInstance);
                         log_ERR_get_error("Failed creating OpenSSL instance.");
                         result = __FAILURE__;
                     }
@@ -2054,6 +2637,13 @@ static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
                     {
                         SSL_set_bio(tlsInstance->ssl, tlsInstance->in_bio, tlsInstance->out_bio);
                         SSL_set_tlsext_host_name(tlsInstance->ssl, tlsInstance->serverName);
+                        /*lets on_new_tls_session find this instance*/
+                        (void)SSL_set_app_data(tlsInstance->ssl, tlsInstance);
+                        /*without a key the connection neither resumes nor stores sessions*/
+                        if (tlsInstance->session_cache != NULL && build_session_key(tlsInstance) == 0)
+                        {
+                            tlsio_openssl_session_cache_apply(tlsInstance->session_cache, tlsInstance->session_key, tlsInstance->ssl);
+                        }
                         SSL_set_connect_state(tlsInstance->ssl);
                         result = 0;
                     }
@@ -2069,6 +2659,21 @@ int tlsio_openssl_init(void)
 {
     crl_cache_lock = Lock_Init();
 
+    if (shared_contexts == NULL)
+    {
+        /*without them every connection gets its own SSL_CTX*/
+        if ((shared_contexts_lock = Lock_Init()) == NULL)
+        {
+            LogError("Failed creating the shared contexts lock.");
+        }
+        else if ((shared_contexts = singlylinkedlist_create()) == NULL)
+        {
+            LogError("Failed creating the shared contexts list.");
+            (void)Lock_Deinit(shared_contexts_lock);
+            shared_contexts_lock = NULL;
+        }
+    }
+
 #if defined(USE_OPENSSL_DYNAMIC)
     if (load_libssl())
     {
@@ -2089,13 +2694,22 @@ int tlsio_openssl_init(void)
     OpenSSL_add_all_algorithms();
 
     // Locking callbacks not needed for 1.1.0 or up.
-    if (openssl_static_locks_install() != 0)
+    if (CRYPTO_get_locking_callback() != NULL)
     {
-        LogError("Failed to install static locks in OpenSSL!");
-        return __FAILURE__;
+        // The application (or another library) already made OpenSSL thread safe, keep its callbacks.
+        LogInfo("OpenSSL locking callbacks already installed, not installing ours.");
     }
+    else
+    {
+        if (openssl_static_locks_install() != 0)
+        {
+            LogError("Failed to install static locks in OpenSSL!");
+            return __FAILURE__;
+        }
 
-    openssl_dynamic_locks_install();
+        openssl_dynamic_locks_install();
+        openssl_locks_installed = true;
+    }
 #endif
 
 #if USE_OPENSSL_1_1_0_OR_UP
@@ -2109,16 +2723,31 @@ int tlsio_openssl_init(void)
 
 void tlsio_openssl_deinit(void)
 {
+    if (shared_contexts != NULL)
+    {
+        /*every instance is expected to be destroyed by now*/
+        if (singlylinkedlist_get_head_item(shared_contexts) != NULL)
+        {
+            LogError("tlsio_openssl instances are still open, their SSL_CTX are leaked.");
+        }
+        singlylinkedlist_destroy(shared_contexts);
+        shared_contexts = NULL;
+        (void)Lock_Deinit(shared_contexts_lock);
+        shared_contexts_lock = NULL;
+    }
+
 #if !USE_OPENSSL_1_1_0_OR_UP
     // Clean-up (incl. locking callbacks) not required anymore for 1.1.0 or up.
 
-    openssl_dynamic_locks_uninstall();
-    openssl_static_locks_uninstall();
+    if (openssl_locks_installed)
+    {
+        openssl_dynamic_locks_uninstall();
+        openssl_static_locks_uninstall();
+        openssl_locks_installed = false;
+    }
 #ifndef __APPLE__
     FIPS_mode_set(0);
 #endif
-    CRYPTO_set_locking_callback(NULL);
-    CRYPTO_set_id_callback(NULL); // TODO already deprecated in 1.0.0 ?
     ERR_free_strings();
     EVP_cleanup();
     ERR_remove_thread_state(NULL);
@@ -2194,6 +2823,7 @@ CONCRETE_IO_HANDLE tlsio_openssl_create(void* io_create_parameters)
                     result->on_io_error_context = NULL;
                     result->ssl = NULL;
                     result->ssl_context = NULL;
+                    result->shared_context = NULL;
                     result->tls_validation_callback = NULL;
                     result->tls_validation_callback_data = NULL;
                     result->x509_certificate = NULL;
@@ -2202,6 +2832,19 @@ CONCRETE_IO_HANDLE tlsio_openssl_create(void* io_create_parameters)
                     result->tls_version = OPTION_TLS_VERSION_1_0;
                     result->disable_crl_check = false;
                     result->disable_default_verify_paths = false;
+                    (void)memset(&result->send_queue_limits, 0, sizeof(result->send_queue_limits));
+                    result->send_blocked = false;
+                    result->receive_buffer = NULL;
+                    result->receive_buffer_size = TLSIO_RECEIVE_BUFFER_SIZE;
+                    result->user_receive_buffer.buffer = NULL;
+                    result->user_receive_buffer.size = 0;
+                    result->send_buffer = NULL;
+                    result->send_buffer_size = 0;
+                    result->send_buffer_in_use = false;
+                    result->port = tls_io_config->port;
+                    result->session_key = NULL;
+                    result->session_cache = NULL;
+                    result->owns_session_cache = false;
 
                     result->underlying_io = xio_create(underlying_io_interface, io_interface_parameters);
                     if (result->underlying_io == NULL)
@@ -2238,7 +2881,11 @@ void tlsio_openssl_destroy(CONCRETE_IO_HANDLE tls_io)
         }
         free((void*)tls_io_instance->x509_certificate);
         free((void*)tls_io_instance->x509_private_key);
+        free(tls_io_instance->receive_buffer);
+        free(tls_io_instance->send_buffer);
         close_openssl_instance(tls_io_instance);
+        (void)set_session_cache(tls_io_instance, NULL, false);
+        free(tls_io_instance->session_key);
         if (tls_io_instance->underlying_io != NULL)
         {
             xio_destroy(tls_io_instance->underlying_io);
@@ -2372,13 +3019,56 @@ int tlsio_openssl_close(CONCRETE_IO_HANDLE tls_io, ON_IO_CLOSE_COMPLETE on_io_cl
     return result;
 }
 
+static size_t get_underlying_outstanding_bytes(TLS_IO_INSTANCE* tls_io_instance)
+{
+    size_t outstanding_bytes;
+
+    if (xio_getoption(tls_io_instance->underlying_io, OPTION_XIO_OUTSTANDING_BYTES, &outstanding_bytes) != 0)
+    {
+        /* an underlying IO that cannot tell does not queue */
+        outstanding_bytes = 0;
+    }
+
+    return outstanding_bytes;
+}
+
+static bool is_send_queue_full(TLS_IO_INSTANCE* tls_io_instance)
+{
+    return (tls_io_instance->send_queue_limits.high_water_mark != 0) &&
+        (get_underlying_outstanding_bytes(tls_io_instance) >= tls_io_instance->send_queue_limits.high_water_mark);
+}
+
+static void indicate_low_water_if_due(TLS_IO_INSTANCE* tls_io_instance)
+{
+    if ((tls_io_instance->send_blocked) &&
+        (get_underlying_outstanding_bytes(tls_io_instance) <= tls_io_instance->send_queue_limits.low_water_mark))
+    {
+        tls_io_instance->send_blocked = false;
+        if (tls_io_instance->send_queue_limits.on_low_water != NULL)
+        {
+            tls_io_instance->send_queue_limits.on_low_water(tls_io_instance->send_queue_limits.on_low_water_context);
+        }
+    }
+}
+
 int tlsio_openssl_send(CONCRETE_IO_HANDLE tls_io, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    XIO_IOVEC iov;
+    iov.base = buffer;
+    iov.length = size;
+
+    return tlsio_openssl_send_vectored(tls_io, &iov, 1, on_send_complete, callback_context);
+}
+
+int tlsio_openssl_send_vectored(CONCRETE_IO_HANDLE tls_io, const XIO_IOVEC* iov, size_t iov_count, ON_SEND_COMPLETE on_send_complete, void* callback_context)
 {
     int result;
 
-    if (tls_io == NULL)
+    if ((tls_io == NULL) ||
+        (iov == NULL) ||
+        (iov_count == 0))
     {
-        LogError("NULL tls_io.");
+        LogError("Invalid arguments: tls_io=%p, iov=%p, iov_count=%lu", tls_io, iov, (unsigned long)iov_count);
         result = __FAILURE__;
     }
     else
@@ -2392,7 +3082,8 @@ int tlsio_openssl_send(CONCRETE_IO_HANDLE tls_io, const void* buffer, size_t siz
         }
         else
         {
-            int res;
+            size_t i;
+
             if (tls_io_instance->ssl == NULL)
             {
                 LogError("SSL channel closed in tlsio_openssl_send.");
@@ -2400,13 +3091,81 @@ int tlsio_openssl_send(CONCRETE_IO_HANDLE tls_io, const void* buffer, size_t siz
                 return result;
             }
 
-            res = SSL_write(tls_io_instance->ssl, buffer, (int)size);
-            if (res != (int)size)
+            /* checked before SSL_write, once encrypted the record has to reach the underlying IO */
+            if (is_send_queue_full(tls_io_instance))
             {
-                log_ERR_get_error("SSL_write error.");
-                result = __FAILURE__;
+                tls_io_instance->send_blocked = true;
+                return XIO_SEND_WOULD_BLOCK;
+            }
+
+            if (iov_count == 1)
+            {
+                if ((iov[0].length > 0) &&
+                    (SSL_write(tls_io_instance->ssl, iov[0].base, (int)iov[0].length) != (int)iov[0].length))
+                {
+                    log_ERR_get_error("SSL_write error.");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
             }
             else
+            {
+                /* the pieces are gathered and encrypted with one SSL_write: a failure cannot leave the first pieces
+                   encrypted and the rest not, and small pieces do not each cost a TLS record */
+                size_t total_length = 0;
+                unsigned char* plaintext;
+
+                for (i = 0; i < iov_count; i++)
+                {
+                    total_length += iov[i].length;
+                }
+
+                if (total_length == 0)
+                {
+                    result = 0;
+                }
+                else if (total_length > INT_MAX)
+                {
+                    LogError("Too many bytes for one send: %lu", (unsigned long)total_length);
+                    result = __FAILURE__;
+                }
+                else if ((plaintext = get_send_buffer(tls_io_instance, total_length)) == NULL)
+                {
+                    LogError("Failed allocating the buffer for the gathered pieces.");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    size_t offset = 0;
+
+                    for (i = 0; i < iov_count; i++)
+                    {
+                        if (iov[i].length > 0)
+                        {
+                            (void)memcpy(plaintext + offset, iov[i].base, iov[i].length);
+                            offset += iov[i].length;
+                        }
+                    }
+
+                    if (SSL_write(tls_io_instance->ssl, plaintext, (int)total_length) != (int)total_length)
+                    {
+                        log_ERR_get_error("SSL_write error.");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        result = 0;
+                    }
+
+                    /* free again for the records write_outgoing_bytes reads out of out_bio */
+                    release_send_buffer(tls_io_instance, plaintext);
+                }
+            }
+
+            if (result == 0)
             {
                 if (write_outgoing_bytes(tls_io_instance, on_send_complete, callback_context) != 0)
                 {
@@ -2471,6 +3230,10 @@ void tlsio_openssl_dowork(CONCRETE_IO_HANDLE tls_io)
                 IO_OPEN_RESULT_DETAILED error_result = { IO_OPEN_ERROR, __FAILURE__ };
                 indicate_open_complete(tls_io_instance, error_result);
             }
+            else
+            {
+                indicate_low_water_if_due(tls_io_instance);
+            }
         }
     }
 }
@@ -2492,29 +3255,38 @@ int tlsio_openssl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, c
             const char* cert = (const char*)value;
             size_t len;
 
-            if (tls_io_instance->certificate != NULL)
-            {
-                // Free the memory if it has been previously allocated
-                free(tls_io_instance->certificate);
-            }
-
-            // Store the certificate
-            len = strlen(cert);
-            tls_io_instance->certificate = malloc(len + 1);
-            if (tls_io_instance->certificate == NULL)
+            // The context of an open connection may be shared with other instances, it cannot be changed for this one only
+            if (tls_io_instance->shared_context != NULL)
             {
+                LogError("Unable to set the %s option while the connection shares its TLS context", optionName);
                 result = __FAILURE__;
             }
             else
             {
-                strcpy(tls_io_instance->certificate, cert);
-                result = 0;
-            }
+                if (tls_io_instance->certificate != NULL)
+                {
+                    // Free the memory if it has been previously allocated
+                    free(tls_io_instance->certificate);
+                }
 
-            // If we're previously connected then add the cert to the context
-            if (tls_io_instance->ssl_context != NULL)
-            {
-                result = add_certificate_to_store(tls_io_instance, cert);
+                // Store the certificate
+                len = strlen(cert);
+                tls_io_instance->certificate = malloc(len + 1);
+                if (tls_io_instance->certificate == NULL)
+                {
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    strcpy(tls_io_instance->certificate, cert);
+                    result = 0;
+                }
+
+                // If we're previously connected then add the cert to the context
+                if ((result == 0) && (tls_io_instance->ssl_context != NULL))
+                {
+                    result = add_certificate_to_store(tls_io_instance, cert);
+                }
             }
         }
         else if (strcmp(SU_OPTION_X509_CERT, optionName) == 0 || strcmp(OPTION_X509_ECC_CERT, optionName) == 0)
@@ -2561,32 +3333,48 @@ int tlsio_openssl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, c
         }
         else if (strcmp("tls_validation_callback", optionName) == 0)
         {
+            if (tls_io_instance->shared_context != NULL)
+            {
+                LogError("Unable to set the %s option while the connection shares its TLS context", optionName);
+                result = __FAILURE__;
+            }
+            else
+            {
 #ifdef WIN32
 #pragma warning(push)
 #pragma warning(disable:4055)
 #endif // WIN32
-            tls_io_instance->tls_validation_callback = (TLS_CERTIFICATE_VALIDATION_CALLBACK)value;
+                tls_io_instance->tls_validation_callback = (TLS_CERTIFICATE_VALIDATION_CALLBACK)value;
 #ifdef WIN32
 #pragma warning(pop)
 #endif // WIN32
 
-            if (tls_io_instance->ssl_context != NULL)
-            {
-                SSL_CTX_set_cert_verify_callback(tls_io_instance->ssl_context, tls_io_instance->tls_validation_callback, tls_io_instance->tls_validation_callback_data);
-            }
+                if (tls_io_instance->ssl_context != NULL)
+                {
+                    SSL_CTX_set_cert_verify_callback(tls_io_instance->ssl_context, tls_io_instance->tls_validation_callback, tls_io_instance->tls_validation_callback_data);
+                }
 
-            result = 0;
+                result = 0;
+            }
         }
         else if (strcmp("tls_validation_callback_data", optionName) == 0)
         {
-            tls_io_instance->tls_validation_callback_data = (void*)value;
-
-            if (tls_io_instance->ssl_context != NULL)
+            if (tls_io_instance->shared_context != NULL)
             {
-                SSL_CTX_set_cert_verify_callback(tls_io_instance->ssl_context, tls_io_instance->tls_validation_callback, tls_io_instance->tls_validation_callback_data);
+                LogError("Unable to set the %s option while the connection shares its TLS context", optionName);
+                result = __FAILURE__;
             }
+            else
+            {
+                tls_io_instance->tls_validation_callback_data = (void*)value;
 
-            result = 0;
+                if (tls_io_instance->ssl_context != NULL)
+                {
+                    SSL_CTX_set_cert_verify_callback(tls_io_instance->ssl_context, tls_io_instance->tls_validation_callback, tls_io_instance->tls_validation_callback_data);
+                }
+
+                result = 0;
+            }
         }
         else if (strcmp(OPTION_TLS_VERSION, optionName) == 0)
         {
@@ -2654,6 +3442,94 @@ int tlsio_openssl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, c
         {
             result = 0;
         }
+        else if (strcmp(OPTION_XIO_SEND_QUEUE_LIMITS, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL value for %s", optionName);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* not passed down, the underlying IO has to accept every TLS record */
+                tls_io_instance->send_queue_limits = *(const XIO_SEND_QUEUE_LIMITS*)value;
+                if (tls_io_instance->send_queue_limits.high_water_mark == 0)
+                {
+                    tls_io_instance->send_blocked = false;
+                }
+                result = 0;
+            }
+        }
+        else if (strcmp(OPTION_TLS_RECEIVE_BUFFER_SIZE, optionName) == 0)
+        {
+            if (value == NULL || *(const size_t*)value == 0)
+            {
+                LogError("Invalid value for %s", optionName);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*reallocated at the next decode*/
+                free(tls_io_instance->receive_buffer);
+                tls_io_instance->receive_buffer = NULL;
+                tls_io_instance->receive_buffer_size = *(const size_t*)value;
+                result = 0;
+            }
+        }
+        else if (strcmp(OPTION_TLS_SESSION_RESUMPTION, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL value for %s", optionName);
+                result = __FAILURE__;
+            }
+            else if (!*(const bool*)value)
+            {
+                result = set_session_cache(tls_io_instance, NULL, false);
+            }
+            else if (tls_io_instance->session_cache != NULL)
+            {
+                /*already resuming, through a private or a shared cache*/
+                result = 0;
+            }
+            else
+            {
+                /*a private cache only ever holds the session of this instance*/
+                TLSIO_SESSION_CACHE_HANDLE session_cache = tlsio_openssl_session_cache_create(1);
+                if (session_cache == NULL)
+                {
+                    result = __FAILURE__;
+                }
+                else if (set_session_cache(tls_io_instance, session_cache, true) != 0)
+                {
+                    tlsio_openssl_session_cache_destroy(session_cache);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+            }
+        }
+        else if (strcmp(OPTION_TLS_SESSION_CACHE, optionName) == 0)
+        {
+            result = set_session_cache(tls_io_instance, (TLSIO_SESSION_CACHE_HANDLE)value, false);
+        }
+        else if (strcmp(OPTION_TLS_RECEIVE_BUFFER, optionName) == 0)
+        {
+            const TLSIO_RECEIVE_BUFFER* receive_buffer = (const TLSIO_RECEIVE_BUFFER*)value;
+
+            if (receive_buffer == NULL || (receive_buffer->buffer != NULL && receive_buffer->size == 0))
+            {
+                LogError("Invalid value for %s", optionName);
+                result = __FAILURE__;
+            }
+            else
+            {
+                tls_io_instance->user_receive_buffer = *receive_buffer;
+                result = 0;
+            }
+        }
         else
         {
             if (tls_io_instance->underlying_io == NULL)
@@ -2670,6 +3546,46 @@ int tlsio_openssl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, c
     return result;
 }
 
+int tlsio_openssl_getoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, void* value)
+{
+    int result;
+
+    if (tls_io == NULL || optionName == NULL || value == NULL)
+    {
+        LogError("Bad arguments, tls_io = %p, optionName = %p, value = %p", tls_io, optionName, value);
+        result = __FAILURE__;
+    }
+    else
+    {
+        TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)tls_io;
+
+        if (strcmp(OPTION_TLS_SESSION_CACHE, optionName) == 0)
+        {
+            /*gives access to the hit/miss counters of a private cache too*/
+            if (tls_io_instance->session_cache == NULL)
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                *(TLSIO_SESSION_CACHE_HANDLE*)value = tls_io_instance->session_cache;
+                result = 0;
+            }
+        }
+        else if (tls_io_instance->underlying_io == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* the bytes waiting below are the TLS records, including their framing */
+            result = xio_getoption(tls_io_instance->underlying_io, optionName, value);
+        }
+    }
+
+    return result;
+}
+
 const IO_INTERFACE_DESCRIPTION* tlsio_openssl_get_interface_description(void)
 {
     return &tlsio_openssl_interface_description;
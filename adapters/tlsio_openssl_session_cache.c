@@ -0,0 +1,394 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "shim_openssl.h"
+
+#include "azure_c_shared_utility/tlsio_openssl_session_cache.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+typedef struct TLSIO_SESSION_CACHE_ENTRY_TAG
+{
+    char* key;
+    SSL_SESSION* session;
+} TLSIO_SESSION_CACHE_ENTRY;
+
+typedef struct TLSIO_SESSION_CACHE_TAG
+{
+    LOCK_HANDLE lock;
+    SINGLYLINKEDLIST_HANDLE entries;
+    size_t entry_count;
+    size_t max_entries;
+    size_t hits;
+    size_t misses;
+} TLSIO_SESSION_CACHE;
+
+/*a NULL credential and an empty one hash differently, so do a certificate and a key swapped between the two*/
+static int add_credential_to_digest(SHA256_CTX* sha256_context, const char* credential)
+{
+    int result;
+    unsigned char marker = (credential == NULL) ? 0 : 1;
+    size_t length = (credential == NULL) ? 0 : strlen(credential);
+    unsigned char encoded_length[8];
+    size_t i;
+
+    for (i = 0; i < sizeof(encoded_length); i++)
+    {
+        encoded_length[i] = (unsigned char)(((uint64_t)length >> (8 * i)) & 0xFF);
+    }
+
+    if ((SHA256_Update(sha256_context, &marker, 1) != 1) ||
+        (SHA256_Update(sha256_context, encoded_length, sizeof(encoded_length)) != 1) ||
+        ((length > 0) && (SHA256_Update(sha256_context, credential, length) != 1)))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static bool session_cache_entry_matches(LIST_ITEM_HANDLE list_item, const void* match_context)
+{
+    const TLSIO_SESSION_CACHE_ENTRY* entry = (const TLSIO_SESSION_CACHE_ENTRY*)singlylinkedlist_item_get_value(list_item);
+    return strcmp(entry->key, (const char*)match_context) == 0;
+}
+
+static void destroy_session_cache_entry(TLSIO_SESSION_CACHE_ENTRY* entry)
+{
+    SSL_SESSION_free(entry->session);
+    free(entry->key);
+    free(entry);
+}
+
+TLSIO_SESSION_CACHE_HANDLE tlsio_openssl_session_cache_create(size_t max_entries)
+{
+    TLSIO_SESSION_CACHE* result;
+
+    if (max_entries == 0)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_001: [ If `max_entries` is 0, `tlsio_openssl_session_cache_create` shall fail and return NULL. ]*/
+        LogError("Invalid max_entries 0.");
+        result = NULL;
+    }
+    /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_002: [ `tlsio_openssl_session_cache_create` shall allocate a cache holding at most `max_entries` sessions, together with a lock and an empty list of entries, and return it. ]*/
+    else if ((result = (TLSIO_SESSION_CACHE*)malloc(sizeof(TLSIO_SESSION_CACHE))) == NULL)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_003: [ If any operation fails, `tlsio_openssl_session_cache_create` shall fail and return NULL. ]*/
+        LogError("Failed allocating session cache.");
+    }
+    else if ((result->lock = Lock_Init()) == NULL)
+    {
+        LogError("Failed creating session cache lock.");
+        free(result);
+        result = NULL;
+    }
+    else if ((result->entries = singlylinkedlist_create()) == NULL)
+    {
+        LogError("Failed creating session cache list.");
+        (void)Lock_Deinit(result->lock);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->entry_count = 0;
+        result->max_entries = max_entries;
+        result->hits = 0;
+        result->misses = 0;
+    }
+
+    return result;
+}
+
+void tlsio_openssl_session_cache_destroy(TLSIO_SESSION_CACHE_HANDLE session_cache)
+{
+    if (session_cache == NULL)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_004: [ If `session_cache` is NULL, `tlsio_openssl_session_cache_destroy` shall do nothing. ]*/
+        LogError("NULL session_cache.");
+    }
+    else
+    {
+        LIST_ITEM_HANDLE item;
+
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_005: [ `tlsio_openssl_session_cache_destroy` shall release every cached session with `SSL_SESSION_free` and free the entries, the list, the lock and the cache. ]*/
+        while ((item = singlylinkedlist_get_head_item(session_cache->entries)) != NULL)
+        {
+            TLSIO_SESSION_CACHE_ENTRY* entry = (TLSIO_SESSION_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+            (void)singlylinkedlist_remove(session_cache->entries, item);
+            destroy_session_cache_entry(entry);
+        }
+
+        singlylinkedlist_destroy(session_cache->entries);
+        (void)Lock_Deinit(session_cache->lock);
+        free(session_cache);
+    }
+}
+
+int tlsio_openssl_session_cache_get_statistics(TLSIO_SESSION_CACHE_HANDLE session_cache, size_t* hits, size_t* misses)
+{
+    int result;
+
+    if (session_cache == NULL || hits == NULL || misses == NULL)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_006: [ If any argument is NULL, `tlsio_openssl_session_cache_get_statistics` shall fail and return a non-zero value. ]*/
+        LogError("Bad arguments, session_cache = %p, hits = %p, misses = %p", session_cache, hits, misses);
+        result = __FAILURE__;
+    }
+    else if (Lock(session_cache->lock) != LOCK_OK)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_007: [ If locking the cache fails, `tlsio_openssl_session_cache_get_statistics` shall fail and return a non-zero value. ]*/
+        LogError("Failed locking the session cache.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_008: [ Otherwise `tlsio_openssl_session_cache_get_statistics` shall fill `hits` and `misses` with the counters kept by `tlsio_openssl_session_cache_count_handshake` and return 0. ]*/
+        *hits = session_cache->hits;
+        *misses = session_cache->misses;
+        (void)Unlock(session_cache->lock);
+        result = 0;
+    }
+
+    return result;
+}
+
+/*a session is only resumed by a connection to the same host that presents the same client certificate and key,
+otherwise a connection could be taken by the server for the device that created the session*/
+char* tlsio_openssl_session_cache_build_key(const char* hostname, int port, const char* x509_certificate, const char* x509_private_key)
+{
+    char* result;
+    SHA256_CTX sha256_context;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+
+    if (hostname == NULL)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_009: [ If `hostname` is NULL, `tlsio_openssl_session_cache_build_key` shall fail and return NULL. ]*/
+        LogError("NULL hostname.");
+        result = NULL;
+    }
+    /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_010: [ The client identity shall be reduced to a SHA-256 digest of `x509_certificate` and `x509_private_key` computed with `SHA256_Init`, `SHA256_Update` and `SHA256_Final`, so that the key material itself is never kept in the cache. ]*/
+    else if ((SHA256_Init(&sha256_context) != 1) ||
+        (add_credential_to_digest(&sha256_context, x509_certificate) != 0) ||
+        (add_credential_to_digest(&sha256_context, x509_private_key) != 0) ||
+        (SHA256_Final(digest, &sha256_context) != 1))
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_012: [ If any operation fails, `tlsio_openssl_session_cache_build_key` shall fail and return NULL. ]*/
+        LogError("Failed hashing the client identity.");
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_011: [ `tlsio_openssl_session_cache_build_key` shall return a newly allocated string made of `hostname`, `port` and the hexadecimal digest, separated by `:`. ]*/
+        size_t hostname_length = strlen(hostname);
+        /*hostname, ':', up to 11 characters of port, ':', the digest in hex and the terminator*/
+        size_t key_size = hostname_length + 1 + 11 + 1 + (2 * SHA256_DIGEST_LENGTH) + 1;
+
+        if ((result = (char*)malloc(key_size)) == NULL)
+        {
+            LogError("Failed allocating session cache key.");
+        }
+        else
+        {
+            int written = snprintf(result, key_size, "%s:%d:", hostname, port);
+            if ((written < 0) || ((size_t)written + (2 * SHA256_DIGEST_LENGTH) >= key_size))
+            {
+                LogError("Failed formatting session cache key.");
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                static const char hex_digits[] = "0123456789abcdef";
+                size_t i;
+
+                for (i = 0; i < SHA256_DIGEST_LENGTH; i++)
+                {
+                    result[written + (2 * i)] = hex_digits[digest[i] >> 4];
+                    result[written + (2 * i) + 1] = hex_digits[digest[i] & 0x0F];
+                }
+
+                result[written + (2 * SHA256_DIGEST_LENGTH)] = '\0';
+            }
+        }
+    }
+
+    return result;
+}
+
+/*on success the cache takes over the reference the caller holds on session*/
+int tlsio_openssl_session_cache_store(TLSIO_SESSION_CACHE_HANDLE session_cache, const char* key, SSL_SESSION* session)
+{
+    int result;
+    LIST_ITEM_HANDLE item;
+
+    if ((session_cache == NULL) || (key == NULL) || (session == NULL))
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_013: [ If any argument is NULL, `tlsio_openssl_session_cache_store` shall fail and return a non-zero value. ]*/
+        LogError("Bad arguments, session_cache = %p, key = %p, session = %p", session_cache, key, session);
+        result = __FAILURE__;
+    }
+    else if (Lock(session_cache->lock) != LOCK_OK)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_018: [ If any operation fails, `tlsio_openssl_session_cache_store` shall fail, return a non-zero value and leave the reference on `session` to the caller. ]*/
+        LogError("Failed locking the session cache.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if ((item = singlylinkedlist_find(session_cache->entries, session_cache_entry_matches, key)) != NULL)
+        {
+            /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_014: [ If an entry with `key` exists, its session shall be released with `SSL_SESSION_free` and replaced by `session`. ]*/
+            TLSIO_SESSION_CACHE_ENTRY* entry = (TLSIO_SESSION_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+            SSL_SESSION_free(entry->session);
+            entry->session = session;
+            result = 0;
+        }
+        else
+        {
+            /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_015: [ Otherwise a new entry holding a copy of `key` and `session` shall be added to the cache. ]*/
+            TLSIO_SESSION_CACHE_ENTRY* entry = (TLSIO_SESSION_CACHE_ENTRY*)malloc(sizeof(TLSIO_SESSION_CACHE_ENTRY));
+            if (entry == NULL)
+            {
+                LogError("Failed allocating session cache entry.");
+                result = __FAILURE__;
+            }
+            else if (mallocAndStrcpy_s(&entry->key, key) != 0)
+            {
+                LogError("Failed copying session cache key.");
+                free(entry);
+                result = __FAILURE__;
+            }
+            else
+            {
+                entry->session = session;
+
+                /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_016: [ If the cache already holds `max_entries` entries, the oldest entry shall be removed and its session released with `SSL_SESSION_free` before the new entry is added. ]*/
+                if (session_cache->entry_count >= session_cache->max_entries &&
+                    (item = singlylinkedlist_get_head_item(session_cache->entries)) != NULL)
+                {
+                    TLSIO_SESSION_CACHE_ENTRY* oldest = (TLSIO_SESSION_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+                    (void)singlylinkedlist_remove(session_cache->entries, item);
+                    destroy_session_cache_entry(oldest);
+                    session_cache->entry_count--;
+                }
+
+                if (singlylinkedlist_add(session_cache->entries, entry) == NULL)
+                {
+                    LogError("Failed adding session cache entry.");
+                    free(entry->key);
+                    free(entry);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    session_cache->entry_count++;
+                    result = 0;
+                }
+            }
+        }
+
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_017: [ The cache shall be locked while the entries are inspected and changed. ]*/
+        (void)Unlock(session_cache->lock);
+    }
+
+    return result;
+}
+
+void tlsio_openssl_session_cache_remove(TLSIO_SESSION_CACHE_HANDLE session_cache, const char* key)
+{
+    if ((session_cache == NULL) || (key == NULL))
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_019: [ If `session_cache` or `key` is NULL, `tlsio_openssl_session_cache_remove` shall do nothing. ]*/
+        LogError("Bad arguments, session_cache = %p, key = %p", session_cache, key);
+    }
+    else if (Lock(session_cache->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the session cache.");
+    }
+    else
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_020: [ `tlsio_openssl_session_cache_remove` shall remove the entry with `key`, if any, and release its session with `SSL_SESSION_free`. ]*/
+        LIST_ITEM_HANDLE item = singlylinkedlist_find(session_cache->entries, session_cache_entry_matches, key);
+        if (item != NULL)
+        {
+            TLSIO_SESSION_CACHE_ENTRY* entry = (TLSIO_SESSION_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+            (void)singlylinkedlist_remove(session_cache->entries, item);
+            destroy_session_cache_entry(entry);
+            session_cache->entry_count--;
+        }
+
+        (void)Unlock(session_cache->lock);
+    }
+}
+
+void tlsio_openssl_session_cache_apply(TLSIO_SESSION_CACHE_HANDLE session_cache, const char* key, SSL* ssl)
+{
+    if ((session_cache == NULL) || (key == NULL) || (ssl == NULL))
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_021: [ If any argument is NULL, `tlsio_openssl_session_cache_apply` shall do nothing. ]*/
+        LogError("Bad arguments, session_cache = %p, key = %p, ssl = %p", session_cache, key, ssl);
+    }
+    else if (Lock(session_cache->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the session cache.");
+    }
+    else
+    {
+        LIST_ITEM_HANDLE item = singlylinkedlist_find(session_cache->entries, session_cache_entry_matches, key);
+        if (item != NULL)
+        {
+            /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_022: [ If an entry with `key` exists, `tlsio_openssl_session_cache_apply` shall offer its session on `ssl` by calling `SSL_set_session`. ]*/
+            /*SSL_set_session takes its own reference, the entry can be replaced while the handshake runs*/
+            const TLSIO_SESSION_CACHE_ENTRY* entry = (const TLSIO_SESSION_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+            if (SSL_set_session(ssl, entry->session) != 1)
+            {
+                /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_023: [ If `SSL_set_session` fails, the handshake shall simply be a full one. ]*/
+                LogError("Failed SSL_set_session, doing a full handshake.");
+            }
+        }
+
+        (void)Unlock(session_cache->lock);
+    }
+}
+
+void tlsio_openssl_session_cache_count_handshake(TLSIO_SESSION_CACHE_HANDLE session_cache, bool resumed)
+{
+    if (session_cache == NULL)
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_024: [ If `session_cache` is NULL, `tlsio_openssl_session_cache_count_handshake` shall do nothing. ]*/
+        LogError("NULL session_cache.");
+    }
+    else if (Lock(session_cache->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the session cache.");
+    }
+    else
+    {
+        /* Codes_SRS_TLSIO_OPENSSL_SESSION_CACHE_01_025: [ `tlsio_openssl_session_cache_count_handshake` shall count a hit when `resumed` is true and a miss otherwise. ]*/
+        if (resumed)
+        {
+            session_cache->hits++;
+        }
+        else
+        {
+            session_cache->misses++;
+        }
+
+        (void)Unlock(session_cache->lock);
+    }
+}
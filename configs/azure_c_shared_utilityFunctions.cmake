@@ -559,6 +559,7 @@ function(set_platform_files c_shared_dir)
         else()
             set(UNIQUEID_C_FILE ${c_shared_dir}/adapters/uniqueid_win32.c PARENT_SCOPE)
         endif()
+        set(RANDOM_SOURCE_C_FILE ${c_shared_dir}/adapters/random_source_win32.c PARENT_SCOPE)
     else()
         set(XLOGGING_C_FILE ${c_shared_dir}/src/xlogging.c PARENT_SCOPE)
         set(LOGGING_C_FILE ${c_shared_dir}/src/consolelogger.c PARENT_SCOPE)
@@ -581,6 +582,9 @@ function(set_platform_files c_shared_dir)
         endif()
         if (${use_socketio})
             set(SOCKETIO_C_FILE ${c_shared_dir}/adapters/socketio_berkeley.c PARENT_SCOPE)
+            if (NOT APPLE)
+                set(SOCKETIO_REACTOR_C_FILE ${c_shared_dir}/adapters/socketio_reactor_epoll.c PARENT_SCOPE)
+            endif()
         endif()
         set(THREAD_C_FILE ${c_shared_dir}/adapters/threadapi_pthreads.c PARENT_SCOPE)
         set(TICKCOUTER_C_FILE ${c_shared_dir}/adapters/tickcounter_linux.c PARENT_SCOPE)
@@ -589,6 +593,7 @@ function(set_platform_files c_shared_dir)
         else()
             set(UNIQUEID_C_FILE ${c_shared_dir}/adapters/uniqueid_linux.c PARENT_SCOPE)
         endif()
+        set(RANDOM_SOURCE_C_FILE ${c_shared_dir}/adapters/random_source_linux.c PARENT_SCOPE)
     endif()
     
     if(WIN32 OR MACOSX OR LINUX)
@@ -34,6 +34,9 @@ MOCKABLE_FUNCTION(, int, BUFFER_fill, BUFFER_HANDLE, handle, unsigned char, fill
 MOCKABLE_FUNCTION(, unsigned char*, BUFFER_u_char, BUFFER_HANDLE, handle);
 MOCKABLE_FUNCTION(, size_t, BUFFER_length, BUFFER_HANDLE, handle);
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, BUFFER_clone, BUFFER_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, BUFFER_reserve, BUFFER_HANDLE, handle, size_t, capacity);
+MOCKABLE_FUNCTION(, size_t, BUFFER_capacity, BUFFER_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, BUFFER_shrink_to_fit, BUFFER_HANDLE, handle);
 
 #ifdef __cplusplus
 }
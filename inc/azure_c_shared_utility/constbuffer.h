@@ -26,12 +26,24 @@ typedef struct CONSTBUFFER_TAG
     size_t size;
 } CONSTBUFFER;
 
+/*called with the context given at creation when a const buffer created by CONSTBUFFER_CreateWithCustomFree is destroyed*/
+typedef void(*CONSTBUFFER_CUSTOM_FREE_FUNC)(void* context);
+
 /*this creates a new constbuffer from a memory area*/
 MOCKABLE_FUNCTION(, CONSTBUFFER_HANDLE, CONSTBUFFER_Create, const unsigned char*, source, size_t, size);
 
 /*this creates a new constbuffer from an existing BUFFER_HANDLE*/
 MOCKABLE_FUNCTION(, CONSTBUFFER_HANDLE, CONSTBUFFER_CreateFromBuffer, BUFFER_HANDLE, buffer);
 
+/*this creates a new constbuffer that takes ownership of source (which must have been allocated with malloc), without copying it*/
+MOCKABLE_FUNCTION(, CONSTBUFFER_HANDLE, CONSTBUFFER_CreateWithMoveMemory, unsigned char*, source, size_t, size);
+
+/*this creates a new constbuffer that points at source without copying it; customFreeFunc is called when the constbuffer is destroyed*/
+MOCKABLE_FUNCTION(, CONSTBUFFER_HANDLE, CONSTBUFFER_CreateWithCustomFree, const unsigned char*, source, size_t, size, CONSTBUFFER_CUSTOM_FREE_FUNC, customFreeFunc, void*, customFreeFuncContext);
+
+/*this creates a new constbuffer that shares a range of the storage of an existing constbuffer, keeping it alive*/
+MOCKABLE_FUNCTION(, CONSTBUFFER_HANDLE, CONSTBUFFER_CreateFromOffsetAndSize, CONSTBUFFER_HANDLE, handle, size_t, offset, size_t, size);
+
 MOCKABLE_FUNCTION(, CONSTBUFFER_HANDLE, CONSTBUFFER_Clone, CONSTBUFFER_HANDLE, constbufferHandle);
 
 MOCKABLE_FUNCTION(, const CONSTBUFFER*, CONSTBUFFER_GetContent, CONSTBUFFER_HANDLE, constbufferHandle);
@@ -7,11 +7,17 @@
 #include "azure_c_shared_utility/umock_c_prod.h"
 
 #ifdef __cplusplus
+#include <cstddef>
 extern "C" {
+#else
+#include <stddef.h>
 #endif
 
 MOCKABLE_FUNCTION(, int, gb_rand);
 
+/*fills buffer with size bytes from the platform cryptographic generator (rand_s, arc4random_buf or getrandom), returns 0 on success*/
+MOCKABLE_FUNCTION(, int, gb_rand_bytes, unsigned char*, buffer, size_t, size);
+
 #ifdef __cplusplus
 }
 #endif
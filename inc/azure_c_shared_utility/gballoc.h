@@ -5,6 +5,7 @@
 #define GBALLOC_H
 
 #include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/macro_utils.h"
 
 #ifdef __cplusplus
 #include <cstddef>
@@ -16,6 +17,33 @@ extern "C"
 #include <stdlib.h>
 #endif
 
+#ifndef GBALLOC_SIZE_HISTOGRAM_BUCKETS
+#define GBALLOC_SIZE_HISTOGRAM_BUCKETS 12
+#endif
+
+#define GBALLOC_SITE_ORDER_VALUES \
+    GBALLOC_SITE_ORDER_BY_LIVE_BYTES, \
+    GBALLOC_SITE_ORDER_BY_ALLOCATIONS
+
+DEFINE_ENUM(GBALLOC_SITE_ORDER, GBALLOC_SITE_ORDER_VALUES);
+
+/* what GB_TRACK_ALLOCATION_SITES records for one malloc/calloc/realloc call site.
+Lifetimes are measured in allocations made by the whole process between the allocation and the free of a block. */
+typedef struct GBALLOC_SITE_STATS_TAG
+{
+    const char* file;
+    int line;
+    /*allocations made at the site since gballoc_init or the last gballoc_resetMetrics*/
+    size_t allocations;
+    size_t live_blocks;
+    size_t live_bytes;
+    /*allocations counted by size: bucket 0 holds sizes up to 16 bytes, each next bucket doubles the limit, the last one holds the rest*/
+    size_t size_histogram[GBALLOC_SIZE_HISTOGRAM_BUCKETS];
+    size_t freed_blocks;
+    size_t average_lifetime;
+    size_t max_lifetime;
+} GBALLOC_SITE_STATS;
+
 // GB_USE_CUSTOM_HEAP disables the implementations in gballoc.c and
 // requires that an external library implement the gballoc_malloc family
 // declared here.
@@ -46,6 +74,12 @@ MOCKABLE_FUNCTION(, size_t, gballoc_getCurrentMemoryUsed);
 MOCKABLE_FUNCTION(, size_t, gballoc_getAllocationCount);
 MOCKABLE_FUNCTION(, void, gballoc_resetMetrics);
 
+MOCKABLE_FUNCTION(, void*, gballoc_malloc_at, size_t, size, const char*, file, int, line);
+MOCKABLE_FUNCTION(, void*, gballoc_calloc_at, size_t, nmemb, size_t, size, const char*, file, int, line);
+MOCKABLE_FUNCTION(, void*, gballoc_realloc_at, void*, ptr, size_t, size, const char*, file, int, line);
+MOCKABLE_FUNCTION(, size_t, gballoc_getTopAllocationSites, GBALLOC_SITE_ORDER, order, GBALLOC_SITE_STATS*, sites, size_t, site_count);
+MOCKABLE_FUNCTION(, void, gballoc_logTopAllocationSites, GBALLOC_SITE_ORDER, order, size_t, site_count);
+
 /* if GB_MEASURE_MEMORY_FOR_THIS is defined then we want to redirect memory allocation functions to gballoc_xxx functions */
 #ifdef GB_MEASURE_MEMORY_FOR_THIS
 /* Unfortunately this is still needed here for things to still compile when using _CRTDBG_MAP_ALLOC.
@@ -59,6 +93,12 @@ That is because there is a rogue component (most likely CppUnitTest) including c
 #define _calloc_dbg(nmemb, size, ...) gballoc_calloc(nmemb, size)
 #define _realloc_dbg(ptr, size, ...) gballoc_realloc(ptr, size)
 #define _free_dbg(ptr, ...) gballoc_free(ptr)
+#elif defined(GB_TRACK_ALLOCATION_SITES)
+/* GB_TRACK_ALLOCATION_SITES records the file and line of every call in gballoc */
+#define malloc(size) gballoc_malloc_at(size, __FILE__, __LINE__)
+#define calloc(nmemb, size) gballoc_calloc_at(nmemb, size, __FILE__, __LINE__)
+#define realloc(ptr, size) gballoc_realloc_at(ptr, size, __FILE__, __LINE__)
+#define free gballoc_free
 #else
 #define malloc gballoc_malloc
 #define calloc gballoc_calloc
@@ -76,6 +116,8 @@ That is because there is a rogue component (most likely CppUnitTest) including c
 #define gballoc_getCurrentMemoryUsed() SIZE_MAX
 #define gballoc_getAllocationCount() SIZE_MAX
 #define gballoc_resetMetrics() ((void)0)
+#define gballoc_getTopAllocationSites(order, sites, site_count) ((void)(order), (void)(sites), (void)(site_count), (size_t)0)
+#define gballoc_logTopAllocationSites(order, site_count) ((void)(order), (void)(site_count))
 
 #endif /* GB_DEBUG_ALLOC */
 
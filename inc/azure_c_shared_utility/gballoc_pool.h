@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef GBALLOC_POOL_H
+#define GBALLOC_POOL_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#endif
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/* When GB_USE_POOL_HEAP is defined (CMake option use_pool_heap), gballoc_pool.c implements the gballoc_malloc family
+required by GB_USE_CUSTOM_HEAP: small requests are served from per size class slabs through per thread caches, larger
+ones go straight to malloc. The functions below report how each size class is used. */
+
+typedef struct GBALLOC_POOL_CLASS_STATS_TAG
+{
+    /*largest request served by the class, 0 for the row reporting the requests too large for any class*/
+    size_t block_size;
+    /*allocations served from the calling thread's cache*/
+    size_t hits;
+    /*allocations that had to go to the shared list of the class (or to malloc for large requests)*/
+    size_t misses;
+    size_t blocks_in_use;
+    /*bytes requested by the callers for the blocks in use*/
+    size_t bytes_in_use;
+    /*bytes taken from the system for the class, bytes_reserved - bytes_in_use is what the pool holds but does not use*/
+    size_t bytes_reserved;
+} GBALLOC_POOL_CLASS_STATS;
+
+/*returns the number of size classes, 0 when the pool allocator is not built in*/
+MOCKABLE_FUNCTION(, size_t, gballoc_pool_get_class_count);
+
+/*fills stats for the size class class_index; class_index equal to the class count reports the requests too large for any class*/
+MOCKABLE_FUNCTION(, int, gballoc_pool_get_class_stats, size_t, class_index, GBALLOC_POOL_CLASS_STATS*, stats);
+
+/*returns the blocks cached by the calling thread to the shared lists and publishes its counters; this also happens when a thread that used the pool exits*/
+MOCKABLE_FUNCTION(, void, gballoc_pool_flush_thread_cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GBALLOC_POOL_H */
@@ -15,6 +15,12 @@
 *				  of all the headers  
 *				- ::HTTPHeaders_GetHeader - when the application needs to retrieve the
 *				  <code>name + ": " + value</code> string based on an index.
+*				- ::HTTPHeaders_GetHeaderSpan - same as ::HTTPHeaders_GetHeader but without
+*				  copying the header out of the collection.
+*				- ::HTTPHeaders_Serialize - when the application needs all the headers
+*				  written in a single buffer.
+*
+*			 Header names are compared case insensitive.
 */
 
 #ifndef HTTPHEADERS_H
@@ -44,6 +50,19 @@ HTTP_HEADERS_ERROR                \
 DEFINE_ENUM(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 typedef struct HTTP_HEADERS_HANDLE_DATA_TAG* HTTP_HEADERS_HANDLE;
 
+/** @brief A header as stored in the collection. None of the strings are owned by the
+*		   caller and they are only valid until the collection is next modified or freed.
+*/
+typedef struct HTTP_HEADER_SPAN_TAG
+{
+    const char* name;       /**< The header name, not '\0' terminated. */
+    size_t nameLength;
+    const char* value;      /**< The header value, '\0' terminated. */
+    size_t valueLength;
+    const char* line;       /**< The <code>name + ": " + value</code> string, '\0' terminated. */
+    size_t lineLength;
+} HTTP_HEADER_SPAN;
+
 /**
  * @brief	Produces a @c HTTP_HANDLE that can later be used in subsequent calls to the module.
  * 			
@@ -138,6 +157,39 @@ MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeaderCount, HTTP_HEADER
  */
 MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeader, HTTP_HEADERS_HANDLE, handle, size_t, index, char**, destination);
 
+/**
+ * @brief	This API retrieves the header element at the given @p index without
+ * 			allocating memory.
+ *
+ * @param	handle			A valid @c HTTP_HEADERS_HANDLE value.
+ * @param	index			Zero-based index of the item in the
+ * 							headers collection.
+ * @param   header			The name, value and <code>name + ": " + value</code>
+ * 							line of the header are written here. They point inside
+ * 							the collection and must not be freed.
+ *
+ * @return	Returns @c HTTP_HEADERS_OK when execution is successful or
+ * 			@c HTTP_HEADERS_INVALID_ARG when an argument is not valid.
+ */
+MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeaderSpan, HTTP_HEADERS_HANDLE, handle, size_t, index, HTTP_HEADER_SPAN*, header);
+
+/**
+ * @brief	This API writes all the headers as <code>name + ": " + value + "\r\n"</code>
+ * 			into @p destination, in the order they were added.
+ *
+ * @param	handle			A valid @c HTTP_HEADERS_HANDLE value.
+ * @param	destination		The buffer receiving the headers. No '\0' is appended.
+ * 							Can be @c NULL when @p destinationSize is @c 0.
+ * @param	destinationSize	The size of @p destination in bytes.
+ * @param	serializedSize	Receives the number of bytes that all the headers need,
+ * 							also when @p destination is too small.
+ *
+ * @return	Returns @c HTTP_HEADERS_OK when execution is successful,
+ * 			@c HTTP_HEADERS_INSUFFICIENT_BUFFER when @p destinationSize is smaller
+ * 			than @p serializedSize or @c HTTP_HEADERS_INVALID_ARG.
+ */
+MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_Serialize, HTTP_HEADERS_HANDLE, handle, char*, destination, size_t, destinationSize, size_t*, serializedSize);
+
 /**
  * @brief	This API produces a clone of the @p handle parameter.
  *
@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef RANDOM_SOURCE_H
+#define RANDOM_SOURCE_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/*fills buffer with size bytes from the platform cryptographic generator, returns 0 on success; implemented by adapters/random_source_*.c*/
+MOCKABLE_FUNCTION(, int, random_source_fill, unsigned char*, buffer, size_t, size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RANDOM_SOURCE_H */
@@ -7,8 +7,11 @@
 #include "azure_c_shared_utility/const_defines.h"
 
 #ifdef __cplusplus
+#include <cstddef>
 extern "C"
 {
+#else
+#include <stddef.h>
 #endif
 
     typedef struct HTTP_PROXY_OPTIONS_TAG
@@ -41,6 +44,29 @@ extern "C"
 
     static STATIC_VAR_UNUSED const char* const OPTION_NET_INT_MAC_ADDRESS = "net_interface_mac_address";
 
+    /*value is a SOCKETIO_REACTOR_HANDLE (see socketio_reactor.h)*/
+    static STATIC_VAR_UNUSED const char* const OPTION_SOCKETIO_REACTOR = "socketio_reactor";
+
+    /*value is a size_t*, the most bytes read by a single recv and handed to on_bytes_received when not batching (default RECEIVE_BYTES_VALUE)*/
+    static STATIC_VAR_UNUSED const char* const OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE = "socketio_receive_chunk_size";
+    /*value is a size_t*, the number of chunks gathered before on_bytes_received is called, each recv then reads into all the space left (default 1)*/
+    static STATIC_VAR_UNUSED const char* const OPTION_SOCKETIO_RECEIVE_BATCH_COUNT = "socketio_receive_batch_count";
+    /*value is an int*, passed to setsockopt SO_RCVBUF / SO_SNDBUF*/
+    static STATIC_VAR_UNUSED const char* const OPTION_SOCKETIO_SO_RCVBUF = "socketio_so_rcvbuf";
+    static STATIC_VAR_UNUSED const char* const OPTION_SOCKETIO_SO_SNDBUF = "socketio_so_sndbuf";
+
+    /*xio_getoption, value is a size_t*: bytes handed to xio_send whose send has not completed yet*/
+    static STATIC_VAR_UNUSED const char* const OPTION_XIO_OUTSTANDING_BYTES = "xio_outstanding_bytes";
+    /*xio_getoption, value is a size_t*: sends whose on_send_complete has not been called yet*/
+    static STATIC_VAR_UNUSED const char* const OPTION_XIO_OUTSTANDING_ITEMS = "xio_outstanding_items";
+    /*xio_setoption, value is an XIO_SEND_QUEUE_LIMITS* (see xio.h)*/
+    static STATIC_VAR_UNUSED const char* const OPTION_XIO_SEND_QUEUE_LIMITS = "xio_send_queue_limits";
+
+    /*value is a size_t*, the largest message uws_client reassembles before failing the connection with 1009 (0, the default, means no limit). Messages indicated through uws_client_set_fragment_received_callback are not limited*/
+    static STATIC_VAR_UNUSED const char* const OPTION_WS_MAX_MESSAGE_SIZE = "ws_max_message_size";
+    /*value is a WS_PERMESSAGE_DEFLATE_CONFIG* (see uws_permessage_deflate.h), offers the RFC 7692 permessage-deflate extension on the next uws_client open. Only available when built with use_ws_permessage_deflate*/
+    static STATIC_VAR_UNUSED const char* const OPTION_WS_PERMESSAGE_DEFLATE = "ws_permessage_deflate";
+
     static STATIC_VAR_UNUSED const char* const OPTION_TLS_VERSION = "tls_version";
 
     typedef enum TLSIO_VERSION_TAG
@@ -50,6 +76,22 @@ extern "C"
         OPTION_TLS_VERSION_1_2,
     } TLSIO_VERSION;
 
+    /*value is a size_t*, the most plaintext bytes handed to a single on_bytes_received call (tlsio_openssl, default 16384)*/
+    static STATIC_VAR_UNUSED const char* const OPTION_TLS_RECEIVE_BUFFER_SIZE = "tls_receive_buffer_size";
+    /*value is a TLSIO_RECEIVE_BUFFER*, caller owned storage that decrypted bytes are read into (tlsio_openssl), a NULL buffer reverts to the internal one*/
+    static STATIC_VAR_UNUSED const char* const OPTION_TLS_RECEIVE_BUFFER = "tls_receive_buffer";
+
+    /*value is a bool*, keeps the last TLS session of this instance so that reconnects resume it (tlsio_openssl)*/
+    static STATIC_VAR_UNUSED const char* const OPTION_TLS_SESSION_RESUMPTION = "tls_session_resumption";
+    /*value is a TLSIO_SESSION_CACHE_HANDLE shared by several instances (tlsio_openssl.h), NULL detaches it*/
+    static STATIC_VAR_UNUSED const char* const OPTION_TLS_SESSION_CACHE = "tls_session_cache";
+
+    typedef struct TLSIO_RECEIVE_BUFFER_TAG
+    {
+        unsigned char* buffer;
+        size_t size;
+    } TLSIO_RECEIVE_BUFFER;
+
 #ifdef __cplusplus
 }
 #endif
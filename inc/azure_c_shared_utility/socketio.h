@@ -31,6 +31,10 @@ MOCKABLE_FUNCTION(, int, socketio_close, CONCRETE_IO_HANDLE, socket_io, ON_IO_CL
 MOCKABLE_FUNCTION(, int, socketio_send, CONCRETE_IO_HANDLE, socket_io, const void*, buffer, size_t, size, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, void, socketio_dowork, CONCRETE_IO_HANDLE, socket_io);
 MOCKABLE_FUNCTION(, int, socketio_setoption, CONCRETE_IO_HANDLE, socket_io, const char*, optionName, const void*, value);
+/*socketio_berkeley only, other socketio implementations leave concrete_io_send_vectored NULL*/
+MOCKABLE_FUNCTION(, int, socketio_send_vectored, CONCRETE_IO_HANDLE, socket_io, const XIO_IOVEC*, iov, size_t, iov_count, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
+/*socketio_berkeley only, other socketio implementations leave concrete_io_getoption NULL*/
+MOCKABLE_FUNCTION(, int, socketio_getoption, CONCRETE_IO_HANDLE, socket_io, const char*, optionName, void*, value);
 
 MOCKABLE_FUNCTION(, const IO_INTERFACE_DESCRIPTION*, socketio_get_interface_description);
 
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef SOCKETIO_REACTOR_H
+#define SOCKETIO_REACTOR_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/* A socketio reactor lets one thread serve many socketio instances: instead of calling xio_dowork on every connection
+(one recv and possibly one send syscall per connection per call), the instances are attached to a reactor with the
+OPTION_SOCKETIO_REACTOR option and socketio_reactor_run_once/socketio_reactor_run wait for readiness and only do work
+on the sockets that are readable or writable. xio_dowork on an attached socketio does not touch the socket, so the
+layers stacked on top of it (tlsio, wsio, ...) can keep calling it for their own timers.
+
+A reactor and the instances attached to it shall be used from a single thread, only socketio_reactor_stop can be
+called from another thread. It is only available on Linux (epoll). */
+
+#define SOCKETIO_REACTOR_EVENT_READ     0x01
+#define SOCKETIO_REACTOR_EVENT_WRITE    0x02
+#define SOCKETIO_REACTOR_EVENT_ERROR    0x04
+
+typedef struct SOCKETIO_REACTOR_TAG* SOCKETIO_REACTOR_HANDLE;
+typedef struct SOCKETIO_REACTOR_REGISTRATION_TAG* SOCKETIO_REACTOR_REGISTRATION_HANDLE;
+
+typedef void(*ON_SOCKETIO_REACTOR_EVENT)(void* context, unsigned int events);
+
+MOCKABLE_FUNCTION(, SOCKETIO_REACTOR_HANDLE, socketio_reactor_create);
+MOCKABLE_FUNCTION(, void, socketio_reactor_destroy, SOCKETIO_REACTOR_HANDLE, reactor);
+
+/*waits up to timeout_ms milliseconds (-1 waits forever) for ready sockets and dispatches their events*/
+MOCKABLE_FUNCTION(, int, socketio_reactor_run_once, SOCKETIO_REACTOR_HANDLE, reactor, int, timeout_ms);
+/*dispatches events until socketio_reactor_stop is called*/
+MOCKABLE_FUNCTION(, int, socketio_reactor_run, SOCKETIO_REACTOR_HANDLE, reactor);
+MOCKABLE_FUNCTION(, int, socketio_reactor_stop, SOCKETIO_REACTOR_HANDLE, reactor);
+
+/*used by the IO adapters to hook their sockets into the reactor*/
+MOCKABLE_FUNCTION(, SOCKETIO_REACTOR_REGISTRATION_HANDLE, socketio_reactor_register, SOCKETIO_REACTOR_HANDLE, reactor, int, fd, ON_SOCKETIO_REACTOR_EVENT, on_event, void*, on_event_context);
+MOCKABLE_FUNCTION(, int, socketio_reactor_set_write_interest, SOCKETIO_REACTOR_REGISTRATION_HANDLE, registration, bool, enabled);
+MOCKABLE_FUNCTION(, void, socketio_reactor_unregister, SOCKETIO_REACTOR_REGISTRATION_HANDLE, registration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOCKETIO_REACTOR_H */
@@ -14,6 +14,15 @@ extern "C" {
 #include <stddef.h>
 #endif /* __cplusplus */
 
+/*TLS session cache, shared by the instances it is set on with OPTION_TLS_SESSION_CACHE. Sessions are keyed by hostname:port and a SHA-256 digest of the x509 client certificate and key, so instances with different identities never resume each other's sessions.
+The cache is owned by the caller and has to outlive every instance it is set on.*/
+typedef struct TLSIO_SESSION_CACHE_TAG* TLSIO_SESSION_CACHE_HANDLE;
+
+MOCKABLE_FUNCTION(, TLSIO_SESSION_CACHE_HANDLE, tlsio_openssl_session_cache_create, size_t, max_entries);
+MOCKABLE_FUNCTION(, void, tlsio_openssl_session_cache_destroy, TLSIO_SESSION_CACHE_HANDLE, session_cache);
+/*hits are handshakes that resumed a cached session, misses are full handshakes done while the cache was set*/
+MOCKABLE_FUNCTION(, int, tlsio_openssl_session_cache_get_statistics, TLSIO_SESSION_CACHE_HANDLE, session_cache, size_t*, hits, size_t*, misses);
+
 MOCKABLE_FUNCTION(, int, tlsio_openssl_init);
 MOCKABLE_FUNCTION(, void, tlsio_openssl_deinit);
 
@@ -22,8 +31,11 @@ MOCKABLE_FUNCTION(, void, tlsio_openssl_destroy, CONCRETE_IO_HANDLE, tls_io);
 MOCKABLE_FUNCTION(, int, tlsio_openssl_open, CONCRETE_IO_HANDLE, tls_io, ON_IO_OPEN_COMPLETE, on_io_open_complete, void*, on_io_open_complete_context, ON_BYTES_RECEIVED, on_bytes_received, void*, on_bytes_received_context, ON_IO_ERROR, on_io_error, void*, on_io_error_context);
 MOCKABLE_FUNCTION(, int, tlsio_openssl_close, CONCRETE_IO_HANDLE, tls_io, ON_IO_CLOSE_COMPLETE, on_io_close_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, int, tlsio_openssl_send, CONCRETE_IO_HANDLE, tls_io, const void*, buffer, size_t, size, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
+MOCKABLE_FUNCTION(, int, tlsio_openssl_send_vectored, CONCRETE_IO_HANDLE, tls_io, const XIO_IOVEC*, iov, size_t, iov_count, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, void, tlsio_openssl_dowork, CONCRETE_IO_HANDLE, tls_io);
+/*open instances with the same configuration share one SSL_CTX, so TrustedCerts, tls_validation_callback and tls_validation_callback_data fail on an open instance whose context is shared*/
 MOCKABLE_FUNCTION(, int, tlsio_openssl_setoption, CONCRETE_IO_HANDLE, tls_io, const char*, optionName, const void*, value);
+MOCKABLE_FUNCTION(, int, tlsio_openssl_getoption, CONCRETE_IO_HANDLE, tls_io, const char*, optionName, void*, value);
 
 MOCKABLE_FUNCTION(, const IO_INTERFACE_DESCRIPTION*, tlsio_openssl_get_interface_description);
 
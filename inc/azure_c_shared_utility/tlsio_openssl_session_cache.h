@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef TLSIO_OPENSSL_SESSION_CACHE_H
+#define TLSIO_OPENSSL_SESSION_CACHE_H
+
+#include "openssl/ssl.h"
+#include "azure_c_shared_utility/tlsio_openssl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#include <cstdbool>
+#else
+#include <stdbool.h>
+#endif
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/*used by tlsio_openssl, the cache itself is created and destroyed with tlsio_openssl_session_cache_create/tlsio_openssl_session_cache_destroy*/
+MOCKABLE_FUNCTION(, char*, tlsio_openssl_session_cache_build_key, const char*, hostname, int, port, const char*, x509_certificate, const char*, x509_private_key);
+MOCKABLE_FUNCTION(, int, tlsio_openssl_session_cache_store, TLSIO_SESSION_CACHE_HANDLE, session_cache, const char*, key, SSL_SESSION*, session);
+MOCKABLE_FUNCTION(, void, tlsio_openssl_session_cache_remove, TLSIO_SESSION_CACHE_HANDLE, session_cache, const char*, key);
+MOCKABLE_FUNCTION(, void, tlsio_openssl_session_cache_apply, TLSIO_SESSION_CACHE_HANDLE, session_cache, const char*, key, SSL*, ssl);
+MOCKABLE_FUNCTION(, void, tlsio_openssl_session_cache_count_handshake, TLSIO_SESSION_CACHE_HANDLE, session_cache, bool, resumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TLSIO_OPENSSL_SESSION_CACHE_H */
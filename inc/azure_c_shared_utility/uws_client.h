@@ -7,6 +7,7 @@
 #include "xio.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/uws_permessage_deflate.h"
 
 #ifdef __cplusplus
 #include <cstddef>
@@ -56,7 +57,8 @@ typedef struct _WS_OPEN_RESULT_DETAILED {
     WS_ERROR_BAD_FRAME_RECEIVED, \
     WS_ERROR_CANNOT_REMOVE_SENT_ITEM_FROM_LIST, \
     WS_ERROR_UNDERLYING_IO_ERROR, \
-    WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO
+    WS_ERROR_CANNOT_CLOSE_UNDERLYING_IO, \
+    WS_ERROR_MESSAGE_TOO_BIG
 
 DEFINE_ENUM(WS_ERROR, WS_ERROR_VALUES);
 
@@ -64,6 +66,15 @@ DEFINE_ENUM(WS_ERROR, WS_ERROR_VALUES);
 #define WS_FRAME_TYPE_TEXT          0x01
 #define WS_FRAME_TYPE_BINARY        0x02
 
+/* Position of the bytes passed to ON_WS_FRAGMENT_RECEIVED within the message they belong to */
+#define WS_FRAGMENT_VALUES \
+    WS_FRAGMENT_BEGIN, \
+    WS_FRAGMENT_CONTINUE, \
+    WS_FRAGMENT_END, \
+    WS_FRAGMENT_COMPLETE
+
+DEFINE_ENUM(WS_FRAGMENT, WS_FRAGMENT_VALUES);
+
 /* Codes_SRS_UWS_CLIENT_01_324: [ 1000 indicates a normal closure, meaning that the purpose for which the connection was established has been fulfilled. ]*/
 /* Codes_SRS_UWS_CLIENT_01_325: [ 1001 indicates that an endpoint is "going away", such as a server going down or a browser having navigated away from a page. ]*/
 /* Codes_SRS_UWS_CLIENT_01_326: [ 1002 indicates that an endpoint is terminating the connection due to a protocol error. ]*/
@@ -93,6 +104,7 @@ DEFINE_ENUM(WS_ERROR, WS_ERROR_VALUES);
 #define CLOSE_RESERVED_1015                 1015
 
 typedef void(*ON_WS_FRAME_RECEIVED)(void* context, unsigned char frame_type, const unsigned char* buffer, size_t size);
+typedef void(*ON_WS_FRAGMENT_RECEIVED)(void* context, unsigned char frame_type, WS_FRAGMENT fragment, const unsigned char* buffer, size_t size);
 typedef void(*ON_WS_SEND_FRAME_COMPLETE)(void* context, WS_SEND_FRAME_RESULT ws_send_frame_result);
 typedef void(*ON_WS_OPEN_COMPLETE)(void* context, WS_OPEN_RESULT_DETAILED ws_open_result);
 typedef void(*ON_WS_CLOSE_COMPLETE)(void* context);
@@ -111,7 +123,12 @@ MOCKABLE_FUNCTION(, int, uws_client_open_async, UWS_CLIENT_HANDLE, uws_client, O
 MOCKABLE_FUNCTION(, int, uws_client_close_async, UWS_CLIENT_HANDLE, uws_client, ON_WS_CLOSE_COMPLETE, on_ws_close_complete, void*, on_ws_close_complete_context);
 MOCKABLE_FUNCTION(, int, uws_client_close_handshake_async, UWS_CLIENT_HANDLE, uws_client, uint16_t, close_code, const char*, close_reason, ON_WS_CLOSE_COMPLETE, on_ws_close_complete, void*, on_ws_close_complete_context);
 MOCKABLE_FUNCTION(, int, uws_client_send_frame_async, UWS_CLIENT_HANDLE, uws_client, unsigned char, frame_type, const unsigned char*, buffer, size_t, size, bool, is_final, ON_WS_SEND_FRAME_COMPLETE, on_ws_send_frame_complete, void*, callback_context);
+/* buffer holds headroom bytes (UWS_FRAME_ENCODER_MAX_HEADER_SIZE is always enough) followed by the size payload bytes, it stays owned by the caller and can be reused once the call returns */
+MOCKABLE_FUNCTION(, int, uws_client_send_frame_in_place_async, UWS_CLIENT_HANDLE, uws_client, unsigned char, frame_type, unsigned char*, buffer, size_t, headroom, size_t, size, bool, is_final, ON_WS_SEND_FRAME_COMPLETE, on_ws_send_frame_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, void, uws_client_dowork, UWS_CLIENT_HANDLE, uws_client);
+MOCKABLE_FUNCTION(, int, uws_client_set_fragment_received_callback, UWS_CLIENT_HANDLE, uws_client, ON_WS_FRAGMENT_RECEIVED, on_ws_fragment_received, void*, on_ws_fragment_received_context);
+/* fails unless permessage-deflate was negotiated on the current connection */
+MOCKABLE_FUNCTION(, int, uws_client_get_permessage_deflate_statistics, UWS_CLIENT_HANDLE, uws_client, WS_PERMESSAGE_DEFLATE_STATISTICS*, statistics);
 
 MOCKABLE_FUNCTION(, int, uws_client_set_option, UWS_CLIENT_HANDLE, uws_client, const char*, option_name, const void*, value);
 MOCKABLE_FUNCTION(, OPTIONHANDLER_HANDLE, uws_client_retrieve_options, UWS_CLIENT_HANDLE, uws_client);
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef UWS_PERMESSAGE_DEFLATE_H
+#define UWS_PERMESSAGE_DEFLATE_H
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+typedef struct UWS_PERMESSAGE_DEFLATE_INSTANCE_TAG* UWS_PERMESSAGE_DEFLATE_HANDLE;
+
+/* Parameters of the permessage-deflate extension (RFC 7692).
+   Window bits are the base 2 logarithm of the LZ77 window: 9..15 for the client (zlib cannot produce 8), 8..15 for the server, 15 meaning no limit is requested.
+   compression_level is the zlib level (-1 for the zlib default, 0..9 otherwise). */
+typedef struct WS_PERMESSAGE_DEFLATE_CONFIG_TAG
+{
+    bool client_no_context_takeover;
+    bool server_no_context_takeover;
+    int client_max_window_bits;
+    int server_max_window_bits;
+    int compression_level;
+} WS_PERMESSAGE_DEFLATE_CONFIG;
+
+/* Counters of one connection, the compression ratio is bytes_before_compression / bytes_after_compression.
+   CPU times are the CPU time of the calling thread spent in the zlib calls, in microseconds. */
+typedef struct WS_PERMESSAGE_DEFLATE_STATISTICS_TAG
+{
+    uint64_t messages_compressed;
+    uint64_t bytes_before_compression;
+    uint64_t bytes_after_compression;
+    uint64_t compression_cpu_time_us;
+    uint64_t messages_decompressed;
+    uint64_t bytes_before_decompression;
+    uint64_t bytes_after_decompression;
+    uint64_t decompression_cpu_time_us;
+} WS_PERMESSAGE_DEFLATE_STATISTICS;
+
+MOCKABLE_FUNCTION(, char*, uws_permessage_deflate_create_offer, const WS_PERMESSAGE_DEFLATE_CONFIG*, config);
+MOCKABLE_FUNCTION(, int, uws_permessage_deflate_negotiate, const WS_PERMESSAGE_DEFLATE_CONFIG*, offer, const char*, upgrade_response, WS_PERMESSAGE_DEFLATE_CONFIG*, negotiated, bool*, is_accepted);
+MOCKABLE_FUNCTION(, UWS_PERMESSAGE_DEFLATE_HANDLE, uws_permessage_deflate_create, const WS_PERMESSAGE_DEFLATE_CONFIG*, negotiated);
+MOCKABLE_FUNCTION(, void, uws_permessage_deflate_destroy, UWS_PERMESSAGE_DEFLATE_HANDLE, permessage_deflate);
+/* the compressed bytes are preceded by headroom writable bytes and stay valid until the next call */
+MOCKABLE_FUNCTION(, int, uws_permessage_deflate_compress, UWS_PERMESSAGE_DEFLATE_HANDLE, permessage_deflate, const unsigned char*, payload, size_t, length, size_t, headroom, unsigned char**, compressed, size_t*, compressed_length);
+/* the decompressed bytes stay valid until the next call, when max_length is non-zero decompression stops once more than max_length bytes were produced */
+MOCKABLE_FUNCTION(, int, uws_permessage_deflate_decompress, UWS_PERMESSAGE_DEFLATE_HANDLE, permessage_deflate, const unsigned char*, payload, size_t, length, bool, is_message_end, size_t, max_length, const unsigned char**, decompressed, size_t*, decompressed_length);
+MOCKABLE_FUNCTION(, int, uws_permessage_deflate_get_statistics, UWS_PERMESSAGE_DEFLATE_HANDLE, permessage_deflate, WS_PERMESSAGE_DEFLATE_STATISTICS*, statistics);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* UWS_PERMESSAGE_DEFLATE_H */
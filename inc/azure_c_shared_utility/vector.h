@@ -24,6 +24,7 @@ MOCKABLE_FUNCTION(, void, VECTOR_destroy, VECTOR_HANDLE, handle);
 
 /* insertion */
 MOCKABLE_FUNCTION(, int, VECTOR_push_back, VECTOR_HANDLE, handle, const void*, elements, size_t, numElements);
+MOCKABLE_FUNCTION(, void*, VECTOR_emplace_back, VECTOR_HANDLE, handle, size_t, numElements);
 
 /* removal */
 MOCKABLE_FUNCTION(, void, VECTOR_erase, VECTOR_HANDLE, handle, void*, elements, size_t, numElements);
@@ -37,6 +38,10 @@ MOCKABLE_FUNCTION(, void*, VECTOR_find_if, VECTOR_HANDLE, handle, PREDICATE_FUNC
 
 /* capacity */
 MOCKABLE_FUNCTION(, size_t, VECTOR_size, VECTOR_HANDLE, handle);
+MOCKABLE_FUNCTION(, size_t, VECTOR_capacity, VECTOR_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, VECTOR_reserve, VECTOR_HANDLE, handle, size_t, numElements);
+MOCKABLE_FUNCTION(, int, VECTOR_shrink_to_fit, VECTOR_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, VECTOR_resize, VECTOR_HANDLE, handle, size_t, numElements);
 
 #ifdef __cplusplus
 }
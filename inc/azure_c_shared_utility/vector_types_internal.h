@@ -14,6 +14,7 @@ typedef struct VECTOR_TAG
 {
     void* storage;
     size_t count;
+    size_t capacity;
     size_t elementSize;
 } VECTOR;
 
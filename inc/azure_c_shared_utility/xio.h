@@ -44,6 +44,29 @@ typedef void(*ON_IO_OPEN_COMPLETE)(void* context, IO_OPEN_RESULT_DETAILED open_r
 typedef void(*ON_IO_CLOSE_COMPLETE)(void* context);
 typedef void(*ON_IO_ERROR)(void* context);
 
+/*one piece of a scatter/gather send, same shape as struct iovec*/
+typedef struct XIO_IOVEC_TAG
+{
+    const void* base;
+    size_t length;
+} XIO_IOVEC;
+
+/*returned by xio_send and xio_send_vectored when the send queue is at its high water mark (see OPTION_XIO_SEND_QUEUE_LIMITS in shared_util_options.h), never a __FAILURE__ value*/
+#define XIO_SEND_WOULD_BLOCK (-1)
+
+typedef void(*ON_SEND_QUEUE_LOW_WATER)(void* context);
+
+/*value of OPTION_XIO_SEND_QUEUE_LIMITS*/
+typedef struct XIO_SEND_QUEUE_LIMITS_TAG
+{
+    /*sends are refused with XIO_SEND_WOULD_BLOCK while this many bytes or more are outstanding, 0 means no limit*/
+    size_t high_water_mark;
+    /*once a send was refused, on_low_water is called when the outstanding bytes drop to this value or below*/
+    size_t low_water_mark;
+    ON_SEND_QUEUE_LOW_WATER on_low_water;
+    void* on_low_water_context;
+} XIO_SEND_QUEUE_LIMITS;
+
 typedef OPTIONHANDLER_HANDLE (*IO_RETRIEVEOPTIONS)(CONCRETE_IO_HANDLE concrete_io);
 typedef CONCRETE_IO_HANDLE(*IO_CREATE)(void* io_create_parameters);
 typedef void(*IO_DESTROY)(CONCRETE_IO_HANDLE concrete_io);
@@ -52,6 +75,8 @@ typedef int(*IO_CLOSE)(CONCRETE_IO_HANDLE concrete_io, ON_IO_CLOSE_COMPLETE on_i
 typedef int(*IO_SEND)(CONCRETE_IO_HANDLE concrete_io, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context);
 typedef void(*IO_DOWORK)(CONCRETE_IO_HANDLE concrete_io);
 typedef int(*IO_SETOPTION)(CONCRETE_IO_HANDLE concrete_io, const char* optionName, const void* value);
+typedef int(*IO_SEND_VECTORED)(CONCRETE_IO_HANDLE concrete_io, const XIO_IOVEC* iov, size_t iov_count, ON_SEND_COMPLETE on_send_complete, void* callback_context);
+typedef int(*IO_GETOPTION)(CONCRETE_IO_HANDLE concrete_io, const char* optionName, void* value);
 
 
 typedef struct IO_INTERFACE_DESCRIPTION_TAG
@@ -64,6 +89,10 @@ typedef struct IO_INTERFACE_DESCRIPTION_TAG
     IO_SEND concrete_io_send;
     IO_DOWORK concrete_io_dowork;
     IO_SETOPTION concrete_io_setoption;
+    /*optional, when NULL xio_send_vectored gathers the pieces in one buffer and calls concrete_io_send*/
+    IO_SEND_VECTORED concrete_io_send_vectored;
+    /*optional, when NULL xio_getoption fails*/
+    IO_GETOPTION concrete_io_getoption;
 } IO_INTERFACE_DESCRIPTION;
 
 MOCKABLE_FUNCTION(, XIO_HANDLE, xio_create, const IO_INTERFACE_DESCRIPTION*, io_interface_description, const void*, io_create_parameters);
@@ -71,8 +100,10 @@ MOCKABLE_FUNCTION(, void, xio_destroy, XIO_HANDLE, xio);
 MOCKABLE_FUNCTION(, int, xio_open, XIO_HANDLE, xio, ON_IO_OPEN_COMPLETE, on_io_open_complete, void*, on_io_open_complete_context, ON_BYTES_RECEIVED, on_bytes_received, void*, on_bytes_received_context, ON_IO_ERROR, on_io_error, void*, on_io_error_context);
 MOCKABLE_FUNCTION(, int, xio_close, XIO_HANDLE, xio, ON_IO_CLOSE_COMPLETE, on_io_close_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, int, xio_send, XIO_HANDLE, xio, const void*, buffer, size_t, size, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
+MOCKABLE_FUNCTION(, int, xio_send_vectored, XIO_HANDLE, xio, const XIO_IOVEC*, iov, size_t, iov_count, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, void, xio_dowork, XIO_HANDLE, xio);
 MOCKABLE_FUNCTION(, int, xio_setoption, XIO_HANDLE, xio, const char*, optionName, const void*, value);
+MOCKABLE_FUNCTION(, int, xio_getoption, XIO_HANDLE, xio, const char*, optionName, void*, value);
 MOCKABLE_FUNCTION(, OPTIONHANDLER_HANDLE, xio_retrieveoptions, XIO_HANDLE, xio);
 
 #ifdef __cplusplus
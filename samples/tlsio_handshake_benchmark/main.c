@@ -0,0 +1,221 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Opens and closes TLS connections to one server from several threads and reports the handshake rate.
+// Usage: tlsio_handshake_benchmark <host> [port] [threads] [handshakes per thread] [resume]
+// With resume set to 1 the threads share a session cache, so after the first full handshake to the host
+// the following ones are resumptions.
+// The rwlock based lock callbacks only take effect against OpenSSL 1.0.x, which locks through the callbacks the
+// application installs; 1.1.0 and later lock internally. Their gain over the mutex callbacks has not been measured
+// yet, since no OpenSSL 1.0.x build was available to run this sample against.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/tlsio.h"
+#include "azure_c_shared_utility/tlsio_openssl.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+#define MAX_THREADS 256
+
+typedef enum CONNECTION_STATE_TAG
+{
+    CONNECTION_STATE_PENDING,
+    CONNECTION_STATE_DONE,
+    CONNECTION_STATE_FAILED
+} CONNECTION_STATE;
+
+typedef struct BENCHMARK_THREAD_TAG
+{
+    const char* hostname;
+    int port;
+    int handshakes;
+    TLSIO_SESSION_CACHE_HANDLE session_cache;
+    int succeeded;
+} BENCHMARK_THREAD;
+
+static void on_io_open_complete(void* context, IO_OPEN_RESULT_DETAILED open_result)
+{
+    *(CONNECTION_STATE*)context = (open_result.result == IO_OPEN_OK) ? CONNECTION_STATE_DONE : CONNECTION_STATE_FAILED;
+}
+
+static void on_io_close_complete(void* context)
+{
+    *(CONNECTION_STATE*)context = CONNECTION_STATE_DONE;
+}
+
+static void on_io_bytes_received(void* context, const unsigned char* buffer, size_t size)
+{
+    (void)context, (void)buffer, (void)size;
+}
+
+static void on_io_error(void* context)
+{
+    *(CONNECTION_STATE*)context = CONNECTION_STATE_FAILED;
+}
+
+static int run_handshake(BENCHMARK_THREAD* benchmark_thread)
+{
+    int result;
+    TLSIO_CONFIG tlsio_config = { benchmark_thread->hostname, benchmark_thread->port, NULL, NULL };
+    XIO_HANDLE tlsio = xio_create(tlsio_openssl_get_interface_description(), &tlsio_config);
+
+    if (tlsio == NULL)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        CONNECTION_STATE state = CONNECTION_STATE_PENDING;
+
+        if (benchmark_thread->session_cache != NULL &&
+            xio_setoption(tlsio, OPTION_TLS_SESSION_CACHE, benchmark_thread->session_cache) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else if (xio_open(tlsio, on_io_open_complete, &state, on_io_bytes_received, NULL, on_io_error, &state) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            while (state == CONNECTION_STATE_PENDING)
+            {
+                xio_dowork(tlsio);
+            }
+
+            result = (state == CONNECTION_STATE_DONE) ? 0 : __FAILURE__;
+
+            state = CONNECTION_STATE_PENDING;
+            if (xio_close(tlsio, on_io_close_complete, &state) == 0)
+            {
+                while (state == CONNECTION_STATE_PENDING)
+                {
+                    xio_dowork(tlsio);
+                }
+            }
+        }
+
+        xio_destroy(tlsio);
+    }
+
+    return result;
+}
+
+static int benchmark_thread_func(void* arg)
+{
+    BENCHMARK_THREAD* benchmark_thread = (BENCHMARK_THREAD*)arg;
+    int i;
+
+    for (i = 0; i < benchmark_thread->handshakes; i++)
+    {
+        if (run_handshake(benchmark_thread) == 0)
+        {
+            benchmark_thread->succeeded++;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    const char* hostname = (argc > 1) ? argv[1] : "www.microsoft.com";
+    int port = (argc > 2) ? atoi(argv[2]) : 443;
+    int thread_count = (argc > 3) ? atoi(argv[3]) : 8;
+    int handshakes = (argc > 4) ? atoi(argv[4]) : 50;
+    bool resume = (argc > 5) && (atoi(argv[5]) != 0);
+
+    if (thread_count <= 0 || thread_count > MAX_THREADS || handshakes <= 0)
+    {
+        (void)printf("Usage: %s <host> [port] [threads (1..%d)] [handshakes per thread] [resume]\r\n", argv[0], MAX_THREADS);
+        result = __FAILURE__;
+    }
+    else if (platform_init() != 0)
+    {
+        (void)printf("Cannot initialize platform.\r\n");
+        result = __FAILURE__;
+    }
+    else
+    {
+        TICK_COUNTER_HANDLE tick_counter = tickcounter_create();
+        TLSIO_SESSION_CACHE_HANDLE session_cache = resume ? tlsio_openssl_session_cache_create((size_t)thread_count) : NULL;
+
+        if (tick_counter == NULL || (resume && session_cache == NULL))
+        {
+            (void)printf("Cannot create the tick counter or the session cache.\r\n");
+            result = __FAILURE__;
+        }
+        else
+        {
+            static BENCHMARK_THREAD benchmark_threads[MAX_THREADS];
+            THREAD_HANDLE threads[MAX_THREADS];
+            tickcounter_ms_t start_ms;
+            tickcounter_ms_t end_ms;
+            int started;
+            int succeeded = 0;
+            int i;
+
+            (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+
+            for (started = 0; started < thread_count; started++)
+            {
+                benchmark_threads[started].hostname = hostname;
+                benchmark_threads[started].port = port;
+                benchmark_threads[started].handshakes = handshakes;
+                benchmark_threads[started].session_cache = session_cache;
+                benchmark_threads[started].succeeded = 0;
+
+                if (ThreadAPI_Create(&threads[started], benchmark_thread_func, &benchmark_threads[started]) != THREADAPI_OK)
+                {
+                    (void)printf("Cannot start thread %d.\r\n", started);
+                    break;
+                }
+            }
+
+            for (i = 0; i < started; i++)
+            {
+                int thread_result;
+                (void)ThreadAPI_Join(threads[i], &thread_result);
+                succeeded += benchmark_threads[i].succeeded;
+            }
+
+            (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+            (void)printf("%d threads, %d/%d handshakes succeeded in %lu ms, %.1f handshakes/s\r\n",
+                started, succeeded, started * handshakes, (unsigned long)(end_ms - start_ms),
+                (end_ms > start_ms) ? (succeeded * 1000.0) / (double)(end_ms - start_ms) : 0.0);
+
+            if (session_cache != NULL)
+            {
+                size_t hits;
+                size_t misses;
+                if (tlsio_openssl_session_cache_get_statistics(session_cache, &hits, &misses) == 0)
+                {
+                    (void)printf("session cache: %lu resumed, %lu full handshakes\r\n", (unsigned long)hits, (unsigned long)misses);
+                }
+            }
+
+            result = (started == thread_count) ? 0 : __FAILURE__;
+        }
+
+        if (session_cache != NULL)
+        {
+            tlsio_openssl_session_cache_destroy(session_cache);
+        }
+        if (tick_counter != NULL)
+        {
+            tickcounter_destroy(tick_counter);
+        }
+
+        platform_deinit();
+    }
+
+    return result;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures WebSocket frame masking throughput and masking key generation cost, in CPU time.
+// Usage: uws_masking_benchmark [frame size in bytes] [total MB per run]
+// The byte loop is the masking loop uws_frame_encoder_encode used before it masked a word or a vector at a time,
+// the unmasked encode shows the cost of the allocation and copy alone.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/gb_rand.h"
+#include "azure_c_shared_utility/uws_frame_encoder.h"
+
+#define KEY_ITERATIONS 1000000
+
+static void mask_byte_loop(unsigned char* destination, const unsigned char* source, size_t length, const unsigned char* mask_key)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        destination[i] = source[i] ^ mask_key[i % 4];
+    }
+}
+
+static double seconds_between(clock_t start, clock_t end)
+{
+    return (double)(end - start) / CLOCKS_PER_SEC;
+}
+
+static double megabytes_per_second(size_t bytes, clock_t start, clock_t end)
+{
+    double seconds = seconds_between(start, end);
+    return (seconds > 0.0) ? ((double)bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+}
+
+static int run_encode(const unsigned char* payload, size_t frame_size, size_t frame_count, bool is_masked)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < frame_count; i++)
+    {
+        BUFFER_HANDLE encoded = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, frame_size, is_masked, true, 0);
+        if (encoded == NULL)
+        {
+            result = __FAILURE__;
+            break;
+        }
+
+        BUFFER_delete(encoded);
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    size_t frame_size = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 1024 * 1024;
+    size_t total_mb = (argc > 2) ? (size_t)strtoul(argv[2], NULL, 10) : 512;
+    size_t frame_count = (frame_size == 0) ? 0 : (total_mb * 1024 * 1024) / frame_size;
+    unsigned char* payload = (frame_size == 0) ? NULL : (unsigned char*)malloc(frame_size);
+    unsigned char* masked = (frame_size == 0) ? NULL : (unsigned char*)malloc(frame_size);
+
+    if (frame_count == 0)
+    {
+        (void)printf("Usage: %s [frame size in bytes] [total MB per run]\r\n", argv[0]);
+        result = __FAILURE__;
+    }
+    else if (payload == NULL || masked == NULL)
+    {
+        (void)printf("Cannot allocate the payload.\r\n");
+        result = __FAILURE__;
+    }
+    else
+    {
+        const unsigned char mask_key[4] = { 0x12, 0x34, 0x56, 0x78 };
+        size_t bytes = frame_count * frame_size;
+        clock_t start;
+        clock_t end;
+        size_t i;
+
+        for (i = 0; i < frame_size; i++)
+        {
+            payload[i] = (unsigned char)i;
+        }
+
+        (void)printf("%lu frames of %lu bytes per run\r\n", (unsigned long)frame_count, (unsigned long)frame_size);
+
+        start = clock();
+        for (i = 0; i < frame_count; i++)
+        {
+            mask_byte_loop(masked, payload, frame_size, mask_key);
+        }
+        end = clock();
+        (void)printf("byte loop masking:  %8.1f MB/s (checksum %u)\r\n", megabytes_per_second(bytes, start, end), (unsigned int)masked[frame_size - 1]);
+
+        start = clock();
+        result = run_encode(payload, frame_size, frame_count, true);
+        end = clock();
+        (void)printf("masked encode:      %8.1f MB/s\r\n", megabytes_per_second(bytes, start, end));
+
+        start = clock();
+        if (run_encode(payload, frame_size, frame_count, false) != 0)
+        {
+            result = __FAILURE__;
+        }
+        end = clock();
+        (void)printf("unmasked encode:    %8.1f MB/s\r\n", megabytes_per_second(bytes, start, end));
+
+        start = clock();
+        for (i = 0; i < KEY_ITERATIONS; i++)
+        {
+            masked[i % frame_size] = (unsigned char)gb_rand();
+            masked[(i + 1) % frame_size] = (unsigned char)gb_rand();
+            masked[(i + 2) % frame_size] = (unsigned char)gb_rand();
+            masked[(i + 3) % frame_size] = (unsigned char)gb_rand();
+        }
+        end = clock();
+        (void)printf("4 x gb_rand key:    %8.1f ns\r\n", seconds_between(start, end) * 1000000000.0 / KEY_ITERATIONS);
+
+        start = clock();
+        for (i = 0; i < KEY_ITERATIONS; i++)
+        {
+            unsigned char key[4];
+            if (gb_rand_bytes(key, sizeof(key)) != 0)
+            {
+                result = __FAILURE__;
+                break;
+            }
+            masked[i % frame_size] = key[0];
+        }
+        end = clock();
+        (void)printf("gb_rand_bytes key:  %8.1f ns\r\n", seconds_between(start, end) * 1000000000.0 / KEY_ITERATIONS);
+    }
+
+    free(masked);
+    free(payload);
+
+    return result;
+}
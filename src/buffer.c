@@ -14,8 +14,47 @@ typedef struct BUFFER_TAG
 {
     unsigned char* buffer;
     size_t size;
+    size_t capacity;
 } BUFFER;
 
+/* Makes sure that the buffer can hold at least required bytes. Unless BUFFER_USE_EXACT_GROWTH is defined
+   the capacity grows geometrically so that a sequence of appends costs amortized O(1) per byte. */
+static int BUFFER_ensure_capacity(BUFFER* handleptr, size_t required)
+{
+    int result;
+    if (required <= handleptr->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t new_capacity;
+        unsigned char* temp;
+#ifdef BUFFER_USE_EXACT_GROWTH
+        new_capacity = required;
+#else
+        new_capacity = handleptr->capacity * 2;
+        if ((new_capacity < required) || (new_capacity < handleptr->capacity))
+        {
+            new_capacity = required;
+        }
+#endif
+        temp = (unsigned char*)realloc(handleptr->buffer, new_capacity);
+        if (temp == NULL)
+        {
+            LogError("Failure reallocating buffer to %lu bytes", (unsigned long)new_capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            handleptr->buffer = temp;
+            handleptr->capacity = new_capacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
 /* Codes_SRS_BUFFER_07_001: [BUFFER_new shall allocate a BUFFER_HANDLE that will contain a NULL unsigned char*.] */
 BUFFER_HANDLE BUFFER_new(void)
 {
@@ -25,6 +64,7 @@ BUFFER_HANDLE BUFFER_new(void)
     {
         temp->buffer = NULL;
         temp->size = 0;
+        temp->capacity = 0;
     }
     return (BUFFER_HANDLE)temp;
 }
@@ -48,6 +88,7 @@ static int BUFFER_safemalloc(BUFFER* handleptr, size_t size)
     {
         // we still consider the real buffer size is 0
         handleptr->size = size;
+        handleptr->capacity = sizetomalloc;
         result = 0;
     }
     return result;
@@ -126,6 +167,7 @@ int BUFFER_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size)
         free(b->buffer);
         b->buffer = NULL;
         b->size = 0;
+        b->capacity = 0;
 
         result = 0;
     }
@@ -151,6 +193,7 @@ int BUFFER_build(BUFFER_HANDLE handle, const unsigned char* source, size_t size)
             {
                 b->buffer = newBuffer;
                 b->size = size;
+                b->capacity = size;
                 /* Codes_SRS_BUFFER_01_002: [The size argument can be zero, in which case nothing shall be copied from source.] */
                 (void)memcpy(b->buffer, source, size);
 
@@ -193,8 +236,14 @@ int BUFFER_append_build(BUFFER_HANDLE handle, const unsigned char* source, size_
         else
         {
             /* Codes_SRS_BUFFER_07_032: [ if handle->buffer is not NULL BUFFER_append_build shall realloc the buffer to be the handle->size + size ] */
-            unsigned char* temp = (unsigned char*)realloc(handle->buffer, handle->size + size);
-            if (temp == NULL)
+            /* Codes_SRS_BUFFER_11_001: [ If the capacity of the buffer is already at least handle->size + size, BUFFER_append_build shall not reallocate the buffer. ] */
+            if (handle->size + size < handle->size)
+            {
+                /* Codes_SRS_BUFFER_07_035: [ If any error is encountered BUFFER_append_build shall return a non-null value. ] */
+                LogError("Failure: buffer size would overflow");
+                result = __FAILURE__;
+            }
+            else if (BUFFER_ensure_capacity(handle, handle->size + size) != 0)
             {
                 /* Codes_SRS_BUFFER_07_035: [ If any error is encountered BUFFER_append_build shall return a non-null value. ] */
                 LogError("Failure reallocating temporary buffer");
@@ -203,7 +252,6 @@ int BUFFER_append_build(BUFFER_HANDLE handle, const unsigned char* source, size_
             else
             {
                 /* Codes_SRS_BUFFER_07_033: [ ... and copy the contents of source to the end of the buffer. ] */
-                handle->buffer = temp;
                 // Append the BUFFER
                 (void)memcpy(&handle->buffer[handle->size], source, size);
                 handle->size += size;
@@ -251,6 +299,7 @@ int BUFFER_pre_build(BUFFER_HANDLE handle, size_t size)
             else
             {
                 b->size = size;
+                b->capacity = size;
                 result = 0;
             }
         }
@@ -295,6 +344,7 @@ extern int BUFFER_unbuild(BUFFER_HANDLE handle)
             free(b->buffer);
             b->buffer = NULL;
             b->size = 0;
+            b->capacity = 0;
             result = 0;
         }
         else
@@ -325,8 +375,14 @@ int BUFFER_enlarge(BUFFER_HANDLE handle, size_t enlargeSize)
     else
     {
         BUFFER* b = (BUFFER*)handle;
-        unsigned char* temp = (unsigned char*)realloc(b->buffer, b->size + enlargeSize);
-        if (temp == NULL)
+        if (b->size + enlargeSize < b->size)
+        {
+            /* Codes_SRS_BUFFER_07_018: [BUFFER_enlarge shall return a nonzero result if any error is encountered.] */
+            LogError("Failure: buffer size would overflow.");
+            result = __FAILURE__;
+        }
+        /* Codes_SRS_BUFFER_11_002: [ If the capacity of the buffer is already at least the enlarged size, BUFFER_enlarge shall not reallocate the buffer. ] */
+        else if (BUFFER_ensure_capacity(b, b->size + enlargeSize) != 0)
         {
             /* Codes_SRS_BUFFER_07_018: [BUFFER_enlarge shall return a nonzero result if any error is encountered.] */
             LogError("Failure: allocating temp buffer.");
@@ -334,7 +390,6 @@ int BUFFER_enlarge(BUFFER_HANDLE handle, size_t enlargeSize)
         }
         else
         {
-            b->buffer = temp;
             b->size += enlargeSize;
             result = 0;
         }
@@ -373,6 +428,7 @@ int BUFFER_shrink(BUFFER_HANDLE handle, size_t decreaseSize, bool fromEnd)
             free(handle->buffer);
             handle->buffer = NULL;
             handle->size = 0;
+            handle->capacity = 0;
             result = 0;
         }
         else
@@ -393,6 +449,7 @@ int BUFFER_shrink(BUFFER_HANDLE handle, size_t decreaseSize, bool fromEnd)
                     free(handle->buffer);
                     handle->buffer = tmp;
                     handle->size = alloc_size;
+                    handle->capacity = alloc_size;
                     result = 0;
                 }
                 else
@@ -402,6 +459,7 @@ int BUFFER_shrink(BUFFER_HANDLE handle, size_t decreaseSize, bool fromEnd)
                     free(handle->buffer);
                     handle->buffer = tmp;
                     handle->size = alloc_size;
+                    handle->capacity = alloc_size;
                     result = 0;
                 }
             }
@@ -461,8 +519,14 @@ int BUFFER_append(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2)
             else
             {
                 // b2->size != 0, whatever b1->size is
-                unsigned char* temp = (unsigned char*)realloc(b1->buffer, b1->size + b2->size);
-                if (temp == NULL)
+                if (b1->size + b2->size < b1->size)
+                {
+                    /* Codes_SRS_BUFFER_07_023: [BUFFER_append shall return a nonzero upon any error that is encountered.] */
+                    LogError("Failure: buffer size would overflow.");
+                    result = __FAILURE__;
+                }
+                /* Codes_SRS_BUFFER_11_003: [ If the capacity of handle1 is already at least the combined size, BUFFER_append shall not reallocate handle1. ] */
+                else if (BUFFER_ensure_capacity(b1, b1->size + b2->size) != 0)
                 {
                     /* Codes_SRS_BUFFER_07_023: [BUFFER_append shall return a nonzero upon any error that is encountered.] */
                     LogError("Failure: allocating temp buffer.");
@@ -471,7 +535,6 @@ int BUFFER_append(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2)
                 else
                 {
                     /* Codes_SRS_BUFFER_07_024: [BUFFER_append concatenates b2 onto b1 without modifying b2 and shall return zero on success.]*/
-                    b1->buffer = temp;
                     // Append the BUFFER
                     (void)memcpy(&b1->buffer[b1->size], b2->buffer, b2->size);
                     b1->size += b2->size;
@@ -540,6 +603,7 @@ int BUFFER_prepend(BUFFER_HANDLE handle1, BUFFER_HANDLE handle2)
                     free(b1->buffer);
                     b1->buffer = temp;
                     b1->size += b2->size;
+                    b1->capacity = b1->size + 1;
                     result = 0;
                 }
             }
@@ -639,3 +703,89 @@ BUFFER_HANDLE BUFFER_clone(BUFFER_HANDLE handle)
     }
     return result;
 }
+
+int BUFFER_reserve(BUFFER_HANDLE handle, size_t capacity)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_BUFFER_11_004: [ If handle is NULL, BUFFER_reserve shall return a non-zero value. ] */
+        LogError("Invalid parameter specified, handle == NULL.");
+        result = __FAILURE__;
+    }
+    else if (capacity <= handle->capacity)
+    {
+        /* Codes_SRS_BUFFER_11_005: [ If capacity is less than or equal to the current capacity, BUFFER_reserve shall not allocate and shall return 0. ] */
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_BUFFER_11_006: [ Otherwise BUFFER_reserve shall reallocate the underlying storage to exactly capacity bytes, preserving the content and the size of the buffer. ] */
+        unsigned char* temp = (unsigned char*)realloc(handle->buffer, capacity);
+        if (temp == NULL)
+        {
+            /* Codes_SRS_BUFFER_11_007: [ If reallocating fails, BUFFER_reserve shall return a non-zero value and leave the buffer unchanged. ] */
+            LogError("Failure reallocating buffer to %lu bytes", (unsigned long)capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_BUFFER_11_008: [ On success BUFFER_reserve shall return 0. ] */
+            handle->buffer = temp;
+            handle->capacity = capacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+size_t BUFFER_capacity(BUFFER_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_BUFFER_11_009: [ If handle is NULL, BUFFER_capacity shall return 0. ] */
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_BUFFER_11_010: [ Otherwise BUFFER_capacity shall return the number of bytes the buffer can hold without reallocating. ] */
+        result = handle->capacity;
+    }
+    return result;
+}
+
+int BUFFER_shrink_to_fit(BUFFER_HANDLE handle)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_BUFFER_11_011: [ If handle is NULL, BUFFER_shrink_to_fit shall return a non-zero value. ] */
+        LogError("Invalid parameter specified, handle == NULL.");
+        result = __FAILURE__;
+    }
+    else if ((handle->buffer == NULL) || (handle->size == 0) || (handle->capacity == handle->size))
+    {
+        /* Codes_SRS_BUFFER_11_012: [ If the buffer holds no content or its capacity already equals its size, BUFFER_shrink_to_fit shall not allocate and shall return 0. ] */
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_BUFFER_11_013: [ Otherwise BUFFER_shrink_to_fit shall reallocate the underlying storage to exactly the size of the buffer. ] */
+        unsigned char* temp = (unsigned char*)realloc(handle->buffer, handle->size);
+        if (temp == NULL)
+        {
+            /* Codes_SRS_BUFFER_11_014: [ If reallocating fails, BUFFER_shrink_to_fit shall return a non-zero value and leave the buffer unchanged. ] */
+            LogError("Failure reallocating buffer to %lu bytes", (unsigned long)handle->size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_BUFFER_11_015: [ On success BUFFER_shrink_to_fit shall return 0. ] */
+            handle->buffer = temp;
+            handle->capacity = handle->size;
+            result = 0;
+        }
+    }
+    return result;
+}
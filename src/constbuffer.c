@@ -11,9 +11,22 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/refcount.h"
 
+typedef enum CONSTBUFFER_TYPE_TAG
+{
+    CONSTBUFFER_TYPE_COPIED,
+    CONSTBUFFER_TYPE_MEMORY_MOVED,
+    CONSTBUFFER_TYPE_WITH_CUSTOM_FREE,
+    CONSTBUFFER_TYPE_FROM_OFFSET_AND_SIZE
+} CONSTBUFFER_TYPE;
+
 typedef struct CONSTBUFFER_HANDLE_DATA_TAG
 {
     CONSTBUFFER alias;
+    CONSTBUFFER_TYPE buffer_type;
+    CONSTBUFFER_CUSTOM_FREE_FUNC custom_free_func;
+    void* custom_free_func_context;
+    /*the handle whose storage is shared by a CONSTBUFFER_TYPE_FROM_OFFSET_AND_SIZE buffer*/
+    CONSTBUFFER_HANDLE originalHandle;
 }CONSTBUFFER_HANDLE_DATA;
 
 DEFINE_REFCOUNT_TYPE(CONSTBUFFER_HANDLE_DATA);
@@ -35,6 +48,10 @@ static CONSTBUFFER_HANDLE CONSTBUFFER_Create_Internal(const unsigned char* sourc
     {
         /*Codes_SRS_CONSTBUFFER_02_002: [Otherwise, CONSTBUFFER_Create shall create a copy of the memory area pointed to by source having size bytes.]*/
         result->alias.size = size;
+        result->buffer_type = CONSTBUFFER_TYPE_COPIED;
+        result->custom_free_func = NULL;
+        result->custom_free_func_context = NULL;
+        result->originalHandle = NULL;
         if (size == 0)
         {
             result->alias.buffer = NULL;
@@ -102,6 +119,125 @@ CONSTBUFFER_HANDLE CONSTBUFFER_CreateFromBuffer(BUFFER_HANDLE buffer)
     return (CONSTBUFFER_HANDLE)result;
 }
 
+CONSTBUFFER_HANDLE CONSTBUFFER_CreateWithMoveMemory(unsigned char* source, size_t size)
+{
+    CONSTBUFFER_HANDLE_DATA* result;
+
+    /*Codes_SRS_CONSTBUFFER_11_001: [ If source is NULL and size is different than 0 then CONSTBUFFER_CreateWithMoveMemory shall fail and return NULL. ]*/
+    if ((source == NULL) && (size != 0))
+    {
+        LogError("Invalid arguments: unsigned char* source=%p, size_t size=%zu", source, size);
+        result = NULL;
+    }
+    else
+    {
+        result = REFCOUNT_TYPE_CREATE(CONSTBUFFER_HANDLE_DATA);
+        if (result == NULL)
+        {
+            /*Codes_SRS_CONSTBUFFER_11_004: [ If any error occurs, CONSTBUFFER_CreateWithMoveMemory shall fail and return NULL. ]*/
+            LogError("unable to malloc");
+        }
+        else
+        {
+            /*Codes_SRS_CONSTBUFFER_11_002: [ CONSTBUFFER_CreateWithMoveMemory shall store source and size and return a non-NULL handle with its ref count set to 1, without copying the memory. ]*/
+            /*Codes_SRS_CONSTBUFFER_11_003: [ On success, source becomes owned by the const buffer and shall be freed with free when the ref count reaches 0. ]*/
+            result->alias.buffer = source;
+            result->alias.size = size;
+            result->buffer_type = CONSTBUFFER_TYPE_MEMORY_MOVED;
+            result->custom_free_func = NULL;
+            result->custom_free_func_context = NULL;
+            result->originalHandle = NULL;
+        }
+    }
+
+    return (CONSTBUFFER_HANDLE)result;
+}
+
+CONSTBUFFER_HANDLE CONSTBUFFER_CreateWithCustomFree(const unsigned char* source, size_t size, CONSTBUFFER_CUSTOM_FREE_FUNC customFreeFunc, void* customFreeFuncContext)
+{
+    CONSTBUFFER_HANDLE_DATA* result;
+
+    /*Codes_SRS_CONSTBUFFER_11_005: [ If source is NULL and size is different than 0 then CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+    /*Codes_SRS_CONSTBUFFER_11_006: [ If customFreeFunc is NULL, CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+    if (((source == NULL) && (size != 0)) ||
+        (customFreeFunc == NULL))
+    {
+        LogError("Invalid arguments: unsigned char* source=%p, size_t size=%zu, customFreeFunc=%p",
+            source, size, customFreeFunc);
+        result = NULL;
+    }
+    else
+    {
+        result = REFCOUNT_TYPE_CREATE(CONSTBUFFER_HANDLE_DATA);
+        if (result == NULL)
+        {
+            /*Codes_SRS_CONSTBUFFER_11_009: [ If any error occurs, CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+            LogError("unable to malloc");
+        }
+        else
+        {
+            /*Codes_SRS_CONSTBUFFER_11_007: [ CONSTBUFFER_CreateWithCustomFree shall store source, size, customFreeFunc and customFreeFuncContext and return a non-NULL handle with its ref count set to 1, without copying the memory. ]*/
+            /*Codes_SRS_CONSTBUFFER_11_008: [ When the ref count reaches 0, customFreeFunc shall be called with customFreeFuncContext instead of freeing source. ]*/
+            result->alias.buffer = source;
+            result->alias.size = size;
+            result->buffer_type = CONSTBUFFER_TYPE_WITH_CUSTOM_FREE;
+            result->custom_free_func = customFreeFunc;
+            result->custom_free_func_context = customFreeFuncContext;
+            result->originalHandle = NULL;
+        }
+    }
+
+    return (CONSTBUFFER_HANDLE)result;
+}
+
+CONSTBUFFER_HANDLE CONSTBUFFER_CreateFromOffsetAndSize(CONSTBUFFER_HANDLE handle, size_t offset, size_t size)
+{
+    CONSTBUFFER_HANDLE result;
+
+    /*Codes_SRS_CONSTBUFFER_11_010: [ If handle is NULL then CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    /*Codes_SRS_CONSTBUFFER_11_011: [ If offset is greater than the size of handle then CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    /*Codes_SRS_CONSTBUFFER_11_012: [ If offset + size exceeds the size of handle (or overflows) then CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    if ((handle == NULL) ||
+        (offset > handle->alias.size) ||
+        (size > handle->alias.size - offset))
+    {
+        LogError("Invalid arguments: CONSTBUFFER_HANDLE handle=%p, size_t offset=%zu, size_t size=%zu",
+            handle, offset, size);
+        result = NULL;
+    }
+    else if ((offset == 0) && (size == handle->alias.size))
+    {
+        /*Codes_SRS_CONSTBUFFER_11_013: [ If offset is 0 and size is the size of handle then CONSTBUFFER_CreateFromOffsetAndSize shall increment the ref count of handle and return handle. ]*/
+        INC_REF(CONSTBUFFER_HANDLE_DATA, handle);
+        result = handle;
+    }
+    else
+    {
+        CONSTBUFFER_HANDLE_DATA* slice = REFCOUNT_TYPE_CREATE(CONSTBUFFER_HANDLE_DATA);
+        if (slice == NULL)
+        {
+            /*Codes_SRS_CONSTBUFFER_11_016: [ If any error occurs, CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+            LogError("unable to malloc");
+            result = NULL;
+        }
+        else
+        {
+            /*Codes_SRS_CONSTBUFFER_11_014: [ Otherwise CONSTBUFFER_CreateFromOffsetAndSize shall return a non-NULL handle with its ref count set to 1 whose content points at offset inside the storage of handle and has size bytes. ]*/
+            /*Codes_SRS_CONSTBUFFER_11_015: [ CONSTBUFFER_CreateFromOffsetAndSize shall increment the ref count of handle, and the new handle shall release it when its own ref count reaches 0. ]*/
+            INC_REF(CONSTBUFFER_HANDLE_DATA, handle);
+            slice->alias.buffer = (handle->alias.buffer == NULL) ? NULL : handle->alias.buffer + offset;
+            slice->alias.size = size;
+            slice->buffer_type = CONSTBUFFER_TYPE_FROM_OFFSET_AND_SIZE;
+            slice->custom_free_func = NULL;
+            slice->custom_free_func_context = NULL;
+            slice->originalHandle = handle;
+            result = (CONSTBUFFER_HANDLE)slice;
+        }
+    }
+
+    return result;
+}
+
 CONSTBUFFER_HANDLE CONSTBUFFER_Clone(CONSTBUFFER_HANDLE constbufferHandle)
 {
     if (constbufferHandle == NULL)
@@ -144,7 +280,20 @@ void CONSTBUFFER_Destroy(CONSTBUFFER_HANDLE constbufferHandle)
         {
             /*Codes_SRS_CONSTBUFFER_02_017: [If the refcount reaches zero, then CONSTBUFFER_Destroy shall deallocate all resources used by the CONSTBUFFER_HANDLE.]*/
             CONSTBUFFER_HANDLE_DATA* constbufferHandleData = (CONSTBUFFER_HANDLE_DATA*)constbufferHandle;
-            free((void*)constbufferHandleData->alias.buffer);
+            switch (constbufferHandleData->buffer_type)
+            {
+                case CONSTBUFFER_TYPE_WITH_CUSTOM_FREE:
+                    /*Codes_SRS_CONSTBUFFER_11_008: [ When the ref count reaches 0, customFreeFunc shall be called with customFreeFuncContext instead of freeing source. ]*/
+                    constbufferHandleData->custom_free_func(constbufferHandleData->custom_free_func_context);
+                    break;
+                case CONSTBUFFER_TYPE_FROM_OFFSET_AND_SIZE:
+                    /*Codes_SRS_CONSTBUFFER_11_015: [ CONSTBUFFER_CreateFromOffsetAndSize shall increment the ref count of handle, and the new handle shall release it when its own ref count reaches 0. ]*/
+                    CONSTBUFFER_Destroy(constbufferHandleData->originalHandle);
+                    break;
+                default:
+                    free((void*)constbufferHandleData->alias.buffer);
+                    break;
+            }
             free(constbufferHandleData);
         }
     }
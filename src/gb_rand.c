@@ -3,14 +3,109 @@
 
 #ifdef __cplusplus
 #include <cstdlib>
+#include <cstring>
 #else
 #include <stdlib.h>
+#include <string.h>
 #endif
 
 #include "azure_c_shared_utility/gb_rand.h"
+#include "azure_c_shared_utility/random_source.h"
+#include "azure_c_shared_utility/optimize_size.h"
 
 /*this is rand*/
 int gb_rand(void)
 {
     return rand();
 }
+
+/* Small requests (such as WebSocket masking keys) are served from a per thread pool of GB_RAND_POOL_SIZE bytes, so
+the platform generator (random_source_fill) is entered once every few dozen requests instead of once per request.
+Compilers without thread local storage go to the platform generator every time. */
+#ifndef GB_RAND_POOL_SIZE
+#define GB_RAND_POOL_SIZE 256
+#endif
+
+#if defined(_MSC_VER)
+#define GB_RAND_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) && (defined(_WIN32) || defined(__linux__) || defined(__APPLE__))
+#define GB_RAND_THREAD_LOCAL __thread
+#endif
+
+#if defined(GB_RAND_THREAD_LOCAL)
+static GB_RAND_THREAD_LOCAL unsigned char rand_pool[GB_RAND_POOL_SIZE];
+static GB_RAND_THREAD_LOCAL size_t rand_pool_available;
+
+#if !defined(_WIN32)
+#include <pthread.h>
+
+/*a forked child starts with a copy of the pool of the thread that forked, it must not hand out the same bytes as the parent*/
+static pthread_once_t rand_pool_fork_handler_once = PTHREAD_ONCE_INIT;
+
+static void discard_rand_pool_in_child(void)
+{
+    /*only the forking thread exists in the child, its pool is the only copy there*/
+    (void)memset(rand_pool, 0, sizeof(rand_pool));
+    rand_pool_available = 0;
+}
+
+static void register_rand_pool_fork_handler(void)
+{
+    (void)pthread_atfork(NULL, NULL, discard_rand_pool_in_child);
+}
+
+static int register_fork_handler(void)
+{
+    return (pthread_once(&rand_pool_fork_handler_once, register_rand_pool_fork_handler) == 0) ? 0 : __FAILURE__;
+}
+#else
+static int register_fork_handler(void)
+{
+    return 0;
+}
+#endif
+#endif
+
+int gb_rand_bytes(unsigned char* buffer, size_t size)
+{
+    int result;
+
+    if (buffer == NULL)
+    {
+        result = __FAILURE__;
+    }
+#if defined(GB_RAND_THREAD_LOCAL)
+    else if (size <= GB_RAND_POOL_SIZE / 4)
+    {
+        /*the handler is in place before the pool holds any bytes*/
+        if ((rand_pool_available < size) &&
+            (register_fork_handler() == 0) &&
+            (random_source_fill(rand_pool, sizeof(rand_pool)) == 0))
+        {
+            rand_pool_available = sizeof(rand_pool);
+        }
+
+        if (rand_pool_available < size)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned char* pool_bytes = rand_pool + sizeof(rand_pool) - rand_pool_available;
+
+            (void)memcpy(buffer, pool_bytes, size);
+
+            /*bytes handed out are not kept around*/
+            (void)memset(pool_bytes, 0, size);
+            rand_pool_available -= size;
+            result = 0;
+        }
+    }
+#endif
+    else
+    {
+        result = random_source_fill(buffer, size);
+    }
+
+    return result;
+}
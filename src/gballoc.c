@@ -5,21 +5,490 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 #include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
+#if defined(GB_DEBUG_ALLOC)
+/*gballoc.h is needed for the allocation site types, this file must not redirect its own malloc calls to gballoc*/
+#undef GB_MEASURE_MEMORY_FOR_THIS
+#include "azure_c_shared_utility/gballoc.h"
+#endif
+
 #ifndef GB_USE_CUSTOM_HEAP
 
 #ifndef SIZE_MAX
 #define SIZE_MAX ((size_t)~(size_t)0)
 #endif
 
+#if defined(GB_USE_INLINE_TRACKING)
+
+#if defined(GB_TRACK_ALLOCATION_SITES)
+#error GB_TRACK_ALLOCATION_SITES is not supported together with GB_USE_INLINE_TRACKING
+#endif
+
+/* In this mode every block carries its own tracking header right before the memory handed out to the caller,
+so gballoc_free and gballoc_realloc find the size in O(1) instead of searching a list. The counters are split
+in shards, each on its own cache line and updated with atomic operations, so no lock is taken.
+gballoc_free and gballoc_realloc therefore only accept NULL or a block returned by gballoc: the header of any other
+pointer is read out of bounds. GBALLOC_VALIDATE_HEADERS (on unless NDEBUG is defined) adds a cookie check that
+catches double frees and most foreign pointers while debugging, it does not make passing them defined behavior. */
+
+#if !defined(NDEBUG) && !defined(GBALLOC_VALIDATE_HEADERS)
+#define GBALLOC_VALIDATE_HEADERS
+#endif
+
+#ifndef GBALLOC_SHARD_COUNT
+#define GBALLOC_SHARD_COUNT 16
+#endif
+
+#ifndef GBALLOC_CACHE_LINE_SIZE
+#define GBALLOC_CACHE_LINE_SIZE 64
+#endif
+
+/*marks a header written by gballoc; cleared when the block is released*/
+#define GBALLOC_HEADER_COOKIE ((size_t)0x6762616C6C6F6321ULL)
+
+/*shard recorded for blocks allocated while gballoc was not initialized, these are never counted*/
+#define GBALLOC_UNTRACKED_SHARD GBALLOC_SHARD_COUNT
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#if defined(_WIN64)
+#define GBALLOC_ATOMIC_ADD(target, value) ((void)_InterlockedExchangeAdd64((volatile __int64*)(target), (__int64)(value)))
+#define GBALLOC_ATOMIC_SUB(target, value) ((void)_InterlockedExchangeAdd64((volatile __int64*)(target), -(__int64)(value)))
+#define GBALLOC_ATOMIC_CAS(target, expected, desired) (_InterlockedCompareExchange64((volatile __int64*)(target), (__int64)(desired), (__int64)(expected)) == (__int64)(expected))
+#else
+#define GBALLOC_ATOMIC_ADD(target, value) ((void)_InterlockedExchangeAdd((volatile long*)(target), (long)(value)))
+#define GBALLOC_ATOMIC_SUB(target, value) ((void)_InterlockedExchangeAdd((volatile long*)(target), -(long)(value)))
+#define GBALLOC_ATOMIC_CAS(target, expected, desired) (_InterlockedCompareExchange((volatile long*)(target), (long)(desired), (long)(expected)) == (long)(expected))
+#endif
+#elif defined(__GNUC__)
+#define GBALLOC_ATOMIC_ADD(target, value) ((void)__sync_fetch_and_add((target), (value)))
+#define GBALLOC_ATOMIC_SUB(target, value) ((void)__sync_fetch_and_sub((target), (value)))
+#define GBALLOC_ATOMIC_CAS(target, expected, desired) __sync_bool_compare_and_swap((target), (expected), (desired))
+#if defined(__ATOMIC_RELAXED)
+#define GBALLOC_ATOMIC_LOAD(target) __atomic_load_n((target), __ATOMIC_RELAXED)
+#endif
+#else
+#error GB_USE_INLINE_TRACKING requires atomic operations that are not known for this compiler
+#endif
+
+#ifndef GBALLOC_ATOMIC_LOAD
+#define GBALLOC_ATOMIC_LOAD(target) (*(target))
+#endif
+
+typedef struct GBALLOC_HEADER_INFO_TAG
+{
+    size_t size;
+    size_t shard;
+    size_t generation;
+    size_t cookie;
+} GBALLOC_HEADER_INFO;
+
+/*the union keeps the memory returned to the caller aligned as malloc would align it*/
+typedef union GBALLOC_HEADER_TAG
+{
+    GBALLOC_HEADER_INFO info;
+    long double align_long_double;
+    long long align_long_long;
+    void* align_pointer;
+} GBALLOC_HEADER;
+
+typedef struct GBALLOC_SHARD_TAG
+{
+    volatile size_t currentSize;
+    volatile size_t allocations;
+    unsigned char padding[GBALLOC_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+} GBALLOC_SHARD;
+
+typedef enum GBALLOC_STATE_TAG
+{
+    GBALLOC_STATE_INIT,
+    GBALLOC_STATE_NOT_INIT
+} GBALLOC_STATE;
+
+static GBALLOC_SHARD shards[GBALLOC_SHARD_COUNT];
+static volatile size_t maxSize = 0;
+static volatile GBALLOC_STATE gballocState = GBALLOC_STATE_NOT_INIT;
+/*incremented by every gballoc_init, blocks counted before the last one are not in the current counters*/
+static volatile size_t gballocGeneration = 0;
+
+static size_t gballoc_sum_current_size(void)
+{
+    size_t result = 0;
+    size_t i;
+    for (i = 0; i < GBALLOC_SHARD_COUNT; i++)
+    {
+        result += GBALLOC_ATOMIC_LOAD(&shards[i].currentSize);
+    }
+    return result;
+}
+
+/*blocks handed out by different threads come from different heap regions, so the address spreads them over the shards*/
+static size_t gballoc_select_shard(const void* block)
+{
+    uintptr_t address = (uintptr_t)block;
+    return (size_t)(((address >> 4) ^ (address >> 12)) % GBALLOC_SHARD_COUNT);
+}
+
+static void gballoc_track(GBALLOC_HEADER* header, size_t size)
+{
+    header->info.size = size;
+    header->info.cookie = GBALLOC_HEADER_COOKIE;
+
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        header->info.shard = GBALLOC_UNTRACKED_SHARD;
+    }
+    else
+    {
+        size_t shard = gballoc_select_shard(header);
+        size_t total;
+        size_t currentMax;
+
+        header->info.shard = shard;
+        header->info.generation = gballocGeneration;
+        GBALLOC_ATOMIC_ADD(&shards[shard].currentSize, size);
+        GBALLOC_ATOMIC_ADD(&shards[shard].allocations, 1);
+
+        /* Codes_SRS_GBALLOC_01_011: [The maximum total memory used shall be the maximum of the total memory used at any point.] */
+        total = gballoc_sum_current_size();
+        currentMax = GBALLOC_ATOMIC_LOAD(&maxSize);
+        while ((currentMax < total) && !GBALLOC_ATOMIC_CAS(&maxSize, currentMax, total))
+        {
+            currentMax = GBALLOC_ATOMIC_LOAD(&maxSize);
+        }
+    }
+}
+
+static void gballoc_untrack(GBALLOC_HEADER* header)
+{
+    /* Codes_SRS_GBALLOC_11_012: [ When GB_USE_INLINE_TRACKING is defined, freeing or reallocating a block counted before the last gballoc_init shall not change the counters. ]*/
+    if ((gballocState == GBALLOC_STATE_INIT) && (header->info.shard != GBALLOC_UNTRACKED_SHARD) && (header->info.generation == gballocGeneration))
+    {
+        GBALLOC_ATOMIC_SUB(&shards[header->info.shard].currentSize, header->info.size);
+    }
+    header->info.cookie = 0;
+}
+
+static GBALLOC_HEADER* gballoc_get_header(void* ptr)
+{
+    GBALLOC_HEADER* result = ((GBALLOC_HEADER*)ptr) - 1;
+#if defined(GBALLOC_VALIDATE_HEADERS)
+    /* Codes_SRS_GBALLOC_11_013: [ When GB_USE_INLINE_TRACKING is defined, gballoc_free and gballoc_realloc shall only accept NULL or a block returned by gballoc; when GBALLOC_VALIDATE_HEADERS is defined (the default unless NDEBUG is defined) a header whose cookie does not match shall be treated as a pointer that cannot be found. ]*/
+    if (result->info.cookie != GBALLOC_HEADER_COOKIE)
+    {
+        result = NULL;
+    }
+#endif
+    return result;
+}
+
+int gballoc_init(void)
+{
+    int result;
+
+    if (gballocState != GBALLOC_STATE_NOT_INIT)
+    {
+        /* Codes_SRS_GBALLOC_01_025: [Init after Init shall fail and return a non-zero value.] */
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+
+        /* Codes_SRS_GBALLOC_11_001: [ When GB_USE_INLINE_TRACKING is defined, gballoc_init shall not create any lock. ]*/
+        /* Codes_SRS_GBALLOC_01_002: [Upon initialization the total memory used and maximum total memory used tracked by the module shall be set to 0.] */
+        for (i = 0; i < GBALLOC_SHARD_COUNT; i++)
+        {
+            shards[i].currentSize = 0;
+            shards[i].allocations = 0;
+        }
+        maxSize = 0;
+        gballocGeneration++;
+        gballocState = GBALLOC_STATE_INIT;
+
+        /* Codes_SRS_GBALLOC_01_024: [gballoc_init shall initialize the gballoc module and return 0 upon success.] */
+        result = 0;
+    }
+
+    return result;
+}
+
+void gballoc_deinit(void)
+{
+    /* Codes_SRS_GBALLOC_01_029: [if gballoc is not initialized gballoc_deinit shall do nothing.] */
+    gballocState = GBALLOC_STATE_NOT_INIT;
+}
+
+void* gballoc_malloc(size_t size)
+{
+    void* result;
+
+    if (size > SIZE_MAX - sizeof(GBALLOC_HEADER))
+    {
+        LogError("size %zu too large", size);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_11_002: [ When GB_USE_INLINE_TRACKING is defined, gballoc_malloc, gballoc_calloc and gballoc_realloc shall store the size of the block in a header placed right before the memory returned to the caller, whether or not gballoc is initialized. ]*/
+        GBALLOC_HEADER* header = (GBALLOC_HEADER*)malloc(sizeof(GBALLOC_HEADER) + size);
+        if (header == NULL)
+        {
+            /* Codes_SRS_GBALLOC_01_012: [When the underlying malloc call fails, gballoc_malloc shall return NULL and size should not be counted towards total memory used.] */
+            result = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_01_004: [If the underlying malloc call is successful, gb_malloc shall increment the total memory used with the amount indicated by size.] */
+            gballoc_track(header, size);
+            result = header + 1;
+        }
+    }
+
+    return result;
+}
+
+void* gballoc_calloc(size_t nmemb, size_t size)
+{
+    void* result;
+
+    if ((size != 0) && (nmemb > (SIZE_MAX - sizeof(GBALLOC_HEADER)) / size))
+    {
+        LogError("nmemb %zu * size %zu too large", nmemb, size);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_01_020: [gballoc_calloc shall call the C99 calloc function and return its result.] */
+        GBALLOC_HEADER* header = (GBALLOC_HEADER*)calloc(1, sizeof(GBALLOC_HEADER) + (nmemb * size));
+        if (header == NULL)
+        {
+            /* Codes_SRS_GBALLOC_01_022: [When the underlying calloc call fails, gballoc_calloc shall return NULL and size should not be counted towards total memory used.] */
+            result = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_01_021: [If the underlying calloc call is successful, gballoc_calloc shall increment the total memory used with nmemb*size.] */
+            gballoc_track(header, nmemb * size);
+            result = header + 1;
+        }
+    }
+
+    return result;
+}
+
+void* gballoc_realloc(void* ptr, size_t size)
+{
+    void* result;
+    GBALLOC_HEADER* header;
+
+    if (ptr == NULL)
+    {
+        /* Codes_SRS_GBALLOC_01_017: [When ptr is NULL, gballoc_realloc shall call the underlying realloc with ptr being NULL and the realloc result shall be tracked by gballoc.] */
+        result = gballoc_malloc(size);
+    }
+    else if ((header = gballoc_get_header(ptr)) == NULL)
+    {
+        /* Codes_SRS_GBALLOC_01_016: [When the ptr pointer cannot be found in the pointers tracked by gballoc, gballoc_realloc shall return NULL and the underlying realloc shall not be called.] */
+        LogError("Could not realloc allocation for address %p (not found)", ptr);
+        result = NULL;
+    }
+    else if (size > SIZE_MAX - sizeof(GBALLOC_HEADER))
+    {
+        LogError("size %zu too large", size);
+        result = NULL;
+    }
+    else
+    {
+        /*the old block stays counted until the underlying realloc succeeds*/
+        GBALLOC_HEADER saved = *header;
+        GBALLOC_HEADER* newHeader;
+
+        header->info.cookie = 0;
+        newHeader = (GBALLOC_HEADER*)realloc(header, sizeof(GBALLOC_HEADER) + size);
+        if (newHeader == NULL)
+        {
+            /* Codes_SRS_GBALLOC_01_014: [When the underlying realloc call fails, gballoc_realloc shall return NULL and no change should be made to the counted total memory usage.] */
+            header->info.cookie = GBALLOC_HEADER_COOKIE;
+            result = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_01_006: [If the underlying realloc call is successful, gballoc_realloc shall look up the size associated with the pointer ptr and decrease the total memory used with that size.] */
+            /* Codes_SRS_GBALLOC_01_007: [If realloc is successful, gballoc_realloc shall also increment the total memory used value tracked by this module.] */
+            gballoc_untrack(&saved);
+            gballoc_track(newHeader, size);
+            result = newHeader + 1;
+        }
+    }
+
+    return result;
+}
+
+void gballoc_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        GBALLOC_HEADER* header = gballoc_get_header(ptr);
+        if (header == NULL)
+        {
+            /* Codes_SRS_GBALLOC_01_019: [When the ptr pointer cannot be found in the pointers tracked by gballoc, gballoc_free shall not free any memory.] */
+            LogError("Could not free allocation for address %p (not found)", ptr);
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_01_009: [gballoc_free shall also look up the size associated with the ptr pointer and decrease the total memory used with the associated size amount.] */
+            gballoc_untrack(header);
+            /* Codes_SRS_GBALLOC_01_008: [gballoc_free shall call the C99 free function.] */
+            free(header);
+        }
+    }
+}
+
+size_t gballoc_getMaximumMemoryUsed(void)
+{
+    size_t result;
+
+    /* Codes_SRS_GBALLOC_01_038: [If gballoc was not initialized gballoc_getMaximumMemoryUsed shall return MAX_INT_SIZE.] */
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        LogError("gballoc is not initialized.");
+        result = SIZE_MAX;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_01_010: [gballoc_getMaximumMemoryUsed shall return the maximum amount of total memory used recorded since the module initialization.] */
+        result = GBALLOC_ATOMIC_LOAD(&maxSize);
+    }
+
+    return result;
+}
+
+size_t gballoc_getCurrentMemoryUsed(void)
+{
+    size_t result;
+
+    /* Codes_SRS_GBALLOC_01_044: [If gballoc was not initialized gballoc_getCurrentMemoryUsed shall return SIZE_MAX.] */
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        LogError("gballoc is not initialized.");
+        result = SIZE_MAX;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_11_003: [ When GB_USE_INLINE_TRACKING is defined, gballoc_getCurrentMemoryUsed and gballoc_getAllocationCount shall return the sum of the per shard counters. ]*/
+        result = gballoc_sum_current_size();
+    }
+
+    return result;
+}
+
+size_t gballoc_getAllocationCount(void)
+{
+    size_t result;
+
+    /* Codes_SRS_GBALLOC_07_001: [ If gballoc was not initialized gballoc_getAllocationCount shall return 0. ] */
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        LogError("gballoc is not initialized.");
+        result = 0;
+    }
+    else
+    {
+        size_t i;
+
+        /* Codes_SRS_GBALLOC_11_003: [ When GB_USE_INLINE_TRACKING is defined, gballoc_getCurrentMemoryUsed and gballoc_getAllocationCount shall return the sum of the per shard counters. ]*/
+        result = 0;
+        for (i = 0; i < GBALLOC_SHARD_COUNT; i++)
+        {
+            result += GBALLOC_ATOMIC_LOAD(&shards[i].allocations);
+        }
+    }
+
+    return result;
+}
+
+void gballoc_resetMetrics()
+{
+    /* Codes_SRS_GBALLOC_07_005: [ If gballoc was not initialized gballoc_reset Metrics shall do nothing.] */
+    if (gballocState != GBALLOC_STATE_INIT)
+    {
+        LogError("gballoc is not initialized.");
+    }
+    else
+    {
+        size_t i;
+
+        /* Codes_SRS_GBALLOC_07_008: [ gballoc_resetMetrics shall reset the total allocation size, max allocation size and number of allocation to zero. ] */
+        for (i = 0; i < GBALLOC_SHARD_COUNT; i++)
+        {
+            shards[i].currentSize = 0;
+            shards[i].allocations = 0;
+        }
+        maxSize = 0;
+    }
+}
+
+#if defined(GB_DEBUG_ALLOC)
+
+void* gballoc_malloc_at(size_t size, const char* file, int line)
+{
+    (void)file;
+    (void)line;
+    return gballoc_malloc(size);
+}
+
+void* gballoc_calloc_at(size_t nmemb, size_t size, const char* file, int line)
+{
+    (void)file;
+    (void)line;
+    return gballoc_calloc(nmemb, size);
+}
+
+void* gballoc_realloc_at(void* ptr, size_t size, const char* file, int line)
+{
+    (void)file;
+    (void)line;
+    return gballoc_realloc(ptr, size);
+}
+
+size_t gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER order, GBALLOC_SITE_STATS* sites, size_t site_count)
+{
+    /* Codes_SRS_GBALLOC_11_011: [ When GB_TRACK_ALLOCATION_SITES is not defined, gballoc_getTopAllocationSites shall return 0 and gballoc_logTopAllocationSites shall only log an error. ]*/
+    (void)order;
+    (void)sites;
+    (void)site_count;
+    LogError("allocation sites are not tracked, build with GB_TRACK_ALLOCATION_SITES");
+    return 0;
+}
+
+void gballoc_logTopAllocationSites(GBALLOC_SITE_ORDER order, size_t site_count)
+{
+    /* Codes_SRS_GBALLOC_11_011: [ When GB_TRACK_ALLOCATION_SITES is not defined, gballoc_getTopAllocationSites shall return 0 and gballoc_logTopAllocationSites shall only log an error. ]*/
+    (void)order;
+    (void)site_count;
+    LogError("allocation sites are not tracked, build with GB_TRACK_ALLOCATION_SITES");
+}
+
+#endif /* GB_DEBUG_ALLOC */
+
+#else /* GB_USE_INLINE_TRACKING */
+
+typedef struct ALLOCATION_SITE_TAG* ALLOCATION_SITE_HANDLE;
+
 typedef struct ALLOCATION_TAG
 {
     size_t size;
     void* ptr;
     void* next;
+#if defined(GB_TRACK_ALLOCATION_SITES)
+    ALLOCATION_SITE_HANDLE site;
+    size_t sequence;
+#endif
 } ALLOCATION;
 
 typedef enum GBALLOC_STATE_TAG
@@ -36,6 +505,182 @@ static GBALLOC_STATE gballocState = GBALLOC_STATE_NOT_INIT;
 
 static LOCK_HANDLE gballocThreadSafeLock = NULL;
 
+#if defined(GB_TRACK_ALLOCATION_SITES)
+
+#if !defined(GB_DEBUG_ALLOC)
+#error GB_TRACK_ALLOCATION_SITES requires GB_DEBUG_ALLOC
+#endif
+
+/* Every tracked allocation is attributed to the file and line given by the malloc overlay of gballoc.h, in an open
+addressing table keyed by the file string pointer and the line. Sites that do not fit in the table are added up in
+one "<other sites>" row. The table is only touched with the gballoc lock held. */
+
+#ifndef GBALLOC_MAX_ALLOCATION_SITES
+#define GBALLOC_MAX_ALLOCATION_SITES 1024
+#endif
+
+/*the first size histogram bucket holds the allocations up to this size*/
+#define GBALLOC_SIZE_HISTOGRAM_FIRST_LIMIT 16
+
+typedef struct ALLOCATION_SITE_TAG
+{
+    GBALLOC_SITE_STATS stats;
+    size_t lifetime_total;
+} ALLOCATION_SITE;
+
+static ALLOCATION_SITE sites[GBALLOC_MAX_ALLOCATION_SITES];
+static ALLOCATION_SITE other_sites;
+/*counts the tracked allocations, the lifetime of a block is the difference between its sequence and this at free*/
+static size_t allocationSequence = 0;
+
+static const char UNKNOWN_SITE_FILE[] = "<unknown>";
+static const char OTHER_SITES_FILE[] = "<other sites>";
+
+static void clear_sites(void)
+{
+    (void)memset(sites, 0, sizeof(sites));
+    (void)memset(&other_sites, 0, sizeof(other_sites));
+    other_sites.stats.file = OTHER_SITES_FILE;
+    allocationSequence = 0;
+}
+
+static void reset_site_metrics(ALLOCATION_SITE* site)
+{
+    site->stats.allocations = 0;
+    (void)memset(site->stats.size_histogram, 0, sizeof(site->stats.size_histogram));
+    site->stats.freed_blocks = 0;
+    site->stats.max_lifetime = 0;
+    site->lifetime_total = 0;
+}
+
+static void reset_sites_metrics(void)
+{
+    size_t i;
+    for (i = 0; i < GBALLOC_MAX_ALLOCATION_SITES; i++)
+    {
+        if (sites[i].stats.file != NULL)
+        {
+            reset_site_metrics(&sites[i]);
+        }
+    }
+    reset_site_metrics(&other_sites);
+}
+
+static ALLOCATION_SITE* find_site(const char* file, int line)
+{
+    ALLOCATION_SITE* result = &other_sites;
+    size_t index;
+    size_t probes;
+
+    if (file == NULL)
+    {
+        /*allocations made through gballoc_malloc instead of the overlay*/
+        file = UNKNOWN_SITE_FILE;
+    }
+
+    index = ((((size_t)(uintptr_t)file) >> 3) ^ ((size_t)line * 2654435761U)) % GBALLOC_MAX_ALLOCATION_SITES;
+    for (probes = 0; probes < GBALLOC_MAX_ALLOCATION_SITES; probes++)
+    {
+        ALLOCATION_SITE* site = &sites[index];
+        if (site->stats.file == NULL)
+        {
+            site->stats.file = file;
+            site->stats.line = line;
+            result = site;
+            break;
+        }
+        else if ((site->stats.file == file) && (site->stats.line == line))
+        {
+            result = site;
+            break;
+        }
+
+        index = (index + 1) % GBALLOC_MAX_ALLOCATION_SITES;
+    }
+
+    return result;
+}
+
+static void record_allocation(ALLOCATION* allocation, const char* file, int line)
+{
+    /* Codes_SRS_GBALLOC_11_004: [ When GB_TRACK_ALLOCATION_SITES is defined, every tracked allocation shall be counted for the file and line it was made at, with its size added to the live bytes and to the size histogram of the site. ]*/
+    ALLOCATION_SITE* site = find_site(file, line);
+    size_t bucket = 0;
+    size_t limit = GBALLOC_SIZE_HISTOGRAM_FIRST_LIMIT;
+
+    while ((bucket < GBALLOC_SIZE_HISTOGRAM_BUCKETS - 1) && (allocation->size > limit))
+    {
+        bucket++;
+        limit *= 2;
+    }
+
+    allocation->site = site;
+    allocation->sequence = allocationSequence++;
+    site->stats.allocations++;
+    site->stats.live_blocks++;
+    site->stats.live_bytes += allocation->size;
+    site->stats.size_histogram[bucket]++;
+}
+
+static void record_free(ALLOCATION* allocation)
+{
+    /* Codes_SRS_GBALLOC_11_005: [ When GB_TRACK_ALLOCATION_SITES is defined, freeing a tracked block shall remove it from the live blocks and bytes of its site and record its lifetime, counted in allocations made since the block was allocated. ]*/
+    ALLOCATION_SITE* site = allocation->site;
+    size_t lifetime = allocationSequence - allocation->sequence;
+
+    /*the site table is cleared by gballoc_init, blocks allocated before may point to a reused row*/
+    if (site->stats.live_blocks > 0)
+    {
+        site->stats.live_blocks--;
+    }
+    site->stats.live_bytes = (site->stats.live_bytes > allocation->size) ? (site->stats.live_bytes - allocation->size) : 0;
+    site->stats.freed_blocks++;
+    site->lifetime_total += lifetime;
+    if (site->stats.max_lifetime < lifetime)
+    {
+        site->stats.max_lifetime = lifetime;
+    }
+}
+
+static void record_reallocation(ALLOCATION* allocation, size_t new_size)
+{
+    /* Codes_SRS_GBALLOC_11_014: [ When GB_TRACK_ALLOCATION_SITES is defined, reallocating a tracked block shall keep it counted at the site and with the lifetime it was allocated with, only changing the live bytes of the site by the size difference. ]*/
+    ALLOCATION_SITE* site = allocation->site;
+
+    site->stats.live_bytes = (site->stats.live_bytes > allocation->size) ? (site->stats.live_bytes - allocation->size) : 0;
+    site->stats.live_bytes += new_size;
+}
+
+#else /* GB_TRACK_ALLOCATION_SITES */
+
+static void clear_sites(void)
+{
+}
+
+static void reset_sites_metrics(void)
+{
+}
+
+static void record_allocation(ALLOCATION* allocation, const char* file, int line)
+{
+    (void)allocation;
+    (void)file;
+    (void)line;
+}
+
+static void record_free(ALLOCATION* allocation)
+{
+    (void)allocation;
+}
+
+static void record_reallocation(ALLOCATION* allocation, size_t new_size)
+{
+    (void)allocation;
+    (void)new_size;
+}
+
+#endif /* GB_TRACK_ALLOCATION_SITES */
+
 int gballoc_init(void)
 {
     int result;
@@ -59,6 +704,7 @@ int gballoc_init(void)
         totalSize = 0;
         maxSize = 0;
         g_allocations = 0;
+        clear_sites();
 
         /* Codes_SRS_GBALLOC_01_024: [gballoc_init shall initialize the gballoc module and return 0 upon success.] */
         result = 0;
@@ -78,7 +724,7 @@ void gballoc_deinit(void)
     gballocState = GBALLOC_STATE_NOT_INIT;
 }
 
-void* gballoc_malloc(size_t size)
+static void* gballoc_malloc_internal(size_t size, const char* file, int line)
 {
     void* result;
 
@@ -117,6 +763,7 @@ void* gballoc_malloc(size_t size)
                 allocation->size = size;
                 allocation->next = head;
                 head = allocation;
+                record_allocation(allocation, file, line);
 
                 g_allocations++;
                 totalSize += size;
@@ -134,7 +781,7 @@ void* gballoc_malloc(size_t size)
     return result;
 }
 
-void* gballoc_calloc(size_t nmemb, size_t size)
+static void* gballoc_calloc_internal(size_t nmemb, size_t size, const char* file, int line)
 {
     void* result;
 
@@ -173,6 +820,7 @@ void* gballoc_calloc(size_t nmemb, size_t size)
                 allocation->size = nmemb * size;
                 allocation->next = head;
                 head = allocation;
+                record_allocation(allocation, file, line);
                 g_allocations++;
 
                 totalSize += allocation->size;
@@ -190,7 +838,7 @@ void* gballoc_calloc(size_t nmemb, size_t size)
     return result;
 }
 
-void* gballoc_realloc(void* ptr, size_t size)
+static void* gballoc_realloc_internal(void* ptr, size_t size, const char* file, int line)
 {
     ALLOCATION* curr;
     void* result;
@@ -256,6 +904,7 @@ void* gballoc_realloc(void* ptr, size_t size)
                     /* Codes_SRS_GBALLOC_01_006: [If the underlying realloc call is successful, gballoc_realloc shall look up the size associated with the pointer ptr and decrease the total memory used with that size.] */
                     allocation->ptr = result;
                     totalSize -= allocation->size;
+                    record_reallocation(allocation, size);
                     allocation->size = size;
                 }
                 else
@@ -265,6 +914,7 @@ void* gballoc_realloc(void* ptr, size_t size)
                     allocation->size = size;
                     allocation->next = head;
                     head = allocation;
+                    record_allocation(allocation, file, line);
                 }
 
                 /* Codes_SRS_GBALLOC_01_007: [If realloc is successful, gballoc_realloc shall also increment the total memory used value tracked by this module.] */
@@ -285,6 +935,21 @@ void* gballoc_realloc(void* ptr, size_t size)
     return result;
 }
 
+void* gballoc_malloc(size_t size)
+{
+    return gballoc_malloc_internal(size, NULL, 0);
+}
+
+void* gballoc_calloc(size_t nmemb, size_t size)
+{
+    return gballoc_calloc_internal(nmemb, size, NULL, 0);
+}
+
+void* gballoc_realloc(void* ptr, size_t size)
+{
+    return gballoc_realloc_internal(ptr, size, NULL, 0);
+}
+
 void gballoc_free(void* ptr)
 {
     ALLOCATION* curr = head;
@@ -311,6 +976,7 @@ void gballoc_free(void* ptr)
                 /* Codes_SRS_GBALLOC_01_008: [gballoc_free shall call the C99 free function.] */
                 free(ptr);
                 totalSize -= curr->size;
+                record_free(curr);
                 if (prev != NULL)
                 {
                     prev->next = curr->next;
@@ -446,8 +1112,180 @@ void gballoc_resetMetrics()
         totalSize = 0;
         maxSize = 0;
         g_allocations = 0;
+        /* Codes_SRS_GBALLOC_11_008: [ When GB_TRACK_ALLOCATION_SITES is defined, gballoc_resetMetrics shall also reset the allocation counts, size histograms and lifetimes of all sites, keeping their live blocks and bytes. ]*/
+        reset_sites_metrics();
+        (void)Unlock(gballocThreadSafeLock);
+    }
+}
+
+#if defined(GB_DEBUG_ALLOC)
+
+void* gballoc_malloc_at(size_t size, const char* file, int line)
+{
+    return gballoc_malloc_internal(size, file, line);
+}
+
+void* gballoc_calloc_at(size_t nmemb, size_t size, const char* file, int line)
+{
+    return gballoc_calloc_internal(nmemb, size, file, line);
+}
+
+void* gballoc_realloc_at(void* ptr, size_t size, const char* file, int line)
+{
+    return gballoc_realloc_internal(ptr, size, file, line);
+}
+
+#if defined(GB_TRACK_ALLOCATION_SITES)
+
+static size_t get_site_key(const ALLOCATION_SITE* site, GBALLOC_SITE_ORDER order)
+{
+    return (order == GBALLOC_SITE_ORDER_BY_LIVE_BYTES) ? site->stats.live_bytes : site->stats.allocations;
+}
+
+/*sites are ranked by key, ties broken by their address so that each pass over the table picks the next one exactly once*/
+static int site_ranks_before(const ALLOCATION_SITE* site, size_t key, const ALLOCATION_SITE* other, size_t other_key)
+{
+    return (key > other_key) || ((key == other_key) && (site < other));
+}
+
+size_t gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER order, GBALLOC_SITE_STATS* sites_stats, size_t site_count)
+{
+    size_t result;
+
+    if ((sites_stats == NULL) && (site_count > 0))
+    {
+        /* Codes_SRS_GBALLOC_11_009: [ If sites is NULL and site_count is not 0, gballoc_getTopAllocationSites shall return 0. ]*/
+        LogError("Invalid arguments: GBALLOC_SITE_STATS* sites=%p, size_t site_count=%zu", sites_stats, site_count);
+        result = 0;
+    }
+    else if (gballocState != GBALLOC_STATE_INIT)
+    {
+        LogError("gballoc is not initialized.");
+        result = 0;
+    }
+    else if (LOCK_OK != Lock(gballocThreadSafeLock))
+    {
+        LogError("Failed to get the Lock.");
+        result = 0;
+    }
+    else
+    {
+        const ALLOCATION_SITE* previous = NULL;
+        size_t previous_key = 0;
+
+        /* Codes_SRS_GBALLOC_11_006: [ gballoc_getTopAllocationSites shall copy to sites the statistics of at most site_count sites, in decreasing order of live bytes for GBALLOC_SITE_ORDER_BY_LIVE_BYTES or of allocations for GBALLOC_SITE_ORDER_BY_ALLOCATIONS, skipping the sites for which that value is 0, and return the number of sites copied. ]*/
+        for (result = 0; result < site_count; result++)
+        {
+            const ALLOCATION_SITE* best = NULL;
+            size_t best_key = 0;
+            size_t i;
+
+            for (i = 0; i <= GBALLOC_MAX_ALLOCATION_SITES; i++)
+            {
+                const ALLOCATION_SITE* site = (i < GBALLOC_MAX_ALLOCATION_SITES) ? &sites[i] : &other_sites;
+                size_t key = get_site_key(site, order);
+
+                if ((site->stats.file != NULL) &&
+                    (key > 0) &&
+                    ((previous == NULL) || site_ranks_before(previous, previous_key, site, key)) &&
+                    ((best == NULL) || site_ranks_before(site, key, best, best_key)))
+                {
+                    best = site;
+                    best_key = key;
+                }
+            }
+
+            if (best == NULL)
+            {
+                break;
+            }
+
+            sites_stats[result] = best->stats;
+            /* Codes_SRS_GBALLOC_11_007: [ The average lifetime of a site shall be the sum of the lifetimes of its freed blocks divided by their number, 0 when none was freed. ]*/
+            sites_stats[result].average_lifetime = (best->stats.freed_blocks == 0) ? 0 : (best->lifetime_total / best->stats.freed_blocks);
+            previous = best;
+            previous_key = best_key;
+        }
+
         (void)Unlock(gballocThreadSafeLock);
     }
+
+    return result;
+}
+
+void gballoc_logTopAllocationSites(GBALLOC_SITE_ORDER order, size_t site_count)
+{
+    GBALLOC_SITE_STATS* top_sites;
+
+    if ((site_count == 0) ||
+        (site_count > SIZE_MAX / sizeof(GBALLOC_SITE_STATS)))
+    {
+        LogError("Invalid arguments: size_t site_count=%zu", site_count);
+    }
+    else if ((top_sites = (GBALLOC_SITE_STATS*)malloc(site_count * sizeof(GBALLOC_SITE_STATS))) == NULL)
+    {
+        LogError("Failure allocating the allocation sites");
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_11_010: [ gballoc_logTopAllocationSites shall log one line per site returned by gballoc_getTopAllocationSites, including its size histogram. ]*/
+        size_t count = gballoc_getTopAllocationSites(order, top_sites, site_count);
+        size_t i;
+
+        for (i = 0; i < count; i++)
+        {
+            char histogram[GBALLOC_SIZE_HISTOGRAM_BUCKETS * 24];
+            size_t written = 0;
+            size_t bucket;
+            size_t limit = GBALLOC_SIZE_HISTOGRAM_FIRST_LIMIT;
+
+            histogram[0] = '\0';
+            for (bucket = 0; bucket < GBALLOC_SIZE_HISTOGRAM_BUCKETS; bucket++)
+            {
+                int printed = (bucket < GBALLOC_SIZE_HISTOGRAM_BUCKETS - 1) ?
+                    snprintf(histogram + written, sizeof(histogram) - written, " <=%zu:%zu", limit, top_sites[i].size_histogram[bucket]) :
+                    snprintf(histogram + written, sizeof(histogram) - written, " >%zu:%zu", limit / 2, top_sites[i].size_histogram[bucket]);
+                if ((printed < 0) || ((size_t)printed >= sizeof(histogram) - written))
+                {
+                    break;
+                }
+                written += (size_t)printed;
+                limit *= 2;
+            }
+
+            LogInfo("%s:%d live_bytes=%zu live_blocks=%zu allocations=%zu freed=%zu average_lifetime=%zu max_lifetime=%zu sizes:%s",
+                top_sites[i].file, top_sites[i].line, top_sites[i].live_bytes, top_sites[i].live_blocks, top_sites[i].allocations,
+                top_sites[i].freed_blocks, top_sites[i].average_lifetime, top_sites[i].max_lifetime, histogram);
+        }
+
+        free(top_sites);
+    }
+}
+
+#else /* GB_TRACK_ALLOCATION_SITES */
+
+size_t gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER order, GBALLOC_SITE_STATS* sites_stats, size_t site_count)
+{
+    /* Codes_SRS_GBALLOC_11_011: [ When GB_TRACK_ALLOCATION_SITES is not defined, gballoc_getTopAllocationSites shall return 0 and gballoc_logTopAllocationSites shall only log an error. ]*/
+    (void)order;
+    (void)sites_stats;
+    (void)site_count;
+    LogError("allocation sites are not tracked, build with GB_TRACK_ALLOCATION_SITES");
+    return 0;
+}
+
+void gballoc_logTopAllocationSites(GBALLOC_SITE_ORDER order, size_t site_count)
+{
+    /* Codes_SRS_GBALLOC_11_011: [ When GB_TRACK_ALLOCATION_SITES is not defined, gballoc_getTopAllocationSites shall return 0 and gballoc_logTopAllocationSites shall only log an error. ]*/
+    (void)order;
+    (void)site_count;
+    LogError("allocation sites are not tracked, build with GB_TRACK_ALLOCATION_SITES");
 }
 
+#endif /* GB_TRACK_ALLOCATION_SITES */
+
+#endif /* GB_DEBUG_ALLOC */
+
+#endif /* GB_USE_INLINE_TRACKING */
+
 #endif // GB_USE_CUSTOM_HEAP
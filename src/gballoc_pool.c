@@ -0,0 +1,682 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc_pool.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#if defined(GB_USE_POOL_HEAP)
+
+/* Requests up to the largest size class are served from slabs of GBALLOC_POOL_SLAB_SIZE bytes carved into blocks
+of one class. Each thread keeps up to GBALLOC_POOL_THREAD_CACHE_SIZE free blocks per class, so most allocations and
+frees touch no shared state. When the thread cache runs empty or overflows half of it is exchanged with the shared
+list of the class, under a spin lock (Lock_Init itself allocates, so the lock module cannot be used here).
+A thread registers for a flush of its cache the first time it caches a block, so the blocks of a thread that exits
+go back to the shared lists (pthread key destructor, FLS callback on Windows).
+Slabs are kept for the lifetime of the process. */
+
+#ifndef GBALLOC_POOL_SLAB_SIZE
+#define GBALLOC_POOL_SLAB_SIZE 16384
+#endif
+
+#ifndef GBALLOC_POOL_THREAD_CACHE_SIZE
+#define GBALLOC_POOL_THREAD_CACHE_SIZE 32
+#endif
+
+/*number of allocations and frees of a class after which a thread publishes its counters*/
+#ifndef GBALLOC_POOL_STATS_PUBLISH_INTERVAL
+#define GBALLOC_POOL_STATS_PUBLISH_INTERVAL 64
+#endif
+
+#ifndef GBALLOC_POOL_CACHE_LINE_SIZE
+#define GBALLOC_POOL_CACHE_LINE_SIZE 64
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GBALLOC_POOL_THREAD_LOCAL __declspec(thread)
+#if defined(_WIN64)
+#define GBALLOC_POOL_ATOMIC_ADD(target, value) ((void)_InterlockedExchangeAdd64((volatile __int64*)(target), (__int64)(value)))
+#else
+#define GBALLOC_POOL_ATOMIC_ADD(target, value) ((void)_InterlockedExchangeAdd((volatile long*)(target), (long)(value)))
+#endif
+#define GBALLOC_POOL_TRY_LOCK(lock) (_InterlockedExchange((lock), 1) == 0)
+#define GBALLOC_POOL_UNLOCK(lock) ((void)_InterlockedExchange((lock), 0))
+#elif defined(__GNUC__)
+#define GBALLOC_POOL_THREAD_LOCAL __thread
+#define GBALLOC_POOL_ATOMIC_ADD(target, value) ((void)__sync_fetch_and_add((target), (value)))
+#define GBALLOC_POOL_TRY_LOCK(lock) (__sync_lock_test_and_set((lock), 1) == 0)
+#define GBALLOC_POOL_UNLOCK(lock) __sync_lock_release(lock)
+#if defined(__ATOMIC_RELAXED)
+#define GBALLOC_POOL_ATOMIC_LOAD(target) __atomic_load_n((target), __ATOMIC_RELAXED)
+#endif
+#else
+#error GB_USE_POOL_HEAP requires thread local storage and atomic operations that are not known for this compiler
+#endif
+
+#ifndef GBALLOC_POOL_ATOMIC_LOAD
+#define GBALLOC_POOL_ATOMIC_LOAD(target) (*(target))
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/*largest request served by each class; must be multiples of the header size so that every block stays aligned*/
+static const size_t pool_class_sizes[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+#define POOL_CLASS_COUNT (sizeof(pool_class_sizes) / sizeof(pool_class_sizes[0]))
+
+/*size class recorded for requests too large for any class, these are malloc-ed directly*/
+#define POOL_LARGE_CLASS POOL_CLASS_COUNT
+
+/*precedes every block; the union keeps the memory returned to the caller aligned as malloc would align it*/
+typedef union POOL_BLOCK_HEADER_TAG
+{
+    struct
+    {
+        size_t size_class;
+        size_t size;
+    } info;
+    long double align_long_double;
+    long long align_long_long;
+    void* align_pointer;
+} POOL_BLOCK_HEADER;
+
+typedef union POOL_SLAB_TAG
+{
+    union POOL_SLAB_TAG* next;
+    long double align_long_double;
+    long long align_long_long;
+} POOL_SLAB;
+
+typedef struct POOL_CLASS_TAG
+{
+    volatile long lock;
+    POOL_BLOCK_HEADER* free_blocks;
+    POOL_SLAB* slabs;
+    volatile size_t hits;
+    volatile size_t misses;
+    volatile size_t allocated_blocks;
+    volatile size_t freed_blocks;
+    volatile size_t allocated_bytes;
+    volatile size_t freed_bytes;
+    volatile size_t bytes_reserved;
+    /*keeps the lock of one class off the cache line of the next one*/
+    unsigned char padding[GBALLOC_POOL_CACHE_LINE_SIZE];
+} POOL_CLASS;
+
+typedef struct POOL_THREAD_CACHE_TAG
+{
+    POOL_BLOCK_HEADER* free_blocks;
+    size_t free_block_count;
+    size_t operations;
+    size_t hits;
+    size_t misses;
+    size_t allocated_blocks;
+    size_t freed_blocks;
+    size_t allocated_bytes;
+    size_t freed_bytes;
+} POOL_THREAD_CACHE;
+
+static POOL_CLASS pool_classes[POOL_CLASS_COUNT];
+static GBALLOC_POOL_THREAD_LOCAL POOL_THREAD_CACHE thread_caches[POOL_CLASS_COUNT];
+
+/*set once the calling thread has asked to have its cache flushed when it exits*/
+static GBALLOC_POOL_THREAD_LOCAL int thread_exit_flush_registered;
+
+static volatile size_t large_allocated_blocks;
+static volatile size_t large_freed_blocks;
+static volatile size_t large_allocated_bytes;
+static volatile size_t large_freed_bytes;
+
+/*the free list link lives in the block memory, right after the header*/
+static POOL_BLOCK_HEADER* get_next_free_block(POOL_BLOCK_HEADER* block)
+{
+    return *(POOL_BLOCK_HEADER**)(void*)(block + 1);
+}
+
+static void set_next_free_block(POOL_BLOCK_HEADER* block, POOL_BLOCK_HEADER* next)
+{
+    *(POOL_BLOCK_HEADER**)(void*)(block + 1) = next;
+}
+
+static void lock_class(POOL_CLASS* pool_class)
+{
+    while (!GBALLOC_POOL_TRY_LOCK(&pool_class->lock))
+    {
+        while (GBALLOC_POOL_ATOMIC_LOAD(&pool_class->lock) != 0)
+        {
+        }
+    }
+}
+
+static void on_thread_exit(void* value)
+{
+    (void)value;
+    /*a destructor running after this one may free pooled blocks again, they register the thread once more*/
+    thread_exit_flush_registered = 0;
+    gballoc_pool_flush_thread_cache();
+}
+
+#if defined(_WIN32)
+
+static INIT_ONCE thread_exit_flush_once = INIT_ONCE_STATIC_INIT;
+static DWORD thread_exit_flush_index = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI on_fiber_storage_released(PVOID value)
+{
+    on_thread_exit(value);
+}
+
+static BOOL CALLBACK create_thread_exit_flush_index(PINIT_ONCE init_once, PVOID parameter, PVOID* context)
+{
+    (void)init_once;
+    (void)parameter;
+    (void)context;
+    thread_exit_flush_index = FlsAlloc(on_fiber_storage_released);
+    return TRUE;
+}
+
+static void register_thread_exit_flush(void)
+{
+    if (thread_exit_flush_registered == 0)
+    {
+        thread_exit_flush_registered = 1;
+        if ((!InitOnceExecuteOnce(&thread_exit_flush_once, create_thread_exit_flush_index, NULL, NULL)) ||
+            (thread_exit_flush_index == FLS_OUT_OF_INDEXES) ||
+            (!FlsSetValue(thread_exit_flush_index, (PVOID)&thread_exit_flush_once)))
+        {
+            LogError("Failure registering the thread cache flush, call gballoc_pool_flush_thread_cache before the thread exits");
+        }
+    }
+}
+
+#else
+
+static pthread_once_t thread_exit_flush_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_exit_flush_key;
+static int thread_exit_flush_key_created;
+
+static void create_thread_exit_flush_key(void)
+{
+    thread_exit_flush_key_created = (pthread_key_create(&thread_exit_flush_key, on_thread_exit) == 0);
+}
+
+static void register_thread_exit_flush(void)
+{
+    if (thread_exit_flush_registered == 0)
+    {
+        thread_exit_flush_registered = 1;
+        /*the destructor only runs for a non-NULL value*/
+        if ((pthread_once(&thread_exit_flush_once, create_thread_exit_flush_key) != 0) ||
+            (!thread_exit_flush_key_created) ||
+            (pthread_setspecific(thread_exit_flush_key, (void*)&thread_exit_flush_once) != 0))
+        {
+            LogError("Failure registering the thread cache flush, call gballoc_pool_flush_thread_cache before the thread exits");
+        }
+    }
+}
+
+#endif
+
+static size_t select_class(size_t size)
+{
+    size_t result = 0;
+    while ((result < POOL_CLASS_COUNT) && (pool_class_sizes[result] < size))
+    {
+        result++;
+    }
+    return result;
+}
+
+static void publish_thread_counters(POOL_CLASS* pool_class, POOL_THREAD_CACHE* cache)
+{
+    GBALLOC_POOL_ATOMIC_ADD(&pool_class->hits, cache->hits);
+    GBALLOC_POOL_ATOMIC_ADD(&pool_class->misses, cache->misses);
+    GBALLOC_POOL_ATOMIC_ADD(&pool_class->allocated_blocks, cache->allocated_blocks);
+    GBALLOC_POOL_ATOMIC_ADD(&pool_class->freed_blocks, cache->freed_blocks);
+    GBALLOC_POOL_ATOMIC_ADD(&pool_class->allocated_bytes, cache->allocated_bytes);
+    GBALLOC_POOL_ATOMIC_ADD(&pool_class->freed_bytes, cache->freed_bytes);
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->allocated_blocks = 0;
+    cache->freed_blocks = 0;
+    cache->allocated_bytes = 0;
+    cache->freed_bytes = 0;
+    cache->operations = 0;
+}
+
+static void count_thread_operation(POOL_CLASS* pool_class, POOL_THREAD_CACHE* cache)
+{
+    cache->operations++;
+    if (cache->operations >= GBALLOC_POOL_STATS_PUBLISH_INTERVAL)
+    {
+        publish_thread_counters(pool_class, cache);
+    }
+}
+
+static int refill_thread_cache(size_t class_index, POOL_THREAD_CACHE* cache)
+{
+    int result;
+    POOL_CLASS* pool_class = &pool_classes[class_index];
+    size_t wanted = (GBALLOC_POOL_THREAD_CACHE_SIZE / 2) + 1;
+
+    /* Codes_SRS_GBALLOC_POOL_11_015: [ When a thread that cached blocks exits, its cache shall be flushed as gballoc_pool_flush_thread_cache does. ]*/
+    register_thread_exit_flush();
+
+    lock_class(pool_class);
+    while ((cache->free_block_count < wanted) && (pool_class->free_blocks != NULL))
+    {
+        POOL_BLOCK_HEADER* block = pool_class->free_blocks;
+        pool_class->free_blocks = get_next_free_block(block);
+        set_next_free_block(block, cache->free_blocks);
+        cache->free_blocks = block;
+        cache->free_block_count++;
+    }
+    GBALLOC_POOL_UNLOCK(&pool_class->lock);
+
+    if (cache->free_block_count > 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        /*the shared list is empty too, carve a new slab outside of the lock*/
+        size_t stride = sizeof(POOL_BLOCK_HEADER) + pool_class_sizes[class_index];
+        size_t slab_size = GBALLOC_POOL_SLAB_SIZE;
+        POOL_SLAB* slab;
+
+        if (slab_size < sizeof(POOL_SLAB) + stride)
+        {
+            slab_size = sizeof(POOL_SLAB) + stride;
+        }
+
+        slab = (POOL_SLAB*)malloc(slab_size);
+        if (slab == NULL)
+        {
+            LogError("Failure allocating a slab of %zu bytes", slab_size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned char* blocks = (unsigned char*)(slab + 1);
+            size_t block_count = (slab_size - sizeof(POOL_SLAB)) / stride;
+            POOL_BLOCK_HEADER* shared_head = NULL;
+            POOL_BLOCK_HEADER* shared_tail = NULL;
+            size_t i;
+
+            for (i = 0; i < block_count; i++)
+            {
+                POOL_BLOCK_HEADER* block = (POOL_BLOCK_HEADER*)(void*)(blocks + (i * stride));
+                block->info.size_class = class_index;
+                block->info.size = 0;
+                if (i < wanted)
+                {
+                    set_next_free_block(block, cache->free_blocks);
+                    cache->free_blocks = block;
+                    cache->free_block_count++;
+                }
+                else
+                {
+                    set_next_free_block(block, shared_head);
+                    if (shared_tail == NULL)
+                    {
+                        shared_tail = block;
+                    }
+                    shared_head = block;
+                }
+            }
+
+            lock_class(pool_class);
+            slab->next = pool_class->slabs;
+            pool_class->slabs = slab;
+            if (shared_tail != NULL)
+            {
+                set_next_free_block(shared_tail, pool_class->free_blocks);
+                pool_class->free_blocks = shared_head;
+            }
+            GBALLOC_POOL_UNLOCK(&pool_class->lock);
+
+            GBALLOC_POOL_ATOMIC_ADD(&pool_class->bytes_reserved, slab_size);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*moves the blocks cached by the thread above keep_count back to the shared list of the class*/
+static void trim_thread_cache(size_t class_index, POOL_THREAD_CACHE* cache, size_t keep_count)
+{
+    if (cache->free_block_count > keep_count)
+    {
+        POOL_CLASS* pool_class = &pool_classes[class_index];
+        POOL_BLOCK_HEADER* head = cache->free_blocks;
+        POOL_BLOCK_HEADER* tail = head;
+
+        while (cache->free_block_count > keep_count + 1)
+        {
+            tail = get_next_free_block(tail);
+            cache->free_block_count--;
+        }
+        cache->free_blocks = get_next_free_block(tail);
+        cache->free_block_count--;
+
+        lock_class(pool_class);
+        set_next_free_block(tail, pool_class->free_blocks);
+        pool_class->free_blocks = head;
+        GBALLOC_POOL_UNLOCK(&pool_class->lock);
+    }
+}
+
+static void* large_malloc(size_t size)
+{
+    void* result;
+
+    if (size > SIZE_MAX - sizeof(POOL_BLOCK_HEADER))
+    {
+        LogError("size %zu too large", size);
+        result = NULL;
+    }
+    else
+    {
+        POOL_BLOCK_HEADER* header = (POOL_BLOCK_HEADER*)malloc(sizeof(POOL_BLOCK_HEADER) + size);
+        if (header == NULL)
+        {
+            result = NULL;
+        }
+        else
+        {
+            header->info.size_class = POOL_LARGE_CLASS;
+            header->info.size = size;
+            GBALLOC_POOL_ATOMIC_ADD(&large_allocated_blocks, 1);
+            GBALLOC_POOL_ATOMIC_ADD(&large_allocated_bytes, size);
+            result = header + 1;
+        }
+    }
+
+    return result;
+}
+
+void* gballoc_malloc(size_t size)
+{
+    void* result;
+    size_t class_index = select_class(size);
+
+    if (class_index == POOL_LARGE_CLASS)
+    {
+        /* Codes_SRS_GBALLOC_POOL_11_003: [ If size is larger than the largest size class, gballoc_malloc shall allocate the block with malloc. ]*/
+        result = large_malloc(size);
+    }
+    else
+    {
+        POOL_CLASS* pool_class = &pool_classes[class_index];
+        POOL_THREAD_CACHE* cache = &thread_caches[class_index];
+
+        if (cache->free_blocks != NULL)
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_001: [ gballoc_malloc shall take the block from the calling thread's cache of the smallest size class that fits size and count a hit. ]*/
+            cache->hits++;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_002: [ If the thread's cache is empty, gballoc_malloc shall count a miss and move blocks from the shared list of the class to the thread's cache, carving a new slab when the shared list is empty. ]*/
+            cache->misses++;
+        }
+
+        if ((cache->free_blocks == NULL) &&
+            (refill_thread_cache(class_index, cache) != 0))
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_004: [ If allocating a slab fails, gballoc_malloc shall return NULL. ]*/
+            result = NULL;
+        }
+        else
+        {
+            POOL_BLOCK_HEADER* block = cache->free_blocks;
+            cache->free_blocks = get_next_free_block(block);
+            cache->free_block_count--;
+
+            block->info.size = size;
+            cache->allocated_blocks++;
+            cache->allocated_bytes += size;
+            count_thread_operation(pool_class, cache);
+            result = block + 1;
+        }
+    }
+
+    return result;
+}
+
+void* gballoc_calloc(size_t nmemb, size_t size)
+{
+    void* result;
+
+    if ((size != 0) && (nmemb > SIZE_MAX / size))
+    {
+        LogError("nmemb %zu * size %zu too large", nmemb, size);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_GBALLOC_POOL_11_005: [ gballoc_calloc shall allocate nmemb * size bytes as gballoc_malloc does and set them to 0. ]*/
+        result = gballoc_malloc(nmemb * size);
+        if (result != NULL)
+        {
+            (void)memset(result, 0, nmemb * size);
+        }
+    }
+
+    return result;
+}
+
+void gballoc_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        POOL_BLOCK_HEADER* block = ((POOL_BLOCK_HEADER*)ptr) - 1;
+        size_t class_index = block->info.size_class;
+
+        if (class_index > POOL_LARGE_CLASS)
+        {
+            LogError("Could not free allocation for address %p (not allocated by the pool)", ptr);
+        }
+        else if (class_index == POOL_LARGE_CLASS)
+        {
+            GBALLOC_POOL_ATOMIC_ADD(&large_freed_blocks, 1);
+            GBALLOC_POOL_ATOMIC_ADD(&large_freed_bytes, block->info.size);
+            free(block);
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_006: [ gballoc_free shall return a pooled block to the calling thread's cache. ]*/
+            POOL_CLASS* pool_class = &pool_classes[class_index];
+            POOL_THREAD_CACHE* cache = &thread_caches[class_index];
+
+            if (cache->free_block_count == 0)
+            {
+                /*blocks allocated by other threads can be the first this thread caches*/
+                register_thread_exit_flush();
+            }
+
+            cache->freed_blocks++;
+            cache->freed_bytes += block->info.size;
+
+            set_next_free_block(block, cache->free_blocks);
+            cache->free_blocks = block;
+            cache->free_block_count++;
+
+            if (cache->free_block_count > GBALLOC_POOL_THREAD_CACHE_SIZE)
+            {
+                /* Codes_SRS_GBALLOC_POOL_11_007: [ When the thread's cache holds more than GBALLOC_POOL_THREAD_CACHE_SIZE blocks of the class, gballoc_free shall move half of them to the shared list of the class. ]*/
+                trim_thread_cache(class_index, cache, GBALLOC_POOL_THREAD_CACHE_SIZE / 2);
+            }
+
+            count_thread_operation(pool_class, cache);
+        }
+    }
+}
+
+void* gballoc_realloc(void* ptr, size_t size)
+{
+    void* result;
+
+    if (ptr == NULL)
+    {
+        result = gballoc_malloc(size);
+    }
+    else
+    {
+        POOL_BLOCK_HEADER* block = ((POOL_BLOCK_HEADER*)ptr) - 1;
+        size_t old_class_index = block->info.size_class;
+        size_t old_size = block->info.size;
+        size_t class_index = select_class(size);
+
+        if (old_class_index > POOL_LARGE_CLASS)
+        {
+            LogError("Could not realloc allocation for address %p (not allocated by the pool)", ptr);
+            result = NULL;
+        }
+        else if ((old_class_index == POOL_LARGE_CLASS) && (class_index == POOL_LARGE_CLASS))
+        {
+            POOL_BLOCK_HEADER* new_block;
+
+            if (size > SIZE_MAX - sizeof(POOL_BLOCK_HEADER))
+            {
+                LogError("size %zu too large", size);
+                result = NULL;
+            }
+            else if ((new_block = (POOL_BLOCK_HEADER*)realloc(block, sizeof(POOL_BLOCK_HEADER) + size)) == NULL)
+            {
+                result = NULL;
+            }
+            else
+            {
+                new_block->info.size = size;
+                GBALLOC_POOL_ATOMIC_ADD(&large_freed_bytes, old_size);
+                GBALLOC_POOL_ATOMIC_ADD(&large_allocated_bytes, size);
+                result = new_block + 1;
+            }
+        }
+        else if (old_class_index == class_index)
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_008: [ If size still maps to the size class of ptr, gballoc_realloc shall return ptr without moving the block. ]*/
+            POOL_THREAD_CACHE* cache = &thread_caches[class_index];
+            cache->freed_bytes += old_size;
+            cache->allocated_bytes += size;
+            block->info.size = size;
+            result = ptr;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_009: [ Otherwise gballoc_realloc shall allocate a new block, copy the content of ptr to it and free ptr. ]*/
+            result = gballoc_malloc(size);
+            if (result != NULL)
+            {
+                (void)memcpy(result, ptr, (old_size < size) ? old_size : size);
+                gballoc_free(ptr);
+            }
+        }
+    }
+
+    return result;
+}
+
+size_t gballoc_pool_get_class_count(void)
+{
+    return POOL_CLASS_COUNT;
+}
+
+int gballoc_pool_get_class_stats(size_t class_index, GBALLOC_POOL_CLASS_STATS* stats)
+{
+    int result;
+
+    if ((stats == NULL) ||
+        (class_index > POOL_CLASS_COUNT))
+    {
+        /* Codes_SRS_GBALLOC_POOL_11_010: [ If stats is NULL or class_index is larger than the class count, gballoc_pool_get_class_stats shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: size_t class_index=%zu, GBALLOC_POOL_CLASS_STATS* stats=%p", class_index, stats);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t allocated_blocks;
+        size_t freed_blocks;
+        size_t allocated_bytes;
+        size_t freed_bytes;
+
+        if (class_index == POOL_LARGE_CLASS)
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_012: [ If class_index is equal to the class count, gballoc_pool_get_class_stats shall report the requests too large for any class, with block_size 0, every allocation counted as a miss and bytes_reserved equal to bytes_in_use. ]*/
+            allocated_blocks = GBALLOC_POOL_ATOMIC_LOAD(&large_allocated_blocks);
+            freed_blocks = GBALLOC_POOL_ATOMIC_LOAD(&large_freed_blocks);
+            allocated_bytes = GBALLOC_POOL_ATOMIC_LOAD(&large_allocated_bytes);
+            freed_bytes = GBALLOC_POOL_ATOMIC_LOAD(&large_freed_bytes);
+            stats->block_size = 0;
+            stats->hits = 0;
+            stats->misses = allocated_blocks;
+        }
+        else
+        {
+            /* Codes_SRS_GBALLOC_POOL_11_011: [ gballoc_pool_get_class_stats shall fill stats with the block size, hits, misses, blocks and bytes in use and bytes reserved of the class, as published by all threads. ]*/
+            POOL_CLASS* pool_class = &pool_classes[class_index];
+            allocated_blocks = GBALLOC_POOL_ATOMIC_LOAD(&pool_class->allocated_blocks);
+            freed_blocks = GBALLOC_POOL_ATOMIC_LOAD(&pool_class->freed_blocks);
+            allocated_bytes = GBALLOC_POOL_ATOMIC_LOAD(&pool_class->allocated_bytes);
+            freed_bytes = GBALLOC_POOL_ATOMIC_LOAD(&pool_class->freed_bytes);
+            stats->block_size = pool_class_sizes[class_index];
+            stats->hits = GBALLOC_POOL_ATOMIC_LOAD(&pool_class->hits);
+            stats->misses = GBALLOC_POOL_ATOMIC_LOAD(&pool_class->misses);
+        }
+
+        /*a block freed on one thread can be published before its allocation on another thread*/
+        stats->blocks_in_use = (allocated_blocks > freed_blocks) ? allocated_blocks - freed_blocks : 0;
+        stats->bytes_in_use = (allocated_bytes > freed_bytes) ? allocated_bytes - freed_bytes : 0;
+        stats->bytes_reserved = (class_index == POOL_LARGE_CLASS) ? stats->bytes_in_use : GBALLOC_POOL_ATOMIC_LOAD(&pool_classes[class_index].bytes_reserved);
+
+        result = 0;
+    }
+
+    return result;
+}
+
+void gballoc_pool_flush_thread_cache(void)
+{
+    size_t i;
+
+    /* Codes_SRS_GBALLOC_POOL_11_013: [ gballoc_pool_flush_thread_cache shall move all the blocks cached by the calling thread to the shared lists and publish the thread's counters. ]*/
+    for (i = 0; i < POOL_CLASS_COUNT; i++)
+    {
+        trim_thread_cache(i, &thread_caches[i], 0);
+        publish_thread_counters(&pool_classes[i], &thread_caches[i]);
+    }
+}
+
+#else /* GB_USE_POOL_HEAP */
+
+size_t gballoc_pool_get_class_count(void)
+{
+    /* Codes_SRS_GBALLOC_POOL_11_014: [ When GB_USE_POOL_HEAP is not defined, gballoc_pool_get_class_count shall return 0, gballoc_pool_get_class_stats shall fail and gballoc_pool_flush_thread_cache shall do nothing. ]*/
+    return 0;
+}
+
+int gballoc_pool_get_class_stats(size_t class_index, GBALLOC_POOL_CLASS_STATS* stats)
+{
+    /* Codes_SRS_GBALLOC_POOL_11_014: [ When GB_USE_POOL_HEAP is not defined, gballoc_pool_get_class_count shall return 0, gballoc_pool_get_class_stats shall fail and gballoc_pool_flush_thread_cache shall do nothing. ]*/
+    (void)class_index;
+    (void)stats;
+    LogError("the pool allocator is not built in, build with use_pool_heap");
+    return __FAILURE__;
+}
+
+void gballoc_pool_flush_thread_cache(void)
+{
+}
+
+#endif /* GB_USE_POOL_HEAP */
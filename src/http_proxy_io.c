@@ -881,7 +881,13 @@ static int http_proxy_io_send(CONCRETE_IO_HANDLE http_proxy_io, const void* buff
         else
         {
             /* Codes_SRS_HTTP_PROXY_IO_01_033: [ `http_proxy_io_send` shall send the bytes by calling `xio_send` on the underlying IO created in `http_proxy_io_create` and passing `buffer` and `size` as arguments. ]*/
-            if (xio_send(http_proxy_io_instance->underlying_io, buffer, size, on_send_complete, on_send_complete_context) != 0)
+            int send_result = xio_send(http_proxy_io_instance->underlying_io, buffer, size, on_send_complete, on_send_complete_context);
+            if (send_result == XIO_SEND_WOULD_BLOCK)
+            {
+                /* Codes_SRS_HTTP_PROXY_IO_11_001: [ If `xio_send` returns `XIO_SEND_WOULD_BLOCK`, `http_proxy_io_send` shall return `XIO_SEND_WOULD_BLOCK`. ]*/
+                result = XIO_SEND_WOULD_BLOCK;
+            }
+            else if (send_result != 0)
             {
                 /* Codes_SRS_HTTP_PROXY_IO_01_055: [ If `xio_send` fails, `http_proxy_io_send` shall fail and return a non-zero value. ]*/
                 result = __LINE__;
@@ -952,6 +958,38 @@ static int http_proxy_io_set_option(CONCRETE_IO_HANDLE http_proxy_io, const char
     return result;
 }
 
+static int http_proxy_io_get_option(CONCRETE_IO_HANDLE http_proxy_io, const char* option_name, void* value)
+{
+    int result;
+
+    if ((http_proxy_io == NULL) || (option_name == NULL) || (value == NULL))
+    {
+        /* Codes_SRS_HTTP_PROXY_IO_11_002: [ If any of the arguments `http_proxy_io`, `option_name` or `value` is NULL, `http_proxy_io_get_option` shall return a non-zero value. ]*/
+        LogError("Bad arguments: http_proxy_io = %p, option_name = %p, value = %p",
+            http_proxy_io, option_name, value);
+        result = __LINE__;
+    }
+    else
+    {
+        HTTP_PROXY_IO_INSTANCE* http_proxy_io_instance = (HTTP_PROXY_IO_INSTANCE*)http_proxy_io;
+
+        /* Codes_SRS_HTTP_PROXY_IO_11_003: [ `http_proxy_io_get_option` shall call `xio_getoption` on the underlying IO created in `http_proxy_io_create`, passing the option name and value to it. ]*/
+        if (xio_getoption(http_proxy_io_instance->underlying_io, option_name, value) != 0)
+        {
+            /* Codes_SRS_HTTP_PROXY_IO_11_004: [ If `xio_getoption` fails, `http_proxy_io_get_option` shall return a non-zero value. ]*/
+            LogError("Unable to query option %s on the underlying IO", option_name);
+            result = __LINE__;
+        }
+        else
+        {
+            /* Codes_SRS_HTTP_PROXY_IO_11_005: [ On success, `http_proxy_io_get_option` shall return 0. ]*/
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
 static OPTIONHANDLER_HANDLE http_proxy_io_retrieve_options(CONCRETE_IO_HANDLE http_proxy_io)
 {
     OPTIONHANDLER_HANDLE result;
@@ -986,7 +1024,9 @@ static const IO_INTERFACE_DESCRIPTION http_proxy_io_interface_description =
     http_proxy_io_close,
     http_proxy_io_send,
     http_proxy_io_dowork,
-    http_proxy_io_set_option
+    http_proxy_io_set_option,
+    NULL,
+    http_proxy_io_get_option
 };
 
 const IO_INTERFACE_DESCRIPTION* http_proxy_io_get_interface_description(void)
@@ -553,24 +553,27 @@ static int createOrUpdateOption(HTTPAPIEX_HANDLE_DATA* handleData, const char* o
     }
     else
     {
-        HTTPAPIEX_SAVED_OPTION newOption;
-        if (mallocAndStrcpy_s((char**)&(newOption.optionName), optionName) != 0)
+        char* cloneOfOptionName;
+        if (mallocAndStrcpy_s(&cloneOfOptionName, optionName) != 0)
         {
             free((void*)value);
             result = __FAILURE__;
         }
         else
         {
-            newOption.value = value;
-            if (VECTOR_push_back(handleData->savedOptions, &newOption, 1) != 0)
+            /*the new option is filled in directly in the vector's storage*/
+            HTTPAPIEX_SAVED_OPTION* newOption = (HTTPAPIEX_SAVED_OPTION*)VECTOR_emplace_back(handleData->savedOptions, 1);
+            if (newOption == NULL)
             {
-                LogError("unable to VECTOR_push_back");
-                free((void*)newOption.optionName);
+                LogError("unable to VECTOR_emplace_back");
+                free(cloneOfOptionName);
                 free((void*)value);
                 result = __FAILURE__;
             }
             else
             {
+                newOption->optionName = cloneOfOptionName;
+                newOption->value = value;
                 result = 0;
             }
         }
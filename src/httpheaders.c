@@ -3,7 +3,6 @@
 
 #include <stdlib.h>
 #include "azure_c_shared_utility/gballoc.h"
-#include "azure_c_shared_utility/map.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include <string.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -11,11 +10,184 @@
 
 DEFINE_ENUM_STRINGS(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 
+#ifndef HTTP_HEADERS_INITIAL_CAPACITY
+#define HTTP_HEADERS_INITIAL_CAPACITY 8
+#endif
+
+/*every header is kept as a single "name: value" line so that it can be handed out without copying*/
+typedef struct HTTP_HEADER_TAG
+{
+    char* line;
+    size_t nameLength;
+    size_t lineLength;
+    size_t hash;
+} HTTP_HEADER;
+
 typedef struct HTTP_HEADERS_HANDLE_DATA_TAG
 {
-    MAP_HANDLE headers;
+    HTTP_HEADER* headers;
+    size_t count;
+    size_t capacity;
+    size_t* hashIndex; /*open addressing, a slot holds 1 + the position of the header, 0 means empty*/
+    size_t hashIndexSize; /*always a power of 2, twice the capacity*/
+    size_t serializedSize;
 } HTTP_HEADERS_HANDLE_DATA;
 
+static char headers_ToLower(char c)
+{
+    return ((c >= 'A') && (c <= 'Z')) ? (char)(c - 'A' + 'a') : c;
+}
+
+/*FNV-1a over the lower case name*/
+static size_t headers_HashName(const char* name, size_t nameLength)
+{
+    size_t result = (size_t)2166136261u;
+    size_t i;
+    for (i = 0; i < nameLength; i++)
+    {
+        result ^= (unsigned char)headers_ToLower(name[i]);
+        result *= (size_t)16777619u;
+    }
+    return result;
+}
+
+static bool headers_NameEquals(const HTTP_HEADER* header, const char* name, size_t nameLength, size_t hash)
+{
+    bool result;
+    if ((header->hash != hash) || (header->nameLength != nameLength))
+    {
+        result = false;
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < nameLength; i++)
+        {
+            if (headers_ToLower(header->line[i]) != headers_ToLower(name[i]))
+            {
+                break;
+            }
+        }
+        result = (i == nameLength);
+    }
+    return result;
+}
+
+static void headers_IndexInsert(size_t* hashIndex, size_t hashIndexSize, size_t hash, size_t position)
+{
+    size_t slot = hash & (hashIndexSize - 1);
+    while (hashIndex[slot] != 0)
+    {
+        slot = (slot + 1) & (hashIndexSize - 1);
+    }
+    hashIndex[slot] = position + 1;
+}
+
+/*returns the header having name (compared case insensitive) or NULL*/
+static HTTP_HEADER* headers_Find(HTTP_HEADERS_HANDLE_DATA* handleData, const char* name, size_t nameLength, size_t hash)
+{
+    HTTP_HEADER* result = NULL;
+    if (handleData->hashIndex != NULL)
+    {
+        size_t slot = hash & (handleData->hashIndexSize - 1);
+        while (handleData->hashIndex[slot] != 0)
+        {
+            HTTP_HEADER* header = &handleData->headers[handleData->hashIndex[slot] - 1];
+            if (headers_NameEquals(header, name, nameLength, hash))
+            {
+                result = header;
+                break;
+            }
+            slot = (slot + 1) & (handleData->hashIndexSize - 1);
+        }
+    }
+    return result;
+}
+
+/*makes room for one more header. The hash index is rebuilt from the stored hashes, so no name is ever hashed twice*/
+static int headers_EnsureCapacity(HTTP_HEADERS_HANDLE_DATA* handleData)
+{
+    int result;
+    if (handleData->count < handleData->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newCapacity = (handleData->capacity == 0) ? HTTP_HEADERS_INITIAL_CAPACITY : handleData->capacity * 2;
+        HTTP_HEADER* newHeaders = (HTTP_HEADER*)realloc(handleData->headers, newCapacity * sizeof(HTTP_HEADER));
+        if (newHeaders == NULL)
+        {
+            LogError("unable to realloc headers");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t newHashIndexSize = 1;
+            size_t* newHashIndex;
+            handleData->headers = newHeaders;
+
+            while (newHashIndexSize < newCapacity * 2)
+            {
+                newHashIndexSize *= 2;
+            }
+
+            newHashIndex = (size_t*)malloc(newHashIndexSize * sizeof(size_t));
+            if (newHashIndex == NULL)
+            {
+                /*the larger headers array is kept, capacity is only updated together with the index*/
+                LogError("unable to malloc hash index");
+                result = __FAILURE__;
+            }
+            else
+            {
+                size_t i;
+                (void)memset(newHashIndex, 0, newHashIndexSize * sizeof(size_t));
+                for (i = 0; i < handleData->count; i++)
+                {
+                    headers_IndexInsert(newHashIndex, newHashIndexSize, handleData->headers[i].hash, i);
+                }
+                free(handleData->hashIndex);
+                handleData->hashIndex = newHashIndex;
+                handleData->hashIndexSize = newHashIndexSize;
+                handleData->capacity = newCapacity;
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+/*builds "name: value" followed by existingValue + ", " (when existingValue is not NULL) and value*/
+static char* headers_BuildLine(const char* name, size_t nameLength, const char* existingValue, size_t existingValueLength, const char* value, size_t valueLength, size_t* lineLength)
+{
+    size_t newLineLength = nameLength + /*COLON_AND_SPACE_LENGTH*/ 2 + ((existingValue != NULL) ? (existingValueLength + /*COMMA_AND_SPACE_LENGTH*/ 2) : 0) + valueLength;
+    char* result = (char*)malloc(newLineLength + /*EOL*/ 1);
+    if (result == NULL)
+    {
+        LogError("unable to malloc header line");
+    }
+    else
+    {
+        char* runLine = result;
+        (void)memcpy(runLine, name, nameLength);
+        runLine += nameLength;
+        (*runLine++) = ':';
+        (*runLine++) = ' ';
+        if (existingValue != NULL)
+        {
+            (void)memcpy(runLine, existingValue, existingValueLength);
+            runLine += existingValueLength;
+            (*runLine++) = ',';
+            (*runLine++) = ' ';
+        }
+        (void)memcpy(runLine, value, valueLength);
+        runLine[valueLength] = '\0';
+        *lineLength = newLineLength;
+    }
+    return result;
+}
+
 HTTP_HEADERS_HANDLE HTTPHeaders_Alloc(void)
 {
     /*Codes_SRS_HTTP_HEADERS_99_002:[ This API shall produce a HTTP_HANDLE that can later be used in subsequent calls to the module.]*/
@@ -24,25 +196,21 @@ HTTP_HEADERS_HANDLE HTTPHeaders_Alloc(void)
 
     if (result == NULL)
     {
+        /*Codes_SRS_HTTP_HEADERS_99_003:[ The function shall return NULL when the function cannot execute properly]*/
         LogError("malloc failed");
     }
     else
     {
         /*Codes_SRS_HTTP_HEADERS_99_004:[ After a successful init, HTTPHeaders_GetHeaderCount shall report 0 existing headers.]*/
-        result->headers = Map_Create(NULL);
-        if (result->headers == NULL)
-        {
-            LogError("Map_Create failed");
-            free(result);
-            result = NULL;
-        }
-        else
-        {
-            /*all is fine*/
-        }
+        /*Codes_SRS_HTTP_HEADERS_11_001: [ Storage for the headers shall only be allocated when the first header is added. ]*/
+        result->headers = NULL;
+        result->count = 0;
+        result->capacity = 0;
+        result->hashIndex = NULL;
+        result->hashIndexSize = 0;
+        result->serializedSize = 0;
     }
 
-    /*Codes_SRS_HTTP_HEADERS_99_003:[ The function shall return NULL when the function cannot execute properly]*/
     return (HTTP_HEADERS_HANDLE)result;
 }
 
@@ -58,8 +226,13 @@ void HTTPHeaders_Free(HTTP_HEADERS_HANDLE handle)
     {
         /*Codes_SRS_HTTP_HEADERS_99_005:[ Calling this API shall de-allocate the data structures allocated by previous API calls to the same handle.]*/
         HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
-
-        Map_Destroy(handleData->headers);
+        size_t i;
+        for (i = 0; i < handleData->count; i++)
+        {
+            free(handleData->headers[i].line);
+        }
+        free(handleData->headers);
+        free(handleData->hashIndex);
         free(handleData);
     }
 }
@@ -100,61 +273,67 @@ static HTTP_HEADERS_RESULT headers_ReplaceHeaderNameValuePair(HTTP_HEADERS_HANDL
         else
         {
             HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
-            const char* existingValue = Map_GetValueFromKey(handleData->headers, name);
+            /*Codes_SRS_HTTP_HEADERS_11_002: [ Header names shall be compared case insensitive. ]*/
+            size_t hash = headers_HashName(name, nameLen);
+            HTTP_HEADER* existingHeader = headers_Find(handleData, name, nameLen, hash);
+            size_t valueLen;
             /*eat up the whitespaces from value, as per RFC 2616, chapter 4.2 "The field value MAY be preceded by any amount of LWS, though a single SP is preferred."*/
             /*Codes_SRS_HTTP_HEADERS_02_002: [The LWS from the beginning of the value shall not be stored.] */
             while ((value[0] == ' ') || (value[0] == '\t') || (value[0] == '\r') || (value[0] == '\n'))
             {
                 value++;
             }
+            valueLen = strlen(value);
 
-            if (!replace && (existingValue != NULL))
+            if (existingHeader != NULL)
             {
-                size_t existingValueLen = strlen(existingValue);
-                size_t valueLen = strlen(value);
-                char* newValue = (char*)malloc(sizeof(char) * (existingValueLen + /*COMMA_AND_SPACE_LENGTH*/ 2 + valueLen + /*EOL*/ 1));
-                if (newValue == NULL)
+                /*the new line is built before the old one is released, value might point inside the old one*/
+                /*Codes_SRS_HTTP_HEADERS_11_003: [ When the name already exists, the stored name shall keep the casing it was first added with. ]*/
+                size_t newLineLength;
+                const char* existingValue = existingHeader->line + existingHeader->nameLength + /*COLON_AND_SPACE_LENGTH*/ 2;
+                size_t existingValueLen = existingHeader->lineLength - existingHeader->nameLength - /*COLON_AND_SPACE_LENGTH*/ 2;
+                /*Codes_SRS_HTTP_HEADERS_99_017:[ If the name already exists in the collection of headers, the function shall concatenate the new value after the existing value, separated by a comma and a space as in: old-value+", "+new-value.]*/
+                char* newLine = headers_BuildLine(existingHeader->line, existingHeader->nameLength, replace ? NULL : existingValue, existingValueLen, value, valueLen, &newLineLength);
+                if (newLine == NULL)
                 {
                     /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
                     result = HTTP_HEADERS_ALLOC_FAILED;
-                    LogError("failed to malloc , result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+                    LogError("failed to build header line, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
                 }
                 else
                 {
-                    char* runNewValue;
-                    /*Codes_SRS_HTTP_HEADERS_99_017:[ If the name already exists in the collection of headers, the function shall concatenate the new value after the existing value, separated by a comma and a space as in: old-value+", "+new-value.]*/
-                    (void)memcpy(newValue, existingValue, existingValueLen);
-                    runNewValue = newValue + existingValueLen;
-                    (*runNewValue++) = ',';
-                    (*runNewValue++) = ' ';
-                    (void)memcpy(runNewValue, value, valueLen + /*EOL*/ 1);
-
-                    /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
-                    if (Map_AddOrUpdate(handleData->headers, name, newValue) != MAP_OK)
-                    {
-                        /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
-                        result = HTTP_HEADERS_ERROR;
-                        LogError("failed to Map_AddOrUpdate, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-                    }
-                    else
-                    {
-                        /*Codes_SRS_HTTP_HEADERS_99_013:[ The function shall return HTTP_HEADERS_OK when execution is successful.]*/
-                        result = HTTP_HEADERS_OK;
-                    }
-                    free(newValue);
+                    free(existingHeader->line);
+                    handleData->serializedSize = handleData->serializedSize - existingHeader->lineLength + newLineLength;
+                    existingHeader->line = newLine;
+                    existingHeader->lineLength = newLineLength;
+                    /*Codes_SRS_HTTP_HEADERS_99_013:[ The function shall return HTTP_HEADERS_OK when execution is successful.]*/
+                    result = HTTP_HEADERS_OK;
                 }
             }
+            else if (headers_EnsureCapacity(handleData) != 0)
+            {
+                /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+                result = HTTP_HEADERS_ALLOC_FAILED;
+                LogError("failed to grow headers, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+            }
             else
             {
                 /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
-                if (Map_AddOrUpdate(handleData->headers, name, value) != MAP_OK)
+                HTTP_HEADER* newHeader = &handleData->headers[handleData->count];
+                newHeader->line = headers_BuildLine(name, nameLen, NULL, 0, value, valueLen, &newHeader->lineLength);
+                if (newHeader->line == NULL)
                 {
                     /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
                     result = HTTP_HEADERS_ALLOC_FAILED;
-                    LogError("failed to Map_AddOrUpdate, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+                    LogError("failed to build header line, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
                 }
                 else
                 {
+                    newHeader->nameLength = nameLen;
+                    newHeader->hash = hash;
+                    headers_IndexInsert(handleData->hashIndex, handleData->hashIndexSize, hash, handleData->count);
+                    handleData->count++;
+                    handleData->serializedSize += newHeader->lineLength + /*CRLF*/ 2;
                     result = HTTP_HEADERS_OK;
                 }
             }
@@ -192,8 +371,11 @@ const char* HTTPHeaders_FindHeaderValue(HTTP_HEADERS_HANDLE httpHeadersHandle, c
         /*Codes_SRS_HTTP_HEADERS_99_018:[ Calling this API shall retrieve the value for a previously stored name.]*/
         /*Codes_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.] */
         /*Codes_SRS_HTTP_HEADERS_99_021:[ In this case the return value shall point to a string that shall strcmp equal to the original stored string.]*/
+        /*Codes_SRS_HTTP_HEADERS_11_002: [ Header names shall be compared case insensitive. ]*/
         HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)httpHeadersHandle;
-        result = Map_GetValueFromKey(handleData->headers, name);
+        size_t nameLength = strlen(name);
+        HTTP_HEADER* header = headers_Find(handleData, name, nameLength, headers_HashName(name, nameLength));
+        result = (header == NULL) ? NULL : header->line + header->nameLength + /*COLON_AND_SPACE_LENGTH*/ 2;
     }
     return result;
 
@@ -212,21 +394,11 @@ HTTP_HEADERS_RESULT HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE handle, size_
     }
     else
     {
-        HTTP_HEADERS_HANDLE_DATA *handleData = (HTTP_HEADERS_HANDLE_DATA *)handle;
-        const char*const* keys;
-        const char*const* values;
         /*Codes_SRS_HTTP_HEADERS_99_023:[ Calling this API shall provide the number of stored headers.]*/
-        if (Map_GetInternals(handleData->headers, &keys, &values, headerCount) != MAP_OK)
-        {
-            /*Codes_SRS_HTTP_HEADERS_99_037:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs.]*/
-            result = HTTP_HEADERS_ERROR;
-            LogError("Map_GetInternals failed, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-        }
-        else
-        {
-            /*Codes_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
-            result = HTTP_HEADERS_OK;
-        }
+        /*Codes_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
+        HTTP_HEADERS_HANDLE_DATA *handleData = (HTTP_HEADERS_HANDLE_DATA *)handle;
+        *headerCount = handleData->count;
+        result = HTTP_HEADERS_OK;
     }
 
     return result;
@@ -247,52 +419,116 @@ HTTP_HEADERS_RESULT HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t ind
         result = HTTP_HEADERS_INVALID_ARG;
         LogError("invalid arg (NULL), result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
     }
-    /*Codes_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
     else
     {
         HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
-        const char*const* keys;
-        const char*const* values;
-        size_t headerCount;
-        if (Map_GetInternals(handleData->headers, &keys, &values, &headerCount) != MAP_OK)
+        /*Codes_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
+        if (index >= handleData->count)
         {
-            /*Codes_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-            result = HTTP_HEADERS_ERROR;
-            LogError("Map_GetInternals failed, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+            result = HTTP_HEADERS_INVALID_ARG;
+            LogError("index out of bounds, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
         }
         else
         {
-            /*Codes_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
-            if (index >= headerCount)
+            const HTTP_HEADER* header = &handleData->headers[index];
+            *destination = (char*)malloc(sizeof(char) * (header->lineLength + /*EOL*/ 1));
+            if (*destination == NULL)
             {
-                result = HTTP_HEADERS_INVALID_ARG;
-                LogError("index out of bounds, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+                /*Codes_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
+                result = HTTP_HEADERS_ERROR;
+                LogError("unable to malloc, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
             }
             else
             {
-                size_t keyLen = strlen(keys[index]);
-                size_t valueLen = strlen(values[index]);
-                *destination = (char*)malloc(sizeof(char) * (keyLen + /*COLON_AND_SPACE_LENGTH*/ 2 + valueLen + /*EOL*/ 1));
-                if (*destination == NULL)
-                {
-                    /*Codes_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-                    result = HTTP_HEADERS_ERROR;
-                    LogError("unable to malloc, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
-                }
-                else
-                {
-                    /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
-                    /*Codes_SRS_HTTP_HEADERS_99_027:[ Calling this API shall produce the string value+": "+pair) for the index header in the *destination parameter.]*/
-                    char* runDestination = (*destination);
-                    (void)memcpy(runDestination, keys[index], keyLen);
-                    runDestination += keyLen;
-                    (*runDestination++) = ':';
-                    (*runDestination++) = ' ';
-                    (void)memcpy(runDestination, values[index], valueLen + /*EOL*/ 1);
-                    /*Codes_SRS_HTTP_HEADERS_99_035:[ The function shall return HTTP_HEADERS_OK when the function executed without error.]*/
-                    result = HTTP_HEADERS_OK;
-                }
+                /*Codes_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
+                /*Codes_SRS_HTTP_HEADERS_99_027:[ Calling this API shall produce the string value+": "+pair) for the index header in the *destination parameter.]*/
+                (void)memcpy(*destination, header->line, header->lineLength + /*EOL*/ 1);
+                /*Codes_SRS_HTTP_HEADERS_99_035:[ The function shall return HTTP_HEADERS_OK when the function executed without error.]*/
+                result = HTTP_HEADERS_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
+HTTP_HEADERS_RESULT HTTPHeaders_GetHeaderSpan(HTTP_HEADERS_HANDLE handle, size_t index, HTTP_HEADER_SPAN* header)
+{
+    HTTP_HEADERS_RESULT result;
+
+    /*Codes_SRS_HTTP_HEADERS_11_004: [ If handle is NULL or header is NULL then HTTPHeaders_GetHeaderSpan shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (header == NULL)
+        )
+    {
+        result = HTTP_HEADERS_INVALID_ARG;
+        LogError("invalid arg (NULL), result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+    }
+    else
+    {
+        HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
+        /*Codes_SRS_HTTP_HEADERS_11_005: [ If index is not smaller than the number of stored headers then HTTPHeaders_GetHeaderSpan shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        if (index >= handleData->count)
+        {
+            result = HTTP_HEADERS_INVALID_ARG;
+            LogError("index out of bounds, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_HTTP_HEADERS_11_006: [ Otherwise HTTPHeaders_GetHeaderSpan shall fill header with pointers into the stored name, value and name+": "+value line, without allocating memory, and return HTTP_HEADERS_OK. ]*/
+            const HTTP_HEADER* storedHeader = &handleData->headers[index];
+            header->name = storedHeader->line;
+            header->nameLength = storedHeader->nameLength;
+            header->value = storedHeader->line + storedHeader->nameLength + /*COLON_AND_SPACE_LENGTH*/ 2;
+            header->valueLength = storedHeader->lineLength - storedHeader->nameLength - /*COLON_AND_SPACE_LENGTH*/ 2;
+            header->line = storedHeader->line;
+            header->lineLength = storedHeader->lineLength;
+            result = HTTP_HEADERS_OK;
+        }
+    }
+
+    return result;
+}
+
+HTTP_HEADERS_RESULT HTTPHeaders_Serialize(HTTP_HEADERS_HANDLE handle, char* destination, size_t destinationSize, size_t* serializedSize)
+{
+    HTTP_HEADERS_RESULT result;
+
+    /*Codes_SRS_HTTP_HEADERS_11_007: [ If handle is NULL or serializedSize is NULL then HTTPHeaders_Serialize shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+    /*Codes_SRS_HTTP_HEADERS_11_008: [ If destination is NULL and destinationSize is not 0 then HTTPHeaders_Serialize shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (serializedSize == NULL) ||
+        ((destination == NULL) && (destinationSize != 0))
+        )
+    {
+        result = HTTP_HEADERS_INVALID_ARG;
+        LogError("invalid arg, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+    }
+    else
+    {
+        HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
+        /*Codes_SRS_HTTP_HEADERS_11_009: [ HTTPHeaders_Serialize shall write in *serializedSize the number of bytes needed to hold every header as name+": "+value+"\r\n". ]*/
+        *serializedSize = handleData->serializedSize;
+        if (destinationSize < handleData->serializedSize)
+        {
+            /*Codes_SRS_HTTP_HEADERS_11_010: [ If destinationSize is smaller than that then HTTPHeaders_Serialize shall return HTTP_HEADERS_INSUFFICIENT_BUFFER without writing to destination. ]*/
+            result = HTTP_HEADERS_INSUFFICIENT_BUFFER;
+        }
+        else
+        {
+            /*Codes_SRS_HTTP_HEADERS_11_011: [ Otherwise HTTPHeaders_Serialize shall write all the headers in insertion order in a single pass, without a terminating '\0', and return HTTP_HEADERS_OK. ]*/
+            char* runDestination = destination;
+            size_t i;
+            for (i = 0; i < handleData->count; i++)
+            {
+                (void)memcpy(runDestination, handleData->headers[i].line, handleData->headers[i].lineLength);
+                runDestination += handleData->headers[i].lineLength;
+                (*runDestination++) = '\r';
+                (*runDestination++) = '\n';
             }
+            result = HTTP_HEADERS_OK;
         }
     }
 
@@ -314,20 +550,65 @@ HTTP_HEADERS_HANDLE HTTPHeaders_Clone(HTTP_HEADERS_HANDLE handle)
         if (result == NULL)
         {
             /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+            LogError("unable to malloc");
         }
         else
         {
             HTTP_HEADERS_HANDLE_DATA* handleData = handle;
-            result->headers = Map_Clone(handleData->headers);
-            if (result->headers == NULL)
-            {
-                /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
-                free(result);
-                result = NULL;
-            }
-            else
+            result->headers = NULL;
+            result->count = 0;
+            result->capacity = 0;
+            result->hashIndex = NULL;
+            result->hashIndexSize = 0;
+            result->serializedSize = 0;
+
+            if (handleData->count > 0)
             {
-                /*all is fine*/
+                size_t i;
+                result->headers = (HTTP_HEADER*)malloc(handleData->capacity * sizeof(HTTP_HEADER));
+                result->hashIndex = (size_t*)malloc(handleData->hashIndexSize * sizeof(size_t));
+                if ((result->headers == NULL) || (result->hashIndex == NULL))
+                {
+                    /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+                    LogError("unable to malloc storage");
+                    i = 0;
+                }
+                else
+                {
+                    for (i = 0; i < handleData->count; i++)
+                    {
+                        result->headers[i] = handleData->headers[i];
+                        result->headers[i].line = (char*)malloc(handleData->headers[i].lineLength + /*EOL*/ 1);
+                        if (result->headers[i].line == NULL)
+                        {
+                            LogError("unable to malloc header line");
+                            break;
+                        }
+                        (void)memcpy(result->headers[i].line, handleData->headers[i].line, handleData->headers[i].lineLength + /*EOL*/ 1);
+                    }
+                }
+
+                if (i < handleData->count)
+                {
+                    /*Codes_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+                    size_t j;
+                    for (j = 0; j < i; j++)
+                    {
+                        free(result->headers[j].line);
+                    }
+                    free(result->headers);
+                    free(result->hashIndex);
+                    free(result);
+                    result = NULL;
+                }
+                else
+                {
+                    (void)memcpy(result->hashIndex, handleData->hashIndex, handleData->hashIndexSize * sizeof(size_t));
+                    result->count = handleData->count;
+                    result->capacity = handleData->capacity;
+                    result->hashIndexSize = handleData->hashIndexSize;
+                    result->serializedSize = handleData->serializedSize;
+                }
             }
         }
     }
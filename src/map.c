@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/map.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -10,11 +11,20 @@
 
 DEFINE_ENUM_STRINGS(MAP_RESULT, MAP_RESULT_VALUES);
 
+#ifndef MAP_HASH_INDEX_THRESHOLD
+/*maps that can hold fewer pairs than this are searched linearly, which beats hashing for a handful of keys*/
+#define MAP_HASH_INDEX_THRESHOLD 8
+#endif
+
 typedef struct MAP_HANDLE_DATA_TAG
 {
     char** keys;
     char** values;
-    size_t count;
+    size_t count; /*number of slots in use in keys and values, including the ones of deleted pairs*/
+    size_t deletedCount; /*slots of deleted pairs, their key and value are NULL until Map_Compact removes them*/
+    size_t capacity; /*number of slots allocated in keys and values*/
+    size_t* hashIndex; /*open addressing table, a slot holds 1 + the position of a key in keys, 0 means the slot is empty*/
+    size_t hashIndexSize; /*a power of 2, at least twice capacity*/
     MAP_FILTER_CALLBACK mapFilterCallback;
 }MAP_HANDLE_DATA;
 
@@ -31,6 +41,10 @@ MAP_HANDLE Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
         result->keys = NULL;
         result->values = NULL;
         result->count = 0;
+        result->deletedCount = 0;
+        result->capacity = 0;
+        result->hashIndex = NULL;
+        result->hashIndexSize = 0;
         result->mapFilterCallback = mapFilterFunc;
     }
     return (MAP_HANDLE)result;
@@ -52,10 +66,153 @@ void Map_Destroy(MAP_HANDLE handle)
         }
         free(handleData->keys);
         free(handleData->values);
+        if (handleData->hashIndex != NULL)
+        {
+            free(handleData->hashIndex);
+        }
         free(handleData);
     }
 }
 
+/*FNV-1a*/
+static size_t Map_HashKey(const char* key)
+{
+    size_t hash = (size_t)2166136261u;
+    while (*key != '\0')
+    {
+        hash ^= (unsigned char)(*key);
+        hash *= (size_t)16777619u;
+        key++;
+    }
+    return hash;
+}
+
+static void Map_IndexInsert(MAP_HANDLE_DATA* handleData, size_t position)
+{
+    size_t mask = handleData->hashIndexSize - 1;
+    size_t slot = Map_HashKey(handleData->keys[position]) & mask;
+    while (handleData->hashIndex[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    handleData->hashIndex[slot] = position + 1;
+}
+
+static size_t Map_IndexFind(MAP_HANDLE_DATA* handleData, size_t position)
+{
+    size_t mask = handleData->hashIndexSize - 1;
+    size_t slot = Map_HashKey(handleData->keys[position]) & mask;
+    while (handleData->hashIndex[slot] != position + 1)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*removes the key at "position" from the hash index, the positions of the other keys do not change*/
+static void Map_IndexRemove(MAP_HANDLE_DATA* handleData, size_t position)
+{
+    size_t mask = handleData->hashIndexSize - 1;
+    size_t slot = Map_IndexFind(handleData, position);
+    size_t next;
+
+    /*backward shift deletion: pull later entries of the same probe run into the hole so that no tombstones are needed*/
+    next = (slot + 1) & mask;
+    while (handleData->hashIndex[next] != 0)
+    {
+        /*the entry at next can fill the hole if the hole lies between its home slot and next*/
+        size_t home = Map_HashKey(handleData->keys[handleData->hashIndex[next] - 1]) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            handleData->hashIndex[slot] = handleData->hashIndex[next];
+            slot = next;
+        }
+        next = (next + 1) & mask;
+    }
+    handleData->hashIndex[slot] = 0;
+}
+
+/*removes the slots of deleted pairs, keeping the order of the others. Only the index entries of the pairs that move are
+rewritten, so this costs O(count) and no memory is allocated*/
+static void Map_Compact(MAP_HANDLE_DATA* handleData)
+{
+    if (handleData->deletedCount > 0)
+    {
+        size_t i;
+        size_t j = 0;
+        for (i = 0; i < handleData->count; i++)
+        {
+            if (handleData->keys[i] != NULL)
+            {
+                if (i != j)
+                {
+                    if (handleData->hashIndex != NULL)
+                    {
+                        /*positions are rewritten in increasing order, so i + 1 can only be found in the entry of this key*/
+                        handleData->hashIndex[Map_IndexFind(handleData, i)] = j + 1;
+                    }
+                    handleData->keys[j] = handleData->keys[i];
+                    handleData->values[j] = handleData->values[i];
+                }
+                j++;
+            }
+        }
+        handleData->count = j;
+        handleData->deletedCount = 0;
+    }
+}
+
+/*(re)builds the hash index so that it can hold handleData->capacity keys. The index only speeds up lookups, so when it cannot be
+allocated the map keeps working with linear searches*/
+static void Map_RebuildIndex(MAP_HANDLE_DATA* handleData)
+{
+    if (handleData->capacity >= MAP_HASH_INDEX_THRESHOLD)
+    {
+        size_t newSize = 1;
+        size_t* newIndex;
+        while ((newSize < handleData->capacity * 2) && (newSize <= SIZE_MAX / 2))
+        {
+            newSize *= 2;
+        }
+
+        if (newSize > SIZE_MAX / sizeof(size_t))
+        {
+            newIndex = NULL;
+        }
+        else
+        {
+            newIndex = (size_t*)malloc(newSize * sizeof(size_t));
+        }
+
+        if (handleData->hashIndex != NULL)
+        {
+            free(handleData->hashIndex);
+        }
+
+        if (newIndex == NULL)
+        {
+            /*Codes_SRS_MAP_11_004: [ If the hash index cannot be allocated, the map shall keep working by searching the keys linearly. ]*/
+            LogError("unable to allocate the hash index, lookups fall back to a linear search");
+            handleData->hashIndex = NULL;
+            handleData->hashIndexSize = 0;
+        }
+        else
+        {
+            size_t i;
+            (void)memset(newIndex, 0, newSize * sizeof(size_t));
+            handleData->hashIndex = newIndex;
+            handleData->hashIndexSize = newSize;
+            for (i = 0; i < handleData->count; i++)
+            {
+                if (handleData->keys[i] != NULL)
+                {
+                    Map_IndexInsert(handleData, i);
+                }
+            }
+        }
+    }
+}
+
 /*makes a copy of a vector of const char*, having size "size". source cannot be NULL*/
 /*returns NULL if it fails*/
 static char** Map_CloneVector(const char*const * source, size_t count)
@@ -108,6 +265,7 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
     else
     {
         MAP_HANDLE_DATA * handleData = (MAP_HANDLE_DATA *)handle;
+        Map_Compact(handleData);
         result = (MAP_HANDLE_DATA*)malloc(sizeof(MAP_HANDLE_DATA));
         if (result == NULL)
         {
@@ -117,9 +275,13 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
         }
         else
         {
+            result->hashIndex = NULL;
+            result->hashIndexSize = 0;
+            result->deletedCount = 0;
             if (handleData->count == 0)
             {
                 result->count = 0;
+                result->capacity = 0;
                 result->keys = NULL;
                 result->values = NULL;
                 result->mapFilterCallback = NULL;
@@ -128,6 +290,7 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
             {
                 result->mapFilterCallback = handleData->mapFilterCallback;
                 result->count = handleData->count;
+                result->capacity = handleData->count;
                 if( (result->keys = Map_CloneVector((const char* const*)handleData->keys, handleData->count))==NULL)
                 {
                     /*Codes_SRS_MAP_02_047: [If during cloning, any operation fails, then Map_Clone shall return NULL.] */
@@ -150,7 +313,8 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
                 }
                 else
                 {
-                    /*all fine, return it*/
+                    /*Codes_SRS_MAP_11_003: [ Once a map can hold MAP_HASH_INDEX_THRESHOLD pairs, lookups by key shall go through a hash index and shall not scan all the keys. ]*/
+                    Map_RebuildIndex(result);
                 }
             }
         }
@@ -158,89 +322,103 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
     return (MAP_HANDLE)result;
 }
 
+/*makes room for one more pair at the end of keys and values (both set to NULL) and increases handleData->count*/
 static int Map_IncreaseStorageKeysValues(MAP_HANDLE_DATA* handleData)
 {
     int result;
-    char** newKeys = (char**)realloc(handleData->keys, (handleData->count + 1) * sizeof(char*));
-    if (newKeys == NULL)
+    if (handleData->count == handleData->capacity)
     {
-        LogError("realloc error");
-        result = __FAILURE__;
+        /*reusing the slots of deleted pairs comes before growing*/
+        Map_Compact(handleData);
+    }
+
+    if (handleData->count < handleData->capacity)
+    {
+        result = 0;
     }
     else
     {
-        char** newValues;
-        handleData->keys = newKeys;
-        handleData->keys[handleData->count] = NULL;
-        newValues = (char**)realloc(handleData->values, (handleData->count + 1) * sizeof(char*));
-        if (newValues == NULL)
+        /*Codes_SRS_MAP_11_001: [ When the storage of the map is full, it shall be grown to twice its capacity. ]*/
+        size_t newCapacity = (handleData->capacity == 0) ? 1 : handleData->capacity * 2;
+        if (newCapacity > SIZE_MAX / sizeof(char*))
         {
-            LogError("realloc error");
-            if (handleData->count == 0) /*avoiding an implementation defined behavior */
+            LogError("map too big");
+            result = __FAILURE__;
+        }
+        else
+        {
+            char** newKeys = (char**)realloc(handleData->keys, newCapacity * sizeof(char*));
+            if (newKeys == NULL)
             {
-                free(handleData->keys);
-                handleData->keys = NULL;
+                LogError("realloc error");
+                result = __FAILURE__;
             }
             else
             {
-                char** undoneKeys = (char**)realloc(handleData->keys, (handleData->count) * sizeof(char*));
-                if (undoneKeys == NULL)
+                char** newValues;
+                handleData->keys = newKeys;
+                newValues = (char**)realloc(handleData->values, newCapacity * sizeof(char*));
+                if (newValues == NULL)
                 {
-                    LogError("CATASTROPHIC error, unable to undo through realloc to a smaller size");
+                    LogError("realloc error");
+                    if (handleData->count == 0) /*an empty map holds no storage*/
+                    {
+                        free(handleData->keys);
+                        handleData->keys = NULL;
+                    }
+                    else
+                    {
+                        /*keys is bigger than capacity, which is harmless*/
+                    }
+                    result = __FAILURE__;
                 }
                 else
                 {
-                    handleData->keys = undoneKeys;
+                    handleData->values = newValues;
+                    handleData->capacity = newCapacity;
+                    Map_RebuildIndex(handleData);
+                    result = 0;
                 }
             }
-            result = __FAILURE__;
-        }
-        else
-        {
-            handleData->values = newValues;
-            handleData->values[handleData->count] = NULL;
-            handleData->count++;
-            result = 0;
         }
     }
+
+    if (result == 0)
+    {
+        handleData->keys[handleData->count] = NULL;
+        handleData->values[handleData->count] = NULL;
+        handleData->count++;
+    }
     return result;
 }
 
+/*an empty map holds no storage*/
+static void Map_ReleaseStorage(MAP_HANDLE_DATA* handleData)
+{
+    free(handleData->keys);
+    handleData->keys = NULL;
+    free(handleData->values);
+    handleData->values = NULL;
+    if (handleData->hashIndex != NULL)
+    {
+        free(handleData->hashIndex);
+        handleData->hashIndex = NULL;
+        handleData->hashIndexSize = 0;
+    }
+    handleData->count = 0;
+    handleData->deletedCount = 0;
+    handleData->capacity = 0;
+    handleData->mapFilterCallback = NULL;
+}
+
 static void Map_DecreaseStorageKeysValues(MAP_HANDLE_DATA* handleData)
 {
-    if (handleData->count == 1)
+    if (handleData->count - handleData->deletedCount == 1)
     {
-        free(handleData->keys);
-        handleData->keys = NULL;
-        free(handleData->values);
-        handleData->values = NULL;
-        handleData->count = 0;
-        handleData->mapFilterCallback = NULL;
+        Map_ReleaseStorage(handleData);
     }
     else
     {
-        /*certainly > 1...*/
-        char** undoneValues;
-        char** undoneKeys = (char**)realloc(handleData->keys, sizeof(char*)* (handleData->count - 1));
-        if (undoneKeys == NULL)
-        {
-            LogError("CATASTROPHIC error, unable to undo through realloc to a smaller size");
-        }
-        else
-        {
-            handleData->keys = undoneKeys;
-        }
-
-        undoneValues = (char**)realloc(handleData->values, sizeof(char*)* (handleData->count - 1));
-        if (undoneValues == NULL)
-        {
-            LogError("CATASTROPHIC error, unable to undo through realloc to a smaller size");
-        }
-        else
-        {
-            handleData->values = undoneValues;
-        }
-
         handleData->count--;
     }
 }
@@ -252,13 +430,30 @@ static char** findKey(MAP_HANDLE_DATA* handleData, const char* key)
     {
         result = NULL;
     }
+    else if (handleData->hashIndex != NULL)
+    {
+        /*Codes_SRS_MAP_11_003: [ Once a map can hold MAP_HASH_INDEX_THRESHOLD pairs, lookups by key shall go through a hash index and shall not scan all the keys. ]*/
+        size_t mask = handleData->hashIndexSize - 1;
+        size_t slot = Map_HashKey(key) & mask;
+        result = NULL;
+        while (handleData->hashIndex[slot] != 0)
+        {
+            char** candidate = handleData->keys + (handleData->hashIndex[slot] - 1);
+            if (strcmp(*candidate, key) == 0)
+            {
+                result = candidate;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
     else
     {
         size_t i;
         result = NULL;
         for (i = 0; i < handleData->count; i++)
         {
-            if (strcmp(handleData->keys[i], key) == 0)
+            if ((handleData->keys[i] != NULL) && (strcmp(handleData->keys[i], key) == 0))
             {
                 result = handleData->keys + i;
                 break;
@@ -281,7 +476,7 @@ static char** findValue(MAP_HANDLE_DATA* handleData, const char* value)
         result = NULL;
         for (i = 0; i < handleData->count; i++)
         {
-            if (strcmp(handleData->values[i], value) == 0)
+            if ((handleData->values[i] != NULL) && (strcmp(handleData->values[i], value) == 0))
             {
                 result = handleData->values + i;
                 break;
@@ -317,6 +512,10 @@ static int insertNewKeyValue(MAP_HANDLE_DATA* handleData, const char* key, const
             }
             else
             {
+                if (handleData->hashIndex != NULL)
+                {
+                    Map_IndexInsert(handleData, handleData->count - 1);
+                }
                 result = 0;
             }
         }
@@ -465,11 +664,30 @@ MAP_RESULT Map_Delete(MAP_HANDLE handle, const char* key)
         {
             /*Codes_SRS_MAP_02_023: [Otherwise, Map_Delete shall remove the key and its associated value from the map and return MAP_OK.]*/
             size_t index = whereIsIt - handleData->keys;
+            if (handleData->hashIndex != NULL)
+            {
+                Map_IndexRemove(handleData, index);
+            }
             free(handleData->keys[index]);
             free(handleData->values[index]);
-            memmove(handleData->keys + index, handleData->keys + index + 1, (handleData->count - index - 1)*sizeof(char*)); /*if order doesn't matter... then this can be optimized*/
-            memmove(handleData->values + index, handleData->values + index + 1, (handleData->count - index - 1)*sizeof(char*));
-            Map_DecreaseStorageKeysValues(handleData);
+
+            /*Codes_SRS_MAP_11_005: [ Removing a pair shall leave an empty slot in its place and the empty slots shall only be removed once they are more than half of the remaining pairs, so that removing is O(1) on average. ]*/
+            handleData->keys[index] = NULL;
+            handleData->values[index] = NULL;
+            handleData->deletedCount++;
+            if (handleData->deletedCount == handleData->count)
+            {
+                Map_ReleaseStorage(handleData);
+            }
+            /*Codes_SRS_MAP_11_002: [ Removing a pair shall not shrink the storage of the map unless the map becomes empty. ]*/
+            else if (handleData->deletedCount > (handleData->count - handleData->deletedCount) / 2)
+            {
+                Map_Compact(handleData);
+            }
+            else
+            {
+                /*the empty slot stays until enough pairs are deleted*/
+            }
             result = MAP_OK;
         }
 
@@ -576,6 +794,7 @@ MAP_RESULT Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const ch
         /*Codes_SRS_MAP_02_044: [Map_GetInternals shall produce in *values a pointer to an array of const char* having all the values stored so far by the map.]*/
         /*Codes_SRS_MAP_02_045: [  Map_GetInternals shall produce in *count the number of stored keys and values.]*/
         MAP_HANDLE_DATA * handleData = (MAP_HANDLE_DATA *)handle;
+        Map_Compact(handleData);
         *keys =(const char* const*)(handleData->keys);
         *values = (const char* const*)(handleData->values);
         *count = handleData->count;
@@ -607,6 +826,7 @@ STRING_HANDLE Map_ToJSON(MAP_HANDLE handle)
             MAP_HANDLE_DATA* handleData = (MAP_HANDLE_DATA *)handle;
             /*Codes_SRS_MAP_02_049: [If the MAP is empty, then Map_ToJSON shall produce the string "{}".*/
             bool breakFor = false; /*used to break out of for*/
+            Map_Compact(handleData);
             for (i = 0; (i < handleData->count) && (!breakFor); i++)
             {
                 /*add one entry to the JSON*/
@@ -79,20 +79,20 @@ static OPTIONHANDLER_RESULT AddOptionInternal(OPTIONHANDLER_HANDLE handle, const
         }
         else
         {
-            OPTION temp;
-            temp.name = cloneOfName;
-            temp.storage = cloneOfValue;
             /*Codes_SRS_OPTIONHANDLER_02_007: [ OptionHandler_AddProperty shall use VECTOR APIs to save the name and the newly created clone of value. ]*/
-            if (VECTOR_push_back(handle->storage, &temp, 1) != 0)
+            OPTION* newOption = (OPTION*)VECTOR_emplace_back(handle->storage, 1);
+            if (newOption == NULL)
             {
                 /*Codes_SRS_OPTIONHANDLER_02_009: [ Otherwise, OptionHandler_AddProperty shall succeed and return OPTIONHANDLER_ERROR. ]*/
-                LogError("unable to VECTOR_push_back");
+                LogError("unable to VECTOR_emplace_back");
                 handle->destroyOption(name, cloneOfValue);
                 free((void*)cloneOfName);
                 result = OPTIONHANDLER_ERROR;
             }
             else
             {
+                newOption->name = cloneOfName;
+                newOption->storage = cloneOfValue;
                 /*Codes_SRS_OPTIONHANDLER_02_008: [ If all the operations succed then OptionHandler_AddProperty shall succeed and return OPTIONHANDLER_OK. ]*/
                 result = OPTIONHANDLER_OK;
             }
@@ -13,12 +13,53 @@ typedef struct LIST_ITEM_INSTANCE_TAG
     void* next;
 } LIST_ITEM_INSTANCE;
 
+/*number of removed nodes a list keeps around for reuse unless changed with singlylinkedlist_set_max_free_nodes*/
+#ifndef SINGLYLINKEDLIST_DEFAULT_MAX_FREE_NODES
+#define SINGLYLINKEDLIST_DEFAULT_MAX_FREE_NODES 16
+#endif
+
 typedef struct SINGLYLINKEDLIST_INSTANCE_TAG
 {
     LIST_ITEM_INSTANCE* head;
     LIST_ITEM_INSTANCE* tail;
+    LIST_ITEM_INSTANCE* free_nodes;
+    size_t free_node_count;
+    size_t max_free_nodes;
 } LIST_INSTANCE;
 
+static LIST_ITEM_INSTANCE* allocate_node(LIST_INSTANCE* list_instance)
+{
+    LIST_ITEM_INSTANCE* result;
+
+    if (list_instance->free_nodes != NULL)
+    {
+        result = list_instance->free_nodes;
+        list_instance->free_nodes = (LIST_ITEM_INSTANCE*)result->next;
+        list_instance->free_node_count--;
+    }
+    else
+    {
+        result = (LIST_ITEM_INSTANCE*)malloc(sizeof(LIST_ITEM_INSTANCE));
+    }
+
+    return result;
+}
+
+static void release_node(LIST_INSTANCE* list_instance, LIST_ITEM_INSTANCE* node)
+{
+    if (list_instance->free_node_count < list_instance->max_free_nodes)
+    {
+        node->item = NULL;
+        node->next = list_instance->free_nodes;
+        list_instance->free_nodes = node;
+        list_instance->free_node_count++;
+    }
+    else
+    {
+        free(node);
+    }
+}
+
 SINGLYLINKEDLIST_HANDLE singlylinkedlist_create(void)
 {
     LIST_INSTANCE* result;
@@ -30,6 +71,10 @@ SINGLYLINKEDLIST_HANDLE singlylinkedlist_create(void)
         /* Codes_SRS_LIST_01_002: [If any error occurs during the list creation, singlylinkedlist_create shall return NULL.] */
         result->head = NULL;
         result->tail = NULL;
+        /* Codes_SRS_LIST_11_001: [ singlylinkedlist_create shall start with an empty free node pool whose high-water mark is SINGLYLINKEDLIST_DEFAULT_MAX_FREE_NODES. ]*/
+        result->free_nodes = NULL;
+        result->free_node_count = 0;
+        result->max_free_nodes = SINGLYLINKEDLIST_DEFAULT_MAX_FREE_NODES;
     }
 
     return result;
@@ -49,6 +94,13 @@ void singlylinkedlist_destroy(SINGLYLINKEDLIST_HANDLE list)
             free(current_item);
         }
 
+        while (list_instance->free_nodes != NULL)
+        {
+            LIST_ITEM_INSTANCE* current_item = list_instance->free_nodes;
+            list_instance->free_nodes = (LIST_ITEM_INSTANCE*)current_item->next;
+            free(current_item);
+        }
+
         /* Codes_SRS_LIST_01_003: [singlylinkedlist_destroy shall free all resources associated with the list identified by the handle argument.] */
         free(list_instance);
     }
@@ -68,12 +120,13 @@ LIST_ITEM_HANDLE singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void*
     else
     {
         LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
-        result = (LIST_ITEM_INSTANCE*)malloc(sizeof(LIST_ITEM_INSTANCE));
+        /* Codes_SRS_LIST_11_002: [ singlylinkedlist_add shall take the node from the free node pool when the pool is not empty, otherwise it shall allocate it. ]*/
+        result = allocate_node(list_instance);
 
         if (result == NULL)
         {
             /* Codes_SRS_LIST_01_007: [If allocating the new list node fails, singlylinkedlist_add shall return NULL.] */
-            result = NULL;
+            LogError("Cannot allocate memory for the list item");
         }
         else
         {
@@ -97,6 +150,45 @@ LIST_ITEM_HANDLE singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void*
     return result;
 }
 
+LIST_ITEM_HANDLE singlylinkedlist_add_head(SINGLYLINKEDLIST_HANDLE list, const void* item)
+{
+    LIST_ITEM_INSTANCE* result;
+
+    /* Codes_SRS_LIST_11_004: [ If any of the arguments is NULL, singlylinkedlist_add_head shall not add the item to the list and return NULL. ]*/
+    if ((list == NULL) ||
+        (item == NULL))
+    {
+        LogError("Invalid argument (list=%p, item=%p)", list, item);
+        result = NULL;
+    }
+    else
+    {
+        LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
+        /* Codes_SRS_LIST_11_005: [ singlylinkedlist_add_head shall take the node from the free node pool when the pool is not empty, otherwise it shall allocate it. ]*/
+        result = allocate_node(list_instance);
+
+        if (result == NULL)
+        {
+            /* Codes_SRS_LIST_11_006: [ If allocating the new list node fails, singlylinkedlist_add_head shall return NULL. ]*/
+            LogError("Cannot allocate memory for the list item");
+        }
+        else
+        {
+            /* Codes_SRS_LIST_11_003: [ singlylinkedlist_add_head shall add one item to the head of the list and on success it shall return a handle to the added item. ]*/
+            result->item = item;
+            result->next = list_instance->head;
+            list_instance->head = result;
+
+            if (list_instance->tail == NULL)
+            {
+                list_instance->tail = result;
+            }
+        }
+    }
+
+    return result;
+}
+
 int singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
 {
     int result;
@@ -108,6 +200,23 @@ int singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
         LogError("Invalid argument (list=%p, item=%p)", list, item);
         result = __FAILURE__;
     }
+    else if (item == ((LIST_INSTANCE*)list)->head)
+    {
+        /* Codes_SRS_LIST_11_007: [ When item_handle is the head of the list, singlylinkedlist_remove shall unlink it without walking the list. ]*/
+        LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
+        LIST_ITEM_INSTANCE* head_item = list_instance->head;
+
+        list_instance->head = (LIST_ITEM_INSTANCE*)head_item->next;
+        if (list_instance->head == NULL)
+        {
+            list_instance->tail = NULL;
+        }
+
+        release_node(list_instance, head_item);
+
+        /* Codes_SRS_LIST_01_023: [singlylinkedlist_remove shall remove a list item from the list and on success it shall return 0.] */
+        result = 0;
+    }
     else
     {
         LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
@@ -132,7 +241,8 @@ int singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
                     list_instance->tail = previous_item;
                 }
 
-                free(current_item);
+                /* Codes_SRS_LIST_11_008: [ Removed nodes shall be kept in the free node pool while the pool holds fewer nodes than its high-water mark, otherwise they shall be freed. ]*/
+                release_node(list_instance, current_item);
 
                 break;
             }
@@ -310,7 +420,8 @@ int singlylinkedlist_remove_if(SINGLYLINKEDLIST_HANDLE list, LIST_CONDITION_FUNC
                     list_instance->tail = previous_item;
                 }
 
-                free(current_item);
+                /* Codes_SRS_LIST_11_008: [ Removed nodes shall be kept in the free node pool while the pool holds fewer nodes than its high-water mark, otherwise they shall be freed. ]*/
+                release_node(list_instance, current_item);
             }
             /* Codes_SRS_LIST_09_005: [ If the condition function returns false, singlylinkedlist_find shall consider that item as not to be removed. ] */
             else
@@ -372,3 +483,35 @@ int singlylinkedlist_foreach(SINGLYLINKEDLIST_HANDLE list, LIST_ACTION_FUNCTION
 
     return result;
 }
+
+int singlylinkedlist_set_max_free_nodes(SINGLYLINKEDLIST_HANDLE list, size_t max_free_nodes)
+{
+    int result;
+
+    /* Codes_SRS_LIST_11_009: [ If list is NULL, singlylinkedlist_set_max_free_nodes shall fail and return a non-zero value. ]*/
+    if (list == NULL)
+    {
+        LogError("Invalid argument (list=NULL)");
+        result = __FAILURE__;
+    }
+    else
+    {
+        LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
+
+        /* Codes_SRS_LIST_11_010: [ singlylinkedlist_set_max_free_nodes shall set the high-water mark of the free node pool to max_free_nodes; 0 disables pooling. ]*/
+        list_instance->max_free_nodes = max_free_nodes;
+
+        /* Codes_SRS_LIST_11_011: [ singlylinkedlist_set_max_free_nodes shall free the pooled nodes that exceed the new high-water mark and return 0. ]*/
+        while (list_instance->free_node_count > max_free_nodes)
+        {
+            LIST_ITEM_INSTANCE* node = list_instance->free_nodes;
+            list_instance->free_nodes = (LIST_ITEM_INSTANCE*)node->next;
+            list_instance->free_node_count--;
+            free(node);
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
@@ -21,30 +21,120 @@
 
 static const char hexToASCII[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
 
+/*strings shorter than this (the '\0' terminator included) are stored inside the STRING structure*/
+#ifndef STRING_SMALL_BUFFER_SIZE
+#define STRING_SMALL_BUFFER_SIZE 32
+#endif
+
 typedef struct STRING_TAG
 {
     char* s;
+    size_t length;
+    size_t capacity; /*number of bytes available at s, including the '\0' terminator*/
+    char small_buffer[STRING_SMALL_BUFFER_SIZE];
 } STRING;
 
-/*this function will allocate a new string with just '\0' in it*/
-/*return NULL if it fails*/
-/* Codes_SRS_STRING_07_001: [STRING_new shall allocate a new STRING_HANDLE pointing to an empty string.] */
-STRING_HANDLE STRING_new(void)
+/*allocates a STRING that has room for length characters and the '\0' terminator. The content is not initialized.*/
+static STRING* STRING_allocate(size_t length)
 {
     STRING* result;
-    if ((result = (STRING*)malloc(sizeof(STRING))) != NULL)
+    if ((result = (STRING*)malloc(sizeof(STRING))) == NULL)
+    {
+        LogError("Failure allocating STRING.");
+    }
+    else if (length < STRING_SMALL_BUFFER_SIZE)
+    {
+        /* Codes_SRS_STRING_11_001: [ Strings shorter than STRING_SMALL_BUFFER_SIZE (terminator included) shall be stored inside the STRING_HANDLE without a separate allocation. ] */
+        result->s = result->small_buffer;
+        result->length = length;
+        result->capacity = STRING_SMALL_BUFFER_SIZE;
+    }
+    else if ((length + 1 == 0) || ((result->s = (char*)malloc(length + 1)) == NULL))
+    {
+        LogError("Failure allocating %lu bytes for the STRING value.", (unsigned long)(length + 1));
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->length = length;
+        result->capacity = length + 1;
+    }
+    return result;
+}
+
+/*moves the value of the string into storage of exactly new_capacity bytes. new_capacity must be bigger than length.*/
+static int STRING_resize_storage(STRING* str, size_t new_capacity)
+{
+    int result;
+    char* temp;
+    if (str->s == str->small_buffer)
     {
-        if ((result->s = (char*)malloc(1)) != NULL)
+        if ((temp = (char*)malloc(new_capacity)) != NULL)
         {
-            result->s[0] = '\0';
+            (void)memcpy(temp, str->s, str->length + 1);
         }
-        else
+    }
+    else
+    {
+        temp = (char*)realloc(str->s, new_capacity);
+    }
+
+    if (temp == NULL)
+    {
+        LogError("Failure reallocating value to %lu bytes.", (unsigned long)new_capacity);
+        result = __FAILURE__;
+    }
+    else
+    {
+        str->s = temp;
+        str->capacity = new_capacity;
+        result = 0;
+    }
+    return result;
+}
+
+/*makes sure the string has room for length characters and the '\0' terminator, growing the capacity geometrically*/
+static int STRING_ensure_capacity(STRING* str, size_t length)
+{
+    int result;
+    if (length < str->capacity)
+    {
+        /* Codes_SRS_STRING_11_002: [ Operations that grow the string shall not allocate when the current capacity can hold the new value. ] */
+        result = 0;
+    }
+    else if (length + 1 == 0)
+    {
+        LogError("Failure: string length overflow.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_STRING_11_003: [ When the capacity is exceeded, the capacity shall be grown to the bigger of twice the current capacity and the needed size. ] */
+        size_t new_capacity = str->capacity * 2;
+        if (new_capacity < length + 1)
         {
-            /* Codes_SRS_STRING_07_002: [STRING_new shall return an NULL STRING_HANDLE on any error that is encountered.] */
-            LogError("Failure allocating in STRING_new.");
-            free(result);
-            result = NULL;
+            new_capacity = length + 1;
         }
+        result = STRING_resize_storage(str, new_capacity);
+    }
+    return result;
+}
+
+/*this function will allocate a new string with just '\0' in it*/
+/*return NULL if it fails*/
+/* Codes_SRS_STRING_07_001: [STRING_new shall allocate a new STRING_HANDLE pointing to an empty string.] */
+STRING_HANDLE STRING_new(void)
+{
+    STRING* result;
+    if ((result = STRING_allocate(0)) != NULL)
+    {
+        result->s[0] = '\0';
+    }
+    else
+    {
+        /* Codes_SRS_STRING_07_002: [STRING_new shall return an NULL STRING_HANDLE on any error that is encountered.] */
+        LogError("Failure allocating in STRING_new.");
     }
     return (STRING_HANDLE)result;
 }
@@ -60,26 +150,15 @@ STRING_HANDLE STRING_clone(STRING_HANDLE handle)
     }
     else
     {
+        STRING* source = (STRING*)handle;
         /*Codes_SRS_STRING_02_003: [If STRING_clone fails for any reason, it shall return NULL.] */
-        if ((result = (STRING*)malloc(sizeof(STRING))) != NULL)
+        if ((result = STRING_allocate(source->length)) == NULL)
         {
-            STRING* source = (STRING*)handle;
-            /*Codes_SRS_STRING_02_003: [If STRING_clone fails for any reason, it shall return NULL.] */
-            size_t sourceLen = strlen(source->s);
-            if ((result->s = (char*)malloc(sourceLen + 1)) == NULL)
-            {
-                LogError("Failure allocating clone value.");
-                free(result);
-                result = NULL;
-            }
-            else
-            {
-                (void)memcpy(result->s, source->s, sourceLen + 1);
-            }
+            LogError("Failure allocating clone value.");
         }
         else
         {
-            /*not much to do, result is NULL from malloc*/
+            (void)memcpy(result->s, source->s, source->length + 1);
         }
     }
     return (STRING_HANDLE)result;
@@ -97,21 +176,11 @@ STRING_HANDLE STRING_construct(const char* psz)
     else
     {
         STRING* str;
-        if ((str = (STRING*)malloc(sizeof(STRING))) != NULL)
+        size_t nLen = strlen(psz);
+        if ((str = STRING_allocate(nLen)) != NULL)
         {
-            size_t nLen = strlen(psz) + 1;
-            if ((str->s = (char*)malloc(nLen)) != NULL)
-            {
-                (void)memcpy(str->s, psz, nLen);
-                result = (STRING_HANDLE)str;
-            }
-            /* Codes_SRS_STRING_07_032: [STRING_construct encounters any error it shall return a NULL value.] */
-            else
-            {
-                LogError("Failure allocating constructed value.");
-                free(str);
-                result = NULL;
-            }
+            (void)memcpy(str->s, psz, nLen + 1);
+            result = (STRING_HANDLE)str;
         }
         else
         {
@@ -149,33 +218,22 @@ STRING_HANDLE STRING_construct_sprintf(const char* format, ...)
         va_end(arg_list);
         if (length > 0)
         {
-            result = (STRING*)malloc(sizeof(STRING));
+            result = STRING_allocate((size_t)length);
             if (result != NULL)
             {
-                result->s = (char*)malloc(length+1);
-                if (result->s != NULL)
-                {
-                    va_start(arg_list, format);
-                    if (vsnprintf(result->s, length+1, format, arg_list) < 0)
-                    {
-                        /* Codes_SRS_STRING_07_040: [If any error is encountered STRING_construct_sprintf shall return NULL.] */
-                        free(result->s);
-                        free(result);
-                        result = NULL;
-                        LogError("Failure: vsnprintf formatting failed.");
-                    }
-                    va_end(arg_list);
-                }
-                else
+                va_start(arg_list, format);
+                if (vsnprintf(result->s, length+1, format, arg_list) < 0)
                 {
                     /* Codes_SRS_STRING_07_040: [If any error is encountered STRING_construct_sprintf shall return NULL.] */
-                    free(result);
+                    STRING_delete((STRING_HANDLE)result);
                     result = NULL;
-                    LogError("Failure: allocation sprintf value failed.");
+                    LogError("Failure: vsnprintf formatting failed.");
                 }
+                va_end(arg_list);
             }
             else
             {
+                /* Codes_SRS_STRING_07_040: [If any error is encountered STRING_construct_sprintf shall return NULL.] */
                 LogError("Failure: allocation failed.");
             }
         }
@@ -216,6 +274,8 @@ STRING_HANDLE STRING_new_with_memory(const char* memory)
         if ((result = (STRING*)malloc(sizeof(STRING))) != NULL)
         {
             result->s = (char*)memory;
+            result->length = strlen(memory);
+            result->capacity = result->length + 1;
         }
         else
         {
@@ -234,10 +294,10 @@ STRING_HANDLE STRING_new_quoted(const char* source)
         /* Codes_SRS_STRING_07_009: [STRING_new_quoted shall return a NULL STRING_HANDLE if the supplied const char* is NULL.] */
         result = NULL;
     }
-    else if ((result = (STRING*)malloc(sizeof(STRING))) != NULL)
+    else
     {
         size_t sourceLength = strlen(source);
-        if ((result->s = (char*)malloc(sourceLength + 3)) != NULL)
+        if ((result = STRING_allocate(sourceLength + 2)) != NULL)
         {
             result->s[0] = '"';
             (void)memcpy(result->s + 1, source, sourceLength);
@@ -248,8 +308,6 @@ STRING_HANDLE STRING_new_quoted(const char* source)
         {
             /* Codes_SRS_STRING_07_031: [STRING_new_quoted shall return a NULL STRING_HANDLE if any error is encountered.] */
             LogError("Failure allocating quoted string value.");
-            free(result);
-            result = NULL;
         }
     }
     return (STRING_HANDLE)result;
@@ -306,18 +364,11 @@ STRING_HANDLE STRING_new_JSON(const char* source)
         else
         {
             size_t nAllocation = vlen + 5 * nControlCharacters + nEscapeCharacters + 3;
-            if ((result = (STRING*)malloc(sizeof(STRING))) == NULL)
+            if ((result = STRING_allocate(nAllocation - 1)) == NULL)
             {
                 /*Codes_SRS_STRING_02_021: [If the complete JSON representation cannot be produced, then STRING_new_JSON shall fail and return NULL.] */
                 LogError("malloc json failure");
             }
-            else if ((result->s = (char*)malloc(nAllocation)) == NULL)
-            {
-                /*Codes_SRS_STRING_02_021: [If the complete JSON representation cannot be produced, then STRING_new_JSON shall fail and return NULL.] */
-                free(result);
-                result = NULL;
-                LogError("malloc failed");
-            }
             else
             {
                 size_t pos = 0;
@@ -382,6 +433,7 @@ STRING_HANDLE STRING_new_JSON(const char* source)
                 result->s[pos++] = '"';
                 /*zero terminating it*/
                 result->s[pos] = '\0';
+                result->length = pos;
             }
         }
 
@@ -404,10 +456,11 @@ int STRING_concat(STRING_HANDLE handle, const char* s2)
     else
     {
         STRING* s1 = (STRING*)handle;
-        size_t s1Length = strlen(s1->s);
         size_t s2Length = strlen(s2);
-        char* temp = (char*)realloc(s1->s, s1Length + s2Length + 1);
-        if (temp == NULL)
+        /*s2 can point inside the value of s1, in which case it has to be located again after growing*/
+        int s2IsInside = (s2 >= s1->s) && (s2 <= s1->s + s1->length);
+        size_t s2Offset = s2IsInside ? (size_t)(s2 - s1->s) : 0;
+        if (STRING_ensure_capacity(s1, s1->length + s2Length) != 0)
         {
             /* Codes_SRS_STRING_07_013: [STRING_concat shall return a nonzero number if an error is encountered.] */
             LogError("Failure reallocating value.");
@@ -415,8 +468,13 @@ int STRING_concat(STRING_HANDLE handle, const char* s2)
         }
         else
         {
-            s1->s = temp;
-            (void)memcpy(s1->s + s1Length, s2, s2Length + 1);
+            if (s2IsInside)
+            {
+                s2 = s1->s + s2Offset;
+            }
+            (void)memmove(s1->s + s1->length, s2, s2Length);
+            s1->length += s2Length;
+            s1->s[s1->length] = '\0';
             result = 0;
         }
     }
@@ -441,10 +499,8 @@ int STRING_concat_with_STRING(STRING_HANDLE s1, STRING_HANDLE s2)
         STRING* dest = (STRING*)s1;
         STRING* src = (STRING*)s2;
 
-        size_t s1Length = strlen(dest->s);
-        size_t s2Length = strlen(src->s);
-        char* temp = (char*)realloc(dest->s, s1Length + s2Length + 1);
-        if (temp == NULL)
+        size_t s2Length = src->length;
+        if (STRING_ensure_capacity(dest, dest->length + s2Length) != 0)
         {
             /* Codes_SRS_STRING_07_035: [String_Concat_with_STRING shall return a nonzero number if an error is encountered.] */
             LogError("Failure reallocating value");
@@ -452,9 +508,11 @@ int STRING_concat_with_STRING(STRING_HANDLE s1, STRING_HANDLE s2)
         }
         else
         {
-            dest->s = temp;
             /* Codes_SRS_STRING_07_034: [String_Concat_with_STRING shall concatenate a given STRING_HANDLE variable with a source STRING_HANDLE.] */
-            (void)memcpy(dest->s + s1Length, src->s, s2Length + 1);
+            /*src->s is read only after growing dest, since s1 and s2 can be the same handle*/
+            (void)memcpy(dest->s + dest->length, src->s, s2Length);
+            dest->length += s2Length;
+            dest->s[dest->length] = '\0';
             result = 0;
         }
     }
@@ -480,8 +538,7 @@ int STRING_copy(STRING_HANDLE handle, const char* s2)
         if (s1->s != s2)
         {
             size_t s2Length = strlen(s2);
-            char* temp = (char*)realloc(s1->s, s2Length + 1);
-            if (temp == NULL)
+            if (STRING_ensure_capacity(s1, s2Length) != 0)
             {
                 LogError("Failure reallocating value.");
                 /* Codes_SRS_STRING_07_027: [STRING_copy shall return a nonzero value if any error is encountered.] */
@@ -489,8 +546,8 @@ int STRING_copy(STRING_HANDLE handle, const char* s2)
             }
             else
             {
-                s1->s = temp;
                 memmove(s1->s, s2, s2Length + 1);
+                s1->length = s2Length;
                 result = 0;
             }
         }
@@ -519,14 +576,12 @@ int STRING_copy_n(STRING_HANDLE handle, const char* s2, size_t n)
     {
         STRING* s1 = (STRING*)handle;
         size_t s2Length = strlen(s2);
-        char* temp;
         if (s2Length > n)
         {
             s2Length = n;
         }
 
-        temp = (char*)realloc(s1->s, s2Length + 1);
-        if (temp == NULL)
+        if (STRING_ensure_capacity(s1, s2Length) != 0)
         {
             LogError("Failure reallocating value.");
             /* Codes_SRS_STRING_07_028: [STRING_copy_n shall return a nonzero value if any error is encountered.] */
@@ -534,9 +589,9 @@ int STRING_copy_n(STRING_HANDLE handle, const char* s2, size_t n)
         }
         else
         {
-            s1->s = temp;
-            (void)memcpy(s1->s, s2, s2Length);
+            (void)memmove(s1->s, s2, s2Length);
             s1->s[s2Length] = 0;
+            s1->length = s2Length;
             result = 0;
         }
 
@@ -587,14 +642,11 @@ int STRING_sprintf(STRING_HANDLE handle, const char* format, ...)
         else
         {
             STRING* s1 = (STRING*)handle;
-            char* temp;
-            size_t s1Length = strlen(s1->s);
-            temp = (char*)realloc(s1->s, s1Length + s2Length + 1);
-            if (temp != NULL)
+            size_t s1Length = s1->length;
+            if (STRING_ensure_capacity(s1, s1Length + s2Length) == 0)
             {
-                s1->s = temp;
                 va_start(arg_list, format);
-                if (vsnprintf(s1->s + s1Length, s1Length + s2Length + 1, format, arg_list) < 0)
+                if (vsnprintf(s1->s + s1Length, (size_t)s2Length + 1, format, arg_list) < 0)
                 {
                     /* Codes_SRS_STRING_07_043: [If any error is encountered STRING_sprintf shall return a non zero value.] */
                     LogError("Failure vsnprintf formatting error");
@@ -604,6 +656,7 @@ int STRING_sprintf(STRING_HANDLE handle, const char* format, ...)
                 else
                 {
                     /* Codes_SRS_STRING_07_044: [On success STRING_sprintf shall return 0.]*/
+                    s1->length = s1Length + s2Length;
                     result = 0;
                 }
                 va_end(arg_list);
@@ -634,9 +687,8 @@ int STRING_quote(STRING_HANDLE handle)
     else
     {
         STRING* s1 = (STRING*)handle;
-        size_t s1Length = strlen(s1->s);
-        char* temp = (char*)realloc(s1->s, s1Length + 2 + 1);/*2 because 2 quotes, 1 because '\0'*/
-        if (temp == NULL)
+        size_t s1Length = s1->length;
+        if (STRING_ensure_capacity(s1, s1Length + 2) != 0)/*2 because 2 quotes*/
         {
             LogError("Failure reallocating value.");
             /* Codes_SRS_STRING_07_029: [STRING_quote shall return a nonzero value if any error is encountered.] */
@@ -644,11 +696,11 @@ int STRING_quote(STRING_HANDLE handle)
         }
         else
         {
-            s1->s = temp;
             memmove(s1->s + 1, s1->s, s1Length);
             s1->s[0] = '"';
             s1->s[s1Length + 1] = '"';
             s1->s[s1Length + 2] = '\0';
+            s1->length = s1Length + 2;
             result = 0;
         }
     }
@@ -667,20 +719,11 @@ int STRING_empty(STRING_HANDLE handle)
     }
     else
     {
+        /* Codes_SRS_STRING_11_004: [ STRING_empty shall keep the capacity of the string so that it can be refilled without allocating. ] */
         STRING* s1 = (STRING*)handle;
-        char* temp = (char*)realloc(s1->s, 1);
-        if (temp == NULL)
-        {
-            LogError("Failure reallocating value.");
-            /* Codes_SRS_STRING_07_030: [STRING_empty shall return a nonzero value if the STRING_HANDLE is NULL.] */
-            result = __FAILURE__;
-        }
-        else
-        {
-            s1->s = temp;
-            s1->s[0] = '\0';
-            result = 0;
-        }
+        s1->s[0] = '\0';
+        s1->length = 0;
+        result = 0;
     }
     return result;
 }
@@ -693,7 +736,10 @@ void STRING_delete(STRING_HANDLE handle)
     if (handle != NULL)
     {
         STRING* value = (STRING*)handle;
-        free(value->s);
+        if (value->s != value->small_buffer)
+        {
+            free(value->s);
+        }
         value->s = NULL;
         free(value);
     }
@@ -723,7 +769,7 @@ size_t STRING_length(STRING_HANDLE handle)
     if (handle != NULL)
     {
         STRING* value = (STRING*)handle;
-        result = strlen(value->s);
+        result = value->length;
     }
     return result;
 }
@@ -750,25 +796,16 @@ STRING_HANDLE STRING_construct_n(const char* psz, size_t n)
         else
         {
             STRING* str;
-            if ((str = (STRING*)malloc(sizeof(STRING))) != NULL)
+            if ((str = STRING_allocate(n)) != NULL)
             {
-                if ((str->s = (char*)malloc(len + 1)) != NULL)
-                {
-                    (void)memcpy(str->s, psz, n);
-                    str->s[n] = '\0';
-                    result = (STRING_HANDLE)str;
-                }
-                /* Codes_SRS_STRING_02_010: [In all other error cases, STRING_construct_n shall return NULL.]  */
-                else
-                {
-                    LogError("Failure allocating value.");
-                    free(str);
-                    result = NULL;
-                }
+                (void)memcpy(str->s, psz, n);
+                str->s[n] = '\0';
+                result = (STRING_HANDLE)str;
             }
             else
             {
                 /* Codes_SRS_STRING_02_010: [In all other error cases, STRING_construct_n shall return NULL.]  */
+                LogError("Failure allocating value.");
                 result = NULL;
             }
         }
@@ -817,7 +854,7 @@ STRING_HANDLE STRING_from_byte_array(const unsigned char* source, size_t size)
     else
     {
         /*Codes_SRS_STRING_02_023: [ Otherwise, STRING_from_BUFFER shall build a string that has the same content (byte-by-byte) as source and return a non-NULL handle. ]*/
-        result = (STRING*)malloc(sizeof(STRING));
+        result = STRING_allocate(size);
         if (result == NULL)
         {
             /*Codes_SRS_STRING_02_024: [ If building the string fails, then STRING_from_BUFFER shall fail and return NULL. ]*/
@@ -826,20 +863,13 @@ STRING_HANDLE STRING_from_byte_array(const unsigned char* source, size_t size)
         }
         else
         {
-            /*Codes_SRS_STRING_02_023: [ Otherwise, STRING_from_BUFFER shall build a string that has the same content (byte-by-byte) as source and return a non-NULL handle. ]*/
-            result->s = (char*)malloc(size + 1);
-            if (result->s == NULL)
-            {
-                /*Codes_SRS_STRING_02_024: [ If building the string fails, then STRING_from_BUFFER shall fail and return NULL. ]*/
-                LogError("oom - unable to malloc");
-                free(result);
-                result = NULL;
-            }
-            else
+            if (size > 0)
             {
                 (void)memcpy(result->s, source, size);
-                result->s[size] = '\0'; /*all is fine*/
             }
+            result->s[size] = '\0'; /*all is fine*/
+            /*the byte array can contain '\0', the length of the string stops at the first one*/
+            result->length = strlen(result->s);
         }
     }
     return (STRING_HANDLE)result;
@@ -864,7 +894,7 @@ int STRING_replace(STRING_HANDLE handle, char target, char replace)
         size_t index;
         /* Codes_SRS_STRING_07_047: [ STRING_replace shall replace all instances of target with replace. ] */
         STRING* str_value = (STRING*)handle;
-        length = strlen(str_value->s);
+        length = str_value->length;
         for (index = 0; index < length; index++)
         {
             if (str_value->s[index] == target)
@@ -872,8 +902,52 @@ int STRING_replace(STRING_HANDLE handle, char target, char replace)
                 str_value->s[index] = replace;
             }
         }
+        if (replace == '\0')
+        {
+            /*the string was truncated at the first replaced character*/
+            str_value->length = strlen(str_value->s);
+        }
         /* Codes_SRS_STRING_07_049: [ On success STRING_replace shall return zero. ] */
         result = 0;
     }
     return result;
 }
+
+int STRING_reserve(STRING_HANDLE handle, size_t capacity)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_STRING_11_005: [ If handle is NULL STRING_reserve shall return a non-zero value. ] */
+        LogError("Invalid arg (NULL)");
+        result = __FAILURE__;
+    }
+    else
+    {
+        STRING* str = (STRING*)handle;
+        if (capacity < str->capacity)
+        {
+            /* Codes_SRS_STRING_11_006: [ If the string can already hold capacity characters, STRING_reserve shall not allocate and shall return zero. ] */
+            result = 0;
+        }
+        else if (capacity + 1 == 0)
+        {
+            /* Codes_SRS_STRING_11_008: [ If any error is encountered STRING_reserve shall return a non-zero value and leave the string unchanged. ] */
+            LogError("Invalid arg (capacity too big)");
+            result = __FAILURE__;
+        }
+        /* Codes_SRS_STRING_11_007: [ Otherwise STRING_reserve shall move the value of the string into storage that can hold exactly capacity characters and the '\0' terminator. ] */
+        else if (STRING_resize_storage(str, capacity + 1) != 0)
+        {
+            /* Codes_SRS_STRING_11_008: [ If any error is encountered STRING_reserve shall return a non-zero value and leave the string unchanged. ] */
+            LogError("Failure reserving %lu characters.", (unsigned long)capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_STRING_11_009: [ On success STRING_reserve shall return zero. ] */
+            result = 0;
+        }
+    }
+    return result;
+}
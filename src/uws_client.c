@@ -18,11 +18,13 @@
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/uws_frame_encoder.h"
+#include "azure_c_shared_utility/uws_permessage_deflate.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/utf8_checker.h"
 #include "azure_c_shared_utility/gb_rand.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/shared_util_options.h"
 
 static const char* UWS_CLIENT_OPTIONS = "uWSClientOptions";
 
@@ -90,9 +92,21 @@ typedef struct UWS_CLIENT_INSTANCE_TAG
     void* on_ws_close_complete_context;
     unsigned char* stream_buffer;
     size_t stream_buffer_count;
+    size_t stream_buffer_size;
     unsigned char* fragment_buffer;
     size_t fragment_buffer_count;
     unsigned char fragmented_frame_type;
+    size_t max_message_size;
+    ON_WS_FRAGMENT_RECEIVED on_ws_fragment_received;
+    void* on_ws_fragment_received_context;
+    bool streamed_message_started;
+    size_t streamed_frame_remaining;
+    unsigned char streamed_frame_type;
+    bool streamed_frame_is_final;
+    WS_PERMESSAGE_DEFLATE_CONFIG* permessage_deflate_config;
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate;
+    bool permessage_deflate_takes_over_context;
+    bool is_receiving_compressed_message;
 } UWS_CLIENT_INSTANCE;
 
 void clear_pending_sends(UWS_CLIENT_INSTANCE* uws_client);
@@ -266,9 +280,21 @@ UWS_CLIENT_HANDLE uws_client_create(const char* hostname, unsigned int port, con
                                 result->on_ws_close_complete_context = NULL;
                                 result->stream_buffer = NULL;
                                 result->stream_buffer_count = 0;
+                                result->stream_buffer_size = 0;
                                 result->fragment_buffer = NULL;
                                 result->fragment_buffer_count = 0;
                                 result->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                result->max_message_size = 0;
+                                result->on_ws_fragment_received = NULL;
+                                result->on_ws_fragment_received_context = NULL;
+                                result->streamed_message_started = false;
+                                result->streamed_frame_remaining = 0;
+                                result->streamed_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                result->streamed_frame_is_final = false;
+                                result->permessage_deflate_config = NULL;
+                                result->permessage_deflate = NULL;
+                                result->permessage_deflate_takes_over_context = false;
+                                result->is_receiving_compressed_message = false;
 
                                 result->protocol_count = protocol_count;
 
@@ -443,9 +469,21 @@ UWS_CLIENT_HANDLE uws_client_create_with_io(const IO_INTERFACE_DESCRIPTION* io_i
                                 result->on_ws_close_complete_context = NULL;
                                 result->stream_buffer = NULL;
                                 result->stream_buffer_count = 0;
+                                result->stream_buffer_size = 0;
                                 result->fragment_buffer = NULL;
                                 result->fragment_buffer_count = 0;
                                 result->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                result->max_message_size = 0;
+                                result->on_ws_fragment_received = NULL;
+                                result->on_ws_fragment_received_context = NULL;
+                                result->streamed_message_started = false;
+                                result->streamed_frame_remaining = 0;
+                                result->streamed_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                result->streamed_frame_is_final = false;
+                                result->permessage_deflate_config = NULL;
+                                result->permessage_deflate = NULL;
+                                result->permessage_deflate_takes_over_context = false;
+                                result->is_receiving_compressed_message = false;
 
                                 result->protocol_count = protocol_count;
 
@@ -526,6 +564,7 @@ void uws_client_destroy(UWS_CLIENT_HANDLE uws_client)
     {
         free(uws_client->stream_buffer);
         free(uws_client->fragment_buffer);
+        free(uws_client->permessage_deflate_config);
 
         /* Codes_SRS_UWS_CLIENT_01_021: [ `uws_client_destroy` shall perform a close action if the uws instance has already been open. ]*/
         switch (uws_client->uws_state)
@@ -564,6 +603,13 @@ void uws_client_destroy(UWS_CLIENT_HANDLE uws_client)
         clear_pending_sends(uws_client);
         /* Codes_SRS_UWS_CLIENT_01_024: [ `uws_client_destroy` shall free the list used to track the pending sends by calling `singlylinkedlist_destroy`. ]*/
         singlylinkedlist_destroy(uws_client->pending_sends);
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+        if (uws_client->permessage_deflate != NULL)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_567: [ `uws_client_destroy` shall free the negotiated permessage-deflate state by calling `uws_permessage_deflate_destroy`. ]*/
+            uws_permessage_deflate_destroy(uws_client->permessage_deflate);
+        }
+#endif
         free(uws_client->resource_name);
         free(uws_client->hostname);
         free(uws_client);
@@ -659,6 +705,119 @@ static void indicate_ws_error_and_close(UWS_CLIENT_INSTANCE* uws_client, WS_ERRO
     uws_client->on_ws_error(uws_client->on_ws_error_context, error_code);
 }
 
+/* builds the Sec-WebSocket-Extensions header line of the upgrade request, NULL when no extension is offered */
+static int create_extensions_header(UWS_CLIENT_INSTANCE* uws_client, char** extensions_header)
+{
+    int result;
+
+    if (uws_client->permessage_deflate_config == NULL)
+    {
+        *extensions_header = NULL;
+        result = 0;
+    }
+    else
+    {
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+        /* Codes_SRS_UWS_CLIENT_01_559: [ If the `ws_permessage_deflate` option was set, the upgrade request shall contain a `Sec-WebSocket-Extensions` header whose value is obtained by calling `uws_permessage_deflate_create_offer` with the configured parameters. ]*/
+        char* offer = uws_permessage_deflate_create_offer(uws_client->permessage_deflate_config);
+        if (offer == NULL)
+        {
+            LogError("Cannot create the permessage-deflate offer");
+            result = __FAILURE__;
+        }
+        else
+        {
+            const char extensions_header_format[] = "Sec-WebSocket-Extensions: %s\r\n";
+
+            *extensions_header = (char*)malloc(sizeof(extensions_header_format) + strlen(offer));
+            if (*extensions_header == NULL)
+            {
+                LogError("Cannot allocate memory for the Sec-WebSocket-Extensions header");
+                result = __FAILURE__;
+            }
+            else
+            {
+                (void)sprintf(*extensions_header, extensions_header_format, offer);
+                result = 0;
+            }
+
+            free(offer);
+        }
+#else
+        LogError("permessage-deflate is not supported by this build");
+        result = __FAILURE__;
+#endif
+    }
+
+    return result;
+}
+
+/* applies the extensions accepted in the upgrade response, filling the open result when the response cannot be accepted */
+static int negotiate_extensions(UWS_CLIENT_INSTANCE* uws_client, const char* upgrade_response, WS_OPEN_RESULT_DETAILED* ws_open_result_detailed)
+{
+    int result;
+
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+    /* Codes_SRS_UWS_CLIENT_01_563: [ Any `permessage-deflate` instance left from a previous connection shall be destroyed by calling `uws_permessage_deflate_destroy`. ]*/
+    if (uws_client->permessage_deflate != NULL)
+    {
+        uws_permessage_deflate_destroy(uws_client->permessage_deflate);
+        uws_client->permessage_deflate = NULL;
+    }
+    uws_client->is_receiving_compressed_message = false;
+
+    if (uws_client->permessage_deflate_config == NULL)
+    {
+        result = 0;
+    }
+    else
+    {
+        WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+        bool is_accepted;
+
+        /* Codes_SRS_UWS_CLIENT_01_561: [ If `permessage-deflate` was offered, on receiving a 101 status the upgrade response shall be passed to `uws_permessage_deflate_negotiate` together with the offered parameters. ]*/
+        if (uws_permessage_deflate_negotiate(uws_client->permessage_deflate_config, upgrade_response, &negotiated, &is_accepted) != 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_562: [ If `uws_permessage_deflate_negotiate` fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_BAD_UPGRADE_RESPONSE`. ]*/
+            LogError("Invalid permessage-deflate response");
+            ws_open_result_detailed->result = WS_OPEN_ERROR_BAD_UPGRADE_RESPONSE;
+            ws_open_result_detailed->code = __FAILURE__;
+            result = __FAILURE__;
+        }
+        else if (!is_accepted)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_564: [ If the server did not accept `permessage-deflate`, messages shall be sent and received uncompressed. ]*/
+            result = 0;
+        }
+        else
+        {
+            /* Codes_SRS_UWS_CLIENT_01_565: [ If the server accepted `permessage-deflate`, a compression instance shall be created by calling `uws_permessage_deflate_create` with the negotiated parameters. ]*/
+            uws_client->permessage_deflate = uws_permessage_deflate_create(&negotiated);
+            if (uws_client->permessage_deflate == NULL)
+            {
+                /* Codes_SRS_UWS_CLIENT_01_566: [ If `uws_permessage_deflate_create` fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_NOT_ENOUGH_MEMORY`. ]*/
+                LogError("Cannot create the permessage-deflate instance");
+                ws_open_result_detailed->result = WS_OPEN_ERROR_NOT_ENOUGH_MEMORY;
+                ws_open_result_detailed->code = __FAILURE__;
+                result = __FAILURE__;
+            }
+            else
+            {
+                uws_client->permessage_deflate_takes_over_context = !negotiated.client_no_context_takeover;
+                result = 0;
+            }
+        }
+    }
+#else
+    (void)uws_client;
+    (void)upgrade_response;
+    (void)ws_open_result_detailed;
+    result = 0;
+#endif
+
+    return result;
+}
+
 static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT_DETAILED io_open_result_detailed)
 {
     UWS_CLIENT_HANDLE uws_client = (UWS_CLIENT_HANDLE)context;
@@ -745,10 +904,21 @@ static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT_DETAILE
                         "Sec-WebSocket-Key: %s\r\n"
                         "Sec-WebSocket-Protocol: %s\r\n"
                         "Sec-WebSocket-Version: 13\r\n"
+                        "%s"
                         "\r\n";
                     const char* base64_nonce_chars = STRING_c_str(base64_nonce);
+                    char* extensions_header = NULL;
+
+                    if (create_extensions_header(uws_client, &extensions_header) != 0)
+                    {
+                        /* Codes_SRS_UWS_CLIENT_01_560: [ If creating the `permessage-deflate` offer fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_CONSTRUCTING_UPGRADE_REQUEST`. ]*/
+                        upgrade_request_length = -1;
+                    }
+                    else
+                    {
+                        upgrade_request_length = (int)(strlen(upgrade_request_format) + strlen(uws_client->resource_name)+strlen(uws_client->hostname) + strlen(base64_nonce_chars) + strlen(uws_client->protocols[0].protocol) + ((extensions_header == NULL) ? 0 : strlen(extensions_header)) + 5);
+                    }
 
-                    upgrade_request_length = (int)(strlen(upgrade_request_format) + strlen(uws_client->resource_name)+strlen(uws_client->hostname) + strlen(base64_nonce_chars) + strlen(uws_client->protocols[0].protocol)+5);
                     if (upgrade_request_length < 0)
                     {
                         /* Codes_SRS_UWS_CLIENT_01_408: [ If constructing of the WebSocket upgrade request fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_CONSTRUCTING_UPGRADE_REQUEST`. ]*/
@@ -774,7 +944,8 @@ static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT_DETAILE
                                 uws_client->hostname,
                                 uws_client->port,
                                 base64_nonce_chars,
-                                uws_client->protocols[0].protocol);
+                                uws_client->protocols[0].protocol,
+                                (extensions_header == NULL) ? "" : extensions_header);
 
                             /* No need to have any send complete here, as we are monitoring the received bytes */
                             /* Codes_SRS_UWS_CLIENT_01_372: [ Once prepared the WebSocket upgrade request shall be sent by calling `xio_send`. ]*/
@@ -796,6 +967,11 @@ static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT_DETAILE
                         }
                     }
 
+                    if (extensions_header != NULL)
+                    {
+                        free(extensions_header);
+                    }
+
                     STRING_delete(base64_nonce);
                 }
 
@@ -806,14 +982,82 @@ static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT_DETAILE
     }
 }
 
-static void consume_stream_buffer_bytes(UWS_CLIENT_INSTANCE* uws_client, size_t consumed_bytes)
+static int append_stream_buffer_bytes(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* buffer, size_t size)
+{
+    int result;
+
+    /* One extra byte is always kept so that the upgrade response can be zero terminated */
+    size_t needed_size = uws_client->stream_buffer_count + size + 1;
+
+    if (needed_size > uws_client->stream_buffer_size)
+    {
+        /* Grow geometrically so that a stream of small chunks does not realloc on every chunk */
+        size_t new_size = uws_client->stream_buffer_size * 2;
+        unsigned char* new_stream_buffer;
+
+        if (new_size < needed_size)
+        {
+            new_size = needed_size;
+        }
+
+        new_stream_buffer = (unsigned char*)realloc(uws_client->stream_buffer, new_size);
+        if (new_stream_buffer == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            uws_client->stream_buffer = new_stream_buffer;
+            uws_client->stream_buffer_size = new_size;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        (void)memcpy(uws_client->stream_buffer + uws_client->stream_buffer_count, buffer, size);
+        uws_client->stream_buffer_count += size;
+    }
+
+    return result;
+}
+
+static void retain_undecoded_bytes(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* undecoded_bytes, size_t undecoded_count, bool decoded_in_place)
 {
-    if (consumed_bytes < uws_client->stream_buffer_count)
+    if ((uws_client->uws_state != UWS_STATE_WAITING_FOR_UPGRADE_RESPONSE) &&
+        (uws_client->uws_state != UWS_STATE_OPEN) &&
+        (uws_client->uws_state != UWS_STATE_CLOSING_WAITING_FOR_CLOSE))
+    {
+        /* Nothing more will be decoded on this connection, a new open starts from an empty stream */
+        uws_client->stream_buffer_count = 0;
+    }
+    else if (decoded_in_place)
     {
-        (void)memmove(uws_client->stream_buffer, uws_client->stream_buffer + consumed_bytes, uws_client->stream_buffer_count - consumed_bytes);
+        /* Codes_SRS_UWS_CLIENT_01_533: [ Only the bytes that are left undecoded (such as an incomplete frame) shall be accumulated in order to be decoded together with the bytes received in subsequent calls. ]*/
+        uws_client->stream_buffer_count = 0;
+        if ((undecoded_count > 0) &&
+            (append_stream_buffer_bytes(uws_client, undecoded_bytes, undecoded_count) != 0))
+        {
+            /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
+            LogError("Cannot allocate memory for received data");
+            indicate_ws_error(uws_client, WS_ERROR_NOT_ENOUGH_MEMORY);
+        }
     }
+    else
+    {
+        /* The decoded frames are dropped with a single move of the remaining bytes instead of one move per frame */
+        if ((undecoded_count > 0) &&
+            (undecoded_bytes != uws_client->stream_buffer))
+        {
+            (void)memmove(uws_client->stream_buffer, undecoded_bytes, undecoded_count);
+        }
 
-    uws_client->stream_buffer_count -= consumed_bytes;
+        uws_client->stream_buffer_count = undecoded_count;
+    }
 }
 
 static void on_underlying_io_close_complete(void* context)
@@ -968,11 +1212,17 @@ static int ParseHttpResponse(const char* src, int* dst)
     return result;
 }
 
-static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, size_t length, size_t needed_bytes)
+static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, const unsigned char* payload, size_t length)
 {
     int result;
-    unsigned char *new_fragment_bytes = (unsigned char *)realloc(uws_client->fragment_buffer, uws_client->fragment_buffer_count + length);
-    if (new_fragment_bytes == NULL)
+    unsigned char *new_fragment_bytes;
+
+    if (length == 0)
+    {
+        /* an empty fragment adds nothing, and realloc to 0 bytes would free the accumulated bytes */
+        result = 0;
+    }
+    else if ((new_fragment_bytes = (unsigned char *)realloc(uws_client->fragment_buffer, uws_client->fragment_buffer_count + length)) == NULL)
     {
         /* Codes_SRS_UWS_CLIENT_01_379: [ If allocating memory for accumulating the bytes fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_NOT_ENOUGH_MEMORY`. ]*/
         // TODO error in comment?
@@ -983,7 +1233,7 @@ static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, size_t length
     else
     {
         uws_client->fragment_buffer = new_fragment_bytes;
-        (void)memcpy(uws_client->fragment_buffer + uws_client->fragment_buffer_count, uws_client->stream_buffer + needed_bytes - length, length);
+        (void)memcpy(uws_client->fragment_buffer + uws_client->fragment_buffer_count, payload, length);
         uws_client->fragment_buffer_count += length;
         result = 0;
     }
@@ -991,6 +1241,217 @@ static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, size_t length
     return result;
 }
 
+static void indicate_ws_fragment_bytes(UWS_CLIENT_INSTANCE* uws_client, unsigned char frame_type, bool is_message_end, const unsigned char* buffer, size_t size)
+{
+    WS_FRAGMENT fragment;
+
+    if (uws_client->streamed_message_started)
+    {
+        fragment = is_message_end ? WS_FRAGMENT_END : WS_FRAGMENT_CONTINUE;
+    }
+    else
+    {
+        fragment = is_message_end ? WS_FRAGMENT_COMPLETE : WS_FRAGMENT_BEGIN;
+    }
+
+    uws_client->streamed_message_started = !is_message_end;
+    if (is_message_end)
+    {
+        uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+    }
+
+    uws_client->on_ws_fragment_received(uws_client->on_ws_fragment_received_context, frame_type, fragment, buffer, size);
+}
+
+static void indicate_ws_fragment(UWS_CLIENT_INSTANCE* uws_client, unsigned char frame_type, bool is_message_end, const unsigned char* buffer, size_t size)
+{
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+    if (uws_client->is_receiving_compressed_message)
+    {
+        const unsigned char* decompressed;
+        size_t decompressed_length;
+
+        if (is_message_end)
+        {
+            uws_client->is_receiving_compressed_message = false;
+        }
+
+        /* Codes_SRS_UWS_CLIENT_01_571: [ When streaming a compressed message, each received chunk shall be decompressed by calling `uws_permessage_deflate_decompress` and the decompressed bytes shall be indicated via `on_ws_fragment_received`. ]*/
+        if (uws_permessage_deflate_decompress(uws_client->permessage_deflate, buffer, size, is_message_end, 0, &decompressed, &decompressed_length) != 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_569: [ If decompressing a received message fails, uws shall send a CLOSE frame with code 1002 and indicate `WS_ERROR_BAD_FRAME_RECEIVED` via `on_ws_error`. ]*/
+            LogError("Cannot decompress received message");
+            uws_client->is_receiving_compressed_message = false;
+            indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, CLOSE_PROTOCOL_ERROR);
+        }
+        /* A chunk too short to produce any output and not ending the message has nothing to indicate */
+        else if ((decompressed_length > 0) || is_message_end)
+        {
+            indicate_ws_fragment_bytes(uws_client, frame_type, is_message_end, decompressed, decompressed_length);
+        }
+    }
+    else
+#endif
+    {
+        indicate_ws_fragment_bytes(uws_client, frame_type, is_message_end, buffer, size);
+    }
+}
+
+/* indicates a complete received message, decompressing it first when it was sent compressed */
+static void indicate_ws_message(UWS_CLIENT_INSTANCE* uws_client, unsigned char frame_type, const unsigned char* buffer, size_t size)
+{
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+    if (uws_client->is_receiving_compressed_message)
+    {
+        const unsigned char* decompressed;
+        size_t decompressed_length;
+
+        uws_client->is_receiving_compressed_message = false;
+
+        /* Codes_SRS_UWS_CLIENT_01_568: [ A received message whose first frame has the RSV1 bit set shall be decompressed by calling `uws_permessage_deflate_decompress` with the `ws_max_message_size` option value as limit before being indicated via `on_ws_frame_received`. ]*/
+        if (uws_permessage_deflate_decompress(uws_client->permessage_deflate, buffer, size, true, uws_client->max_message_size, &decompressed, &decompressed_length) != 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_569: [ If decompressing a received message fails, uws shall send a CLOSE frame with code 1002 and indicate `WS_ERROR_BAD_FRAME_RECEIVED` via `on_ws_error`. ]*/
+            LogError("Cannot decompress received message");
+            indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, CLOSE_PROTOCOL_ERROR);
+        }
+        else if ((uws_client->max_message_size > 0) && (decompressed_length > uws_client->max_message_size))
+        {
+            /* Codes_SRS_UWS_CLIENT_01_570: [ If the decompressed message exceeds the `ws_max_message_size` option, uws shall send a CLOSE frame with code 1009 and indicate `WS_ERROR_MESSAGE_TOO_BIG` via `on_ws_error`. ]*/
+            LogError("Decompressed message exceeds the maximum message size of %lu bytes", (unsigned long)uws_client->max_message_size);
+            indicate_ws_error_and_close(uws_client, WS_ERROR_MESSAGE_TOO_BIG, CLOSE_MESSAGE_TOO_BIG);
+        }
+        else
+        {
+            uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, frame_type, decompressed, decompressed_length);
+        }
+    }
+    else
+#endif
+    {
+        uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, frame_type, buffer, size);
+    }
+}
+
+/* validates the RSV1 bit of a received frame header and notes whether the message it starts is compressed */
+static int check_compressed_bit(UWS_CLIENT_INSTANCE* uws_client, unsigned char frame_header)
+{
+    int result;
+
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+    if (uws_client->permessage_deflate == NULL)
+    {
+        result = 0;
+    }
+    else
+    {
+        unsigned char opcode = frame_header & 0xF;
+        bool is_compressed = (frame_header & 0x40) != 0;
+
+        if ((opcode == (unsigned char)WS_TEXT_FRAME) || (opcode == (unsigned char)WS_BINARY_FRAME))
+        {
+            /* Codes_SRS_UWS_CLIENT_01_572: [ The RSV1 bit of the first frame of a data message shall be used to determine whether the message is compressed. ]*/
+            if (uws_client->fragmented_frame_type == WS_FRAME_TYPE_UNKNOWN)
+            {
+                uws_client->is_receiving_compressed_message = is_compressed;
+            }
+
+            result = 0;
+        }
+        else if (is_compressed)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_573: [ If the RSV1 bit is set on a continuation or control frame, uws shall send a CLOSE frame with code 1002 and indicate `WS_ERROR_BAD_FRAME_RECEIVED` via `on_ws_error`. ]*/
+            LogError("RSV1 set on a frame with opcode %u", (unsigned int)opcode);
+            indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, CLOSE_PROTOCOL_ERROR);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+#else
+    (void)uws_client;
+    (void)frame_header;
+    result = 0;
+#endif
+
+    return result;
+}
+
+static int indicate_streamed_data_frame(UWS_CLIENT_INSTANCE* uws_client, unsigned char frame_header, const unsigned char* payload, size_t available, size_t length)
+{
+    int result;
+    unsigned char opcode = frame_header & 0xF;
+    bool is_final = (frame_header & 0x80) != 0;
+    unsigned char frame_type;
+
+    if (opcode == (unsigned char)WS_CONTINUATION_FRAME)
+    {
+        frame_type = uws_client->fragmented_frame_type;
+    }
+    else if (uws_client->fragmented_frame_type != WS_FRAME_TYPE_UNKNOWN)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_217: [ The fragments of one message MUST NOT be interleaved between the fragments of another message unless an extension has been negotiated that can interpret the interleaving. ]*/
+        frame_type = WS_FRAME_TYPE_UNKNOWN;
+    }
+    else
+    {
+        frame_type = (opcode == (unsigned char)WS_TEXT_FRAME) ? WS_FRAME_TYPE_TEXT : WS_FRAME_TYPE_BINARY;
+    }
+
+    if (frame_type == WS_FRAME_TYPE_UNKNOWN)
+    {
+        LogError("Data frame with opcode %u received out of sequence", (unsigned int)opcode);
+        indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+        result = __FAILURE__;
+    }
+    else
+    {
+        bool is_message_end;
+
+        /* Codes_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
+        if (!is_final)
+        {
+            uws_client->fragmented_frame_type = frame_type;
+        }
+
+        uws_client->streamed_frame_type = frame_type;
+        uws_client->streamed_frame_is_final = is_final;
+        uws_client->streamed_frame_remaining = length - available;
+        is_message_end = is_final && (uws_client->streamed_frame_remaining == 0);
+
+        /* A fragment that has no payload yet and does not end the message has nothing to indicate */
+        if ((available > 0) || is_message_end)
+        {
+            indicate_ws_fragment(uws_client, frame_type, is_message_end, payload, available);
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+static size_t indicate_streamed_frame_bytes(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* buffer, size_t size)
+{
+    size_t indicated = (size < uws_client->streamed_frame_remaining) ? size : uws_client->streamed_frame_remaining;
+
+    uws_client->streamed_frame_remaining -= indicated;
+    indicate_ws_fragment(uws_client, uws_client->streamed_frame_type, uws_client->streamed_frame_is_final && (uws_client->streamed_frame_remaining == 0), buffer, indicated);
+
+    return indicated;
+}
+
+static bool is_message_too_big(UWS_CLIENT_INSTANCE* uws_client, unsigned char opcode, size_t length)
+{
+    size_t message_size_so_far = (opcode == (unsigned char)WS_CONTINUATION_FRAME) ? uws_client->fragment_buffer_count : 0;
+
+    return (uws_client->max_message_size > 0) &&
+        ((message_size_so_far > uws_client->max_message_size) ||
+        (length > uws_client->max_message_size - message_size_so_far));
+}
+
 static void on_underlying_io_bytes_received(void* context, const unsigned char* buffer, size_t size)
 {
     WS_OPEN_RESULT_DETAILED ws_open_result_detailed = { WS_OPEN_OK, 0 };
@@ -1011,6 +1472,9 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
         else
         {
             unsigned char decode_stream = 1;
+            const unsigned char* decode_bytes = NULL;
+            size_t decode_count = 0;
+            bool decoded_in_place = false;
 
             switch (uws_client->uws_state)
             {
@@ -1030,8 +1494,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
             case UWS_STATE_WAITING_FOR_UPGRADE_RESPONSE:
             {
                 /* Codes_SRS_UWS_CLIENT_01_378: [ When `on_underlying_io_bytes_received` is called while the uws is OPENING, the received bytes shall be accumulated in order to attempt parsing the WebSocket Upgrade response. ]*/
-                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->stream_buffer, uws_client->stream_buffer_count + size + 1);
-                if (new_received_bytes == NULL)
+                if (append_stream_buffer_bytes(uws_client, buffer, size) != 0)
                 {
                     /* Codes_SRS_UWS_CLIENT_01_379: [ If allocating memory for accumulating the bytes fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_NOT_ENOUGH_MEMORY`. ]*/
                     ws_open_result_detailed.result = WS_OPEN_ERROR_NOT_ENOUGH_MEMORY;
@@ -1041,9 +1504,8 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 }
                 else
                 {
-                    uws_client->stream_buffer = new_received_bytes;
-                    (void)memcpy(uws_client->stream_buffer + uws_client->stream_buffer_count, buffer, size);
-                    uws_client->stream_buffer_count += size;
+                    decode_bytes = uws_client->stream_buffer;
+                    decode_count = uws_client->stream_buffer_count;
 
                     decode_stream = 1;
                 }
@@ -1055,8 +1517,16 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
             case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
             {
                 /* Codes_SRS_UWS_CLIENT_01_385: [ If the state of the uws instance is OPEN, the received bytes shall be used for decoding WebSocket frames. ]*/
-                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->stream_buffer, uws_client->stream_buffer_count + size + 1);
-                if (new_received_bytes == NULL)
+                if (uws_client->stream_buffer_count == 0)
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_532: [ If no bytes are pending from previous calls, the WebSocket frames shall be decoded directly from `buffer` and the payload indicated via `on_ws_frame_received` shall point into `buffer`, without copying the received bytes. ]*/
+                    decode_bytes = buffer;
+                    decode_count = size;
+                    decoded_in_place = true;
+
+                    decode_stream = 1;
+                }
+                else if (append_stream_buffer_bytes(uws_client, buffer, size) != 0)
                 {
                     /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
                     LogError("Cannot allocate memory for received data");
@@ -1066,9 +1536,8 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 }
                 else
                 {
-                    uws_client->stream_buffer = new_received_bytes;
-                    (void)memcpy(uws_client->stream_buffer + uws_client->stream_buffer_count, buffer, size);
-                    uws_client->stream_buffer_count += size;
+                    decode_bytes = uws_client->stream_buffer;
+                    decode_count = uws_client->stream_buffer_count;
 
                     decode_stream = 1;
                 }
@@ -1129,10 +1598,16 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             ws_open_result_detailed.code = status_code;
                             indicate_ws_open_complete_error_and_close(uws_client, ws_open_result_detailed);
                         }
+                        else if (negotiate_extensions(uws_client, (const char*)uws_client->stream_buffer, &ws_open_result_detailed) != 0)
+                        {
+                            LogError("Cannot negotiate the WebSocket extensions");
+                            indicate_ws_open_complete_error_and_close(uws_client, ws_open_result_detailed);
+                        }
                         else
                         {
                             /* Codes_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-                            consume_stream_buffer_bytes(uws_client, request_end_ptr - (char*)uws_client->stream_buffer + 4);
+                            decode_bytes = (const unsigned char*)request_end_ptr + 4;
+                            decode_count = uws_client->stream_buffer_count - (decode_bytes - uws_client->stream_buffer);
 
                             /* Codes_SRS_UWS_CLIENT_01_381: [ If the status is 101, uws shall be considered OPEN and this shall be indicated by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `IO_OPEN_OK`. ]*/
                             uws_client->uws_state = UWS_STATE_OPEN;
@@ -1156,38 +1631,54 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
 
                     /* Codes_SRS_UWS_CLIENT_01_277: [ To receive WebSocket data, an endpoint listens on the underlying network connection. ]*/
                     /* Codes_SRS_UWS_CLIENT_01_278: [ Incoming data MUST be parsed as WebSocket frames as defined in Section 5.2. ]*/
-                    if (uws_client->stream_buffer_count >= needed_bytes)
+                    if (uws_client->streamed_frame_remaining > 0)
+                    {
+                        /* Codes_SRS_UWS_CLIENT_01_536: [ The rest of the payload of a data frame whose header was already indicated shall be indicated via `on_ws_fragment_received` as it is received. ]*/
+                        if (decode_count > 0)
+                        {
+                            size_t indicated = indicate_streamed_frame_bytes(uws_client, decode_bytes, decode_count);
+                            decode_bytes += indicated;
+                            decode_count -= indicated;
+                            decode_stream = 1;
+                        }
+                    }
+                    else if (decode_count >= needed_bytes)
                     {
                         unsigned char has_error = 0;
+                        unsigned char is_frame_streamed = 0;
 
 #ifdef _MSC_VER
-// Disable: Reading invalid data from 'uws_client->stream_buffer':  the readable size is 'uws_client->stream_buffer_count+size+1' bytes, but '2' bytes may be read.</DESCRIPTION>
+// Disable: Reading invalid data from 'decode_bytes':  the readable size is 'decode_count' bytes, but '2' bytes may be read.</DESCRIPTION>
 #pragma warning(disable:6385)
 #endif
                         /* Codes_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-                        if ((uws_client->stream_buffer[1] & 0x80) != 0)
+                        if ((decode_bytes[1] & 0x80) != 0)
                         {
                             /* Codes_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
                             /* Codes_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
                             LogError("Masked frame detected by WebSocket client");
                             indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1002);
                         }
+                        else if (check_compressed_bit(uws_client, decode_bytes[0]) != 0)
+                        {
+                            has_error = 1;
+                        }
 #ifdef _MSC_VER
 #pragma warning(default:6385)
 #endif
 
                         /* Codes_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
                         /* Codes_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-                        length = uws_client->stream_buffer[1];
+                        length = decode_bytes[1];
 
                         if (length == 126)
                         {
                             /* Codes_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
                             needed_bytes += 2;
-                            if (uws_client->stream_buffer_count >= needed_bytes)
+                            if (decode_count >= needed_bytes)
                             {
                                 /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                length = ((size_t)(uws_client->stream_buffer[2]) << 8) + (size_t)uws_client->stream_buffer[3];
+                                length = ((size_t)(decode_bytes[2]) << 8) + (size_t)decode_bytes[3];
 
                                 if (length < 126)
                                 {
@@ -1208,9 +1699,9 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         {
                             /* Codes_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
                             needed_bytes += 8;
-                            if (uws_client->stream_buffer_count >= needed_bytes)
+                            if (decode_count >= needed_bytes)
                             {
-                                if ((uws_client->stream_buffer[2] & 0x80) != 0)
+                                if ((decode_bytes[2] & 0x80) != 0)
                                 {
                                     LogError("Bad frame: received a 64 bit length frame with the highest bit set");
 
@@ -1221,14 +1712,14 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 else
                                 {
                                     /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                    length = (size_t)(((uint64_t)(uws_client->stream_buffer[2]) << 56) +
-                                        (((uint64_t)uws_client->stream_buffer[3]) << 48) +
-                                        (((uint64_t)uws_client->stream_buffer[4]) << 40) +
-                                        (((uint64_t)uws_client->stream_buffer[5]) << 32) +
-                                        (((uint64_t)uws_client->stream_buffer[6]) << 24) +
-                                        (((uint64_t)uws_client->stream_buffer[7]) << 16) +
-                                        (((uint64_t)uws_client->stream_buffer[8]) << 8) +
-                                        (uint64_t)(uws_client->stream_buffer[9]));
+                                    length = (size_t)(((uint64_t)(decode_bytes[2]) << 56) +
+                                        (((uint64_t)decode_bytes[3]) << 48) +
+                                        (((uint64_t)decode_bytes[4]) << 40) +
+                                        (((uint64_t)decode_bytes[5]) << 32) +
+                                        (((uint64_t)decode_bytes[6]) << 24) +
+                                        (((uint64_t)decode_bytes[7]) << 16) +
+                                        (((uint64_t)decode_bytes[8]) << 8) +
+                                        (uint64_t)(decode_bytes[9]));
 
                                     if (length < 65536)
                                     {
@@ -1251,13 +1742,50 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             needed_bytes += length;
                         }
 
+                        if (has_error == 0)
+                        {
+                            unsigned char opcode = decode_bytes[0] & 0xF;
+                            size_t header_length = (decode_bytes[1] == 126) ? 4 : ((decode_bytes[1] == 127) ? 10 : 2);
+
+                            if ((decode_count >= header_length) &&
+                                ((decode_bytes[1] & 0x80) == 0) &&
+                                ((opcode == (unsigned char)WS_CONTINUATION_FRAME) || (opcode == (unsigned char)WS_TEXT_FRAME) || (opcode == (unsigned char)WS_BINARY_FRAME)))
+                            {
+                                if (uws_client->on_ws_fragment_received != NULL)
+                                {
+                                    /* Codes_SRS_UWS_CLIENT_01_535: [ If `on_ws_fragment_received` was set, the payload of data frames shall be indicated via `on_ws_fragment_received` as soon as the frame header has been received, without waiting for the whole frame or for the final fragment of the message. ]*/
+                                    size_t available = decode_count - header_length;
+                                    if (available > length)
+                                    {
+                                        available = length;
+                                    }
+
+                                    is_frame_streamed = 1;
+                                    if (indicate_streamed_data_frame(uws_client, decode_bytes[0], decode_bytes + header_length, available, length) == 0)
+                                    {
+                                        decode_bytes += header_length + available;
+                                        decode_count -= header_length + available;
+                                        decode_stream = 1;
+                                    }
+                                }
+                                else if (is_message_too_big(uws_client, opcode, length))
+                                {
+                                    /* Codes_SRS_UWS_CLIENT_01_537: [ If `on_ws_fragment_received` was not set and the data frame would make the message exceed the `ws_max_message_size` option, uws shall send a CLOSE frame with code 1009 and indicate `WS_ERROR_MESSAGE_TOO_BIG` via `on_ws_error`, before receiving the frame payload. ]*/
+                                    LogError("Received message exceeds the maximum message size of %lu bytes", (unsigned long)uws_client->max_message_size);
+                                    indicate_ws_error_and_close(uws_client, WS_ERROR_MESSAGE_TOO_BIG, CLOSE_MESSAGE_TOO_BIG);
+                                    has_error = 1;
+                                }
+                            }
+                        }
+
                         if ((has_error == 0) &&
-                            (uws_client->stream_buffer_count >= needed_bytes))
+                            (is_frame_streamed == 0) &&
+                            (decode_count >= needed_bytes))
                         {
-                            unsigned char opcode = uws_client->stream_buffer[0] & 0xF;
+                            unsigned char opcode = decode_bytes[0] & 0xF;
 
                             /* Codes_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-                            bool is_final = (uws_client->stream_buffer[0] & 0x80) != 0;
+                            bool is_final = (decode_bytes[0] & 0x80) != 0;
 
                             switch (opcode)
                             {
@@ -1269,7 +1797,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-                                if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
+                                if (process_frame_fragment(uws_client, decode_bytes + needed_bytes - length, length) != 0)
                                 {
                                     break;
                                 }
@@ -1284,7 +1812,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                         decode_stream = 1;
                                         break;
                                     }
-                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, uws_client->fragmented_frame_type, uws_client->fragment_buffer, uws_client->fragment_buffer_count);
+                                    indicate_ws_message(uws_client, uws_client->fragmented_frame_type, uws_client->fragment_buffer, uws_client->fragment_buffer_count);
                                     uws_client->fragment_buffer_count = 0;
                                     uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
                                 }
@@ -1303,7 +1831,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
                                 if (is_final)
                                 {
-                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, uws_client->stream_buffer + needed_bytes - length, length);
+                                    indicate_ws_message(uws_client, WS_FRAME_TYPE_TEXT, decode_bytes + needed_bytes - length, length);
                                 }
                                 else
                                 {
@@ -1318,7 +1846,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-                                    if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
+                                    if (process_frame_fragment(uws_client, decode_bytes + needed_bytes - length, length) != 0)
                                     {
                                         break;
                                     }
@@ -1343,7 +1871,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
                                 if (is_final)
                                 {
-                                    uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, uws_client->stream_buffer + needed_bytes - length, length);
+                                    indicate_ws_message(uws_client, WS_FRAME_TYPE_BINARY, decode_bytes + needed_bytes - length, length);
                                 }
                                 else
                                 {
@@ -1358,7 +1886,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-                                    if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
+                                    if (process_frame_fragment(uws_client, decode_bytes + needed_bytes - length, length) != 0)
                                     {
                                         break;
                                     }
@@ -1379,7 +1907,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 LogInfo("%s: Close frame received", __FUNCTION__);
                                 uint16_t close_code;
                                 uint16_t* close_code_ptr;
-                                const unsigned char* data_ptr = uws_client->stream_buffer + needed_bytes - length;
+                                const unsigned char* data_ptr = decode_bytes + needed_bytes - length;
                                 const unsigned char* extra_data_ptr;
                                 size_t extra_data_length;
                                 unsigned char* close_frame_bytes;
@@ -1536,7 +2064,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 }
 
                                 /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                pong_frame_buffer = uws_frame_encoder_encode(WS_PONG_FRAME, uws_client->stream_buffer + needed_bytes - length, length, true, true, 0);
+                                pong_frame_buffer = uws_frame_encoder_encode(WS_PONG_FRAME, decode_bytes + needed_bytes - length, length, true, true, 0);
                                 if (pong_frame_buffer == NULL)
                                 {
                                     LogError("Encoding of PONG failed.");
@@ -1554,14 +2082,18 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     BUFFER_delete(pong_frame_buffer);
                                 }
 
+                                /* Codes_SRS_UWS_CLIENT_01_214: [ Control frames (see Section 5.5) MAY be injected in the middle of a fragmented message. ]*/
+                                decode_stream = 1;
                                 break;
                             }
                             /* Codes_SRS_UWS_CLIENT_01_252: [ The Pong frame contains an opcode of 0xA. ]*/
                             case (unsigned char)WS_PONG_FRAME:
+                                decode_stream = 1;
                                 break;
                             }
 
-                            consume_stream_buffer_bytes(uws_client, needed_bytes);
+                            decode_bytes += needed_bytes;
+                            decode_count -= needed_bytes;
                         }
                     }
 
@@ -1569,6 +2101,11 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 }
                 }
             }
+
+            if (decode_bytes != NULL)
+            {
+                retain_undecoded_bytes(uws_client, decode_bytes, decode_count, decoded_in_place);
+            }
         }
     }
 }
@@ -1644,6 +2181,8 @@ int uws_client_open_async(UWS_CLIENT_HANDLE uws_client, ON_WS_OPEN_COMPLETE on_w
             uws_client->stream_buffer_count = 0;
             uws_client->fragment_buffer_count = 0;
             uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+            uws_client->streamed_message_started = false;
+            uws_client->streamed_frame_remaining = 0;
 
             uws_client->on_ws_open_complete = on_ws_open_complete;
             uws_client->on_ws_open_complete_context = on_ws_open_complete_context;
@@ -1865,6 +2404,109 @@ static bool find_list_node(LIST_ITEM_HANDLE list_item, const void* match_context
     return list_item == (LIST_ITEM_HANDLE)match_context;
 }
 
+/* queues ws_pending_send and sends the encoded frame, on failure ws_pending_send is freed */
+static int send_pending_frame(UWS_CLIENT_INSTANCE* uws_client, WS_PENDING_SEND* ws_pending_send, const unsigned char* encoded_frame, size_t encoded_frame_length, ON_WS_SEND_FRAME_COMPLETE on_ws_send_frame_complete, void* on_ws_send_frame_complete_context)
+{
+    int result;
+    LIST_ITEM_HANDLE new_pending_send_list_item;
+
+    /* Codes_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
+    /* Codes_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
+    /* Codes_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
+    /* Codes_SRS_UWS_CLIENT_01_041: [ - the send complete callback context `on_ws_send_frame_complete_context` ]*/
+    ws_pending_send->on_ws_send_frame_complete = on_ws_send_frame_complete;
+    ws_pending_send->context = on_ws_send_frame_complete_context;
+    ws_pending_send->uws_client = uws_client;
+
+    /* Codes_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
+    new_pending_send_list_item = singlylinkedlist_add(uws_client->pending_sends, ws_pending_send);
+    if (new_pending_send_list_item == NULL)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_049: [ If `singlylinkedlist_add` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+        LogError("Could not allocate memory for pending frames");
+        free(ws_pending_send);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_CLIENT_01_431: [ Once encoded the frame shall be sent by using `xio_send` with the following arguments: ]*/
+        /* Codes_SRS_UWS_CLIENT_01_053: [ - the io handle shall be the underlyiong IO handle created in `uws_client_create`. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_054: [ - the `buffer` argument shall point to the complete websocket frame to be sent. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_055: [ - the `size` argument shall indicate the websocket frame length. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_057: [ - the `send_complete_context` argument shall identify the pending send. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_276: [ The frame(s) that have been formed MUST be transmitted over the underlying network connection. ]*/
+        if (xio_send(uws_client->underlying_io, encoded_frame, encoded_frame_length, on_underlying_io_send_complete, new_pending_send_list_item) != 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_058: [ If `xio_send` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+            LogError("Could not send bytes through the underlying IO");
+
+            /* Codes_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
+            if (singlylinkedlist_find(uws_client->pending_sends, find_list_node, new_pending_send_list_item) != NULL)
+            {
+                // Guards against double free in case the underlying I/O invoked 'on_underlying_io_send_complete' within xio_send,
+                // in which the message is already removed from the list and freed.
+                (void)singlylinkedlist_remove(uws_client->pending_sends, new_pending_send_list_item);
+                free(ws_pending_send);
+            }
+
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+/* compresses an unfragmented message into a frame with RSV1 set and sends it, on failure ws_pending_send is freed */
+static int send_compressed_frame(UWS_CLIENT_INSTANCE* uws_client, WS_PENDING_SEND* ws_pending_send, unsigned char frame_type, const unsigned char* buffer, size_t size, ON_WS_SEND_FRAME_COMPLETE on_ws_send_frame_complete, void* on_ws_send_frame_complete_context)
+{
+    int result;
+    unsigned char* compressed;
+    size_t compressed_length;
+    size_t frame_offset;
+
+    /* Codes_SRS_UWS_CLIENT_01_574: [ When `permessage-deflate` was negotiated, an unfragmented text or binary message shall be compressed by calling `uws_permessage_deflate_compress`, reserving `UWS_FRAME_ENCODER_MAX_HEADER_SIZE` bytes of headroom before the compressed payload. ]*/
+    if (uws_permessage_deflate_compress(uws_client->permessage_deflate, buffer, size, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, &compressed, &compressed_length) != 0)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_575: [ If `uws_permessage_deflate_compress` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+        LogError("Failed compressing WebSocket message");
+        free(ws_pending_send);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_CLIENT_01_576: [ The compressed payload shall be encoded in place by calling `uws_frame_encoder_encode_in_place` with `is_masked` set to true and the RSV1 bit set. ]*/
+        if (uws_frame_encoder_encode_in_place((WS_FRAME_TYPE)frame_type, compressed - UWS_FRAME_ENCODER_MAX_HEADER_SIZE, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, compressed_length, true, true, RESERVED_1, &frame_offset) != 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+            LogError("Failed encoding WebSocket frame");
+            free(ws_pending_send);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = send_pending_frame(uws_client, ws_pending_send, compressed - UWS_FRAME_ENCODER_MAX_HEADER_SIZE + frame_offset, UWS_FRAME_ENCODER_MAX_HEADER_SIZE - frame_offset + compressed_length, on_ws_send_frame_complete, on_ws_send_frame_complete_context);
+        }
+
+        /* the deflater history now holds a message the server never inflates, later messages would reference it */
+        if ((result != 0) &&
+            (uws_client->permessage_deflate_takes_over_context))
+        {
+            /* Codes_SRS_UWS_CLIENT_01_584: [ If encoding or sending the compressed frame fails and `client_no_context_takeover` was not negotiated, uws shall send a close frame with code 1011, go to the error state and indicate the error by calling `on_ws_error` with `WS_ERROR_UNDERLYING_IO_ERROR`. ]*/
+            indicate_ws_error_and_close(uws_client, WS_ERROR_UNDERLYING_IO_ERROR, CLOSE_UNEXPECTED_CONDITION);
+        }
+    }
+
+    return result;
+}
+#endif
+
 int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char frame_type, const unsigned char* buffer, size_t size, bool is_final, ON_WS_SEND_FRAME_COMPLETE on_ws_send_frame_complete, void* on_ws_send_frame_complete_context)
 {
     int result;
@@ -1899,6 +2541,15 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
             LogError("Cannot allocate memory for frame to be sent.");
             result = __FAILURE__;
         }
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+        /* Codes_SRS_UWS_CLIENT_01_577: [ Fragmented messages shall be sent uncompressed. ]*/
+        else if ((uws_client->permessage_deflate != NULL) &&
+            is_final &&
+            ((frame_type == (unsigned char)WS_TEXT_FRAME) || (frame_type == (unsigned char)WS_BINARY_FRAME)))
+        {
+            result = send_compressed_frame(uws_client, ws_pending_send, frame_type, buffer, size, on_ws_send_frame_complete, on_ws_send_frame_complete_context);
+        }
+#endif
         else
         {
             BUFFER_HANDLE non_control_frame_buffer;
@@ -1919,67 +2570,75 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
             {
                 const unsigned char* encoded_frame;
                 size_t encoded_frame_length;
-                LIST_ITEM_HANDLE new_pending_send_list_item;
 
                 /* Codes_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
                 encoded_frame = BUFFER_u_char(non_control_frame_buffer);
                 /* Codes_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
                 encoded_frame_length = BUFFER_length(non_control_frame_buffer);
 
-                /* Codes_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
-                /* Codes_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
-                /* Codes_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
-                /* Codes_SRS_UWS_CLIENT_01_041: [ - the send complete callback context `on_ws_send_frame_complete_context` ]*/
-                ws_pending_send->on_ws_send_frame_complete = on_ws_send_frame_complete;
-                ws_pending_send->context = on_ws_send_frame_complete_context;
-                ws_pending_send->uws_client = uws_client;
-
-                /* Codes_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
-                new_pending_send_list_item = singlylinkedlist_add(uws_client->pending_sends, ws_pending_send);
-                if (new_pending_send_list_item == NULL)
-                {
-                    /* Codes_SRS_UWS_CLIENT_01_049: [ If `singlylinkedlist_add` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-                    LogError("Could not allocate memory for pending frames");
-                    free(ws_pending_send);
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    /* Codes_SRS_UWS_CLIENT_01_431: [ Once encoded the frame shall be sent by using `xio_send` with the following arguments: ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_053: [ - the io handle shall be the underlyiong IO handle created in `uws_client_create`. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_054: [ - the `buffer` argument shall point to the complete websocket frame to be sent. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_055: [ - the `size` argument shall indicate the websocket frame length. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_057: [ - the `send_complete_context` argument shall identify the pending send. ]*/
-                    /* Codes_SRS_UWS_CLIENT_01_276: [ The frame(s) that have been formed MUST be transmitted over the underlying network connection. ]*/
-                    if (xio_send(uws_client->underlying_io, encoded_frame, encoded_frame_length, on_underlying_io_send_complete, new_pending_send_list_item) != 0)
-                    {
-                        /* Codes_SRS_UWS_CLIENT_01_058: [ If `xio_send` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-                        LogError("Could not send bytes through the underlying IO");
+                result = send_pending_frame(uws_client, ws_pending_send, encoded_frame, encoded_frame_length, on_ws_send_frame_complete, on_ws_send_frame_complete_context);
 
-                        /* Codes_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
-                        if (singlylinkedlist_find(uws_client->pending_sends, find_list_node, new_pending_send_list_item) != NULL)
-                        {
-                            // Guards against double free in case the underlying I/O invoked 'on_underlying_io_send_complete' within xio_send,
-                            // in which the message is already removed from the list and freed.
-                            (void)singlylinkedlist_remove(uws_client->pending_sends, new_pending_send_list_item);
-                            free(ws_pending_send);
-                        }
+                BUFFER_delete(non_control_frame_buffer);
+            }
+        }
+    }
 
-                        result = __FAILURE__;
-                    }
-                    else
-                    {
-                        /* Codes_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
-                        result = 0;
-                    }
-                }
+    return result;
+}
 
-                BUFFER_delete(non_control_frame_buffer);
+int uws_client_send_frame_in_place_async(UWS_CLIENT_HANDLE uws_client, unsigned char frame_type, unsigned char* buffer, size_t headroom, size_t size, bool is_final, ON_WS_SEND_FRAME_COMPLETE on_ws_send_frame_complete, void* on_ws_send_frame_complete_context)
+{
+    int result;
+
+    if (uws_client == NULL)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_547: [ If `uws_client` is NULL, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+        LogError("NULL uws handle.");
+        result = __FAILURE__;
+    }
+    else if (buffer == NULL)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_548: [ If `buffer` is NULL, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+        LogError("NULL buffer.");
+        result = __FAILURE__;
+    }
+    else if (uws_client->uws_state != UWS_STATE_OPEN)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_549: [ If the uws instance is not OPEN, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+        LogError("uws not in OPEN state.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        WS_PENDING_SEND* ws_pending_send = (WS_PENDING_SEND*)malloc(sizeof(WS_PENDING_SEND));
+        if (ws_pending_send == NULL)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_550: [ If allocating memory for the newly queued item fails, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+            LogError("Cannot allocate memory for frame to be sent.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t frame_offset;
+
+            /* Codes_SRS_UWS_CLIENT_01_551: [ The frame shall be encoded by calling `uws_frame_encoder_encode_in_place` with `buffer`, `headroom` and `size`, the `is_final` flag and `is_masked` set to true, so that the header is written in the headroom and the payload is masked where it is. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_274: [ If the data is being sent by the client, the frame(s) MUST be masked as defined in Section 5.3. ]*/
+            if (uws_frame_encoder_encode_in_place((WS_FRAME_TYPE)frame_type, buffer, headroom, size, true, is_final, 0, &frame_offset) != 0)
+            {
+                /* Codes_SRS_UWS_CLIENT_01_552: [ If `uws_frame_encoder_encode_in_place` fails, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+                LogError("Failed encoding WebSocket frame");
+                free(ws_pending_send);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* Codes_SRS_UWS_CLIENT_01_553: [ The encoded frame shall be queued and sent with `xio_send` the same way `uws_client_send_frame_async` sends it, starting at the offset returned by `uws_frame_encoder_encode_in_place`. ]*/
+                result = send_pending_frame(uws_client, ws_pending_send, buffer + frame_offset, headroom - frame_offset + size, on_ws_send_frame_complete, on_ws_send_frame_complete_context);
             }
         }
     }
 
+    /* Codes_SRS_UWS_CLIENT_01_554: [ `uws_client_send_frame_in_place_async` shall not free `buffer`, the bytes are copied by `xio_send` and the caller may reuse or free `buffer` as soon as the call returns. ]*/
     return result;
 }
 
@@ -2001,6 +2660,64 @@ void uws_client_dowork(UWS_CLIENT_HANDLE uws_client)
     }
 }
 
+int uws_client_set_fragment_received_callback(UWS_CLIENT_HANDLE uws_client, ON_WS_FRAGMENT_RECEIVED on_ws_fragment_received, void* on_ws_fragment_received_context)
+{
+    int result;
+
+    if (uws_client == NULL)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_538: [ If `uws_client` is NULL, `uws_client_set_fragment_received_callback` shall fail and return a non-zero value. ]*/
+        LogError("NULL uws handle.");
+        result = __FAILURE__;
+    }
+    else if (uws_client->uws_state != UWS_STATE_CLOSED)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_539: [ If the uws instance is not CLOSED, `uws_client_set_fragment_received_callback` shall fail and return a non-zero value. ]*/
+        LogError("Invalid uWS state while trying to set the fragment received callback: %d", (int)uws_client->uws_state);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_CLIENT_01_540: [ Otherwise `uws_client_set_fragment_received_callback` shall store `on_ws_fragment_received` and `on_ws_fragment_received_context` and return 0. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_541: [ Setting a NULL `on_ws_fragment_received` shall revert to indicating whole messages via `on_ws_frame_received`. ]*/
+        uws_client->on_ws_fragment_received = on_ws_fragment_received;
+        uws_client->on_ws_fragment_received_context = on_ws_fragment_received_context;
+        result = 0;
+    }
+
+    return result;
+}
+
+int uws_client_get_permessage_deflate_statistics(UWS_CLIENT_HANDLE uws_client, WS_PERMESSAGE_DEFLATE_STATISTICS* statistics)
+{
+    int result;
+
+    if ((uws_client == NULL) ||
+        (statistics == NULL))
+    {
+        /* Codes_SRS_UWS_CLIENT_01_581: [ If `uws_client` or `statistics` is NULL, `uws_client_get_permessage_deflate_statistics` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: uws_client=%p, statistics=%p", uws_client, statistics);
+        result = __FAILURE__;
+    }
+    else if (uws_client->permessage_deflate == NULL)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_582: [ If `permessage-deflate` was not negotiated, `uws_client_get_permessage_deflate_statistics` shall fail and return a non-zero value. ]*/
+        LogError("permessage-deflate was not negotiated");
+        result = __FAILURE__;
+    }
+    else
+    {
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+        /* Codes_SRS_UWS_CLIENT_01_583: [ Otherwise `uws_client_get_permessage_deflate_statistics` shall fill `statistics` by calling `uws_permessage_deflate_get_statistics` and return its result. ]*/
+        result = uws_permessage_deflate_get_statistics(uws_client->permessage_deflate, statistics);
+#else
+        result = __FAILURE__;
+#endif
+    }
+
+    return result;
+}
+
 int uws_client_set_option(UWS_CLIENT_HANDLE uws_client, const char* option_name, const void* value)
 {
     int result;
@@ -2031,6 +2748,70 @@ int uws_client_set_option(UWS_CLIENT_HANDLE uws_client, const char* option_name,
                 result = 0;
             }
         }
+        else if (strcmp(OPTION_WS_MAX_MESSAGE_SIZE, option_name) == 0)
+        {
+            if (value == NULL)
+            {
+                /* Codes_SRS_UWS_CLIENT_01_542: [ If the option name is `ws_max_message_size` and `value` is NULL, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+                LogError("NULL value for option %s", option_name);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* Codes_SRS_UWS_CLIENT_01_543: [ If the option name is `ws_max_message_size`, `value` shall be interpreted as a pointer to a `size_t` holding the largest message size uws reassembles, 0 meaning no limit. ]*/
+                uws_client->max_message_size = *(const size_t*)value;
+
+                /* Codes_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
+                result = 0;
+            }
+        }
+        else if (strcmp(OPTION_WS_PERMESSAGE_DEFLATE, option_name) == 0)
+        {
+            if (value == NULL)
+            {
+                /* Codes_SRS_UWS_CLIENT_01_555: [ If the option name is `ws_permessage_deflate` and `value` is NULL, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+                LogError("NULL value for option %s", option_name);
+                result = __FAILURE__;
+            }
+            else
+            {
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+                const WS_PERMESSAGE_DEFLATE_CONFIG* config = (const WS_PERMESSAGE_DEFLATE_CONFIG*)value;
+
+                /* Codes_SRS_UWS_CLIENT_01_557: [ If the `ws_permessage_deflate` configuration has a `client_max_window_bits` outside 9..15, a `server_max_window_bits` outside 8..15 or a `compression_level` outside -1..9, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+                if ((config->client_max_window_bits < 9) || (config->client_max_window_bits > 15) ||
+                    (config->server_max_window_bits < 8) || (config->server_max_window_bits > 15) ||
+                    (config->compression_level < -1) || (config->compression_level > 9))
+                {
+                    LogError("Invalid permessage-deflate configuration");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_558: [ If the option name is `ws_permessage_deflate`, `value` shall be interpreted as a pointer to a `WS_PERMESSAGE_DEFLATE_CONFIG` and a copy of it shall be kept, replacing any previously set configuration, to be offered on the next open. ]*/
+                    WS_PERMESSAGE_DEFLATE_CONFIG* new_config = (WS_PERMESSAGE_DEFLATE_CONFIG*)malloc(sizeof(WS_PERMESSAGE_DEFLATE_CONFIG));
+                    if (new_config == NULL)
+                    {
+                        LogError("Cannot allocate memory for option %s", option_name);
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        *new_config = *config;
+                        free(uws_client->permessage_deflate_config);
+                        uws_client->permessage_deflate_config = new_config;
+
+                        /* Codes_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
+                        result = 0;
+                    }
+                }
+#else
+                /* Codes_SRS_UWS_CLIENT_01_556: [ If uws was built without `use_ws_permessage_deflate`, setting the `ws_permessage_deflate` option shall fail and return a non-zero value. ]*/
+                LogError("Option %s requires building with use_ws_permessage_deflate", option_name);
+                result = __FAILURE__;
+#endif
+            }
+        }
         else
         {
             /* Codes_SRS_UWS_CLIENT_01_441: [ Otherwise all options shall be passed as they are to the underlying IO by calling `xio_setoption`. ]*/
@@ -2071,6 +2852,36 @@ static void* uws_client_clone_option(const char* name, const void* value)
             /* Codes_SRS_UWS_CLIENT_01_507: [ `uws_client_clone_option` called with `name` being `uWSClientOptions` shall return the same value. ]*/
             result = (void*)value;
         }
+        else if (strcmp(name, OPTION_WS_MAX_MESSAGE_SIZE) == 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_544: [ `uws_client_clone_option` called with `name` being `ws_max_message_size` shall return a newly allocated copy of the `size_t` value. ]*/
+            size_t* max_message_size = (size_t*)malloc(sizeof(size_t));
+            if (max_message_size == NULL)
+            {
+                LogError("Cannot allocate memory for option %s", name);
+            }
+            else
+            {
+                *max_message_size = *(const size_t*)value;
+            }
+
+            result = max_message_size;
+        }
+        else if (strcmp(name, OPTION_WS_PERMESSAGE_DEFLATE) == 0)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_578: [ `uws_client_clone_option` called with `name` being `ws_permessage_deflate` shall return a newly allocated copy of the `WS_PERMESSAGE_DEFLATE_CONFIG` value. ]*/
+            WS_PERMESSAGE_DEFLATE_CONFIG* config = (WS_PERMESSAGE_DEFLATE_CONFIG*)malloc(sizeof(WS_PERMESSAGE_DEFLATE_CONFIG));
+            if (config == NULL)
+            {
+                LogError("Cannot allocate memory for option %s", name);
+            }
+            else
+            {
+                *config = *(const WS_PERMESSAGE_DEFLATE_CONFIG*)value;
+            }
+
+            result = config;
+        }
         else
         {
             /* Codes_SRS_UWS_CLIENT_01_512: [ `uws_client_clone_option` called with any other option name than `uWSClientOptions` shall return NULL. ]*/
@@ -2099,6 +2910,13 @@ static void uws_client_destroy_option(const char* name, const void* value)
             /* Codes_SRS_UWS_CLIENT_01_508: [ `uws_client_destroy_option` called with the option `name` being `uWSClientOptions` shall destroy the value by calling `OptionHandler_Destroy`. ]*/
             OptionHandler_Destroy((OPTIONHANDLER_HANDLE)value);
         }
+        else if ((strcmp(name, OPTION_WS_MAX_MESSAGE_SIZE) == 0) ||
+            (strcmp(name, OPTION_WS_PERMESSAGE_DEFLATE) == 0))
+        {
+            /* Codes_SRS_UWS_CLIENT_01_545: [ `uws_client_destroy_option` called with the option `name` being `ws_max_message_size` shall free the value. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_579: [ `uws_client_destroy_option` called with the option `name` being `ws_permessage_deflate` shall free the value. ]*/
+            free((void*)value);
+        }
         else
         {
             /* Codes_SRS_UWS_CLIENT_01_513: [ If `uws_client_destroy_option` is called with any other `name` it shall do nothing. ]*/
@@ -2149,6 +2967,22 @@ OPTIONHANDLER_HANDLE uws_client_retrieve_options(UWS_CLIENT_HANDLE uws_client)
                     OptionHandler_Destroy(result);
                     result = NULL;
                 }
+                else if ((uws_client->max_message_size > 0) &&
+                    (OptionHandler_AddOption(result, OPTION_WS_MAX_MESSAGE_SIZE, &uws_client->max_message_size) != OPTIONHANDLER_OK))
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_546: [ If the `ws_max_message_size` option was set, it shall also be added to the option handler and if that fails `uws_client_retrieve_options` shall fail and return NULL. ]*/
+                    LogError("OptionHandler_AddOption failed");
+                    OptionHandler_Destroy(result);
+                    result = NULL;
+                }
+                else if ((uws_client->permessage_deflate_config != NULL) &&
+                    (OptionHandler_AddOption(result, OPTION_WS_PERMESSAGE_DEFLATE, uws_client->permessage_deflate_config) != OPTIONHANDLER_OK))
+                {
+                    /* Codes_SRS_UWS_CLIENT_01_580: [ If the `ws_permessage_deflate` option was set, it shall also be added to the option handler and if that fails `uws_client_retrieve_options` shall fail and return NULL. ]*/
+                    LogError("OptionHandler_AddOption failed");
+                    OptionHandler_Destroy(result);
+                    result = NULL;
+                }
             }
         }
 
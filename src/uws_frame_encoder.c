@@ -5,13 +5,204 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gb_rand.h"
 #include "azure_c_shared_utility/uws_frame_encoder.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/uniqueid.h"
 
+/* The masking kernel uses the widest vector unit the compiler is allowed to target (AVX2 only when building with
+-mavx2 or /arch:AVX2), then 64 bit words, then single bytes for the tail. */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UWS_MASK_USE_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define UWS_MASK_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define UWS_MASK_USE_NEON
+#endif
+
+/* Codes_SRS_UWS_FRAME_ENCODER_01_039: [ To convert masked data into unmasked data, or vice versa, the following algorithm is applied. ]*/
+/* Codes_SRS_UWS_FRAME_ENCODER_01_040: [ The same algorithm applies regardless of the direction of the translation, e.g., the same steps are applied to mask the data as to unmask the data. ]*/
+/* Codes_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
+static void mask_payload(unsigned char* destination, const unsigned char* source, size_t length, const unsigned char* mask_key)
+{
+    /* every block below is a multiple of 4 bytes long, so the key repeated over the block lines up with i modulo 4 */
+    unsigned char mask_pattern[32];
+    uint64_t mask_word;
+    size_t i;
+
+    for (i = 0; i < sizeof(mask_pattern); i++)
+    {
+        mask_pattern[i] = mask_key[i % 4];
+    }
+
+    i = 0;
+
+#if defined(UWS_MASK_USE_AVX2)
+    {
+        __m256i mask_vector = _mm256_loadu_si256((const __m256i*)mask_pattern);
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i data = _mm256_loadu_si256((const __m256i*)(source + i));
+            _mm256_storeu_si256((__m256i*)(destination + i), _mm256_xor_si256(data, mask_vector));
+        }
+    }
+#endif
+
+#if defined(UWS_MASK_USE_SSE2)
+    {
+        __m128i mask_vector = _mm_loadu_si128((const __m128i*)mask_pattern);
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i*)(source + i));
+            _mm_storeu_si128((__m128i*)(destination + i), _mm_xor_si128(data, mask_vector));
+        }
+    }
+#elif defined(UWS_MASK_USE_NEON)
+    {
+        uint8x16_t mask_vector = vld1q_u8(mask_pattern);
+        for (; i + 16 <= length; i += 16)
+        {
+            vst1q_u8(destination + i, veorq_u8(vld1q_u8(source + i), mask_vector));
+        }
+    }
+#endif
+
+    /* memcpy keeps the word accesses legal for unaligned payloads, compilers turn it into plain loads and stores */
+    (void)memcpy(&mask_word, mask_pattern, sizeof(mask_word));
+    for (; i + sizeof(mask_word) <= length; i += sizeof(mask_word))
+    {
+        uint64_t data;
+        (void)memcpy(&data, source + i, sizeof(data));
+        data ^= mask_word;
+        (void)memcpy(destination + i, &data, sizeof(data));
+    }
+
+    for (; i < length; i++)
+    {
+        destination[i] = source[i] ^ mask_key[i % 4];
+    }
+}
+
+static size_t get_header_size(size_t length, bool is_masked)
+{
+    size_t header_size = 2;
+
+    if (length > 65535)
+    {
+        header_size += 8;
+    }
+    else if (length > 125)
+    {
+        header_size += 2;
+    }
+
+    if (is_masked)
+    {
+        header_size += 4;
+    }
+
+    return header_size;
+}
+
+/* writes the header_size bytes of the frame header, including a fresh masking key when is_masked is true */
+static int write_header(unsigned char* header, size_t header_size, WS_FRAME_TYPE opcode, size_t length, bool is_masked, bool is_final, unsigned char reserved)
+{
+    int result;
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_007: [ *  %x0 denotes a continuation frame ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_008: [ *  %x1 denotes a text frame ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_009: [ *  %x2 denotes a binary frame ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_010: [ *  %x3-7 are reserved for further non-control frames ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_011: [ *  %x8 denotes a connection close ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_012: [ *  %x9 denotes a ping ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_013: [ *  %xA denotes a pong ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_014: [ *  %xB-F are reserved for further control frames ]*/
+    header[0] = (unsigned char)opcode;
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_002: [ Indicates that this is the final fragment in a message. ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_003: [ The first fragment MAY also be the final fragment. ]*/
+    if (is_final)
+    {
+        header[0] |= 0x80;
+    }
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_004: [ MUST be 0 unless an extension is negotiated that defines meanings for non-zero values. ]*/
+    header[0] |= reserved << 4;
+
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_022: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_018: [ The length of the "Payload data", in bytes: ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_023: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
+    /* Codes_SRS_UWS_FRAME_ENCODER_01_042: [ The payload length, indicated in the framing as frame-payload-length, does NOT include the length of the masking key. ]*/
+    if (length > 65535)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_020: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
+        header[1] = 127;
+
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
+        header[2] = (unsigned char)((uint64_t)length >> 56) & 0xFF;
+        header[3] = (unsigned char)((uint64_t)length >> 48) & 0xFF;
+        header[4] = (unsigned char)((uint64_t)length >> 40) & 0xFF;
+        header[5] = (unsigned char)((uint64_t)length >> 32) & 0xFF;
+        header[6] = (unsigned char)((uint64_t)length >> 24) & 0xFF;
+        header[7] = (unsigned char)((uint64_t)length >> 16) & 0xFF;
+        header[8] = (unsigned char)((uint64_t)length >> 8) & 0xFF;
+        header[9] = (unsigned char)(length & 0xFF);
+    }
+    else if (length > 125)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_019: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
+        header[1] = 126;
+
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
+        header[2] = (unsigned char)(length >> 8);
+        header[3] = (unsigned char)(length & 0xFF);
+    }
+    else
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_043: [ if 0-125, that is the payload length. ]*/
+        header[1] = (unsigned char)length;
+    }
+
+    if (is_masked)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_015: [ Defines whether the "Payload data" is masked. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_033: [ A masked frame MUST have the field frame-masked set to 1, as defined in Section 5.2. ]*/
+        header[1] |= 0x80;
+
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand_bytes` shall be called once to fill the 4 bytes of the masking key. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_016: [ If set to 1, a masking key is present in masking-key, and this is used to unmask the "Payload data" as per Section 5.3. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_026: [ This field is present if the mask bit is set to 1 and is absent if the mask bit is set to 0. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_034: [ The masking key is contained completely within the frame, as defined in Section 5.2 as frame-masking-key. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_036: [ The masking key is a 32-bit value chosen at random by the client. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_037: [ When preparing a masked frame, the client MUST pick a fresh masking key from the set of allowed 32-bit values. ]*/
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_038: [ The masking key needs to be unpredictable; thus, the masking key MUST be derived from a strong source of entropy, and the masking key for a given frame MUST NOT make it simple for a server/proxy to predict the masking key for a subsequent frame. ]*/
+        if (gb_rand_bytes(header + header_size - 4, 4) != 0)
+        {
+            LogError("Cannot generate masking key");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
 BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char* payload, size_t length, bool is_masked, bool is_final, unsigned char reserved)
 {
     BUFFER_HANDLE result;
@@ -37,9 +228,6 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
     }
     else
     {
-        size_t needed_bytes = 2;
-        size_t header_bytes;
-
         /* Codes_SRS_UWS_FRAME_ENCODER_01_044: [ On success `uws_frame_encoder_encode` shall return a non-NULL handle to the result buffer. ]*/
         /* Codes_SRS_UWS_FRAME_ENCODER_01_048: [ The newly created buffer shall be created by calling `BUFFER_new`. ]*/
         result = BUFFER_new();
@@ -51,25 +239,10 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
         else
         {
             /* Codes_SRS_UWS_FRAME_ENCODER_01_001: [ `uws_frame_encoder_encode` shall encode the information given in `opcode`, `payload`, `length`, `is_masked`, `is_final` and `reserved` according to the RFC6455 into a new buffer.]*/
-            if (length > 65535)
-            {
-                needed_bytes += 8;
-            }
-            else if (length > 125)
-            {
-                needed_bytes += 2;
-            }
-
-            if (is_masked)
-            {
-                needed_bytes += 4;
-            }
-
-            header_bytes = needed_bytes;
-            needed_bytes += length;
+            size_t header_bytes = get_header_size(length, is_masked);
 
             /* Codes_SRS_UWS_FRAME_ENCODER_01_046: [ The result buffer shall be resized accordingly using `BUFFER_enlarge`. ]*/
-            if (BUFFER_enlarge(result, needed_bytes) != 0)
+            if (BUFFER_enlarge(result, header_bytes + length) != 0)
             {
                 /* Codes_SRS_UWS_FRAME_ENCODER_01_047: [ If `BUFFER_enlarge` fails then `uws_frame_encoder_encode` shall fail and return NULL. ]*/
                 LogError("Cannot allocate memory for encoded frame");
@@ -87,102 +260,85 @@ BUFFER_HANDLE uws_frame_encoder_encode(WS_FRAME_TYPE opcode, const unsigned char
                     BUFFER_delete(result);
                     result = NULL;
                 }
-                else
+                else if (write_header(buffer, header_bytes, opcode, length, is_masked, is_final, reserved) != 0)
                 {
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_007: [ *  %x0 denotes a continuation frame ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_008: [ *  %x1 denotes a text frame ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_009: [ *  %x2 denotes a binary frame ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_010: [ *  %x3-7 are reserved for further non-control frames ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_011: [ *  %x8 denotes a connection close ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_012: [ *  %x9 denotes a ping ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_013: [ *  %xA denotes a pong ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_014: [ *  %xB-F are reserved for further control frames ]*/
-                    buffer[0] = (unsigned char)opcode;
-
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_002: [ Indicates that this is the final fragment in a message. ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_003: [ The first fragment MAY also be the final fragment. ]*/
-                    if (is_final)
-                    {
-                        buffer[0] |= 0x80;
-                    }
-
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_004: [ MUST be 0 unless an extension is negotiated that defines meanings for non-zero values. ]*/
-                    buffer[0] |= reserved << 4;
-
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_022: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_018: [ The length of the "Payload data", in bytes: ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_023: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
-                    /* Codes_SRS_UWS_FRAME_ENCODER_01_042: [ The payload length, indicated in the framing as frame-payload-length, does NOT include the length of the masking key. ]*/
-                    if (length > 65535)
-                    {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_020: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
-                        buffer[1] = 127;
-
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
-                        buffer[2] = (unsigned char)((uint64_t)length >> 56) & 0xFF;
-                        buffer[3] = (unsigned char)((uint64_t)length >> 48) & 0xFF;
-                        buffer[4] = (unsigned char)((uint64_t)length >> 40) & 0xFF;
-                        buffer[5] = (unsigned char)((uint64_t)length >> 32) & 0xFF;
-                        buffer[6] = (unsigned char)((uint64_t)length >> 24) & 0xFF;
-                        buffer[7] = (unsigned char)((uint64_t)length >> 16) & 0xFF;
-                        buffer[8] = (unsigned char)((uint64_t)length >> 8) & 0xFF;
-                        buffer[9] = (unsigned char)(length & 0xFF);
-                    }
-                    else if (length > 125)
+                    /* Codes_SRS_UWS_FRAME_ENCODER_01_055: [ If `gb_rand_bytes` fails then `uws_frame_encoder_encode` shall fail and return NULL. ]*/
+                    BUFFER_delete(result);
+                    result = NULL;
+                }
+                else if (length > 0)
+                {
+                    if (is_masked)
                     {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_019: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
-                        buffer[1] = 126;
-
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_021: [ Multibyte length quantities are expressed in network byte order. ]*/
-                        buffer[2] = (unsigned char)(length >> 8);
-                        buffer[3] = (unsigned char)(length & 0xFF);
+                        /* Codes_SRS_UWS_FRAME_ENCODER_01_035: [ It is used to mask the "Payload data" defined in the same section as frame-payload-data, which includes "Extension data" and "Application data". ]*/
+                        mask_payload(buffer + header_bytes, payload, length, buffer + header_bytes - 4);
                     }
                     else
                     {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_043: [ if 0-125, that is the payload length. ]*/
-                        buffer[1] = (unsigned char)length;
+                        (void)memcpy(buffer + header_bytes, payload, length);
                     }
+                }
+            }
+        }
+    }
 
-                    if (is_masked)
-                    {
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_015: [ Defines whether the "Payload data" is masked. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_033: [ A masked frame MUST have the field frame-masked set to 1, as defined in Section 5.2. ]*/
-                        buffer[1] |= 0x80;
-
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand` shall be used 4 times (for each byte). ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_016: [ If set to 1, a masking key is present in masking-key, and this is used to unmask the "Payload data" as per Section 5.3. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_026: [ This field is present if the mask bit is set to 1 and is absent if the mask bit is set to 0. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_034: [ The masking key is contained completely within the frame, as defined in Section 5.2 as frame-masking-key. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_036: [ The masking key is a 32-bit value chosen at random by the client. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_037: [ When preparing a masked frame, the client MUST pick a fresh masking key from the set of allowed 32-bit values. ]*/
-                        /* Codes_SRS_UWS_FRAME_ENCODER_01_038: [ The masking key needs to be unpredictable; thus, the masking key MUST be derived from a strong source of entropy, and the masking key for a given frame MUST NOT make it simple for a server/proxy to predict the masking key for a subsequent frame. ]*/
-                        buffer[header_bytes - 4] = (unsigned char)gb_rand();
-                        buffer[header_bytes - 3] = (unsigned char)gb_rand();
-                        buffer[header_bytes - 2] = (unsigned char)gb_rand();
-                        buffer[header_bytes - 1] = (unsigned char)gb_rand();
-                    }
+    return result;
+}
 
-                    if (length > 0)
-                    {
-                        if (is_masked)
-                        {
-                            size_t i;
-
-                            /* Codes_SRS_UWS_FRAME_ENCODER_01_035: [ It is used to mask the "Payload data" defined in the same section as frame-payload-data, which includes "Extension data" and "Application data". ]*/
-                            /* Codes_SRS_UWS_FRAME_ENCODER_01_039: [ To convert masked data into unmasked data, or vice versa, the following algorithm is applied. ]*/
-                            /* Codes_SRS_UWS_FRAME_ENCODER_01_040: [ The same algorithm applies regardless of the direction of the translation, e.g., the same steps are applied to mask the data as to unmask the data. ]*/
-                            for (i = 0; i < length; i++)
-                            {
-                                /* Codes_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
-                                buffer[header_bytes + i] = ((unsigned char*)payload)[i] ^ buffer[header_bytes - 4 + (i % 4)];
-                            }
-                        }
-                        else
-                        {
-                            (void)memcpy(buffer + header_bytes, payload, length);
-                        }
-                    }
+int uws_frame_encoder_encode_in_place(WS_FRAME_TYPE opcode, unsigned char* buffer, size_t headroom, size_t length, bool is_masked, bool is_final, unsigned char reserved, size_t* frame_offset)
+{
+    int result;
+
+    if ((buffer == NULL) ||
+        (frame_offset == NULL))
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_056: [ If `buffer` or `frame_offset` is NULL, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: buffer=%p, frame_offset=%p", buffer, frame_offset);
+        result = __FAILURE__;
+    }
+    else if (reserved > 7)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_057: [ If `reserved` has any bits set except the lowest 3 or `opcode` is greater than 0x0F, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+        LogError("Bad reserved value: 0x%02x", reserved);
+        result = __FAILURE__;
+    }
+    else if (opcode > 0x0F)
+    {
+        /* Codes_SRS_UWS_FRAME_ENCODER_01_057: [ If `reserved` has any bits set except the lowest 3 or `opcode` is greater than 0x0F, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+        LogError("Invalid opcode: 0x%02x", opcode);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t header_bytes = get_header_size(length, is_masked);
+
+        if (headroom < header_bytes)
+        {
+            /* Codes_SRS_UWS_FRAME_ENCODER_01_058: [ If `headroom` is smaller than the header needed for the frame, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+            LogError("Headroom of %lu bytes cannot hold a %lu bytes frame header", (unsigned long)headroom, (unsigned long)header_bytes);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_UWS_FRAME_ENCODER_01_059: [ `uws_frame_encoder_encode_in_place` shall write the frame header in the `headroom` bytes immediately before the `length` payload bytes that start at `buffer + headroom`, encoded the same way `uws_frame_encoder_encode` encodes it. ]*/
+            unsigned char* header = buffer + headroom - header_bytes;
+
+            if (write_header(header, header_bytes, opcode, length, is_masked, is_final, reserved) != 0)
+            {
+                /* Codes_SRS_UWS_FRAME_ENCODER_01_060: [ If `gb_rand_bytes` fails then `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+                result = __FAILURE__;
+            }
+            else
+            {
+                if (is_masked)
+                {
+                    /* Codes_SRS_UWS_FRAME_ENCODER_01_061: [ If `is_masked` is true, the payload shall be masked in place. ]*/
+                    mask_payload(buffer + headroom, buffer + headroom, length, buffer + headroom - 4);
                 }
+
+                /* Codes_SRS_UWS_FRAME_ENCODER_01_062: [ On success `uws_frame_encoder_encode_in_place` shall set `frame_offset` to the offset in `buffer` where the encoded frame starts and return 0. ]*/
+                *frame_offset = headroom - header_bytes;
+                result = 0;
             }
         }
     }
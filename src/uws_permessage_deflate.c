@@ -0,0 +1,814 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <ctype.h>
+#include <time.h>
+#ifdef _WIN32
+#include "windows.h"
+#endif
+#include "zlib.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/uws_permessage_deflate.h"
+
+#define PERMESSAGE_DEFLATE_EXTENSION_NAME   "permessage-deflate"
+#define EXTENSIONS_HEADER_NAME              "Sec-WebSocket-Extensions"
+#define MAX_OFFER_LENGTH                    160
+#define MIN_CLIENT_WINDOW_BITS              9
+#define MIN_SERVER_WINDOW_BITS              8
+#define MAX_WINDOW_BITS                     15
+#define MIN_INFLATE_WINDOW_BITS             9
+/* zlib asks for more than 6 bytes of output space on a sync flush so that it does not repeat the flush marker */
+#define MIN_OUTPUT_SPACE                    256
+
+/* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_020: [ Before being sent, the 4 octets 0x00 0x00 0xff 0xff that end the compressed data of every message shall be removed. ]*/
+/* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_025: [ After the last bytes of a message, the 4 octets 0x00 0x00 0xff 0xff shall be appended to the inflater input. ]*/
+static const unsigned char deflate_message_tail[] = { 0x00, 0x00, 0xFF, 0xFF };
+
+typedef struct UWS_PERMESSAGE_DEFLATE_INSTANCE_TAG
+{
+    z_stream deflater;
+    z_stream inflater;
+    bool client_no_context_takeover;
+    bool server_no_context_takeover;
+    unsigned char* compress_buffer;
+    size_t compress_buffer_size;
+    unsigned char* decompress_buffer;
+    size_t decompress_buffer_size;
+    WS_PERMESSAGE_DEFLATE_STATISTICS statistics;
+} UWS_PERMESSAGE_DEFLATE_INSTANCE;
+
+static voidpf zlib_alloc(voidpf opaque, uInt items, uInt size)
+{
+    (void)opaque;
+    return (voidpf)malloc((size_t)items * size);
+}
+
+static void zlib_free(voidpf opaque, voidpf address)
+{
+    (void)opaque;
+    free(address);
+}
+
+static bool is_valid_config(const WS_PERMESSAGE_DEFLATE_CONFIG* config)
+{
+    return (config->client_max_window_bits >= MIN_CLIENT_WINDOW_BITS) &&
+        (config->client_max_window_bits <= MAX_WINDOW_BITS) &&
+        (config->server_max_window_bits >= MIN_SERVER_WINDOW_BITS) &&
+        (config->server_max_window_bits <= MAX_WINDOW_BITS) &&
+        (config->compression_level >= Z_DEFAULT_COMPRESSION) &&
+        (config->compression_level <= Z_BEST_COMPRESSION);
+}
+
+/* CPU time consumed by the calling thread, in microseconds. clock() would charge the time spent by all
+   the other threads of the process to this connection, so the per-thread clock is used where available. */
+static uint64_t get_thread_cpu_time_us(void)
+{
+    uint64_t result;
+#ifdef _WIN32
+    FILETIME creation_time;
+    FILETIME exit_time;
+    FILETIME kernel_time;
+    FILETIME user_time;
+
+    if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+    {
+        result = 0;
+    }
+    else
+    {
+        /* FILETIME counts 100 ns intervals */
+        result = ((((uint64_t)kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime) +
+            (((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime)) / 10;
+    }
+#elif defined CLOCK_THREAD_CPUTIME_ID
+    struct timespec now;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        result = ((uint64_t)now.tv_sec * 1000000) + ((uint64_t)now.tv_nsec / 1000);
+    }
+#else
+    clock_t now = clock();
+    result = (now == (clock_t)-1) ? 0 : ((uint64_t)now * 1000000) / CLOCKS_PER_SEC;
+#endif
+    return result;
+}
+
+static uint64_t get_elapsed_cpu_time_us(uint64_t start)
+{
+    uint64_t end = get_thread_cpu_time_us();
+    return ((start == 0) || (end < start)) ? 0 : end - start;
+}
+
+static int ensure_buffer_size(unsigned char** buffer, size_t* buffer_size, size_t needed_size)
+{
+    int result;
+
+    if (needed_size <= *buffer_size)
+    {
+        result = 0;
+    }
+    else
+    {
+        /* Grow geometrically so that a stream of messages does not realloc every time */
+        size_t new_size = (*buffer_size > SIZE_MAX / 2) ? needed_size : *buffer_size * 2;
+        unsigned char* new_buffer;
+
+        if (new_size < needed_size)
+        {
+            new_size = needed_size;
+        }
+
+        new_buffer = (unsigned char*)realloc(*buffer, new_size);
+        if (new_buffer == NULL)
+        {
+            LogError("Cannot grow buffer to %lu bytes", (unsigned long)new_size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            *buffer = new_buffer;
+            *buffer_size = new_size;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static bool is_equal_case_insensitive(const char* str, size_t length, const char* expected)
+{
+    size_t i;
+    bool result = (strlen(expected) == length);
+
+    for (i = 0; result && (i < length); i++)
+    {
+        result = (tolower((unsigned char)str[i]) == tolower((unsigned char)expected[i]));
+    }
+
+    return result;
+}
+
+static const char* skip_whitespace(const char* pos, const char* end)
+{
+    while ((pos < end) && ((*pos == ' ') || (*pos == '\t')))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+static const char* skip_token(const char* pos, const char* end)
+{
+    while ((pos < end) && (*pos != ' ') && (*pos != '\t') && (*pos != ';') && (*pos != ',') && (*pos != '=') && (*pos != '"'))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+static int parse_window_bits(const char* value, size_t value_length, int* window_bits)
+{
+    int result;
+
+    if ((value_length == 0) || (value_length > 2))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+
+        *window_bits = 0;
+        result = 0;
+        for (i = 0; i < value_length; i++)
+        {
+            if ((value[i] < '0') || (value[i] > '9'))
+            {
+                result = __FAILURE__;
+                break;
+            }
+
+            *window_bits = (*window_bits * 10) + (value[i] - '0');
+        }
+    }
+
+    return result;
+}
+
+static int parse_extension_parameter(const char* name, size_t name_length, const char* value, size_t value_length, bool has_value, const WS_PERMESSAGE_DEFLATE_CONFIG* offer, WS_PERMESSAGE_DEFLATE_CONFIG* negotiated, unsigned int* seen_parameters)
+{
+    int result;
+    int window_bits;
+
+    if (is_equal_case_insensitive(name, name_length, "server_no_context_takeover") &&
+        !has_value &&
+        ((*seen_parameters & 0x01) == 0))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_010: [ A `server_no_context_takeover` parameter shall make the inflater be reset after every message. ]*/
+        *seen_parameters |= 0x01;
+        negotiated->server_no_context_takeover = true;
+        result = 0;
+    }
+    else if (is_equal_case_insensitive(name, name_length, "client_no_context_takeover") &&
+        !has_value &&
+        ((*seen_parameters & 0x02) == 0))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_011: [ A `client_no_context_takeover` parameter shall make the deflater be reset after every message. ]*/
+        *seen_parameters |= 0x02;
+        negotiated->client_no_context_takeover = true;
+        result = 0;
+    }
+    else if (is_equal_case_insensitive(name, name_length, "server_max_window_bits") &&
+        has_value &&
+        ((*seen_parameters & 0x04) == 0) &&
+        (parse_window_bits(value, value_length, &window_bits) == 0) &&
+        (window_bits >= MIN_SERVER_WINDOW_BITS) &&
+        (window_bits <= offer->server_max_window_bits))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_012: [ A `server_max_window_bits` parameter with a value from 8 to the offered value shall set the window of the inflater. ]*/
+        *seen_parameters |= 0x04;
+        negotiated->server_max_window_bits = window_bits;
+        result = 0;
+    }
+    else if (is_equal_case_insensitive(name, name_length, "client_max_window_bits") &&
+        has_value &&
+        ((*seen_parameters & 0x08) == 0) &&
+        (parse_window_bits(value, value_length, &window_bits) == 0) &&
+        (window_bits >= MIN_CLIENT_WINDOW_BITS) &&
+        (window_bits <= MAX_WINDOW_BITS))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_013: [ A `client_max_window_bits` parameter with a value from 9 to 15 shall limit the window of the deflater to the smaller of that value and the offered one. ]*/
+        *seen_parameters |= 0x08;
+        if (window_bits < negotiated->client_max_window_bits)
+        {
+            negotiated->client_max_window_bits = window_bits;
+        }
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_014: [ If a parameter is unknown, repeated, has a missing, unexpected or out of range value, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+        LogError("Bad permessage-deflate parameter in the upgrade response: %.*s", (int)name_length, name);
+        result = __FAILURE__;
+    }
+
+    return result;
+}
+
+static int parse_extensions(const char* pos, const char* end, const WS_PERMESSAGE_DEFLATE_CONFIG* offer, WS_PERMESSAGE_DEFLATE_CONFIG* negotiated, bool* is_accepted)
+{
+    int result = 0;
+
+    while (result == 0)
+    {
+        const char* extension_name;
+
+        pos = skip_whitespace(pos, end);
+        if (pos == end)
+        {
+            break;
+        }
+        else if (*pos == ',')
+        {
+            pos++;
+            continue;
+        }
+
+        extension_name = pos;
+        pos = skip_token(pos, end);
+
+        if (!is_equal_case_insensitive(extension_name, (size_t)(pos - extension_name), PERMESSAGE_DEFLATE_EXTENSION_NAME))
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_008: [ If the response accepts any extension other than `permessage-deflate`, or accepts `permessage-deflate` more than once, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+            LogError("Upgrade response accepted an extension that was not offered: %.*s", (int)(pos - extension_name), extension_name);
+            result = __FAILURE__;
+        }
+        else if (*is_accepted)
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_008: [ If the response accepts any extension other than `permessage-deflate`, or accepts `permessage-deflate` more than once, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+            LogError("Upgrade response accepted permessage-deflate more than once");
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned int seen_parameters = 0;
+
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_009: [ When the response accepts `permessage-deflate`, `is_accepted` shall be set to true and `negotiated` shall start from the offer, with a `server_max_window_bits` of 15 and `server_no_context_takeover` false, and be adjusted by the parameters of the response. ]*/
+            *is_accepted = true;
+            *negotiated = *offer;
+            negotiated->server_max_window_bits = MAX_WINDOW_BITS;
+            negotiated->server_no_context_takeover = false;
+
+            pos = skip_whitespace(pos, end);
+            while ((result == 0) &&
+                (pos < end) &&
+                (*pos == ';'))
+            {
+                const char* name;
+                size_t name_length;
+                const char* value = NULL;
+                size_t value_length = 0;
+                bool has_value = false;
+
+                pos = skip_whitespace(pos + 1, end);
+                name = pos;
+                pos = skip_token(pos, end);
+                name_length = (size_t)(pos - name);
+                pos = skip_whitespace(pos, end);
+
+                if ((pos < end) && (*pos == '='))
+                {
+                    has_value = true;
+                    pos = skip_whitespace(pos + 1, end);
+                    if ((pos < end) && (*pos == '"'))
+                    {
+                        value = ++pos;
+                        while ((pos < end) && (*pos != '"'))
+                        {
+                            pos++;
+                        }
+                        value_length = (size_t)(pos - value);
+                        if (pos < end)
+                        {
+                            pos++;
+                        }
+                        else
+                        {
+                            value_length = 0;
+                        }
+                    }
+                    else
+                    {
+                        value = pos;
+                        pos = skip_token(pos, end);
+                        value_length = (size_t)(pos - value);
+                    }
+                    pos = skip_whitespace(pos, end);
+                }
+
+                result = parse_extension_parameter(name, name_length, value, value_length, has_value, offer, negotiated, &seen_parameters);
+            }
+
+            if ((result == 0) &&
+                (pos < end) &&
+                (*pos != ','))
+            {
+                /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_015: [ If the `Sec-WebSocket-Extensions` header value cannot be parsed, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+                LogError("Cannot parse the Sec-WebSocket-Extensions header of the upgrade response");
+                result = __FAILURE__;
+            }
+        }
+    }
+
+    return result;
+}
+
+char* uws_permessage_deflate_create_offer(const WS_PERMESSAGE_DEFLATE_CONFIG* config)
+{
+    char* result;
+
+    if (config == NULL)
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_001: [ If `config` is NULL, `uws_permessage_deflate_create_offer` shall fail and return NULL. ]*/
+        LogError("NULL config");
+        result = NULL;
+    }
+    else if (!is_valid_config(config))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_002: [ If `client_max_window_bits` is not within 9..15, `server_max_window_bits` is not within 8..15 or `compression_level` is not within -1..9, `uws_permessage_deflate_create_offer` shall fail and return NULL. ]*/
+        LogError("Invalid permessage-deflate configuration: client_max_window_bits=%d, server_max_window_bits=%d, compression_level=%d",
+            config->client_max_window_bits, config->server_max_window_bits, config->compression_level);
+        result = NULL;
+    }
+    else if ((result = (char*)malloc(MAX_OFFER_LENGTH)) == NULL)
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_003: [ If allocating memory for the offer fails, `uws_permessage_deflate_create_offer` shall fail and return NULL. ]*/
+        LogError("Cannot allocate memory for the permessage-deflate offer");
+    }
+    else
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_004: [ `uws_permessage_deflate_create_offer` shall return a newly allocated `Sec-WebSocket-Extensions` header value offering `permessage-deflate` with the `client_max_window_bits` parameter, whose value is only given when it is below 15. ]*/
+        int length = sprintf(result, PERMESSAGE_DEFLATE_EXTENSION_NAME "; client_max_window_bits");
+
+        if (config->client_max_window_bits < MAX_WINDOW_BITS)
+        {
+            length += sprintf(result + length, "=%d", config->client_max_window_bits);
+        }
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_005: [ The `server_max_window_bits` parameter shall be added when `server_max_window_bits` is below 15. ]*/
+        if (config->server_max_window_bits < MAX_WINDOW_BITS)
+        {
+            length += sprintf(result + length, "; server_max_window_bits=%d", config->server_max_window_bits);
+        }
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_006: [ The `client_no_context_takeover` and `server_no_context_takeover` parameters shall be added when the corresponding config members are true. ]*/
+        if (config->client_no_context_takeover)
+        {
+            length += sprintf(result + length, "; client_no_context_takeover");
+        }
+
+        if (config->server_no_context_takeover)
+        {
+            (void)sprintf(result + length, "; server_no_context_takeover");
+        }
+    }
+
+    return result;
+}
+
+int uws_permessage_deflate_negotiate(const WS_PERMESSAGE_DEFLATE_CONFIG* offer, const char* upgrade_response, WS_PERMESSAGE_DEFLATE_CONFIG* negotiated, bool* is_accepted)
+{
+    int result;
+
+    if ((offer == NULL) ||
+        (upgrade_response == NULL) ||
+        (negotiated == NULL) ||
+        (is_accepted == NULL))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_007: [ If any argument is NULL, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: offer=%p, upgrade_response=%p, negotiated=%p, is_accepted=%p", offer, upgrade_response, negotiated, is_accepted);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Skip the status line, the headers end with an empty line */
+        const char* line = strstr(upgrade_response, "\r\n");
+
+        *is_accepted = false;
+        result = 0;
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_016: [ `uws_permessage_deflate_negotiate` shall look at every `Sec-WebSocket-Extensions` header of `upgrade_response`, matching the header name case insensitively. ]*/
+        while ((result == 0) &&
+            (line != NULL) &&
+            (strncmp(line, "\r\n\r\n", 4) != 0))
+        {
+            const char* line_end;
+            const char* colon;
+
+            line += 2;
+            line_end = strstr(line, "\r\n");
+            if (line_end == NULL)
+            {
+                line_end = line + strlen(line);
+            }
+
+            colon = (const char*)memchr(line, ':', (size_t)(line_end - line));
+            if ((colon != NULL) &&
+                is_equal_case_insensitive(line, (size_t)(colon - line), EXTENSIONS_HEADER_NAME))
+            {
+                result = parse_extensions(colon + 1, line_end, offer, negotiated, is_accepted);
+            }
+
+            line = (*line_end == '\0') ? NULL : line_end;
+        }
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_017: [ If the response does not accept `permessage-deflate`, `is_accepted` shall be set to false and `uws_permessage_deflate_negotiate` shall return 0. ]*/
+    }
+
+    return result;
+}
+
+UWS_PERMESSAGE_DEFLATE_HANDLE uws_permessage_deflate_create(const WS_PERMESSAGE_DEFLATE_CONFIG* negotiated)
+{
+    UWS_PERMESSAGE_DEFLATE_INSTANCE* result;
+
+    if (negotiated == NULL)
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_030: [ If `negotiated` is NULL or holds values out of the ranges accepted by `uws_permessage_deflate_create_offer`, `uws_permessage_deflate_create` shall fail and return NULL. ]*/
+        LogError("NULL negotiated parameters");
+        result = NULL;
+    }
+    else if (!is_valid_config(negotiated))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_030: [ If `negotiated` is NULL or holds values out of the ranges accepted by `uws_permessage_deflate_create_offer`, `uws_permessage_deflate_create` shall fail and return NULL. ]*/
+        LogError("Invalid negotiated permessage-deflate parameters");
+        result = NULL;
+    }
+    else if ((result = (UWS_PERMESSAGE_DEFLATE_INSTANCE*)malloc(sizeof(UWS_PERMESSAGE_DEFLATE_INSTANCE))) == NULL)
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_031: [ If allocating memory fails, `uws_permessage_deflate_create` shall fail and return NULL. ]*/
+        LogError("Cannot allocate memory for the permessage-deflate instance");
+    }
+    else
+    {
+        (void)memset(result, 0, sizeof(UWS_PERMESSAGE_DEFLATE_INSTANCE));
+        result->deflater.zalloc = zlib_alloc;
+        result->deflater.zfree = zlib_free;
+        result->inflater.zalloc = zlib_alloc;
+        result->inflater.zfree = zlib_free;
+        result->client_no_context_takeover = negotiated->client_no_context_takeover;
+        result->server_no_context_takeover = negotiated->server_no_context_takeover;
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_032: [ `uws_permessage_deflate_create` shall create a raw deflate stream with the negotiated `compression_level` and `client_max_window_bits` by calling `deflateInit2`. ]*/
+        if (deflateInit2(&result->deflater, negotiated->compression_level, Z_DEFLATED, -negotiated->client_max_window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_034: [ If `deflateInit2` or `inflateInit2` fails, `uws_permessage_deflate_create` shall fail and return NULL. ]*/
+            LogError("deflateInit2 failed");
+            free(result);
+            result = NULL;
+        }
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_033: [ `uws_permessage_deflate_create` shall create a raw inflate stream with the negotiated `server_max_window_bits`, but never below 9, by calling `inflateInit2`. ]*/
+        /* zlib based servers deflate with a 9 bit window when asked for 8, a smaller inflate window would reject their back-references */
+        else if (inflateInit2(&result->inflater, -((negotiated->server_max_window_bits < MIN_INFLATE_WINDOW_BITS) ? MIN_INFLATE_WINDOW_BITS : negotiated->server_max_window_bits)) != Z_OK)
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_034: [ If `deflateInit2` or `inflateInit2` fails, `uws_permessage_deflate_create` shall fail and return NULL. ]*/
+            LogError("inflateInit2 failed");
+            (void)deflateEnd(&result->deflater);
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+void uws_permessage_deflate_destroy(UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate)
+{
+    if (permessage_deflate == NULL)
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_035: [ If `permessage_deflate` is NULL, `uws_permessage_deflate_destroy` shall do nothing. ]*/
+        LogError("NULL permessage_deflate");
+    }
+    else
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_036: [ `uws_permessage_deflate_destroy` shall end both zlib streams and free all the memory of the instance. ]*/
+        (void)deflateEnd(&permessage_deflate->deflater);
+        (void)inflateEnd(&permessage_deflate->inflater);
+        free(permessage_deflate->compress_buffer);
+        free(permessage_deflate->decompress_buffer);
+        free(permessage_deflate);
+    }
+}
+
+int uws_permessage_deflate_compress(UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate, const unsigned char* payload, size_t length, size_t headroom, unsigned char** compressed, size_t* compressed_length)
+{
+    int result;
+
+    if ((permessage_deflate == NULL) ||
+        ((payload == NULL) && (length > 0)) ||
+        (compressed == NULL) ||
+        (compressed_length == NULL))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_018: [ If `permessage_deflate`, `compressed` or `compressed_length` is NULL, or `payload` is NULL while `length` is not 0, `uws_permessage_deflate_compress` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: permessage_deflate=%p, payload=%p, length=%lu, compressed=%p, compressed_length=%p", permessage_deflate, payload, (unsigned long)length, compressed, compressed_length);
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint64_t start = get_thread_cpu_time_us();
+        size_t output_length = headroom;
+        size_t remaining = length;
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_019: [ `uws_permessage_deflate_compress` shall compress `payload` with `deflate` and `Z_SYNC_FLUSH` into a buffer owned by the instance that is reused by the following calls, leaving `headroom` bytes in front of the compressed bytes. ]*/
+        result = ensure_buffer_size(&permessage_deflate->compress_buffer, &permessage_deflate->compress_buffer_size, headroom + (size_t)deflateBound(&permessage_deflate->deflater, (uLong)length) + MIN_OUTPUT_SPACE);
+        permessage_deflate->deflater.next_in = (Bytef*)payload;
+
+        while (result == 0)
+        {
+            uInt input_chunk = (remaining > UINT_MAX) ? UINT_MAX : (uInt)remaining;
+            size_t output_space;
+            int zlib_result;
+
+            if ((permessage_deflate->compress_buffer_size - output_length < MIN_OUTPUT_SPACE) &&
+                (ensure_buffer_size(&permessage_deflate->compress_buffer, &permessage_deflate->compress_buffer_size, output_length + MIN_OUTPUT_SPACE) != 0))
+            {
+                result = __FAILURE__;
+                break;
+            }
+
+            output_space = permessage_deflate->compress_buffer_size - output_length;
+            permessage_deflate->deflater.avail_in = input_chunk;
+            permessage_deflate->deflater.next_out = permessage_deflate->compress_buffer + output_length;
+            permessage_deflate->deflater.avail_out = (output_space > UINT_MAX) ? UINT_MAX : (uInt)output_space;
+
+            zlib_result = deflate(&permessage_deflate->deflater, (input_chunk == remaining) ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+
+            remaining -= input_chunk - permessage_deflate->deflater.avail_in;
+            output_length = (size_t)(permessage_deflate->deflater.next_out - permessage_deflate->compress_buffer);
+
+            if ((zlib_result != Z_OK) &&
+                (zlib_result != Z_BUF_ERROR))
+            {
+                LogError("deflate failed with %d", zlib_result);
+                result = __FAILURE__;
+            }
+            else if ((remaining == 0) &&
+                (permessage_deflate->deflater.avail_out != 0))
+            {
+                break;
+            }
+        }
+
+        if (result != 0)
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_022: [ If compressing fails, `uws_permessage_deflate_compress` shall reset the deflater, fail and return a non-zero value. ]*/
+            (void)deflateReset(&permessage_deflate->deflater);
+        }
+        else
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_020: [ Before being sent, the 4 octets 0x00 0x00 0xff 0xff that end the compressed data of every message shall be removed. ]*/
+            if ((output_length - headroom >= sizeof(deflate_message_tail)) &&
+                (memcmp(permessage_deflate->compress_buffer + output_length - sizeof(deflate_message_tail), deflate_message_tail, sizeof(deflate_message_tail)) == 0))
+            {
+                output_length -= sizeof(deflate_message_tail);
+            }
+
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_040: [ If nothing is left after removing the tail, a single 0x00 octet shall be sent so that the message is an empty stored block. ]*/
+            if (output_length == headroom)
+            {
+                permessage_deflate->compress_buffer[output_length++] = 0x00;
+            }
+
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_021: [ If `client_no_context_takeover` was negotiated, the deflater shall be reset after each message. ]*/
+            if (permessage_deflate->client_no_context_takeover)
+            {
+                (void)deflateReset(&permessage_deflate->deflater);
+            }
+
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_023: [ On success `uws_permessage_deflate_compress` shall set `compressed` and `compressed_length` to the compressed bytes, update the compression statistics and return 0. ]*/
+            *compressed = permessage_deflate->compress_buffer + headroom;
+            *compressed_length = output_length - headroom;
+
+            permessage_deflate->statistics.messages_compressed++;
+            permessage_deflate->statistics.bytes_before_compression += length;
+            permessage_deflate->statistics.bytes_after_compression += *compressed_length;
+            permessage_deflate->statistics.compression_cpu_time_us += get_elapsed_cpu_time_us(start);
+        }
+    }
+
+    return result;
+}
+
+static int inflate_bytes(UWS_PERMESSAGE_DEFLATE_INSTANCE* permessage_deflate, const unsigned char* input, size_t length, size_t max_length, size_t* output_length, bool* is_stream_end)
+{
+    int result = 0;
+    size_t remaining = length;
+
+    *is_stream_end = false;
+
+    permessage_deflate->inflater.next_in = (Bytef*)input;
+
+    while ((max_length == 0) || (*output_length <= max_length))
+    {
+        uInt input_chunk = (remaining > UINT_MAX) ? UINT_MAX : (uInt)remaining;
+        size_t output_space = permessage_deflate->decompress_buffer_size - *output_length;
+        int zlib_result;
+
+        if (output_space < MIN_OUTPUT_SPACE)
+        {
+            /* Never grow past one byte above the limit, that byte is enough to tell that the message is too big */
+            size_t needed_size = *output_length + MIN_OUTPUT_SPACE;
+            if ((max_length > 0) &&
+                (needed_size > max_length + 1))
+            {
+                needed_size = max_length + 1;
+            }
+
+            if (ensure_buffer_size(&permessage_deflate->decompress_buffer, &permessage_deflate->decompress_buffer_size, needed_size) != 0)
+            {
+                result = __FAILURE__;
+                break;
+            }
+
+            output_space = permessage_deflate->decompress_buffer_size - *output_length;
+        }
+
+        if ((max_length > 0) &&
+            (output_space > max_length + 1 - *output_length))
+        {
+            output_space = max_length + 1 - *output_length;
+        }
+
+        permessage_deflate->inflater.avail_in = input_chunk;
+        permessage_deflate->inflater.next_out = permessage_deflate->decompress_buffer + *output_length;
+        permessage_deflate->inflater.avail_out = (output_space > UINT_MAX) ? UINT_MAX : (uInt)output_space;
+
+        zlib_result = inflate(&permessage_deflate->inflater, Z_SYNC_FLUSH);
+
+        remaining -= input_chunk - permessage_deflate->inflater.avail_in;
+        *output_length = (size_t)(permessage_deflate->inflater.next_out - permessage_deflate->decompress_buffer);
+
+        if (zlib_result == Z_STREAM_END)
+        {
+            /* The peer ended the DEFLATE stream with a final block, the next message starts a new one */
+            (void)inflateReset(&permessage_deflate->inflater);
+            *is_stream_end = true;
+            break;
+        }
+        else if ((zlib_result != Z_OK) &&
+            (zlib_result != Z_BUF_ERROR))
+        {
+            LogError("inflate failed with %d", zlib_result);
+            result = __FAILURE__;
+            break;
+        }
+        else if ((remaining == 0) &&
+            (permessage_deflate->inflater.avail_out != 0))
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+int uws_permessage_deflate_decompress(UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate, const unsigned char* payload, size_t length, bool is_message_end, size_t max_length, const unsigned char** decompressed, size_t* decompressed_length)
+{
+    int result;
+
+    if ((permessage_deflate == NULL) ||
+        ((payload == NULL) && (length > 0)) ||
+        (decompressed == NULL) ||
+        (decompressed_length == NULL))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_024: [ If `permessage_deflate`, `decompressed` or `decompressed_length` is NULL, or `payload` is NULL while `length` is not 0, `uws_permessage_deflate_decompress` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: permessage_deflate=%p, payload=%p, length=%lu, decompressed=%p, decompressed_length=%p", permessage_deflate, payload, (unsigned long)length, decompressed, decompressed_length);
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint64_t start = get_thread_cpu_time_us();
+        size_t output_length = 0;
+        bool is_stream_end;
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_026: [ `uws_permessage_deflate_decompress` shall inflate `payload` into a buffer owned by the instance that is reused by the following calls, `payload` being the whole message or the next part of it. ]*/
+        result = inflate_bytes(permessage_deflate, payload, length, max_length, &output_length, &is_stream_end);
+
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_025: [ After the last bytes of a message, the 4 octets 0x00 0x00 0xff 0xff shall be appended to the inflater input. ]*/
+        /* A message whose DEFLATE stream ended with a final block needs no tail */
+        if ((result == 0) &&
+            is_message_end &&
+            !is_stream_end &&
+            ((max_length == 0) || (output_length <= max_length)))
+        {
+            result = inflate_bytes(permessage_deflate, deflate_message_tail, sizeof(deflate_message_tail), max_length, &output_length, &is_stream_end);
+        }
+
+        if (result != 0)
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_029: [ If inflating fails, `uws_permessage_deflate_decompress` shall reset the inflater, fail and return a non-zero value. ]*/
+            (void)inflateReset(&permessage_deflate->inflater);
+        }
+        else
+        {
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_027: [ If `max_length` is not 0, inflating shall stop once more than `max_length` bytes were produced, so that a `decompressed_length` greater than `max_length` tells that the message is too big. ]*/
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_028: [ If `server_no_context_takeover` was negotiated, the inflater shall be reset at the end of each message. ]*/
+            if (is_message_end &&
+                permessage_deflate->server_no_context_takeover)
+            {
+                (void)inflateReset(&permessage_deflate->inflater);
+            }
+
+            /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_037: [ On success `uws_permessage_deflate_decompress` shall set `decompressed` and `decompressed_length` to the inflated bytes, update the decompression statistics and return 0. ]*/
+            *decompressed = permessage_deflate->decompress_buffer;
+            *decompressed_length = output_length;
+
+            if (is_message_end)
+            {
+                permessage_deflate->statistics.messages_decompressed++;
+            }
+            permessage_deflate->statistics.bytes_before_decompression += length;
+            permessage_deflate->statistics.bytes_after_decompression += output_length;
+            permessage_deflate->statistics.decompression_cpu_time_us += get_elapsed_cpu_time_us(start);
+        }
+    }
+
+    return result;
+}
+
+int uws_permessage_deflate_get_statistics(UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate, WS_PERMESSAGE_DEFLATE_STATISTICS* statistics)
+{
+    int result;
+
+    if ((permessage_deflate == NULL) ||
+        (statistics == NULL))
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_038: [ If `permessage_deflate` or `statistics` is NULL, `uws_permessage_deflate_get_statistics` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: permessage_deflate=%p, statistics=%p", permessage_deflate, statistics);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_UWS_PERMESSAGE_DEFLATE_01_039: [ Otherwise `uws_permessage_deflate_get_statistics` shall copy the counters of the instance to `statistics` and return 0. ]*/
+        *statistics = permessage_deflate->statistics;
+        result = 0;
+    }
+
+    return result;
+}
@@ -9,6 +9,39 @@
 
 #include "azure_c_shared_utility/vector_types_internal.h"
 
+/*makes room for at least numElements elements. When the storage has to grow it at least doubles, so that a sequence of push_back calls is amortized O(1)*/
+static int VECTOR_grow(VECTOR_HANDLE handle, size_t numElements)
+{
+    int result;
+    if (numElements <= handle->capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newCapacity = handle->capacity * 2;
+        void* temp;
+        if (newCapacity < numElements)
+        {
+            newCapacity = numElements;
+        }
+
+        temp = realloc(handle->storage, handle->elementSize * newCapacity);
+        if (temp == NULL)
+        {
+            LogError("realloc failed.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            handle->storage = temp;
+            handle->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    return result;
+}
+
 VECTOR_HANDLE VECTOR_create(size_t elementSize)
 {
     VECTOR_HANDLE result;
@@ -32,6 +65,7 @@ VECTOR_HANDLE VECTOR_create(size_t elementSize)
             /* Codes_SRS_VECTOR_10_001: [VECTOR_create shall allocate a VECTOR_HANDLE that will contain an empty vector.The size of each element is given with the parameter elementSize.] */
             result->storage = NULL;
             result->count = 0;
+            result->capacity = 0;
             result->elementSize = elementSize;
         }
     }
@@ -74,11 +108,13 @@ VECTOR_HANDLE VECTOR_move(VECTOR_HANDLE handle)
         {
             /* Codes_SRS_VECTOR_10_004: [VECTOR_move shall allocate a VECTOR_HANDLE and move the data to it from the given handle.] */
             result->count = handle->count;
+            result->capacity = handle->capacity;
             result->elementSize = handle->elementSize;
             result->storage = handle->storage;
 
             handle->storage = NULL;
             handle->count = 0;
+            handle->capacity = 0;
         }
     }
     return result;
@@ -102,18 +138,17 @@ int VECTOR_push_back(VECTOR_HANDLE handle, const void* elements, size_t numEleme
         size_t curSize = handle->elementSize * handle->count;
         size_t appendSize = handle->elementSize * numElements;
 
-        void* temp = realloc(handle->storage, curSize + appendSize);
-        if (temp == NULL)
+        if (VECTOR_grow(handle, handle->count + numElements) != 0)
         {
            /* Codes_SRS_VECTOR_10_012: [VECTOR_push_back shall fail and return non-zero if memory allocation fails.] */
-            LogError("realloc failed.");
+            LogError("unable to grow the vector.");
             result = __FAILURE__;
         }
         else
         {
             /* Codes_SRS_VECTOR_10_013: [VECTOR_push_back shall append the given elements and return 0 indicating success.] */
-            (void)memcpy((unsigned char*)temp + curSize, elements, appendSize);
-            handle->storage = temp;
+            /* Codes_SRS_VECTOR_11_001: [ When the capacity is exceeded, the storage shall grow to the larger of twice the capacity and the needed number of elements. ] */
+            (void)memcpy((unsigned char*)handle->storage + curSize, elements, appendSize);
             handle->count += numElements;
             result = 0;
         }
@@ -121,6 +156,30 @@ int VECTOR_push_back(VECTOR_HANDLE handle, const void* elements, size_t numEleme
     return result;
 }
 
+void* VECTOR_emplace_back(VECTOR_HANDLE handle, size_t numElements)
+{
+    void* result;
+    if (handle == NULL || numElements == 0)
+    {
+        /* Codes_SRS_VECTOR_11_002: [ VECTOR_emplace_back shall fail and return NULL if `handle` is NULL or `numElements` is 0. ] */
+        LogError("invalid argument - handle(%p), numElements(%zd).", handle, numElements);
+        result = NULL;
+    }
+    else if (VECTOR_grow(handle, handle->count + numElements) != 0)
+    {
+        /* Codes_SRS_VECTOR_11_003: [ VECTOR_emplace_back shall fail and return NULL if memory allocation fails. ] */
+        LogError("unable to grow the vector.");
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_VECTOR_11_004: [ VECTOR_emplace_back shall append `numElements` uninitialized elements and return a pointer to the first of them. ] */
+        result = (unsigned char*)handle->storage + (handle->elementSize * handle->count);
+        handle->count += numElements;
+    }
+    return result;
+}
+
 /* removal */
 
 void VECTOR_erase(VECTOR_HANDLE handle, void* elements, size_t numElements)
@@ -159,27 +218,9 @@ void VECTOR_erase(VECTOR_HANDLE handle, void* elements, size_t numElements)
                 }
                 else
                 {
-                    /* Codes_SRS_VECTOR_10_014: [VECTOR_erase shall remove the 'numElements' starting at 'elements' and reduce its internal storage.] */
+                    /* Codes_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and keep its internal storage.] */
+                    (void)memmove(elements, src, srcEnd - src);
                     handle->count -= numElements;
-                    if (handle->count == 0)
-                    {
-                        free(handle->storage);
-                        handle->storage = NULL;
-                    }
-                    else
-                    {
-                        void* tmp;
-                        (void)memmove(elements, src, srcEnd - src);
-                        tmp = realloc(handle->storage, (handle->elementSize * handle->count));
-                        if (tmp == NULL)
-                        {
-                            LogInfo("realloc failed. Keeping original internal storage pointer.");
-                        }
-                        else
-                        {
-                            handle->storage = tmp;
-                        }
-                    }
                 }
             }
         }
@@ -199,6 +240,7 @@ void VECTOR_clear(VECTOR_HANDLE handle)
         free(handle->storage);
         handle->storage = NULL;
         handle->count = 0;
+        handle->capacity = 0;
     }
 }
 
@@ -336,3 +378,126 @@ size_t VECTOR_size(VECTOR_HANDLE handle)
     }
     return result;
 }
+
+size_t VECTOR_capacity(VECTOR_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_VECTOR_11_005: [ VECTOR_capacity shall return 0 if the given handle is NULL. ] */
+        LogError("invalid argument handle(NULL).");
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_VECTOR_11_006: [ VECTOR_capacity shall return the number of elements that fit in the internal storage. ] */
+        result = handle->capacity;
+    }
+    return result;
+}
+
+int VECTOR_reserve(VECTOR_HANDLE handle, size_t numElements)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_VECTOR_11_007: [ VECTOR_reserve shall fail and return non-zero if `handle` is NULL. ] */
+        LogError("invalid argument handle(NULL).");
+        result = __FAILURE__;
+    }
+    else if (numElements <= handle->capacity)
+    {
+        /* Codes_SRS_VECTOR_11_008: [ If `numElements` is not greater than the capacity, VECTOR_reserve shall return 0 without changing the storage. ] */
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_VECTOR_11_009: [ Otherwise VECTOR_reserve shall reallocate the storage to hold exactly `numElements` elements and return 0. ] */
+        void* temp = realloc(handle->storage, handle->elementSize * numElements);
+        if (temp == NULL)
+        {
+            /* Codes_SRS_VECTOR_11_010: [ VECTOR_reserve shall fail and return non-zero if memory allocation fails. ] */
+            LogError("realloc failed.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            handle->storage = temp;
+            handle->capacity = numElements;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int VECTOR_shrink_to_fit(VECTOR_HANDLE handle)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_VECTOR_11_011: [ VECTOR_shrink_to_fit shall fail and return non-zero if `handle` is NULL. ] */
+        LogError("invalid argument handle(NULL).");
+        result = __FAILURE__;
+    }
+    else if (handle->count == handle->capacity)
+    {
+        result = 0;
+    }
+    else if (handle->count == 0)
+    {
+        /* Codes_SRS_VECTOR_11_012: [ If the vector is empty, VECTOR_shrink_to_fit shall release the internal storage. ] */
+        free(handle->storage);
+        handle->storage = NULL;
+        handle->capacity = 0;
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_VECTOR_11_013: [ Otherwise VECTOR_shrink_to_fit shall reallocate the storage to hold exactly the stored elements and return 0. ] */
+        void* temp = realloc(handle->storage, handle->elementSize * handle->count);
+        if (temp == NULL)
+        {
+            /* Codes_SRS_VECTOR_11_014: [ If memory allocation fails, VECTOR_shrink_to_fit shall keep the original storage and return non-zero. ] */
+            LogError("realloc failed. Keeping original internal storage pointer.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            handle->storage = temp;
+            handle->capacity = handle->count;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int VECTOR_resize(VECTOR_HANDLE handle, size_t numElements)
+{
+    int result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_VECTOR_11_015: [ VECTOR_resize shall fail and return non-zero if `handle` is NULL. ] */
+        LogError("invalid argument handle(NULL).");
+        result = __FAILURE__;
+    }
+    else if (numElements <= handle->count)
+    {
+        /* Codes_SRS_VECTOR_11_016: [ If `numElements` is not greater than the size, VECTOR_resize shall drop the elements past `numElements` and keep the internal storage. ] */
+        handle->count = numElements;
+        result = 0;
+    }
+    else if (VECTOR_grow(handle, numElements) != 0)
+    {
+        /* Codes_SRS_VECTOR_11_017: [ VECTOR_resize shall fail and return non-zero if memory allocation fails. ] */
+        LogError("unable to grow the vector.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_VECTOR_11_018: [ Otherwise VECTOR_resize shall append zero filled elements up to `numElements` and return 0. ] */
+        (void)memset((unsigned char*)handle->storage + (handle->elementSize * handle->count), 0, handle->elementSize * (numElements - handle->count));
+        handle->count = numElements;
+        result = 0;
+    }
+    return result;
+}
@@ -33,6 +33,7 @@ typedef struct PENDING_IO_TAG
     ON_SEND_COMPLETE on_send_complete;
     void* callback_context;
     void* wsio;
+    size_t size;
 } PENDING_IO;
 
 typedef struct WSIO_INSTANCE_TAG
@@ -48,6 +49,11 @@ typedef struct WSIO_INSTANCE_TAG
     IO_STATE io_state;
     SINGLYLINKEDLIST_HANDLE pending_io_list;
     UWS_CLIENT_HANDLE uws;
+    /*payload bytes and entries in pending_io_list*/
+    size_t outstanding_bytes;
+    size_t outstanding_items;
+    XIO_SEND_QUEUE_LIMITS send_queue_limits;
+    bool send_blocked;
 } WSIO_INSTANCE;
 
 static void indicate_error(WSIO_INSTANCE* wsio_instance)
@@ -72,6 +78,9 @@ static void complete_send_item(LIST_ITEM_HANDLE pending_io_list_item, IO_SEND_RE
         LogError("Failed removing pending IO from linked list.");
     }
 
+    wsio_instance->outstanding_bytes -= pending_io->size;
+    wsio_instance->outstanding_items--;
+
     /* Codes_SRS_WSIO_01_105: [ The argument `on_send_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
     if (pending_io->on_send_complete != NULL)
     {
@@ -80,6 +89,18 @@ static void complete_send_item(LIST_ITEM_HANDLE pending_io_list_item, IO_SEND_RE
 
     /* Codes_SRS_WSIO_01_144: [ Also the pending IO data shall be freed. ]*/
     free(pending_io);
+
+    /* Codes_SRS_WSIO_11_003: [ If a send was refused since the last time `on_low_water` was called and the outstanding bytes are now at or below `low_water_mark`, `on_low_water` shall be called. ]*/
+    if ((wsio_instance->send_blocked) &&
+        (wsio_instance->io_state == IO_STATE_OPEN) &&
+        (wsio_instance->outstanding_bytes <= wsio_instance->send_queue_limits.low_water_mark))
+    {
+        wsio_instance->send_blocked = false;
+        if (wsio_instance->send_queue_limits.on_low_water != NULL)
+        {
+            wsio_instance->send_queue_limits.on_low_water(wsio_instance->send_queue_limits.on_low_water_context);
+        }
+    }
 }
 
 static void on_underlying_ws_send_frame_complete(void* context, WS_SEND_FRAME_RESULT ws_send_frame_result)
@@ -272,6 +293,10 @@ CONCRETE_IO_HANDLE wsio_create(void* io_create_parameters)
                 else
                 {
                     result->io_state = IO_STATE_NOT_OPEN;
+                    result->outstanding_bytes = 0;
+                    result->outstanding_items = 0;
+                    (void)memset(&result->send_queue_limits, 0, sizeof(result->send_queue_limits));
+                    result->send_blocked = false;
                 }
             }
         }
@@ -593,6 +618,13 @@ int wsio_send(CONCRETE_IO_HANDLE ws_io, const void* buffer, size_t size, ON_SEND
             LogError("Attempting to send when not open");
             result = __FAILURE__;
         }
+        else if ((wsio_instance->send_queue_limits.high_water_mark != 0) &&
+            (wsio_instance->outstanding_bytes >= wsio_instance->send_queue_limits.high_water_mark))
+        {
+            /* Codes_SRS_WSIO_11_002: [ If `high_water_mark` is not 0 and at least `high_water_mark` bytes are outstanding, `wsio_send` shall return `XIO_SEND_WOULD_BLOCK` without queueing anything. ]*/
+            wsio_instance->send_blocked = true;
+            result = XIO_SEND_WOULD_BLOCK;
+        }
         else
         {
             LIST_ITEM_HANDLE new_item;
@@ -608,6 +640,7 @@ int wsio_send(CONCRETE_IO_HANDLE ws_io, const void* buffer, size_t size, ON_SEND
                 pending_socket_io->on_send_complete = on_send_complete;
                 pending_socket_io->callback_context = callback_context;
                 pending_socket_io->wsio = wsio_instance;
+                pending_socket_io->size = size;
 
                 /* Codes_SRS_WSIO_01_102: [ An entry shall be queued in the singly linked list by calling `singlylinkedlist_add`. ]*/
                 if ((new_item = singlylinkedlist_add(wsio_instance->pending_io_list, pending_socket_io)) == NULL)
@@ -621,6 +654,10 @@ int wsio_send(CONCRETE_IO_HANDLE ws_io, const void* buffer, size_t size, ON_SEND
                     /* Codes_SRS_WSIO_01_095: [ `wsio_send` shall call `uws_client_send_frame_async`, passing the `buffer` and `size` arguments as they are: ]*/
                     /* Codes_SRS_WSIO_01_097: [ The `is_final` argument shall be set to true. ]*/
                     /* Codes_SRS_WSIO_01_096: [ The frame type used shall be `WS_FRAME_TYPE_BINARY`. ]*/
+                    /* counted first, the frame may complete before uws_client_send_frame_async returns */
+                    wsio_instance->outstanding_bytes += size;
+                    wsio_instance->outstanding_items++;
+
                     if (uws_client_send_frame_async(wsio_instance->uws, WS_FRAME_TYPE_BINARY, (const unsigned char*)buffer, size, true, on_underlying_ws_send_frame_complete, new_item) != 0)
                     {
                         if (singlylinkedlist_remove(wsio_instance->pending_io_list, new_item) != 0)
@@ -628,6 +665,8 @@ int wsio_send(CONCRETE_IO_HANDLE ws_io, const void* buffer, size_t size, ON_SEND
                             LogError("Failed removing pending IO from linked list.");
                         }
 
+                        wsio_instance->outstanding_bytes -= size;
+                        wsio_instance->outstanding_items--;
                         free(pending_socket_io);
                         result = __FAILURE__;
                     }
@@ -681,7 +720,27 @@ int wsio_setoption(CONCRETE_IO_HANDLE ws_io, const char* optionName, const void*
     {
         WSIO_INSTANCE* wsio_instance = (WSIO_INSTANCE*)ws_io;
 
-        if (strcmp(WSIO_OPTIONS, optionName) == 0)
+        if (strcmp(OPTION_XIO_SEND_QUEUE_LIMITS, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL value for %s", optionName);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* Codes_SRS_WSIO_11_001: [ If the option name is `xio_send_queue_limits`, `wsio_setoption` shall keep a copy of the `XIO_SEND_QUEUE_LIMITS` pointed to by `value` and not pass it to uws. ]*/
+                wsio_instance->send_queue_limits = *(const XIO_SEND_QUEUE_LIMITS*)value;
+                if (wsio_instance->send_queue_limits.high_water_mark == 0)
+                {
+                    wsio_instance->send_blocked = false;
+                }
+
+                /* Codes_SRS_WSIO_01_158: [ On success, `wsio_setoption` shall return 0. ]*/
+                result = 0;
+            }
+        }
+        else if (strcmp(WSIO_OPTIONS, optionName) == 0)
         {
             /* Codes_SRS_WSIO_01_183: [ If the option name is `WSIOOptions` then `wsio_setoption` shall call `OptionHandler_FeedOptions` and pass to it the underlying IO handle and the `value` argument. ]*/
             if (OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)value, wsio_instance->uws) != OPTIONHANDLER_OK)
@@ -716,6 +775,46 @@ int wsio_setoption(CONCRETE_IO_HANDLE ws_io, const char* optionName, const void*
     return result;
 }
 
+int wsio_getoption(CONCRETE_IO_HANDLE ws_io, const char* optionName, void* value)
+{
+    int result;
+
+    if ((ws_io == NULL) ||
+        (optionName == NULL) ||
+        (value == NULL))
+    {
+        /* Codes_SRS_WSIO_11_004: [ If any of the arguments `ws_io`, `option_name` or `value` is NULL `wsio_getoption` shall return a non-zero value. ]*/
+        LogError("Bad parameters: ws_io=%p, optionName=%p, value=%p",
+            ws_io, optionName, value);
+        result = __FAILURE__;
+    }
+    else
+    {
+        WSIO_INSTANCE* wsio_instance = (WSIO_INSTANCE*)ws_io;
+
+        if (strcmp(OPTION_XIO_OUTSTANDING_BYTES, optionName) == 0)
+        {
+            /* Codes_SRS_WSIO_11_005: [ For `xio_outstanding_bytes` `wsio_getoption` shall store in the size_t pointed to by `value` the payload bytes of the sends that have not completed yet and return 0. ]*/
+            *(size_t*)value = wsio_instance->outstanding_bytes;
+            result = 0;
+        }
+        else if (strcmp(OPTION_XIO_OUTSTANDING_ITEMS, optionName) == 0)
+        {
+            /* Codes_SRS_WSIO_11_006: [ For `xio_outstanding_items` `wsio_getoption` shall store in the size_t pointed to by `value` the number of sends that have not completed yet and return 0. ]*/
+            *(size_t*)value = wsio_instance->outstanding_items;
+            result = 0;
+        }
+        else
+        {
+            /* Codes_SRS_WSIO_11_007: [ For any other option `wsio_getoption` shall return a non-zero value. ]*/
+            LogError("Option %s cannot be queried", optionName);
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
 static void* wsio_clone_option(const char* name, const void* value)
 {
     void *result;
@@ -831,7 +930,9 @@ static const IO_INTERFACE_DESCRIPTION ws_io_interface_description =
     wsio_close,
     wsio_send,
     wsio_dowork,
-    wsio_setoption
+    wsio_setoption,
+    NULL,
+    wsio_getoption
 };
 
 const IO_INTERFACE_DESCRIPTION* wsio_get_interface_description(void)
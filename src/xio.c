@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xio.h"
@@ -22,6 +23,8 @@ XIO_HANDLE xio_create(const IO_INTERFACE_DESCRIPTION* io_interface_description,
     /* Codes_SRS_XIO_01_003: [If the argument io_interface_description is NULL, xio_create shall return NULL.] */
     if ((io_interface_description == NULL) ||
         /* Codes_SRS_XIO_01_004: [If any io_interface_description member is NULL, xio_create shall return NULL.] */
+        /* Codes_SRS_XIO_11_001: [ concrete_io_send_vectored is optional and may be NULL. ]*/
+        /* Codes_SRS_XIO_11_007: [ concrete_io_getoption is optional and may be NULL. ]*/
         (io_interface_description->concrete_io_retrieveoptions == NULL) ||
         (io_interface_description->concrete_io_create == NULL) ||
         (io_interface_description->concrete_io_destroy == NULL) ||
@@ -154,6 +157,71 @@ int xio_send(XIO_HANDLE xio, const void* buffer, size_t size, ON_SEND_COMPLETE o
     return result;
 }
 
+int xio_send_vectored(XIO_HANDLE xio, const XIO_IOVEC* iov, size_t iov_count, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    int result;
+
+    if ((xio == NULL) ||
+        (iov == NULL) ||
+        (iov_count == 0))
+    {
+        /* Codes_SRS_XIO_11_002: [ If xio or iov is NULL or iov_count is 0, xio_send_vectored shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: XIO_HANDLE xio=%p, const XIO_IOVEC* iov=%p, size_t iov_count=%lu", xio, iov, (unsigned long)iov_count);
+        result = __FAILURE__;
+    }
+    else
+    {
+        XIO_INSTANCE* xio_instance = (XIO_INSTANCE*)xio;
+
+        if (xio_instance->io_interface_description->concrete_io_send_vectored != NULL)
+        {
+            /* Codes_SRS_XIO_11_003: [ If the concrete IO implements concrete_io_send_vectored, xio_send_vectored shall pass all its arguments to it and return its result. ]*/
+            result = xio_instance->io_interface_description->concrete_io_send_vectored(xio_instance->concrete_xio_handle, iov, iov_count, on_send_complete, callback_context);
+        }
+        else if (iov_count == 1)
+        {
+            /* Codes_SRS_XIO_11_004: [ Otherwise, if iov_count is 1, xio_send_vectored shall pass the piece to concrete_io_send. ]*/
+            result = xio_instance->io_interface_description->concrete_io_send(xio_instance->concrete_xio_handle, iov[0].base, iov[0].length, on_send_complete, callback_context);
+        }
+        else
+        {
+            size_t total_length = 0;
+            size_t i;
+            unsigned char* gathered;
+
+            for (i = 0; i < iov_count; i++)
+            {
+                total_length += iov[i].length;
+            }
+
+            /* Codes_SRS_XIO_11_005: [ Otherwise xio_send_vectored shall copy the pieces in order to one buffer, pass it to concrete_io_send and free it. ]*/
+            if ((gathered = (unsigned char*)malloc(total_length == 0 ? 1 : total_length)) == NULL)
+            {
+                /* Codes_SRS_XIO_11_006: [ If allocating the buffer fails, xio_send_vectored shall fail and return a non-zero value. ]*/
+                LogError("Failed allocating %lu bytes to gather the send buffers", (unsigned long)total_length);
+                result = __FAILURE__;
+            }
+            else
+            {
+                size_t offset = 0;
+                for (i = 0; i < iov_count; i++)
+                {
+                    if (iov[i].length > 0)
+                    {
+                        (void)memcpy(gathered + offset, iov[i].base, iov[i].length);
+                        offset += iov[i].length;
+                    }
+                }
+
+                result = xio_instance->io_interface_description->concrete_io_send(xio_instance->concrete_xio_handle, gathered, total_length, on_send_complete, callback_context);
+                free(gathered);
+            }
+        }
+    }
+
+    return result;
+}
+
 void xio_dowork(XIO_HANDLE xio)
 {
     /* Codes_SRS_XIO_01_018: [When the handle argument is NULL, xio_dowork shall do nothing.] */
@@ -204,6 +272,38 @@ int xio_setoption(XIO_HANDLE xio, const char* optionName, const void* value)
     return result;
 }
 
+int xio_getoption(XIO_HANDLE xio, const char* optionName, void* value)
+{
+    int result;
+
+    if ((xio == NULL) ||
+        (optionName == NULL) ||
+        (value == NULL))
+    {
+        /* Codes_SRS_XIO_11_008: [ If xio, optionName or value is NULL, xio_getoption shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: XIO_HANDLE xio=%p, const char* optionName=%p, void* value=%p", xio, optionName, value);
+        result = __FAILURE__;
+    }
+    else
+    {
+        XIO_INSTANCE* xio_instance = (XIO_INSTANCE*)xio;
+
+        if (xio_instance->io_interface_description->concrete_io_getoption == NULL)
+        {
+            /* Codes_SRS_XIO_11_010: [ If the concrete IO does not implement concrete_io_getoption, xio_getoption shall fail and return a non-zero value. ]*/
+            LogError("Option %s cannot be queried, the concrete IO does not implement getoption", optionName);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_XIO_11_009: [ xio_getoption shall pass optionName and value to concrete_io_getoption and return its result. ]*/
+            result = xio_instance->io_interface_description->concrete_io_getoption(xio_instance->concrete_xio_handle, optionName, value);
+        }
+    }
+
+    return result;
+}
+
 static void* xio_CloneOption(const char* name, const void* value)
 {
     void *result;
@@ -1635,4 +1635,299 @@ BEGIN_TEST_SUITE(Buffer_UnitTests)
         BUFFER_delete(buffer);
     }
 
+    /* Tests_SRS_BUFFER_11_001: [ If the capacity of the buffer is already at least handle->size + size, BUFFER_append_build shall not reallocate the buffer. ] */
+    TEST_FUNCTION(BUFFER_append_build_within_capacity_does_not_reallocate)
+    {
+        //arrange
+        int nResult;
+        BUFFER_HANDLE hBuffer;
+        hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        (void)BUFFER_reserve(hBuffer, TOTAL_ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        //act
+        nResult = BUFFER_append_build(hBuffer, ADDITIONAL_BUFFER, ALLOCATION_SIZE);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, nResult);
+        ASSERT_ARE_EQUAL(size_t, TOTAL_ALLOCATION_SIZE, BUFFER_length(hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hBuffer), TOTAL_BUFFER, TOTAL_ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_001: [ If the capacity of the buffer is already at least handle->size + size, BUFFER_append_build shall not reallocate the buffer. ] */
+    TEST_FUNCTION(BUFFER_append_build_grows_capacity_geometrically)
+    {
+        //arrange
+        int nResult;
+        size_t i;
+        BUFFER_HANDLE hBuffer;
+        hBuffer = BUFFER_create(BUFFER_TEST_VALUE, 1);
+        umock_c_reset_all_calls();
+
+        // 1 -> 2 -> 4 -> 8 -> 16
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 2));
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 4));
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 8));
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 16));
+
+        //act
+        nResult = 0;
+        for (i = 1; i < ALLOCATION_SIZE; i++)
+        {
+            nResult |= BUFFER_append_build(hBuffer, &BUFFER_TEST_VALUE[i], 1);
+        }
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, nResult);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(hBuffer));
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_capacity(hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_002: [ If the capacity of the buffer is already at least the enlarged size, BUFFER_enlarge shall not reallocate the buffer. ] */
+    TEST_FUNCTION(BUFFER_enlarge_within_capacity_does_not_reallocate)
+    {
+        //arrange
+        int nResult;
+        BUFFER_HANDLE hBuffer;
+        hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        (void)BUFFER_enlarge(hBuffer, 1);
+        umock_c_reset_all_calls();
+
+        //act
+        nResult = BUFFER_enlarge(hBuffer, ALLOCATION_SIZE - 1);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, nResult);
+        ASSERT_ARE_EQUAL(size_t, TOTAL_ALLOCATION_SIZE, BUFFER_length(hBuffer));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_003: [ If the capacity of handle1 is already at least the combined size, BUFFER_append shall not reallocate handle1. ] */
+    TEST_FUNCTION(BUFFER_append_within_capacity_does_not_reallocate)
+    {
+        //arrange
+        int nResult;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        BUFFER_HANDLE hAppend = BUFFER_create(ADDITIONAL_BUFFER, ALLOCATION_SIZE);
+        (void)BUFFER_reserve(hBuffer, TOTAL_ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        //act
+        nResult = BUFFER_append(hBuffer, hAppend);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, nResult);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hBuffer), TOTAL_BUFFER, TOTAL_ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hAppend);
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_004: [ If handle is NULL, BUFFER_reserve shall return a non-zero value. ] */
+    TEST_FUNCTION(BUFFER_reserve_handle_NULL_fail)
+    {
+        //arrange
+        int result;
+
+        //act
+        result = BUFFER_reserve(NULL, ALLOCATION_SIZE);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BUFFER_11_006: [ Otherwise BUFFER_reserve shall reallocate the underlying storage to exactly capacity bytes, preserving the content and the size of the buffer. ] */
+    /* Tests_SRS_BUFFER_11_008: [ On success BUFFER_reserve shall return 0. ] */
+    TEST_FUNCTION(BUFFER_reserve_succeed)
+    {
+        //arrange
+        int result;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, TOTAL_ALLOCATION_SIZE));
+
+        //act
+        result = BUFFER_reserve(hBuffer, TOTAL_ALLOCATION_SIZE);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_length(hBuffer));
+        ASSERT_ARE_EQUAL(size_t, TOTAL_ALLOCATION_SIZE, BUFFER_capacity(hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_005: [ If capacity is less than or equal to the current capacity, BUFFER_reserve shall not allocate and shall return 0. ] */
+    TEST_FUNCTION(BUFFER_reserve_smaller_capacity_does_not_allocate)
+    {
+        //arrange
+        int result;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        //act
+        result = BUFFER_reserve(hBuffer, ALLOCATION_SIZE - 1);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_capacity(hBuffer));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_007: [ If reallocating fails, BUFFER_reserve shall return a non-zero value and leave the buffer unchanged. ] */
+    TEST_FUNCTION(BUFFER_reserve_realloc_fails_fail)
+    {
+        //arrange
+        int result;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, TOTAL_ALLOCATION_SIZE)).SetReturn(NULL);
+
+        //act
+        result = BUFFER_reserve(hBuffer, TOTAL_ALLOCATION_SIZE);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_capacity(hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_009: [ If handle is NULL, BUFFER_capacity shall return 0. ] */
+    TEST_FUNCTION(BUFFER_capacity_handle_NULL_returns_0)
+    {
+        //arrange
+
+        //act
+        size_t result = BUFFER_capacity(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(size_t, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BUFFER_11_010: [ Otherwise BUFFER_capacity shall return the number of bytes the buffer can hold without reallocating. ] */
+    TEST_FUNCTION(BUFFER_capacity_succeed)
+    {
+        //arrange
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        //act
+        size_t result = BUFFER_capacity(hBuffer);
+
+        //assert
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_011: [ If handle is NULL, BUFFER_shrink_to_fit shall return a non-zero value. ] */
+    TEST_FUNCTION(BUFFER_shrink_to_fit_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        int result = BUFFER_shrink_to_fit(NULL);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BUFFER_11_012: [ If the buffer holds no content or its capacity already equals its size, BUFFER_shrink_to_fit shall not allocate and shall return 0. ] */
+    TEST_FUNCTION(BUFFER_shrink_to_fit_already_fit_does_not_allocate)
+    {
+        //arrange
+        int result;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        //act
+        result = BUFFER_shrink_to_fit(hBuffer);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_013: [ Otherwise BUFFER_shrink_to_fit shall reallocate the underlying storage to exactly the size of the buffer. ] */
+    /* Tests_SRS_BUFFER_11_015: [ On success BUFFER_shrink_to_fit shall return 0. ] */
+    TEST_FUNCTION(BUFFER_shrink_to_fit_succeed)
+    {
+        //arrange
+        int result;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        (void)BUFFER_reserve(hBuffer, TOTAL_ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, ALLOCATION_SIZE));
+
+        //act
+        result = BUFFER_shrink_to_fit(hBuffer);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, ALLOCATION_SIZE, BUFFER_capacity(hBuffer));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hBuffer), BUFFER_TEST_VALUE, ALLOCATION_SIZE));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
+    /* Tests_SRS_BUFFER_11_014: [ If reallocating fails, BUFFER_shrink_to_fit shall return a non-zero value and leave the buffer unchanged. ] */
+    TEST_FUNCTION(BUFFER_shrink_to_fit_realloc_fails_fail)
+    {
+        //arrange
+        int result;
+        BUFFER_HANDLE hBuffer = BUFFER_create(BUFFER_TEST_VALUE, ALLOCATION_SIZE);
+        (void)BUFFER_reserve(hBuffer, TOTAL_ALLOCATION_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, ALLOCATION_SIZE)).SetReturn(NULL);
+
+        //act
+        result = BUFFER_shrink_to_fit(hBuffer);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, TOTAL_ALLOCATION_SIZE, BUFFER_capacity(hBuffer));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        BUFFER_delete(hBuffer);
+    }
+
 END_TEST_SUITE(Buffer_UnitTests)
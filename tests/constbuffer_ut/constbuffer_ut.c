@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 
@@ -47,6 +49,9 @@ void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/gballoc.h"
 
+MOCK_FUNCTION_WITH_CODE(, void, test_free_func, void*, context)
+MOCK_FUNCTION_END()
+
 #undef ENABLE_MOCKS
 #include "azure_c_shared_utility/constbuffer.h"
 
@@ -608,4 +613,250 @@ BEGIN_TEST_SUITE(constbuffer_unittests)
         ///cleanup
     }
 
+    /*Tests_SRS_CONSTBUFFER_11_001: [ If source is NULL and size is different than 0 then CONSTBUFFER_CreateWithMoveMemory shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithMoveMemory_with_NULL_source_and_non_zero_size_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+
+        ///act
+        handle = CONSTBUFFER_CreateWithMoveMemory(NULL, 1);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_002: [ CONSTBUFFER_CreateWithMoveMemory shall store source and size and return a non-NULL handle with its ref count set to 1, without copying the memory. ]*/
+    /*Tests_SRS_CONSTBUFFER_11_003: [ On success, source becomes owned by the const buffer and shall be freed with free when the ref count reaches 0. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithMoveMemory_succeeds)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+        const CONSTBUFFER* content;
+        unsigned char* source = (unsigned char*)my_gballoc_malloc(2);
+        ASSERT_IS_NOT_NULL(source);
+        source[0] = 0x42;
+        source[1] = 0x43;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        handle = CONSTBUFFER_CreateWithMoveMemory(source, 2);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(handle);
+        content = CONSTBUFFER_GetContent(handle);
+        ASSERT_ARE_EQUAL(void_ptr, source, content->buffer);
+        ASSERT_ARE_EQUAL(size_t, 2, content->size);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(gballoc_free(source));
+        STRICT_EXPECTED_CALL(gballoc_free(handle));
+
+        CONSTBUFFER_Destroy(handle);
+
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_004: [ If any error occurs, CONSTBUFFER_CreateWithMoveMemory shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithMoveMemory_fails_when_malloc_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+        unsigned char source[1] = { 0x42 };
+
+        whenShallmalloc_fail = 1;
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        handle = CONSTBUFFER_CreateWithMoveMemory(source, sizeof(source));
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_006: [ If customFreeFunc is NULL, CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_with_NULL_customFreeFunc_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+
+        ///act
+        handle = CONSTBUFFER_CreateWithCustomFree(BUFFER1_u_char, BUFFER1_length, NULL, (void*)0x4242);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_005: [ If source is NULL and size is different than 0 then CONSTBUFFER_CreateWithCustomFree shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_with_NULL_source_and_non_zero_size_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+
+        ///act
+        handle = CONSTBUFFER_CreateWithCustomFree(NULL, 1, test_free_func, (void*)0x4242);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_007: [ CONSTBUFFER_CreateWithCustomFree shall store source, size, customFreeFunc and customFreeFuncContext and return a non-NULL handle with its ref count set to 1, without copying the memory. ]*/
+    /*Tests_SRS_CONSTBUFFER_11_008: [ When the ref count reaches 0, customFreeFunc shall be called with customFreeFuncContext instead of freeing source. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateWithCustomFree_succeeds_and_calls_the_custom_free_on_destroy)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+        const CONSTBUFFER* content;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        handle = CONSTBUFFER_CreateWithCustomFree(BUFFER1_u_char, BUFFER1_length, test_free_func, (void*)0x4242);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(handle);
+        content = CONSTBUFFER_GetContent(handle);
+        ASSERT_ARE_EQUAL(void_ptr, BUFFER1_u_char, content->buffer);
+        ASSERT_ARE_EQUAL(size_t, BUFFER1_length, content->size);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(test_free_func((void*)0x4242));
+        STRICT_EXPECTED_CALL(gballoc_free(handle));
+
+        CONSTBUFFER_Destroy(handle);
+
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_010: [ If handle is NULL then CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateFromOffsetAndSize_with_NULL_handle_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE handle;
+
+        ///act
+        handle = CONSTBUFFER_CreateFromOffsetAndSize(NULL, 0, 1);
+
+        ///assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_011: [ If offset is greater than the size of handle then CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    /*Tests_SRS_CONSTBUFFER_11_012: [ If offset + size exceeds the size of handle (or overflows) then CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateFromOffsetAndSize_with_out_of_range_arguments_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE source = CONSTBUFFER_Create(BUFFER1_u_char, BUFFER1_length);
+        umock_c_reset_all_calls();
+
+        ///act
+        ASSERT_IS_NULL(CONSTBUFFER_CreateFromOffsetAndSize(source, BUFFER1_length + 1, 0));
+        ASSERT_IS_NULL(CONSTBUFFER_CreateFromOffsetAndSize(source, 1, BUFFER1_length));
+        ASSERT_IS_NULL(CONSTBUFFER_CreateFromOffsetAndSize(source, 1, (size_t)-1));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CONSTBUFFER_Destroy(source);
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_013: [ If offset is 0 and size is the size of handle then CONSTBUFFER_CreateFromOffsetAndSize shall increment the ref count of handle and return handle. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateFromOffsetAndSize_for_the_whole_buffer_returns_the_same_handle)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE result;
+        CONSTBUFFER_HANDLE source = CONSTBUFFER_Create(BUFFER1_u_char, BUFFER1_length);
+        umock_c_reset_all_calls();
+
+        ///act
+        result = CONSTBUFFER_CreateFromOffsetAndSize(source, 0, BUFFER1_length);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, source, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CONSTBUFFER_Destroy(result);
+        CONSTBUFFER_Destroy(source);
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_014: [ Otherwise CONSTBUFFER_CreateFromOffsetAndSize shall return a non-NULL handle with its ref count set to 1 whose content points at offset inside the storage of handle and has size bytes. ]*/
+    /*Tests_SRS_CONSTBUFFER_11_015: [ CONSTBUFFER_CreateFromOffsetAndSize shall increment the ref count of handle, and the new handle shall release it when its own ref count reaches 0. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateFromOffsetAndSize_shares_the_storage_of_the_original)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE result;
+        const CONSTBUFFER* sourceContent;
+        const CONSTBUFFER* content;
+        CONSTBUFFER_HANDLE source = CONSTBUFFER_Create(BUFFER1_u_char, BUFFER1_length);
+        sourceContent = CONSTBUFFER_GetContent(source);
+        umock_c_reset_all_calls();
+
+        /*only the handle of the slice is allocated, the content is not copied*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        result = CONSTBUFFER_CreateFromOffsetAndSize(source, 3, 6);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(result);
+        content = CONSTBUFFER_GetContent(result);
+        ASSERT_ARE_EQUAL(void_ptr, sourceContent->buffer + 3, content->buffer);
+        ASSERT_ARE_EQUAL(size_t, 6, content->size);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /*the original can go away first, the slice keeps its storage alive*/
+        umock_c_reset_all_calls();
+        CONSTBUFFER_Destroy(source);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(int, 0, memcmp(content->buffer, BUFFER1_u_char + 3, 6));
+
+        /*the content and the handle of the original, then the slice*/
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_free(result));
+
+        ///cleanup
+        CONSTBUFFER_Destroy(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CONSTBUFFER_11_016: [ If any error occurs, CONSTBUFFER_CreateFromOffsetAndSize shall fail and return NULL. ]*/
+    TEST_FUNCTION(CONSTBUFFER_CreateFromOffsetAndSize_fails_when_malloc_fails)
+    {
+        ///arrange
+        CONSTBUFFER_HANDLE result;
+        CONSTBUFFER_HANDLE source = CONSTBUFFER_Create(BUFFER1_u_char, BUFFER1_length);
+        umock_c_reset_all_calls();
+
+        whenShallmalloc_fail = currentmalloc_call + 1;
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        result = CONSTBUFFER_CreateFromOffsetAndSize(source, 1, 1);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CONSTBUFFER_Destroy(source);
+    }
+
 END_TEST_SUITE(constbuffer_unittests)
@@ -0,0 +1,384 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#if defined(GB_MEASURE_MEMORY_FOR_THIS)
+#undef GB_MEASURE_MEMORY_FOR_THIS
+#endif
+
+#ifdef __cplusplus
+#include <cstdlib>
+#else
+#include <stdlib.h>
+#endif
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/lock.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+TEST_DEFINE_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+static const LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4244;
+
+static const char TEST_FILE_1[] = "test_file_1.c";
+static const char TEST_FILE_2[] = "test_file_2.c";
+
+static void* my_mock_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_mock_calloc(size_t nmemb, size_t size)
+{
+    return calloc(nmemb, size);
+}
+
+static void* my_mock_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_mock_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+
+#include "umock_c.h"
+#include "umock_c_prod.h"
+
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, void*, mock_malloc, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_calloc, size_t, nmemb, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_realloc, void*, ptr, size_t, size);
+    MOCKABLE_FUNCTION(, void, mock_free, void*, ptr);
+
+    MOCKABLE_FUNCTION(, LOCK_HANDLE, Lock_Init);
+    MOCKABLE_FUNCTION(, LOCK_RESULT, Lock_Deinit, LOCK_HANDLE, handle);
+    MOCKABLE_FUNCTION(, LOCK_RESULT, Lock, LOCK_HANDLE, handle);
+    MOCKABLE_FUNCTION(, LOCK_RESULT, Unlock, LOCK_HANDLE, handle);
+#ifdef __cplusplus
+}
+#endif
+
+#undef ENABLE_MOCKS
+
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(GBAlloc_Allocation_Sites_UnitTests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    result = umock_c_init(on_umock_c_error);
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mock_malloc, my_mock_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_calloc, my_mock_calloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_realloc, my_mock_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_free, my_mock_free);
+
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    (void)gballoc_init();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    gballoc_deinit();
+
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* gballoc_getTopAllocationSites */
+
+/* Tests_SRS_GBALLOC_11_004: [ When GB_TRACK_ALLOCATION_SITES is defined, every tracked allocation shall be counted for the file and line it was made at, with its size added to the live bytes and to the size histogram of the site. ]*/
+/* Tests_SRS_GBALLOC_11_006: [ gballoc_getTopAllocationSites shall copy to sites the statistics of at most site_count sites, in decreasing order of live bytes for GBALLOC_SITE_ORDER_BY_LIVE_BYTES or of allocations for GBALLOC_SITE_ORDER_BY_ALLOCATIONS, skipping the sites for which that value is 0, and return the number of sites copied. ]*/
+TEST_FUNCTION(gballoc_getTopAllocationSites_by_live_bytes_orders_the_sites_by_their_live_bytes)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[3];
+    size_t result;
+    void* small1 = gballoc_malloc_at(10, TEST_FILE_1, 10);
+    void* small2 = gballoc_malloc_at(10, TEST_FILE_1, 10);
+    void* large = gballoc_calloc_at(10, 10, TEST_FILE_2, 20);
+
+    // act
+    result = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_LIVE_BYTES, sites, 3);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 2, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_FILE_2, sites[0].file);
+    ASSERT_ARE_EQUAL(int, 20, sites[0].line);
+    ASSERT_ARE_EQUAL(size_t, 100, sites[0].live_bytes);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[0].live_blocks);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_FILE_1, sites[1].file);
+    ASSERT_ARE_EQUAL(int, 10, sites[1].line);
+    ASSERT_ARE_EQUAL(size_t, 20, sites[1].live_bytes);
+    ASSERT_ARE_EQUAL(size_t, 2, sites[1].live_blocks);
+
+    // cleanup
+    gballoc_free(small1);
+    gballoc_free(small2);
+    gballoc_free(large);
+}
+
+/* Tests_SRS_GBALLOC_11_006: [ gballoc_getTopAllocationSites shall copy to sites the statistics of at most site_count sites, in decreasing order of live bytes for GBALLOC_SITE_ORDER_BY_LIVE_BYTES or of allocations for GBALLOC_SITE_ORDER_BY_ALLOCATIONS, skipping the sites for which that value is 0, and return the number of sites copied. ]*/
+TEST_FUNCTION(gballoc_getTopAllocationSites_by_allocations_orders_the_sites_by_their_allocation_count)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[1];
+    size_t result;
+    size_t i;
+    void* large = gballoc_malloc_at(1000, TEST_FILE_1, 1);
+    for (i = 0; i < 5; i++)
+    {
+        gballoc_free(gballoc_malloc_at(8, TEST_FILE_2, 2));
+    }
+
+    // act
+    result = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_ALLOCATIONS, sites, 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_FILE_2, sites[0].file);
+    ASSERT_ARE_EQUAL(size_t, 5, sites[0].allocations);
+    ASSERT_ARE_EQUAL(size_t, 0, sites[0].live_bytes);
+
+    // cleanup
+    gballoc_free(large);
+}
+
+TEST_FUNCTION(gballoc_getTopAllocationSites_attributes_gballoc_malloc_calls_to_an_unknown_site)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[1];
+    size_t result;
+    void* block = gballoc_malloc(10);
+
+    // act
+    result = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_LIVE_BYTES, sites, 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, result);
+    ASSERT_ARE_EQUAL(char_ptr, "<unknown>", sites[0].file);
+    ASSERT_ARE_EQUAL(size_t, 10, sites[0].live_bytes);
+
+    // cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_11_004: [ When GB_TRACK_ALLOCATION_SITES is defined, every tracked allocation shall be counted for the file and line it was made at, with its size added to the live bytes and to the size histogram of the site. ]*/
+TEST_FUNCTION(gballoc_getTopAllocationSites_reports_the_size_histogram)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[1];
+    void* block1 = gballoc_malloc_at(16, TEST_FILE_1, 1);
+    void* block2 = gballoc_malloc_at(17, TEST_FILE_1, 1);
+    void* block3 = gballoc_malloc_at(1024 * 1024, TEST_FILE_1, 1);
+
+    // act
+    (void)gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_ALLOCATIONS, sites, 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, sites[0].size_histogram[0]);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[0].size_histogram[1]);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[0].size_histogram[GBALLOC_SIZE_HISTOGRAM_BUCKETS - 1]);
+
+    // cleanup
+    gballoc_free(block1);
+    gballoc_free(block2);
+    gballoc_free(block3);
+}
+
+/* Tests_SRS_GBALLOC_11_005: [ When GB_TRACK_ALLOCATION_SITES is defined, freeing a tracked block shall remove it from the live blocks and bytes of its site and record its lifetime, counted in allocations made since the block was allocated. ]*/
+/* Tests_SRS_GBALLOC_11_007: [ The average lifetime of a site shall be the sum of the lifetimes of its freed blocks divided by their number, 0 when none was freed. ]*/
+TEST_FUNCTION(gballoc_free_records_the_lifetime_of_the_block_in_allocations)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[2];
+    void* long_lived = gballoc_malloc_at(10, TEST_FILE_1, 1);
+    void* others[3];
+    size_t i;
+    for (i = 0; i < 3; i++)
+    {
+        others[i] = gballoc_malloc_at(1, TEST_FILE_2, 2);
+    }
+    gballoc_free(long_lived);
+    gballoc_free(gballoc_malloc_at(10, TEST_FILE_1, 1));
+
+    // act
+    (void)gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_ALLOCATIONS, sites, 2);
+
+    // assert
+    /* the 3 allocations of TEST_FILE_2 rank it before the 2 of TEST_FILE_1 */
+    ASSERT_ARE_EQUAL(char_ptr, TEST_FILE_1, sites[1].file);
+    ASSERT_ARE_EQUAL(size_t, 2, sites[1].freed_blocks);
+    ASSERT_ARE_EQUAL(size_t, 4, sites[1].max_lifetime);
+    ASSERT_ARE_EQUAL(size_t, (4 + 1) / 2, sites[1].average_lifetime);
+    ASSERT_ARE_EQUAL(size_t, 0, sites[1].live_blocks);
+
+    // cleanup
+    for (i = 0; i < 3; i++)
+    {
+        gballoc_free(others[i]);
+    }
+}
+
+/* Tests_SRS_GBALLOC_11_014: [ When GB_TRACK_ALLOCATION_SITES is defined, reallocating a tracked block shall keep it counted at the site and with the lifetime it was allocated with, only changing the live bytes of the site by the size difference. ]*/
+TEST_FUNCTION(gballoc_realloc_at_keeps_the_block_at_its_allocation_site)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[2];
+    size_t result;
+    void* block = gballoc_malloc_at(10, TEST_FILE_1, 1);
+    block = gballoc_realloc_at(block, 50, TEST_FILE_2, 2);
+
+    // act
+    result = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_ALLOCATIONS, sites, 2);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_FILE_1, sites[0].file);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[0].allocations);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[0].live_blocks);
+    ASSERT_ARE_EQUAL(size_t, 50, sites[0].live_bytes);
+    ASSERT_ARE_EQUAL(size_t, 0, sites[0].freed_blocks);
+
+    // cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_11_014: [ When GB_TRACK_ALLOCATION_SITES is defined, reallocating a tracked block shall keep it counted at the site and with the lifetime it was allocated with, only changing the live bytes of the site by the size difference. ]*/
+TEST_FUNCTION(gballoc_realloc_at_does_not_restart_the_lifetime_of_the_block)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[2];
+    void* block = gballoc_malloc_at(10, TEST_FILE_1, 1);
+    void* others[2];
+    size_t i;
+    for (i = 0; i < 2; i++)
+    {
+        others[i] = gballoc_malloc_at(1, TEST_FILE_2, 2);
+    }
+    block = gballoc_realloc_at(block, 20, TEST_FILE_1, 1);
+    gballoc_free(block);
+
+    // act
+    (void)gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_ALLOCATIONS, sites, 2);
+
+    // assert
+    /* the 2 allocations of TEST_FILE_2 rank it before the single one of TEST_FILE_1 */
+    ASSERT_ARE_EQUAL(char_ptr, TEST_FILE_1, sites[1].file);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[1].allocations);
+    ASSERT_ARE_EQUAL(size_t, 1, sites[1].freed_blocks);
+    ASSERT_ARE_EQUAL(size_t, 3, sites[1].max_lifetime);
+
+    // cleanup
+    for (i = 0; i < 2; i++)
+    {
+        gballoc_free(others[i]);
+    }
+}
+
+/* Tests_SRS_GBALLOC_11_009: [ If sites is NULL and site_count is not 0, gballoc_getTopAllocationSites shall return 0. ]*/
+TEST_FUNCTION(gballoc_getTopAllocationSites_with_NULL_sites_returns_0)
+{
+    // arrange
+    size_t result;
+    void* block = gballoc_malloc_at(10, TEST_FILE_1, 1);
+
+    // act
+    result = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_LIVE_BYTES, NULL, 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+
+    // cleanup
+    gballoc_free(block);
+}
+
+TEST_FUNCTION(gballoc_getTopAllocationSites_when_gballoc_is_not_initialized_returns_0)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[1];
+    size_t result;
+    gballoc_deinit();
+
+    // act
+    result = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_LIVE_BYTES, sites, 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+}
+
+/* gballoc_resetMetrics */
+
+/* Tests_SRS_GBALLOC_11_008: [ When GB_TRACK_ALLOCATION_SITES is defined, gballoc_resetMetrics shall also reset the allocation counts, size histograms and lifetimes of all sites, keeping their live blocks and bytes. ]*/
+TEST_FUNCTION(gballoc_resetMetrics_keeps_the_live_bytes_of_the_sites)
+{
+    // arrange
+    GBALLOC_SITE_STATS sites[1];
+    size_t by_allocations;
+    size_t by_live_bytes;
+    void* block = gballoc_malloc_at(10, TEST_FILE_1, 1);
+
+    // act
+    gballoc_resetMetrics();
+
+    // assert
+    by_allocations = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_ALLOCATIONS, sites, 1);
+    ASSERT_ARE_EQUAL(size_t, 0, by_allocations);
+    by_live_bytes = gballoc_getTopAllocationSites(GBALLOC_SITE_ORDER_BY_LIVE_BYTES, sites, 1);
+    ASSERT_ARE_EQUAL(size_t, 1, by_live_bytes);
+    ASSERT_ARE_EQUAL(size_t, 10, sites[0].live_bytes);
+    ASSERT_ARE_EQUAL(size_t, 0, sites[0].size_histogram[0]);
+
+    // cleanup
+    gballoc_free(block);
+}
+
+END_TEST_SUITE(GBAlloc_Allocation_Sites_UnitTests)
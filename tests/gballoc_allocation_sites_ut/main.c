@@ -0,0 +1,11 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "testrunnerswitcher.h"
+
+int main(void)
+{
+    size_t failedTestCount = 0;
+	RUN_TEST_SUITE(GBAlloc_Allocation_Sites_UnitTests, failedTestCount);
+    return failedTestCount;
+}
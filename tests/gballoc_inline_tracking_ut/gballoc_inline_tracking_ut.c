@@ -0,0 +1,497 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#if defined(GB_MEASURE_MEMORY_FOR_THIS)
+#undef GB_MEASURE_MEMORY_FOR_THIS
+#endif
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "testrunnerswitcher.h"
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)~(size_t)0)
+#endif
+
+/*smallest header gballoc can place in front of a block: size, shard and cookie*/
+#define TEST_MIN_HEADER_SIZE (3 * sizeof(size_t))
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+static size_t g_last_requested_size;
+
+static void* my_mock_malloc(size_t size)
+{
+    g_last_requested_size = size;
+    return malloc(size);
+}
+
+static void* my_mock_calloc(size_t nmemb, size_t size)
+{
+    g_last_requested_size = nmemb * size;
+    return calloc(nmemb, size);
+}
+
+static void* my_mock_realloc(void* ptr, size_t size)
+{
+    g_last_requested_size = size;
+    return realloc(ptr, size);
+}
+
+static void my_mock_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+
+#include "umock_c.h"
+#include "umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, void*, mock_malloc, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_calloc, size_t, nmemb, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_realloc, void*, ptr, size_t, size);
+    MOCKABLE_FUNCTION(, void, mock_free, void*, ptr);
+#ifdef __cplusplus
+}
+#endif
+
+#undef ENABLE_MOCKS
+
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(GBAlloc_Inline_Tracking_UnitTests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mock_malloc, my_mock_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_calloc, my_mock_calloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_realloc, my_mock_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_free, my_mock_free);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_last_requested_size = 0;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    gballoc_deinit();
+
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* gballoc_init */
+
+/* Tests_SRS_GBALLOC_11_001: [ When GB_USE_INLINE_TRACKING is defined, gballoc_init shall not create any lock. ]*/
+/* Tests_SRS_GBALLOC_01_002: [Upon initialization the total memory used and maximum total memory used tracked by the module shall be set to 0.] */
+TEST_FUNCTION(gballoc_init_with_inline_tracking_does_not_allocate_and_resets_the_counters)
+{
+    // arrange
+    int result;
+
+    // act
+    result = gballoc_init();
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+}
+
+/* Tests_SRS_GBALLOC_01_025: [Init after Init shall fail and return a non-zero value.] */
+TEST_FUNCTION(gballoc_init_after_init_with_inline_tracking_fails)
+{
+    // arrange
+    int result;
+    (void)gballoc_init();
+
+    // act
+    result = gballoc_init();
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* gballoc_malloc */
+
+/* Tests_SRS_GBALLOC_11_002: [ When GB_USE_INLINE_TRACKING is defined, gballoc_malloc, gballoc_calloc and gballoc_realloc shall store the size of the block in a header placed right before the memory returned to the caller, whether or not gballoc is initialized. ]*/
+/* Tests_SRS_GBALLOC_01_004: [If the underlying malloc call is successful, gb_malloc shall increment the total memory used with the amount indicated by size.] */
+TEST_FUNCTION(gballoc_malloc_with_inline_tracking_allocates_room_for_the_header_and_counts_the_size)
+{
+    // arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = gballoc_malloc(42);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(g_last_requested_size >= 42 + TEST_MIN_HEADER_SIZE);
+    ASSERT_ARE_EQUAL(size_t, 42, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 42, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 1, gballoc_getAllocationCount());
+    (void)memset(result, 0xAA, 42);
+
+    // cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_01_012: [When the underlying malloc call fails, gballoc_malloc shall return NULL and size should not be counted towards total memory used.] */
+TEST_FUNCTION(when_malloc_fails_gballoc_malloc_with_inline_tracking_fails)
+{
+    // arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = gballoc_malloc(42);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+}
+
+/* gballoc_calloc */
+
+/* Tests_SRS_GBALLOC_01_021: [If the underlying calloc call is successful, gballoc_calloc shall increment the total memory used with nmemb*size.] */
+TEST_FUNCTION(gballoc_calloc_with_inline_tracking_allocates_room_for_the_header_and_counts_nmemb_times_size)
+{
+    // arrange
+    unsigned char* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_calloc(1, IGNORED_NUM_ARG));
+
+    // act
+    result = (unsigned char*)gballoc_calloc(3, 4);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(g_last_requested_size >= 12 + TEST_MIN_HEADER_SIZE);
+    ASSERT_ARE_EQUAL(int, 0, (int)result[11]);
+    ASSERT_ARE_EQUAL(size_t, 12, gballoc_getCurrentMemoryUsed());
+
+    // cleanup
+    gballoc_free(result);
+}
+
+TEST_FUNCTION(gballoc_calloc_with_inline_tracking_with_overflowing_size_fails)
+{
+    // arrange
+    void* result;
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    // act
+    result = gballoc_calloc(SIZE_MAX / 2, 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+}
+
+/* gballoc_realloc */
+
+/* Tests_SRS_GBALLOC_01_006: [If the underlying realloc call is successful, gballoc_realloc shall look up the size associated with the pointer ptr and decrease the total memory used with that size.] */
+/* Tests_SRS_GBALLOC_01_007: [If realloc is successful, gballoc_realloc shall also increment the total memory used value tracked by this module.] */
+TEST_FUNCTION(gballoc_realloc_with_inline_tracking_replaces_the_counted_size)
+{
+    // arrange
+    unsigned char* block;
+    unsigned char* result;
+    (void)gballoc_init();
+    block = (unsigned char*)gballoc_malloc(10);
+    (void)memset(block, 0x42, 10);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    result = (unsigned char*)gballoc_realloc(block, 30);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(g_last_requested_size >= 30 + TEST_MIN_HEADER_SIZE);
+    ASSERT_ARE_EQUAL(int, 0x42, (int)result[9]);
+    ASSERT_ARE_EQUAL(size_t, 30, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 30, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 2, gballoc_getAllocationCount());
+
+    // cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_01_014: [When the underlying realloc call fails, gballoc_realloc shall return NULL and no change should be made to the counted total memory usage.] */
+TEST_FUNCTION(when_realloc_fails_gballoc_realloc_with_inline_tracking_keeps_the_original_block)
+{
+    // arrange
+    void* block;
+    void* result;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+
+    // act
+    result = gballoc_realloc(block, 30);
+    gballoc_free(block);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 10, gballoc_getMaximumMemoryUsed());
+}
+
+/* gballoc_free */
+
+/* Tests_SRS_GBALLOC_01_008: [gballoc_free shall call the C99 free function.] */
+/* Tests_SRS_GBALLOC_01_009: [gballoc_free shall also look up the size associated with the ptr pointer and decrease the total memory used with the associated size amount.] */
+TEST_FUNCTION(gballoc_free_with_inline_tracking_frees_the_header_and_decrements_the_counted_size)
+{
+    // arrange
+    void* block1;
+    void* block2;
+    (void)gballoc_init();
+    block1 = gballoc_malloc(10);
+    block2 = gballoc_malloc(20);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+
+    // act
+    gballoc_free(block1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 20, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 30, gballoc_getMaximumMemoryUsed());
+
+    // cleanup
+    gballoc_free(block2);
+}
+
+/* Tests_SRS_GBALLOC_11_002: [ When GB_USE_INLINE_TRACKING is defined, gballoc_malloc, gballoc_calloc and gballoc_realloc shall store the size of the block in a header placed right before the memory returned to the caller, whether or not gballoc is initialized. ]*/
+TEST_FUNCTION(gballoc_free_with_inline_tracking_of_a_block_allocated_before_init_does_not_change_the_counters)
+{
+    // arrange
+    void* block = gballoc_malloc(10);
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+
+    // act
+    gballoc_free(block);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+}
+
+/* Tests_SRS_GBALLOC_11_012: [ When GB_USE_INLINE_TRACKING is defined, freeing or reallocating a block counted before the last gballoc_init shall not change the counters. ]*/
+TEST_FUNCTION(gballoc_free_with_inline_tracking_of_a_block_allocated_before_deinit_and_init_does_not_change_the_counters)
+{
+    // arrange
+    void* old_block;
+    void* new_block;
+    (void)gballoc_init();
+    old_block = gballoc_malloc(10);
+    gballoc_deinit();
+    (void)gballoc_init();
+    new_block = gballoc_malloc(3);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+
+    // act
+    gballoc_free(old_block);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 3, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 1, gballoc_getAllocationCount());
+
+    // cleanup
+    gballoc_free(new_block);
+}
+
+/* Tests_SRS_GBALLOC_11_012: [ When GB_USE_INLINE_TRACKING is defined, freeing or reallocating a block counted before the last gballoc_init shall not change the counters. ]*/
+TEST_FUNCTION(gballoc_realloc_with_inline_tracking_of_a_block_allocated_before_deinit_and_init_counts_only_the_new_size)
+{
+    // arrange
+    void* block;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    gballoc_deinit();
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    block = gballoc_realloc(block, 4);
+
+    // assert
+    ASSERT_IS_NOT_NULL(block);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 4, gballoc_getCurrentMemoryUsed());
+
+    // cleanup
+    gballoc_free(block);
+}
+
+/* Tests_SRS_GBALLOC_01_019: [When the ptr pointer cannot be found in the pointers tracked by gballoc, gballoc_free shall not free any memory.] */
+/* Tests_SRS_GBALLOC_11_013: [ When GB_USE_INLINE_TRACKING is defined, gballoc_free and gballoc_realloc shall only accept NULL or a block returned by gballoc; when GBALLOC_VALIDATE_HEADERS is defined (the default unless NDEBUG is defined) a header whose cookie does not match shall be treated as a pointer that cannot be found. ]*/
+TEST_FUNCTION(gballoc_free_with_inline_tracking_of_a_pointer_without_header_does_not_free)
+{
+    // arrange
+    /*the pointer is in the middle of the array so that reading its header stays in bounds*/
+    size_t foreign[8];
+    (void)memset(foreign, 0, sizeof(foreign));
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    // act
+    gballoc_free(&foreign[4]);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_01_016: [When the ptr pointer cannot be found in the pointers tracked by gballoc, gballoc_realloc shall return NULL and the underlying realloc shall not be called.] */
+/* Tests_SRS_GBALLOC_11_013: [ When GB_USE_INLINE_TRACKING is defined, gballoc_free and gballoc_realloc shall only accept NULL or a block returned by gballoc; when GBALLOC_VALIDATE_HEADERS is defined (the default unless NDEBUG is defined) a header whose cookie does not match shall be treated as a pointer that cannot be found. ]*/
+TEST_FUNCTION(gballoc_realloc_with_inline_tracking_of_a_pointer_without_header_fails)
+{
+    // arrange
+    size_t foreign[8];
+    void* result;
+    (void)memset(foreign, 0, sizeof(foreign));
+    (void)gballoc_init();
+    umock_c_reset_all_calls();
+
+    // act
+    result = gballoc_realloc(&foreign[4], 16);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* gballoc_getAllocationCount */
+
+/* Tests_SRS_GBALLOC_11_003: [ When GB_USE_INLINE_TRACKING is defined, gballoc_getCurrentMemoryUsed and gballoc_getAllocationCount shall return the sum of the per shard counters. ]*/
+TEST_FUNCTION(gballoc_getAllocationCount_with_inline_tracking_sums_allocations_over_all_shards)
+{
+    // arrange
+    void* blocks[40];
+    size_t i;
+    size_t count;
+    size_t current;
+    (void)gballoc_init();
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        blocks[i] = gballoc_malloc(i + 1);
+    }
+
+    // act
+    count = gballoc_getAllocationCount();
+    current = gballoc_getCurrentMemoryUsed();
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 40, count);
+    ASSERT_ARE_EQUAL(size_t, 40 * 41 / 2, current);
+
+    // cleanup
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        gballoc_free(blocks[i]);
+    }
+}
+
+/* gballoc_resetMetrics */
+
+/* Tests_SRS_GBALLOC_07_008: [ gballoc_resetMetrics shall reset the total allocation size, max allocation size and number of allocation to zero. ] */
+TEST_FUNCTION(gballoc_resetMetrics_with_inline_tracking_resets_all_shards)
+{
+    // arrange
+    void* block;
+    (void)gballoc_init();
+    block = gballoc_malloc(10);
+    gballoc_free(block);
+
+    // act
+    gballoc_resetMetrics();
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getCurrentMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getMaximumMemoryUsed());
+    ASSERT_ARE_EQUAL(size_t, 0, gballoc_getAllocationCount());
+}
+
+END_TEST_SUITE(GBAlloc_Inline_Tracking_UnitTests)
@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+
+#ifndef GB_USE_INLINE_TRACKING
+#define GB_USE_INLINE_TRACKING
+#endif
+
+/*the tests of pointers without a gballoc header need the header check, whatever the build type*/
+#ifndef GBALLOC_VALIDATE_HEADERS
+#define GBALLOC_VALIDATE_HEADERS
+#endif
+
+#define malloc mock_malloc
+#define calloc mock_calloc
+#define realloc mock_realloc
+#define free mock_free
+
+extern void* mock_malloc(size_t size);
+extern void* mock_calloc(size_t nmemb, size_t size);
+extern void* mock_realloc(void* ptr, size_t size);
+extern void mock_free(void* ptr);
+
+#undef _CRTDBG_MAP_ALLOC
+#include "../src/gballoc.c"
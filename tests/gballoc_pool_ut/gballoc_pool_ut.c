@@ -0,0 +1,655 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)~(size_t)0)
+#endif
+
+/*these mirror the size classes and the thread cache size in gballoc_pool.c*/
+#define TEST_CLASS_COUNT 10
+#define TEST_LARGEST_CLASS_SIZE 512
+#define TEST_CLASS_INDEX_FOR_80_BYTES 4
+#define TEST_CLASS_INDEX_FOR_100_BYTES 5
+#define TEST_CLASS_INDEX_FOR_300_BYTES 8
+#define TEST_THREAD_CACHE_SIZE 32
+
+#define TEST_THREAD_COUNT 4
+/*so that the last counters of every thread are only published when it exits*/
+#define TEST_THREAD_ITERATIONS 1001
+#define TEST_THREAD_LIVE_BLOCKS 16
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+static size_t g_last_requested_size;
+static bool g_fail_malloc;
+
+static void* my_mock_malloc(size_t size)
+{
+    g_last_requested_size = size;
+    return g_fail_malloc ? NULL : malloc(size);
+}
+
+static void* my_mock_realloc(void* ptr, size_t size)
+{
+    g_last_requested_size = size;
+    return realloc(ptr, size);
+}
+
+static void my_mock_free(void* ptr)
+{
+    free(ptr);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    extern void* gballoc_malloc(size_t size);
+    extern void* gballoc_calloc(size_t nmemb, size_t size);
+    extern void* gballoc_realloc(void* ptr, size_t size);
+    extern void gballoc_free(void* ptr);
+#ifdef __cplusplus
+}
+#endif
+
+#define ENABLE_MOCKS
+
+#include "umock_c.h"
+#include "umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, void*, mock_malloc, size_t, size);
+    MOCKABLE_FUNCTION(, void*, mock_realloc, void*, ptr, size_t, size);
+    MOCKABLE_FUNCTION(, void, mock_free, void*, ptr);
+#ifdef __cplusplus
+}
+#endif
+
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/gballoc_pool.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+typedef struct TEST_THREAD_BLOCK_TAG
+{
+    size_t size;
+    void* block;
+} TEST_THREAD_BLOCK;
+
+/*allocates and frees one block, then exits without flushing its cache*/
+static int allocate_and_free_one_block(void* arg)
+{
+    TEST_THREAD_BLOCK* thread_block = (TEST_THREAD_BLOCK*)arg;
+    thread_block->block = gballoc_malloc(thread_block->size);
+    gballoc_free(thread_block->block);
+    return 0;
+}
+
+/*allocates one block and keeps it*/
+static int allocate_one_block(void* arg)
+{
+    TEST_THREAD_BLOCK* thread_block = (TEST_THREAD_BLOCK*)arg;
+    thread_block->block = gballoc_malloc(thread_block->size);
+    return 0;
+}
+
+/*fills every block with a byte of its own and checks that no other thread wrote to it before freeing it*/
+static int allocate_and_free_blocks(void* arg)
+{
+    unsigned char pattern = (unsigned char)(uintptr_t)arg;
+    unsigned char* blocks[TEST_THREAD_LIVE_BLOCKS];
+    int result = 0;
+    size_t i;
+    size_t j;
+    size_t k;
+
+    for (i = 0; i < TEST_THREAD_ITERATIONS; i++)
+    {
+        for (j = 0; j < TEST_THREAD_LIVE_BLOCKS; j++)
+        {
+            blocks[j] = (unsigned char*)gballoc_malloc(300);
+            if (blocks[j] == NULL)
+            {
+                result = __LINE__;
+            }
+            else
+            {
+                (void)memset(blocks[j], (int)(pattern + j), 300);
+            }
+        }
+
+        for (j = 0; j < TEST_THREAD_LIVE_BLOCKS; j++)
+        {
+            if (blocks[j] != NULL)
+            {
+                for (k = 0; k < 300; k++)
+                {
+                    if (blocks[j][k] != (unsigned char)(pattern + j))
+                    {
+                        result = __LINE__;
+                        break;
+                    }
+                }
+                gballoc_free(blocks[j]);
+            }
+        }
+    }
+
+    return result;
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(GBAlloc_Pool_UnitTests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mock_malloc, my_mock_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_realloc, my_mock_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(mock_free, my_mock_free);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_last_requested_size = 0;
+    g_fail_malloc = false;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* gballoc_malloc */
+
+/* Tests_SRS_GBALLOC_POOL_11_001: [ gballoc_malloc shall take the block from the calling thread's cache of the smallest size class that fits size and count a hit. ]*/
+/* Tests_SRS_GBALLOC_POOL_11_006: [ gballoc_free shall return a pooled block to the calling thread's cache. ]*/
+TEST_FUNCTION(gballoc_malloc_reuses_the_block_freed_last_in_the_same_class_without_calling_malloc)
+{
+    // arrange
+    void* block = gballoc_malloc(24);
+    void* result;
+    gballoc_free(block);
+    umock_c_reset_all_calls();
+
+    // act
+    result = gballoc_malloc(20);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, block, result);
+    ASSERT_ARE_EQUAL(size_t, 0, ((uintptr_t)result) % sizeof(void*));
+
+    // cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_003: [ If size is larger than the largest size class, gballoc_malloc shall allocate the block with malloc. ]*/
+TEST_FUNCTION(gballoc_malloc_with_a_size_larger_than_the_largest_class_calls_malloc)
+{
+    // arrange
+    void* result;
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = gballoc_malloc(TEST_LARGEST_CLASS_SIZE + 1);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(g_last_requested_size > TEST_LARGEST_CLASS_SIZE + 1);
+
+    // cleanup
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(mock_free(IGNORED_PTR_ARG));
+    gballoc_free(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_004: [ If allocating a slab fails, gballoc_malloc shall return NULL. ]*/
+TEST_FUNCTION(when_allocating_a_slab_fails_gballoc_malloc_fails)
+{
+    // arrange
+    void* blocks[1024];
+    size_t block_count = 0;
+    GBALLOC_POOL_CLASS_STATS before;
+    GBALLOC_POOL_CLASS_STATS after;
+    size_t i;
+
+    gballoc_pool_flush_thread_cache();
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_COUNT - 1, &before);
+    g_fail_malloc = true;
+
+    // act
+    /*the blocks already carved for the class are handed out first*/
+    while ((block_count < sizeof(blocks) / sizeof(blocks[0])) &&
+        ((blocks[block_count] = gballoc_malloc(TEST_LARGEST_CLASS_SIZE)) != NULL))
+    {
+        block_count++;
+    }
+
+    // assert
+    ASSERT_IS_TRUE(block_count < sizeof(blocks) / sizeof(blocks[0]));
+    ASSERT_IS_NOT_NULL(strstr(umock_c_get_actual_calls(), "mock_malloc"));
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_COUNT - 1, &after);
+    ASSERT_ARE_EQUAL(size_t, before.bytes_reserved, after.bytes_reserved);
+
+    // cleanup
+    g_fail_malloc = false;
+    for (i = 0; i < block_count; i++)
+    {
+        gballoc_free(blocks[i]);
+    }
+}
+
+TEST_FUNCTION(when_malloc_fails_gballoc_malloc_with_a_large_size_fails)
+{
+    // arrange
+    void* result;
+    STRICT_EXPECTED_CALL(mock_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = gballoc_malloc(TEST_LARGEST_CLASS_SIZE * 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* gballoc_calloc */
+
+/* Tests_SRS_GBALLOC_POOL_11_005: [ gballoc_calloc shall allocate nmemb * size bytes as gballoc_malloc does and set them to 0. ]*/
+TEST_FUNCTION(gballoc_calloc_zeroes_a_reused_block)
+{
+    // arrange
+    unsigned char* result;
+    size_t i;
+    void* block = gballoc_malloc(40);
+    (void)memset(block, 0xFF, 40);
+    gballoc_free(block);
+    umock_c_reset_all_calls();
+
+    // act
+    result = (unsigned char*)gballoc_calloc(5, 8);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, block, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    for (i = 0; i < 40; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, (int)result[i]);
+    }
+
+    // cleanup
+    gballoc_free(result);
+}
+
+TEST_FUNCTION(gballoc_calloc_with_overflowing_size_fails)
+{
+    // arrange
+    void* result;
+
+    // act
+    result = gballoc_calloc(SIZE_MAX / 2, 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* gballoc_free */
+
+TEST_FUNCTION(gballoc_free_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    gballoc_free(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_007: [ When the thread's cache holds more than GBALLOC_POOL_THREAD_CACHE_SIZE blocks of the class, gballoc_free shall move half of them to the shared list of the class. ]*/
+TEST_FUNCTION(gballoc_free_moves_the_blocks_over_the_thread_cache_size_to_the_shared_list)
+{
+    // arrange
+    void* blocks[TEST_THREAD_CACHE_SIZE + 1];
+    TEST_THREAD_BLOCK other_thread_block;
+    THREAD_HANDLE thread;
+    bool found = false;
+    size_t i;
+
+    gballoc_pool_flush_thread_cache();
+    for (i = 0; i < TEST_THREAD_CACHE_SIZE + 1; i++)
+    {
+        blocks[i] = gballoc_malloc(150);
+        ASSERT_IS_NOT_NULL(blocks[i]);
+    }
+
+    // act
+    for (i = 0; i < TEST_THREAD_CACHE_SIZE + 1; i++)
+    {
+        gballoc_free(blocks[i]);
+    }
+
+    // assert
+    /*another thread can only get one of these blocks from the shared list*/
+    other_thread_block.size = 150;
+    other_thread_block.block = NULL;
+    ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Create(&thread, allocate_one_block, &other_thread_block));
+    ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Join(thread, NULL));
+    ASSERT_IS_NOT_NULL(other_thread_block.block);
+    for (i = 0; i < TEST_THREAD_CACHE_SIZE + 1; i++)
+    {
+        if (blocks[i] == other_thread_block.block)
+        {
+            found = true;
+        }
+    }
+    ASSERT_IS_TRUE(found);
+
+    // cleanup
+    gballoc_free(other_thread_block.block);
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_015: [ When a thread that cached blocks exits, its cache shall be flushed as gballoc_pool_flush_thread_cache does. ]*/
+TEST_FUNCTION(the_cache_of_a_thread_that_exits_goes_back_to_the_shared_list)
+{
+    // arrange
+    void* blocks[(TEST_THREAD_CACHE_SIZE / 2) + 1];
+    TEST_THREAD_BLOCK thread_block;
+    GBALLOC_POOL_CLASS_STATS before;
+    GBALLOC_POOL_CLASS_STATS after;
+    THREAD_HANDLE thread;
+    bool found = false;
+    size_t i;
+
+    gballoc_pool_flush_thread_cache();
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_80_BYTES, &before);
+    thread_block.size = 80;
+    thread_block.block = NULL;
+
+    // act
+    ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Create(&thread, allocate_and_free_one_block, &thread_block));
+    ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Join(thread, NULL));
+
+    // assert
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_80_BYTES, &after);
+    ASSERT_IS_NOT_NULL(thread_block.block);
+    ASSERT_ARE_EQUAL(size_t, before.hits + before.misses + 1, after.hits + after.misses);
+    ASSERT_ARE_EQUAL(size_t, before.blocks_in_use, after.blocks_in_use);
+
+    /*the exiting thread put its whole cache in front of the shared list, one refill gets the block back*/
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        blocks[i] = gballoc_malloc(80);
+        if (blocks[i] == thread_block.block)
+        {
+            found = true;
+        }
+    }
+    ASSERT_IS_TRUE(found);
+
+    // cleanup
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        gballoc_free(blocks[i]);
+    }
+}
+
+TEST_FUNCTION(gballoc_malloc_and_gballoc_free_on_several_threads_keep_the_blocks_apart_and_the_statistics_exact)
+{
+    // arrange
+    /*enough carved blocks for every thread's live blocks and a full cache, so no thread needs a slab (umock_c is not thread safe)*/
+    void* warm_up_blocks[TEST_THREAD_COUNT * (TEST_THREAD_LIVE_BLOCKS + TEST_THREAD_CACHE_SIZE + 1)];
+    THREAD_HANDLE threads[TEST_THREAD_COUNT];
+    GBALLOC_POOL_CLASS_STATS before;
+    GBALLOC_POOL_CLASS_STATS after;
+    int thread_result;
+    size_t i;
+
+    for (i = 0; i < sizeof(warm_up_blocks) / sizeof(warm_up_blocks[0]); i++)
+    {
+        warm_up_blocks[i] = gballoc_malloc(300);
+        ASSERT_IS_NOT_NULL(warm_up_blocks[i]);
+    }
+    for (i = 0; i < sizeof(warm_up_blocks) / sizeof(warm_up_blocks[0]); i++)
+    {
+        gballoc_free(warm_up_blocks[i]);
+    }
+    gballoc_pool_flush_thread_cache();
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_300_BYTES, &before);
+
+    // act
+    for (i = 0; i < TEST_THREAD_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Create(&threads[i], allocate_and_free_blocks, (void*)(uintptr_t)(i * TEST_THREAD_LIVE_BLOCKS)));
+    }
+
+    // assert
+    for (i = 0; i < TEST_THREAD_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)THREADAPI_OK, (int)ThreadAPI_Join(threads[i], &thread_result));
+        ASSERT_ARE_EQUAL(int, 0, thread_result);
+    }
+
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_300_BYTES, &after);
+    ASSERT_ARE_EQUAL(size_t, before.hits + before.misses + (TEST_THREAD_COUNT * TEST_THREAD_ITERATIONS * TEST_THREAD_LIVE_BLOCKS), after.hits + after.misses);
+    ASSERT_ARE_EQUAL(size_t, before.blocks_in_use, after.blocks_in_use);
+    ASSERT_ARE_EQUAL(size_t, before.bytes_in_use, after.bytes_in_use);
+    ASSERT_ARE_EQUAL(size_t, before.bytes_reserved, after.bytes_reserved);
+}
+
+/* gballoc_realloc */
+
+/* Tests_SRS_GBALLOC_POOL_11_008: [ If size still maps to the size class of ptr, gballoc_realloc shall return ptr without moving the block. ]*/
+TEST_FUNCTION(gballoc_realloc_within_the_same_class_does_not_move_the_block)
+{
+    // arrange
+    void* block = gballoc_malloc(33);
+    void* result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = gballoc_realloc(block, 48);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, block, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    gballoc_free(result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_009: [ Otherwise gballoc_realloc shall allocate a new block, copy the content of ptr to it and free ptr. ]*/
+TEST_FUNCTION(gballoc_realloc_to_another_class_copies_the_content)
+{
+    // arrange
+    char* block = (char*)gballoc_malloc(10);
+    char* result;
+    (void)memcpy(block, "123456789", 10);
+
+    // act
+    result = (char*)gballoc_realloc(block, 200);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_NOT_EQUAL(void_ptr, block, result);
+    ASSERT_ARE_EQUAL(char_ptr, "123456789", result);
+
+    // cleanup
+    gballoc_free(result);
+}
+
+TEST_FUNCTION(gballoc_realloc_of_a_large_block_to_a_large_size_calls_realloc)
+{
+    // arrange
+    void* block = gballoc_malloc(TEST_LARGEST_CLASS_SIZE * 2);
+    void* result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(mock_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    result = gballoc_realloc(block, TEST_LARGEST_CLASS_SIZE * 3);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(g_last_requested_size > TEST_LARGEST_CLASS_SIZE * 3);
+
+    // cleanup
+    gballoc_free(result);
+}
+
+/* gballoc_pool_get_class_count */
+
+TEST_FUNCTION(gballoc_pool_get_class_count_returns_the_number_of_size_classes)
+{
+    // arrange
+    size_t result;
+
+    // act
+    result = gballoc_pool_get_class_count();
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, TEST_CLASS_COUNT, result);
+}
+
+/* gballoc_pool_get_class_stats */
+
+/* Tests_SRS_GBALLOC_POOL_11_010: [ If stats is NULL or class_index is larger than the class count, gballoc_pool_get_class_stats shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(gballoc_pool_get_class_stats_with_NULL_stats_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = gballoc_pool_get_class_stats(0, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_010: [ If stats is NULL or class_index is larger than the class count, gballoc_pool_get_class_stats shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(gballoc_pool_get_class_stats_with_class_index_past_the_large_row_fails)
+{
+    // arrange
+    GBALLOC_POOL_CLASS_STATS stats;
+    int result;
+
+    // act
+    result = gballoc_pool_get_class_stats(TEST_CLASS_COUNT + 1, &stats);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_011: [ gballoc_pool_get_class_stats shall fill stats with the block size, hits, misses, blocks and bytes in use and bytes reserved of the class, as published by all threads. ]*/
+/* Tests_SRS_GBALLOC_POOL_11_013: [ gballoc_pool_flush_thread_cache shall move all the blocks cached by the calling thread to the shared lists and publish the thread's counters. ]*/
+TEST_FUNCTION(gballoc_pool_get_class_stats_reports_the_blocks_in_use_after_a_flush)
+{
+    // arrange
+    GBALLOC_POOL_CLASS_STATS before;
+    GBALLOC_POOL_CLASS_STATS in_use;
+    GBALLOC_POOL_CLASS_STATS after;
+    void* block;
+    int result;
+
+    gballoc_pool_flush_thread_cache();
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_100_BYTES, &before);
+    block = gballoc_malloc(100);
+    gballoc_pool_flush_thread_cache();
+
+    // act
+    result = gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_100_BYTES, &in_use);
+    gballoc_free(block);
+    gballoc_pool_flush_thread_cache();
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_INDEX_FOR_100_BYTES, &after);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 128, in_use.block_size);
+    ASSERT_ARE_EQUAL(size_t, before.blocks_in_use + 1, in_use.blocks_in_use);
+    ASSERT_ARE_EQUAL(size_t, before.bytes_in_use + 100, in_use.bytes_in_use);
+    ASSERT_ARE_EQUAL(size_t, before.hits + before.misses + 1, in_use.hits + in_use.misses);
+    ASSERT_IS_TRUE(in_use.bytes_reserved >= in_use.bytes_in_use);
+    ASSERT_ARE_EQUAL(size_t, before.blocks_in_use, after.blocks_in_use);
+    ASSERT_ARE_EQUAL(size_t, before.bytes_in_use, after.bytes_in_use);
+}
+
+/* Tests_SRS_GBALLOC_POOL_11_012: [ If class_index is equal to the class count, gballoc_pool_get_class_stats shall report the requests too large for any class, with block_size 0, every allocation counted as a miss and bytes_reserved equal to bytes_in_use. ]*/
+TEST_FUNCTION(gballoc_pool_get_class_stats_for_the_large_row_counts_every_allocation_as_a_miss)
+{
+    // arrange
+    GBALLOC_POOL_CLASS_STATS before;
+    GBALLOC_POOL_CLASS_STATS stats;
+    void* block;
+    int result;
+
+    (void)gballoc_pool_get_class_stats(TEST_CLASS_COUNT, &before);
+    block = gballoc_malloc(1000);
+
+    // act
+    result = gballoc_pool_get_class_stats(TEST_CLASS_COUNT, &stats);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, stats.block_size);
+    ASSERT_ARE_EQUAL(size_t, 0, stats.hits);
+    ASSERT_ARE_EQUAL(size_t, before.misses + 1, stats.misses);
+    ASSERT_ARE_EQUAL(size_t, before.bytes_in_use + 1000, stats.bytes_in_use);
+    ASSERT_ARE_EQUAL(size_t, stats.bytes_in_use, stats.bytes_reserved);
+
+    // cleanup
+    gballoc_free(block);
+}
+
+END_TEST_SUITE(GBAlloc_Pool_UnitTests)
@@ -1358,6 +1358,35 @@ TEST_FUNCTION(when_xio_send_fails_http_proxy_io_send_also_fails)
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
+/* Tests_SRS_HTTP_PROXY_IO_11_001: [ If `xio_send` returns `XIO_SEND_WOULD_BLOCK`, `http_proxy_io_send` shall return `XIO_SEND_WOULD_BLOCK`. ]*/
+TEST_FUNCTION(when_xio_send_would_block_http_proxy_io_send_returns_XIO_SEND_WOULD_BLOCK)
+{
+    // arrange
+    CONCRETE_IO_HANDLE http_io;
+    int result;
+    unsigned char test_buffer[] = { 0x42 };
+
+    http_io = http_proxy_io_get_interface_description()->concrete_io_create((void*)&default_http_proxy_io_config);
+    (void)http_proxy_io_get_interface_description()->concrete_io_open(http_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_io_open_complete_context, (const unsigned char*)connect_response, sizeof(connect_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(test_buffer), NULL, (void*)0x4247))
+        .ValidateArgumentBuffer(2, test_buffer, sizeof(test_buffer))
+        .SetReturn(XIO_SEND_WOULD_BLOCK);
+
+    // act
+    result = http_proxy_io_get_interface_description()->concrete_io_send(http_io, test_buffer, sizeof(test_buffer), NULL, (void*)0x4247);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
+}
+
 /* http_proxy_io_dowork */
 
 /* Tests_SRS_HTTP_PROXY_IO_01_037: [ `http_proxy_io_dowork` shall call `xio_dowork` on the underlying IO created in `http_proxy_io_create`. ]*/
@@ -1550,6 +1579,86 @@ TEST_FUNCTION(http_proxy_io_set_option_with_NULL_value_is_allowed)
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
+/* http_proxy_io_get_option */
+
+/* Tests_SRS_HTTP_PROXY_IO_11_002: [ If any of the arguments `http_proxy_io`, `option_name` or `value` is NULL, `http_proxy_io_get_option` shall return a non-zero value. ]*/
+TEST_FUNCTION(http_proxy_io_get_option_with_NULL_arguments_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE http_io;
+    size_t value;
+    int result_1;
+    int result_2;
+    int result_3;
+
+    http_io = http_proxy_io_get_interface_description()->concrete_io_create((void*)&default_http_proxy_io_config);
+    umock_c_reset_all_calls();
+
+    // act
+    result_1 = http_proxy_io_get_interface_description()->concrete_io_getoption(NULL, "option_1", &value);
+    result_2 = http_proxy_io_get_interface_description()->concrete_io_getoption(http_io, NULL, &value);
+    result_3 = http_proxy_io_get_interface_description()->concrete_io_getoption(http_io, "option_1", NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
+}
+
+/* Tests_SRS_HTTP_PROXY_IO_11_003: [ `http_proxy_io_get_option` shall call `xio_getoption` on the underlying IO created in `http_proxy_io_create`, passing the option name and value to it. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_11_005: [ On success, `http_proxy_io_get_option` shall return 0. ]*/
+TEST_FUNCTION(http_proxy_io_get_option_calls_the_underlying_xio_getoption)
+{
+    // arrange
+    CONCRETE_IO_HANDLE http_io;
+    size_t value;
+    int result;
+
+    http_io = http_proxy_io_get_interface_description()->concrete_io_create((void*)&default_http_proxy_io_config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_getoption(TEST_IO_HANDLE, "option_1", &value));
+
+    // act
+    result = http_proxy_io_get_interface_description()->concrete_io_getoption(http_io, "option_1", &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
+}
+
+/* Tests_SRS_HTTP_PROXY_IO_11_004: [ If `xio_getoption` fails, `http_proxy_io_get_option` shall return a non-zero value. ]*/
+TEST_FUNCTION(when_the_underlying_xio_getoption_fails_http_proxy_io_get_option_also_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE http_io;
+    size_t value;
+    int result;
+
+    http_io = http_proxy_io_get_interface_description()->concrete_io_create((void*)&default_http_proxy_io_config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_getoption(TEST_IO_HANDLE, "option_1", &value))
+        .SetReturn(1);
+
+    // act
+    result = http_proxy_io_get_interface_description()->concrete_io_getoption(http_io, "option_1", &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
+}
+
 /* http_proxy_io_retrieve_options */
 
 /* Tests_SRS_HTTP_PROXY_IO_01_046: [ `http_proxy_io_retrieve_options` shall return an `OPTIONHANDLER_HANDLE` obtained by calling `xio_retrieveoptions` on the underlying IO created in `http_proxy_io_create`. ]*/
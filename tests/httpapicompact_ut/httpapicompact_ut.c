@@ -152,7 +152,6 @@ static const int xio_send_e[4] = { 123, 123, 123, 123 };
 static const int xio_send_0_e[4] = { 0, 123, 0, 0 };
 static const int xio_send_00_e[4] = { 0, 0, 123, 0 };
 static const int xio_send_7x0[7] = { 0, 0, 0, 0, 0, 0, 0 };
-static const int xio_send_6x0_e[7] = { 0, 0, 0, 0, 0, 0, 123 };
 static const xio_dowork_job doworkjob_end[1] = { XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_oe[2] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_4none_oe[6] = { XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_END };
@@ -165,8 +164,8 @@ static const xio_dowork_job doworkjob_o_re[3] = { XIO_DOWORK_JOB_OPEN, XIO_DOWOR
 static const xio_dowork_job doworkjob_o_rce[8] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_o_rc_error[9] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_o_rre[4] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_sre[15] = { XIO_DOWORK_JOB_OPEN, 
-    XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND,
+static const xio_dowork_job doworkjob_o_sre[10] = { XIO_DOWORK_JOB_OPEN, 
+    XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND,
     XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
 
 static const IO_OPEN_RESULT openresult_ok[1] = { IO_OPEN_OK };
@@ -183,15 +182,6 @@ static const IO_SEND_RESULT sendresult_7ok[7] = {
         IO_SEND_OK,
         IO_SEND_OK
 };
-static const IO_SEND_RESULT sendresult_6ok_error[7] = {
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_ERROR
-};
 
 
 static const xio_dowork_job* DoworkJobs = (const xio_dowork_job*)doworkjob_end;
@@ -423,19 +413,33 @@ HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE handle, si
 }
 
 static HTTP_HEADERS_RESULT HTTPHeaders_GetHeader_shallReturn;
-HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t index, char** destination)
+static const char TEST_HEADER_LINE[] = "0123456789";
+HTTP_HEADERS_RESULT my_HTTPHeaders_Serialize(HTTP_HEADERS_HANDLE handle, char* destination, size_t destinationSize, size_t* serializedSize)
 {
     HTTP_HEADERS_RESULT result;
+    size_t lineSize = sizeof(TEST_HEADER_LINE) - 1 + 2;
 
-    if ((handle == NULL) || (destination == NULL) || (index > TEST_GET_HEADER_HEAD_COUNT))
+    if ((handle == NULL) || (serializedSize == NULL))
     {
         result = HTTP_HEADERS_INVALID_ARG;
     }
     else
     {
-        *destination = (char*)malloc(11 * sizeof(char));
-        strcpy(*destination, "0123456789");
-        result = HTTPHeaders_GetHeaderCount_shallReturn;
+        *serializedSize = TEST_GET_HEADER_HEAD_COUNT * lineSize;
+        if (destinationSize < *serializedSize)
+        {
+            result = HTTP_HEADERS_INSUFFICIENT_BUFFER;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < TEST_GET_HEADER_HEAD_COUNT; i++)
+            {
+                (void)memcpy(destination + (i * lineSize), TEST_HEADER_LINE, lineSize - 2);
+                (void)memcpy(destination + (i * lineSize) + lineSize - 2, "\r\n", 2);
+            }
+            result = HTTPHeaders_GetHeaderCount_shallReturn;
+        }
     }
 
     return result;
@@ -603,30 +607,27 @@ static void setupAllCallBeforeReceiveHTTPsequenceWithSuccess()
         .IgnoreArgument(1);
 }
 
-static void setupAllCallBeforeSendHTTPsequenceWithSuccess(HTTP_HEADERS_HANDLE requestHttpHeaders)
+static void setupSerializeHeadsSequence(HTTP_HEADERS_HANDLE requestHttpHeaders)
 {
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(3).IgnoreArgument(4);
+}
+
+static void setupSendHeadsSequence(HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    setupSerializeHeadsSequence(requestHttpHeaders);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+}
+
+static void setupAllCallBeforeSendHTTPsequenceWithSuccess(HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    setupSendHeadsSequence(requestHttpHeaders);
 
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
@@ -729,7 +730,7 @@ TEST_SUITE_INITIALIZE(setsBufferTempSize)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderCount, my_HTTPHeaders_GetHeaderCount);
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeader, my_HTTPHeaders_GetHeader);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Serialize, my_HTTPHeaders_Serialize);
 
     REGISTER_GLOBAL_MOCK_HOOK(platform_get_default_tlsio, my_platform_get_default_tlsio);
 }
@@ -2308,8 +2309,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
     setHttpx509ClientCertificateAndKey(httpHandle);
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, true);
     xio_send_shallReturn = (const int*)xio_send_e;
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    setupSendHeadsSequence(requestHttpHeaders);
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2334,8 +2334,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_before_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__serialize_headers_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2348,21 +2348,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
 
     DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
     DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_0_e;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(4)
+        .SetReturn(HTTP_HEADERS_ERROR);
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2377,7 +2367,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
         TestBufferHandle);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_STRING_PROCESSING_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
 
@@ -2387,8 +2377,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_before_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__heads_buffer_out_of_memory_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2401,23 +2391,13 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_bef
 
     DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
     DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_00_e;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Serialize(requestHttpHeaders, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
+        .IgnoreArgument(2).IgnoreArgument(4);
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    whenShallmalloc_fail = currentmalloc_call + 1;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -2432,7 +2412,58 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_bef
         TestBufferHandle);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_STRING_PROCESSING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+
+    /// cleanup
+    whenShallmalloc_fail = 0;
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_Deinit();
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_11_001: [ The HTTPAPI_ExecuteRequest shall send the request line, the headers serialized by HTTPHeaders_Serialize and the empty line that closes them in a single xio_send. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_line_headers_and_empty_line_are_sent_together_succeed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+
+    setHttpCertificate(httpHandle);
+    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
+    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
+    DoworkJobsReceivedBuffer_counter = 0;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
+    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
+    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+
+    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
+
+    xio_send_transmited_buffer_target = 1;
+    (void)memset(xio_send_transmited_buffer, 0, sizeof(xio_send_transmited_buffer));
+
+    /// act
+    result = HTTPAPI_ExecuteRequest(
+        httpHandle,
+        HTTPAPI_REQUEST_GET,
+        "/path",
+        requestHttpHeaders,
+        TEST_EXECUTE_REQUEST_CONTENT,
+        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
+        &statusCode,
+        responseHttpHeaders,
+        TestBufferHandle);
+
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "GET /path HTTP/1.1\r\n0123456789\r\n0123456789\r\n\r\n", xio_send_transmited_buffer);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
 
@@ -2463,6 +2494,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_timeout_failed)
     call_on_send_complete_in_xio_send = false;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupSerializeHeadsSequence(requestHttpHeaders);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     SkipDoworkJobsSendResult = 200;
@@ -2474,6 +2506,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_timeout_failed)
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
 
     HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
 
@@ -2521,6 +2555,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_retry_n_and_failed
     call_on_send_complete_in_xio_send = false;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupSerializeHeadsSequence(requestHttpHeaders);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     SkipDoworkJobsSendResult = 10;
@@ -2532,6 +2567,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_retry_n_and_failed
     }
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
 
     HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
 
@@ -2572,33 +2609,12 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_buffer_complete_with_error_failed)
 
     DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
     DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_6ok_error;
-    xio_send_shallReturn = (const int*)xio_send_6x0_e;
+    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
+    xio_send_shallReturn = (const int*)xio_send_0_e;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    setupSendHeadsSequence(requestHttpHeaders);
 
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
@@ -3178,6 +3194,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_send_succeed)
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
+    setupSerializeHeadsSequence(requestHttpHeaders);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     SkipDoworkJobsSendResult = 199;
@@ -3187,41 +3204,8 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_send_succeed)
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
     }
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
 
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
@@ -3596,7 +3580,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_with_content_succeed)
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
     HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    xio_send_transmited_buffer_target = 2;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3643,32 +3627,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_NULL_content_succeed)
     DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    setupSendHeadsSequence(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
     HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    xio_send_transmited_buffer_target = 2;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3716,32 +3679,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_content_size_0_succeed)
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    setupSendHeadsSequence(requestHttpHeaders);
     setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
 
     HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    xio_send_transmited_buffer_target = 2;
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3836,28 +3778,7 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_responseHeadersHandle_s
 
     setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    setupSendHeadsSequence(requestHttpHeaders);
     STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
     STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
@@ -244,6 +244,7 @@ extern "C"
 
     /* insertion */
     int real_VECTOR_push_back(VECTOR_HANDLE handle, const void* elements, size_t numElements);
+    void* real_VECTOR_emplace_back(VECTOR_HANDLE handle, size_t numElements);
 
     /* removal */
     void real_VECTOR_erase(VECTOR_HANDLE handle, void* elements, size_t numElements);
@@ -469,6 +470,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_move, real_VECTOR_move);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_destroy, real_VECTOR_destroy);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_push_back, real_VECTOR_push_back);
+    REGISTER_GLOBAL_MOCK_HOOK(VECTOR_emplace_back, real_VECTOR_emplace_back);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_erase, real_VECTOR_erase);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_clear, real_VECTOR_clear);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_element, real_VECTOR_element);
@@ -2834,9 +2836,8 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_happy_path_without_httpapi_handle_succeeds)
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)) /*this is adding the optionName, value*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1)) /*this is adding the optionName, value*/
+        .IgnoreArgument(1);
 
     /// act
     result = HTTPAPIEX_SetOption(httpapiexhandle, "someOption", "333");
@@ -2866,9 +2867,8 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_happy_path_without_httpapi_handle_can_save_2_o
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption1"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
+        .IgnoreArgument(1);
 
     EXPECTED_CALL(HTTPAPI_CloneOption("someOption2", (void*)"33", IGNORED_PTR_ARG));  /*this asks lower HTTPAPI to create a clone of the option*/
 
@@ -2877,9 +2877,8 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_happy_path_without_httpapi_handle_can_save_2_o
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption2"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
+        .IgnoreArgument(1);
 
     /// act
     result1 = HTTPAPIEX_SetOption(httpapiexhandle, "someOption1", (void*)"3");
@@ -3053,7 +3052,7 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_passes_saved_options_to_httpapi_ignores_errors
 }
 
 /*Tests_SRS_HTTPAPIEX_02_041: [If creating or updating the pair optionName/value fails then shall return HTTPAPIEX_ERROR.] */
-TEST_FUNCTION(HTTPAPIEX_SetOption_fails_when_VECTOR_push_back_fails)
+TEST_FUNCTION(HTTPAPIEX_SetOption_fails_when_VECTOR_emplace_back_fails)
 {
     /// arrange
 	HTTPAPIEX_RESULT result;
@@ -3067,10 +3066,9 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_fails_when_VECTOR_push_back_fails)
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption2"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
         .IgnoreArgument(1)
-        .IgnoreArgument(2)
-        .SetReturn(1);
+        .SetReturn(NULL);
 
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -3190,9 +3188,8 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_passes_saved_options_to_existing_httpapi_handl
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
+        .IgnoreArgument(1);
 
     EXPECTED_CALL(HTTPAPI_SetOption(IGNORED_PTR_ARG, "someOption", "3"));
 
@@ -3234,9 +3231,8 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_passes_saved_options_to_existing_httpapi_handl
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
+        .IgnoreArgument(1);
 
     EXPECTED_CALL(HTTPAPI_SetOption(IGNORED_PTR_ARG, "someOption", "3"))
         .SetReturn(HTTPAPI_INVALID_ARG);
@@ -3279,9 +3275,8 @@ TEST_FUNCTION(HTTPAPIEX_SetOption_passes_saved_options_to_existing_httpapi_handl
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption"))
         .IgnoreArgument(1); /*this is creating a clone of the optionName*/
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1)) /*this is increasing the array of options by 1*/
+        .IgnoreArgument(1);
 
     EXPECTED_CALL(HTTPAPI_SetOption(IGNORED_PTR_ARG, "someOption", "3"))
         .SetReturn(HTTPAPI_ALLOC_FAILED);
@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <climits>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
 #endif
 
 static size_t currentmalloc_call = 0;
@@ -71,25 +73,6 @@ void my_gballoc_free(void* ptr)
 
 #define ENABLE_MOCKS
 
-#include "azure_c_shared_utility/map.h"
-
-MAP_HANDLE my_Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
-{
-    (void)mapFilterFunc;
-    return (MAP_HANDLE)malloc(1);
-}
-
-MAP_HANDLE my_Map_Clone(MAP_HANDLE handle)
-{
-    (void)handle;
-    return (MAP_HANDLE)malloc(1);
-}
-
-void my_Map_Destroy(MAP_HANDLE handle)
-{
-    free(handle);
-}
-
 #include "azure_c_shared_utility/gballoc.h"
 
 #undef ENABLE_MOCKS
@@ -104,9 +87,6 @@ static TEST_MUTEX_HANDLE g_testByTest;
 TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 
-TEST_DEFINE_ENUM_TYPE(MAP_RESULT, MAP_RESULT_VALUES);
-IMPLEMENT_UMOCK_C_ENUM_TYPE(MAP_RESULT, MAP_RESULT_VALUES);
-
 /*test assets*/
 #define NAME1 "name1"
 #define VALUE1 "value1"
@@ -119,6 +99,9 @@ static const char *NAME1_TRICK3 = "name1: value1";
 #define VALUE2 "value2"
 #define HEADER2 NAME2 ": " VALUE2
 
+/*has to match HTTP_HEADERS_INITIAL_CAPACITY in httpheaders.c*/
+#define TEST_INITIAL_CAPACITY 8
+
 #define TEMP_BUFFER_SIZE 1024
 static char tempBuffer[TEMP_BUFFER_SIZE];
 
@@ -135,6 +118,17 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
     ASSERT_FAIL(temp_str);
 }
 
+/*the first header added to a collection allocates the headers array, the hash index and the "name: value" line*/
+static void setup_first_header_add_calls(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+}
+
 BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
 
         TEST_SUITE_INITIALIZE(TestClassInitialize)
@@ -151,17 +145,6 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             result = umocktypes_charptr_register_types();
             ASSERT_ARE_EQUAL(int, 0, result);
 
-            REGISTER_TYPE(MAP_RESULT, MAP_RESULT);
-            REGISTER_UMOCK_ALIAS_TYPE(MAP_FILTER_CALLBACK, void*);
-            REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
-
-            REGISTER_GLOBAL_MOCK_HOOK(Map_Create, my_Map_Create);
-            REGISTER_GLOBAL_MOCK_HOOK(Map_Clone, my_Map_Clone);
-            REGISTER_GLOBAL_MOCK_HOOK(Map_Destroy, my_Map_Destroy);
-            REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
-            REGISTER_GLOBAL_MOCK_RETURN(Map_GetValueFromKey, VALUE1);
-            REGISTER_GLOBAL_MOCK_RETURN(Map_GetInternals, MAP_OK);
-
             REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
             REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
             REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
@@ -198,15 +181,14 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
 
 
         /*Tests_SRS_HTTP_HEADERS_99_002:[ This API shall produce a HTTP_HANDLE that can later be used in subsequent calls to the module.]*/
+        /*Tests_SRS_HTTP_HEADERS_11_001: [ Storage for the headers shall only be allocated when the first header is added. ]*/
         TEST_FUNCTION(HTTPHeaders_Alloc_happy_path_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE handle;
+            HTTP_HEADERS_HANDLE handle;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
-            STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
-
             ///act
             handle = HTTPHeaders_Alloc();
 
@@ -223,7 +205,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_Alloc_fails_when_malloc_fails)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE httpHandle;
+            HTTP_HEADERS_HANDLE httpHandle;
             whenShallmalloc_fail = currentmalloc_call + 1;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
@@ -256,8 +238,8 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTP_HEADERS_HANDLE handle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG))
-                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(NULL));
+            STRICT_EXPECTED_CALL(gballoc_free(NULL));
             STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
                 .IgnoreArgument(1);
 
@@ -268,25 +250,30 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
-
-        /*Tests_SRS_HTTP_HEADERS_99_003:[ The function shall return NULL when the function cannot execute properly]*/
-        TEST_FUNCTION(HTTPHeaders_Alloc_fails_when_Map_Create_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_005:[ Calling this API shall de-allocate the data structures allocated by previous API calls to the same handle.]*/
+        TEST_FUNCTION(HTTPHeaders_Free_with_2_headers_frees_every_header)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE httpHandle;
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG))
-                .SetReturn(NULL);
+            HTTP_HEADERS_HANDLE handle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(handle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(handle, NAME2, VALUE2);
+            umock_c_reset_all_calls();
 
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
             STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
                 .IgnoreArgument(1);
 
             ///act
-            httpHandle = HTTPHeaders_Alloc();
+            HTTPHeaders_Free(handle);
 
             ///assert
-            ASSERT_IS_NULL(httpHandle);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
@@ -294,16 +281,11 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_Alloc_succeeds_and_GetHeaderCount_returns_0)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             size_t nHeaders;
-            size_t zero = 0;
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreAllArguments()
-                .CopyOutArgumentBuffer(4, &zero, sizeof(zero));
-
             ///act
             res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
 
@@ -321,16 +303,11 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_happy_path_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
-                .IgnoreArgument(1);
+            setup_first_header_add_calls();
 
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
@@ -339,28 +316,50 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-            //checking content
-
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Codes_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
-        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_Map_AddOrUpdate_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_growing_the_headers_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+                .IgnoreArgument(2)
+                .SetReturn(NULL);
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 0, nHeaders);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
 
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_allocating_the_hash_index_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1)
-                .SetReturn(MAP_ERROR);
+                .SetReturn(NULL);
 
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
@@ -368,8 +367,37 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 0, nHeaders);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_fails_when_malloc_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+                .IgnoreArgument(2);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER1)))
+                .SetReturn(NULL);
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
 
-            //checking content
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 0, nHeaders);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -379,16 +407,12 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
-                .IgnoreArgument(1);
+            setup_first_header_add_calls();
 
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
@@ -396,15 +420,14 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-            //checking content
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER1, headerValue);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
+            free(headerValue);
         }
 
-        
-
         /*Tests_SRS_HTTP_HEADERS_99_014:[ The function shall return when the handle is not valid or when name parameter is NULL or when value parameter is NULL.]*/
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_NULL_handle_fails)
         {
@@ -422,7 +445,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_NULL_name_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -441,7 +464,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_NULL_value_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -460,24 +483,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_appends_to_existing_value_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1 ", " VALUE1))
-                .IgnoreArgument(1);
-
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER1 ", " VALUE1)));
             STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
                 .IgnoreArgument(1);
 
@@ -487,43 +499,29 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1 ", " VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_015:[ The function shall return HTTP_HEADERS_ALLOC_FAILED when an internal request to allocate memory fails.]*/
-        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_appends_fails_when_Map_AddOrUpdate_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_017:[ If the name already exists in the collection of headers, the function shall concatenate the new value after the existing value, separated by a comma and a space as in: old-value+", "+new-value.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_appends_value_found_in_the_collection_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1 ", " VALUE1))
-                .IgnoreArgument(1)
-                .SetReturn(MAP_ERROR);
-
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-                .IgnoreArgument(1);
-
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
-            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1 ", " VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -533,21 +531,14 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_same_Name_fails_when_gballoc_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-
-            whenShallmalloc_fail = currentmalloc_call + 1;
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
+                .IgnoreArgument(1)
+                .SetReturn(NULL);
 
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
@@ -555,6 +546,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ALLOC_FAILED, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -564,27 +556,61 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_add_two_headers_produces_two_headers)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER2)));
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_012:[ Calling this API shall record a header from name and value parameters.]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_past_the_initial_capacity_grows_the_storage)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t i;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            for (i = 0; i < TEST_INITIAL_CAPACITY; i++)
+            {
+                (void)sprintf(tempBuffer, "name%u", (unsigned int)i);
+                (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, tempBuffer, VALUE1);
+            }
+            umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME2, VALUE2))
+            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+                .IgnoreAllArguments();
+            STRICT_EXPECTED_CALL(gballoc_malloc(4 * TEST_INITIAL_CAPACITY * sizeof(size_t)));
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "last", VALUE2);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, TEST_INITIAL_CAPACITY + 1, nHeaders);
+            for (i = 0; i < TEST_INITIAL_CAPACITY; i++)
+            {
+                (void)sprintf(tempBuffer, "name%u", (unsigned int)i);
+                ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, tempBuffer));
+            }
+            ASSERT_ARE_EQUAL(char_ptr, VALUE2, HTTPHeaders_FindHeaderValue(httpHandle, "last"));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -594,19 +620,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_When_Second_Added_Header_Is_A_Substring_Of_An_Existing_Header_2_Headers_Are_Added)
         {
             ///arrange
-			HTTP_HEADERS_RESULT result;
+            HTTP_HEADERS_RESULT result;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "ab"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "ab", VALUE1);
             umock_c_reset_all_calls();
-            
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
 
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "a", VALUE1))
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
 
             ///act
@@ -615,9 +635,38 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, result);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_11_002: [ Header names shall be compared case insensitive. ]*/
+        /*Tests_SRS_HTTP_HEADERS_11_003: [ When the name already exists, the stored name shall keep the casing it was first added with. ]*/
+        TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_differently_cased_Name_appends_to_existing_value)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            char* headerValue;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "Content-Type", VALUE1);
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "content-TYPE", VALUE2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            (void)HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, "Content-Type: " VALUE1 ", " VALUE2, headerValue);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
+            free(headerValue);
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_022:[ The return value shall be NULL if name parameter is NULL or if httpHeadersHandle is NULL]*/
@@ -637,7 +686,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_with_NULL_name_returns_NULL)
         {
             ///arrange
-			const char* res;
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
@@ -657,22 +706,16 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_retrieves_previously_stored_value_succeeds)
         {
             ///arrange
-			const char* res1;
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1);
-
             ///act
-            res1 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
+            res = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
 
             ///assert
-            ASSERT_ARE_EQUAL(char_ptr, VALUE1, res1);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
@@ -684,26 +727,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_retrieves_previously_stored_value_for_two_headers_succeeds)
         {
             ///arrange
-			const char* res1;
-			const char* res2;
+            const char* res1;
+            const char* res2;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE2);
-
             ///act
             res1 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
             res2 = HTTPHeaders_FindHeaderValue(httpHandle, NAME2);
@@ -718,89 +748,56 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_018:[ Calling this API shall retrieve the value for a previously stored name.]*/
-        /*Tests_SRS_HTTP_HEADERS_99_021:[ In this case the return value shall point to a string that shall strcmp equal to the original stored string.]*/
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_retrieves_concatenation_of_previously_stored_values_for_header_name_succeeds)
         {
-			const char* res;
+            ///arrange
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1); /*this key exists, was added above*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1 ", " VALUE2);
-
             ///act
             res = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
 
             ///assert
-            ASSERT_ARE_EQUAL(char_ptr,VALUE1 ", " VALUE2, res);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1 ", " VALUE2, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.]*/
-        /*actually we are trying to see that finding a nonexisting value produces NULL*/
+        /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.] */
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_returns_NULL_for_nonexistent_value)
         {
             ///arrange
-			const char* res2;
+            const char* res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-
             ///act
-            res2 = HTTPHeaders_FindHeaderValue(httpHandle, NAME2);
+            res = HTTPHeaders_FindHeaderValue(httpHandle, NAME1);
 
             ///assert
-            ASSERT_IS_NULL(res2);
+            ASSERT_IS_NULL(res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*trying to catch some errors here*/
-        /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.]*/
+        /*Tests_SRS_HTTP_HEADERS_99_020:[ The return value shall be different than NULL when the name matches the name of a previously stored name:value pair.] */
         TEST_FUNCTION(HTTPHeaders_FindHeaderValue_with_nonexistent_header_succeeds)
         {
             ///arrange
-			const char* res1;
-			const char* res2;
-			const char* res3;
+            const char* res1;
+            const char* res2;
+            const char* res3;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1_TRICK1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1_TRICK2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1_TRICK3))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-
             ///act
             res1 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1_TRICK1);
             res2 = HTTPHeaders_FindHeaderValue(httpHandle, NAME1_TRICK2);
@@ -816,23 +813,37 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTPHeaders_Free(httpHandle);
         }
 
-        /* Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
+        /*Tests_SRS_HTTP_HEADERS_11_002: [ Header names shall be compared case insensitive. ]*/
+        TEST_FUNCTION(HTTPHeaders_FindHeaderValue_is_case_insensitive)
+        {
+            ///arrange
+            const char* res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "Content-Length", "42");
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_FindHeaderValue(httpHandle, "CONTENT-length");
+
+            ///assert
+            ASSERT_ARE_EQUAL(char_ptr, "42", res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
         TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn(VALUE1); /*this key does not exist, the line below is adding it*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE2))
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(NAME1 ": " VALUE2)));
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
                 .IgnoreArgument(1);
 
             ///act
@@ -841,49 +852,69 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE2, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /* Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
+        /*Tests_SRS_HTTP_HEADERS_06_001: [This API will perform exactly as HTTPHeaders_AddHeaderNameValuePair except that if the header name already exists the already existing value will be replaced as opposed to concatenated to.] */
         TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_for_none_existing_header_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL);
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE2))
-                .IgnoreArgument(1);
+            setup_first_header_add_calls();
 
             ///act
-            res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, NAME1, VALUE2);
+            res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, NAME1, VALUE1);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_11_002: [ Header names shall be compared case insensitive. ]*/
+        /*Tests_SRS_HTTP_HEADERS_11_003: [ When the name already exists, the stored name shall keep the casing it was first added with. ]*/
+        TEST_FUNCTION(HTTPHeaders_ReplaceHeaderNameValuePair_with_differently_cased_Name_replaces_the_value)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "Host", VALUE1);
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_ReplaceHeaderNameValuePair(httpHandle, "HOST", VALUE2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, "Host: " VALUE2, headerValue);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
+            free(headerValue);
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_024:[ The function shall return HTTP_HEADERS_INVALID_ARG when an invalid handle is passed.]*/
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_NULL_handle_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
             size_t nHeaders;
 
             ///act
-            res1 = HTTPHeaders_GetHeaderCount(NULL, &nHeaders);
+            HTTP_HEADERS_RESULT res = HTTPHeaders_GetHeaderCount(NULL, &nHeaders);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
@@ -891,156 +922,227 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_NULL_headersCount_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
             ///act
-            res1 = HTTPHeaders_GetHeaderCount(httpHandle, NULL);
+            res = HTTPHeaders_GetHeaderCount(httpHandle, NULL);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
         /*Tests_SRS_HTTP_HEADERS_99_023:[ Calling this API shall provide the number of stored headers.]*/
-        /*Tests_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
+        /*Tests_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
         TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_1_header_produces_1)
         {
             ///arrange
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
             size_t nHeaders;
-            const char* keys[] = { "NAME1" }; 
-            const char* values[] = { "VALUE1" }; 
-            const char* const ** pKeys = (const char* const **)&keys; 
-            const char* const ** pValues = (const char* const **)&values;
-            const size_t one = 1;
-			HTTP_HEADERS_RESULT res;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
+            ///act
+            res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
 
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(size_t, 1, nHeaders);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_023:[ Calling this API shall provide the number of stored headers.]*/
+        /*Tests_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_2_header_produces_2)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t nHeaders;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
+            umock_c_reset_all_calls();
 
             ///act
             res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
-            
+
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
-            ASSERT_ARE_EQUAL(size_t, (size_t)1, nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_037:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs.]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeaderCount_fails_when_Map_GetInternals_fails)
+        /*Tests_SRS_HTTP_HEADERS_99_028:[ The function shall return HTTP_HEADERS_INVALID_ARG if the handle is invalid.]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeader_with_NULL_handle_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            char* headerValue;
+
+            ///act
+            HTTP_HEADERS_RESULT res = HTTPHeaders_GetHeader(NULL, 0, &headerValue);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_032:[ The function shall return HTTP_HEADERS_INVALID_ARG if the destination  is NULL]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeader_with_NULL_buffer_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            size_t nHeaders;
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreAllArguments()
-                .SetReturn(MAP_ERROR);
-
             ///act
-            res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            res = HTTPHeaders_GetHeader(httpHandle, 0, NULL);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeader_with_index_too_big_fails_1)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_026:[ The function shall write in *headersCount the number of currently stored headers and shall return HTTP_HEADERS_OK]*/
-        /*Tests_SRS_HTTP_HEADERS_99_023:[ Calling this API shall provide the number of stored headers.]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeaderCount_with_2_header_produces_2)
+        /*Tests_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeader_with_index_too_big_fails_2)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            size_t nHeaders;
-            const char* keys[2] = { "NAME1", "NAME2" };
-            const char* values[2] = { "VALUE1", "VALUE2" };
-            const char* const ** pKeys = (const char* const **)&keys;
-            const char* const ** pValues = (const char* const **)&values;
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            umock_c_reset_all_calls();
 
-            const size_t two = 2;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
+            ///act
+            res = HTTPHeaders_GetHeader(httpHandle, 1, &headerValue);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_027:[ Calling this API shall produce the string value+": "+pair) for the index header in the *destination parameter.]*/
+        /*Tests_SRS_HTTP_HEADERS_99_035:[ The function shall return HTTP_HEADERS_OK when the function executed without error.]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_1)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res2;
+            char* headerValue1;
+            char* headerValue2;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME2))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER1)));
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER2)));
+
+            ///act
+            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue1);
+            res2 = HTTPHeaders_GetHeader(httpHandle, 1, &headerValue2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res2);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER1, headerValue1);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER2, headerValue2);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+            free(headerValue1);
+            free(headerValue2);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_fails_when_malloc_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            char* headerValue;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &two, sizeof(two));
+                .SetReturn(NULL);
 
             ///act
-            res = HTTPHeaders_GetHeaderCount(httpHandle, &nHeaders);
+            res = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
-            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
-            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls()); 
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_028:[ The function shall return NULL if the handle is invalid.]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_with_NULL_handle_fails)
+        /*Tests_SRS_HTTP_HEADERS_11_004: [ If handle is NULL or header is NULL then HTTPHeaders_GetHeaderSpan shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderSpan_with_NULL_handle_fails)
         {
             ///arrange
-            char* headerValue;
+            HTTP_HEADER_SPAN header;
 
             ///act
-            HTTP_HEADERS_RESULT res = HTTPHeaders_GetHeader(NULL, 0, &headerValue);
+            HTTP_HEADERS_RESULT res = HTTPHeaders_GetHeaderSpan(NULL, 0, &header);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_032:[ The function shall return HTTP_HEADERS_INVALID_ARG if the destination  is NULL]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_with_NULL_buffer_fails)
+        /*Tests_SRS_HTTP_HEADERS_11_004: [ If handle is NULL or header is NULL then HTTPHeaders_GetHeaderSpan shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderSpan_with_NULL_header_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
             ///act
-            res = HTTPHeaders_GetHeader(httpHandle, 0, NULL);
+            res = HTTPHeaders_GetHeaderSpan(httpHandle, 0, NULL);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
@@ -1050,198 +1152,210 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
-        /*Tests that not adding something to the collection fails tso retrieve for index 0*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_with_index_too_big_fails_1)
+        /*Tests_SRS_HTTP_HEADERS_11_005: [ If index is not smaller than the number of stored headers then HTTPHeaders_GetHeaderSpan shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderSpan_with_index_too_big_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADER_SPAN header;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            char* headerValue;
-            const char* thisIsNULL = NULL;
-            const char* zero = 0;
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &thisIsNULL, sizeof(thisIsNULL))
-                .CopyOutArgumentBuffer(3, &thisIsNULL, sizeof(thisIsNULL))
-                .CopyOutArgumentBuffer(4, &zero, sizeof(zero));
-
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_GetHeaderSpan(httpHandle, 1, &header);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_029:[ The function shall return HTTP_HEADERS_INVALID_ARG if index is not valid (for example, out of range) for the currently stored headers.]*/
-        /*Tests that not adding something to the collection fails tso retrieve for index 0*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_with_index_too_big_fails_2)
+        /*Tests_SRS_HTTP_HEADERS_11_006: [ Otherwise HTTPHeaders_GetHeaderSpan shall fill header with pointers into the stored name, value and name+": "+value line, without allocating memory, and return HTTP_HEADERS_OK. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderSpan_succeeds_without_allocating)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADER_SPAN header;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            const char* keys[1] = { "NAME1" };
-            const char* values[1] = { "VALUE1" };
-            const char* const ** pKeys = (const char* const **)&keys;
-            const char* const ** pValues = (const char* const **)&values;
-            const size_t one = 1;
-            char* headerValue;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
             (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
-
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 1, &headerValue);
+            res = HTTPHeaders_GetHeaderSpan(httpHandle, 1, &header);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(size_t, sizeof(NAME2) - 1, header.nameLength);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(header.name, NAME2, header.nameLength));
+            ASSERT_ARE_EQUAL(size_t, sizeof(VALUE2) - 1, header.valueLength);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE2, header.value);
+            ASSERT_ARE_EQUAL(size_t, sizeof(HEADER2) - 1, header.lineLength);
+            ASSERT_ARE_EQUAL(char_ptr, HEADER2, header.line);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_027:[ Calling this API shall produce the string value+": "+pair) for the index header in the buffer pointed to by buffer.]*/
-        /*Tests_SRS_HTTP_HEADERS_99_035:[ The function shall return HTTP_HEADERS_OK when the function executed without error.]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_1)
+        /*Tests_SRS_HTTP_HEADERS_11_007: [ If handle is NULL or serializedSize is NULL then HTTPHeaders_Serialize shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_handle_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res1;
+            size_t serializedSize;
+
+            ///act
+            HTTP_HEADERS_RESULT res = HTTPHeaders_Serialize(NULL, tempBuffer, sizeof(tempBuffer), &serializedSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_11_007: [ If handle is NULL or serializedSize is NULL then HTTPHeaders_Serialize shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_serializedSize_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            char* headerValue;
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { "b" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", "b");
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, tempBuffer, sizeof(tempBuffer), NULL);
 
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_11_008: [ If destination is NULL and destinationSize is not 0 then HTTPHeaders_Serialize shall fail and return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_destination_and_non_zero_size_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
 
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_Serialize(httpHandle, NULL, 1, &serializedSize);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res1);
-            ASSERT_ARE_EQUAL(char_ptr, "a: b", headerValue);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
-            free(headerValue);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_fails_when_Map_GetInternals_fails)
+        /*Tests_SRS_HTTP_HEADERS_11_009: [ HTTPHeaders_Serialize shall write in *serializedSize the number of bytes needed to hold every header as name+": "+value+"\r\n". ]*/
+        /*Tests_SRS_HTTP_HEADERS_11_010: [ If destinationSize is smaller than that then HTTPHeaders_Serialize shall return HTTP_HEADERS_INSUFFICIENT_BUFFER without writing to destination. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_NULL_destination_returns_the_needed_size)
         {
             ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            char* headerValue;
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { "b" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-			HTTP_HEADERS_RESULT res1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", "b");
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one))
-                .SetReturn(MAP_ERROR);
-
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_Serialize(httpHandle, NULL, 0, &serializedSize);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INSUFFICIENT_BUFFER, res);
+            ASSERT_ARE_EQUAL(size_t, sizeof(HEADER1 "\r\n" HEADER2 "\r\n") - 1, serializedSize);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_034:[ The function shall return HTTP_HEADERS_ERROR when an internal error occurs]*/
-        TEST_FUNCTION(HTTPHeaders_GetHeader_succeeds_fails_when_malloc_fails)
+        /*Tests_SRS_HTTP_HEADERS_11_010: [ If destinationSize is smaller than that then HTTPHeaders_Serialize shall return HTTP_HEADERS_INSUFFICIENT_BUFFER without writing to destination. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_small_destination_fails)
         {
             ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
-            char* headerValue;
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { "b" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-			HTTP_HEADERS_RESULT res1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", "b");
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)memset(tempBuffer, 'x', sizeof(tempBuffer));
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, tempBuffer, sizeof(HEADER1 "\r\n") - 2, &serializedSize);
 
-            whenShallmalloc_fail = currentmalloc_call + 1;
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INSUFFICIENT_BUFFER, res);
+            ASSERT_ARE_EQUAL(size_t, sizeof(HEADER1 "\r\n") - 1, serializedSize);
+            ASSERT_ARE_EQUAL(int, (int)'x', (int)tempBuffer[0]);
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_11_011: [ Otherwise HTTPHeaders_Serialize shall write all the headers in insertion order in a single pass, without a terminating '\0', and return HTTP_HEADERS_OK. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_succeeds)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME2, VALUE2);
+            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, VALUE2);
+            umock_c_reset_all_calls();
 
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_Serialize(httpHandle, tempBuffer, sizeof(tempBuffer), &serializedSize);
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res1);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            ASSERT_ARE_EQUAL(size_t, sizeof(HEADER1 ", " VALUE2 "\r\n" HEADER2 "\r\n") - 1, serializedSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(HEADER1 ", " VALUE2 "\r\n" HEADER2 "\r\n", tempBuffer, serializedSize));
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_11_011: [ Otherwise HTTPHeaders_Serialize shall write all the headers in insertion order in a single pass, without a terminating '\0', and return HTTP_HEADERS_OK. ]*/
+        TEST_FUNCTION(HTTPHeaders_Serialize_with_no_headers_succeeds)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            size_t serializedSize;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_Serialize(httpHandle, NULL, 0, &serializedSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(size_t, 0, serializedSize);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
-            free(headerValue);
         }
 
         /*Tests_SRS_HTTP_HEADERS_99_031:[ If name contains the character ":" then the return value shall be HTTP_HEADERS_INVALID_ARG.]*/
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_colon_in_name_fails)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
             ///act
-            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a:", "b");
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a:", VALUE1);
 
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
@@ -1251,40 +1365,25 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTPHeaders_Free(httpHandle);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_99_031:[ If name contains the character ":" then the return value shall be HTTP_HEADERS_INVALID_ARG.]*/
+        /*Tests_SRS_HTTP_HEADERS_99_016:[ The function shall store the name:value pair in such a way that when later retrieved by a call to GetHeader it will return a string that shall strcmp equal to the name+": "+value.]*/
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_colon_in_value_succeeds_1)
         {
             ///arrange
-            const char* keys[1] = { "a" };
-            const char** pKeys = &keys[0];
-            const char* values[1] = { ":" };
-            const char** pValues = &values[0];
-            const size_t one = 1;
-            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            HTTP_HEADERS_RESULT res;
             char* headerValue;
-			HTTP_HEADERS_RESULT res1;
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "a"))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist, the line below is adding it*/
-            (void)HTTPHeaders_AddHeaderNameValuePair(httpHandle, "a", ":");
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument(1)
-                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
-                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
-                .CopyOutArgumentBuffer(4, &one, sizeof(one));
-
-            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
+            setup_first_header_add_calls();
 
             ///act
-            res1 = HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, ":");
 
             ///assert
-            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res1);
-            ASSERT_ARE_EQUAL(char_ptr, "a: :", headerValue);
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            (void)HTTPHeaders_GetHeader(httpHandle, 0, &headerValue);
+            ASSERT_ARE_EQUAL(char_ptr, NAME1 ": :", headerValue);
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -1298,15 +1397,15 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///arrange
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             char unacceptableString[2]={'\0', '\0'};
-			int c;
-            
+            int c;
+
             for(c=SCHAR_MIN;c <=SCHAR_MAX; c++)
             {
                 if(c=='\0') continue;
 
                 if((c<33) ||( 126<c)|| (c==':'))
                 {
-					HTTP_HEADERS_RESULT res;
+                    HTTP_HEADERS_RESULT res;
 
                     /*so it is an unacceptable character*/
                     unacceptableString[0]=(char)c;
@@ -1327,16 +1426,11 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_LWS_value_stores_without_LWS_characters_succeeds)
         {
             ///arrange
-			HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_RESULT res;
             HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
-            STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, NAME1))
-                .IgnoreArgument(1)
-                .SetReturn((const char*)NULL); /*this key does not exist*/
-
-            STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, NAME1, VALUE1))
-                .IgnoreArgument(1);
+            setup_first_header_add_calls();
 
             ///act
             res = HTTPHeaders_AddHeaderNameValuePair(httpHandle, NAME1, " \r\t\n" VALUE1); /*notice how there are some LWS characters in the value*/
@@ -1344,8 +1438,7 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             ///assert
             ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
             ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-            //checking content
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(httpHandle, NAME1));
 
             ///cleanup
             HTTPHeaders_Free(httpHandle);
@@ -1368,14 +1461,12 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
         TEST_FUNCTION(HTTPHEADERS_Clone_happy_path)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE result;
             HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG))
-                .IgnoreArgument(1);
 
             ///act
             result = HTTPHeaders_Clone(source);
@@ -1389,19 +1480,67 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             HTTPHeaders_Free(result);
         }
 
-        /*Tests_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
-        TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_map_clone_fails)
+        /*Tests_SRS_HTTP_HEADERS_02_004: [Otherwise HTTPHeaders_Clone shall clone the content of handle to a new handle.*/
+        TEST_FUNCTION(HTTPHEADERS_Clone_with_2_headers_copies_the_headers)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE result;
+            size_t nHeaders;
             HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME2, VALUE2);
             umock_c_reset_all_calls();
 
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG))
-                .IgnoreArgument(1).SetReturn(NULL);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER1)));
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER2)));
+
+            ///act
+            result = HTTPHeaders_Clone(source);
+
+            ///assert
+            ASSERT_IS_NOT_NULL(result);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            HTTPHeaders_Free(source);
+            (void)HTTPHeaders_GetHeaderCount(result, &nHeaders);
+            ASSERT_ARE_EQUAL(size_t, 2, nHeaders);
+            ASSERT_ARE_EQUAL(char_ptr, VALUE1, HTTPHeaders_FindHeaderValue(result, NAME1));
+            ASSERT_ARE_EQUAL(char_ptr, VALUE2, HTTPHeaders_FindHeaderValue(result, NAME2));
+
+            ///cleanup
+            HTTPHeaders_Free(result);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
+        TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_copying_a_header_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME1, VALUE1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(source, NAME2, VALUE2);
+            umock_c_reset_all_calls();
 
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER1)));
+            STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(HEADER2)))
+                .SetReturn(NULL);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
             STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
                 .IgnoreArgument(1);
 
@@ -1414,14 +1553,13 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
 
             ///cleanup
             HTTPHeaders_Free(source);
-            HTTPHeaders_Free(result);
         }
 
         /*Tests_SRS_HTTP_HEADERS_02_005: [If cloning fails for any reason, then HTTPHeaders_Clone shall return NULL.] */
         TEST_FUNCTION(HTTPHEADERS_Clone_fails_when_gballoc_fails)
         {
             ///arrange
-			HTTP_HEADERS_HANDLE result;
+            HTTP_HEADERS_HANDLE result;
             HTTP_HEADERS_HANDLE source = HTTPHeaders_Alloc();
             umock_c_reset_all_calls();
 
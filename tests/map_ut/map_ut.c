@@ -147,6 +147,9 @@ static const char* TEST_BLUEVALUE = "cyan";
 static const char* TEST_GREENKEY = "testgreenkey";
 static const char* TEST_GREENVALUE = "green";
 
+/*matches the default MAP_HASH_INDEX_THRESHOLD in map.c*/
+#define TEST_HASH_INDEX_THRESHOLD 8
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
@@ -549,10 +552,7 @@ BEGIN_TEST_SUITE(map_unittests)
         /*below are undo actions*/
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*undo copy of blue key*/
             .ValidateArgumentBuffer(1, TEST_BLUEKEY, strlen(TEST_BLUEKEY) + 1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing keys*/
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing values*/
-            .IgnoreArgument(1);
+        /*storage is not shrunk back*/
 
 
         ///act
@@ -605,10 +605,7 @@ BEGIN_TEST_SUITE(map_unittests)
         STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEKEY) + 1)); /*copy of blue key*/
 
         /*below are undo actions*/
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing keys*/
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing values*/
-            .IgnoreArgument(1);
+        /*storage is not shrunk back*/
 
 
         ///act
@@ -659,8 +656,7 @@ BEGIN_TEST_SUITE(map_unittests)
             .IgnoreArgument(1);
 
         /*below are undo actions*/
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing keys*/
-            .IgnoreArgument(1);
+        /*keys storage is not shrunk back*/
 
         ///act
         result1 = Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
@@ -1109,10 +1105,7 @@ BEGIN_TEST_SUITE(map_unittests)
         /*below are undo actions*/
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*undo blue key value*/
             .ValidateArgumentBuffer(1, TEST_BLUEKEY, strlen(TEST_BLUEKEY) + 1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing keys*/
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing values*/
-            .IgnoreArgument(1);
+        /*storage is not shrunk back*/
 
         ///act
         result1 = Map_AddOrUpdate(handle, TEST_REDKEY, TEST_REDVALUE);
@@ -1158,10 +1151,7 @@ BEGIN_TEST_SUITE(map_unittests)
         STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEKEY) + 1)); /*copy of red key*/
 
         /*below are undo actions*/
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing keys*/
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing values*/
-            .IgnoreArgument(1);
+        /*storage is not shrunk back*/
 
         ///act
         result1 = Map_AddOrUpdate(handle, TEST_REDKEY, TEST_REDVALUE);
@@ -1206,8 +1196,7 @@ BEGIN_TEST_SUITE(map_unittests)
             .IgnoreArgument(1);
 
         /*below are undo actions*/
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*undo growing keys*/
-            .IgnoreArgument(1);
+        /*keys storage is not shrunk back*/
 
         ///act
         result1 = Map_AddOrUpdate(handle, TEST_REDKEY, TEST_REDVALUE);
@@ -1692,11 +1681,7 @@ BEGIN_TEST_SUITE(map_unittests)
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*freeing yellow value*/
             .ValidateArgumentBuffer(1, TEST_YELLOWVALUE, strlen(TEST_YELLOWVALUE) + 1);
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1* sizeof(const char*))) /*ungrowing values*/
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*ungrowing keys*/
-            .IgnoreArgument(1);
+        /*Tests_SRS_MAP_11_002: [ Removing a pair shall not shrink the storage of the map unless the map becomes empty. ]*/
 
         ///act
         result1 = Map_Delete(handle, TEST_YELLOWKEY);
@@ -1735,11 +1720,7 @@ BEGIN_TEST_SUITE(map_unittests)
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*freeing yellow value*/
             .ValidateArgumentBuffer(1, TEST_REDVALUE, strlen(TEST_REDVALUE) + 1);
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*ungrowing values*/
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1 * sizeof(const char*))) /*ungrowing keys*/
-            .IgnoreArgument(1);
+        /*Tests_SRS_MAP_11_002: [ Removing a pair shall not shrink the storage of the map unless the map becomes empty. ]*/
 
         ///act
         result1 = Map_Delete(handle, TEST_REDKEY);
@@ -3853,5 +3834,259 @@ BEGIN_TEST_SUITE(map_unittests)
         Map_Destroy(handle);
     }
 
-    
+
+    /*Tests_SRS_MAP_11_001: [ When the storage of the map is full, it shall be grown to twice its capacity. ]*/
+    TEST_FUNCTION(Map_Add_grows_storage_geometrically)
+    {
+        ///arrange
+        MAP_RESULT result1;
+        MAP_RESULT result2;
+        MAP_HANDLE handle = Map_Create(NULL);
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        (void)Map_Add(handle, TEST_BLUEKEY, TEST_BLUEVALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 4 * sizeof(const char*))) /*growing keys*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 4 * sizeof(const char*))) /*growing values*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_YELLOWKEY) + 1)); /*copy of yellow key*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_YELLOWVALUE) + 1)); /*copy of yellow value*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_GREENKEY) + 1)); /*copy of green key, no growing*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_GREENVALUE) + 1)); /*copy of green value*/
+
+        ///act
+        result1 = Map_Add(handle, TEST_YELLOWKEY, TEST_YELLOWVALUE);
+        result2 = Map_Add(handle, TEST_GREENKEY, TEST_GREENVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result1);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_11_003: [ Once a map can hold MAP_HASH_INDEX_THRESHOLD pairs, lookups by key shall go through a hash index and shall not scan all the keys. ]*/
+    TEST_FUNCTION(Map_Add_builds_the_hash_index_when_growing_to_the_threshold)
+    {
+        ///arrange
+        MAP_RESULT result;
+        size_t i;
+        char key[20];
+        MAP_HANDLE handle = Map_Create(NULL);
+        for (i = 0; i < TEST_HASH_INDEX_THRESHOLD / 2; i++)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)Map_Add(handle, key, TEST_REDVALUE);
+        }
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, TEST_HASH_INDEX_THRESHOLD * sizeof(const char*))) /*growing keys*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, TEST_HASH_INDEX_THRESHOLD * sizeof(const char*))) /*growing values*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * TEST_HASH_INDEX_THRESHOLD * sizeof(size_t))); /*hash index*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEKEY) + 1)); /*copy of blue key*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEVALUE) + 1)); /*copy of blue value*/
+
+        ///act
+        result = Map_Add(handle, TEST_BLUEKEY, TEST_BLUEVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEVALUE, Map_GetValueFromKey(handle, TEST_BLUEKEY));
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, "key0"));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_11_004: [ If the hash index cannot be allocated, the map shall keep working by searching the keys linearly. ]*/
+    TEST_FUNCTION(Map_Add_succeeds_when_the_hash_index_cannot_be_allocated)
+    {
+        ///arrange
+        MAP_RESULT result;
+        size_t i;
+        char key[20];
+        MAP_HANDLE handle = Map_Create(NULL);
+        for (i = 0; i < TEST_HASH_INDEX_THRESHOLD / 2; i++)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)Map_Add(handle, key, TEST_REDVALUE);
+        }
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, TEST_HASH_INDEX_THRESHOLD * sizeof(const char*))) /*growing keys*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, TEST_HASH_INDEX_THRESHOLD * sizeof(const char*))) /*growing values*/
+            .IgnoreArgument(1);
+        whenShallmalloc_fail = currentmalloc_call + 1;
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * TEST_HASH_INDEX_THRESHOLD * sizeof(size_t))); /*hash index*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEKEY) + 1)); /*copy of blue key*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEVALUE) + 1)); /*copy of blue value*/
+
+        ///act
+        result = Map_Add(handle, TEST_BLUEKEY, TEST_BLUEVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEVALUE, Map_GetValueFromKey(handle, TEST_BLUEKEY));
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, "key3"));
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_11_003: [ Once a map can hold MAP_HASH_INDEX_THRESHOLD pairs, lookups by key shall go through a hash index and shall not scan all the keys. ]*/
+    /*Tests_SRS_MAP_02_023: [Otherwise, Map_Delete shall remove the key and its associated value from the map and return MAP_OK.] */
+    TEST_FUNCTION(Map_with_many_pairs_keeps_insertion_order_and_finds_all_keys_after_deletes)
+    {
+        ///arrange
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+        size_t i;
+        char key[20];
+        char value[20];
+        MAP_HANDLE handle = Map_Create(NULL);
+        for (i = 0; i < 100; i++)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)sprintf(value, "value%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(handle, key, value));
+        }
+
+        ///act
+        for (i = 0; i < 100; i += 3)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Delete(handle, key));
+        }
+
+        ///assert
+        for (i = 0; i < 100; i++)
+        {
+            const char* found;
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)sprintf(value, "value%u", (unsigned int)i);
+            found = Map_GetValueFromKey(handle, key);
+            if (i % 3 == 0)
+            {
+                ASSERT_IS_NULL(found);
+            }
+            else
+            {
+                ASSERT_ARE_EQUAL(char_ptr, value, found);
+            }
+        }
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_GetInternals(handle, &keys, &values, &count));
+        ASSERT_ARE_EQUAL(size_t, 66, count);
+        ASSERT_ARE_EQUAL(char_ptr, "key1", keys[0]);
+        ASSERT_ARE_EQUAL(char_ptr, "key2", keys[1]);
+        ASSERT_ARE_EQUAL(char_ptr, "key4", keys[2]);
+        ASSERT_ARE_EQUAL(char_ptr, "value98", values[65]);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_11_005: [ Removing a pair shall leave an empty slot in its place and the empty slots shall only be removed once they are more than half of the remaining pairs, so that removing is O(1) on average. ]*/
+    TEST_FUNCTION(Map_Delete_only_frees_the_pair_and_Map_Add_reuses_the_empty_slots)
+    {
+        ///arrange
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+        size_t i;
+        char key[20];
+        MAP_HANDLE handle = Map_Create(NULL);
+        for (i = 0; i < 32; i++)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)Map_Add(handle, key, TEST_REDVALUE);
+        }
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*key5*/
+            .ValidateArgumentBuffer(1, "key5", 5);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*value of key5*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEKEY) + 1)); /*copy of blue key, the storage is full but has an empty slot*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_BLUEVALUE) + 1)); /*copy of blue value*/
+
+        ///act
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Delete(handle, "key5"));
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(handle, TEST_BLUEKEY, TEST_BLUEVALUE));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_IS_NULL(Map_GetValueFromKey(handle, "key5"));
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, "key31"));
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEVALUE, Map_GetValueFromKey(handle, TEST_BLUEKEY));
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_GetInternals(handle, &keys, &values, &count));
+        ASSERT_ARE_EQUAL(size_t, 32, count);
+        ASSERT_ARE_EQUAL(char_ptr, "key4", keys[4]);
+        ASSERT_ARE_EQUAL(char_ptr, "key6", keys[5]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_BLUEKEY, keys[31]);
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
+    /*Tests_SRS_MAP_11_005: [ Removing a pair shall leave an empty slot in its place and the empty slots shall only be removed once they are more than half of the remaining pairs, so that removing is O(1) on average. ]*/
+    TEST_FUNCTION(Map_interleaved_adds_and_deletes_keep_all_keys_findable)
+    {
+        ///arrange
+        size_t i;
+        char key[20];
+        char value[20];
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+        MAP_HANDLE clone;
+        MAP_HANDLE handle = Map_Create(NULL);
+
+        ///act
+        for (i = 0; i < 300; i++)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)sprintf(value, "value%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Add(handle, key, value));
+            if (i % 2 == 1)
+            {
+                (void)sprintf(key, "key%u", (unsigned int)(i / 2));
+                ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_Delete(handle, key));
+            }
+        }
+        clone = Map_Clone(handle);
+
+        ///assert
+        for (i = 0; i < 300; i++)
+        {
+            (void)sprintf(key, "key%u", (unsigned int)i);
+            (void)sprintf(value, "value%u", (unsigned int)i);
+            if (i < 150)
+            {
+                ASSERT_IS_NULL(Map_GetValueFromKey(handle, key));
+                ASSERT_IS_NULL(Map_GetValueFromKey(clone, key));
+            }
+            else
+            {
+                ASSERT_ARE_EQUAL(char_ptr, value, Map_GetValueFromKey(handle, key));
+                ASSERT_ARE_EQUAL(char_ptr, value, Map_GetValueFromKey(clone, key));
+            }
+        }
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, Map_GetInternals(handle, &keys, &values, &count));
+        ASSERT_ARE_EQUAL(size_t, 150, count);
+        ASSERT_ARE_EQUAL(char_ptr, "key150", keys[0]);
+        ASSERT_ARE_EQUAL(char_ptr, "value299", values[149]);
+
+        ///cleanup
+        Map_Destroy(clone);
+        Map_Destroy(handle);
+    }
+
 END_TEST_SUITE(map_unittests)
@@ -36,6 +36,7 @@ static void my_gballoc_free(void* s)
 #define VECTOR_move real_VECTOR_move
 #define VECTOR_destroy real_VECTOR_destroy
 #define VECTOR_push_back real_VECTOR_push_back 
+#define VECTOR_emplace_back real_VECTOR_emplace_back 
 #define VECTOR_erase real_VECTOR_erase 
 #define VECTOR_clear real_VECTOR_clear 
 #define VECTOR_element real_VECTOR_element 
@@ -43,11 +44,16 @@ static void my_gballoc_free(void* s)
 #define VECTOR_back real_VECTOR_back 
 #define VECTOR_find_if real_VECTOR_find_if 
 #define VECTOR_size real_VECTOR_size 
+#define VECTOR_capacity real_VECTOR_capacity 
+#define VECTOR_reserve real_VECTOR_reserve 
+#define VECTOR_shrink_to_fit real_VECTOR_shrink_to_fit 
+#define VECTOR_resize real_VECTOR_resize 
 #include "../src/vector.c"
 #undef VECTOR_create
 #undef VECTOR_move
 #undef VECTOR_destroy
 #undef VECTOR_push_back 
+#undef VECTOR_emplace_back 
 #undef VECTOR_erase 
 #undef VECTOR_clear 
 #undef VECTOR_element 
@@ -55,6 +61,10 @@ static void my_gballoc_free(void* s)
 #undef VECTOR_back 
 #undef VECTOR_find_if 
 #undef VECTOR_size 
+#undef VECTOR_capacity 
+#undef VECTOR_reserve 
+#undef VECTOR_shrink_to_fit 
+#undef VECTOR_resize 
 #undef VECTOR_H
 #undef GBALLOC_H
 #undef CRT_ABSTRACTIONS_H
@@ -129,8 +139,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(VECTOR_create, NULL);
 
         REGISTER_GLOBAL_MOCK_HOOK(VECTOR_size, real_VECTOR_size);
-        REGISTER_GLOBAL_MOCK_HOOK(VECTOR_push_back, real_VECTOR_push_back);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(VECTOR_push_back, __FAILURE__);
+        REGISTER_GLOBAL_MOCK_HOOK(VECTOR_emplace_back, real_VECTOR_emplace_back);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(VECTOR_emplace_back, NULL);
 
         REGISTER_GLOBAL_MOCK_HOOK(VECTOR_element, real_VECTOR_element);
 
@@ -348,9 +358,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("TrustedCerts", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
 
         ///act
         result = OptionHandler_Clone(source);
@@ -394,9 +403,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("TrustedCerts", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle();
@@ -404,9 +412,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("option_2", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
 
         ///act
         result = OptionHandler_Clone(source);
@@ -587,10 +594,9 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("TrustedCerts", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle()
-            .IgnoreArgument_elements()
-            .SetReturn(1);
+            .SetReturn(NULL);
 
         EXPECTED_CALL(aDestroyOption("TrustedCerts", IGNORED_PTR_ARG));
         EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -635,9 +641,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("TrustedCerts", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle();
@@ -690,9 +695,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("TrustedCerts", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle();
@@ -748,9 +752,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("TrustedCerts", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle();
@@ -758,10 +761,9 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("option_2", IGNORED_PTR_ARG))
             .IgnoreArgument_value();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
             .IgnoreArgument_handle()
-            .IgnoreArgument_elements()
-            .SetReturn(1);
+            .SetReturn(NULL);
 
         EXPECTED_CALL(aDestroyOption("option_2", IGNORED_PTR_ARG));
         EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -839,9 +841,8 @@ BEGIN_TEST_SUITE(optionhandler_unittests)
             .IgnoreArgument_destination();
         STRICT_EXPECTED_CALL(aCloneOption("name", value))
             .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_elements();
+        STRICT_EXPECTED_CALL(VECTOR_emplace_back(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_handle();
     }
 
     /*Tests_SRS_OPTIONHANDLER_02_006: [ OptionHandler_AddOption shall call pfCloneOption passing name and value. ]*/
@@ -18,6 +18,9 @@
 #define BUFFER_append_build real_BUFFER_append_build
 #define BUFFER_shrink real_BUFFER_shrink
 #define BUFFER_fill real_BUFFER_fill
+#define BUFFER_reserve real_BUFFER_reserve
+#define BUFFER_capacity real_BUFFER_capacity
+#define BUFFER_shrink_to_fit real_BUFFER_shrink_to_fit
 
 #define GBALLOC_H
 
@@ -4,6 +4,7 @@
 #define singlylinkedlist_create real_singlylinkedlist_create
 #define singlylinkedlist_destroy real_singlylinkedlist_destroy
 #define singlylinkedlist_add real_singlylinkedlist_add
+#define singlylinkedlist_add_head real_singlylinkedlist_add_head
 #define singlylinkedlist_remove real_singlylinkedlist_remove
 #define singlylinkedlist_get_head_item real_singlylinkedlist_get_head_item
 #define singlylinkedlist_get_next_item real_singlylinkedlist_get_next_item
@@ -11,6 +12,7 @@
 #define singlylinkedlist_item_get_value real_singlylinkedlist_item_get_value
 #define singlylinkedlist_remove_if real_singlylinkedlist_remove_if
 #define singlylinkedlist_foreach real_singlylinkedlist_foreach
+#define singlylinkedlist_set_max_free_nodes real_singlylinkedlist_set_max_free_nodes
 
 #define GBALLOC_H
 
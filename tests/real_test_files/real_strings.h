@@ -38,7 +38,9 @@
     REGISTER_GLOBAL_MOCK_HOOK(STRING_length, real_STRING_length); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_compare, real_STRING_compare); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_replace, real_STRING_replace); \
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_replace, __LINE__);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_replace, __LINE__); \
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_reserve, real_STRING_reserve); \
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_reserve, __LINE__);
 
 #define STRING_new                      real_STRING_new 
 #define STRING_clone                    real_STRING_clone 
@@ -59,6 +61,7 @@
 #define STRING_length                   real_STRING_length 
 #define STRING_compare                  real_STRING_compare 
 #define STRING_replace                  real_STRING_replace
+#define STRING_reserve                  real_STRING_reserve
 
 
 #undef STRINGS_H
@@ -85,6 +88,7 @@
 #undef STRING_length               
 #undef STRING_compare              
 #undef STRING_replace              
+#undef STRING_reserve              
 
 #endif
 
@@ -5,6 +5,7 @@
 #define VECTOR_move real_VECTOR_move
 #define VECTOR_destroy real_VECTOR_destroy
 #define VECTOR_push_back real_VECTOR_push_back
+#define VECTOR_emplace_back real_VECTOR_emplace_back
 #define VECTOR_erase real_VECTOR_erase
 #define VECTOR_clear real_VECTOR_clear
 #define VECTOR_element real_VECTOR_element
@@ -12,6 +13,10 @@
 #define VECTOR_back real_VECTOR_back
 #define VECTOR_find_if real_VECTOR_find_if
 #define VECTOR_size real_VECTOR_size
+#define VECTOR_capacity real_VECTOR_capacity
+#define VECTOR_reserve real_VECTOR_reserve
+#define VECTOR_shrink_to_fit real_VECTOR_shrink_to_fit
+#define VECTOR_resize real_VECTOR_resize
 
 #define GBALLOC_H
 
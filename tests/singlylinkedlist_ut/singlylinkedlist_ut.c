@@ -689,6 +689,7 @@ TEST_FUNCTION(singlylinkedlist_find_on_a_list_with_no_items_yields_NULL)
 /* singlylinkedlist_remove */
 
 /* Tests_SRS_LIST_01_023: [singlylinkedlist_remove shall remove a list item from the list and on success it shall return 0.] */
+/* Tests_SRS_LIST_11_008: [ Removed nodes shall be kept in the free node pool while the pool holds fewer nodes than its high-water mark, otherwise they shall be freed. ]*/
 TEST_FUNCTION(singlylinkedlist_remove_when_one_item_is_in_the_list_succeeds)
 {
     // arrange
@@ -700,8 +701,6 @@ TEST_FUNCTION(singlylinkedlist_remove_when_one_item_is_in_the_list_succeeds)
     item = singlylinkedlist_find(list, test_match_function, TEST_CONTEXT);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
     // act
     result = singlylinkedlist_remove(list, item);
 
@@ -776,6 +775,7 @@ TEST_FUNCTION(singlylinkedlist_remove_with_an_item_that_has_already_been_removed
 }
 
 /* Tests_SRS_LIST_01_023: [singlylinkedlist_remove shall remove a list item from the list and on success it shall return 0.] */
+/* Tests_SRS_LIST_11_008: [ Removed nodes shall be kept in the free node pool while the pool holds fewer nodes than its high-water mark, otherwise they shall be freed. ]*/
 TEST_FUNCTION(singlylinkedlist_remove_first_of_2_items_succeeds)
 {
     // arrange
@@ -785,8 +785,6 @@ TEST_FUNCTION(singlylinkedlist_remove_first_of_2_items_succeeds)
     LIST_ITEM_HANDLE item1 = singlylinkedlist_add(list, &x1);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
     // act
     result = singlylinkedlist_remove(list, item1);
 
@@ -799,6 +797,7 @@ TEST_FUNCTION(singlylinkedlist_remove_first_of_2_items_succeeds)
 }
 
 /* Tests_SRS_LIST_01_023: [singlylinkedlist_remove shall remove a list item from the list and on success it shall return 0.] */
+/* Tests_SRS_LIST_11_008: [ Removed nodes shall be kept in the free node pool while the pool holds fewer nodes than its high-water mark, otherwise they shall be freed. ]*/
 TEST_FUNCTION(singlylinkedlist_remove_second_of_2_items_succeeds)
 {
     // arrange
@@ -811,8 +810,6 @@ TEST_FUNCTION(singlylinkedlist_remove_second_of_2_items_succeeds)
     item2 = singlylinkedlist_add(list, &x2);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
     // act
     result = singlylinkedlist_remove(list, item2);
 
@@ -1086,8 +1083,6 @@ TEST_FUNCTION(singlylinkedlist_remove_if_all_items_succeeds)
     (void)singlylinkedlist_add(list, &values[4]);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
 
     // act
     result = singlylinkedlist_remove_if(list, removeif_condition_function, &profile);
@@ -1131,7 +1126,6 @@ TEST_FUNCTION(singlylinkedlist_remove_if_break_succeeds)
     (void)singlylinkedlist_add(list, &values[4]);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
 
     // act
     result = singlylinkedlist_remove_if(list, removeif_condition_function, &profile);
@@ -1175,8 +1169,6 @@ TEST_FUNCTION(singlylinkedlist_remove_if_remove_and_break_succeeds)
     (void)singlylinkedlist_add(list, &values[4]);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
 
     // act
     result = singlylinkedlist_remove_if(list, removeif_condition_function, &profile);
@@ -1215,7 +1207,6 @@ TEST_FUNCTION(singlylinkedlist_remove_if_removes_the_only_item_in_the_list)
     (void)singlylinkedlist_add(list, &values[0]);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
 
     // act
     result = singlylinkedlist_remove_if(list, removeif_condition_function, &profile);
@@ -1228,4 +1219,246 @@ TEST_FUNCTION(singlylinkedlist_remove_if_removes_the_only_item_in_the_list)
     singlylinkedlist_destroy(list);
 }
 
+/* singlylinkedlist_add_head */
+
+/* Tests_SRS_LIST_11_004: [ If any of the arguments is NULL, singlylinkedlist_add_head shall not add the item to the list and return NULL. ]*/
+TEST_FUNCTION(singlylinkedlist_add_head_with_NULL_handle_fails)
+{
+    // arrange
+    int x = 42;
+    LIST_ITEM_HANDLE result;
+
+    // act
+    result = singlylinkedlist_add_head(NULL, &x);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_LIST_11_004: [ If any of the arguments is NULL, singlylinkedlist_add_head shall not add the item to the list and return NULL. ]*/
+TEST_FUNCTION(singlylinkedlist_add_head_with_NULL_item_fails)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    LIST_ITEM_HANDLE result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = singlylinkedlist_add_head(list, NULL);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_11_003: [ singlylinkedlist_add_head shall add one item to the head of the list and on success it shall return a handle to the added item. ]*/
+TEST_FUNCTION(singlylinkedlist_add_head_adds_the_item_before_the_existing_items)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x1 = 42;
+    int x2 = 43;
+    int x3 = 44;
+    LIST_ITEM_HANDLE result;
+    LIST_ITEM_HANDLE list_item;
+
+    (void)singlylinkedlist_add(list, &x1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = singlylinkedlist_add_head(list, &x2);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    list_item = singlylinkedlist_get_head_item(list);
+    ASSERT_ARE_EQUAL(void_ptr, result, list_item);
+    ASSERT_ARE_EQUAL(int, x2, *(const int*)singlylinkedlist_item_get_value(list_item));
+    list_item = singlylinkedlist_get_next_item(list_item);
+    ASSERT_ARE_EQUAL(int, x1, *(const int*)singlylinkedlist_item_get_value(list_item));
+
+    /* the tail is still the first item, so appending goes after it */
+    (void)singlylinkedlist_add(list, &x3);
+    list_item = singlylinkedlist_get_next_item(list_item);
+    ASSERT_ARE_EQUAL(int, x3, *(const int*)singlylinkedlist_item_get_value(list_item));
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_11_003: [ singlylinkedlist_add_head shall add one item to the head of the list and on success it shall return a handle to the added item. ]*/
+TEST_FUNCTION(singlylinkedlist_add_head_on_an_empty_list_sets_the_tail)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x1 = 42;
+    int x2 = 43;
+    LIST_ITEM_HANDLE list_item;
+
+    // act
+    (void)singlylinkedlist_add_head(list, &x1);
+    (void)singlylinkedlist_add(list, &x2);
+
+    // assert
+    list_item = singlylinkedlist_get_head_item(list);
+    ASSERT_ARE_EQUAL(int, x1, *(const int*)singlylinkedlist_item_get_value(list_item));
+    list_item = singlylinkedlist_get_next_item(list_item);
+    ASSERT_ARE_EQUAL(int, x2, *(const int*)singlylinkedlist_item_get_value(list_item));
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_11_006: [ If allocating the new list node fails, singlylinkedlist_add_head shall return NULL. ]*/
+TEST_FUNCTION(when_the_underlying_malloc_fails_singlylinkedlist_add_head_fails)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x = 42;
+    LIST_ITEM_HANDLE result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn((void*)NULL);
+
+    // act
+    result = singlylinkedlist_add_head(list, &x);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_IS_NULL(singlylinkedlist_get_head_item(list));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* free node pool */
+
+/* Tests_SRS_LIST_11_002: [ singlylinkedlist_add shall take the node from the free node pool when the pool is not empty, otherwise it shall allocate it. ]*/
+/* Tests_SRS_LIST_11_005: [ singlylinkedlist_add_head shall take the node from the free node pool when the pool is not empty, otherwise it shall allocate it. ]*/
+TEST_FUNCTION(singlylinkedlist_add_reuses_a_removed_node_without_allocating)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x1 = 42;
+    int x2 = 43;
+    LIST_ITEM_HANDLE item1;
+    LIST_ITEM_HANDLE item2;
+
+    item1 = singlylinkedlist_add(list, &x1);
+    (void)singlylinkedlist_remove(list, item1);
+    umock_c_reset_all_calls();
+
+    // act
+    item2 = singlylinkedlist_add_head(list, &x2);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, item1, item2);
+    ASSERT_ARE_EQUAL(int, x2, *(const int*)singlylinkedlist_item_get_value(singlylinkedlist_get_head_item(list)));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_11_008: [ Removed nodes shall be kept in the free node pool while the pool holds fewer nodes than its high-water mark, otherwise they shall be freed. ]*/
+TEST_FUNCTION(singlylinkedlist_remove_frees_the_node_when_the_pool_is_full)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x1 = 42;
+    int x2 = 43;
+    LIST_ITEM_HANDLE item1;
+    LIST_ITEM_HANDLE item2;
+
+    (void)singlylinkedlist_set_max_free_nodes(list, 1);
+    item1 = singlylinkedlist_add(list, &x1);
+    item2 = singlylinkedlist_add(list, &x2);
+    (void)singlylinkedlist_remove(list, item1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(item2));
+
+    // act
+    (void)singlylinkedlist_remove(list, item2);
+
+    // assert
+    ASSERT_IS_NULL(singlylinkedlist_get_head_item(list));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
+/* Tests_SRS_LIST_01_003: [singlylinkedlist_destroy shall free all resources associated with the list identified by the handle argument.] */
+TEST_FUNCTION(singlylinkedlist_destroy_frees_the_pooled_nodes)
+{
+    // arrange
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    int x1 = 42;
+    LIST_ITEM_HANDLE item1 = singlylinkedlist_add(list, &x1);
+    (void)singlylinkedlist_remove(list, item1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(item1));
+    STRICT_EXPECTED_CALL(gballoc_free(list));
+
+    // act
+    singlylinkedlist_destroy(list);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* singlylinkedlist_set_max_free_nodes */
+
+/* Tests_SRS_LIST_11_009: [ If list is NULL, singlylinkedlist_set_max_free_nodes shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(singlylinkedlist_set_max_free_nodes_with_NULL_list_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = singlylinkedlist_set_max_free_nodes(NULL, 4);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_LIST_11_010: [ singlylinkedlist_set_max_free_nodes shall set the high-water mark of the free node pool to max_free_nodes; 0 disables pooling. ]*/
+/* Tests_SRS_LIST_11_011: [ singlylinkedlist_set_max_free_nodes shall free the pooled nodes that exceed the new high-water mark and return 0. ]*/
+TEST_FUNCTION(singlylinkedlist_set_max_free_nodes_to_0_releases_the_pool)
+{
+    // arrange
+    int result;
+    int x1 = 42;
+    SINGLYLINKEDLIST_HANDLE list = singlylinkedlist_create();
+    LIST_ITEM_HANDLE item1 = singlylinkedlist_add(list, &x1);
+    (void)singlylinkedlist_remove(list, item1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(item1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = singlylinkedlist_set_max_free_nodes(list, 0);
+    item1 = singlylinkedlist_add(list, &x1);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(item1);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    singlylinkedlist_destroy(list);
+}
+
 END_TEST_SUITE(singlylinkedlist_unittests)
@@ -2,31 +2,1870 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #else
+#include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #endif
 
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netdb.h>
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
 #include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "azure_c_shared_utility/macro_utils.h"
 
 #define ENABLE_MOCKS
 
 #include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/socketio_reactor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, int, socket, int, af, int, type, int, protocol);
+    MOCKABLE_FUNCTION(, int, setsockopt, int, sockfd, int, level, int, optname, const void*, optval, socklen_t, optlen);
+    MOCKABLE_FUNCTION(, int, getaddrinfo, const char*, node, const char*, service, const struct addrinfo*, hints, struct addrinfo**, res);
+    MOCKABLE_FUNCTION(, void, freeaddrinfo, struct addrinfo*, res);
+    MOCKABLE_FUNCTION(, int, connect, int, sockfd, const struct sockaddr*, addr, socklen_t, addrlen);
+    MOCKABLE_FUNCTION(, ssize_t, sendmsg, int, sockfd, const struct msghdr*, msg, int, flags);
+    MOCKABLE_FUNCTION(, ssize_t, recv, int, sockfd, void*, buf, size_t, len, int, flags);
+    MOCKABLE_FUNCTION(, int, shutdown, int, sockfd, int, how);
+    MOCKABLE_FUNCTION(, int, close, int, sockfd);
+#ifdef __cplusplus
+}
+#endif
 
 #undef ENABLE_MOCKS
 
 #include "azure_c_shared_utility/socketio.h"
+#include "azure_c_shared_utility/shared_util_options.h"
 
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <netdb.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // fcntl is only used to make the socket non blocking
+    int fcntl(int fd, int cmd, ... /* arg */) { (void)fd; (void)cmd; return 0; }
+#ifdef __cplusplus
+}
+#endif
+
+#define TEST_SOCKET             4242
+#define TEST_PORT               443
+#define TEST_PORT_STRING        "443"
+#define TEST_MAX_CALLS          8
+
+#ifdef MSG_NOSIGNAL
+#define TEST_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define TEST_SEND_FLAGS 0
+#endif
+
+static const char* TEST_HOSTNAME = "test.hostname";
+static const SINGLYLINKEDLIST_HANDLE TEST_PENDING_IO_LIST = (SINGLYLINKEDLIST_HANDLE)0x4243;
+static const SOCKETIO_REACTOR_HANDLE TEST_REACTOR = (SOCKETIO_REACTOR_HANDLE)0x4244;
+static const SOCKETIO_REACTOR_HANDLE TEST_REACTOR_2 = (SOCKETIO_REACTOR_HANDLE)0x4245;
+static const SOCKETIO_REACTOR_REGISTRATION_HANDLE TEST_REGISTRATION = (SOCKETIO_REACTOR_REGISTRATION_HANDLE)0x4246;
+static void* TEST_CALLBACK_CONTEXT = (void*)0x4247;
+static const unsigned char TEST_BYTES[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A };
+
+TEST_DEFINE_ENUM_TYPE(IO_SEND_RESULT, IO_SEND_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(IO_SEND_RESULT, IO_SEND_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* the pending IO list is a plain linked list so that the queue order can be checked */
+typedef struct TEST_LIST_ITEM_TAG
+{
+    const void* value;
+    struct TEST_LIST_ITEM_TAG* next;
+} TEST_LIST_ITEM;
+
+static TEST_LIST_ITEM* test_list_head;
+
+static struct sockaddr test_sock_addr;
+static struct addrinfo test_addr_info;
+
+static ON_SOCKETIO_REACTOR_EVENT test_on_socket_event;
+static void* test_on_socket_event_context;
+
+static ssize_t test_sendmsg_results[TEST_MAX_CALLS];
+static size_t test_sendmsg_result_count;
+static size_t test_sendmsg_call_count;
+static size_t test_sendmsg_iov_counts[TEST_MAX_CALLS];
+static int test_sendmsg_errno;
+static unsigned char test_sent_bytes[256];
+static size_t test_sent_byte_count;
+
+static ssize_t test_recv_results[TEST_MAX_CALLS];
+static size_t test_recv_result_count;
+static size_t test_recv_call_count;
+static unsigned char test_recv_next_byte;
+
+static unsigned char test_received_bytes[1024];
+static size_t test_received_byte_count;
+
+static IO_OPEN_RESULT test_open_result;
+
+static SINGLYLINKEDLIST_HANDLE my_singlylinkedlist_create(void)
+{
+    test_list_head = NULL;
+    return TEST_PENDING_IO_LIST;
+}
+
+static void my_singlylinkedlist_destroy(SINGLYLINKEDLIST_HANDLE list)
+{
+    (void)list;
+    while (test_list_head != NULL)
+    {
+        TEST_LIST_ITEM* next = test_list_head->next;
+        my_gballoc_free(test_list_head);
+        test_list_head = next;
+    }
+}
+
+static LIST_ITEM_HANDLE my_singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void* item)
+{
+    TEST_LIST_ITEM* new_item = (TEST_LIST_ITEM*)my_gballoc_malloc(sizeof(TEST_LIST_ITEM));
+    (void)list;
+    if (new_item != NULL)
+    {
+        TEST_LIST_ITEM** last = &test_list_head;
+        while (*last != NULL)
+        {
+            last = &(*last)->next;
+        }
+
+        new_item->value = item;
+        new_item->next = NULL;
+        *last = new_item;
+    }
+
+    return (LIST_ITEM_HANDLE)new_item;
+}
+
+static int my_singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item_handle)
+{
+    int result = 1;
+    TEST_LIST_ITEM** current = &test_list_head;
+    (void)list;
+    while (*current != NULL)
+    {
+        if (*current == (TEST_LIST_ITEM*)item_handle)
+        {
+            TEST_LIST_ITEM* removed = *current;
+            *current = removed->next;
+            my_gballoc_free(removed);
+            result = 0;
+            break;
+        }
+
+        current = &(*current)->next;
+    }
+
+    return result;
+}
+
+static LIST_ITEM_HANDLE my_singlylinkedlist_get_head_item(SINGLYLINKEDLIST_HANDLE list)
+{
+    (void)list;
+    return (LIST_ITEM_HANDLE)test_list_head;
+}
+
+static LIST_ITEM_HANDLE my_singlylinkedlist_get_next_item(LIST_ITEM_HANDLE item_handle)
+{
+    return (LIST_ITEM_HANDLE)((TEST_LIST_ITEM*)item_handle)->next;
+}
+
+static const void* my_singlylinkedlist_item_get_value(LIST_ITEM_HANDLE item_handle)
+{
+    return ((TEST_LIST_ITEM*)item_handle)->value;
+}
+
+static int my_getaddrinfo(const char* node, const char* service, const struct addrinfo* hints, struct addrinfo** res)
+{
+    (void)node;
+    (void)service;
+    (void)hints;
+    test_addr_info.ai_addr = &test_sock_addr;
+    *res = &test_addr_info;
+    return 0;
+}
+
+static SOCKETIO_REACTOR_REGISTRATION_HANDLE my_socketio_reactor_register(SOCKETIO_REACTOR_HANDLE reactor, int fd, ON_SOCKETIO_REACTOR_EVENT on_event, void* on_event_context)
+{
+    (void)reactor;
+    (void)fd;
+    test_on_socket_event = on_event;
+    test_on_socket_event_context = on_event_context;
+    return TEST_REGISTRATION;
+}
+
+/* accepts the scripted number of bytes, everything when nothing is scripted, a negative result fails with test_sendmsg_errno */
+static ssize_t my_sendmsg(int sockfd, const struct msghdr* msg, int flags)
+{
+    ssize_t result;
+    size_t total = 0;
+    size_t i;
+    (void)sockfd;
+    (void)flags;
+
+    for (i = 0; i < (size_t)msg->msg_iovlen; i++)
+    {
+        total += msg->msg_iov[i].iov_len;
+    }
+
+    if (test_sendmsg_call_count < TEST_MAX_CALLS)
+    {
+        test_sendmsg_iov_counts[test_sendmsg_call_count] = (size_t)msg->msg_iovlen;
+    }
+
+    result = (test_sendmsg_call_count < test_sendmsg_result_count) ? test_sendmsg_results[test_sendmsg_call_count] : (ssize_t)total;
+    test_sendmsg_call_count++;
+
+    if (result < 0)
+    {
+        errno = test_sendmsg_errno;
+    }
+    else
+    {
+        size_t to_copy = (size_t)result;
+        for (i = 0; (i < (size_t)msg->msg_iovlen) && (to_copy > 0); i++)
+        {
+            size_t piece = (msg->msg_iov[i].iov_len < to_copy) ? msg->msg_iov[i].iov_len : to_copy;
+            (void)memcpy(test_sent_bytes + test_sent_byte_count, msg->msg_iov[i].iov_base, piece);
+            test_sent_byte_count += piece;
+            to_copy -= piece;
+        }
+    }
+
+    return result;
+}
+
+/* returns the scripted results filled with consecutive byte values, then fails with EAGAIN */
+static ssize_t my_recv(int sockfd, void* buf, size_t len, int flags)
+{
+    ssize_t result;
+    (void)sockfd;
+    (void)flags;
+
+    if (test_recv_call_count < test_recv_result_count)
+    {
+        result = test_recv_results[test_recv_call_count];
+    }
+    else
+    {
+        result = -1;
+    }
+    test_recv_call_count++;
+
+    if (result < 0)
+    {
+        errno = EAGAIN;
+    }
+    else
+    {
+        ssize_t i;
+        if ((size_t)result > len)
+        {
+            result = (ssize_t)len;
+        }
+
+        for (i = 0; i < result; i++)
+        {
+            ((unsigned char*)buf)[i] = test_recv_next_byte++;
+        }
+    }
+
+    return result;
+}
+
+static void queue_sendmsg_result(ssize_t result)
+{
+    test_sendmsg_results[test_sendmsg_result_count++] = result;
+}
+
+static void queue_recv_result(ssize_t result)
+{
+    test_recv_results[test_recv_result_count++] = result;
+}
+
+static void test_on_io_open_complete(void* context, IO_OPEN_RESULT_DETAILED open_result)
+{
+    (void)context;
+    test_open_result = open_result.result;
+}
+
+#define ENABLE_MOCKS
+
+MOCK_FUNCTION_WITH_CODE(, void, test_on_send_complete, void*, context, IO_SEND_RESULT, send_result)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_bytes_received, void*, context, const unsigned char*, buffer, size_t, size)
+    (void)memcpy(test_received_bytes + test_received_byte_count, buffer, size);
+    test_received_byte_count += size;
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_error, void*, context)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_low_water, void*, context)
+MOCK_FUNCTION_END()
+
+#undef ENABLE_MOCKS
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static CONCRETE_IO_HANDLE create_socketio(void)
+{
+    SOCKETIO_CONFIG config;
+    CONCRETE_IO_HANDLE result;
+
+    config.hostname = TEST_HOSTNAME;
+    config.port = TEST_PORT;
+    config.accepted_socket = NULL;
+
+    result = socketio_create(&config);
+    ASSERT_IS_NOT_NULL(result);
+    umock_c_reset_all_calls();
+
+    return result;
+}
+
+static int open_socketio(CONCRETE_IO_HANDLE socket_io)
+{
+    return socketio_open(socket_io, test_on_io_open_complete, TEST_CALLBACK_CONTEXT, test_on_bytes_received, TEST_CALLBACK_CONTEXT, test_on_io_error, TEST_CALLBACK_CONTEXT);
+}
+
+static CONCRETE_IO_HANDLE create_and_open_socketio(SOCKETIO_REACTOR_HANDLE reactor)
+{
+    CONCRETE_IO_HANDLE result = create_socketio();
+
+    if (reactor != NULL)
+    {
+        ASSERT_ARE_EQUAL(int, 0, socketio_setoption(result, OPTION_SOCKETIO_REACTOR, reactor));
+    }
+
+    ASSERT_ARE_EQUAL(int, 0, open_socketio(result));
+    umock_c_reset_all_calls();
+
+    return result;
+}
+
+static void setup_socketio_open_expectations(void)
+{
+    STRICT_EXPECTED_CALL(socket(AF_INET, SOCK_STREAM, 0));
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    STRICT_EXPECTED_CALL(setsockopt(TEST_SOCKET, SOL_SOCKET, SO_NOSIGPIPE, IGNORED_PTR_ARG, sizeof(int)));
+#endif
+    STRICT_EXPECTED_CALL(getaddrinfo(TEST_HOSTNAME, TEST_PORT_STRING, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(connect(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(freeaddrinfo(IGNORED_PTR_ARG));
+}
 
-TEST_MUTEX_HANDLE test_serialize_mutex;
+/* sends TEST_BYTES of which the socket only takes accepted_size, the rest stays queued */
+static void send_leaving_bytes_pending(CONCRETE_IO_HANDLE socket_io, size_t accepted_size)
+{
+    queue_sendmsg_result((ssize_t)accepted_size);
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT));
+    umock_c_reset_all_calls();
+}
 
 BEGIN_TEST_SUITE(socketio_berkeley_unittests)
 
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+    size_t type_size;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // Unnatural type_size variable exists to avoid "conditional expression is constant" warning
+    type_size = sizeof(ssize_t);
+    if (type_size == sizeof(int32_t))
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(ssize_t, int32_t);
+    }
+    else
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(ssize_t, int64_t);
+    }
+
+    type_size = sizeof(socklen_t);
+    if (type_size == sizeof(uint32_t))
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(socklen_t, uint32_t);
+    }
+    else
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(socklen_t, uint64_t);
+    }
+
+    REGISTER_TYPE(IO_SEND_RESULT, IO_SEND_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SOCKETIO_REACTOR_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SOCKETIO_REACTOR_REGISTRATION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SOCKETIO_REACTOR_EVENT, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_create, my_singlylinkedlist_create);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_destroy, my_singlylinkedlist_destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, my_singlylinkedlist_add);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_remove, my_singlylinkedlist_remove);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_head_item, my_singlylinkedlist_get_head_item);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_next_item, my_singlylinkedlist_get_next_item);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_item_get_value, my_singlylinkedlist_item_get_value);
+    REGISTER_GLOBAL_MOCK_RETURNS(socket, TEST_SOCKET, -1);
+    REGISTER_GLOBAL_MOCK_RETURNS(setsockopt, 0, -1);
+    REGISTER_GLOBAL_MOCK_HOOK(getaddrinfo, my_getaddrinfo);
+    REGISTER_GLOBAL_MOCK_RETURNS(connect, 0, -1);
+    REGISTER_GLOBAL_MOCK_HOOK(sendmsg, my_sendmsg);
+    REGISTER_GLOBAL_MOCK_HOOK(recv, my_recv);
+    REGISTER_GLOBAL_MOCK_RETURNS(shutdown, 0, -1);
+    REGISTER_GLOBAL_MOCK_RETURNS(close, 0, -1);
+    REGISTER_GLOBAL_MOCK_HOOK(socketio_reactor_register, my_socketio_reactor_register);
+    REGISTER_GLOBAL_MOCK_RETURNS(socketio_reactor_set_write_interest, 0, 1);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    umock_c_reset_all_calls();
+
+    test_on_socket_event = NULL;
+    test_on_socket_event_context = NULL;
+    test_sendmsg_result_count = 0;
+    test_sendmsg_call_count = 0;
+    test_sendmsg_errno = EAGAIN;
+    test_sent_byte_count = 0;
+    test_recv_result_count = 0;
+    test_recv_call_count = 0;
+    test_recv_next_byte = 0;
+    test_received_byte_count = 0;
+    test_open_result = IO_OPEN_CANCELLED;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+#ifndef __APPLE__
+
+/* socketio_open with a reactor */
+
+TEST_FUNCTION(socketio_open_with_a_reactor_registers_the_socket)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR));
+    umock_c_reset_all_calls();
+
+    setup_socketio_open_expectations();
+    STRICT_EXPECTED_CALL(socketio_reactor_register(TEST_REACTOR, TEST_SOCKET, IGNORED_PTR_ARG, socket_io));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+
+    // act
+    result = open_socketio(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, (int)IO_OPEN_OK, (int)test_open_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_open_closes_the_socket_and_fails_when_registering_with_the_reactor_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR));
+    umock_c_reset_all_calls();
+
+    setup_socketio_open_expectations();
+    STRICT_EXPECTED_CALL(socketio_reactor_register(TEST_REACTOR, TEST_SOCKET, IGNORED_PTR_ARG, socket_io))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+
+    // act
+    result = open_socketio(socket_io);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, (int)IO_OPEN_ERROR, (int)test_open_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socketio_setoption with OPTION_SOCKETIO_REACTOR */
+
+TEST_FUNCTION(socketio_setoption_reactor_registers_an_open_socketio)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int result;
+
+    STRICT_EXPECTED_CALL(socketio_reactor_register(TEST_REACTOR, TEST_SOCKET, IGNORED_PTR_ARG, socket_io));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_reactor_on_a_socketio_that_is_not_open_only_stores_the_reactor)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    int result;
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_reactor_moves_the_socket_to_the_new_reactor)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+    int result;
+
+    STRICT_EXPECTED_CALL(socketio_reactor_unregister(TEST_REGISTRATION));
+    STRICT_EXPECTED_CALL(socketio_reactor_register(TEST_REACTOR_2, TEST_SOCKET, IGNORED_PTR_ARG, socket_io));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR_2);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_reactor_fails_when_registering_with_the_reactor_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int result;
+
+    STRICT_EXPECTED_CALL(socketio_reactor_register(TEST_REACTOR, TEST_SOCKET, IGNORED_PTR_ARG, socket_io))
+        .SetReturn(NULL);
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_reactor_sets_the_write_interest_when_sends_are_pending)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int result;
+
+    send_leaving_bytes_pending(socket_io, 3);
+
+    STRICT_EXPECTED_CALL(socketio_reactor_register(TEST_REACTOR, TEST_SOCKET, IGNORED_PTR_ARG, socket_io));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(socketio_reactor_set_write_interest(TEST_REGISTRATION, true));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_REACTOR, TEST_REACTOR);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socketio_close and socketio_destroy with a reactor */
+
+TEST_FUNCTION(socketio_close_unregisters_the_socket_from_the_reactor)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+    int result;
+
+    STRICT_EXPECTED_CALL(socketio_reactor_unregister(TEST_REGISTRATION));
+    STRICT_EXPECTED_CALL(shutdown(TEST_SOCKET, SHUT_RDWR));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+
+    // act
+    result = socketio_close(socket_io, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_destroy_unregisters_the_socket_from_the_reactor)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+
+    STRICT_EXPECTED_CALL(socketio_reactor_unregister(TEST_REGISTRATION));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(socket_io));
+
+    // act
+    socketio_destroy(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(socketio_close_after_the_reactor_hung_up_does_not_unregister_twice)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+    int result;
+
+    queue_recv_result(0);
+    test_on_socket_event(test_on_socket_event_context, SOCKETIO_REACTOR_EVENT_READ);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(shutdown(TEST_SOCKET, SHUT_RDWR));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+
+    // act
+    result = socketio_close(socket_io, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* sends with a reactor */
+
+TEST_FUNCTION(socketio_send_that_the_socket_does_not_take_entirely_sets_the_write_interest)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+    int result;
+
+    queue_sendmsg_result(3);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_BYTES) - 3));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(socketio_reactor_set_write_interest(TEST_REGISTRATION, true));
+
+    // act
+    result = socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_send_that_completes_does_not_set_the_write_interest)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+    int result;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(test_on_send_complete(TEST_CALLBACK_CONTEXT, IO_SEND_OK));
+
+    // act
+    result = socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_send_while_sends_are_pending_only_queues_the_bytes)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+    int result;
+
+    send_leaving_bytes_pending(socket_io, 3);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_BYTES)));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+
+    // act
+    result = socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* reactor events */
+
+TEST_FUNCTION(socketio_write_event_sends_the_pending_bytes_and_clears_the_write_interest)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+
+    send_leaving_bytes_pending(socket_io, 3);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(TEST_CALLBACK_CONTEXT, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(socketio_reactor_set_write_interest(TEST_REGISTRATION, false));
+
+    // act
+    test_on_socket_event(test_on_socket_event_context, SOCKETIO_REACTOR_EVENT_WRITE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_BYTES), test_sent_byte_count);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(test_sent_bytes, TEST_BYTES, sizeof(TEST_BYTES)));
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_write_event_keeps_the_write_interest_while_bytes_are_still_pending)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_sendmsg_result(2);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(socketio_reactor_set_write_interest(TEST_REGISTRATION, true));
+
+    // act
+    test_on_socket_event(test_on_socket_event_context, SOCKETIO_REACTOR_EVENT_WRITE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_read_event_receives_the_available_bytes)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+
+    queue_recv_result(5);
+
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+    STRICT_EXPECTED_CALL(test_on_bytes_received(TEST_CALLBACK_CONTEXT, IGNORED_PTR_ARG, 5));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(socketio_reactor_set_write_interest(TEST_REGISTRATION, false));
+
+    // act
+    test_on_socket_event(test_on_socket_event_context, SOCKETIO_REACTOR_EVENT_READ);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_read_event_on_a_hung_up_socket_indicates_the_error_and_unregisters)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+
+    queue_recv_result(0);
+
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+    STRICT_EXPECTED_CALL(test_on_io_error(TEST_CALLBACK_CONTEXT));
+    STRICT_EXPECTED_CALL(socketio_reactor_unregister(TEST_REGISTRATION));
+
+    // act
+    test_on_socket_event(test_on_socket_event_context, SOCKETIO_REACTOR_EVENT_READ);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socketio_dowork with a reactor */
+
+TEST_FUNCTION(socketio_dowork_does_nothing_when_attached_to_a_reactor)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(TEST_REACTOR);
+
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_recv_result(5);
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, test_recv_call_count);
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_sends_and_receives_when_not_attached_to_a_reactor)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+#endif //__APPLE__
+
+/* sends */
+
+TEST_FUNCTION(socketio_send_vectored_sends_all_the_pieces_with_one_sendmsg)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    XIO_IOVEC iov[3];
+    int result;
+
+    iov[0].base = TEST_BYTES;
+    iov[0].length = 2;
+    iov[1].base = TEST_BYTES + 2;
+    iov[1].length = 5;
+    iov[2].base = TEST_BYTES + 7;
+    iov[2].length = 3;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(test_on_send_complete(TEST_CALLBACK_CONTEXT, IO_SEND_OK));
+
+    // act
+    result = socketio_send_vectored(socket_io, iov, 3, test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 3, test_sendmsg_iov_counts[0]);
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_BYTES), test_sent_byte_count);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(test_sent_bytes, TEST_BYTES, sizeof(TEST_BYTES)));
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_send_vectored_queues_the_pieces_the_socket_did_not_take)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    XIO_IOVEC iov[2];
+    int result;
+
+    iov[0].base = TEST_BYTES;
+    iov[0].length = 4;
+    iov[1].base = TEST_BYTES + 4;
+    iov[1].length = 6;
+
+    queue_sendmsg_result(6);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(4));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+
+    // act
+    result = socketio_send_vectored(socket_io, iov, 2, test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // the queued bytes are the ones after the 6 the socket took
+    umock_c_reset_all_calls();
+    socketio_dowork(socket_io);
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_BYTES), test_sent_byte_count);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(test_sent_bytes, TEST_BYTES, sizeof(TEST_BYTES)));
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_sends_all_the_pending_ios_with_one_sendmsg_and_completes_them_in_order)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    void* context_1 = (void*)0x5001;
+    void* context_2 = (void*)0x5002;
+    void* context_3 = (void*)0x5003;
+
+    queue_sendmsg_result(-1);
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES, 3, test_on_send_complete, context_1));
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES + 3, 3, test_on_send_complete, context_2));
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES + 6, 4, test_on_send_complete, context_3));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(context_1, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(context_2, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(context_3, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, test_sendmsg_call_count);
+    ASSERT_ARE_EQUAL(size_t, 3, test_sendmsg_iov_counts[1]);
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_BYTES), test_sent_byte_count);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(test_sent_bytes, TEST_BYTES, sizeof(TEST_BYTES)));
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_completes_the_pending_ios_sent_entirely_and_advances_the_partially_sent_one)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    void* context_1 = (void*)0x5001;
+    void* context_2 = (void*)0x5002;
+
+    queue_sendmsg_result(-1);
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES, 4, test_on_send_complete, context_1));
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES + 4, 6, test_on_send_complete, context_2));
+    queue_sendmsg_result(6);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(context_1, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 6, test_sent_byte_count);
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_resumes_a_partially_sent_pending_io_at_its_offset)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_sendmsg_result(2);
+    socketio_dowork(socket_io);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(TEST_CALLBACK_CONTEXT, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_BYTES), test_sent_byte_count);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(test_sent_bytes, TEST_BYTES, sizeof(TEST_BYTES)));
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_keeps_the_pending_ios_when_sendmsg_would_block)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_sendmsg_result(-1);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_drops_the_first_pending_io_and_indicates_an_error_when_sendmsg_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_sendmsg_result(-1);
+    test_sendmsg_errno = ECONNRESET;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_io_error(TEST_CALLBACK_CONTEXT));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* receives */
+
+TEST_FUNCTION(socketio_dowork_indicates_each_read_until_recv_would_block)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    queue_recv_result(RECEIVE_BYTES_VALUE);
+    queue_recv_result(10);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+    STRICT_EXPECTED_CALL(test_on_bytes_received(TEST_CALLBACK_CONTEXT, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+    STRICT_EXPECTED_CALL(test_on_bytes_received(TEST_CALLBACK_CONTEXT, IGNORED_PTR_ARG, 10));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, RECEIVE_BYTES_VALUE + 10, test_received_byte_count);
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_gathers_a_batch_and_asks_recv_for_all_the_space_left)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    size_t chunk_size = 4;
+    size_t batch_count = 3;
+    size_t i;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size));
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT, &batch_count));
+    umock_c_reset_all_calls();
+
+    queue_recv_result(5);
+    queue_recv_result(7);
+    queue_recv_result(3);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, 12, 0));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, 7, 0));
+    STRICT_EXPECTED_CALL(test_on_bytes_received(TEST_CALLBACK_CONTEXT, IGNORED_PTR_ARG, 12));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, 12, 0));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, 9, 0));
+    STRICT_EXPECTED_CALL(test_on_bytes_received(TEST_CALLBACK_CONTEXT, IGNORED_PTR_ARG, 3));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 15, test_received_byte_count);
+    for (i = 0; i < test_received_byte_count; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)i, (int)test_received_bytes[i]);
+    }
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_hands_over_a_partial_batch_before_indicating_the_hang_up)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    size_t batch_count = 4;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT, &batch_count));
+    umock_c_reset_all_calls();
+
+    queue_recv_result(5);
+    queue_recv_result(0);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, 4 * RECEIVE_BYTES_VALUE, 0));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, 4 * RECEIVE_BYTES_VALUE - 5, 0));
+    STRICT_EXPECTED_CALL(test_on_bytes_received(TEST_CALLBACK_CONTEXT, IGNORED_PTR_ARG, 5));
+    STRICT_EXPECTED_CALL(test_on_io_error(TEST_CALLBACK_CONTEXT));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socketio_setoption for the receive buffer */
+
+TEST_FUNCTION(socketio_setoption_receive_chunk_size_allocates_a_receive_buffer_above_the_default_size)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t chunk_size = 1024;
+    int result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(1024));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_batch_count_replaces_the_allocated_receive_buffer)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t chunk_size = 1024;
+    size_t batch_count = 4;
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(4096));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT, &batch_count);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_buffer_of_the_same_capacity_keeps_the_allocated_receive_buffer)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t chunk_size = 1024;
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size));
+    umock_c_reset_all_calls();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_chunk_size_back_to_the_default_size_frees_the_allocated_receive_buffer)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t chunk_size = 1024;
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size));
+    umock_c_reset_all_calls();
+    chunk_size = RECEIVE_BYTES_VALUE;
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_chunk_size_fails_when_allocating_the_receive_buffer_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t chunk_size = 1024;
+    int result;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(1024))
+        .SetReturn(NULL);
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_chunk_size_0_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t chunk_size = 0;
+    int result;
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_CHUNK_SIZE, &chunk_size);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_batch_count_0_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t batch_count = 0;
+    int result;
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT, &batch_count);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_receive_batch_count_fails_when_the_receive_buffer_size_overflows)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    size_t batch_count = (SIZE_MAX / RECEIVE_BYTES_VALUE) + 1;
+    int result;
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_RECEIVE_BATCH_COUNT, &batch_count);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socket buffer sizes */
+
+TEST_FUNCTION(socketio_open_sets_the_socket_buffer_sizes_before_connecting)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    int so_rcvbuf = 262144;
+    int so_sndbuf = 131072;
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_SO_RCVBUF, &so_rcvbuf));
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_SO_SNDBUF, &so_sndbuf));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(socket(AF_INET, SOCK_STREAM, 0));
+    STRICT_EXPECTED_CALL(setsockopt(TEST_SOCKET, SOL_SOCKET, SO_RCVBUF, IGNORED_PTR_ARG, sizeof(int)))
+        .ValidateArgumentBuffer(4, &so_rcvbuf, sizeof(int));
+    STRICT_EXPECTED_CALL(setsockopt(TEST_SOCKET, SOL_SOCKET, SO_SNDBUF, IGNORED_PTR_ARG, sizeof(int)))
+        .ValidateArgumentBuffer(4, &so_sndbuf, sizeof(int));
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    STRICT_EXPECTED_CALL(setsockopt(TEST_SOCKET, SOL_SOCKET, SO_NOSIGPIPE, IGNORED_PTR_ARG, sizeof(int)));
+#endif
+    STRICT_EXPECTED_CALL(getaddrinfo(TEST_HOSTNAME, TEST_PORT_STRING, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(connect(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(freeaddrinfo(IGNORED_PTR_ARG));
+
+    // act
+    result = open_socketio(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, (int)IO_OPEN_OK, (int)test_open_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_open_closes_the_socket_and_fails_when_setting_so_rcvbuf_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio();
+    int so_rcvbuf = 262144;
+    int result;
+
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_SOCKETIO_SO_RCVBUF, &so_rcvbuf));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(socket(AF_INET, SOCK_STREAM, 0));
+    STRICT_EXPECTED_CALL(setsockopt(TEST_SOCKET, SOL_SOCKET, SO_RCVBUF, IGNORED_PTR_ARG, sizeof(int)))
+        .SetReturn(-1);
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+
+    // act
+    result = open_socketio(socket_io);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, (int)IO_OPEN_ERROR, (int)test_open_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_so_sndbuf_on_an_open_socketio_applies_it_right_away)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int so_sndbuf = 131072;
+    int result;
+
+    STRICT_EXPECTED_CALL(setsockopt(TEST_SOCKET, SOL_SOCKET, SO_SNDBUF, IGNORED_PTR_ARG, sizeof(int)))
+        .ValidateArgumentBuffer(4, &so_sndbuf, sizeof(int));
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_SO_SNDBUF, &so_sndbuf);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_so_rcvbuf_with_a_negative_size_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int so_rcvbuf = -1;
+    int result;
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_SOCKETIO_SO_RCVBUF, &so_rcvbuf);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* send queue limits */
+
+static void set_send_queue_limits(CONCRETE_IO_HANDLE socket_io, size_t high_water_mark, size_t low_water_mark)
+{
+    XIO_SEND_QUEUE_LIMITS limits;
+    limits.high_water_mark = high_water_mark;
+    limits.low_water_mark = low_water_mark;
+    limits.on_low_water = test_on_low_water;
+    limits.on_low_water_context = TEST_CALLBACK_CONTEXT;
+    ASSERT_ARE_EQUAL(int, 0, socketio_setoption(socket_io, OPTION_XIO_SEND_QUEUE_LIMITS, &limits));
+}
+
+TEST_FUNCTION(socketio_send_at_the_high_water_mark_returns_XIO_SEND_WOULD_BLOCK)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int result;
+
+    set_send_queue_limits(socket_io, 7, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+
+    // act
+    result = socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_send_below_the_high_water_mark_queues_the_bytes)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int result;
+
+    set_send_queue_limits(socket_io, 8, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_BYTES)));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+
+    // act
+    result = socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_indicates_the_low_water_mark_after_a_send_was_refused)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    set_send_queue_limits(socket_io, 7, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT));
+    queue_sendmsg_result(5);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_low_water(TEST_CALLBACK_CONTEXT));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_indicates_the_low_water_mark_only_once)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    set_send_queue_limits(socket_io, 7, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT));
+    queue_sendmsg_result(5);
+    socketio_dowork(socket_io);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_PENDING_IO_LIST, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete(TEST_CALLBACK_CONTEXT, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_does_not_indicate_the_low_water_mark_while_above_it)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    set_send_queue_limits(socket_io, 7, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT));
+    queue_sendmsg_result(4);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_does_not_indicate_the_low_water_mark_when_no_send_was_refused)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    set_send_queue_limits(socket_io, 100, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_sendmsg_result(5);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_send_queue_limits_without_a_high_water_mark_clears_a_refused_send)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+
+    set_send_queue_limits(socket_io, 7, 2);
+    send_leaving_bytes_pending(socket_io, 3);
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, socketio_send(socket_io, TEST_BYTES, sizeof(TEST_BYTES), test_on_send_complete, TEST_CALLBACK_CONTEXT));
+    set_send_queue_limits(socket_io, 0, 2);
+    queue_sendmsg_result(5);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_PENDING_IO_LIST));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, TEST_SEND_FLAGS));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, RECEIVE_BYTES_VALUE, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socketio_getoption */
+
+TEST_FUNCTION(socketio_getoption_returns_the_outstanding_bytes_and_items)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    size_t outstanding_bytes;
+    size_t outstanding_items;
+    int bytes_result;
+    int items_result;
+
+    send_leaving_bytes_pending(socket_io, 3);
+    ASSERT_ARE_EQUAL(int, 0, socketio_send(socket_io, TEST_BYTES, 4, test_on_send_complete, TEST_CALLBACK_CONTEXT));
+    umock_c_reset_all_calls();
+
+    // act
+    bytes_result = socketio_getoption(socket_io, OPTION_XIO_OUTSTANDING_BYTES, &outstanding_bytes);
+    items_result = socketio_getoption(socket_io, OPTION_XIO_OUTSTANDING_ITEMS, &outstanding_items);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, bytes_result);
+    ASSERT_ARE_EQUAL(int, 0, items_result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_BYTES) - 3 + 4, outstanding_bytes);
+    ASSERT_ARE_EQUAL(size_t, 2, outstanding_items);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_getoption_outstanding_bytes_follows_the_partial_sends)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    size_t outstanding_bytes;
+    size_t outstanding_items;
+    int bytes_result;
+    int items_result;
+
+    send_leaving_bytes_pending(socket_io, 3);
+    queue_sendmsg_result(5);
+    socketio_dowork(socket_io);
+    umock_c_reset_all_calls();
+
+    // act
+    bytes_result = socketio_getoption(socket_io, OPTION_XIO_OUTSTANDING_BYTES, &outstanding_bytes);
+    items_result = socketio_getoption(socket_io, OPTION_XIO_OUTSTANDING_ITEMS, &outstanding_items);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, bytes_result);
+    ASSERT_ARE_EQUAL(int, 0, items_result);
+    ASSERT_ARE_EQUAL(size_t, 2, outstanding_bytes);
+    ASSERT_ARE_EQUAL(size_t, 1, outstanding_items);
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_getoption_with_an_unknown_option_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    size_t value;
+    int result;
+
+    // act
+    result = socketio_getoption(socket_io, "unknown_option", &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_getoption_with_NULL_value_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_and_open_socketio(NULL);
+    int result;
+
+    // act
+    result = socketio_getoption(socket_io, OPTION_XIO_OUTSTANDING_BYTES, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
 #if 0
 
 // SOCKETIO_SETOPTION TESTS WERE WORKING BEFORE SWITCH TO umock_c...need to finish the conversion
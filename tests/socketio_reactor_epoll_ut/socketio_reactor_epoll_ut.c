@@ -0,0 +1,746 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#endif
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "umock_c_negative_tests.h"
+#include "azure_c_shared_utility/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, int, epoll_create1, int, flags);
+    MOCKABLE_FUNCTION(, int, epoll_ctl, int, epfd, int, op, int, fd, struct epoll_event*, event);
+    MOCKABLE_FUNCTION(, int, epoll_wait, int, epfd, struct epoll_event*, events, int, maxevents, int, timeout);
+    MOCKABLE_FUNCTION(, int, eventfd, unsigned int, initval, int, flags);
+    MOCKABLE_FUNCTION(, ssize_t, read, int, fd, void*, buf, size_t, count);
+    MOCKABLE_FUNCTION(, ssize_t, write, int, fd, const void*, buf, size_t, count);
+    MOCKABLE_FUNCTION(, int, close, int, fd);
+#ifdef __cplusplus
+}
+#endif
+
+MOCK_FUNCTION_WITH_CODE(, void, test_on_event, void*, context, unsigned int, events)
+MOCK_FUNCTION_END()
+
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/socketio_reactor.h"
+
+#define TEST_EPOLL_FD       42
+#define TEST_WAKEUP_FD      43
+#define TEST_SOCKET_1       44
+#define TEST_SOCKET_2       45
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static struct epoll_event test_ready_events[4];
+static int test_ready_event_count;
+static int test_epoll_wait_errno;
+static SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_to_unregister;
+static SOCKETIO_REACTOR_HANDLE reactor_to_run;
+static int nested_run_once_result;
+
+static int my_epoll_ctl(int epfd, int op, int fd, struct epoll_event* event)
+{
+    (void)epfd;
+
+    /*remember what the reactor registers so that epoll_wait can report it*/
+    if ((op == EPOLL_CTL_ADD) && (fd != TEST_WAKEUP_FD))
+    {
+        test_ready_events[test_ready_event_count].data.ptr = event->data.ptr;
+        test_ready_event_count++;
+    }
+
+    return 0;
+}
+
+static int my_epoll_wait(int epfd, struct epoll_event* events, int maxevents, int timeout)
+{
+    int result;
+    (void)epfd;
+    (void)timeout;
+
+    if (test_epoll_wait_errno != 0)
+    {
+        errno = test_epoll_wait_errno;
+        result = -1;
+    }
+    else
+    {
+        result = test_ready_event_count < maxevents ? test_ready_event_count : maxevents;
+        (void)memcpy(events, test_ready_events, result * sizeof(struct epoll_event));
+    }
+
+    return result;
+}
+
+static void my_test_on_event(void* context, unsigned int events)
+{
+    (void)context;
+    (void)events;
+
+    if (registration_to_unregister != NULL)
+    {
+        socketio_reactor_unregister(registration_to_unregister);
+        registration_to_unregister = NULL;
+    }
+
+    if (reactor_to_run != NULL)
+    {
+        nested_run_once_result = socketio_reactor_run_once(reactor_to_run, 0);
+        reactor_to_run = NULL;
+    }
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static SOCKETIO_REACTOR_HANDLE create_reactor(void)
+{
+    SOCKETIO_REACTOR_HANDLE result = socketio_reactor_create();
+    ASSERT_IS_NOT_NULL(result);
+    test_ready_event_count = 0;
+    umock_c_reset_all_calls();
+    return result;
+}
+
+static void set_ready_event(int index, uint32_t epoll_events)
+{
+    test_ready_events[index].events = epoll_events;
+}
+
+BEGIN_TEST_SUITE(socketio_reactor_epoll_unittests)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+    size_t type_size;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // Unnatural type_size variable exists to avoid "conditional expression is constant" warning
+    type_size = sizeof(ssize_t);
+    if (type_size == sizeof(int32_t))
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(ssize_t, int32_t);
+    }
+    else
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(ssize_t, int64_t);
+    }
+
+    REGISTER_UMOCK_ALIAS_TYPE(SOCKETIO_REACTOR_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SOCKETIO_REACTOR_REGISTRATION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SOCKETIO_REACTOR_EVENT, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_RETURNS(epoll_create1, TEST_EPOLL_FD, -1);
+    REGISTER_GLOBAL_MOCK_RETURNS(eventfd, TEST_WAKEUP_FD, -1);
+    REGISTER_GLOBAL_MOCK_HOOK(epoll_ctl, my_epoll_ctl);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(epoll_ctl, -1);
+    REGISTER_GLOBAL_MOCK_HOOK(epoll_wait, my_epoll_wait);
+    REGISTER_GLOBAL_MOCK_RETURNS(read, (ssize_t)sizeof(uint64_t), -1);
+    REGISTER_GLOBAL_MOCK_RETURNS(write, (ssize_t)sizeof(uint64_t), -1);
+    REGISTER_GLOBAL_MOCK_RETURNS(close, 0, -1);
+    REGISTER_GLOBAL_MOCK_HOOK(test_on_event, my_test_on_event);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    umock_c_reset_all_calls();
+
+    test_ready_event_count = 0;
+    test_epoll_wait_errno = 0;
+    registration_to_unregister = NULL;
+    reactor_to_run = NULL;
+    nested_run_once_result = 0;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* socketio_reactor_create */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_001: [ socketio_reactor_create shall create an epoll instance and an eventfd used to wake it up, and add the eventfd to the epoll instance. ]*/
+TEST_FUNCTION(socketio_reactor_create_succeeds)
+{
+    ///arrange
+    SOCKETIO_REACTOR_HANDLE reactor;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(epoll_create1(EPOLL_CLOEXEC));
+    STRICT_EXPECTED_CALL(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_ADD, TEST_WAKEUP_FD, IGNORED_PTR_ARG));
+
+    ///act
+    reactor = socketio_reactor_create();
+
+    ///assert
+    ASSERT_IS_NOT_NULL(reactor);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_002: [ If any error occurs, socketio_reactor_create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_a_call_fails_socketio_reactor_create_fails)
+{
+    ///arrange
+    size_t i;
+    size_t count;
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(epoll_create1(EPOLL_CLOEXEC));
+    STRICT_EXPECTED_CALL(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_ADD, TEST_WAKEUP_FD, IGNORED_PTR_ARG));
+    umock_c_negative_tests_snapshot();
+
+    count = umock_c_negative_tests_call_count();
+    for (i = 0; i < count; i++)
+    {
+        SOCKETIO_REACTOR_HANDLE reactor;
+        char temp_str[64];
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(i);
+
+        ///act
+        reactor = socketio_reactor_create();
+
+        ///assert
+        (void)snprintf(temp_str, sizeof(temp_str), "On failed call %lu", (unsigned long)i);
+        ASSERT_IS_NULL_WITH_MSG(reactor, temp_str);
+    }
+
+    ///cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/* socketio_reactor_destroy */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_003: [ socketio_reactor_destroy shall close the eventfd and the epoll instance and free the reactor. ]*/
+TEST_FUNCTION(socketio_reactor_destroy_closes_the_eventfd_and_the_epoll_instance)
+{
+    ///arrange
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    STRICT_EXPECTED_CALL(close(TEST_WAKEUP_FD));
+    STRICT_EXPECTED_CALL(close(TEST_EPOLL_FD));
+    STRICT_EXPECTED_CALL(gballoc_free(reactor));
+
+    ///act
+    socketio_reactor_destroy(reactor);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_004: [ If reactor is NULL, socketio_reactor_destroy shall do nothing. ]*/
+TEST_FUNCTION(socketio_reactor_destroy_with_NULL_does_nothing)
+{
+    ///act
+    socketio_reactor_destroy(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* socketio_reactor_register */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_019: [ If reactor is NULL, fd is negative or on_event is NULL, socketio_reactor_register shall fail and return NULL. ]*/
+TEST_FUNCTION(socketio_reactor_register_with_invalid_arguments_fails)
+{
+    ///arrange
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+
+    ///act
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_1 = socketio_reactor_register(NULL, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_2 = socketio_reactor_register(reactor, -1, test_on_event, (void*)0x4242);
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_3 = socketio_reactor_register(reactor, TEST_SOCKET_1, NULL, (void*)0x4242);
+
+    ///assert
+    ASSERT_IS_NULL(registration_1);
+    ASSERT_IS_NULL(registration_2);
+    ASSERT_IS_NULL(registration_3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_020: [ socketio_reactor_register shall add fd to the epoll instance of the reactor, watching it for readability only. ]*/
+TEST_FUNCTION(socketio_reactor_register_adds_the_socket_to_the_epoll_instance)
+{
+    ///arrange
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_ADD, TEST_SOCKET_1, IGNORED_PTR_ARG));
+
+    ///act
+    registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(registration);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, registration, test_ready_events[0].data.ptr);
+
+    ///cleanup
+    socketio_reactor_unregister(registration);
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_021: [ If any error occurs, socketio_reactor_register shall fail and return NULL. ]*/
+TEST_FUNCTION(when_epoll_ctl_fails_socketio_reactor_register_fails)
+{
+    ///arrange
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_ADD, TEST_SOCKET_1, IGNORED_PTR_ARG))
+        .SetReturn(-1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+
+    ///assert
+    ASSERT_IS_NULL(registration);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* socketio_reactor_set_write_interest */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_022: [ If registration is NULL, socketio_reactor_set_write_interest shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(socketio_reactor_set_write_interest_with_NULL_registration_fails)
+{
+    ///act
+    int result = socketio_reactor_set_write_interest(NULL, true);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_023: [ socketio_reactor_set_write_interest shall modify the epoll registration of the socket to watch it for writability when enabled is true and to stop doing so when enabled is false. ]*/
+TEST_FUNCTION(socketio_reactor_set_write_interest_modifies_the_epoll_registration)
+{
+    ///arrange
+    int result_1;
+    int result_2;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_MOD, TEST_SOCKET_1, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_MOD, TEST_SOCKET_1, IGNORED_PTR_ARG));
+
+    ///act
+    result_1 = socketio_reactor_set_write_interest(registration, true);
+    result_2 = socketio_reactor_set_write_interest(registration, false);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result_1);
+    ASSERT_ARE_EQUAL(int, 0, result_2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_unregister(registration);
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_024: [ If the interest does not change, socketio_reactor_set_write_interest shall return 0 without calling epoll_ctl. ]*/
+TEST_FUNCTION(socketio_reactor_set_write_interest_does_not_call_epoll_ctl_when_nothing_changes)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    umock_c_reset_all_calls();
+
+    ///act
+    result = socketio_reactor_set_write_interest(registration, false);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_unregister(registration);
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_025: [ If epoll_ctl fails, socketio_reactor_set_write_interest shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_epoll_ctl_fails_socketio_reactor_set_write_interest_fails)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_MOD, TEST_SOCKET_1, IGNORED_PTR_ARG))
+        .SetReturn(-1);
+
+    ///act
+    result = socketio_reactor_set_write_interest(registration, true);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_unregister(registration);
+    socketio_reactor_destroy(reactor);
+}
+
+/* socketio_reactor_unregister */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_026: [ If registration is NULL, socketio_reactor_unregister shall do nothing. ]*/
+TEST_FUNCTION(socketio_reactor_unregister_with_NULL_does_nothing)
+{
+    ///act
+    socketio_reactor_unregister(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_027: [ socketio_reactor_unregister shall remove the socket from the epoll instance and free the registration. ]*/
+TEST_FUNCTION(socketio_reactor_unregister_removes_the_socket_from_the_epoll_instance)
+{
+    ///arrange
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_DEL, TEST_SOCKET_1, NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(registration));
+
+    ///act
+    socketio_reactor_unregister(registration);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* socketio_reactor_run_once */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_005: [ If reactor is NULL, socketio_reactor_run_once shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(socketio_reactor_run_once_with_NULL_reactor_fails)
+{
+    ///act
+    int result = socketio_reactor_run_once(NULL, 0);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_006: [ If socketio_reactor_run_once is called from an event callback, it shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(socketio_reactor_run_once_from_an_event_callback_fails)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    set_ready_event(0, EPOLLIN);
+    reactor_to_run = reactor;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
+    STRICT_EXPECTED_CALL(test_on_event((void*)0x4242, SOCKETIO_REACTOR_EVENT_READ));
+
+    ///act
+    result = socketio_reactor_run_once(reactor, 0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, nested_run_once_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_unregister(registration);
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_007: [ socketio_reactor_run_once shall wait with epoll_wait for up to timeout_ms milliseconds for ready sockets. ]*/
+/* Tests_SRS_SOCKETIO_REACTOR_11_008: [ For each ready socket, socketio_reactor_run_once shall call on_event with the on_event_context given at registration and the SOCKETIO_REACTOR_EVENT_READ, SOCKETIO_REACTOR_EVENT_WRITE and SOCKETIO_REACTOR_EVENT_ERROR flags matching the reported epoll events. ]*/
+TEST_FUNCTION(socketio_reactor_run_once_dispatches_the_ready_sockets)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_1 = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_2 = socketio_reactor_register(reactor, TEST_SOCKET_2, test_on_event, (void*)0x4243);
+    set_ready_event(0, EPOLLIN | EPOLLOUT);
+    set_ready_event(1, EPOLLIN | EPOLLHUP);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 1000));
+    STRICT_EXPECTED_CALL(test_on_event((void*)0x4242, SOCKETIO_REACTOR_EVENT_READ | SOCKETIO_REACTOR_EVENT_WRITE));
+    STRICT_EXPECTED_CALL(test_on_event((void*)0x4243, SOCKETIO_REACTOR_EVENT_READ | SOCKETIO_REACTOR_EVENT_ERROR));
+
+    ///act
+    result = socketio_reactor_run_once(reactor, 1000);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_unregister(registration_1);
+    socketio_reactor_unregister(registration_2);
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_009: [ If epoll_wait is interrupted by a signal, socketio_reactor_run_once shall return 0 without dispatching any event. ]*/
+TEST_FUNCTION(when_epoll_wait_is_interrupted_socketio_reactor_run_once_returns_0)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    test_epoll_wait_errno = EINTR;
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 1000));
+
+    ///act
+    result = socketio_reactor_run_once(reactor, 1000);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_010: [ If epoll_wait fails, socketio_reactor_run_once shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_epoll_wait_fails_socketio_reactor_run_once_fails)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    test_epoll_wait_errno = EBADF;
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 1000));
+
+    ///act
+    result = socketio_reactor_run_once(reactor, 1000);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_012: [ Events for sockets unregistered earlier in the same dispatch shall be skipped. ]*/
+/* Tests_SRS_SOCKETIO_REACTOR_11_028: [ If socketio_reactor_unregister is called from an event callback, freeing the registration shall be deferred until the dispatch completes. ]*/
+TEST_FUNCTION(socketio_reactor_run_once_skips_a_socket_unregistered_by_an_earlier_callback)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_1 = socketio_reactor_register(reactor, TEST_SOCKET_1, test_on_event, (void*)0x4242);
+    SOCKETIO_REACTOR_REGISTRATION_HANDLE registration_2 = socketio_reactor_register(reactor, TEST_SOCKET_2, test_on_event, (void*)0x4243);
+    set_ready_event(0, EPOLLIN);
+    set_ready_event(1, EPOLLIN);
+    registration_to_unregister = registration_2;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
+    STRICT_EXPECTED_CALL(test_on_event((void*)0x4242, SOCKETIO_REACTOR_EVENT_READ));
+    STRICT_EXPECTED_CALL(epoll_ctl(TEST_EPOLL_FD, EPOLL_CTL_DEL, TEST_SOCKET_2, NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(registration_2));
+
+    ///act
+    result = socketio_reactor_run_once(reactor, 0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_unregister(registration_1);
+    socketio_reactor_destroy(reactor);
+}
+
+/* socketio_reactor_stop */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_016: [ If reactor is NULL, socketio_reactor_stop shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(socketio_reactor_stop_with_NULL_reactor_fails)
+{
+    ///act
+    int result = socketio_reactor_stop(NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_017: [ socketio_reactor_stop shall signal the eventfd of the reactor. ]*/
+TEST_FUNCTION(socketio_reactor_stop_signals_the_eventfd)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    STRICT_EXPECTED_CALL(write(TEST_WAKEUP_FD, IGNORED_PTR_ARG, sizeof(uint64_t)));
+
+    ///act
+    result = socketio_reactor_stop(reactor);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_018: [ If signaling the eventfd fails, socketio_reactor_stop shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_write_fails_socketio_reactor_stop_fails)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    errno = EBADF;
+    STRICT_EXPECTED_CALL(write(TEST_WAKEUP_FD, IGNORED_PTR_ARG, sizeof(uint64_t)))
+        .SetReturn(-1);
+
+    ///act
+    result = socketio_reactor_stop(reactor);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* socketio_reactor_run */
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_013: [ If reactor is NULL, socketio_reactor_run shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(socketio_reactor_run_with_NULL_reactor_fails)
+{
+    ///act
+    int result = socketio_reactor_run(NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_011: [ When the eventfd is signaled, socketio_reactor_run_once shall reset it and record that a stop was requested. ]*/
+/* Tests_SRS_SOCKETIO_REACTOR_11_014: [ socketio_reactor_run shall call socketio_reactor_run_once without a timeout until a stop is requested and then return 0. ]*/
+TEST_FUNCTION(socketio_reactor_run_returns_when_the_eventfd_is_signaled)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    test_ready_events[0].events = EPOLLIN;
+    test_ready_events[0].data.ptr = NULL;
+    test_ready_event_count = 1;
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, -1));
+    STRICT_EXPECTED_CALL(read(TEST_WAKEUP_FD, IGNORED_PTR_ARG, sizeof(uint64_t)));
+
+    ///act
+    result = socketio_reactor_run(reactor);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+/* Tests_SRS_SOCKETIO_REACTOR_11_015: [ If socketio_reactor_run_once fails, socketio_reactor_run shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_epoll_wait_fails_socketio_reactor_run_fails)
+{
+    ///arrange
+    int result;
+    SOCKETIO_REACTOR_HANDLE reactor = create_reactor();
+    test_epoll_wait_errno = EBADF;
+    STRICT_EXPECTED_CALL(epoll_wait(TEST_EPOLL_FD, IGNORED_PTR_ARG, IGNORED_NUM_ARG, -1));
+
+    ///act
+    result = socketio_reactor_run(reactor);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socketio_reactor_destroy(reactor);
+}
+
+END_TEST_SUITE(socketio_reactor_epoll_unittests)
@@ -40,6 +40,11 @@ void my_gballoc_free(void* ptr)
 static const char TEST_STRING_VALUE []= "DataValueTest";
 static const char INITIAL_STRING_VALUE []= "Initial_";
 static const char MULTIPLE_TEST_STRING_VALUE[] = "DataValueTestDataValueTest";
+/*matches the default STRING_SMALL_BUFFER_SIZE in strings.c*/
+#define TEST_SMALL_BUFFER_SIZE 32
+/*longer than the small string buffer, so it needs a separate allocation*/
+static const char LONG_STRING_VALUE[] = "DataValueTestDataValueTestDataValueTest";
+static const char* COMBINED_LONG_STRING_VALUE = "Initial_DataValueTestDataValueTestDataValueTest";
 static const char* COMBINED_STRING_VALUE = "Initial_DataValueTest";
 static const char* QUOTED_TEST_STRING_VALUE = "\"DataValueTest\"";
 static const char* FORMAT_STRING = "test_format_%s";
@@ -139,7 +144,6 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(1));
 
         ///act
         g_hString = STRING_new();
@@ -163,7 +167,6 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(1));
 
         umock_c_negative_tests_snapshot();
 
@@ -227,6 +230,7 @@ BEGIN_TEST_SUITE(strings_unittests)
     }
 
     /* Tests_SRS_STRING_07_003: [STRING_construct shall allocate a new string with the value of the specified const char*.] */
+    /* Tests_SRS_STRING_11_001: [ Strings shorter than STRING_SMALL_BUFFER_SIZE (terminator included) shall be stored inside the STRING_HANDLE without a separate allocation. ] */
     TEST_FUNCTION(STRING_construct_Succeed)
     {
         ///arrange
@@ -234,13 +238,35 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_STRING_VALUE) + 1));
 
         ///act
         g_hString = STRING_construct(TEST_STRING_VALUE);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, STRING_c_str(g_hString) );
+        ASSERT_ARE_EQUAL(size_t, strlen(TEST_STRING_VALUE), STRING_length(g_hString));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(g_hString);
+    }
+
+    /* Tests_SRS_STRING_07_003: [STRING_construct shall allocate a new string with the value of the specified const char*.] */
+    TEST_FUNCTION(STRING_construct_long_value_Succeed)
+    {
+        ///arrange
+        STRING_HANDLE g_hString;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(LONG_STRING_VALUE) + 1));
+
+        ///act
+        g_hString = STRING_construct(LONG_STRING_VALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, LONG_STRING_VALUE, STRING_c_str(g_hString) );
+        ASSERT_ARE_EQUAL(size_t, strlen(LONG_STRING_VALUE), STRING_length(g_hString));
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
@@ -259,7 +285,7 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_STRING_VALUE) + 1));
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(LONG_STRING_VALUE) + 1));
 
         umock_c_negative_tests_snapshot();
 
@@ -272,7 +298,7 @@ BEGIN_TEST_SUITE(strings_unittests)
             umock_c_negative_tests_reset();
             umock_c_negative_tests_fail_call(index);
 
-            str_handle = STRING_construct(TEST_STRING_VALUE);
+            str_handle = STRING_construct(LONG_STRING_VALUE);
 
             sprintf(tmp_msg, "STRING_construct failure in test %zu/%zu", index+1, count);
 
@@ -306,7 +332,6 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(2 + strlen(TEST_STRING_VALUE) + 1));
 
         ///act
         g_hString = STRING_new_quoted(TEST_STRING_VALUE);
@@ -355,7 +380,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         ///arrange
         STRING_HANDLE str_handle;
 
-        EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
         ///act
@@ -377,7 +401,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         ///arrange
         STRING_HANDLE str_handle;
 
-        EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
         ///act
@@ -402,7 +425,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         int negativeTestsInitResult = umock_c_negative_tests_init();
         ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-        EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
         umock_c_negative_tests_snapshot();
@@ -437,14 +459,12 @@ BEGIN_TEST_SUITE(strings_unittests)
         g_hString = STRING_construct(INITIAL_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, strlen(INITIAL_STRING_VALUE) + strlen(TEST_STRING_VALUE) + 1))
-            .IgnoreArgument(1);
-
         ///act
         nResult = STRING_concat(g_hString, TEST_STRING_VALUE);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, COMBINED_STRING_VALUE, STRING_c_str(g_hString) );
+        ASSERT_ARE_EQUAL(size_t, strlen(COMBINED_STRING_VALUE), STRING_length(g_hString));
         ASSERT_ARE_EQUAL(int, nResult, 0);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
@@ -452,6 +472,80 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRING_delete(g_hString);
     }
 
+    /* Tests_SRS_STRING_07_012: [STRING_concat shall concatenate the given STRING_HANDLE and the const char* value and place the value in the handle.] */
+    /* Tests_SRS_STRING_11_003: [ When the capacity is exceeded, the capacity shall be grown to the bigger of twice the current capacity and the needed size. ] */
+    TEST_FUNCTION(STRING_Concat_beyond_small_buffer_Succeed)
+    {
+        ///arrange
+        int nResult;
+        STRING_HANDLE g_hString;
+        g_hString = STRING_construct(INITIAL_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(64));
+
+        ///act
+        nResult = STRING_concat(g_hString, LONG_STRING_VALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, COMBINED_LONG_STRING_VALUE, STRING_c_str(g_hString) );
+        ASSERT_ARE_EQUAL(size_t, strlen(COMBINED_LONG_STRING_VALUE), STRING_length(g_hString));
+        ASSERT_ARE_EQUAL(int, nResult, 0);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(g_hString);
+    }
+
+    /* Tests_SRS_STRING_11_003: [ When the capacity is exceeded, the capacity shall be grown to the bigger of twice the current capacity and the needed size. ] */
+    TEST_FUNCTION(STRING_Concat_heap_string_reallocates_geometrically)
+    {
+        ///arrange
+        int nResult;
+        STRING_HANDLE g_hString;
+        g_hString = STRING_construct(LONG_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 2 * (strlen(LONG_STRING_VALUE) + 1)));
+
+        ///act
+        nResult = STRING_concat(g_hString, "a");
+        nResult |= STRING_concat(g_hString, TEST_STRING_VALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, nResult);
+        ASSERT_ARE_EQUAL(size_t, strlen(LONG_STRING_VALUE) + 1 + strlen(TEST_STRING_VALUE), STRING_length(g_hString));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(g_hString);
+    }
+
+    /* Tests_SRS_STRING_07_013: [STRING_concat shall return a nonzero number if an error is encountered.] */
+    TEST_FUNCTION(STRING_Concat_grow_fails_leaves_string_unchanged)
+    {
+        ///arrange
+        int nResult;
+        STRING_HANDLE g_hString;
+        g_hString = STRING_construct(INITIAL_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .SetReturn(NULL);
+
+        ///act
+        nResult = STRING_concat(g_hString, LONG_STRING_VALUE);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, nResult);
+        ASSERT_ARE_EQUAL(char_ptr, INITIAL_STRING_VALUE, STRING_c_str(g_hString));
+        ASSERT_ARE_EQUAL(size_t, strlen(INITIAL_STRING_VALUE), STRING_length(g_hString));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(g_hString);
+    }
+
     /* Tests_SRS_STRING_07_013: [STRING_concat shall return a nonzero number if the STRING_HANDLE and const char* is NULL.] */
     TEST_FUNCTION(STRING_Concat_HANDLE_NULL_Fail)
     {
@@ -516,10 +610,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRING_copy(g_hString, TEST_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, strlen(TEST_STRING_VALUE) + strlen(TEST_STRING_VALUE)+1))
-            .IgnoreArgument(1)
-            .IgnoreArgument(2);
-
         ///act
         STRING_concat(g_hString, TEST_STRING_VALUE);
 
@@ -540,9 +630,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRING_HANDLE hAppend = STRING_construct(TEST_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, strlen(INITIAL_STRING_VALUE) + strlen(TEST_STRING_VALUE) + 1))
-            .IgnoreArgument(1);
-
         ///act
         nResult = STRING_concat_with_STRING(g_hString, hAppend);
 
@@ -617,9 +704,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         g_hString = STRING_construct(INITIAL_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, strlen(TEST_STRING_VALUE) + 1))
-            .IgnoreArgument(1);
-
         ///act
         nResult = STRING_copy(g_hString, TEST_STRING_VALUE);
 
@@ -660,9 +744,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRING_HANDLE g_hString;
         g_hString = STRING_construct(INITIAL_STRING_VALUE);
         umock_c_reset_all_calls();
-        
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, NUMBER_OF_CHAR_TOCOPY + 1))
-            .IgnoreArgument(1);
 
         ///act
         nResult = STRING_copy_n(g_hString, COMBINED_STRING_VALUE, NUMBER_OF_CHAR_TOCOPY);
@@ -718,9 +799,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         g_hString = STRING_construct(INITIAL_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1))
-            .IgnoreArgument(1);
-
         ///act
         nResult = STRING_copy_n(g_hString, COMBINED_STRING_VALUE, 0);
 
@@ -742,9 +820,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         g_hString = STRING_construct(TEST_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 2 + strlen(TEST_STRING_VALUE) + 1))
-            .IgnoreArgument(1);
-
         ///act
         nResult = STRING_quote(g_hString);
 
@@ -766,11 +841,10 @@ BEGIN_TEST_SUITE(strings_unittests)
         int negativeTestsInitResult = umock_c_negative_tests_init();
         ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-        str_handle = STRING_construct(TEST_STRING_VALUE);
+        str_handle = STRING_construct(LONG_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 2 + strlen(TEST_STRING_VALUE) + 1))
-            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
         umock_c_negative_tests_snapshot();
 
@@ -832,7 +906,6 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_STRING_VALUE) + 1));
 
         ///act
         g_hString = STRING_construct(TEST_STRING_VALUE);
@@ -847,23 +920,23 @@ BEGIN_TEST_SUITE(strings_unittests)
     }
 
     /* Tests_SRS_STRING_07_022: [STRING_empty shall revert the STRING_HANDLE to an empty state.] */
+    /* Tests_SRS_STRING_11_004: [ STRING_empty shall keep the capacity of the string so that it can be refilled without allocating. ] */
     TEST_FUNCTION(STRING_empty_Succeed)
     {
         ///arrange
         STRING_HANDLE g_hString;
         int nResult;
-        g_hString = STRING_construct(TEST_STRING_VALUE);
+        g_hString = STRING_construct(LONG_STRING_VALUE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 1))
-            .IgnoreArgument(1);
-
         ///act
         nResult = STRING_empty(g_hString);
 
         ///assert
         ASSERT_ARE_EQUAL(int, nResult, 0);
         ASSERT_ARE_EQUAL(char_ptr, EMPTY_STRING, STRING_c_str(g_hString) );
+        ASSERT_ARE_EQUAL(size_t, 0, STRING_length(g_hString));
+        ASSERT_ARE_EQUAL(int, 0, STRING_copy(g_hString, LONG_STRING_VALUE));
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
@@ -903,8 +976,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         g_hString = STRING_new();
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
 
@@ -915,6 +986,24 @@ BEGIN_TEST_SUITE(strings_unittests)
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     }
 
+    /* Tests_SRS_STRING_07_010: [STRING_delete will free the memory allocated by the STRING_HANDLE.] */
+    TEST_FUNCTION(STRING_delete_long_value_Succeed)
+    {
+        ///arrange
+        STRING_HANDLE g_hString;
+        g_hString = STRING_construct(LONG_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        STRING_delete(g_hString);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
     TEST_FUNCTION(STRING_length_Succeed)
     {
         ///arrange
@@ -969,7 +1058,6 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("aa")));
 
         ///act
         result = STRING_clone(hSource);
@@ -995,12 +1083,12 @@ BEGIN_TEST_SUITE(strings_unittests)
         int negativeTestsInitResult = umock_c_negative_tests_init();
         ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-        str_handle = STRING_construct("aa");
+        str_handle = STRING_construct(LONG_STRING_VALUE);
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("aa")));
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(LONG_STRING_VALUE)));
 
         umock_c_negative_tests_snapshot();
 
@@ -1061,8 +1149,6 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(3))
-            .IgnoreArgument(1);
 
         ///act
         result = STRING_construct_n("qq", 2);
@@ -1083,8 +1169,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRING_HANDLE result;
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(4))
-            .IgnoreArgument(1);
 
         ///act
         result = STRING_construct_n("12345", 3);
@@ -1108,7 +1192,7 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(3))
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument(1);
 
         umock_c_negative_tests_snapshot();
@@ -1123,7 +1207,7 @@ BEGIN_TEST_SUITE(strings_unittests)
             umock_c_negative_tests_reset();
             umock_c_negative_tests_fail_call(index);
 
-            result = STRING_construct_n("qq", 2);
+            result = STRING_construct_n(LONG_STRING_VALUE, sizeof(LONG_STRING_VALUE) - 1);
 
             sprintf(tmp_msg, "STRING_construct_n failure in test %zu/%zu", index+1, count);
 
@@ -1286,7 +1370,10 @@ BEGIN_TEST_SUITE(strings_unittests)
 
             STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
                 .IgnoreArgument(1);
-            STRICT_EXPECTED_CALL(gballoc_malloc(strlen(JSONtests[i].expectedJSON) + 1));
+            if (strlen(JSONtests[i].expectedJSON) >= TEST_SMALL_BUFFER_SIZE)
+            {
+                STRICT_EXPECTED_CALL(gballoc_malloc(strlen(JSONtests[i].expectedJSON) + 1));
+            }
 
             ///act
             result = STRING_new_JSON(JSONtests[i].source);
@@ -1310,7 +1397,7 @@ BEGIN_TEST_SUITE(strings_unittests)
         ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_malloc(strlen("ab") + 2+1));
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(LONG_STRING_VALUE) + 2+1));
 
         umock_c_negative_tests_snapshot();
 
@@ -1324,7 +1411,7 @@ BEGIN_TEST_SUITE(strings_unittests)
             umock_c_negative_tests_reset();
             umock_c_negative_tests_fail_call(index);
 
-            result = STRING_new_JSON("ab");
+            result = STRING_new_JSON(LONG_STRING_VALUE);
 
             sprintf(tmp_msg, "STRING_new_JSON failure in test %zu/%zu", index+1, count);
 
@@ -1374,8 +1461,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument_size();
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(1 + 1));
-
         ///act
         result = STRING_from_byte_array((const unsigned char*)"a", 1);
 
@@ -1396,8 +1481,6 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument_size();
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(1 + 0));
-
         ///act
         result = STRING_from_byte_array(NULL, 0);
 
@@ -1418,14 +1501,14 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
             .IgnoreArgument_size();
         
-        STRICT_EXPECTED_CALL(gballoc_malloc(1 + 1))
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(LONG_STRING_VALUE)))
             .SetReturn(NULL);
 
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument_ptr();
 
         ///act
-        result = STRING_from_byte_array((const unsigned char*)"a", 1);
+        result = STRING_from_byte_array((const unsigned char*)LONG_STRING_VALUE, sizeof(LONG_STRING_VALUE) - 1);
 
         ///assert
         ASSERT_IS_NULL(result);
@@ -1497,7 +1580,7 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         umock_c_reset_all_calls();
 
-        EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
         ///act
         str_result = STRING_sprintf(str_handle, FORMAT_STRING, TEST_STRING_VALUE);
@@ -1548,7 +1631,7 @@ BEGIN_TEST_SUITE(strings_unittests)
 
         umock_c_reset_all_calls();
 
-        EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
         umock_c_negative_tests_snapshot();
 
@@ -1700,4 +1783,89 @@ BEGIN_TEST_SUITE(strings_unittests)
         STRING_delete(str_handle);
     }
 
+    /* Tests_SRS_STRING_11_005: [ If handle is NULL STRING_reserve shall return a non-zero value. ] */
+    TEST_FUNCTION(STRING_reserve_handle_NULL_fail)
+    {
+        //arrange
+        int str_result;
+
+        //act
+        str_result = STRING_reserve(NULL, 100);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, str_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_STRING_11_006: [ If the string can already hold capacity characters, STRING_reserve shall not allocate and shall return zero. ] */
+    TEST_FUNCTION(STRING_reserve_within_capacity_does_not_allocate)
+    {
+        //arrange
+        int str_result;
+        STRING_HANDLE str_handle = STRING_construct(TEST_STRING_VALUE);
+        ASSERT_IS_NOT_NULL(str_handle);
+        umock_c_reset_all_calls();
+
+        //act
+        str_result = STRING_reserve(str_handle, TEST_SMALL_BUFFER_SIZE - 1);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, str_result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, STRING_c_str(str_handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        STRING_delete(str_handle);
+    }
+
+    /* Tests_SRS_STRING_11_007: [ Otherwise STRING_reserve shall move the value of the string into storage that can hold exactly capacity characters and the '\0' terminator. ] */
+    /* Tests_SRS_STRING_11_009: [ On success STRING_reserve shall return zero. ] */
+    TEST_FUNCTION(STRING_reserve_succeed)
+    {
+        //arrange
+        int str_result;
+        STRING_HANDLE str_handle = STRING_construct(TEST_STRING_VALUE);
+        ASSERT_IS_NOT_NULL(str_handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(100 + 1));
+
+        //act
+        str_result = STRING_reserve(str_handle, 100);
+        str_result |= STRING_concat(str_handle, LONG_STRING_VALUE);
+        str_result |= STRING_concat(str_handle, LONG_STRING_VALUE);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, str_result);
+        ASSERT_ARE_EQUAL(size_t, strlen(TEST_STRING_VALUE) + 2 * strlen(LONG_STRING_VALUE), STRING_length(str_handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        STRING_delete(str_handle);
+    }
+
+    /* Tests_SRS_STRING_11_008: [ If any error is encountered STRING_reserve shall return a non-zero value and leave the string unchanged. ] */
+    TEST_FUNCTION(STRING_reserve_fail)
+    {
+        //arrange
+        int str_result;
+        STRING_HANDLE str_handle = STRING_construct(LONG_STRING_VALUE);
+        ASSERT_IS_NOT_NULL(str_handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 100 + 1))
+            .SetReturn(NULL);
+
+        //act
+        str_result = STRING_reserve(str_handle, 100);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, str_result);
+        ASSERT_ARE_EQUAL(char_ptr, LONG_STRING_VALUE, STRING_c_str(str_handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        STRING_delete(str_handle);
+    }
+
 END_TEST_SUITE(strings_unittests)
\ No newline at end of file
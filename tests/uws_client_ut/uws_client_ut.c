@@ -58,6 +58,7 @@ Tests_SRS_UWS_CLIENT_01_211: [ One implication of this is that in absence of ext
 #include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/uws_frame_encoder.h"
+#include "azure_c_shared_utility/uws_permessage_deflate.h"
 #include "azure_c_shared_utility/gb_rand.h"
 #include "azure_c_shared_utility/base64.h"
 
@@ -228,6 +229,8 @@ TEST_DEFINE_ENUM_TYPE(WS_ERROR, WS_ERROR_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(WS_ERROR, WS_ERROR_VALUES);
 TEST_DEFINE_ENUM_TYPE(WS_SEND_FRAME_RESULT, WS_SEND_FRAME_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(WS_SEND_FRAME_RESULT, WS_SEND_FRAME_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(WS_FRAGMENT, WS_FRAGMENT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(WS_FRAGMENT, WS_FRAGMENT_VALUES);
 
 static char* umocktypes_stringify_const_SOCKETIO_CONFIG_ptr(const SOCKETIO_CONFIG** value)
 {
@@ -330,6 +333,8 @@ MOCK_FUNCTION_WITH_CODE(, void, test_on_ws_open_complete, void*, context, WS_OPE
 MOCK_FUNCTION_END()
 MOCK_FUNCTION_WITH_CODE(, void, test_on_ws_frame_received, void*, context, unsigned char, frame_type, const unsigned char*, buffer, size_t, size)
 MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_ws_fragment_received, void*, context, unsigned char, frame_type, WS_FRAGMENT, fragment, const unsigned char*, buffer, size_t, size)
+MOCK_FUNCTION_END()
 MOCK_FUNCTION_WITH_CODE(, void, test_on_ws_peer_closed, void*, context, uint16_t*, close_code, const unsigned char*, extra_data, size_t, extra_data_length)
 MOCK_FUNCTION_END()
 MOCK_FUNCTION_WITH_CODE(, void, test_on_ws_error, void*, context, WS_ERROR, error_code);
@@ -394,6 +399,164 @@ static OPTIONHANDLER_HANDLE my_OptionHandler_Create(pfCloneOption cloneOption, p
     return TEST_OPTIONHANDLER_HANDLE;
 }
 
+/* random chunk tests: a stream of data frames is cut in random chunks and the bytes indicated to the user are summed up */
+#define RANDOM_CHUNKS_MESSAGE_COUNT 1000
+
+typedef struct RANDOM_CHUNKS_RECEIVED_TAG
+{
+    size_t message_count;
+    size_t byte_count;
+    size_t checksum;
+    size_t order_errors;
+    bool in_message;
+    size_t error_count;
+} RANDOM_CHUNKS_RECEIVED;
+
+static unsigned int random_chunks_seed;
+
+static size_t random_chunks_next(size_t modulo)
+{
+    random_chunks_seed = random_chunks_seed * 1103515245 + 12345;
+    return (size_t)((random_chunks_seed >> 8) % modulo);
+}
+
+static void random_chunks_add_bytes(RANDOM_CHUNKS_RECEIVED* received, const unsigned char* buffer, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        received->checksum = received->checksum * 31 + buffer[i];
+    }
+    received->byte_count += size;
+}
+
+static void random_chunks_on_ws_frame_received(void* context, unsigned char frame_type, const unsigned char* buffer, size_t size)
+{
+    RANDOM_CHUNKS_RECEIVED* received = (RANDOM_CHUNKS_RECEIVED*)context;
+    (void)frame_type;
+    random_chunks_add_bytes(received, buffer, size);
+    received->message_count++;
+}
+
+static void random_chunks_on_ws_fragment_received(void* context, unsigned char frame_type, WS_FRAGMENT fragment, const unsigned char* buffer, size_t size)
+{
+    RANDOM_CHUNKS_RECEIVED* received = (RANDOM_CHUNKS_RECEIVED*)context;
+    bool starts_message = (fragment == WS_FRAGMENT_BEGIN) || (fragment == WS_FRAGMENT_COMPLETE);
+    (void)frame_type;
+    if (starts_message == received->in_message)
+    {
+        received->order_errors++;
+    }
+    received->in_message = (fragment == WS_FRAGMENT_BEGIN) || (fragment == WS_FRAGMENT_CONTINUE);
+    random_chunks_add_bytes(received, buffer, size);
+    if ((fragment == WS_FRAGMENT_END) || (fragment == WS_FRAGMENT_COMPLETE))
+    {
+        received->message_count++;
+    }
+}
+
+static void random_chunks_on_ws_error(void* context, WS_ERROR error_code)
+{
+    (void)error_code;
+    ((RANDOM_CHUNKS_RECEIVED*)context)->error_count++;
+}
+
+static size_t random_chunks_add_frame(unsigned char* stream, unsigned char first_byte, size_t payload_length, RANDOM_CHUNKS_RECEIVED* expected)
+{
+    size_t length = 0;
+    size_t i;
+    stream[length++] = first_byte;
+    if (payload_length < 126)
+    {
+        stream[length++] = (unsigned char)payload_length;
+    }
+    else if (payload_length < 65536)
+    {
+        stream[length++] = 126;
+        stream[length++] = (unsigned char)(payload_length >> 8);
+        stream[length++] = (unsigned char)payload_length;
+    }
+    else
+    {
+        int shift;
+        stream[length++] = 127;
+        for (shift = 56; shift >= 0; shift -= 8)
+        {
+            stream[length++] = (unsigned char)((uint64_t)payload_length >> shift);
+        }
+    }
+    for (i = 0; i < payload_length; i++)
+    {
+        stream[length++] = (unsigned char)random_chunks_next(256);
+    }
+    random_chunks_add_bytes(expected, stream + length - payload_length, payload_length);
+    return length;
+}
+
+static size_t random_chunks_payload_length(void)
+{
+    size_t kind = random_chunks_next(100);
+    /* mostly 7 bit lengths, some 16 and 64 bit ones, some empty frames */
+    return (kind < 5) ? 0 : (kind < 85) ? random_chunks_next(126) : (kind < 98) ? 126 + random_chunks_next(2000) : 65536 + random_chunks_next(10000);
+}
+
+/* builds RANDOM_CHUNKS_MESSAGE_COUNT binary and text messages, a third of them fragmented in 2 to 4 frames, into a newly allocated stream */
+static unsigned char* random_chunks_build_stream(size_t* stream_length, RANDOM_CHUNKS_RECEIVED* expected)
+{
+    size_t stream_capacity = 1024 * 1024;
+    unsigned char* stream = (unsigned char*)malloc(stream_capacity);
+    size_t n;
+    *stream_length = 0;
+    (void)memset(expected, 0, sizeof(RANDOM_CHUNKS_RECEIVED));
+    for (n = 0; (stream != NULL) && (n < RANDOM_CHUNKS_MESSAGE_COUNT); n++)
+    {
+        unsigned char opcode = (random_chunks_next(4) == 0) ? 0x01 : 0x02;
+        size_t frame_count = (random_chunks_next(3) == 0) ? 2 + random_chunks_next(3) : 1;
+        size_t i;
+        for (i = 0; i < frame_count; i++)
+        {
+            unsigned char first_byte = (unsigned char)(((i == frame_count - 1) ? 0x80 : 0x00) | ((i == 0) ? opcode : 0x00));
+            size_t payload_length = random_chunks_payload_length();
+            if (stream_capacity - *stream_length < 14 + payload_length)
+            {
+                unsigned char* new_stream;
+                stream_capacity *= 2;
+                new_stream = (unsigned char*)realloc(stream, stream_capacity);
+                if (new_stream == NULL)
+                {
+                    free(stream);
+                    stream = NULL;
+                    break;
+                }
+                stream = new_stream;
+            }
+            *stream_length += random_chunks_add_frame(stream + *stream_length, first_byte, payload_length, expected);
+        }
+        expected->message_count++;
+    }
+    return stream;
+}
+
+/* hands the stream to uws in chunks of random size, each in its own allocation so that no pointer into a previous chunk stays valid */
+static void random_chunks_receive_stream(const unsigned char* stream, size_t stream_length)
+{
+    size_t position = 0;
+    while (position < stream_length)
+    {
+        size_t chunk_length = (random_chunks_next(2) == 0) ? 1 + random_chunks_next(16) : 1 + random_chunks_next(20000);
+        unsigned char* chunk;
+        if (chunk_length > stream_length - position)
+        {
+            chunk_length = stream_length - position;
+        }
+        chunk = (unsigned char*)malloc(chunk_length);
+        (void)memcpy(chunk, stream + position, chunk_length);
+        g_on_bytes_received(g_on_bytes_received_context, chunk, chunk_length);
+        free(chunk);
+        position += chunk_length;
+    }
+}
+
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
@@ -424,6 +587,43 @@ extern "C" {
 }
 #endif
 
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+static const UWS_PERMESSAGE_DEFLATE_HANDLE TEST_PERMESSAGE_DEFLATE_HANDLE = (UWS_PERMESSAGE_DEFLATE_HANDLE)0x4561;
+static const char TEST_PERMESSAGE_DEFLATE_OFFER[] = "permessage-deflate; client_max_window_bits";
+
+static char* my_uws_permessage_deflate_create_offer(const WS_PERMESSAGE_DEFLATE_CONFIG* config)
+{
+    char* result = (char*)my_gballoc_malloc(sizeof(TEST_PERMESSAGE_DEFLATE_OFFER));
+    (void)config;
+    (void)memcpy(result, TEST_PERMESSAGE_DEFLATE_OFFER, sizeof(TEST_PERMESSAGE_DEFLATE_OFFER));
+    return result;
+}
+
+static int my_uws_permessage_deflate_negotiate(const WS_PERMESSAGE_DEFLATE_CONFIG* offer, const char* upgrade_response, WS_PERMESSAGE_DEFLATE_CONFIG* negotiated, bool* is_accepted)
+{
+    (void)upgrade_response;
+    *negotiated = *offer;
+    *is_accepted = true;
+    return 0;
+}
+
+/* creates an uws instance that offers permessage-deflate and opens it, the server accepting the offer */
+static UWS_CLIENT_HANDLE create_and_open_uws_client_with_permessage_deflate(bool client_no_context_takeover)
+{
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Extensions: permessage-deflate\r\n\r\n";
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { client_no_context_takeover, false, 15, 15, -1 };
+    UWS_CLIENT_HANDLE uws_client;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+
+    return uws_client;
+}
+#endif
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
@@ -478,6 +678,11 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_length, real_BUFFER_length);
     REGISTER_GLOBAL_MOCK_HOOK(uws_frame_encoder_encode, my_uws_frame_encoder_encode);
     REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, "test_str");
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+    REGISTER_GLOBAL_MOCK_HOOK(uws_permessage_deflate_create_offer, my_uws_permessage_deflate_create_offer);
+    REGISTER_GLOBAL_MOCK_HOOK(uws_permessage_deflate_negotiate, my_uws_permessage_deflate_negotiate);
+    REGISTER_GLOBAL_MOCK_RETURN(uws_permessage_deflate_create, TEST_PERMESSAGE_DEFLATE_HANDLE);
+#endif
     REGISTER_TYPE(IO_OPEN_RESULT, IO_OPEN_RESULT);
     REGISTER_TYPE(IO_SEND_RESULT, IO_SEND_RESULT);
     REGISTER_TYPE(WS_OPEN_RESULT, WS_OPEN_RESULT);
@@ -485,6 +690,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_TYPE(WS_ERROR, WS_ERROR);
     REGISTER_TYPE(WS_SEND_FRAME_RESULT, WS_SEND_FRAME_RESULT);
     REGISTER_TYPE(WS_FRAME_TYPE, WS_FRAME_TYPE);
+    REGISTER_TYPE(WS_FRAGMENT, WS_FRAGMENT);
     REGISTER_TYPE(const SOCKETIO_CONFIG*, const_SOCKETIO_CONFIG_ptr);
 
     REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
@@ -505,6 +711,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(pfCloneOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfSetOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfDestroyOption, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(size_t*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(UWS_PERMESSAGE_DEFLATE_HANDLE, void*);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -3774,7 +3982,6 @@ TEST_FUNCTION(when_1_extra_byte_is_received_the_open_complete_is_properly_indica
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
@@ -3789,38 +3996,26 @@ TEST_FUNCTION(when_1_extra_byte_is_received_the_open_complete_is_properly_indica
 /* Tests_SRS_UWS_CLIENT_01_386: [ When a WebSocket data frame is decoded succesfully it shall be indicated via the callback `on_ws_frame_received`. ]*/
 /* Tests_SRS_UWS_CLIENT_01_385: [ If the state of the uws instance is OPEN, the received bytes shall be used for decoding WebSocket frames. ]*/
 /* Tests_SRS_UWS_CLIENT_01_154: [ *  %x2 denotes a binary frame ]*/
-/* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
-/* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_169: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
-/* Tests_SRS_UWS_CLIENT_01_173: [ The "Payload data" is defined as "Extension data" concatenated with "Application data". ]*/
-/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_148: [ The first fragment MAY also be the final fragment. ]*/
-/* Tests_SRS_UWS_CLIENT_01_277: [ To receive WebSocket data, an endpoint listens on the underlying network connection. ]*/
-/* Tests_SRS_UWS_CLIENT_01_278: [ Incoming data MUST be parsed as WebSocket frames as defined in Section 5.2. ]*/
-/* Tests_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
-/* Tests_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
-TEST_FUNCTION(when_a_1_byte_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_535: [ If `on_ws_fragment_received` was set, the payload of data frames shall be indicated via `on_ws_fragment_received` as soon as the frame header has been received, without waiting for the whole frame or for the final fragment of the message. ]*/
+TEST_FUNCTION(when_a_fragment_callback_is_set_a_complete_frame_is_indicated_as_a_complete_fragment)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char test_frame[] = { 0x82, 0x01, 0x42 };
-    const unsigned char expected_payload[] = { 0x42 };
+    const unsigned char test_frame[] = { 0x82, 0x02, 0x42, 0x43 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_fragment_received_callback(uws_client, test_on_ws_fragment_received, (void*)0x4245);
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 1))
-        .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_BINARY, WS_FRAGMENT_COMPLETE, &test_frame[2], 2));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
@@ -3832,35 +4027,37 @@ TEST_FUNCTION(when_a_1_byte_binary_frame_is_received_it_shall_be_indicated_to_th
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_153: [ *  %x1 denotes a text frame ]*/
-/* Tests_SRS_UWS_CLIENT_01_258: [ Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
-/* Tests_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
-/* Tests_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
-TEST_FUNCTION(when_a_1_byte_text_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_535: [ If `on_ws_fragment_received` was set, the payload of data frames shall be indicated via `on_ws_fragment_received` as soon as the frame header has been received, without waiting for the whole frame or for the final fragment of the message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_536: [ The rest of the payload of a data frame whose header was already indicated shall be indicated via `on_ws_fragment_received` as it is received. ]*/
+TEST_FUNCTION(when_a_fragment_callback_is_set_a_partially_received_frame_is_indicated_without_buffering)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char test_frame[] = { 0x81, 0x01, 'a' };
-    const unsigned char expected_payload[] = { 'a' };
+    const unsigned char test_frame_part_1[] = { 0x82, 0x05, 0x42, 0x43 };
+    const unsigned char test_frame_part_2[] = { 0x44, 0x45 };
+    const unsigned char test_frame_part_3[] = { 0x46, 0x82, 0x01, 0x47 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_fragment_received_callback(uws_client, test_on_ws_fragment_received, (void*)0x4245);
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
-        .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_BINARY, WS_FRAGMENT_BEGIN, &test_frame_part_1[2], 2));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_BINARY, WS_FRAGMENT_CONTINUE, &test_frame_part_2[0], 2));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_BINARY, WS_FRAGMENT_END, &test_frame_part_3[0], 1));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_BINARY, WS_FRAGMENT_COMPLETE, &test_frame_part_3[3], 1));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame_part_1, sizeof(test_frame_part_1));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame_part_2, sizeof(test_frame_part_2));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame_part_3, sizeof(test_frame_part_3));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3869,32 +4066,36 @@ TEST_FUNCTION(when_a_1_byte_text_frame_is_received_it_shall_be_indicated_to_the_
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
-/* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_264: [ The "Payload data" is arbitrary binary data whose interpretation is solely up to the application layer. ]*/
-TEST_FUNCTION(when_a_0_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_535: [ If `on_ws_fragment_received` was set, the payload of data frames shall be indicated via `on_ws_fragment_received` as soon as the frame header has been received, without waiting for the whole frame or for the final fragment of the message. ]*/
+TEST_FUNCTION(when_a_fragment_callback_is_set_the_fragments_of_a_text_message_are_indicated_as_they_arrive)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char test_frame[] = { 0x82, 0x00 };
+    const unsigned char test_frames[] = { 0x01, 0x01, 'a', 0x89, 0x00, 0x00, 0x01, 'b', 0x80, 0x01, 'c' };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_fragment_received_callback(uws_client, test_on_ws_fragment_received, (void*)0x4245);
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
-        .IgnoreArgument_buffer();
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_TEXT, WS_FRAGMENT_BEGIN, &test_frames[2], 1));
+    EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG, true, true, 0));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_TEXT, WS_FRAGMENT_CONTINUE, &test_frames[7], 1));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_TEXT, WS_FRAGMENT_END, &test_frames[10], 1));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frames, sizeof(test_frames));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3903,173 +4104,148 @@ TEST_FUNCTION(when_a_0_bytes_binary_frame_is_received_it_shall_be_indicated_to_t
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
-/* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_258: [ Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
-TEST_FUNCTION(when_a_0_bytes_text_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_533: [ Only the bytes that are left undecoded (such as an incomplete frame) shall be accumulated in order to be decoded together with the bytes received in subsequent calls. ]*/
+/* Tests_SRS_UWS_CLIENT_01_386: [ When a WebSocket data frame is decoded succesfully it shall be indicated via the callback `on_ws_frame_received`. ]*/
+TEST_FUNCTION(messages_received_in_random_chunks_are_indicated_whole_with_all_their_bytes)
 {
     // arrange
-    TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char test_frame[] = { 0x81, 0x00 };
-
-    tlsio_config.hostname = "test_host";
-    tlsio_config.port = 444;
+    RANDOM_CHUNKS_RECEIVED expected;
+    RANDOM_CHUNKS_RECEIVED received;
+    unsigned char* stream;
+    size_t stream_length;
 
+    random_chunks_seed = 42;
+    stream = random_chunks_build_stream(&stream_length, &expected);
+    ASSERT_IS_NOT_NULL(stream);
+    (void)memset(&received, 0, sizeof(received));
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, random_chunks_on_ws_frame_received, &received, test_on_ws_peer_closed, (void*)0x4301, random_chunks_on_ws_error, &received);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 0))
-        .IgnoreArgument_buffer();
-
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    random_chunks_receive_stream(stream, stream_length);
 
     // assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, received.error_count);
+    ASSERT_ARE_EQUAL(size_t, expected.message_count, received.message_count);
+    ASSERT_ARE_EQUAL(size_t, expected.byte_count, received.byte_count);
+    ASSERT_ARE_EQUAL(size_t, expected.checksum, received.checksum);
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(stream);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
-/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
-/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
-/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
-TEST_FUNCTION(when_a_fragmented_text_frame_is_received_it_shall_be_indicated_to_the_user_once_fully_received)
+/* Tests_SRS_UWS_CLIENT_01_535: [ If `on_ws_fragment_received` was set, the payload of data frames shall be indicated via `on_ws_fragment_received` as soon as the frame header has been received, without waiting for the whole frame or for the final fragment of the message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_536: [ The rest of the payload of a data frame whose header was already indicated shall be indicated via `on_ws_fragment_received` as it is received. ]*/
+TEST_FUNCTION(messages_received_in_random_chunks_are_streamed_in_order_with_all_their_bytes)
 {
     // arrange
-    TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char first_fragment[125 + 2] = { 0x01, 0x7D };
-    unsigned char middle_fragment[130 + 4] = { 0x00, 0x7E, 0x00, 0x82 };
-    unsigned char last_fragment[2] = { 0x80, 0x00 };
-    unsigned char* result_payload = (unsigned char*)malloc(255);
-    size_t i;
-
-    for (i = 0; i < 255; i++)
-    {
-        if (i < 125)
-        {
-            first_fragment[2 + i] = (unsigned char)i;
-        }
-        else
-        {
-            middle_fragment[4 + (i - 125)] = (unsigned char)i;
-        }
-        result_payload[i] = (unsigned char)i;
-    }
-
-    tlsio_config.hostname = "test_host";
-    tlsio_config.port = 444;
-
-    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    RANDOM_CHUNKS_RECEIVED expected;
+    RANDOM_CHUNKS_RECEIVED received;
+    unsigned char* stream;
+    size_t stream_length;
+
+    random_chunks_seed = 42;
+    stream = random_chunks_build_stream(&stream_length, &expected);
+    ASSERT_IS_NOT_NULL(stream);
+    (void)memset(&received, 0, sizeof(received));
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_fragment_received_callback(uws_client, random_chunks_on_ws_fragment_received, &received);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, random_chunks_on_ws_error, &received);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 255))
-        .ValidateArgumentBuffer(3, result_payload, 255);
-
     // act
-    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
-    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
-    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
+    random_chunks_receive_stream(stream, stream_length);
 
     // assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, received.error_count);
+    ASSERT_ARE_EQUAL(size_t, 0, received.order_errors);
+    ASSERT_IS_FALSE(received.in_message);
+    ASSERT_ARE_EQUAL(size_t, expected.message_count, received.message_count);
+    ASSERT_ARE_EQUAL(size_t, expected.byte_count, received.byte_count);
+    ASSERT_ARE_EQUAL(size_t, expected.checksum, received.checksum);
 
     // cleanup
-    free(result_payload);
     uws_client_destroy(uws_client);
+    free(stream);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
-/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
-/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
-/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
-TEST_FUNCTION(when_a_fragmented_binary_frame_is_received_it_shall_be_indicated_to_the_user_once_fully_received)
+/* Tests_SRS_UWS_CLIENT_01_537: [ If `on_ws_fragment_received` was not set and the data frame would make the message exceed the `ws_max_message_size` option, uws shall send a CLOSE frame with code 1009 and indicate `WS_ERROR_MESSAGE_TOO_BIG` via `on_ws_error`, before receiving the frame payload. ]*/
+TEST_FUNCTION(when_a_frame_exceeds_the_max_message_size_the_connection_is_failed_with_1009)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char first_fragment[125 + 2] = { 0x02, 0x7D };
-    unsigned char middle_fragment[130 + 4] = { 0x00, 0x7E, 0x00, 0x82 };
-    unsigned char last_fragment[2] = { 0x80, 0x00 };
-    unsigned char* result_payload = (unsigned char*)malloc(255);
-    size_t i;
-
-    for (i = 0; i < 255; i++)
-    {
-        if (i < 125)
-        {
-            first_fragment[2 + i] = (unsigned char)i;
-        }
-        else
-        {
-            middle_fragment[4 + (i - 125)] = (unsigned char)i;
-        }
-        result_payload[i] = (unsigned char)i;
-    }
+    const unsigned char test_frame_header[] = { 0x82, 0x7E, 0x00, 0x80 };
+    unsigned char close_frame_payload[] = { 0x03, 0xF1 };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xF1 };
+    size_t max_message_size = 100;
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_max_message_size", &max_message_size);
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 255))
-        .ValidateArgumentBuffer(3, result_payload, 255);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_MESSAGE_TOO_BIG));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
-    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
-    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame_header, sizeof(test_frame_header));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    free(result_payload);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_217: [ The fragments of one message MUST NOT be interleaved between the fragments of another message unless an extension has been negotiated that can interpret the interleaving. ]*/
-TEST_FUNCTION(when_a_fragmented_frame_is_interleaved_within_another_fragmented_frame_there_is_an_error)
+/* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
+/* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_169: [ The payload length is the length of the "Extension data" + the length of the "Application data". ]*/
+/* Tests_SRS_UWS_CLIENT_01_173: [ The "Payload data" is defined as "Extension data" concatenated with "Application data". ]*/
+/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_148: [ The first fragment MAY also be the final fragment. ]*/
+/* Tests_SRS_UWS_CLIENT_01_277: [ To receive WebSocket data, an endpoint listens on the underlying network connection. ]*/
+/* Tests_SRS_UWS_CLIENT_01_278: [ Incoming data MUST be parsed as WebSocket frames as defined in Section 5.2. ]*/
+/* Tests_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
+/* Tests_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
+TEST_FUNCTION(when_a_1_byte_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char fragment1[2] = {0x02, 0x00};
-    unsigned char fragment2[2] = {0x02, 0x00};
+    const unsigned char test_frame[] = { 0x82, 0x01, 0x42 };
+    const unsigned char expected_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4080,14 +4256,11 @@ TEST_FUNCTION(when_a_fragmented_frame_is_interleaved_within_another_fragmented_f
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
-
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
+
     // act
-    g_on_bytes_received(g_on_bytes_received_context, fragment1, sizeof(fragment1));
-    g_on_bytes_received(g_on_bytes_received_context, fragment2, sizeof(fragment2));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4096,19 +4269,19 @@ TEST_FUNCTION(when_a_fragmented_frame_is_interleaved_within_another_fragmented_f
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
-/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
-/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
-/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
-TEST_FUNCTION(when_a_fragmented_frame_is_received_all_at_once_the_frame_is_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_153: [ *  %x1 denotes a text frame ]*/
+/* Tests_SRS_UWS_CLIENT_01_258: [ Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
+/* Tests_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
+/* Tests_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
+TEST_FUNCTION(when_a_1_byte_text_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_stream[2 + 3 + 2] = { 0x02, 0x00, 0x00, 0x01, 0x00, 0x80, 0x00};
+    const unsigned char test_frame[] = { 0x81, 0x01, 'a' };
+    const unsigned char expected_payload[] = { 'a' };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4119,15 +4292,12 @@ TEST_FUNCTION(when_a_fragmented_frame_is_received_all_at_once_the_frame_is_indic
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 1))
-        .IgnoreArgument_buffer();
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_stream, sizeof(test_stream));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
@@ -4135,41 +4305,14 @@ TEST_FUNCTION(when_a_fragmented_frame_is_received_all_at_once_the_frame_is_indic
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
-/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
-/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
-/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
-/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
-/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
-/* Tests_SRS_UWS_CLIENT_01_214: [ Control frames (see Section 5.5) MAY be injected in the middle of a fragmented message. ]*/  
-TEST_FUNCTION(pong_frame_can_be_injected_in_middle_of_fragmented_message)
+/* Tests_SRS_UWS_CLIENT_01_532: [ If no bytes are pending from previous calls, the WebSocket frames shall be decoded directly from `buffer` and the payload indicated via `on_ws_frame_received` shall point into `buffer`, without copying the received bytes. ]*/
+TEST_FUNCTION(when_a_complete_frame_is_received_the_payload_is_indicated_from_the_received_bytes)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char first_fragment[125 + 2] = { 0x01, 0x7D };
-    unsigned char middle_fragment[130 + 4] = { 0x00, 0x7E, 0x00, 0x82 };
-    unsigned char last_fragment[2] = { 0x80, 0x00 };
-    const unsigned char ping_frame[] = { 0x89, 0x00 };
-    unsigned char pong_frame[] = {0x8A, 0x00, 0x00, 0x00, 0x00, 0x00};
-    BUFFER_HANDLE buffer_handle;
-
-    unsigned char* result_payload = (unsigned char*)malloc(255);
-    size_t i;
-
-    for (i = 0; i < 255; i++)
-    {
-        if (i < 125)
-        {
-            first_fragment[2 + i] = (unsigned char)i;
-        }
-        else
-        {
-            middle_fragment[4 + (i - 125)] = (unsigned char)i;
-        }
-        result_payload[i] = (unsigned char)i;
-    }
+    const unsigned char test_frames[] = { 0x82, 0x02, 0x42, 0x43, 0x82, 0x01, 0x44 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4180,53 +4323,30 @@ TEST_FUNCTION(pong_frame_can_be_injected_in_middle_of_fragmented_message)
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, IGNORED_PTR_ARG, 0, true, true, 0))
-        .IgnoreArgument_payload()
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(pong_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(pong_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, pong_frame, sizeof(pong_frame), IGNORED_PTR_ARG, NULL))
-        .ValidateArgumentBuffer(2, pong_frame, sizeof(pong_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 255))
-        .ValidateArgumentBuffer(3, result_payload, 255);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frames[2], 2));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frames[6], 1));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)ping_frame, sizeof(ping_frame));
-    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
-    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, test_frames, sizeof(test_frames));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    free(result_payload);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_215: [ Control frames themselves MUST NOT be fragmented. ]*/
-TEST_FUNCTION(when_a_fragmented_control_frame_is_received_there_is_an_error)
+/* Tests_SRS_UWS_CLIENT_01_533: [ Only the bytes that are left undecoded (such as an incomplete frame) shall be accumulated in order to be decoded together with the bytes received in subsequent calls. ]*/
+TEST_FUNCTION(when_a_frame_is_split_across_2_calls_the_frame_is_indicated_once_complete)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char test_frame[] = {0x09, 0x00};
+    const unsigned char test_frame_part_1[] = { 0x82, 0x01, 0x42, 0x82, 0x02, 0x43 };
+    const unsigned char test_frame_part_2[] = { 0x44 };
+    const unsigned char expected_payload_1[] = { 0x42 };
+    const unsigned char expected_payload_2[] = { 0x43, 0x44 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4237,11 +4357,14 @@ TEST_FUNCTION(when_a_fragmented_control_frame_is_received_there_is_an_error)
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(3, expected_payload_1, sizeof(expected_payload_1));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 2))
+        .ValidateArgumentBuffer(3, expected_payload_2, sizeof(expected_payload_2));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame_part_1, sizeof(test_frame_part_1));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame_part_2, sizeof(test_frame_part_2));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4253,20 +4376,13 @@ TEST_FUNCTION(when_a_fragmented_control_frame_is_received_there_is_an_error)
 /* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
 /* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
 /* Tests_SRS_UWS_CLIENT_01_264: [ The "Payload data" is arbitrary binary data whose interpretation is solely up to the application layer. ]*/
-/* Tests_SRS_UWS_CLIENT_01_258: [ Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
-TEST_FUNCTION(when_a_125_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+TEST_FUNCTION(when_a_0_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[125 + 2] = { 0x82, 0x7D };
-    size_t i;
-
-    for (i = 0; i < 125; i++)
-    {
-        test_frame[2 + i] = (unsigned char)i;
-    }
+    const unsigned char test_frame[] = { 0x82, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4277,9 +4393,8 @@ TEST_FUNCTION(when_a_125_bytes_binary_frame_is_received_it_shall_be_indicated_to
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 125))
-        .ValidateArgumentBuffer(3, &test_frame[2], 125);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
+        .IgnoreArgument_buffer();
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
@@ -4291,21 +4406,16 @@ TEST_FUNCTION(when_a_125_bytes_binary_frame_is_received_it_shall_be_indicated_to
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-TEST_FUNCTION(when_a_126_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
+/* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_258: [ Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
+TEST_FUNCTION(when_a_0_bytes_text_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[126 + 4] = { 0x82, 0x7E, 0x00, 0x7E };
-    size_t i;
-
-    for (i = 0; i < 126; i++)
-    {
-        test_frame[4 + i] = (unsigned char)i;
-    }
+    const unsigned char test_frame[] = { 0x81, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4316,9 +4426,8 @@ TEST_FUNCTION(when_a_126_bytes_binary_frame_is_received_it_shall_be_indicated_to
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 126))
-        .ValidateArgumentBuffer(3, &test_frame[4], 126);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 0))
+        .IgnoreArgument_buffer();
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
@@ -4330,20 +4439,35 @@ TEST_FUNCTION(when_a_126_bytes_binary_frame_is_received_it_shall_be_indicated_to
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-TEST_FUNCTION(when_a_127_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
+/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
+/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
+/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
+/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
+TEST_FUNCTION(when_a_fragmented_text_frame_is_received_it_shall_be_indicated_to_the_user_once_fully_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[127 + 4] = { 0x82, 0x7E, 0x00, 0x7F };
+    unsigned char first_fragment[125 + 2] = { 0x01, 0x7D };
+    unsigned char middle_fragment[130 + 4] = { 0x00, 0x7E, 0x00, 0x82 };
+    unsigned char last_fragment[2] = { 0x80, 0x00 };
+    unsigned char* result_payload = (unsigned char*)malloc(255);
     size_t i;
 
-    for (i = 0; i < 127; i++)
+    for (i = 0; i < 255; i++)
     {
-        test_frame[4 + i] = (unsigned char)i;
+        if (i < 125)
+        {
+            first_fragment[2 + i] = (unsigned char)i;
+        }
+        else
+        {
+            middle_fragment[4 + (i - 125)] = (unsigned char)i;
+        }
+        result_payload[i] = (unsigned char)i;
     }
 
     tlsio_config.hostname = "test_host";
@@ -4356,37 +4480,52 @@ TEST_FUNCTION(when_a_127_bytes_binary_frame_is_received_it_shall_be_indicated_to
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 127))
-        .ValidateArgumentBuffer(3, &test_frame[4], 127);
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 255))
+        .ValidateArgumentBuffer(3, result_payload, 255);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    free(result_payload);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-TEST_FUNCTION(when_a_65535_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
+/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
+/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
+/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
+/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
+TEST_FUNCTION(when_a_fragmented_binary_frame_is_received_it_shall_be_indicated_to_the_user_once_fully_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char* test_frame = (unsigned char*)malloc(65535 + 4);
+    unsigned char first_fragment[125 + 2] = { 0x02, 0x7D };
+    unsigned char middle_fragment[130 + 4] = { 0x00, 0x7E, 0x00, 0x82 };
+    unsigned char last_fragment[2] = { 0x80, 0x00 };
+    unsigned char* result_payload = (unsigned char*)malloc(255);
     size_t i;
-    test_frame[0] = 0x82;
-    test_frame[1] = 0x7E;
-    test_frame[2] = 0xFF;
-    test_frame[3] = 0xFF;
 
-    for (i = 0; i < 65535; i++)
+    for (i = 0; i < 255; i++)
     {
-        test_frame[4 + i] = (unsigned char)i;
+        if (i < 125)
+        {
+            first_fragment[2 + i] = (unsigned char)i;
+        }
+        else
+        {
+            middle_fragment[4 + (i - 125)] = (unsigned char)i;
+        }
+        result_payload[i] = (unsigned char)i;
     }
 
     tlsio_config.hostname = "test_host";
@@ -4399,45 +4538,32 @@ TEST_FUNCTION(when_a_65535_bytes_binary_frame_is_received_it_shall_be_indicated_
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65535))
-        .ValidateArgumentBuffer(3, &test_frame[4], 65535);
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 255))
+        .ValidateArgumentBuffer(3, result_payload, 255);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65535 + 4);
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    free(test_frame);
+    free(result_payload);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-TEST_FUNCTION(when_a_65536_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_217: [ The fragments of one message MUST NOT be interleaved between the fragments of another message unless an extension has been negotiated that can interpret the interleaving. ]*/
+TEST_FUNCTION(when_a_fragmented_frame_is_interleaved_within_another_fragmented_frame_there_is_an_error)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char* test_frame = (unsigned char*)malloc(65536 + 10);
-    size_t i;
-    test_frame[0] = 0x82;
-    test_frame[1] = 0x7F;
-    test_frame[2] = 0x00;
-    test_frame[3] = 0x00;
-    test_frame[4] = 0x00;
-    test_frame[5] = 0x00;
-    test_frame[6] = 0x00;
-    test_frame[7] = 0x01;
-    test_frame[8] = 0x00;
-    test_frame[9] = 0x00;
-
-    for (i = 0; i < 65536; i++)
-    {
-        test_frame[10 + i] = (unsigned char)i;
-    }
+    unsigned char fragment1[2] = {0x02, 0x00};
+    unsigned char fragment2[2] = {0x02, 0x00};
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4448,46 +4574,32 @@ TEST_FUNCTION(when_a_65536_bytes_binary_frame_is_received_it_shall_be_indicated_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65536))
-        .ValidateArgumentBuffer(3, &test_frame[10], 65536);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65536 + 10);
+    g_on_bytes_received(g_on_bytes_received_context, fragment1, sizeof(fragment1));
+    g_on_bytes_received(g_on_bytes_received_context, fragment2, sizeof(fragment2));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    free(test_frame);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-TEST_FUNCTION(when_a_65537_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
+/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
+/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
+/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
+/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
+TEST_FUNCTION(when_a_fragmented_frame_is_received_all_at_once_the_frame_is_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char* test_frame = (unsigned char*)malloc(65537 + 10);
-    size_t i;
-    test_frame[0] = 0x82;
-    test_frame[1] = 0x7F;
-    test_frame[2] = 0x00;
-    test_frame[3] = 0x00;
-    test_frame[4] = 0x00;
-    test_frame[5] = 0x00;
-    test_frame[6] = 0x00;
-    test_frame[7] = 0x01;
-    test_frame[8] = 0x00;
-    test_frame[9] = 0x01;
-
-    for (i = 0; i < 65537; i++)
-    {
-        test_frame[10 + i] = (unsigned char)i;
-    }
+    unsigned char test_stream[2 + 3 + 2] = { 0x02, 0x00, 0x00, 0x01, 0x00, 0x80, 0x00};
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4499,29 +4611,53 @@ TEST_FUNCTION(when_a_65537_bytes_binary_frame_is_received_it_shall_be_indicated_
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65537))
-        .ValidateArgumentBuffer(3, &test_frame[10], 65537);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 1))
+        .IgnoreArgument_buffer();
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65537 + 10);
-
+    g_on_bytes_received(g_on_bytes_received_context, test_stream, sizeof(test_stream));
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    free(test_frame);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_16_bit_length_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
+/* Tests_SRS_UWS_CLIENT_01_147: [ Indicates that this is the final fragment in a message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_152: [* *  %x0 denotes a continuation frame *]*/
+/* Tests_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
+/* Tests_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
+/* Tests_SRS_UWS_CLIENT_01_225: [ As a consequence of these rules, all fragments of a message are of the same type, as set by the first fragment's opcode. ]*/
+/* Tests_SRS_UWS_CLIENT_01_214: [ Control frames (see Section 5.5) MAY be injected in the middle of a fragmented message. ]*/  
+TEST_FUNCTION(pong_frame_can_be_injected_in_middle_of_fragmented_message)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x7E, 0x00, 0x00 };
+    unsigned char first_fragment[125 + 2] = { 0x01, 0x7D };
+    unsigned char middle_fragment[130 + 4] = { 0x00, 0x7E, 0x00, 0x82 };
+    unsigned char last_fragment[2] = { 0x80, 0x00 };
+    const unsigned char ping_frame[] = { 0x89, 0x00 };
+    unsigned char pong_frame[] = {0x8A, 0x00, 0x00, 0x00, 0x00, 0x00};
+    BUFFER_HANDLE buffer_handle;
+
+    unsigned char* result_payload = (unsigned char*)malloc(255);
+    size_t i;
+
+    for (i = 0; i < 255; i++)
+    {
+        if (i < 125)
+        {
+            first_fragment[2 + i] = (unsigned char)i;
+        }
+        else
+        {
+            middle_fragment[4 + (i - 125)] = (unsigned char)i;
+        }
+        result_payload[i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4533,33 +4669,46 @@ TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_16_bit_length_an_error
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, IGNORED_PTR_ARG, 0, true, true, 0))
+        .IgnoreArgument_payload()
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(pong_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(pong_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, pong_frame, sizeof(pong_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, pong_frame, sizeof(pong_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 255))
+        .ValidateArgumentBuffer(3, result_payload, 255);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)ping_frame, sizeof(ping_frame));
+    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    free(result_payload);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(when_a_125_byte_binary_frame_is_received_with_16_bit_length_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_215: [ Control frames themselves MUST NOT be fragmented. ]*/
+TEST_FUNCTION(when_a_fragmented_control_frame_is_received_there_is_an_error)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[125 + 4] = { 0x82, 0x7E, 0x00, 0x7D };
-    size_t i;
-
-    for (i = 0; i < 125; i++)
-    {
-        test_frame[4 + i] = (unsigned char)i;
-    }
+    const unsigned char test_frame[] = {0x09, 0x00};
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4570,7 +4719,6 @@ TEST_FUNCTION(when_a_125_byte_binary_frame_is_received_with_16_bit_length_an_err
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -4583,15 +4731,23 @@ TEST_FUNCTION(when_a_125_byte_binary_frame_is_received_with_16_bit_length_an_err
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_64_bit_length_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
+/* Tests_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_264: [ The "Payload data" is arbitrary binary data whose interpretation is solely up to the application layer. ]*/
+/* Tests_SRS_UWS_CLIENT_01_258: [ Currently defined opcodes for data frames include 0x1 (Text), 0x2 (Binary). ]*/
+TEST_FUNCTION(when_a_125_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    unsigned char test_frame[125 + 2] = { 0x82, 0x7D };
+    size_t i;
+
+    for (i = 0; i < 125; i++)
+    {
+        test_frame[2 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4602,8 +4758,8 @@ TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_64_bit_length_an_error
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 125))
+        .ValidateArgumentBuffer(3, &test_frame[2], 125);
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
@@ -4615,30 +4771,20 @@ TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_64_bit_length_an_error
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(when_a_65535_byte_binary_frame_is_received_with_64_bit_length_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+TEST_FUNCTION(when_a_126_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char* test_frame = (unsigned char*)malloc(65535 + 10);
+    unsigned char test_frame[126 + 4] = { 0x82, 0x7E, 0x00, 0x7E };
     size_t i;
-    test_frame[0] = 0x82;
-    test_frame[1] = 0x7F;
-    test_frame[2] = 0x00;
-    test_frame[3] = 0x00;
-    test_frame[4] = 0x00;
-    test_frame[5] = 0x00;
-    test_frame[6] = 0x00;
-    test_frame[7] = 0x00;
-    test_frame[8] = 0xFF;
-    test_frame[9] = 0xFF;
 
-    for (i = 0; i < 65535; i++)
+    for (i = 0; i < 126; i++)
     {
-        test_frame[10 + i] = (unsigned char)i;
+        test_frame[4 + i] = (unsigned char)i;
     }
 
     tlsio_config.hostname = "test_host";
@@ -4650,29 +4796,34 @@ TEST_FUNCTION(when_a_65535_byte_binary_frame_is_received_with_64_bit_length_an_e
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 126))
+        .ValidateArgumentBuffer(3, &test_frame[4], 126);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65535 + 10);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
-    free(test_frame);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(check_for_16_bit_length_too_low_is_done_as_soon_as_length_is_received)
+/* Tests_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+TEST_FUNCTION(when_a_127_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x7E, 0x00, 0x7D };
+    unsigned char test_frame[127 + 4] = { 0x82, 0x7E, 0x00, 0x7F };
+    size_t i;
+
+    for (i = 0; i < 127; i++)
+    {
+        test_frame[4 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4683,8 +4834,8 @@ TEST_FUNCTION(check_for_16_bit_length_too_low_is_done_as_soon_as_length_is_recei
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 127))
+        .ValidateArgumentBuffer(3, &test_frame[4], 127);
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
@@ -4696,15 +4847,25 @@ TEST_FUNCTION(check_for_16_bit_length_too_low_is_done_as_soon_as_length_is_recei
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(check_for_64_bit_length_too_low_is_done_as_soon_as_length_is_received)
+/* Tests_SRS_UWS_CLIENT_01_165: [ If 126, the following 2 bytes interpreted as a 16-bit unsigned integer are the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+TEST_FUNCTION(when_a_65535_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
+    unsigned char* test_frame = (unsigned char*)malloc(65535 + 4);
+    size_t i;
+    test_frame[0] = 0x82;
+    test_frame[1] = 0x7E;
+    test_frame[2] = 0xFF;
+    test_frame[3] = 0xFF;
+
+    for (i = 0; i < 65535; i++)
+    {
+        test_frame[4 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4715,22 +4876,23 @@ TEST_FUNCTION(check_for_64_bit_length_too_low_is_done_as_soon_as_length_is_recei
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65535))
+        .ValidateArgumentBuffer(3, &test_frame[4], 65535);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65535 + 4);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    free(test_frame);
     uws_client_destroy(uws_client);
 }
 
 /* Tests_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
-/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
-TEST_FUNCTION(when_the_highest_bit_is_set_in_a_64_bit_length_frame_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+TEST_FUNCTION(when_a_65536_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
@@ -4740,7 +4902,7 @@ TEST_FUNCTION(when_the_highest_bit_is_set_in_a_64_bit_length_frame_an_error_is_i
     size_t i;
     test_frame[0] = 0x82;
     test_frame[1] = 0x7F;
-    test_frame[2] = 0x80;
+    test_frame[2] = 0x00;
     test_frame[3] = 0x00;
     test_frame[4] = 0x00;
     test_frame[5] = 0x00;
@@ -4763,8 +4925,8 @@ TEST_FUNCTION(when_the_highest_bit_is_set_in_a_64_bit_length_frame_an_error_is_i
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65536))
+        .ValidateArgumentBuffer(3, &test_frame[10], 65536);
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, 65536 + 10);
@@ -4773,18 +4935,35 @@ TEST_FUNCTION(when_the_highest_bit_is_set_in_a_64_bit_length_frame_an_error_is_i
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    uws_client_destroy(uws_client);
     free(test_frame);
+    uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
-TEST_FUNCTION(when_allocating_memory_for_the_received_frame_bytes_fails_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
+TEST_FUNCTION(when_a_65537_bytes_binary_frame_is_received_it_shall_be_indicated_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x00 };
+    unsigned char* test_frame = (unsigned char*)malloc(65537 + 10);
+    size_t i;
+    test_frame[0] = 0x82;
+    test_frame[1] = 0x7F;
+    test_frame[2] = 0x00;
+    test_frame[3] = 0x00;
+    test_frame[4] = 0x00;
+    test_frame[5] = 0x00;
+    test_frame[6] = 0x00;
+    test_frame[7] = 0x01;
+    test_frame[8] = 0x00;
+    test_frame[9] = 0x01;
+
+    for (i = 0; i < 65537; i++)
+    {
+        test_frame[10 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4795,32 +4974,29 @@ TEST_FUNCTION(when_allocating_memory_for_the_received_frame_bytes_fails_an_error
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
-        .SetReturn(NULL);
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_NOT_ENOUGH_MEMORY));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 65537))
+        .ValidateArgumentBuffer(3, &test_frame[10], 65537);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65537 + 10);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    free(test_frame);
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-TEST_FUNCTION(when_1_byte_is_received_together_with_the_upgrade_request_and_one_byte_with_a_separate_call_decoding_frame_succeeds)
+/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_16_bit_length_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char* upgrade_response_frame = (unsigned char*)malloc(sizeof(test_upgrade_response));
-    unsigned char test_frame[] = { 0x00 };
-
-    (void)memcpy(upgrade_response_frame, test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    upgrade_response_frame[sizeof(test_upgrade_response) - 1] = 0x82;
+    unsigned char test_frame[] = { 0x82, 0x7E, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4828,12 +5004,10 @@ TEST_FUNCTION(when_1_byte_is_received_together_with_the_upgrade_request_and_one_
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)upgrade_response_frame, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
-        .IgnoreArgument_buffer();
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
@@ -4843,22 +5017,23 @@ TEST_FUNCTION(when_1_byte_is_received_together_with_the_upgrade_request_and_one_
 
     // cleanup
     uws_client_destroy(uws_client);
-    free(upgrade_response_frame);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-TEST_FUNCTION(when_a_complete_frame_is_received_together_with_the_upgrade_request_the_frame_is_indicated_as_received)
+/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(when_a_125_byte_binary_frame_is_received_with_16_bit_length_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    size_t received_data_length = sizeof(test_upgrade_response) + 1;
-    unsigned char* received_data = (unsigned char*)malloc(received_data_length);
+    unsigned char test_frame[125 + 4] = { 0x82, 0x7E, 0x00, 0x7D };
+    size_t i;
 
-    (void)memcpy(received_data, test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    received_data[received_data_length - 2] = 0x82;
-    received_data[received_data_length - 1] = 0x00;
+    for (i = 0; i < 125; i++)
+    {
+        test_frame[4 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4866,39 +5041,30 @@ TEST_FUNCTION(when_a_complete_frame_is_received_together_with_the_upgrade_reques
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
-        .IgnoreArgument_buffer();
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
-    free(received_data);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-TEST_FUNCTION(when_a_1_byte_complete_frame_is_received_together_with_the_upgrade_request_the_frame_is_indicated_as_received)
+/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(when_a_0_byte_binary_frame_is_received_with_64_bit_length_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    size_t received_data_length = sizeof(test_upgrade_response) + 2;
-    unsigned char* received_data = (unsigned char*)malloc(received_data_length);
-    unsigned char expected_frame_payload[] = { 0x42 };
-
-    (void)memcpy(received_data, test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    received_data[received_data_length - 1] = 0x42;
-    received_data[received_data_length - 2] = 0x01;
-    received_data[received_data_length - 3] = 0x82;
+    unsigned char test_frame[] = { 0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4906,40 +5072,46 @@ TEST_FUNCTION(when_a_1_byte_complete_frame_is_received_together_with_the_upgrade
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, expected_frame_payload, sizeof(expected_frame_payload)))
-        .ValidateArgumentBuffer(3, expected_frame_payload, sizeof(expected_frame_payload));
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
-    free(received_data);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-TEST_FUNCTION(when_2_complete_frames_are_received_together_with_the_upgrade_request_the_frames_are_indicated_as_received)
+/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(when_a_65535_byte_binary_frame_is_received_with_64_bit_length_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    size_t received_data_length = sizeof(test_upgrade_response) + 4;
-    unsigned char* received_data = (unsigned char*)malloc(received_data_length);
+    unsigned char* test_frame = (unsigned char*)malloc(65535 + 10);
+    size_t i;
+    test_frame[0] = 0x82;
+    test_frame[1] = 0x7F;
+    test_frame[2] = 0x00;
+    test_frame[3] = 0x00;
+    test_frame[4] = 0x00;
+    test_frame[5] = 0x00;
+    test_frame[6] = 0x00;
+    test_frame[7] = 0x00;
+    test_frame[8] = 0xFF;
+    test_frame[9] = 0xFF;
 
-    (void)memcpy(received_data, test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    received_data[received_data_length - 5] = 0x81;
-    received_data[received_data_length - 4] = 0x01;
-    received_data[received_data_length - 3] = 'a';
-    received_data[received_data_length - 2] = 0x82;
-    received_data[received_data_length - 1] = 0x00;
+    for (i = 0; i < 65535; i++)
+    {
+        test_frame[10 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4947,40 +5119,31 @@ TEST_FUNCTION(when_2_complete_frames_are_received_together_with_the_upgrade_requ
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
-        .ValidateArgumentBuffer(3, "a", 1);
-    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
-        .IgnoreArgument_buffer();
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65535 + 10);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
-    free(received_data);
+    free(test_frame);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
-/* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
-/* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_masked_frame_is_received_an_error_is_indicated_and_connection_is_closed)
+/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(check_for_16_bit_length_too_low_is_done_as_soon_as_length_is_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x80 };
-    unsigned char close_frame_payload[] = { 0x03, 0xEA };
-    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEA };
-    BUFFER_HANDLE buffer_handle;
+    unsigned char test_frame[] = { 0x82, 0x7E, 0x00, 0x7D };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -4988,23 +5151,9 @@ TEST_FUNCTION(when_a_masked_frame_is_received_an_error_is_indicated_and_connecti
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
-        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(close_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
-        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -5017,36 +5166,25 @@ TEST_FUNCTION(when_a_masked_frame_is_received_an_error_is_indicated_and_connecti
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
-/* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
-/* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_masked_frame_is_received_and_encoding_the_close_frame_fails_an_error_is_indicated_anyhow)
+/* Tests_SRS_UWS_CLIENT_01_168: [ Note that in all cases, the minimal number of bytes MUST be used to encode the length, for example, the length of a 124-byte-long string can't be encoded as the sequence 126, 0, 124. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(check_for_64_bit_length_too_low_is_done_as_soon_as_length_is_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x80 };
-    unsigned char close_frame_payload[] = { 0x03, 0xEA };
-    BUFFER_HANDLE buffer_handle;
+    unsigned char test_frame[] = { 0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new())
-        .CaptureReturn(&buffer_handle);
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
-        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
-        .SetReturn(NULL);
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
@@ -5059,20 +5197,31 @@ TEST_FUNCTION(when_a_masked_frame_is_received_and_encoding_the_close_frame_fails
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
-/* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
-/* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_masked_frame_is_received_and_sending_the_encoded_CLOSE_frame_fails_an_error_is_indicated_anyhow)
+/* Tests_SRS_UWS_CLIENT_01_166: [ If 127, the following 8 bytes interpreted as a 64-bit unsigned integer (the most significant bit MUST be 0) are the payload length. ]*/
+/* Tests_SRS_UWS_CLIENT_01_419: [ If there is an error decoding the WebSocket frame, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_BAD_FRAME_RECEIVED`. ]*/
+TEST_FUNCTION(when_the_highest_bit_is_set_in_a_64_bit_length_frame_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_frame[] = { 0x82, 0x80 };
-    unsigned char close_frame_payload[] = { 0x03, 0xEA };
-    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEA };
-    BUFFER_HANDLE buffer_handle;
+    unsigned char* test_frame = (unsigned char*)malloc(65536 + 10);
+    size_t i;
+    test_frame[0] = 0x82;
+    test_frame[1] = 0x7F;
+    test_frame[2] = 0x80;
+    test_frame[3] = 0x00;
+    test_frame[4] = 0x00;
+    test_frame[5] = 0x00;
+    test_frame[6] = 0x00;
+    test_frame[7] = 0x01;
+    test_frame[8] = 0x00;
+    test_frame[9] = 0x00;
+
+    for (i = 0; i < 65536; i++)
+    {
+        test_frame[10 + i] = (unsigned char)i;
+    }
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5080,57 +5229,31 @@ TEST_FUNCTION(when_a_masked_frame_is_received_and_sending_the_encoded_CLOSE_fram
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
-        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(close_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
-        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame))
-        .SetReturn(1);
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
     STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, 65536 + 10);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(test_frame);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_460: [ When a CLOSE frame is received the callback `on_ws_peer_closed` passed to `uws_client_open_async` shall be called, while passing to it the argument `on_ws_peer_closed_context`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_156: [ *  %x8 denotes a connection close ]*/
-/* Tests_SRS_UWS_CLIENT_01_234: [ The Close frame contains an opcode of 0x8. ]*/
-/* Tests_SRS_UWS_CLIENT_01_235: [ The Close frame MAY contain a body (the "Application data" portion of the frame) that indicates a reason for closing, such as an endpoint shutting down, an endpoint having received a frame too large, or an endpoint having received a frame that does not conform to the format expected by the endpoint. ]*/
-/* Tests_SRS_UWS_CLIENT_01_236: [ If there is a body, the first two bytes of the body MUST be a 2-byte unsigned integer (in network byte order) representing a status code with value /code/ defined in Section 7.4. ]*/
-/* Tests_SRS_UWS_CLIENT_01_461: [ The argument `close_code` shall be set to point to the code extracted from the CLOSE frame. ]*/
-/* Tests_SRS_UWS_CLIENT_01_296: [ Upon either sending or receiving a Close control frame, it is said that _The WebSocket Closing Handshake is Started_ and that the WebSocket connection is in the CLOSING state. ]*/
-/* Tests_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
-/* Tests_SRS_UWS_CLIENT_01_242: [ It SHOULD do so as soon as practical. ]*/
-/* Tests_SRS_UWS_CLIENT_01_239: [ Close frames sent from client to server must be masked as per Section 5.3. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_the_code_is_reported_to_the_user)
+/* Tests_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
+TEST_FUNCTION(when_allocating_memory_for_the_received_frame_bytes_fails_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
-    BUFFER_HANDLE buffer_handle;
-    uint16_t expected_close_code = 1002;
-    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
+    /* incomplete frame, larger than the bytes already held for the upgrade response, so it has to be accumulated */
+    unsigned char test_frame[64] = { 0x82, 0x7E, 0x00, 0x80 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5141,26 +5264,12 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_the_code_is_reported_
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sent_close_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(sent_close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_send_complete();
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, NULL, 0))
-        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_NOT_ENOUGH_MEMORY));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -5169,21 +5278,18 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_the_code_is_reported_
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_460: [ When a CLOSE frame is received the callback `on_ws_peer_closed` passed to `uws_client_open_async` shall be called, while passing to it the argument `on_ws_peer_closed_context`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_156: [ *  %x8 denotes a connection close ]*/
-/* Tests_SRS_UWS_CLIENT_01_234: [ The Close frame contains an opcode of 0x8. ]*/
-/* Tests_SRS_UWS_CLIENT_01_462: [ If no code can be extracted then `close_code` shall be NULL. ]*/
-/* Tests_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_CLOSE_frame_is_received_without_a_close_code_while_in_open_the_callback_is_triggered)
+/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
+TEST_FUNCTION(when_1_byte_is_received_together_with_the_upgrade_request_and_one_byte_with_a_separate_call_decoding_frame_succeeds)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x00 };
-    BUFFER_HANDLE buffer_handle;
-    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
+    unsigned char* upgrade_response_frame = (unsigned char*)malloc(sizeof(test_upgrade_response));
+    unsigned char test_frame[] = { 0x00 };
+
+    (void)memcpy(upgrade_response_frame, test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    upgrade_response_frame[sizeof(test_upgrade_response) - 1] = 0x82;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5191,50 +5297,36 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_without_a_close_code_while_in_open_
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)upgrade_response_frame, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sent_close_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(sent_close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_send_complete();
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, NULL, NULL, 0));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
+        .IgnoreArgument_buffer();
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(upgrade_response_frame);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_463: [ The extra bytes (besides the close code) shall be passed to the `on_ws_peer_closed` callback by using `extra_data` and `extra_data_length`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_extra_bytes_the_bytes_are_passed_to_the_callback)
+/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
+TEST_FUNCTION(when_a_complete_frame_is_received_together_with_the_upgrade_request_the_frame_is_indicated_as_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x04, 0x03, 0xEA, 0x42, 0x43 };
-    BUFFER_HANDLE buffer_handle;
-    uint16_t expected_close_code = 1002;
-    unsigned char expected_extra_data[] = { 0x42, 0x43 };
-    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
+    size_t received_data_length = sizeof(test_upgrade_response) + 1;
+    unsigned char* received_data = (unsigned char*)malloc(received_data_length);
+
+    (void)memcpy(received_data, test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    received_data[received_data_length - 2] = 0x82;
+    received_data[received_data_length - 1] = 0x00;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5242,49 +5334,39 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_extra_bytes_the_bytes_are_pass
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 2))
-        .ValidateArgumentBuffer(1, &close_frame[4], 2);
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sent_close_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(sent_close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_send_complete();
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, IGNORED_PTR_ARG, sizeof(expected_extra_data)))
-        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code))
-        .ValidateArgumentBuffer(3, &expected_extra_data, sizeof(expected_extra_data));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
+        .IgnoreArgument_buffer();
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(received_data);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_237: [ Following the 2-byte integer, the body MAY contain UTF-8-encoded data with value /reason/, the interpretation of which is not defined by this specification. ]*/
-TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_a_malformed_UTF8_text_the_connection_is_closed)
+/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
+TEST_FUNCTION(when_a_1_byte_complete_frame_is_received_together_with_the_upgrade_request_the_frame_is_indicated_as_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x03, 0x03, 0xEA, 0xDF };
-    uint16_t expected_close_code = 1002;
+    size_t received_data_length = sizeof(test_upgrade_response) + 2;
+    unsigned char* received_data = (unsigned char*)malloc(received_data_length);
+    unsigned char expected_frame_payload[] = { 0x42 };
+
+    (void)memcpy(received_data, test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    received_data[received_data_length - 1] = 0x42;
+    received_data[received_data_length - 2] = 0x01;
+    received_data[received_data_length - 3] = 0x82;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5292,40 +5374,40 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_a_malformed_UTF8_text_the_conn
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
-        .ValidateArgumentBuffer(1, &close_frame[4], 1)
-        .SetReturn(false);
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_io_close_complete();
-    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0))
-        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, expected_frame_payload, sizeof(expected_frame_payload)))
+        .ValidateArgumentBuffer(3, expected_frame_payload, sizeof(expected_frame_payload));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(received_data);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
-/* Tests_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
-/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_encoding_the_outgoing_CLOSE_fails_the_connection_is_closed)
+/* Tests_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
+TEST_FUNCTION(when_2_complete_frames_are_received_together_with_the_upgrade_request_the_frames_are_indicated_as_received)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
-    uint16_t expected_close_code = 1002;
+    size_t received_data_length = sizeof(test_upgrade_response) + 4;
+    unsigned char* received_data = (unsigned char*)malloc(received_data_length);
+
+    (void)memcpy(received_data, test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    received_data[received_data_length - 5] = 0x81;
+    received_data[received_data_length - 4] = 0x01;
+    received_data[received_data_length - 3] = 'a';
+    received_data[received_data_length - 2] = 0x82;
+    received_data[received_data_length - 1] = 0x00;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5333,41 +5415,40 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_encoding_the_outg
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
-        .SetReturn(NULL);
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_io_close_complete();
-    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, NULL, 0))
-        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(3, "a", 1);
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))
+        .IgnoreArgument_buffer();
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)received_data, received_data_length);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(received_data);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
-/* Tests_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
+/* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
+/* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
+/* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
 /* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_sending_the_outgoing_CLOSE_fails_the_connection_is_closed)
+TEST_FUNCTION(when_a_masked_frame_is_received_an_error_is_indicated_and_connection_is_closed)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
+    unsigned char test_frame[] = { 0x82, 0x80 };
+    unsigned char close_frame_payload[] = { 0x03, 0xEA };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEA };
     BUFFER_HANDLE buffer_handle;
-    uint16_t expected_close_code = 1002;
-    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5375,33 +5456,26 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_sending_the_outgo
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sent_close_frame);
+        .SetReturn(close_frame);
     STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(sent_close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_send_complete()
-        .SetReturn(1);
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_io_close_complete();
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
     STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle);
-    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, NULL, 0))
-        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -5410,63 +5484,61 @@ TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_sending_the_outgo
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_240: [ The application MUST NOT send any more data frames after sending a Close frame. ] */
-TEST_FUNCTION(sending_after_a_close_is_received_does_not_send_anything)
+/* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
+/* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
+/* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+TEST_FUNCTION(when_a_masked_frame_is_received_and_encoding_the_close_frame_fails_an_error_is_indicated_anyhow)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
-    int result;
-    unsigned char test_payload[] = { 0x42 };
+    unsigned char test_frame[] = { 0x82, 0x80 };
+    unsigned char close_frame_payload[] = { 0x03, 0xEA };
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .CaptureReturn(&buffer_handle);
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* uws_client_send_frame_async */
-
-/* Tests_SRS_UWS_CLIENT_01_044: [ If any the arguments `uws_client` is NULL, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(uws_client_send_frame_async_with_NULL_handle_fails)
-{
-    // arrange
-    unsigned char test_payload[] = { 0x42 };
-    int result;
-
-    // act
-    result = uws_client_send_frame_async(NULL, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
-
-    // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-}
-
-/* Tests_SRS_UWS_CLIENT_01_045: [ If `size` is non-zero and `buffer` is NULL then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(uws_client_send_frame_async_with_NULL_buffer_and_non_zero_size_fails)
+/* Tests_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
+/* Tests_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
+/* Tests_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+TEST_FUNCTION(when_a_masked_frame_is_received_and_sending_the_encoded_CLOSE_frame_fails_an_error_is_indicated_anyhow)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    int result;
+    unsigned char test_frame[] = { 0x82, 0x80 };
+    unsigned char close_frame_payload[] = { 0x03, 0xEA };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEA };
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5477,129 +5549,105 @@ TEST_FUNCTION(uws_client_send_frame_async_with_NULL_buffer_and_non_zero_size_fai
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, NULL, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_043: [ If the uws instance is not OPEN (open has not been called or is still in progress) then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
-/* Tests_SRS_UWS_CLIENT_01_268: [ The endpoint MUST ensure the WebSocket connection is in the OPEN state ]*/
-TEST_FUNCTION(uws_client_send_frame_async_when_not_open_fails)
+/* Tests_SRS_UWS_CLIENT_01_460: [ When a CLOSE frame is received the callback `on_ws_peer_closed` passed to `uws_client_open_async` shall be called, while passing to it the argument `on_ws_peer_closed_context`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_156: [ *  %x8 denotes a connection close ]*/
+/* Tests_SRS_UWS_CLIENT_01_234: [ The Close frame contains an opcode of 0x8. ]*/
+/* Tests_SRS_UWS_CLIENT_01_235: [ The Close frame MAY contain a body (the "Application data" portion of the frame) that indicates a reason for closing, such as an endpoint shutting down, an endpoint having received a frame too large, or an endpoint having received a frame that does not conform to the format expected by the endpoint. ]*/
+/* Tests_SRS_UWS_CLIENT_01_236: [ If there is a body, the first two bytes of the body MUST be a 2-byte unsigned integer (in network byte order) representing a status code with value /code/ defined in Section 7.4. ]*/
+/* Tests_SRS_UWS_CLIENT_01_461: [ The argument `close_code` shall be set to point to the code extracted from the CLOSE frame. ]*/
+/* Tests_SRS_UWS_CLIENT_01_296: [ Upon either sending or receiving a Close control frame, it is said that _The WebSocket Closing Handshake is Started_ and that the WebSocket connection is in the CLOSING state. ]*/
+/* Tests_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
+/* Tests_SRS_UWS_CLIENT_01_242: [ It SHOULD do so as soon as practical. ]*/
+/* Tests_SRS_UWS_CLIENT_01_239: [ Close frames sent from client to server must be masked as per Section 5.3. ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_the_code_is_reported_to_the_user)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    int result;
-    unsigned char test_payload[] = { 0x42 };
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
+    BUFFER_HANDLE buffer_handle;
+    uint16_t expected_close_code = 1002;
+    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
-
-    // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    // cleanup
-    uws_client_destroy(uws_client);
-}
-
-/* Tests_SRS_UWS_CLIENT_01_043: [ If the uws instance is not OPEN (open has not been called or is still in progress) then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
-TEST_FUNCTION(uws_client_send_frame_async_when_opening_underlying_io_fails)
-{
-    // arrange
-    TLSIO_CONFIG tlsio_config;
-    UWS_CLIENT_HANDLE uws_client;
-    int result;
-    unsigned char test_payload[] = { 0x42 };
-
-    tlsio_config.hostname = "test_host";
-    tlsio_config.port = 444;
-
-    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    umock_c_reset_all_calls();
-
-    // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
-
-    // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    // cleanup
-    uws_client_destroy(uws_client);
-}
-
-/* Tests_SRS_UWS_CLIENT_01_043: [ If the uws instance is not OPEN (open has not been called or is still in progress) then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
-TEST_FUNCTION(uws_client_send_frame_async_when_waiting_for_upgrade_response_fails)
-{
-    // arrange
-    TLSIO_CONFIG tlsio_config;
-    UWS_CLIENT_HANDLE uws_client;
-    int result;
-    unsigned char test_payload[] = { 0x42 };
-
-    tlsio_config.hostname = "test_host";
-    tlsio_config.port = 444;
-
-    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sent_close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(sent_close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
+        .IgnoreArgument_callback_context()
+        .IgnoreArgument_on_send_complete();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, NULL, 0))
+        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
 
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
-/* Tests_SRS_UWS_CLIENT_01_039: [ - the encoded websocket frame, so that the frame can be later sent when `uws_client_dowork` is called ]*/
-/* Tests_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
-/* Tests_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
-/* Tests_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
-/* Tests_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode` and passing to it the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
-/* Tests_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
-/* Tests_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
-/* Tests_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
-/* Tests_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
-/* Tests_SRS_UWS_CLIENT_01_041: [ - the send complete callback context `on_ws_send_frame_complete_context` ]*/
+/* Tests_SRS_UWS_CLIENT_01_460: [ When a CLOSE frame is received the callback `on_ws_peer_closed` passed to `uws_client_open_async` shall be called, while passing to it the argument `on_ws_peer_closed_context`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_156: [ *  %x8 denotes a connection close ]*/
+/* Tests_SRS_UWS_CLIENT_01_234: [ The Close frame contains an opcode of 0x8. ]*/
+/* Tests_SRS_UWS_CLIENT_01_462: [ If no code can be extracted then `close_code` shall be NULL. ]*/
+/* Tests_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
 /* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
-/* Tests_SRS_UWS_CLIENT_01_270: [ An endpoint MUST encapsulate the /data/ in a WebSocket frame as defined in Section 5.2. ]*/
-/* Tests_SRS_UWS_CLIENT_01_274: [ If the data is being sent by the client, the frame(s) MUST be masked as defined in Section 5.3. ]*/
-/* Tests_SRS_UWS_CLIENT_01_276: [ The frame(s) that have been formed MUST be transmitted over the underlying network connection. ]*/
-TEST_FUNCTION(uws_client_send_frame_async_succeeds)
+TEST_FUNCTION(when_a_CLOSE_frame_is_received_without_a_close_code_while_in_open_the_callback_is_triggered)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
-    int result;
+    unsigned char close_frame[] = { 0x88, 0x00 };
     BUFFER_HANDLE buffer_handle;
+    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5607,49 +5655,49 @@ TEST_FUNCTION(uws_client_send_frame_async_succeeds)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
+        .SetReturn(sent_close_frame);
     STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item();
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_send_complete()
+        .SetReturn(sizeof(sent_close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
         .IgnoreArgument_callback_context()
-        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+        .IgnoreArgument_on_send_complete();
     STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, NULL, NULL, 0));
 
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_272: [ The opcode (frame-opcode) of the first frame containing the data MUST be set to the appropriate value from Section 5.2 for data that is to be interpreted by the recipient as text or binary data. ]*/
-TEST_FUNCTION(uws_send_text_frame_succeeds)
+/* Tests_SRS_UWS_CLIENT_01_463: [ The extra bytes (besides the close code) shall be passed to the `on_ws_peer_closed` callback by using `extra_data` and `extra_data_length`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_241: [ If an endpoint receives a Close frame and did not previously send a Close frame, the endpoint MUST send a Close frame in response. ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_extra_bytes_the_bytes_are_passed_to_the_callback)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 'a' };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 'a' };
-    int result;
+    unsigned char close_frame[] = { 0x88, 0x04, 0x03, 0xEA, 0x42, 0x43 };
     BUFFER_HANDLE buffer_handle;
+    uint16_t expected_close_code = 1002;
+    unsigned char expected_extra_data[] = { 0x42, 0x43 };
+    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5657,47 +5705,48 @@ TEST_FUNCTION(uws_send_text_frame_succeeds)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_TEXT_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 2))
+        .ValidateArgumentBuffer(1, &close_frame[4], 2);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
+        .SetReturn(sent_close_frame);
     STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item();
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_send_complete()
+        .SetReturn(sizeof(sent_close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
         .IgnoreArgument_callback_context()
-        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+        .IgnoreArgument_on_send_complete();
     STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, IGNORED_PTR_ARG, sizeof(expected_extra_data)))
+        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code))
+        .ValidateArgumentBuffer(3, &expected_extra_data, sizeof(expected_extra_data));
 
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_047: [ If allocating memory for the newly queued item fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(when_allocating_memory_for_the_new_sent_item_fails_uws_client_send_frame_async_fails)
+/* Tests_SRS_UWS_CLIENT_01_237: [ Following the 2-byte integer, the body MAY contain UTF-8-encoded data with value /reason/, the interpretation of which is not defined by this specification. ]*/
+TEST_FUNCTION(when_a_CLOSE_frame_is_received_with_a_malformed_UTF8_text_the_connection_is_closed)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    int result;
+    unsigned char close_frame[] = { 0x88, 0x03, 0x03, 0xEA, 0xDF };
+    uint16_t expected_close_code = 1002;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5705,32 +5754,39 @@ TEST_FUNCTION(when_allocating_memory_for_the_new_sent_item_fails_uws_client_send
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(1, &close_frame[4], 1)
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_callback_context()
+        .IgnoreArgument_on_io_close_complete();
+    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0))
+        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
 
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(when_encoding_the_frame_fails_uws_client_send_frame_async_fails)
+/* Tests_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
+/* Tests_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_encoding_the_outgoing_CLOSE_fails_the_connection_is_closed)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    int result;
+    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
+    uint16_t expected_close_code = 1002;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5738,145 +5794,104 @@ TEST_FUNCTION(when_encoding_the_frame_fails_uws_client_send_frame_async_fails)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_callback_context()
+        .IgnoreArgument_on_io_close_complete();
+    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, NULL, 0))
+        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
 
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_058: [ If `xio_send` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-/* Tests_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
-TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails)
+/* Tests_SRS_UWS_CLIENT_01_288: [ To _Close the WebSocket Connection_, an endpoint closes the underlying TCP connection. ]*/
+/* Tests_SRS_UWS_CLIENT_01_290: [ An endpoint MAY close the connection via any means available when necessary, such as when under attack. ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+TEST_FUNCTION(when_a_CLOSE_frame_is_received_while_in_open_and_sending_the_outgoing_CLOSE_fails_the_connection_is_closed)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
-    int result;
+    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
     BUFFER_HANDLE buffer_handle;
-    LIST_ITEM_HANDLE new_item_handle;
+    uint16_t expected_close_code = 1002;
+    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new())
-        .CaptureReturn(&buffer_handle);
-
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .CaptureReturn(&buffer_handle);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
+        .SetReturn(sent_close_frame);
     STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item()
-        .CaptureReturn(&new_item_handle);
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_send_complete()
+        .SetReturn(sizeof(sent_close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
         .IgnoreArgument_callback_context()
-        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame))
+        .IgnoreArgument_on_send_complete()
         .SetReturn(1);
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .SetReturn((LIST_ITEM_HANDLE)0x1234);
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .ValidateArgumentValue_item_handle(&new_item_handle);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_callback_context()
+        .IgnoreArgument_on_io_close_complete();
     STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_peer_closed((void*)0x4301, IGNORED_PTR_ARG, NULL, 0))
+        .ValidateArgumentBuffer(2, &expected_close_code, sizeof(expected_close_code));
 
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
-TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails_message_removed_by_xio_send)
+/* Tests_SRS_UWS_CLIENT_01_240: [ The application MUST NOT send any more data frames after sending a Close frame. ] */
+TEST_FUNCTION(sending_after_a_close_is_received_does_not_send_anything)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    unsigned char close_frame[] = { 0x88, 0x02, 0x03, 0xEA };
     int result;
-    BUFFER_HANDLE buffer_handle;
-    LIST_ITEM_HANDLE new_item_handle;
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new())
-        .CaptureReturn(&buffer_handle);
-
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item()
-        .CaptureReturn(&new_item_handle);
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_send_complete()
-        .IgnoreArgument_callback_context()
-        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .SetReturn(NULL);
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-
-    // section for on_io_send_complete()
-    g_xio_send_result = 1;
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete(IGNORED_PTR_ARG, WS_SEND_FRAME_ERROR));
-    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
-
     // act
     result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_ERROR);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
@@ -5886,17 +5901,31 @@ TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails_message_remo
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_049: [ If `singlylinkedlist_add` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(when_adding_the_item_to_the_list_fails_uws_client_send_frame_async_fails)
+/* uws_client_send_frame_async */
+
+/* Tests_SRS_UWS_CLIENT_01_044: [ If any the arguments `uws_client` is NULL, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_client_send_frame_async_with_NULL_handle_fails)
+{
+    // arrange
+    unsigned char test_payload[] = { 0x42 };
+    int result;
+
+    // act
+    result = uws_client_send_frame_async(NULL, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_CLIENT_01_045: [ If `size` is non-zero and `buffer` is NULL then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_client_send_frame_async_with_NULL_buffer_and_non_zero_size_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
-    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -5907,24 +5936,8 @@ TEST_FUNCTION(when_adding_the_item_to_the_list_fails_uws_client_send_frame_async
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item()
-        .SetReturn(NULL);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, NULL, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
@@ -5934,67 +5947,42 @@ TEST_FUNCTION(when_adding_the_item_to_the_list_fails_uws_client_send_frame_async
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
-TEST_FUNCTION(uws_client_send_frame_async_with_NULL_complete_callback_succeeds)
+/* Tests_SRS_UWS_CLIENT_01_043: [ If the uws instance is not OPEN (open has not been called or is still in progress) then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
+/* Tests_SRS_UWS_CLIENT_01_268: [ The endpoint MUST ensure the WebSocket connection is in the OPEN state ]*/
+TEST_FUNCTION(uws_client_send_frame_async_when_not_open_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
-    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
     int result;
-    BUFFER_HANDLE buffer_handle;
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(encoded_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item();
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_send_complete()
-        .IgnoreArgument_callback_context()
-        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-
     // act
-    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, NULL, NULL);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* on_underlying_io_send_complete */
-
-/* Tests_SRS_UWS_CLIENT_01_389: [ When `on_underlying_io_send_complete` is called with `IO_SEND_OK` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_OK`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_432: [ The indicated sent frame shall be removed from the list by calling `singlylinkedlist_remove`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_434: [ The memory associated with the sent frame shall be freed. ]*/
-TEST_FUNCTION(on_underlying_io_send_complete_with_OK_indicates_the_frame_as_sent_OK)
+/* Tests_SRS_UWS_CLIENT_01_043: [ If the uws instance is not OPEN (open has not been called or is still in progress) then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
+TEST_FUNCTION(uws_client_send_frame_async_when_opening_underlying_io_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    int result;
     unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
@@ -6002,34 +5990,27 @@ TEST_FUNCTION(on_underlying_io_send_complete_with_OK_indicates_the_frame_as_sent
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item_handle();
-    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_OK));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_433: [ If `singlylinkedlist_remove` fails an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_CANNOT_REMOVE_SENT_ITEM_FROM_LIST`. ]*/
-TEST_FUNCTION(when_removing_the_sent_framefrom_the_list_fails_then_an_error_is_indicated)
+/* Tests_SRS_UWS_CLIENT_01_043: [ If the uws instance is not OPEN (open has not been called or is still in progress) then `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
+TEST_FUNCTION(uws_client_send_frame_async_when_waiting_for_upgrade_response_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    int result;
     unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
@@ -6038,34 +6019,46 @@ TEST_FUNCTION(when_removing_the_sent_framefrom_the_list_fails_then_an_error_is_i
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item_handle()
-        .SetReturn(1);
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_CANNOT_REMOVE_SENT_ITEM_FROM_LIST));
-
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_390: [ When `on_underlying_io_send_complete` is called with `IO_SEND_ERROR` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_ERROR`. ]*/
-TEST_FUNCTION(on_underlying_io_send_complete_with_ERROR_indicates_the_frame_with_WS_SEND_ERROR)
+/* Tests_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
+/* Tests_SRS_UWS_CLIENT_01_039: [ - the encoded websocket frame, so that the frame can be later sent when `uws_client_dowork` is called ]*/
+/* Tests_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
+/* Tests_SRS_UWS_CLIENT_01_056: [ - the `send_complete` callback shall be the `on_underlying_io_send_complete` function. ]*/
+/* Tests_SRS_UWS_CLIENT_01_042: [ On success, `uws_client_send_frame_async` shall return 0. ]*/
+/* Tests_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode` and passing to it the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
+/* Tests_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
+/* Tests_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
+/* Tests_SRS_UWS_CLIENT_01_048: [ Queueing shall be done by calling `singlylinkedlist_add`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
+/* Tests_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
+/* Tests_SRS_UWS_CLIENT_01_041: [ - the send complete callback context `on_ws_send_frame_complete_context` ]*/
+/* Tests_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
+/* Tests_SRS_UWS_CLIENT_01_146: [ A data frame MAY be transmitted by either the client or the server at any time after opening handshake completion and before that endpoint has sent a Close frame (Section 5.5.1). ]*/
+/* Tests_SRS_UWS_CLIENT_01_270: [ An endpoint MUST encapsulate the /data/ in a WebSocket frame as defined in Section 5.2. ]*/
+/* Tests_SRS_UWS_CLIENT_01_274: [ If the data is being sent by the client, the frame(s) MUST be masked as defined in Section 5.3. ]*/
+/* Tests_SRS_UWS_CLIENT_01_276: [ The frame(s) that have been formed MUST be transmitted over the underlying network connection. ]*/
+TEST_FUNCTION(uws_client_send_frame_async_succeeds)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    int result;
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6074,33 +6067,48 @@ TEST_FUNCTION(on_underlying_io_send_complete_with_ERROR_indicates_the_frame_with
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item_handle();
-    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_ERROR));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item();
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_ERROR);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_391: [ When `on_underlying_io_send_complete` is called with `IO_SEND_CANCELLED` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_CANCELLED`. ]*/
-TEST_FUNCTION(on_underlying_io_send_complete_with_CANCELLED_indicates_the_frame_with_WS_SEND_CANCELLED)
+/* Tests_SRS_UWS_CLIENT_01_272: [ The opcode (frame-opcode) of the first frame containing the data MUST be set to the appropriate value from Section 5.2 for data that is to be interpreted by the recipient as text or binary data. ]*/
+TEST_FUNCTION(uws_send_text_frame_succeeds)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    unsigned char test_payload[] = { 0x42 };
+    unsigned char test_payload[] = { 'a' };
+    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 'a' };
+    int result;
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6109,33 +6117,46 @@ TEST_FUNCTION(on_underlying_io_send_complete_with_CANCELLED_indicates_the_frame_
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item_handle();
-    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_CANCELLED));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_TEXT_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item();
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_CANCELLED);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_435: [ When `on_underlying_io_send_complete` is called with a NULL `context`, it shall do nothing. ]*/
-TEST_FUNCTION(on_underlying_io_send_complete_with_NULL_context_does_nothing)
+/* Tests_SRS_UWS_CLIENT_01_047: [ If allocating memory for the newly queued item fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_allocating_memory_for_the_new_sent_item_fails_uws_client_send_frame_async_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
+    int result;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6144,27 +6165,31 @@ TEST_FUNCTION(on_underlying_io_send_complete_with_NULL_context_does_nothing)
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
     // act
-    g_on_io_send_complete(NULL, IO_SEND_CANCELLED);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_436: [ When `on_underlying_io_send_complete` is called with any other error code, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_ERROR`. ]*/
-TEST_FUNCTION(on_underlying_io_send_complete_with_an_unknown_result_indicates_an_error)
+/* Tests_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_encoding_the_frame_fails_uws_client_send_frame_async_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
     unsigned char test_payload[] = { 0x42 };
+    int result;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6173,124 +6198,263 @@ TEST_FUNCTION(on_underlying_io_send_complete_with_an_unknown_result_indicates_an
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
-    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
-        .IgnoreArgument_item_handle();
-    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_ERROR));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .SetReturn(NULL);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, (IO_SEND_RESULT)0x42);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* uws_client_dowork */
-
-/* Tests_SRS_UWS_CLIENT_01_059: [ If the `uws_client` argument is NULL, `uws_client_dowork` shall do nothing. ]*/
-TEST_FUNCTION(uws_client_dowork_with_NULL_handle_does_nothing)
+/* Tests_SRS_UWS_CLIENT_01_058: [ If `xio_send` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
+TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails)
 {
     // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    int result;
+    BUFFER_HANDLE buffer_handle;
+    LIST_ITEM_HANDLE new_item_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .CaptureReturn(&buffer_handle);
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item()
+        .CaptureReturn(&new_item_handle);
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn((LIST_ITEM_HANDLE)0x1234);
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .ValidateArgumentValue_item_handle(&new_item_handle);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
-    uws_client_dowork(NULL);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_430: [ `uws_client_dowork` shall call `xio_dowork` with the IO handle argument set to the underlying IO created in `uws_client_create`. ]*/
-TEST_FUNCTION(uws_client_dowork_calls_the_underlying_io_dowork)
+/* Tests_SRS_UWS_CLIENT_09_001: [ If `xio_send` fails and the message is still queued, it shall be de-queued and destroyed. ] */
+TEST_FUNCTION(when_xio_send_fails_uws_client_send_frame_async_fails_message_removed_by_xio_send)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    int result;
+    BUFFER_HANDLE buffer_handle;
+    LIST_ITEM_HANDLE new_item_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .CaptureReturn(&buffer_handle);
+
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_dowork(TEST_IO_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item()
+        .CaptureReturn(&new_item_handle);
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+
+    // section for on_io_send_complete()
+    g_xio_send_result = 1;
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete(IGNORED_PTR_ARG, WS_SEND_FRAME_ERROR));
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
 
     // act
-    uws_client_dowork(uws_client);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_ERROR);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_060: [ If the IO is not yet open, `uws_client_dowork` shall do nothing. ]*/
-TEST_FUNCTION(uws_client_dowork_when_closed_does_nothing)
+/* Tests_SRS_UWS_CLIENT_01_049: [ If `singlylinkedlist_add` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_adding_the_item_to_the_list_fails_uws_client_send_frame_async_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    int result;
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item()
+        .SetReturn(NULL);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+
     // act
-    uws_client_dowork(uws_client);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* on_underlying_io_error */
-
-/* Tests_SRS_UWS_CLIENT_01_375: [ When `on_underlying_io_error` is called while uws is OPENING, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_UNDERLYING_IO_ERROR`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_077: [ If this fails (e.g., the server's certificate could not be verified), then the client MUST _Fail the WebSocket Connection_ and abort the connection. ]*/
-TEST_FUNCTION(on_underlying_io_error_while_opening_underlying_io_indicates_an_open_complete_with_WS_OPEN_ERROR_UNDERLYING_IO_ERROR)
+/* Tests_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
+TEST_FUNCTION(uws_client_send_frame_async_with_NULL_complete_callback_succeeds)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
+    unsigned char encoded_frame[] = { 0x82, 0x01, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    int result;
+    BUFFER_HANDLE buffer_handle;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
-    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_UNDERLYING_IO_ERROR));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item();
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
 
     // act
-    g_on_io_error(g_on_io_error_context);
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, NULL, NULL);
 
     // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_375: [ When `on_underlying_io_error` is called while uws is OPENING, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_UNDERLYING_IO_ERROR`. ]*/
-TEST_FUNCTION(on_underlying_io_error_while_waiting_for_upgrade_response_indicates_an_open_complete_with_WS_OPEN_ERROR_UNDERLYING_IO_ERROR)
+/* on_underlying_io_send_complete */
+
+/* Tests_SRS_UWS_CLIENT_01_389: [ When `on_underlying_io_send_complete` is called with `IO_SEND_OK` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_OK`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_432: [ The indicated sent frame shall be removed from the list by calling `singlylinkedlist_remove`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_434: [ The memory associated with the sent frame shall be freed. ]*/
+TEST_FUNCTION(on_underlying_io_send_complete_with_OK_indicates_the_frame_as_sent_OK)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6298,13 +6462,18 @@ TEST_FUNCTION(on_underlying_io_error_while_waiting_for_upgrade_response_indicate
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
-    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_UNDERLYING_IO_ERROR));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item_handle();
+    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_OK));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
-    g_on_io_error(g_on_io_error_context);
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6313,15 +6482,14 @@ TEST_FUNCTION(on_underlying_io_error_while_waiting_for_upgrade_response_indicate
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_376: [ When `on_underlying_io_error` is called while the uws instance is OPEN, an error shall be reported to the user by calling the `on_ws_error` callback that was passed to `uws_client_open_async` with the argument `WS_ERROR_UNDERLYING_IO_ERROR`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_318: [ Servers MAY close the WebSocket connection whenever desired. ]*/
-/* Tests_SRS_UWS_CLIENT_01_269: [ If at any point the state of the WebSocket connection changes, the endpoint MUST abort the following steps. ]*/
-TEST_FUNCTION(on_underlying_io_error_while_OPEN_indicates_an_error)
+/* Tests_SRS_UWS_CLIENT_01_433: [ If `singlylinkedlist_remove` fails an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_CANNOT_REMOVE_SENT_ITEM_FROM_LIST`. ]*/
+TEST_FUNCTION(when_removing_the_sent_framefrom_the_list_fails_then_an_error_is_indicated)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6329,13 +6497,18 @@ TEST_FUNCTION(on_underlying_io_error_while_OPEN_indicates_an_error)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_UNDERLYING_IO_ERROR));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item_handle()
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_CANNOT_REMOVE_SENT_ITEM_FROM_LIST));
 
     // act
-    g_on_io_error(g_on_io_error_context);
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6344,14 +6517,14 @@ TEST_FUNCTION(on_underlying_io_error_while_OPEN_indicates_an_error)
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
-TEST_FUNCTION(on_underlying_io_error_while_CLOSING_indicates_an_error)
+/* Tests_SRS_UWS_CLIENT_01_390: [ When `on_underlying_io_send_complete` is called with `IO_SEND_ERROR` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_ERROR`. ]*/
+TEST_FUNCTION(on_underlying_io_send_complete_with_ERROR_indicates_the_frame_with_WS_SEND_ERROR)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6359,14 +6532,18 @@ TEST_FUNCTION(on_underlying_io_error_while_CLOSING_indicates_an_error)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item_handle();
+    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_ERROR));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
-    g_on_io_error(g_on_io_error_context);
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_ERROR);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6375,15 +6552,14 @@ TEST_FUNCTION(on_underlying_io_error_while_CLOSING_indicates_an_error)
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
-TEST_FUNCTION(open_after_error_during_sending_close_succeeds)
+/* Tests_SRS_UWS_CLIENT_01_391: [ When `on_underlying_io_send_complete` is called with `IO_SEND_CANCELLED` as a result of sending a WebSocket frame to the underlying IO, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_CANCELLED`. ]*/
+TEST_FUNCTION(on_underlying_io_send_complete_with_CANCELLED_indicates_the_frame_with_WS_SEND_CANCELLED)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
-    int result;
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6391,39 +6567,34 @@ TEST_FUNCTION(open_after_error_during_sending_close_succeeds)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
-    g_on_io_error(g_on_io_error_context);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_open_complete()
-        .IgnoreArgument_on_io_open_complete_context()
-        .IgnoreArgument_on_bytes_received()
-        .IgnoreArgument_on_bytes_received_context()
-        .IgnoreArgument_on_io_error()
-        .IgnoreArgument_on_io_error_context();
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item_handle();
+    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_CANCELLED));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
-    result = uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_CANCELLED);
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
-/* Tests_SRS_UWS_CLIENT_01_499: [ If the CLOSE was due to the peer closing, the callback `on_ws_close_complete` shall not be called. ]*/
-TEST_FUNCTION(on_underlying_io_error_while_CLOSING_underlying_io_indicates_the_close)
+/* Tests_SRS_UWS_CLIENT_01_435: [ When `on_underlying_io_send_complete` is called with a NULL `context`, it shall do nothing. ]*/
+TEST_FUNCTION(on_underlying_io_send_complete_with_NULL_context_does_nothing)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
+    unsigned char test_payload[] = { 0x42 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6431,17 +6602,47 @@ TEST_FUNCTION(on_underlying_io_error_while_CLOSING_underlying_io_indicates_the_c
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_io_close_complete();
+    // act
+    g_on_io_send_complete(NULL, IO_SEND_CANCELLED);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_436: [ When `on_underlying_io_send_complete` is called with any other error code, the send shall be indicated to the uws user by calling `on_ws_send_frame_complete` with `WS_SEND_FRAME_ERROR`. ]*/
+TEST_FUNCTION(on_underlying_io_send_complete_with_an_unknown_result_indicates_an_error)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    unsigned char test_payload[] = { 0x42 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
+    (void)uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4245);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item_handle();
+    STRICT_EXPECTED_CALL(test_on_ws_send_frame_complete((void*)0x4245, WS_SEND_FRAME_ERROR));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
-    g_on_io_error(g_on_io_error_context);
+    g_on_io_send_complete(g_on_io_send_complete_context, (IO_SEND_RESULT)0x42);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6450,15 +6651,68 @@ TEST_FUNCTION(on_underlying_io_error_while_CLOSING_underlying_io_indicates_the_c
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
-TEST_FUNCTION(open_after_error_during_closing_underlying_io_succeeds)
+/* uws_client_send_frame_in_place_async */
+
+/* Tests_SRS_UWS_CLIENT_01_547: [ If `uws_client` is NULL, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_01_554: [ `uws_client_send_frame_in_place_async` shall not free `buffer`, the bytes are copied by `xio_send` and the caller may reuse or free `buffer` as soon as the call returns. ]*/
+TEST_FUNCTION(uws_client_send_frame_in_place_async_with_NULL_handle_fails)
+{
+    // arrange
+    int result;
+    unsigned char* frame_buffer = (unsigned char*)malloc(UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1);
+    umock_c_reset_all_calls();
+
+    // act
+    result = uws_client_send_frame_in_place_async(NULL, WS_FRAME_TYPE_BINARY, frame_buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(frame_buffer);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_549: [ If the uws instance is not OPEN, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+/* Tests_SRS_UWS_CLIENT_01_554: [ `uws_client_send_frame_in_place_async` shall not free `buffer`, the bytes are copied by `xio_send` and the caller may reuse or free `buffer` as soon as the call returns. ]*/
+TEST_FUNCTION(uws_client_send_frame_in_place_async_when_not_open_fails)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    int result;
+    unsigned char* frame_buffer = (unsigned char*)malloc(UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1);
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
+    // act
+    result = uws_client_send_frame_in_place_async(uws_client, WS_FRAME_TYPE_BINARY, frame_buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+    free(frame_buffer);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_551: [ The frame shall be encoded by calling `uws_frame_encoder_encode_in_place` with `buffer`, `headroom` and `size`, the `is_final` flag and `is_masked` set to true, so that the header is written in the headroom and the payload is masked where it is. ]*/
+/* Tests_SRS_UWS_CLIENT_01_553: [ The encoded frame shall be queued and sent with `xio_send` the same way `uws_client_send_frame_async` sends it, starting at the offset returned by `uws_frame_encoder_encode_in_place`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_554: [ `uws_client_send_frame_in_place_async` shall not free `buffer`, the bytes are copied by `xio_send` and the caller may reuse or free `buffer` as soon as the call returns. ]*/
+TEST_FUNCTION(uws_client_send_frame_in_place_async_sends_the_frame_from_the_caller_buffer)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
     int result;
+    size_t frame_offset = UWS_FRAME_ENCODER_MAX_HEADER_SIZE - 6;
+    unsigned char* frame_buffer = (unsigned char*)malloc(UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1);
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6466,22 +6720,20 @@ TEST_FUNCTION(open_after_error_during_closing_underlying_io_succeeds)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
-    g_on_io_error(g_on_io_error_context);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_open_complete()
-        .IgnoreArgument_on_io_open_complete_context()
-        .IgnoreArgument_on_bytes_received()
-        .IgnoreArgument_on_bytes_received_context()
-        .IgnoreArgument_on_io_error()
-        .IgnoreArgument_on_io_error_context();
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, true, 0, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(8, &frame_offset, sizeof(frame_offset));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item();
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, frame_buffer + frame_offset, 7, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context();
 
     // act
-    result = uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    result = uws_client_send_frame_in_place_async(uws_client, WS_FRAME_TYPE_BINARY, frame_buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
     ASSERT_ARE_EQUAL(int, 0, result);
@@ -6489,16 +6741,18 @@ TEST_FUNCTION(open_after_error_during_closing_underlying_io_succeeds)
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(frame_buffer);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_500: [ If `xio_close` fails then the callback `on_ws_close_complete` shall be called, while passing the `on_ws_close_complete_context` argument to it. ]*/
-/* Tests_SRS_UWS_CLIENT_01_500: [ The callback `on_ws_close_complete` shall be called, while passing the `on_ws_close_complete_context` argument to it. ]*/
-TEST_FUNCTION(on_underlying_io_error_while_CLOSING_due_to_local_initiated_close)
+/* Tests_SRS_UWS_CLIENT_01_552: [ If `uws_frame_encoder_encode_in_place` fails, `uws_client_send_frame_in_place_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_uws_frame_encoder_encode_in_place_fails_uws_client_send_frame_in_place_async_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    int result;
+    unsigned char* frame_buffer = (unsigned char*)malloc(1);
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6506,49 +6760,58 @@ TEST_FUNCTION(on_underlying_io_error_while_CLOSING_due_to_local_initiated_close)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    (void)uws_client_close_handshake_async(uws_client, 1002, "", test_on_ws_close_complete, (void*)0x6666);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_close_complete()
-        .IgnoreArgument_callback_context()
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, frame_buffer, 0, 1, true, true, 0, IGNORED_PTR_ARG))
         .SetReturn(1);
-    STRICT_EXPECTED_CALL(test_on_ws_close_complete((void*)0x6666));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     // act
-    g_on_io_error(g_on_io_error_context);
+    result = uws_client_send_frame_in_place_async(uws_client, WS_FRAME_TYPE_BINARY, frame_buffer, 0, 1, true, test_on_ws_send_frame_complete, (void*)0x4248);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
+    free(frame_buffer);
 }
 
-/* on_underlying_io_close_sent */
+/* uws_client_dowork */
 
-/* Tests_SRS_UWS_CLIENT_01_489: [ When `on_underlying_io_close_sent` is called with NULL context, it shall do nothing. ]*/
-TEST_FUNCTION(on_underlying_io_close_sent_with_NULL_context_does_nothing)
+/* Tests_SRS_UWS_CLIENT_01_059: [ If the `uws_client` argument is NULL, `uws_client_dowork` shall do nothing. ]*/
+TEST_FUNCTION(uws_client_dowork_with_NULL_handle_does_nothing)
+{
+    // arrange
+
+    // act
+    uws_client_dowork(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_CLIENT_01_430: [ `uws_client_dowork` shall call `xio_dowork` with the IO handle argument set to the underlying IO created in `uws_client_create`. ]*/
+TEST_FUNCTION(uws_client_dowork_calls_the_underlying_io_dowork)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(xio_dowork(TEST_IO_HANDLE));
+
     // act
-    g_on_io_send_complete(NULL, IO_SEND_OK);
+    uws_client_dowork(uws_client);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6557,31 +6820,51 @@ TEST_FUNCTION(on_underlying_io_close_sent_with_NULL_context_does_nothing)
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_490: [ When `on_underlying_io_close_sent` is called while the uws client is CLOSING, `on_underlying_io_close_sent` shall close the underlying IO by calling `xio_close`. ]*/
-TEST_FUNCTION(on_underlying_io_close_sent_when_a_CLOSE_was_sent_closes_the_underlying_IO)
+/* Tests_SRS_UWS_CLIENT_01_060: [ If the IO is not yet open, `uws_client_dowork` shall do nothing. ]*/
+TEST_FUNCTION(uws_client_dowork_when_closed_does_nothing)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
+    // act
+    uws_client_dowork(uws_client);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* on_underlying_io_error */
+
+/* Tests_SRS_UWS_CLIENT_01_375: [ When `on_underlying_io_error` is called while uws is OPENING, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_UNDERLYING_IO_ERROR`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_077: [ If this fails (e.g., the server's certificate could not be verified), then the client MUST _Fail the WebSocket Connection_ and abort the connection. ]*/
+TEST_FUNCTION(on_underlying_io_error_while_opening_underlying_io_indicates_an_open_complete_with_WS_OPEN_ERROR_UNDERLYING_IO_ERROR)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
 
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_close_complete()
-        .IgnoreArgument_callback_context();
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_UNDERLYING_IO_ERROR));
 
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    g_on_io_error(g_on_io_error_context);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6590,15 +6873,12 @@ TEST_FUNCTION(on_underlying_io_close_sent_when_a_CLOSE_was_sent_closes_the_under
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_493: [ If calling `xio_close` fails, the state of the uws client shall be considered CLOSED and the `on_ws_close_complete` shall be called if it was specified. ]*/
-/* Tests_SRS_UWS_CLIENT_01_496: [ If the close was initiated by the peer no `on_ws_close_complete` shall be called. ]*/
-TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_initiated_by_peer_no_callback_is_triggered)
+/* Tests_SRS_UWS_CLIENT_01_375: [ When `on_underlying_io_error` is called while uws is OPENING, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_UNDERLYING_IO_ERROR`. ]*/
+TEST_FUNCTION(on_underlying_io_error_while_waiting_for_upgrade_response_indicates_an_open_complete_with_WS_OPEN_ERROR_UNDERLYING_IO_ERROR)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6606,17 +6886,13 @@ TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_init
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_close_complete()
-        .IgnoreArgument_callback_context()
-        .SetReturn(1);
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_UNDERLYING_IO_ERROR));
 
     // act
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    g_on_io_error(g_on_io_error_context);
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -6625,16 +6901,15 @@ TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_init
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_493: [ If calling `xio_close` fails, the state of the uws client shall be considered CLOSED and the `on_ws_close_complete` shall be called if it was specified. ]*/
-/* Tests_SRS_UWS_CLIENT_01_496: [ If the close was initiated by the peer no `on_ws_close_complete` shall be called. ]*/
-TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_initiated_by_peer_no_callback_is_triggered_and_next_open_succeeds)
+/* Tests_SRS_UWS_CLIENT_01_376: [ When `on_underlying_io_error` is called while the uws instance is OPEN, an error shall be reported to the user by calling the `on_ws_error` callback that was passed to `uws_client_open_async` with the argument `WS_ERROR_UNDERLYING_IO_ERROR`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_318: [ Servers MAY close the WebSocket connection whenever desired. ]*/
+/* Tests_SRS_UWS_CLIENT_01_269: [ If at any point the state of the WebSocket connection changes, the endpoint MUST abort the following steps. ]*/
+TEST_FUNCTION(on_underlying_io_error_while_OPEN_indicates_an_error)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
     const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_frame[] = { 0x88, 0x00 };
-    int result;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
@@ -6643,207 +6918,1488 @@ TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_init
     (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
-    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_close_complete()
-        .IgnoreArgument_callback_context()
-        .SetReturn(1);
-    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
-    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_UNDERLYING_IO_ERROR));
 
-    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_on_io_open_complete()
-        .IgnoreArgument_on_io_open_complete_context()
-        .IgnoreArgument_on_bytes_received()
-        .IgnoreArgument_on_bytes_received_context()
-        .IgnoreArgument_on_io_error()
-        .IgnoreArgument_on_io_error_context();
+    // act
+    g_on_io_error(g_on_io_error_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
+TEST_FUNCTION(on_underlying_io_error_while_CLOSING_indicates_an_error)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+
+    // act
+    g_on_io_error(g_on_io_error_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
+TEST_FUNCTION(open_after_error_during_sending_close_succeeds)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_io_error(g_on_io_error_context);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_open_complete()
+        .IgnoreArgument_on_io_open_complete_context()
+        .IgnoreArgument_on_bytes_received()
+        .IgnoreArgument_on_bytes_received_context()
+        .IgnoreArgument_on_io_error()
+        .IgnoreArgument_on_io_error_context();
+
+    // act
+    result = uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_499: [ If the CLOSE was due to the peer closing, the callback `on_ws_close_complete` shall not be called. ]*/
+TEST_FUNCTION(on_underlying_io_error_while_CLOSING_underlying_io_indicates_the_close)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_callback_context()
+        .IgnoreArgument_on_io_close_complete();
+
+    // act
+    g_on_io_error(g_on_io_error_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_377: [ When `on_underlying_io_error` is called while the uws instance is CLOSING the underlying IO shall be closed by calling `xio_close`. ]*/
+TEST_FUNCTION(open_after_error_during_closing_underlying_io_succeeds)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    g_on_io_error(g_on_io_error_context);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_open_complete()
+        .IgnoreArgument_on_io_open_complete_context()
+        .IgnoreArgument_on_bytes_received()
+        .IgnoreArgument_on_bytes_received_context()
+        .IgnoreArgument_on_io_error()
+        .IgnoreArgument_on_io_error_context();
+
+    // act
+    result = uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_500: [ If `xio_close` fails then the callback `on_ws_close_complete` shall be called, while passing the `on_ws_close_complete_context` argument to it. ]*/
+/* Tests_SRS_UWS_CLIENT_01_500: [ The callback `on_ws_close_complete` shall be called, while passing the `on_ws_close_complete_context` argument to it. ]*/
+TEST_FUNCTION(on_underlying_io_error_while_CLOSING_due_to_local_initiated_close)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    (void)uws_client_close_handshake_async(uws_client, 1002, "", test_on_ws_close_complete, (void*)0x6666);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_close_complete()
+        .IgnoreArgument_callback_context()
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(test_on_ws_close_complete((void*)0x6666));
+
+    // act
+    g_on_io_error(g_on_io_error_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* on_underlying_io_close_sent */
+
+/* Tests_SRS_UWS_CLIENT_01_489: [ When `on_underlying_io_close_sent` is called with NULL context, it shall do nothing. ]*/
+TEST_FUNCTION(on_underlying_io_close_sent_with_NULL_context_does_nothing)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    umock_c_reset_all_calls();
+
+    // act
+    g_on_io_send_complete(NULL, IO_SEND_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_490: [ When `on_underlying_io_close_sent` is called while the uws client is CLOSING, `on_underlying_io_close_sent` shall close the underlying IO by calling `xio_close`. ]*/
+TEST_FUNCTION(on_underlying_io_close_sent_when_a_CLOSE_was_sent_closes_the_underlying_IO)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_close_complete()
+        .IgnoreArgument_callback_context();
+
+    // act
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_493: [ If calling `xio_close` fails, the state of the uws client shall be considered CLOSED and the `on_ws_close_complete` shall be called if it was specified. ]*/
+/* Tests_SRS_UWS_CLIENT_01_496: [ If the close was initiated by the peer no `on_ws_close_complete` shall be called. ]*/
+TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_initiated_by_peer_no_callback_is_triggered)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_close_complete()
+        .IgnoreArgument_callback_context()
+        .SetReturn(1);
+
+    // act
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_493: [ If calling `xio_close` fails, the state of the uws client shall be considered CLOSED and the `on_ws_close_complete` shall be called if it was specified. ]*/
+/* Tests_SRS_UWS_CLIENT_01_496: [ If the close was initiated by the peer no `on_ws_close_complete` shall be called. ]*/
+TEST_FUNCTION(when_xio_close_fails_in_on_underlying_io_close_sent_and_CLOSE_initiated_by_peer_no_callback_is_triggered_and_next_open_succeeds)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_close_complete()
+        .IgnoreArgument_callback_context()
+        .SetReturn(1);
+    g_on_io_send_complete(g_on_io_send_complete_context, IO_SEND_OK);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_io_open_complete()
+        .IgnoreArgument_on_io_open_complete_context()
+        .IgnoreArgument_on_bytes_received()
+        .IgnoreArgument_on_bytes_received_context()
+        .IgnoreArgument_on_io_error()
+        .IgnoreArgument_on_io_error_context();
+
+    // act
+    result = uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Ping frame */
+
+/* Tests_SRS_UWS_CLIENT_01_157: [ *  %x9 denotes a ping ]*/
+/* Tests_SRS_UWS_CLIENT_01_249: [ Upon receipt of a Ping frame, an endpoint MUST send a Pong frame in response ]*/
+/* Tests_SRS_UWS_CLIENT_01_250: [ It SHOULD respond with Pong frame as soon as is practical. ]*/
+/* Tests_SRS_UWS_CLIENT_01_253: [ A Pong frame sent in response to a Ping frame must have identical "Application data" as found in the message body of the Ping frame being replied to. ]*/
+/* Tests_SRS_UWS_CLIENT_01_247: [ The Ping frame contains an opcode of 0x9. ]*/
+/* Tests_SRS_UWS_CLIENT_01_251: [ An endpoint MAY send a Ping frame any time after the connection is established and before the connection is closed. ]*/
+TEST_FUNCTION(when_a_PING_frame_was_received_a_PONG_frame_is_sent)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char ping_frame[] = { 0x89, 0x00 };
+    unsigned char pong_frame[] = { 0x8A, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    BUFFER_HANDLE buffer_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, IGNORED_PTR_ARG, 0, true, true, 0))
+        .IgnoreArgument_payload()
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(pong_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(pong_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, pong_frame, sizeof(pong_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, pong_frame, sizeof(pong_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)ping_frame, sizeof(ping_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_253: [ A Pong frame sent in response to a Ping frame must have identical "Application data" as found in the message body of the Ping frame being replied to. ]*/
+/* Tests_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
+TEST_FUNCTION(when_a_PING_frame_was_received_with_some_payload_a_PONG_frame_is_sent_with_the_Same_payload)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char ping_frame[] = { 0x89, 0x02, 0x42, 0x43 };
+    unsigned char pong_frame_payload[] = { 0x42, 0x43 };
+    unsigned char pong_frame[] = { 0x8A, 0x02, 0x00, 0x00, 0x00, 0x00, 0x42, 0x43 };
+    BUFFER_HANDLE buffer_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .CaptureReturn(&buffer_handle);
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, pong_frame_payload, sizeof(pong_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, pong_frame_payload, sizeof(pong_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(pong_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(pong_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, pong_frame, sizeof(pong_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, pong_frame, sizeof(pong_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)ping_frame, sizeof(ping_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_251: [ An endpoint MAY send a Ping frame any time after the connection is established and before the connection is closed. ]*/
+/* Tests_SRS_UWS_CLIENT_01_240: [ The application MUST NOT send any more data frames after sending a Close frame. ]*/
+TEST_FUNCTION(when_a_PING_frame_is_received_after_a_close_frame_no_pong_is_sent)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char close_and_ping_frames[] = { 0x88, 0x00, 0x89, 0x02, 0x42, 0x43 };
+    BUFFER_HANDLE buffer_handle;
+    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sent_close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(sent_close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
+        .IgnoreArgument_callback_context()
+        .IgnoreArgument_on_send_complete();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    EXPECTED_CALL(test_on_ws_peer_closed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)close_and_ping_frames, sizeof(close_and_ping_frames));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* uws_client_set_fragment_received_callback */
+
+/* Tests_SRS_UWS_CLIENT_01_538: [ If `uws_client` is NULL, `uws_client_set_fragment_received_callback` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_client_set_fragment_received_callback_with_NULL_handle_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = uws_client_set_fragment_received_callback(NULL, test_on_ws_fragment_received, (void*)0x4245);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_CLIENT_01_540: [ Otherwise `uws_client_set_fragment_received_callback` shall store `on_ws_fragment_received` and `on_ws_fragment_received_context` and return 0. ]*/
+/* Tests_SRS_UWS_CLIENT_01_541: [ Setting a NULL `on_ws_fragment_received` shall revert to indicating whole messages via `on_ws_frame_received`. ]*/
+TEST_FUNCTION(uws_client_set_fragment_received_callback_with_NULL_callback_succeeds)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
+    // act
+    result = uws_client_set_fragment_received_callback(uws_client, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_539: [ If the uws instance is not CLOSED, `uws_client_set_fragment_received_callback` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_client_set_fragment_received_callback_while_open_fails)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    // act
+    result = uws_client_set_fragment_received_callback(uws_client, test_on_ws_fragment_received, (void*)0x4245);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* uws_client_get_permessage_deflate_statistics */
+
+/* Tests_SRS_UWS_CLIENT_01_581: [ If `uws_client` or `statistics` is NULL, `uws_client_get_permessage_deflate_statistics` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_client_get_permessage_deflate_statistics_with_NULL_handle_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_STATISTICS statistics;
+    int result;
+
+    // act
+    result = uws_client_get_permessage_deflate_statistics(NULL, &statistics);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_CLIENT_01_582: [ If `permessage-deflate` was not negotiated, `uws_client_get_permessage_deflate_statistics` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_client_get_permessage_deflate_statistics_when_not_negotiated_fails)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_STATISTICS statistics;
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
+    // act
+    result = uws_client_get_permessage_deflate_statistics(uws_client, &statistics);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+/* Tests_SRS_UWS_CLIENT_01_583: [ Otherwise `uws_client_get_permessage_deflate_statistics` shall fill `statistics` by calling `uws_permessage_deflate_get_statistics` and return its result. ]*/
+TEST_FUNCTION(uws_client_get_permessage_deflate_statistics_gets_the_statistics_of_the_negotiated_instance)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_STATISTICS statistics;
+    int result;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_get_statistics(TEST_PERMESSAGE_DEFLATE_HANDLE, &statistics));
+
+    // act
+    result = uws_client_get_permessage_deflate_statistics(uws_client, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* permessage-deflate */
+
+/* Tests_SRS_UWS_CLIENT_01_559: [ If the `ws_permessage_deflate` option was set, the upgrade request shall contain a `Sec-WebSocket-Extensions` header whose value is obtained by calling `uws_permessage_deflate_create_offer` with the configured parameters. ]*/
+TEST_FUNCTION(when_ws_permessage_deflate_is_set_the_upgrade_request_carries_the_permessage_deflate_offer)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { true, false, 12, 15, 6 };
+    const char expected_upgrade_request[] = "GET /aaa HTTP/1.1\r\n"
+        "Host: test_host:444\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: ZWRuYW1vZGU6bm9jYXBlcyE=\r\n"
+        "Sec-WebSocket-Protocol: test_protocol\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n"
+        "\r\n";
+    size_t i;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    umock_c_reset_all_calls();
+
+    for (i = 0; i < 16; i++)
+    {
+        EXPECTED_CALL(gb_rand());
+    }
+
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 16));
+    STRICT_EXPECTED_CALL(STRING_c_str(BASE64_ENCODED_STRING)).SetReturn("ZWRuYW1vZGU6bm9jYXBlcyE=");
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_create_offer(IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(1, &config, sizeof(config));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(expected_upgrade_request) - 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, expected_upgrade_request, sizeof(expected_upgrade_request) - 1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(BASE64_ENCODED_STRING));
+
+    // act
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_560: [ If creating the `permessage-deflate` offer fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_CONSTRUCTING_UPGRADE_REQUEST`. ]*/
+TEST_FUNCTION(when_creating_the_permessage_deflate_offer_fails_the_open_fails_with_WS_OPEN_ERROR_CONSTRUCTING_UPGRADE_REQUEST)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    size_t i;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    umock_c_reset_all_calls();
+
+    for (i = 0; i < 16; i++)
+    {
+        EXPECTED_CALL(gb_rand());
+    }
+
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 16));
+    STRICT_EXPECTED_CALL(STRING_c_str(BASE64_ENCODED_STRING));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_create_offer(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_CONSTRUCTING_UPGRADE_REQUEST));
+    STRICT_EXPECTED_CALL(STRING_delete(BASE64_ENCODED_STRING));
+
+    // act
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_561: [ If `permessage-deflate` was offered, on receiving a 101 status the upgrade response shall be passed to `uws_permessage_deflate_negotiate` together with the offered parameters. ]*/
+/* Tests_SRS_UWS_CLIENT_01_565: [ If the server accepted `permessage-deflate`, a compression instance shall be created by calling `uws_permessage_deflate_create` with the negotiated parameters. ]*/
+TEST_FUNCTION(when_the_server_accepts_permessage_deflate_a_compression_instance_is_created)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated = { true, true, 10, 11, -1 };
+    bool is_accepted = true;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Extensions: permessage-deflate\r\n\r\n";
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_negotiate(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(1, &config, sizeof(config))
+        .ValidateArgumentBuffer(2, test_upgrade_response, sizeof(test_upgrade_response) - 1)
+        .CopyOutArgumentBuffer(3, &negotiated, sizeof(negotiated))
+        .CopyOutArgumentBuffer(4, &is_accepted, sizeof(is_accepted))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_create(IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(1, &negotiated, sizeof(negotiated));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_562: [ If `uws_permessage_deflate_negotiate` fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_BAD_UPGRADE_RESPONSE`. ]*/
+TEST_FUNCTION(when_negotiating_permessage_deflate_fails_the_open_fails_with_WS_OPEN_ERROR_BAD_UPGRADE_RESPONSE)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Extensions: permessage-deflate; x\r\n\r\n";
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_negotiate(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_BAD_UPGRADE_RESPONSE));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_564: [ If the server did not accept `permessage-deflate`, messages shall be sent and received uncompressed. ]*/
+TEST_FUNCTION(when_the_server_does_not_accept_permessage_deflate_no_compression_instance_is_created)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    WS_PERMESSAGE_DEFLATE_STATISTICS statistics;
+    bool is_accepted = false;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_negotiate(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(4, &is_accepted, sizeof(is_accepted))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, uws_client_get_permessage_deflate_statistics(uws_client, &statistics));
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_566: [ If `uws_permessage_deflate_create` fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_NOT_ENOUGH_MEMORY`. ]*/
+TEST_FUNCTION(when_creating_the_compression_instance_fails_the_open_fails_with_WS_OPEN_ERROR_NOT_ENOUGH_MEMORY)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Extensions: permessage-deflate\r\n\r\n";
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_negotiate(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_create(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_ERROR_NOT_ENOUGH_MEMORY));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_563: [ Any `permessage-deflate` instance left from a previous connection shall be destroyed by calling `uws_permessage_deflate_destroy`. ]*/
+TEST_FUNCTION(when_reopening_the_compression_instance_of_the_previous_connection_is_destroyed)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Extensions: permessage-deflate\r\n\r\n";
+    const unsigned char close_frame[] = { 0x88, 0x00 };
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    g_on_bytes_received(g_on_bytes_received_context, close_frame, sizeof(close_frame));
+    g_on_io_error(g_on_io_error_context);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_destroy(TEST_PERMESSAGE_DEFLATE_HANDLE));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_negotiate(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_568: [ A received message whose first frame has the RSV1 bit set shall be decompressed by calling `uws_permessage_deflate_decompress` with the `ws_max_message_size` option value as limit before being indicated via `on_ws_frame_received`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_572: [ The RSV1 bit of the first frame of a data message shall be used to determine whether the message is compressed. ]*/
+TEST_FUNCTION(a_received_message_with_RSV1_set_is_decompressed_before_being_indicated)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_frame[] = { 0xC1, 0x02, 0x4B, 0x04 };
+    const unsigned char decompressed_payload[] = { 'a', 'b', 'c' };
+    const unsigned char* decompressed = decompressed_payload;
+    size_t decompressed_length = sizeof(decompressed_payload);
+    size_t max_message_size = 100;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    (void)uws_client_set_option(uws_client, "ws_max_message_size", &max_message_size);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_decompress(TEST_PERMESSAGE_DEFLATE_HANDLE, IGNORED_PTR_ARG, 2, true, max_message_size, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(2, &test_frame[2], 2)
+        .CopyOutArgumentBuffer(6, &decompressed, sizeof(decompressed))
+        .CopyOutArgumentBuffer(7, &decompressed_length, sizeof(decompressed_length));
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, decompressed_payload, sizeof(decompressed_payload)));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_572: [ The RSV1 bit of the first frame of a data message shall be used to determine whether the message is compressed. ]*/
+TEST_FUNCTION(a_received_message_without_RSV1_is_indicated_without_decompressing_it)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_frame[] = { 0x82, 0x01, 0x42 };
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, &test_frame[2], 1));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_569: [ If decompressing a received message fails, uws shall send a CLOSE frame with code 1002 and indicate `WS_ERROR_BAD_FRAME_RECEIVED` via `on_ws_error`. ]*/
+TEST_FUNCTION(when_decompressing_a_received_message_fails_the_connection_is_failed_with_1002)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_frame[] = { 0xC2, 0x02, 0x4B, 0x04 };
+    unsigned char close_frame_payload[] = { 0x03, 0xEA };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEA };
+    BUFFER_HANDLE buffer_handle;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_decompress(TEST_PERMESSAGE_DEFLATE_HANDLE, IGNORED_PTR_ARG, 2, true, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_570: [ If the decompressed message exceeds the `ws_max_message_size` option, uws shall send a CLOSE frame with code 1009 and indicate `WS_ERROR_MESSAGE_TOO_BIG` via `on_ws_error`. ]*/
+TEST_FUNCTION(when_a_decompressed_message_exceeds_the_max_message_size_the_connection_is_failed_with_1009)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_frame[] = { 0xC2, 0x02, 0x4B, 0x04 };
+    const unsigned char decompressed_payload[] = { 'a', 'b', 'c' };
+    const unsigned char* decompressed = decompressed_payload;
+    size_t decompressed_length = sizeof(decompressed_payload);
+    unsigned char close_frame_payload[] = { 0x03, 0xF1 };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xF1 };
+    size_t max_message_size = 2;
+    BUFFER_HANDLE buffer_handle;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    (void)uws_client_set_option(uws_client, "ws_max_message_size", &max_message_size);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_decompress(TEST_PERMESSAGE_DEFLATE_HANDLE, IGNORED_PTR_ARG, 2, true, max_message_size, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(6, &decompressed, sizeof(decompressed))
+        .CopyOutArgumentBuffer(7, &decompressed_length, sizeof(decompressed_length));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_MESSAGE_TOO_BIG));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_571: [ When streaming a compressed message, each received chunk shall be decompressed by calling `uws_permessage_deflate_decompress` and the decompressed bytes shall be indicated via `on_ws_fragment_received`. ]*/
+TEST_FUNCTION(when_a_fragment_callback_is_set_the_chunks_of_a_compressed_message_are_decompressed_as_they_arrive)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_frames[] = { 0x41, 0x01, 0x4B, 0x80, 0x01, 0x04 };
+    const unsigned char first_decompressed_payload[] = { 'a', 'b' };
+    const unsigned char last_decompressed_payload[] = { 'c' };
+    const unsigned char* first_decompressed = first_decompressed_payload;
+    const unsigned char* last_decompressed = last_decompressed_payload;
+    size_t first_decompressed_length = sizeof(first_decompressed_payload);
+    size_t last_decompressed_length = sizeof(last_decompressed_payload);
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Extensions: permessage-deflate\r\n\r\n";
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
+    (void)uws_client_set_fragment_received_callback(uws_client, test_on_ws_fragment_received, (void*)0x4245);
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_decompress(TEST_PERMESSAGE_DEFLATE_HANDLE, &test_frames[2], 1, false, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(6, &first_decompressed, sizeof(first_decompressed))
+        .CopyOutArgumentBuffer(7, &first_decompressed_length, sizeof(first_decompressed_length));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_TEXT, WS_FRAGMENT_BEGIN, first_decompressed_payload, sizeof(first_decompressed_payload)));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_decompress(TEST_PERMESSAGE_DEFLATE_HANDLE, &test_frames[5], 1, true, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(6, &last_decompressed, sizeof(last_decompressed))
+        .CopyOutArgumentBuffer(7, &last_decompressed_length, sizeof(last_decompressed_length));
+    STRICT_EXPECTED_CALL(test_on_ws_fragment_received((void*)0x4245, WS_FRAME_TYPE_TEXT, WS_FRAGMENT_END, last_decompressed_payload, sizeof(last_decompressed_payload)));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frames, sizeof(test_frames));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_573: [ If the RSV1 bit is set on a continuation or control frame, uws shall send a CLOSE frame with code 1002 and indicate `WS_ERROR_BAD_FRAME_RECEIVED` via `on_ws_error`. ]*/
+TEST_FUNCTION(when_RSV1_is_set_on_a_control_frame_the_connection_is_failed_with_1002)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_frame[] = { 0xC9, 0x00 };
+    unsigned char close_frame_payload[] = { 0x03, 0xEA };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEA };
+    BUFFER_HANDLE buffer_handle;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_574: [ When `permessage-deflate` was negotiated, an unfragmented text or binary message shall be compressed by calling `uws_permessage_deflate_compress`, reserving `UWS_FRAME_ENCODER_MAX_HEADER_SIZE` bytes of headroom before the compressed payload. ]*/
+/* Tests_SRS_UWS_CLIENT_01_576: [ The compressed payload shall be encoded in place by calling `uws_frame_encoder_encode_in_place` with `is_masked` set to true and the RSV1 bit set. ]*/
+TEST_FUNCTION(when_permessage_deflate_was_negotiated_a_message_is_sent_compressed)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_payload[] = { 'a', 'b', 'c' };
+    unsigned char compressed_frame[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 2];
+    unsigned char* compressed = compressed_frame + UWS_FRAME_ENCODER_MAX_HEADER_SIZE;
+    size_t compressed_length = 2;
+    size_t frame_offset = UWS_FRAME_ENCODER_MAX_HEADER_SIZE - 6;
+    int result;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_compress(TEST_PERMESSAGE_DEFLATE_HANDLE, test_payload, sizeof(test_payload), UWS_FRAME_ENCODER_MAX_HEADER_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(5, &compressed, sizeof(compressed))
+        .CopyOutArgumentBuffer(6, &compressed_length, sizeof(compressed_length));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_in_place(WS_TEXT_FRAME, compressed_frame, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, compressed_length, true, true, RESERVED_1, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(8, &frame_offset, sizeof(frame_offset));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item();
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, compressed_frame + frame_offset, UWS_FRAME_ENCODER_MAX_HEADER_SIZE - frame_offset + compressed_length, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context();
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_575: [ If `uws_permessage_deflate_compress` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_compressing_the_message_fails_uws_client_send_frame_async_fails)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_payload[] = { 'a', 'b', 'c' };
+    int result;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_compress(TEST_PERMESSAGE_DEFLATE_HANDLE, test_payload, sizeof(test_payload), UWS_FRAME_ENCODER_MAX_HEADER_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_577: [ Fragmented messages shall be sent uncompressed. ]*/
+TEST_FUNCTION(when_permessage_deflate_was_negotiated_a_fragment_is_sent_uncompressed)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    unsigned char test_payload[] = { 0x42 };
+    unsigned char encoded_frame[] = { 0x02, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
+    int result;
+    BUFFER_HANDLE buffer_handle;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_BINARY_FRAME, test_payload, sizeof(test_payload), true, false, 0))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(encoded_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item();
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, IGNORED_PTR_ARG, sizeof(encoded_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .ValidateArgumentBuffer(2, encoded_frame, sizeof(encoded_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_BINARY, test_payload, sizeof(test_payload), false, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_584: [ If encoding or sending the compressed frame fails and `client_no_context_takeover` was not negotiated, uws shall send a close frame with code 1011, go to the error state and indicate the error by calling `on_ws_error` with `WS_ERROR_UNDERLYING_IO_ERROR`. ]*/
+TEST_FUNCTION(when_sending_a_compressed_frame_fails_and_the_client_context_is_taken_over_the_connection_is_failed_with_1011)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_payload[] = { 'a', 'b', 'c' };
+    unsigned char compressed_frame[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 2];
+    unsigned char* compressed = compressed_frame + UWS_FRAME_ENCODER_MAX_HEADER_SIZE;
+    size_t compressed_length = 2;
+    size_t frame_offset = UWS_FRAME_ENCODER_MAX_HEADER_SIZE - 6;
+    unsigned char close_frame_payload[] = { 0x03, 0xF3 };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xF3 };
+    LIST_ITEM_HANDLE new_item_handle;
+    BUFFER_HANDLE buffer_handle;
+    int result;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(false);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_compress(TEST_PERMESSAGE_DEFLATE_HANDLE, test_payload, sizeof(test_payload), UWS_FRAME_ENCODER_MAX_HEADER_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(5, &compressed, sizeof(compressed))
+        .CopyOutArgumentBuffer(6, &compressed_length, sizeof(compressed_length));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_in_place(WS_TEXT_FRAME, compressed_frame, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, compressed_length, true, true, RESERVED_1, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(8, &frame_offset, sizeof(frame_offset));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_item()
+        .CaptureReturn(&new_item_handle);
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, compressed_frame + frame_offset, UWS_FRAME_ENCODER_MAX_HEADER_SIZE - frame_offset + compressed_length, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_on_send_complete()
+        .IgnoreArgument_callback_context()
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn((LIST_ITEM_HANDLE)0x1234);
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG))
+        .ValidateArgumentValue_item_handle(&new_item_handle);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_UNDERLYING_IO_ERROR));
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_584: [ If encoding or sending the compressed frame fails and `client_no_context_takeover` was not negotiated, uws shall send a close frame with code 1011, go to the error state and indicate the error by calling `on_ws_error` with `WS_ERROR_UNDERLYING_IO_ERROR`. ]*/
+TEST_FUNCTION(when_encoding_a_compressed_frame_fails_without_client_context_takeover_only_the_send_fails)
+{
+    // arrange
+    UWS_CLIENT_HANDLE uws_client;
+    const unsigned char test_payload[] = { 'a', 'b', 'c' };
+    unsigned char compressed_frame[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 2];
+    unsigned char* compressed = compressed_frame + UWS_FRAME_ENCODER_MAX_HEADER_SIZE;
+    size_t compressed_length = 2;
+    int result;
+
+    uws_client = create_and_open_uws_client_with_permessage_deflate(true);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(uws_permessage_deflate_compress(TEST_PERMESSAGE_DEFLATE_HANDLE, test_payload, sizeof(test_payload), UWS_FRAME_ENCODER_MAX_HEADER_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(5, &compressed, sizeof(compressed))
+        .CopyOutArgumentBuffer(6, &compressed_length, sizeof(compressed_length));
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode_in_place(WS_TEXT_FRAME, compressed_frame, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, compressed_length, true, true, RESERVED_1, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = uws_client_send_frame_async(uws_client, WS_FRAME_TYPE_TEXT, test_payload, sizeof(test_payload), true, test_on_ws_send_frame_complete, (void*)0x4248);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+#endif
+
+/* uws_setoption */
+
+/* Tests_SRS_UWS_CLIENT_01_440: [ If any of the arguments `uws_client` or `option_name` is NULL `uws_client_set_option` shall return a non-zero value. ]*/
+TEST_FUNCTION(uws_set_option_with_NULL_uws_handle_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = uws_client_set_option(NULL, "test_option", (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_CLIENT_01_440: [ If any of the arguments `uws_client` or `option_name` is NULL `uws_client_set_option` shall return a non-zero value. ]*/
+TEST_FUNCTION(uws_set_option_with_NULL_option_name_fails)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
+    // act
+    result = uws_client_set_option(uws_client, NULL, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_510: [ If the option name is `uWSClientOptions` then `uws_client_set_option` shall call `OptionHandler_FeedOptions` and pass to it the underlying IO handle and the `value` argument. ]*/
+/* Tests_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
+TEST_FUNCTION(uws_set_option_with_uws_client_options_calls_OptionHandler_FeedOptions)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    int result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)0x4242, TEST_IO_HANDLE));
 
     // act
-    result = uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    result = uws_client_set_option(uws_client, "uWSClientOptions", (void*)0x4242);
 
     // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Ping frame */
-
-/* Tests_SRS_UWS_CLIENT_01_157: [ *  %x9 denotes a ping ]*/
-/* Tests_SRS_UWS_CLIENT_01_249: [ Upon receipt of a Ping frame, an endpoint MUST send a Pong frame in response ]*/
-/* Tests_SRS_UWS_CLIENT_01_250: [ It SHOULD respond with Pong frame as soon as is practical. ]*/
-/* Tests_SRS_UWS_CLIENT_01_253: [ A Pong frame sent in response to a Ping frame must have identical "Application data" as found in the message body of the Ping frame being replied to. ]*/
-/* Tests_SRS_UWS_CLIENT_01_247: [ The Ping frame contains an opcode of 0x9. ]*/
-/* Tests_SRS_UWS_CLIENT_01_251: [ An endpoint MAY send a Ping frame any time after the connection is established and before the connection is closed. ]*/
-TEST_FUNCTION(when_a_PING_frame_was_received_a_PONG_frame_is_sent)
+/* Tests_SRS_UWS_CLIENT_01_511: [ If `OptionHandler_FeedOptions` fails, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_OptionHandler_FeedOptions_fails_then_uws_set_option_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char ping_frame[] = { 0x89, 0x00 };
-    unsigned char pong_frame[] = { 0x8A, 0x00, 0x00, 0x00, 0x00, 0x00 };
-    BUFFER_HANDLE buffer_handle;
+    int result;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
-
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, IGNORED_PTR_ARG, 0, true, true, 0))
-        .IgnoreArgument_payload()
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(pong_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(pong_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, pong_frame, sizeof(pong_frame), IGNORED_PTR_ARG, NULL))
-        .ValidateArgumentBuffer(2, pong_frame, sizeof(pong_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)0x4242, TEST_IO_HANDLE))
+        .SetReturn(OPTIONHANDLER_ERROR);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)ping_frame, sizeof(ping_frame));
+    result = uws_client_set_option(uws_client, "uWSClientOptions", (void*)0x4242);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_253: [ A Pong frame sent in response to a Ping frame must have identical "Application data" as found in the message body of the Ping frame being replied to. ]*/
-/* Tests_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
-TEST_FUNCTION(when_a_PING_frame_was_received_with_some_payload_a_PONG_frame_is_sent_with_the_Same_payload)
+/* Tests_SRS_UWS_CLIENT_01_441: [ Otherwise all options shall be passed as they are to the underlying IO by calling `xio_setoption`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
+TEST_FUNCTION(uws_set_option_passes_the_option_down)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char ping_frame[] = { 0x89, 0x02, 0x42, 0x43 };
-    unsigned char pong_frame_payload[] = { 0x42, 0x43 };
-    unsigned char pong_frame[] = { 0x8A, 0x02, 0x00, 0x00, 0x00, 0x00, 0x42, 0x43 };
-    BUFFER_HANDLE buffer_handle;
+    int result;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
-
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(BUFFER_new())
-        .CaptureReturn(&buffer_handle);
-
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_PONG_FRAME, pong_frame_payload, sizeof(pong_frame_payload), true, true, 0))
-        .ValidateArgumentBuffer(2, pong_frame_payload, sizeof(pong_frame_payload))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(pong_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(pong_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, pong_frame, sizeof(pong_frame), IGNORED_PTR_ARG, NULL))
-        .ValidateArgumentBuffer(2, pong_frame, sizeof(pong_frame));
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(xio_setoption(TEST_IO_HANDLE, "option1", (void*)0x4242));
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)ping_frame, sizeof(ping_frame));
+    result = uws_client_set_option(uws_client, "option1", (void*)0x4242);
 
     // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_251: [ An endpoint MAY send a Ping frame any time after the connection is established and before the connection is closed. ]*/
-/* Tests_SRS_UWS_CLIENT_01_240: [ The application MUST NOT send any more data frames after sending a Close frame. ]*/
-TEST_FUNCTION(when_a_PING_frame_is_received_after_a_close_frame_no_pong_is_sent)
+/* Tests_SRS_UWS_CLIENT_01_443: [ If `xio_setoption` fails, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_xio_setoption_fails_then_uws_set_option_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
-    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
-    const unsigned char close_and_ping_frames[] = { 0x88, 0x00, 0x89, 0x02, 0x42, 0x43 };
-    BUFFER_HANDLE buffer_handle;
-    unsigned char sent_close_frame[] = { 0x88, 0x80, 0x00, 0x00, 0x00, 0x00 };
+    int result;
 
     tlsio_config.hostname = "test_host";
     tlsio_config.port = 444;
-
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
-    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
-    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
-        .CaptureReturn(&buffer_handle);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sent_close_frame);
-    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle)
-        .SetReturn(sizeof(sent_close_frame));
-    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, sent_close_frame, sizeof(sent_close_frame), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .ValidateArgumentBuffer(2, sent_close_frame, sizeof(sent_close_frame))
-        .IgnoreArgument_callback_context()
-        .IgnoreArgument_on_send_complete();
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
-        .ValidateArgumentValue_handle(&buffer_handle);
-    EXPECTED_CALL(test_on_ws_peer_closed(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(xio_setoption(TEST_IO_HANDLE, "option1", (void*)0x4242))
+        .SetReturn(1);
 
     // act
-    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)close_and_ping_frames, sizeof(close_and_ping_frames));
+    result = uws_client_set_option(uws_client, "option1", (void*)0x4242);
 
     // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* uws_setoption */
-
-/* Tests_SRS_UWS_CLIENT_01_440: [ If any of the arguments `uws_client` or `option_name` is NULL `uws_client_set_option` shall return a non-zero value. ]*/
-TEST_FUNCTION(uws_set_option_with_NULL_uws_handle_fails)
+/* Tests_SRS_UWS_CLIENT_01_542: [ If the option name is `ws_max_message_size` and `value` is NULL, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_set_option_with_ws_max_message_size_and_NULL_value_fails)
 {
     // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
     int result;
 
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    umock_c_reset_all_calls();
+
     // act
-    result = uws_client_set_option(NULL, "test_option", (void*)0x4242);
+    result = uws_client_set_option(uws_client, "ws_max_message_size", NULL);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_440: [ If any of the arguments `uws_client` or `option_name` is NULL `uws_client_set_option` shall return a non-zero value. ]*/
-TEST_FUNCTION(uws_set_option_with_NULL_option_name_fails)
+/* Tests_SRS_UWS_CLIENT_01_543: [ If the option name is `ws_max_message_size`, `value` shall be interpreted as a pointer to a `size_t` holding the largest message size uws reassembles, 0 meaning no limit. ]*/
+/* Tests_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
+TEST_FUNCTION(uws_set_option_with_ws_max_message_size_does_not_pass_the_option_down)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    size_t max_message_size = 4096;
     int result;
 
     tlsio_config.hostname = "test_host";
@@ -6852,19 +8408,18 @@ TEST_FUNCTION(uws_set_option_with_NULL_option_name_fails)
     umock_c_reset_all_calls();
 
     // act
-    result = uws_client_set_option(uws_client, NULL, (void*)0x4242);
+    result = uws_client_set_option(uws_client, "ws_max_message_size", &max_message_size);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_510: [ If the option name is `uWSClientOptions` then `uws_client_set_option` shall call `OptionHandler_FeedOptions` and pass to it the underlying IO handle and the `value` argument. ]*/
-/* Tests_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
-TEST_FUNCTION(uws_set_option_with_uws_client_options_calls_OptionHandler_FeedOptions)
+/* Tests_SRS_UWS_CLIENT_01_555: [ If the option name is `ws_permessage_deflate` and `value` is NULL, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_set_option_with_ws_permessage_deflate_and_NULL_value_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
@@ -6876,25 +8431,25 @@ TEST_FUNCTION(uws_set_option_with_uws_client_options_calls_OptionHandler_FeedOpt
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)0x4242, TEST_IO_HANDLE));
-
     // act
-    result = uws_client_set_option(uws_client, "uWSClientOptions", (void*)0x4242);
+    result = uws_client_set_option(uws_client, "ws_permessage_deflate", NULL);
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_511: [ If `OptionHandler_FeedOptions` fails, `uws_client_set_option` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(when_OptionHandler_FeedOptions_fails_then_uws_set_option_fails)
+#ifdef USE_WS_PERMESSAGE_DEFLATE
+/* Tests_SRS_UWS_CLIENT_01_557: [ If the `ws_permessage_deflate` configuration has a `client_max_window_bits` outside 9..15, a `server_max_window_bits` outside 8..15 or a `compression_level` outside -1..9, `uws_client_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_set_option_with_ws_permessage_deflate_and_8_client_window_bits_fails)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 8, 15, -1 };
     int result;
 
     tlsio_config.hostname = "test_host";
@@ -6902,11 +8457,8 @@ TEST_FUNCTION(when_OptionHandler_FeedOptions_fails_then_uws_set_option_fails)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)0x4242, TEST_IO_HANDLE))
-        .SetReturn(OPTIONHANDLER_ERROR);
-
     // act
-    result = uws_client_set_option(uws_client, "uWSClientOptions", (void*)0x4242);
+    result = uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
@@ -6916,13 +8468,14 @@ TEST_FUNCTION(when_OptionHandler_FeedOptions_fails_then_uws_set_option_fails)
     uws_client_destroy(uws_client);
 }
 
-/* Tests_SRS_UWS_CLIENT_01_441: [ Otherwise all options shall be passed as they are to the underlying IO by calling `xio_setoption`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_558: [ If the option name is `ws_permessage_deflate`, `value` shall be interpreted as a pointer to a `WS_PERMESSAGE_DEFLATE_CONFIG` and a copy of it shall be kept, replacing any previously set configuration, to be offered on the next open. ]*/
 /* Tests_SRS_UWS_CLIENT_01_442: [ On success, `uws_client_set_option` shall return 0. ]*/
-TEST_FUNCTION(uws_set_option_passes_the_option_down)
+TEST_FUNCTION(uws_set_option_with_ws_permessage_deflate_copies_the_config)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
     int result;
 
     tlsio_config.hostname = "test_host";
@@ -6930,10 +8483,11 @@ TEST_FUNCTION(uws_set_option_passes_the_option_down)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_setoption(TEST_IO_HANDLE, "option1", (void*)0x4242));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(WS_PERMESSAGE_DEFLATE_CONFIG)));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
 
     // act
-    result = uws_client_set_option(uws_client, "option1", (void*)0x4242);
+    result = uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
 
     // assert
     ASSERT_ARE_EQUAL(int, 0, result);
@@ -6942,13 +8496,14 @@ TEST_FUNCTION(uws_set_option_passes_the_option_down)
     // cleanup
     uws_client_destroy(uws_client);
 }
-
-/* Tests_SRS_UWS_CLIENT_01_443: [ If `xio_setoption` fails, `uws_client_set_option` shall fail and return a non-zero value. ]*/
-TEST_FUNCTION(when_xio_setoption_fails_then_uws_set_option_fails)
+#else
+/* Tests_SRS_UWS_CLIENT_01_556: [ If uws was built without `use_ws_permessage_deflate`, setting the `ws_permessage_deflate` option shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_set_option_with_ws_permessage_deflate_fails_when_not_built_in)
 {
     // arrange
     TLSIO_CONFIG tlsio_config;
     UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
     int result;
 
     tlsio_config.hostname = "test_host";
@@ -6956,11 +8511,8 @@ TEST_FUNCTION(when_xio_setoption_fails_then_uws_set_option_fails)
     uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(xio_setoption(TEST_IO_HANDLE, "option1", (void*)0x4242))
-        .SetReturn(1);
-
     // act
-    result = uws_client_set_option(uws_client, "option1", (void*)0x4242);
+    result = uws_client_set_option(uws_client, "ws_permessage_deflate", &config);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
@@ -6969,6 +8521,7 @@ TEST_FUNCTION(when_xio_setoption_fails_then_uws_set_option_fails)
     // cleanup
     uws_client_destroy(uws_client);
 }
+#endif
 
 /* uws_client_retrieve_options */
 
@@ -7131,6 +8684,68 @@ TEST_FUNCTION(uws_client_clone_option_calls_xio_cloneoption)
     uws_client_destroy(uws_client);
 }
 
+/* Tests_SRS_UWS_CLIENT_01_544: [ `uws_client_clone_option` called with `name` being `ws_max_message_size` shall return a newly allocated copy of the `size_t` value. ]*/
+TEST_FUNCTION(uws_client_clone_option_with_ws_max_message_size_copies_the_value)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    size_t max_message_size = 4096;
+    void* result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_retrieve_options(uws_client);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(size_t)));
+
+    // act
+    result = g_clone_option("ws_max_message_size", &max_message_size);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(size_t, 4096, *(size_t*)result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    g_destroy_option("ws_max_message_size", result);
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_578: [ `uws_client_clone_option` called with `name` being `ws_permessage_deflate` shall return a newly allocated copy of the `WS_PERMESSAGE_DEFLATE_CONFIG` value. ]*/
+TEST_FUNCTION(uws_client_clone_option_with_ws_permessage_deflate_copies_the_value)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { true, false, 12, 15, 6 };
+    void* result;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_retrieve_options(uws_client);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(WS_PERMESSAGE_DEFLATE_CONFIG)));
+
+    // act
+    result = g_clone_option("ws_permessage_deflate", &config);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_IS_TRUE(((WS_PERMESSAGE_DEFLATE_CONFIG*)result)->client_no_context_takeover);
+    ASSERT_ARE_EQUAL(int, 12, ((WS_PERMESSAGE_DEFLATE_CONFIG*)result)->client_max_window_bits);
+    ASSERT_ARE_EQUAL(int, 6, ((WS_PERMESSAGE_DEFLATE_CONFIG*)result)->compression_level);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    g_destroy_option("ws_permessage_deflate", result);
+    uws_client_destroy(uws_client);
+}
+
 /* Tests_SRS_UWS_CLIENT_01_512: [ `uws_client_clone_option` called with any other option name than `uWSClientOptions` shall return NULL. ]*/
 TEST_FUNCTION(uws_client_clone_with_an_unknown_option_fails)
 {
@@ -7302,6 +8917,62 @@ TEST_FUNCTION(uws_client_destroy_option_with_uWSClientOptions_calls_OptionHandle
     uws_client_destroy(uws_client);
 }
 
+/* Tests_SRS_UWS_CLIENT_01_545: [ `uws_client_destroy_option` called with the option `name` being `ws_max_message_size` shall free the value. ]*/
+TEST_FUNCTION(uws_client_destroy_option_with_ws_max_message_size_frees_the_value)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    size_t max_message_size = 4096;
+    void* cloned_value;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_retrieve_options(uws_client);
+    cloned_value = g_clone_option("ws_max_message_size", &max_message_size);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(cloned_value));
+
+    // act
+    g_destroy_option("ws_max_message_size", cloned_value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_579: [ `uws_client_destroy_option` called with the option `name` being `ws_permessage_deflate` shall free the value. ]*/
+TEST_FUNCTION(uws_client_destroy_option_with_ws_permessage_deflate_frees_the_value)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    WS_PERMESSAGE_DEFLATE_CONFIG config = { false, false, 15, 15, -1 };
+    void* cloned_value;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_retrieve_options(uws_client);
+    cloned_value = g_clone_option("ws_permessage_deflate", &config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(cloned_value));
+
+    // act
+    g_destroy_option("ws_permessage_deflate", cloned_value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
 /* on_underlying_io_close_complete */
 
 /* Tests_SRS_UWS_CLIENT_01_475: [ When `on_underlying_io_close_complete` is called while closing the underlying IO a subsequent `uws_client_open_async` shall succeed. ]*/
@@ -7324,7 +8995,6 @@ TEST_FUNCTION(underlying_io_close_after_a_send_close_frame_failed_puts_the_uws_i
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -7376,7 +9046,6 @@ TEST_FUNCTION(underlying_io_close_due_to_CLOSE_frame_being_received_doe_not_trig
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -7419,7 +9088,6 @@ TEST_FUNCTION(underlying_io_close_complete_with_NULL_context_does_nothing)
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
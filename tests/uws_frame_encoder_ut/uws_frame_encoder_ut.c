@@ -101,6 +101,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_enlarge, real_BUFFER_enlarge);
 
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(size_t*, void*);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -245,6 +246,33 @@ TEST_FUNCTION(when_BUFFER_u_char_fails_then_uws_frame_encoder_encode_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+/* Tests_SRS_UWS_FRAME_ENCODER_01_055: [ If `gb_rand_bytes` fails then `uws_frame_encoder_encode` shall fail and return NULL. ]*/
+TEST_FUNCTION(when_gb_rand_bytes_fails_then_uws_frame_encoder_encode_fails)
+{
+    // arrange
+    BUFFER_HANDLE result;
+    BUFFER_HANDLE newly_created_buffer;
+    unsigned char payload[] = { 0x42 };
+
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .CaptureReturn(&newly_created_buffer);
+    STRICT_EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, 7))
+        .ValidateArgumentValue_handle(&newly_created_buffer);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&newly_created_buffer);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&newly_created_buffer);
+
+    // act
+    result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 /* Tests_SRS_UWS_FRAME_ENCODER_01_002: [ Indicates that this is the final fragment in a message. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_003: [ The first fragment MAY also be the final fragment. ]*/
 TEST_FUNCTION(uws_frame_encoder_encode_encodes_a_zero_length_binary_frame_that_is_not_final)
@@ -884,7 +912,7 @@ TEST_FUNCTION(uws_frame_encoder_encodes_a_reserved_control_frame_F)
 }
 
 /* Tests_SRS_UWS_FRAME_ENCODER_01_015: [ Defines whether the "Payload data" is masked. ]*/
-/* Tests_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand` shall be used 4 times (for each byte). ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand_bytes` shall be called once to fill the 4 bytes of the masking key. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_016: [ If set to 1, a masking key is present in masking-key, and this is used to unmask the "Payload data" as per Section 5.3. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_026: [ This field is present if the mask bit is set to 1 and is absent if the mask bit is set to 0. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_042: [ The payload length, indicated in the framing as frame-payload-length, does NOT include the length of the masking key. ]*/
@@ -893,6 +921,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_encodes_a_masked_zero_length_binary_frame
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0xFF, 0xFF, 0xFF, 0xFF };
     unsigned char expected_bytes[] = { 0x82, 0x80, 0xFF, 0xFF, 0xFF, 0xFF };
 
     STRICT_EXPECTED_CALL(BUFFER_new())
@@ -901,14 +930,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_encodes_a_masked_zero_length_binary_frame
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, NULL, 0, true, true, 0);
@@ -925,7 +948,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_encodes_a_masked_zero_length_binary_frame
 }
 
 /* Tests_SRS_UWS_FRAME_ENCODER_01_015: [ Defines whether the "Payload data" is masked. ]*/
-/* Tests_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand` shall be used 4 times (for each byte). ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand_bytes` shall be called once to fill the 4 bytes of the masking key. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_016: [ If set to 1, a masking key is present in masking-key, and this is used to unmask the "Payload data" as per Section 5.3. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_026: [ This field is present if the mask bit is set to 1 and is absent if the mask bit is set to 0. ]*/
 /* Tests_SRS_UWS_FRAME_ENCODER_01_042: [ The payload length, indicated in the framing as frame-payload-length, does NOT include the length of the masking key. ]*/
@@ -934,6 +957,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_encodes_a_masked_zero_length_binary_frame
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0x42, 0x43, 0x44, 0x45 };
     unsigned char expected_bytes[] = { 0x82, 0x80, 0x42, 0x43, 0x44, 0x45 };
 
     STRICT_EXPECTED_CALL(BUFFER_new())
@@ -942,14 +966,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_encodes_a_masked_zero_length_binary_frame
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x42);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x43);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x44);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x45);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, NULL, 0, true, true, 0);
@@ -1204,6 +1222,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_1_byte_frame_with_0_as_mask)
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0x00, 0x00, 0x00, 0x00 };
     unsigned char payload[] = { 0x42 };
     unsigned char expected_bytes[] = { 0x82, 0x81, 0x00, 0x00, 0x00, 0x00, 0x42 };
 
@@ -1213,14 +1232,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_1_byte_frame_with_0_as_mask)
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
@@ -1250,6 +1263,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_1_byte_frame_with_0xFF_as_mask)
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0xFF, 0x00, 0x00, 0x00 };
     unsigned char payload[] = { 0x42 };
     unsigned char expected_bytes[] = { 0x82, 0x81, 0xFF, 0x00, 0x00, 0x00, 0xBD };
 
@@ -1259,14 +1273,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_1_byte_frame_with_0xFF_as_mask)
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
@@ -1296,6 +1304,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_4_byte_frame_with_0xFF_as_mask)
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0xFF, 0xFF, 0xFF, 0xFF };
     unsigned char payload[] = { 0x42, 0x43, 0x44, 0x45 };
     unsigned char expected_bytes[] = { 0x82, 0x84, 0xFF, 0xFF, 0xFF, 0xFF, 0xBD, 0xBC, 0xBB, 0xBA };
 
@@ -1305,14 +1314,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_4_byte_frame_with_0xFF_as_mask)
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
@@ -1342,6 +1345,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_5_byte_frame_with_0xFF_as_mask)
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0xFF, 0xFF, 0xFF, 0xFF };
     unsigned char payload[] = { 0x42, 0x43, 0x44, 0x45, 0x01 };
     unsigned char expected_bytes[] = { 0x82, 0x85, 0xFF, 0xFF, 0xFF, 0xFF, 0xBD, 0xBC, 0xBB, 0xBA, 0xFE };
 
@@ -1351,14 +1355,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_5_byte_frame_with_0xFF_as_mask)
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
@@ -1388,6 +1386,7 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_8_byte_frame_with_different_mask_
     // arrange
     BUFFER_HANDLE result;
     BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0x00, 0xFF, 0xAA, 0x42 };
     unsigned char payload[] = { 0x42, 0x43, 0x44, 0x45, 0x01, 0x02, 0xFF, 0xAA };
     unsigned char expected_bytes[] = { 0x82, 0x88, 0x00, 0xFF, 0xAA, 0x42, 0x42, 0xBC, 0xEE, 0x07, 0x01, 0xFD, 0x55, 0xE8 };
 
@@ -1397,14 +1396,8 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_8_byte_frame_with_different_mask_
         .ValidateArgumentValue_handle(&newly_created_buffer);
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .ValidateArgumentValue_handle(&newly_created_buffer);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x00);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xFF);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0xAA);
-    STRICT_EXPECTED_CALL(gb_rand())
-        .SetReturn(0x42);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
 
     // act
     result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
@@ -1420,4 +1413,191 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_8_byte_frame_with_different_mask_
     real_BUFFER_delete(result);
 }
 
+/* Tests_SRS_UWS_FRAME_ENCODER_01_041: [ Octet i of the transformed data ("transformed-octet-i") is the XOR of octet i of the original data ("original-octet-i") with octet at index i modulo 4 of the masking key ("masking-key-octet-j"): ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_masks_a_frame_longer_than_the_masking_blocks)
+{
+    // arrange
+    BUFFER_HANDLE result;
+    BUFFER_HANDLE newly_created_buffer;
+    unsigned char mask_key[] = { 0x01, 0x80, 0xAA, 0x42 };
+    unsigned char payload[77];
+    unsigned char* encoded_bytes;
+    size_t i;
+
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = (unsigned char)(i * 7);
+    }
+
+    STRICT_EXPECTED_CALL(BUFFER_new())
+        .CaptureReturn(&newly_created_buffer);
+    STRICT_EXPECTED_CALL(BUFFER_enlarge(IGNORED_PTR_ARG, 6 + sizeof(payload)))
+        .ValidateArgumentValue_handle(&newly_created_buffer);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&newly_created_buffer);
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
+
+    // act
+    result = uws_frame_encoder_encode(WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(size_t, 6 + sizeof(payload), real_BUFFER_length(result));
+    encoded_bytes = real_BUFFER_u_char(result);
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)(payload[i] ^ mask_key[i % 4]), (int)encoded_bytes[6 + i]);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    real_BUFFER_delete(result);
+}
+
+/* uws_frame_encoder_encode_in_place */
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_056: [ If `buffer` or `frame_offset` is NULL, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_NULL_buffer_fails)
+{
+    // arrange
+    int result;
+    size_t frame_offset;
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, NULL, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, true, 0, &frame_offset);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_056: [ If `buffer` or `frame_offset` is NULL, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_NULL_frame_offset_fails)
+{
+    // arrange
+    int result;
+    unsigned char buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1];
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, true, 0, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_057: [ If `reserved` has any bits set except the lowest 3 or `opcode` is greater than 0x0F, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_invalid_reserved_bits_fails)
+{
+    // arrange
+    int result;
+    size_t frame_offset;
+    unsigned char buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1];
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, true, 0x08, &frame_offset);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_058: [ If `headroom` is smaller than the header needed for the frame, `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_with_too_small_headroom_fails)
+{
+    // arrange
+    int result;
+    size_t frame_offset;
+    unsigned char buffer[5 + 1];
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, buffer, 5, 1, true, true, 0, &frame_offset);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_059: [ `uws_frame_encoder_encode_in_place` shall write the frame header in the `headroom` bytes immediately before the `length` payload bytes that start at `buffer + headroom`, encoded the same way `uws_frame_encoder_encode` encodes it. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_061: [ If `is_masked` is true, the payload shall be masked in place. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_062: [ On success `uws_frame_encoder_encode_in_place` shall set `frame_offset` to the offset in `buffer` where the encoded frame starts and return 0. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_encodes_a_masked_8_byte_binary_frame)
+{
+    // arrange
+    int result;
+    size_t frame_offset;
+    unsigned char mask_key[] = { 0x00, 0xFF, 0xAA, 0x42 };
+    unsigned char payload[] = { 0x42, 0x43, 0x44, 0x45, 0x01, 0x02, 0xFF, 0xAA };
+    unsigned char expected_bytes[] = { 0x82, 0x88, 0x00, 0xFF, 0xAA, 0x42, 0x42, 0xBC, 0xEE, 0x07, 0x01, 0xFD, 0x55, 0xE8 };
+    unsigned char buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + sizeof(payload)];
+
+    (void)memcpy(buffer + UWS_FRAME_ENCODER_MAX_HEADER_SIZE, payload, sizeof(payload));
+
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .CopyOutArgumentBuffer(1, mask_key, sizeof(mask_key));
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, sizeof(payload), true, true, 0, &frame_offset);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, UWS_FRAME_ENCODER_MAX_HEADER_SIZE - 6, frame_offset);
+    stringify_bytes(expected_bytes, sizeof(expected_bytes), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(buffer + frame_offset, sizeof(buffer) - frame_offset, actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_059: [ `uws_frame_encoder_encode_in_place` shall write the frame header in the `headroom` bytes immediately before the `length` payload bytes that start at `buffer + headroom`, encoded the same way `uws_frame_encoder_encode` encodes it. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_062: [ On success `uws_frame_encoder_encode_in_place` shall set `frame_offset` to the offset in `buffer` where the encoded frame starts and return 0. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_in_place_encodes_an_unmasked_126_byte_binary_frame)
+{
+    // arrange
+    int result;
+    size_t frame_offset;
+    unsigned char buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 126];
+    size_t i;
+
+    for (i = 0; i < 126; i++)
+    {
+        buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + i] = (unsigned char)i;
+    }
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 126, false, true, 0, &frame_offset);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, UWS_FRAME_ENCODER_MAX_HEADER_SIZE - 4, frame_offset);
+    ASSERT_ARE_EQUAL(int, 0x82, (int)buffer[frame_offset]);
+    ASSERT_ARE_EQUAL(int, 0x7E, (int)buffer[frame_offset + 1]);
+    ASSERT_ARE_EQUAL(int, 0x00, (int)buffer[frame_offset + 2]);
+    ASSERT_ARE_EQUAL(int, 0x7E, (int)buffer[frame_offset + 3]);
+    for (i = 0; i < 126; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)i, (int)buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + i]);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_01_060: [ If `gb_rand_bytes` fails then `uws_frame_encoder_encode_in_place` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_gb_rand_bytes_fails_uws_frame_encoder_encode_in_place_fails)
+{
+    // arrange
+    int result;
+    size_t frame_offset;
+    unsigned char buffer[UWS_FRAME_ENCODER_MAX_HEADER_SIZE + 1];
+
+    STRICT_EXPECTED_CALL(gb_rand_bytes(IGNORED_PTR_ARG, 4))
+        .SetReturn(1);
+
+    // act
+    result = uws_frame_encoder_encode_in_place(WS_BINARY_FRAME, buffer, UWS_FRAME_ENCODER_MAX_HEADER_SIZE, 1, true, true, 0, &frame_offset);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(uws_frame_encoder_ut)
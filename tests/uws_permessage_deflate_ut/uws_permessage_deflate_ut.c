@@ -0,0 +1,655 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+#ifdef _CRTDBG_MAP_ALLOC
+#include <crtdbg.h>
+#endif
+
+#ifdef __cplusplus
+#include <cstddef>
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/uws_permessage_deflate.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* "Hello" compressed as in RFC 7692 section 7.2.3.1 and 7.2.3.2 */
+static const unsigned char hello_compressed[] = { 0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00 };
+static const unsigned char hello_compressed_again[] = { 0xf2, 0x00, 0x11, 0x00, 0x00 };
+
+static const char test_upgrade_response_format[] = "HTTP/1.1 101 Switching Protocols\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "%s"
+    "\r\n";
+
+static WS_PERMESSAGE_DEFLATE_CONFIG default_config(void)
+{
+    WS_PERMESSAGE_DEFLATE_CONFIG config;
+    config.client_no_context_takeover = false;
+    config.server_no_context_takeover = false;
+    config.client_max_window_bits = 15;
+    config.server_max_window_bits = 15;
+    config.compression_level = -1;
+    return config;
+}
+
+static int negotiate(const WS_PERMESSAGE_DEFLATE_CONFIG* offer, const char* extensions_header, WS_PERMESSAGE_DEFLATE_CONFIG* negotiated, bool* is_accepted)
+{
+    char upgrade_response[512];
+    (void)sprintf(upgrade_response, test_upgrade_response_format, extensions_header);
+    return uws_permessage_deflate_negotiate(offer, upgrade_response, negotiated, is_accepted);
+}
+
+BEGIN_TEST_SUITE(uws_permessage_deflate_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* uws_permessage_deflate_create_offer */
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_001: [ If `config` is NULL, `uws_permessage_deflate_create_offer` shall fail and return NULL. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_offer_with_NULL_config_fails)
+{
+    // arrange
+    char* result;
+
+    // act
+    result = uws_permessage_deflate_create_offer(NULL);
+
+    // assert
+    ASSERT_IS_NULL(result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_002: [ If `client_max_window_bits` is not within 9..15, `server_max_window_bits` is not within 8..15 or `compression_level` is not within -1..9, `uws_permessage_deflate_create_offer` shall fail and return NULL. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_offer_with_8_client_window_bits_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    char* result;
+    config.client_max_window_bits = 8;
+
+    // act
+    result = uws_permessage_deflate_create_offer(&config);
+
+    // assert
+    ASSERT_IS_NULL(result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_002: [ If `client_max_window_bits` is not within 9..15, `server_max_window_bits` is not within 8..15 or `compression_level` is not within -1..9, `uws_permessage_deflate_create_offer` shall fail and return NULL. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_offer_with_compression_level_10_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    char* result;
+    config.compression_level = 10;
+
+    // act
+    result = uws_permessage_deflate_create_offer(&config);
+
+    // assert
+    ASSERT_IS_NULL(result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_004: [ `uws_permessage_deflate_create_offer` shall return a newly allocated `Sec-WebSocket-Extensions` header value offering `permessage-deflate` with the `client_max_window_bits` parameter, whose value is only given when it is below 15. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_offer_with_default_config_succeeds)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    char* result;
+
+    // act
+    result = uws_permessage_deflate_create_offer(&config);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, "permessage-deflate; client_max_window_bits", result);
+
+    // cleanup
+    free(result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_004: [ `uws_permessage_deflate_create_offer` shall return a newly allocated `Sec-WebSocket-Extensions` header value offering `permessage-deflate` with the `client_max_window_bits` parameter, whose value is only given when it is below 15. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_005: [ The `server_max_window_bits` parameter shall be added when `server_max_window_bits` is below 15. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_006: [ The `client_no_context_takeover` and `server_no_context_takeover` parameters shall be added when the corresponding config members are true. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_offer_with_all_parameters_succeeds)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    char* result;
+    config.client_max_window_bits = 10;
+    config.server_max_window_bits = 12;
+    config.client_no_context_takeover = true;
+    config.server_no_context_takeover = true;
+
+    // act
+    result = uws_permessage_deflate_create_offer(&config);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, "permessage-deflate; client_max_window_bits=10; server_max_window_bits=12; client_no_context_takeover; server_no_context_takeover", result);
+
+    // cleanup
+    free(result);
+}
+
+/* uws_permessage_deflate_negotiate */
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_007: [ If any argument is NULL, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_NULL_upgrade_response_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted;
+    int result;
+
+    // act
+    result = uws_permessage_deflate_negotiate(&offer, NULL, &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_017: [ If the response does not accept `permessage-deflate`, `is_accepted` shall be set to false and `uws_permessage_deflate_negotiate` shall return 0. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_without_extensions_header_is_not_accepted)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted = true;
+    int result;
+
+    // act
+    result = negotiate(&offer, "", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_FALSE(is_accepted);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_009: [ When the response accepts `permessage-deflate`, `is_accepted` shall be set to true and `negotiated` shall start from the offer, with a `server_max_window_bits` of 15 and `server_no_context_takeover` false, and be adjusted by the parameters of the response. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_010: [ A `server_no_context_takeover` parameter shall make the inflater be reset after every message. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_013: [ A `client_max_window_bits` parameter with a value from 9 to 15 shall limit the window of the deflater to the smaller of that value and the offered one. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_016: [ `uws_permessage_deflate_negotiate` shall look at every `Sec-WebSocket-Extensions` header of `upgrade_response`, matching the header name case insensitively. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_parameters_succeeds)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted = false;
+    int result;
+
+    // act
+    result = negotiate(&offer, "sec-websocket-extensions: permessage-deflate; server_no_context_takeover; client_max_window_bits=\"10\"\r\n", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(is_accepted);
+    ASSERT_IS_TRUE(negotiated.server_no_context_takeover);
+    ASSERT_IS_FALSE(negotiated.client_no_context_takeover);
+    ASSERT_ARE_EQUAL(int, 10, negotiated.client_max_window_bits);
+    ASSERT_ARE_EQUAL(int, 15, negotiated.server_max_window_bits);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_008: [ If the response accepts any extension other than `permessage-deflate`, or accepts `permessage-deflate` more than once, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_unknown_extension_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted;
+    int result;
+
+    // act
+    result = negotiate(&offer, "Sec-WebSocket-Extensions: x-webkit-deflate-frame\r\n", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_008: [ If the response accepts any extension other than `permessage-deflate`, or accepts `permessage-deflate` more than once, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_permessage_deflate_accepted_twice_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted;
+    int result;
+
+    // act
+    result = negotiate(&offer, "Sec-WebSocket-Extensions: permessage-deflate\r\nSec-WebSocket-Extensions: permessage-deflate\r\n", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_012: [ A `server_max_window_bits` parameter with a value from 8 to the offered value shall set the window of the inflater. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_014: [ If a parameter is unknown, repeated, has a missing, unexpected or out of range value, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_server_window_bits_above_the_offer_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted;
+    int result;
+    offer.server_max_window_bits = 10;
+
+    // act
+    result = negotiate(&offer, "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=11\r\n", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_014: [ If a parameter is unknown, repeated, has a missing, unexpected or out of range value, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_8_client_window_bits_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted;
+    int result;
+
+    // act
+    result = negotiate(&offer, "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits=8\r\n", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_014: [ If a parameter is unknown, repeated, has a missing, unexpected or out of range value, `uws_permessage_deflate_negotiate` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_negotiate_with_repeated_parameter_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG offer = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG negotiated;
+    bool is_accepted;
+    int result;
+
+    // act
+    result = negotiate(&offer, "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; server_no_context_takeover\r\n", &negotiated, &is_accepted);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* uws_permessage_deflate_create */
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_030: [ If `negotiated` is NULL or holds values out of the ranges accepted by `uws_permessage_deflate_create_offer`, `uws_permessage_deflate_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_with_NULL_config_fails)
+{
+    // arrange
+    UWS_PERMESSAGE_DEFLATE_HANDLE result;
+
+    // act
+    result = uws_permessage_deflate_create(NULL);
+
+    // assert
+    ASSERT_IS_NULL(result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_033: [ `uws_permessage_deflate_create` shall create a raw inflate stream with the negotiated `server_max_window_bits`, but never below 9, by calling `inflateInit2`. ]*/
+TEST_FUNCTION(uws_permessage_deflate_create_with_8_server_window_bits_inflates_back_references_of_a_9_bit_window)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG server_config = default_config();
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE server_permessage_deflate = uws_permessage_deflate_create(&server_config);
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate;
+    unsigned char message[800];
+    unsigned char* compressed;
+    size_t compressed_length;
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    unsigned int seed = 42;
+    size_t i;
+    int result;
+
+    /* 400 random bytes repeated, the repetition is a back-reference 400 bytes away, which fits a 9 bit window but not an 8 bit one */
+    for (i = 0; i < sizeof(message) / 2; i++)
+    {
+        seed = (seed * 1103515245) + 12345;
+        message[i] = (unsigned char)(seed >> 16);
+        message[i + (sizeof(message) / 2)] = message[i];
+    }
+    (void)uws_permessage_deflate_compress(server_permessage_deflate, message, sizeof(message), 0, &compressed, &compressed_length);
+    config.server_max_window_bits = 8;
+    permessage_deflate = uws_permessage_deflate_create(&config);
+
+    // act
+    result = uws_permessage_deflate_decompress(permessage_deflate, compressed, compressed_length, true, 0, &decompressed, &decompressed_length);
+
+    // assert
+    ASSERT_IS_TRUE(compressed_length < sizeof(message));
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(message), decompressed_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(decompressed, message, sizeof(message)));
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+    uws_permessage_deflate_destroy(server_permessage_deflate);
+}
+
+/* uws_permessage_deflate_compress */
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_018: [ If `permessage_deflate`, `compressed` or `compressed_length` is NULL, or `payload` is NULL while `length` is not 0, `uws_permessage_deflate_compress` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_compress_with_NULL_payload_and_non_zero_length_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    unsigned char* compressed;
+    size_t compressed_length;
+    int result;
+
+    // act
+    result = uws_permessage_deflate_compress(permessage_deflate, NULL, 1, 0, &compressed, &compressed_length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_019: [ `uws_permessage_deflate_compress` shall compress `payload` with `deflate` and `Z_SYNC_FLUSH` into a buffer owned by the instance that is reused by the following calls, leaving `headroom` bytes in front of the compressed bytes. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_020: [ Before being sent, the 4 octets 0x00 0x00 0xff 0xff that end the compressed data of every message shall be removed. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_023: [ On success `uws_permessage_deflate_compress` shall set `compressed` and `compressed_length` to the compressed bytes, update the compression statistics and return 0. ]*/
+TEST_FUNCTION(uws_permessage_deflate_compress_produces_the_RFC_7692_example_bytes)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    unsigned char* compressed;
+    size_t compressed_length;
+    int result;
+
+    // act
+    result = uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 14, &compressed, &compressed_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(hello_compressed), compressed_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(compressed, hello_compressed, sizeof(hello_compressed)));
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_019: [ `uws_permessage_deflate_compress` shall compress `payload` with `deflate` and `Z_SYNC_FLUSH` into a buffer owned by the instance that is reused by the following calls, leaving `headroom` bytes in front of the compressed bytes. ]*/
+TEST_FUNCTION(uws_permessage_deflate_compress_with_context_takeover_refers_to_the_previous_message)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    unsigned char* compressed;
+    size_t compressed_length;
+    int result;
+    (void)uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+
+    // act
+    result = uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(hello_compressed_again), compressed_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(compressed, hello_compressed_again, sizeof(hello_compressed_again)));
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_021: [ If `client_no_context_takeover` was negotiated, the deflater shall be reset after each message. ]*/
+TEST_FUNCTION(uws_permessage_deflate_compress_with_client_no_context_takeover_compresses_each_message_alone)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate;
+    unsigned char* compressed;
+    size_t compressed_length;
+    int result;
+    config.client_no_context_takeover = true;
+    permessage_deflate = uws_permessage_deflate_create(&config);
+    (void)uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+
+    // act
+    result = uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(hello_compressed), compressed_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(compressed, hello_compressed, sizeof(hello_compressed)));
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_040: [ If nothing is left after removing the tail, a single 0x00 octet shall be sent so that the message is an empty stored block. ]*/
+TEST_FUNCTION(uws_permessage_deflate_compress_an_empty_message_yields_one_zero_byte)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    unsigned char* compressed;
+    size_t compressed_length;
+    int result;
+    (void)uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+
+    // act
+    result = uws_permessage_deflate_compress(permessage_deflate, NULL, 0, 0, &compressed, &compressed_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, compressed_length);
+    ASSERT_ARE_EQUAL(int, 0, compressed[0]);
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* uws_permessage_deflate_decompress */
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_024: [ If `permessage_deflate`, `decompressed` or `decompressed_length` is NULL, or `payload` is NULL while `length` is not 0, `uws_permessage_deflate_decompress` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_decompress_with_NULL_handle_fails)
+{
+    // arrange
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    int result;
+
+    // act
+    result = uws_permessage_deflate_decompress(NULL, hello_compressed, sizeof(hello_compressed), true, 0, &decompressed, &decompressed_length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_025: [ After the last bytes of a message, the 4 octets 0x00 0x00 0xff 0xff shall be appended to the inflater input. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_026: [ `uws_permessage_deflate_decompress` shall inflate `payload` into a buffer owned by the instance that is reused by the following calls, `payload` being the whole message or the next part of it. ]*/
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_037: [ On success `uws_permessage_deflate_decompress` shall set `decompressed` and `decompressed_length` to the inflated bytes, update the decompression statistics and return 0. ]*/
+TEST_FUNCTION(uws_permessage_deflate_decompress_the_RFC_7692_examples_succeeds)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    int result;
+    (void)uws_permessage_deflate_decompress(permessage_deflate, hello_compressed, sizeof(hello_compressed), true, 0, &decompressed, &decompressed_length);
+
+    // act
+    result = uws_permessage_deflate_decompress(permessage_deflate, hello_compressed_again, sizeof(hello_compressed_again), true, 0, &decompressed, &decompressed_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 5, decompressed_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(decompressed, "Hello", 5));
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_026: [ `uws_permessage_deflate_decompress` shall inflate `payload` into a buffer owned by the instance that is reused by the following calls, `payload` being the whole message or the next part of it. ]*/
+TEST_FUNCTION(uws_permessage_deflate_decompress_a_message_in_parts_succeeds)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    char message[8];
+    size_t message_length = 0;
+    size_t i;
+    int result = 0;
+
+    // act
+    for (i = 0; i < sizeof(hello_compressed); i++)
+    {
+        result |= uws_permessage_deflate_decompress(permessage_deflate, hello_compressed + i, 1, i == sizeof(hello_compressed) - 1, 0, &decompressed, &decompressed_length);
+        (void)memcpy(message + message_length, decompressed, decompressed_length);
+        message_length += decompressed_length;
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 5, message_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(message, "Hello", 5));
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_027: [ If `max_length` is not 0, inflating shall stop once more than `max_length` bytes were produced, so that a `decompressed_length` greater than `max_length` tells that the message is too big. ]*/
+TEST_FUNCTION(uws_permessage_deflate_decompress_stops_past_max_length)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    int result;
+
+    // act
+    result = uws_permessage_deflate_decompress(permessage_deflate, hello_compressed, sizeof(hello_compressed), true, 3, &decompressed, &decompressed_length);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(decompressed_length > 3);
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_029: [ If inflating fails, `uws_permessage_deflate_decompress` shall reset the inflater, fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_decompress_invalid_data_fails_and_resets_the_inflater)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    static const unsigned char invalid_data[] = { 0xff, 0xff };
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    int result;
+
+    // act
+    result = uws_permessage_deflate_decompress(permessage_deflate, invalid_data, sizeof(invalid_data), true, 0, &decompressed, &decompressed_length);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, uws_permessage_deflate_decompress(permessage_deflate, hello_compressed, sizeof(hello_compressed), true, 0, &decompressed, &decompressed_length));
+    ASSERT_ARE_EQUAL(size_t, 5, decompressed_length);
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* uws_permessage_deflate_get_statistics */
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_038: [ If `permessage_deflate` or `statistics` is NULL, `uws_permessage_deflate_get_statistics` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_permessage_deflate_get_statistics_with_NULL_statistics_fails)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    int result;
+
+    // act
+    result = uws_permessage_deflate_get_statistics(permessage_deflate, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+/* Tests_SRS_UWS_PERMESSAGE_DEFLATE_01_039: [ Otherwise `uws_permessage_deflate_get_statistics` shall copy the counters of the instance to `statistics` and return 0. ]*/
+TEST_FUNCTION(uws_permessage_deflate_get_statistics_counts_messages_and_bytes)
+{
+    // arrange
+    WS_PERMESSAGE_DEFLATE_CONFIG config = default_config();
+    UWS_PERMESSAGE_DEFLATE_HANDLE permessage_deflate = uws_permessage_deflate_create(&config);
+    WS_PERMESSAGE_DEFLATE_STATISTICS statistics;
+    unsigned char* compressed;
+    size_t compressed_length;
+    const unsigned char* decompressed;
+    size_t decompressed_length;
+    int result;
+    (void)uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+    (void)uws_permessage_deflate_compress(permessage_deflate, (const unsigned char*)"Hello", 5, 0, &compressed, &compressed_length);
+    (void)uws_permessage_deflate_decompress(permessage_deflate, hello_compressed, sizeof(hello_compressed), true, 0, &decompressed, &decompressed_length);
+
+    // act
+    result = uws_permessage_deflate_get_statistics(permessage_deflate, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(uint64_t, 2, statistics.messages_compressed);
+    ASSERT_ARE_EQUAL(uint64_t, 10, statistics.bytes_before_compression);
+    ASSERT_ARE_EQUAL(uint64_t, sizeof(hello_compressed) + sizeof(hello_compressed_again), statistics.bytes_after_compression);
+    ASSERT_ARE_EQUAL(uint64_t, 1, statistics.messages_decompressed);
+    ASSERT_ARE_EQUAL(uint64_t, sizeof(hello_compressed), statistics.bytes_before_decompression);
+    ASSERT_ARE_EQUAL(uint64_t, 5, statistics.bytes_after_decompression);
+
+    // cleanup
+    uws_permessage_deflate_destroy(permessage_deflate);
+}
+
+END_TEST_SUITE(uws_permessage_deflate_ut)
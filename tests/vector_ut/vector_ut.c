@@ -776,7 +776,7 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         VECTOR_destroy(handle);
     }
 
-    /* Tests_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and reduce its internal storage.] */
+    /* Tests_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and keep its internal storage.] */
     TEST_FUNCTION(VECTOR_erase_succeeds_case_1)
     {
         ///arrange
@@ -789,8 +789,6 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         (void)VECTOR_push_back(handle, &sItem2, 1);
         pfindItem = (VECTOR_UNITTEST*)VECTOR_find_if(handle, VECTOR_UNITTEST_isEqual, &sItem1);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, sizeof(VECTOR_UNITTEST)))
-            .IgnoreArgument_ptr();
 
         ///act
         VECTOR_erase(handle, pfindItem, 1);
@@ -806,7 +804,7 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         VECTOR_destroy(handle);
     }
 
-    /* Tests_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and reduce its internal storage.] */
+    /* Tests_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and keep its internal storage.] */
     TEST_FUNCTION(VECTOR_erase_succeeds_case_2)
     {
         ///arrange
@@ -819,8 +817,6 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         (void)VECTOR_push_back(handle, &sItem2, 1);
         pfindItem = (VECTOR_UNITTEST*)VECTOR_find_if(handle, VECTOR_UNITTEST_isEqual, &sItem1);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
 
         ///act
         VECTOR_erase(handle, pfindItem, 2);
@@ -836,7 +832,7 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         VECTOR_destroy(handle);
     }
 
-    /* Tests_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and reduce its internal storage.] */
+    /* Tests_SRS_VECTOR_10_014: [VECTOR_erase shall remove the `numElements` starting at `elements` and keep its internal storage.] */
     TEST_FUNCTION(VECTOR_erase_succeeds_case_3)
     {
         ///arrange
@@ -849,10 +845,6 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         (void)VECTOR_push_back(handle, &sItem2, 1);
         pfindItem = (VECTOR_UNITTEST*)VECTOR_find_if(handle, VECTOR_UNITTEST_isEqual, &sItem1);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
-            .IgnoreArgument_ptr()
-            .IgnoreArgument_size()
-            .SetReturn(NULL);
 
         ///act
         VECTOR_erase(handle, pfindItem, 1);
@@ -860,6 +852,7 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         ///assert
         num = VECTOR_size(handle);
         ASSERT_ARE_EQUAL(size_t, 1, num);
+        ASSERT_ARE_EQUAL(size_t, 2, VECTOR_capacity(handle));
         pfindItem = (VECTOR_UNITTEST*)VECTOR_find_if(handle, VECTOR_UNITTEST_isEqual, &sItem1);
         ASSERT_IS_NULL(pfindItem);
         pfindItem = (VECTOR_UNITTEST*)VECTOR_find_if(handle, VECTOR_UNITTEST_isEqual, &sItem2);
@@ -998,6 +991,7 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         VECTOR_destroy(handle);
     }
 
+    /* Tests_SRS_VECTOR_11_001: [ When the capacity is exceeded, the storage shall grow to the larger of twice the capacity and the needed number of elements. ] */
     TEST_FUNCTION(VECTOR_push_back_multiple_elements_succeeds)
     {
         ///arrange
@@ -1009,8 +1003,12 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         umock_c_reset_all_calls();
         for (nIndex = 0; nIndex < NUM_ITEM_PUSH_BACK; nIndex++)
         {
-            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, (nIndex + 1) * sizeof(VECTOR_UNITTEST)))
-                .IgnoreArgument_ptr();
+            /*storage only grows when it is full: capacities go 1, 2, 4, 8...*/
+            if ((nIndex & (nIndex - 1)) == 0)
+            {
+                STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, ((nIndex == 0) ? 1 : (2 * nIndex)) * sizeof(VECTOR_UNITTEST)))
+                    .IgnoreArgument_ptr();
+            }
         }
 
         ///act
@@ -1033,6 +1031,367 @@ BEGIN_TEST_SUITE(Vector_UnitTests)
         VECTOR_destroy(handle);
     }
 
+    /* Tests_SRS_VECTOR_11_002: [ VECTOR_emplace_back shall fail and return NULL if `handle` is NULL or `numElements` is 0. ] */
+    TEST_FUNCTION(VECTOR_emplace_back_fails_if_handle_is_NULL)
+    {
+        ///arrange
+        void* result;
+
+        ///act
+        result = VECTOR_emplace_back(NULL, 1);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_VECTOR_11_002: [ VECTOR_emplace_back shall fail and return NULL if `handle` is NULL or `numElements` is 0. ] */
+    TEST_FUNCTION(VECTOR_emplace_back_fails_if_numElements_is_zero)
+    {
+        ///arrange
+        void* result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        umock_c_reset_all_calls();
+
+        ///act
+        result = VECTOR_emplace_back(handle, 0);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(size_t, 0, VECTOR_size(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_003: [ VECTOR_emplace_back shall fail and return NULL if memory allocation fails. ] */
+    TEST_FUNCTION(VECTOR_emplace_back_fails_if_realloc_fails)
+    {
+        ///arrange
+        void* result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, sizeof(VECTOR_UNITTEST)))
+            .SetReturn(NULL);
+
+        ///act
+        result = VECTOR_emplace_back(handle, 1);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(size_t, 0, VECTOR_size(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_004: [ VECTOR_emplace_back shall append `numElements` uninitialized elements and return a pointer to the first of them. ] */
+    TEST_FUNCTION(VECTOR_emplace_back_succeeds_without_allocating_when_capacity_suffices)
+    {
+        ///arrange
+        VECTOR_UNITTEST* result;
+        VECTOR_UNITTEST sItem = {1, 2};
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_reserve(handle, 2);
+        (void)VECTOR_push_back(handle, &sItem, 1);
+        umock_c_reset_all_calls();
+
+        ///act
+        result = (VECTOR_UNITTEST*)VECTOR_emplace_back(handle, 1);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(void_ptr, VECTOR_element(handle, 1), result);
+        ASSERT_ARE_EQUAL(size_t, 2, VECTOR_size(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_005: [ VECTOR_capacity shall return 0 if the given handle is NULL. ] */
+    TEST_FUNCTION(VECTOR_capacity_returns_0_if_handle_is_NULL)
+    {
+        ///arrange
+        size_t result;
+
+        ///act
+        result = VECTOR_capacity(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(size_t, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_VECTOR_11_007: [ VECTOR_reserve shall fail and return non-zero if `handle` is NULL. ] */
+    TEST_FUNCTION(VECTOR_reserve_fails_if_handle_is_NULL)
+    {
+        ///arrange
+        int result;
+
+        ///act
+        result = VECTOR_reserve(NULL, 4);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_VECTOR_11_006: [ VECTOR_capacity shall return the number of elements that fit in the internal storage. ] */
+    /* Tests_SRS_VECTOR_11_009: [ Otherwise VECTOR_reserve shall reallocate the storage to hold exactly `numElements` elements and return 0. ] */
+    TEST_FUNCTION(VECTOR_reserve_succeeds)
+    {
+        ///arrange
+        int result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 10 * sizeof(VECTOR_UNITTEST)));
+
+        ///act
+        result = VECTOR_reserve(handle, 10);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 10, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(size_t, 0, VECTOR_size(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_008: [ If `numElements` is not greater than the capacity, VECTOR_reserve shall return 0 without changing the storage. ] */
+    TEST_FUNCTION(VECTOR_reserve_smaller_than_capacity_does_not_allocate)
+    {
+        ///arrange
+        int result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_reserve(handle, 10);
+        umock_c_reset_all_calls();
+
+        ///act
+        result = VECTOR_reserve(handle, 5);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 10, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_010: [ VECTOR_reserve shall fail and return non-zero if memory allocation fails. ] */
+    TEST_FUNCTION(VECTOR_reserve_fails_if_realloc_fails)
+    {
+        ///arrange
+        int result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 10 * sizeof(VECTOR_UNITTEST)))
+            .SetReturn(NULL);
+
+        ///act
+        result = VECTOR_reserve(handle, 10);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 0, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_011: [ VECTOR_shrink_to_fit shall fail and return non-zero if `handle` is NULL. ] */
+    TEST_FUNCTION(VECTOR_shrink_to_fit_fails_if_handle_is_NULL)
+    {
+        ///arrange
+        int result;
+
+        ///act
+        result = VECTOR_shrink_to_fit(NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_VECTOR_11_012: [ If the vector is empty, VECTOR_shrink_to_fit shall release the internal storage. ] */
+    TEST_FUNCTION(VECTOR_shrink_to_fit_releases_storage_of_empty_vector)
+    {
+        ///arrange
+        int result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_reserve(handle, 10);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        result = VECTOR_shrink_to_fit(handle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 0, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_013: [ Otherwise VECTOR_shrink_to_fit shall reallocate the storage to hold exactly the stored elements and return 0. ] */
+    TEST_FUNCTION(VECTOR_shrink_to_fit_succeeds)
+    {
+        ///arrange
+        int result;
+        VECTOR_UNITTEST sItem = {1, 2};
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_reserve(handle, 10);
+        (void)VECTOR_push_back(handle, &sItem, 1);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, sizeof(VECTOR_UNITTEST)))
+            .IgnoreArgument_ptr();
+
+        ///act
+        result = VECTOR_shrink_to_fit(handle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 1, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(int, sItem.nValue1, ((VECTOR_UNITTEST*)VECTOR_front(handle))->nValue1);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_014: [ If memory allocation fails, VECTOR_shrink_to_fit shall keep the original storage and return non-zero. ] */
+    TEST_FUNCTION(VECTOR_shrink_to_fit_keeps_storage_if_realloc_fails)
+    {
+        ///arrange
+        int result;
+        VECTOR_UNITTEST sItem = {1, 2};
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_reserve(handle, 10);
+        (void)VECTOR_push_back(handle, &sItem, 1);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, sizeof(VECTOR_UNITTEST)))
+            .IgnoreArgument_ptr()
+            .SetReturn(NULL);
+
+        ///act
+        result = VECTOR_shrink_to_fit(handle);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 10, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(int, sItem.nValue1, ((VECTOR_UNITTEST*)VECTOR_front(handle))->nValue1);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_015: [ VECTOR_resize shall fail and return non-zero if `handle` is NULL. ] */
+    TEST_FUNCTION(VECTOR_resize_fails_if_handle_is_NULL)
+    {
+        ///arrange
+        int result;
+
+        ///act
+        result = VECTOR_resize(NULL, 1);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_VECTOR_11_016: [ If `numElements` is not greater than the size, VECTOR_resize shall drop the elements past `numElements` and keep the internal storage. ] */
+    TEST_FUNCTION(VECTOR_resize_shrinks_without_allocating)
+    {
+        ///arrange
+        int result;
+        VECTOR_UNITTEST sItems[3] = { {1, 2}, {3, 4}, {5, 6} };
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_push_back(handle, sItems, 3);
+        umock_c_reset_all_calls();
+
+        ///act
+        result = VECTOR_resize(handle, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 1, VECTOR_size(handle));
+        ASSERT_ARE_EQUAL(size_t, 3, VECTOR_capacity(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_018: [ Otherwise VECTOR_resize shall append zero filled elements up to `numElements` and return 0. ] */
+    TEST_FUNCTION(VECTOR_resize_grows_with_zero_filled_elements)
+    {
+        ///arrange
+        int result;
+        VECTOR_UNITTEST* pResult;
+        VECTOR_UNITTEST sItem = {1, 2};
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        (void)VECTOR_push_back(handle, &sItem, 1);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 3 * sizeof(VECTOR_UNITTEST)))
+            .IgnoreArgument_ptr();
+
+        ///act
+        result = VECTOR_resize(handle, 3);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 3, VECTOR_size(handle));
+        pResult = (VECTOR_UNITTEST*)VECTOR_element(handle, 0);
+        ASSERT_ARE_EQUAL(int, 1, pResult->nValue1);
+        pResult = (VECTOR_UNITTEST*)VECTOR_element(handle, 2);
+        ASSERT_ARE_EQUAL(int, 0, pResult->nValue1);
+        ASSERT_ARE_EQUAL(long, 0, pResult->lValue2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
+    /* Tests_SRS_VECTOR_11_017: [ VECTOR_resize shall fail and return non-zero if memory allocation fails. ] */
+    TEST_FUNCTION(VECTOR_resize_fails_if_realloc_fails)
+    {
+        ///arrange
+        int result;
+        VECTOR_HANDLE handle = VECTOR_create(sizeof(VECTOR_UNITTEST));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, 2 * sizeof(VECTOR_UNITTEST)))
+            .SetReturn(NULL);
+
+        ///act
+        result = VECTOR_resize(handle, 2);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 0, VECTOR_size(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        VECTOR_destroy(handle);
+    }
+
     /* Vector_Tests END */
 
 END_TEST_SUITE(Vector_UnitTests)
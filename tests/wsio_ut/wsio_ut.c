@@ -174,6 +174,7 @@ static OPTIONHANDLER_HANDLE my_OptionHandler_Create(pfCloneOption cloneOption, p
 #undef ENABLE_MOCKS
 
 #include "azure_c_shared_utility/wsio.h"
+#include "azure_c_shared_utility/shared_util_options.h"
 
 // consumer mocks
 MOCK_FUNCTION_WITH_CODE(, void, test_on_io_open_complete, void*, context, IO_OPEN_RESULT, io_open_result);
@@ -186,6 +187,8 @@ MOCK_FUNCTION_WITH_CODE(, void, test_on_io_close_complete, void*, context);
 MOCK_FUNCTION_END()
 MOCK_FUNCTION_WITH_CODE(, void, test_on_send_complete, void*, context, IO_SEND_RESULT, send_result)
 MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_low_water, void*, context)
+MOCK_FUNCTION_END()
 
 static ON_WS_OPEN_COMPLETE g_on_ws_open_complete;
 static void* g_on_ws_open_complete_context;
@@ -1257,6 +1260,68 @@ TEST_FUNCTION(wsio_send_with_NULL_send_complete_callback_succeeds)
     wsio_get_interface_description()->concrete_io_destroy(wsio);
 }
 
+/* Tests_SRS_WSIO_11_001: [ If the option name is `xio_send_queue_limits`, `wsio_setoption` shall keep a copy of the `XIO_SEND_QUEUE_LIMITS` pointed to by `value` and not pass it to uws. ]*/
+/* Tests_SRS_WSIO_11_002: [ If `high_water_mark` is not 0 and at least `high_water_mark` bytes are outstanding, `wsio_send` shall return `XIO_SEND_WOULD_BLOCK` without queueing anything. ]*/
+TEST_FUNCTION(wsio_send_at_the_high_water_mark_returns_XIO_SEND_WOULD_BLOCK)
+{
+    // arrange
+    CONCRETE_IO_HANDLE wsio;
+    unsigned char test_buffer[] = { 42, 43 };
+    XIO_SEND_QUEUE_LIMITS limits = { 2, 0, test_on_low_water, (void*)0x4545 };
+    int setoption_result;
+    int result;
+
+    wsio = wsio_get_interface_description()->concrete_io_create(&default_wsio_config);
+    (void)wsio_get_interface_description()->concrete_io_open(wsio, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    g_on_ws_open_complete(g_on_ws_open_complete_context, WS_OPEN_OK);
+    setoption_result = wsio_get_interface_description()->concrete_io_setoption(wsio, OPTION_XIO_SEND_QUEUE_LIMITS, &limits);
+    (void)wsio_get_interface_description()->concrete_io_send(wsio, test_buffer, sizeof(test_buffer), test_on_send_complete, (void*)0x4343);
+    umock_c_reset_all_calls();
+
+    // act
+    result = wsio_get_interface_description()->concrete_io_send(wsio, test_buffer, sizeof(test_buffer), test_on_send_complete, (void*)0x4343);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, setoption_result);
+    ASSERT_ARE_EQUAL(int, XIO_SEND_WOULD_BLOCK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    wsio_get_interface_description()->concrete_io_destroy(wsio);
+}
+
+/* Tests_SRS_WSIO_11_003: [ If a send was refused since the last time `on_low_water` was called and the outstanding bytes are now at or below `low_water_mark`, `on_low_water` shall be called. ]*/
+TEST_FUNCTION(wsio_send_completion_after_a_refused_send_indicates_low_water)
+{
+    // arrange
+    CONCRETE_IO_HANDLE wsio;
+    unsigned char test_buffer[] = { 42, 43 };
+    XIO_SEND_QUEUE_LIMITS limits = { 2, 0, test_on_low_water, (void*)0x4545 };
+
+    wsio = wsio_get_interface_description()->concrete_io_create(&default_wsio_config);
+    (void)wsio_get_interface_description()->concrete_io_open(wsio, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    g_on_ws_open_complete(g_on_ws_open_complete_context, WS_OPEN_OK);
+    (void)wsio_get_interface_description()->concrete_io_setoption(wsio, OPTION_XIO_SEND_QUEUE_LIMITS, &limits);
+    (void)wsio_get_interface_description()->concrete_io_send(wsio, test_buffer, sizeof(test_buffer), test_on_send_complete, (void*)0x4343);
+    (void)wsio_get_interface_description()->concrete_io_send(wsio, test_buffer, sizeof(test_buffer), test_on_send_complete, (void*)0x4343);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_SINGLYLINKEDSINGLYLINKEDLIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x4343, IO_SEND_OK));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_low_water((void*)0x4545));
+
+    // act
+    g_on_ws_send_frame_complete(g_on_ws_send_frame_complete_context, WS_SEND_FRAME_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    wsio_get_interface_description()->concrete_io_destroy(wsio);
+}
+
 /* wsio_dowork */
 
 /* Tests_SRS_WSIO_01_106: [ `wsio_dowork` shall call `uws_client_dowork` with the uws handle created in `wsio_create`. ]*/
@@ -2044,6 +2109,92 @@ TEST_FUNCTION(when_uws_set_option_fails_wsio_setoption_fails)
     wsio_get_interface_description()->concrete_io_destroy(wsio);
 }
 
+/* wsio_getoption */
+
+/* Tests_SRS_WSIO_11_004: [ If any of the arguments `ws_io`, `option_name` or `value` is NULL `wsio_getoption` shall return a non-zero value. ]*/
+TEST_FUNCTION(wsio_getoption_with_NULL_arguments_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE wsio;
+    size_t value;
+    int result_1;
+    int result_2;
+    int result_3;
+
+    wsio = wsio_get_interface_description()->concrete_io_create(&default_wsio_config);
+    umock_c_reset_all_calls();
+
+    // act
+    result_1 = wsio_get_interface_description()->concrete_io_getoption(NULL, OPTION_XIO_OUTSTANDING_BYTES, &value);
+    result_2 = wsio_get_interface_description()->concrete_io_getoption(wsio, NULL, &value);
+    result_3 = wsio_get_interface_description()->concrete_io_getoption(wsio, OPTION_XIO_OUTSTANDING_BYTES, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    wsio_get_interface_description()->concrete_io_destroy(wsio);
+}
+
+/* Tests_SRS_WSIO_11_005: [ For `xio_outstanding_bytes` `wsio_getoption` shall store in the size_t pointed to by `value` the payload bytes of the sends that have not completed yet and return 0. ]*/
+/* Tests_SRS_WSIO_11_006: [ For `xio_outstanding_items` `wsio_getoption` shall store in the size_t pointed to by `value` the number of sends that have not completed yet and return 0. ]*/
+TEST_FUNCTION(wsio_getoption_returns_the_outstanding_bytes_and_items)
+{
+    // arrange
+    CONCRETE_IO_HANDLE wsio;
+    unsigned char test_buffer[] = { 42, 43, 44 };
+    size_t outstanding_bytes = 0;
+    size_t outstanding_items = 0;
+    int result_1;
+    int result_2;
+
+    wsio = wsio_get_interface_description()->concrete_io_create(&default_wsio_config);
+    (void)wsio_get_interface_description()->concrete_io_open(wsio, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    g_on_ws_open_complete(g_on_ws_open_complete_context, WS_OPEN_OK);
+    (void)wsio_get_interface_description()->concrete_io_send(wsio, test_buffer, sizeof(test_buffer), test_on_send_complete, (void*)0x4343);
+    (void)wsio_get_interface_description()->concrete_io_send(wsio, test_buffer, 1, test_on_send_complete, (void*)0x4343);
+    umock_c_reset_all_calls();
+
+    // act
+    result_1 = wsio_get_interface_description()->concrete_io_getoption(wsio, OPTION_XIO_OUTSTANDING_BYTES, &outstanding_bytes);
+    result_2 = wsio_get_interface_description()->concrete_io_getoption(wsio, OPTION_XIO_OUTSTANDING_ITEMS, &outstanding_items);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result_1);
+    ASSERT_ARE_EQUAL(int, 0, result_2);
+    ASSERT_ARE_EQUAL(size_t, sizeof(test_buffer) + 1, outstanding_bytes);
+    ASSERT_ARE_EQUAL(size_t, 2, outstanding_items);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    wsio_get_interface_description()->concrete_io_destroy(wsio);
+}
+
+/* Tests_SRS_WSIO_11_007: [ For any other option `wsio_getoption` shall return a non-zero value. ]*/
+TEST_FUNCTION(wsio_getoption_with_an_unknown_option_fails)
+{
+    // arrange
+    CONCRETE_IO_HANDLE wsio;
+    size_t value;
+    int result;
+
+    wsio = wsio_get_interface_description()->concrete_io_create(&default_wsio_config);
+    umock_c_reset_all_calls();
+
+    // act
+    result = wsio_get_interface_description()->concrete_io_getoption(wsio, "option1", &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    wsio_get_interface_description()->concrete_io_destroy(wsio);
+}
+
 /* wsio_retrieveoptions */
 
 /* Tests_SRS_WSIO_01_118: [ If parameter `handle` is `NULL` then `wsio_retrieveoptions` shall fail and return NULL. ]*/
@@ -53,6 +53,10 @@ MOCK_FUNCTION_WITH_CODE(, void, test_xio_dowork, CONCRETE_IO_HANDLE, handle)
 MOCK_FUNCTION_END()
 MOCK_FUNCTION_WITH_CODE(, int, test_xio_setoption, CONCRETE_IO_HANDLE, handle, const char*, optionName, const void*, value)
 MOCK_FUNCTION_END(0)
+MOCK_FUNCTION_WITH_CODE(, int, test_xio_send_vectored, CONCRETE_IO_HANDLE, handle, const XIO_IOVEC*, iov, size_t, iov_count, ON_SEND_COMPLETE, on_send_complete, void*, callback_context)
+MOCK_FUNCTION_END(0)
+MOCK_FUNCTION_WITH_CODE(, int, test_xio_getoption, CONCRETE_IO_HANDLE, handle, const char*, optionName, void*, value)
+MOCK_FUNCTION_END(0)
 
 #include "azure_c_shared_utility/umock_c_prod.h"
 /*this function will clone an option given by name and value*/
@@ -113,6 +117,33 @@ const IO_INTERFACE_DESCRIPTION test_io_description =
     test_xio_setoption
 };
 
+const IO_INTERFACE_DESCRIPTION test_io_description_with_send_vectored =
+{
+    test_xio_retrieveoptions,
+    test_xio_create,
+    test_xio_destroy,
+    test_xio_open,
+    test_xio_close,
+    test_xio_send,
+    test_xio_dowork,
+    test_xio_setoption,
+    test_xio_send_vectored
+};
+
+const IO_INTERFACE_DESCRIPTION test_io_description_with_getoption =
+{
+    test_xio_retrieveoptions,
+    test_xio_create,
+    test_xio_destroy,
+    test_xio_open,
+    test_xio_close,
+    test_xio_send,
+    test_xio_dowork,
+    test_xio_setoption,
+    NULL,
+    test_xio_getoption
+};
+
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
@@ -777,6 +808,156 @@ TEST_FUNCTION(xio_send_with_non_NULL_buffer_and_zero_length_passes_the_args_down
     xio_destroy(handle);
 }
 
+/* xio_send_vectored */
+
+/* Tests_SRS_XIO_11_002: [ If xio or iov is NULL or iov_count is 0, xio_send_vectored shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(xio_send_vectored_with_invalid_args_fails)
+{
+    // arrange
+    int result_1;
+    int result_2;
+    int result_3;
+    unsigned char send_data[] = { 0x42, 43 };
+    XIO_IOVEC iov[1];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    iov[0].base = send_data;
+    iov[0].length = sizeof(send_data);
+    umock_c_reset_all_calls();
+
+    // act
+    result_1 = xio_send_vectored(NULL, iov, 1, test_on_send_complete, (void*)0x4242);
+    result_2 = xio_send_vectored(handle, NULL, 1, test_on_send_complete, (void*)0x4242);
+    result_3 = xio_send_vectored(handle, iov, 0, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_11_001: [ concrete_io_send_vectored is optional and may be NULL. ]*/
+/* Tests_SRS_XIO_11_003: [ If the concrete IO implements concrete_io_send_vectored, xio_send_vectored shall pass all its arguments to it and return its result. ]*/
+TEST_FUNCTION(xio_send_vectored_calls_the_concrete_send_vectored)
+{
+    // arrange
+    int result;
+    unsigned char send_data_1[] = { 0x42, 43 };
+    unsigned char send_data_2[] = { 0x44 };
+    XIO_IOVEC iov[2];
+    XIO_HANDLE handle = xio_create(&test_io_description_with_send_vectored, NULL);
+    iov[0].base = send_data_1;
+    iov[0].length = sizeof(send_data_1);
+    iov[1].base = send_data_2;
+    iov[1].length = sizeof(send_data_2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_send_vectored(TEST_CONCRETE_IO_HANDLE, iov, 2, test_on_send_complete, (void*)0x4242))
+        .SetReturn(42);
+
+    // act
+    result = xio_send_vectored(handle, iov, 2, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 42, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_11_004: [ Otherwise, if iov_count is 1, xio_send_vectored shall pass the piece to concrete_io_send. ]*/
+TEST_FUNCTION(xio_send_vectored_with_one_piece_calls_the_concrete_send)
+{
+    // arrange
+    int result;
+    unsigned char send_data[] = { 0x42, 43 };
+    XIO_IOVEC iov[1];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    iov[0].base = send_data;
+    iov[0].length = sizeof(send_data);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, send_data, sizeof(send_data), test_on_send_complete, (void*)0x4242));
+
+    // act
+    result = xio_send_vectored(handle, iov, 1, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_11_005: [ Otherwise xio_send_vectored shall copy the pieces in order to one buffer, pass it to concrete_io_send and free it. ]*/
+TEST_FUNCTION(xio_send_vectored_gathers_the_pieces_when_the_concrete_io_has_no_send_vectored)
+{
+    // arrange
+    int result;
+    unsigned char send_data_1[] = { 0x42, 43 };
+    unsigned char send_data_2[] = { 0x44 };
+    unsigned char expected_data[] = { 0x42, 43, 0x44 };
+    XIO_IOVEC iov[3];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    iov[0].base = send_data_1;
+    iov[0].length = sizeof(send_data_1);
+    iov[1].base = NULL;
+    iov[1].length = 0;
+    iov[2].base = send_data_2;
+    iov[2].length = sizeof(send_data_2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(expected_data)));
+    STRICT_EXPECTED_CALL(test_xio_send(TEST_CONCRETE_IO_HANDLE, IGNORED_PTR_ARG, sizeof(expected_data), test_on_send_complete, (void*)0x4242))
+        .ValidateArgumentBuffer(2, expected_data, sizeof(expected_data));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = xio_send_vectored(handle, iov, 3, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_11_006: [ If allocating the buffer fails, xio_send_vectored shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_allocating_the_gather_buffer_fails_xio_send_vectored_fails)
+{
+    // arrange
+    int result;
+    unsigned char send_data_1[] = { 0x42, 43 };
+    unsigned char send_data_2[] = { 0x44 };
+    XIO_IOVEC iov[2];
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    iov[0].base = send_data_1;
+    iov[0].length = sizeof(send_data_1);
+    iov[1].base = send_data_2;
+    iov[1].length = sizeof(send_data_2);
+    umock_c_reset_all_calls();
+    g_fail_alloc_calls = 1;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(3))
+        .SetReturn((void*)NULL);
+
+    // act
+    result = xio_send_vectored(handle, iov, 2, test_on_send_complete, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
 /* xio_dowork */
 
 /* Tests_SRS_XIO_01_012: [xio_dowork shall call the concrete IO implementation specified in xio_create, by calling the concrete_xio_dowork function.] */
@@ -899,6 +1080,78 @@ TEST_FUNCTION(xio_setoption_fails_when_concrete_xio_setoption_fails)
     xio_destroy(handle);
 }
 
+/* xio_getoption */
+
+/* Tests_SRS_XIO_11_008: [ If xio, optionName or value is NULL, xio_getoption shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(xio_getoption_with_invalid_args_fails)
+{
+    // arrange
+    int result_1;
+    int result_2;
+    int result_3;
+    size_t value;
+    XIO_HANDLE handle = xio_create(&test_io_description_with_getoption, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    result_1 = xio_getoption(NULL, "TheOptionName", &value);
+    result_2 = xio_getoption(handle, NULL, &value);
+    result_3 = xio_getoption(handle, "TheOptionName", NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result_3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_11_007: [ concrete_io_getoption is optional and may be NULL. ]*/
+/* Tests_SRS_XIO_11_009: [ xio_getoption shall pass optionName and value to concrete_io_getoption and return its result. ]*/
+TEST_FUNCTION(xio_getoption_calls_the_concrete_getoption)
+{
+    // arrange
+    int result;
+    size_t value;
+    XIO_HANDLE handle = xio_create(&test_io_description_with_getoption, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_xio_getoption(TEST_CONCRETE_IO_HANDLE, "TheOptionName", &value))
+        .SetReturn(42);
+
+    // act
+    result = xio_getoption(handle, "TheOptionName", &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 42, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
+/* Tests_SRS_XIO_11_010: [ If the concrete IO does not implement concrete_io_getoption, xio_getoption shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(xio_getoption_without_a_concrete_getoption_fails)
+{
+    // arrange
+    int result;
+    size_t value;
+    XIO_HANDLE handle = xio_create(&test_io_description, NULL);
+    umock_c_reset_all_calls();
+
+    // act
+    result = xio_getoption(handle, "TheOptionName", &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    xio_destroy(handle);
+}
+
 /*Tests_SRS_XIO_02_001: [ If argument xio is NULL then xio_retrieveoptions shall fail and return NULL. ]*/
 TEST_FUNCTION(xio_retrieveoptions_with_NULL_xio_fails)
 {